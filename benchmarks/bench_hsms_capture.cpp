@@ -0,0 +1,99 @@
+#include "bench_main.hpp"
+
+#include "secs/hsms/capture.hpp"
+#include "secs/hsms/message.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace secs;
+
+namespace {
+
+std::vector<core::byte> make_frame(std::size_t body_size) {
+    const std::vector<core::byte> body(body_size, 0x5A);
+    return hsms::encode_frame(hsms::make_data_message(
+        0x0001, 6, 11, true, 0x01020304, core::bytes_view{body.data(), body.size()}));
+}
+
+// 持续录制吞吐：生产者 try_push，环满时让出 CPU 重试（含后台线程落盘的端到端耗时）。
+void bench_capture_push(std::size_t body_size) {
+    constexpr int frames = 200000;
+    const auto frame = make_frame(body_size);
+    const auto path =
+        (std::filesystem::temp_directory_path() / "secs_bench_capture.bin").string();
+
+    const std::string name =
+        "Capture: record to file " + std::to_string(body_size) + "B body";
+    BENCH_RUN(name, frame.size() * frames, 5, {
+        hsms::CaptureWriter writer(hsms::CaptureWriterOptions{
+            .channel_ring_size = std::size_t{4} << 20U,
+            .flush_interval = std::chrono::milliseconds(1)});
+        if (writer.open(path)) {
+            std::cerr << "CaptureWriter open failed\n";
+            return;
+        }
+        std::shared_ptr<hsms::CaptureChannel> ch;
+        (void)writer.add_channel(1, ch);
+        for (int i = 0; i < frames; ++i) {
+            while (!ch->try_push(hsms::CaptureDirection::rx,
+                                 core::bytes_view{frame.data(), frame.size()})) {
+                std::this_thread::yield();
+            }
+        }
+        ch.reset();
+        writer.close();
+        if (writer.records_written() != static_cast<std::uint64_t>(frames)) {
+            std::cerr << "CaptureWriter lost records\n";
+        }
+    });
+    std::filesystem::remove(path);
+}
+
+// 回放侧：顺序解析整个抓包（零拷贝视图）。
+void bench_capture_read(std::size_t body_size) {
+    constexpr int frames = 200000;
+    const auto frame = make_frame(body_size);
+
+    std::vector<core::byte> file;
+    hsms::append_capture_file_header(file);
+    for (int i = 0; i < frames; ++i) {
+        (void)hsms::append_capture_record(
+            hsms::CaptureRecordView{.timestamp_ns = static_cast<std::uint64_t>(i),
+                                    .frame = core::bytes_view{frame.data(), frame.size()}},
+            file);
+    }
+
+    const std::string name =
+        "Capture: read records " + std::to_string(body_size) + "B body";
+    BENCH_RUN(name, file.size(), 10, {
+        hsms::CaptureReader reader;
+        (void)reader.open(core::bytes_view{file.data(), file.size()});
+        std::size_t n = 0;
+        for (hsms::CaptureRecordView rec; reader.next(rec);) {
+            n += rec.frame.size();
+        }
+        if (n != frame.size() * frames) {
+            std::cerr << "CaptureReader mismatch\n";
+        }
+    });
+}
+
+} // namespace
+
+int main() {
+    for (std::size_t body : {16U, 256U, 4096U}) {
+        bench_capture_push(body);
+    }
+    for (std::size_t body : {16U, 4096U}) {
+        bench_capture_read(body);
+    }
+
+    secs::benchmarks::print_results();
+    return 0;
+}
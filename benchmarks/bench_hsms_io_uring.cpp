@@ -0,0 +1,236 @@
+#include "bench_main.hpp"
+
+#include "secs/hsms/connection.hpp"
+#include "secs/hsms/io_uring_stream.hpp"
+#include "secs/hsms/message.hpp"
+
+#include <asio/as_tuple.hpp>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/use_awaitable.hpp>
+
+#include <sys/resource.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace secs;
+using namespace secs::core;
+using namespace secs::hsms;
+
+/*
+ * 大量并发 HSMS 连接下的传输后端对比：TCP（epoll reactor） vs io_uring。
+ *
+ * N 个客户端连接同时与回显服务端做 R 轮“发送 data 消息 -> 等待回显”。
+ * 服务端与客户端使用同一后端；io_uring 下服务端使用 multishot accept。
+ *
+ * 用法：bench_hsms_io_uring [连接数=1000] [每连接轮数=20] [消息体字节=64]
+ */
+
+namespace {
+
+struct Fleet final {
+    std::vector<std::unique_ptr<Connection>> clients{};
+    std::vector<std::shared_ptr<Connection>> servers{};
+};
+
+// 1000 个连接需要约 2000 个 fd（客户端 + 服务端）。
+void raise_fd_limit() {
+    rlimit rl{};
+    if (::getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        (void)::setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
+asio::awaitable<void> echo_loop(std::shared_ptr<Connection> conn) {
+    for (;;) {
+        auto [ec, msg] = co_await conn->async_read_message();
+        if (ec) {
+            break;
+        }
+        if (co_await conn->async_write_message(msg)) {
+            break;
+        }
+    }
+}
+
+// 建立 n 对连接；失败返回 false。
+bool open_fleet(asio::io_context &ioc, StreamBackend backend, std::size_t n,
+                Fleet &fleet) {
+    const asio::ip::tcp::endpoint loopback{asio::ip::make_address("127.0.0.1"), 0};
+    std::size_t accepted = 0;
+    std::size_t connected = 0;
+    bool failed = false;
+
+    std::unique_ptr<IoUringAcceptor> uring_acceptor;
+    std::unique_ptr<asio::ip::tcp::acceptor> tcp_acceptor;
+    asio::ip::tcp::endpoint endpoint;
+    if (backend == StreamBackend::io_uring) {
+        uring_acceptor = std::make_unique<IoUringAcceptor>(ioc.get_executor());
+        if (uring_acceptor->listen(loopback, 4096)) {
+            return false;
+        }
+        endpoint = uring_acceptor->local_endpoint();
+    } else {
+        tcp_acceptor = std::make_unique<asio::ip::tcp::acceptor>(ioc, loopback);
+        tcp_acceptor->listen(4096);
+        endpoint = tcp_acceptor->local_endpoint();
+    }
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            while (accepted < n && !failed) {
+                std::shared_ptr<Connection> conn;
+                if (uring_acceptor) {
+                    auto [ec, stream] = co_await uring_acceptor->async_accept();
+                    if (ec) {
+                        failed = true;
+                        break;
+                    }
+                    conn = std::make_shared<Connection>(std::move(stream));
+                } else {
+                    auto [ec, sock] = co_await tcp_acceptor->async_accept(
+                        asio::as_tuple(asio::use_awaitable));
+                    if (ec) {
+                        failed = true;
+                        break;
+                    }
+                    conn = std::make_shared<Connection>(std::move(sock));
+                }
+                fleet.servers.push_back(conn);
+                asio::co_spawn(ioc, echo_loop(conn), asio::detached);
+                ++accepted;
+            }
+        },
+        asio::detached);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        fleet.clients.push_back(std::make_unique<Connection>(
+            ioc.get_executor(), ConnectionOptions{.backend = backend}));
+        asio::co_spawn(
+            ioc,
+            [&, conn = fleet.clients.back().get()]() -> asio::awaitable<void> {
+                if (co_await conn->async_connect(endpoint)) {
+                    failed = true;
+                }
+                ++connected;
+            },
+            asio::detached);
+    }
+
+    while ((accepted < n || connected < n) && !failed) {
+        ioc.run_one();
+    }
+    if (uring_acceptor) {
+        uring_acceptor->close();
+    }
+    return !failed;
+}
+
+void close_fleet(asio::io_context &ioc, Fleet &fleet) {
+    std::size_t closed = 0;
+    const std::size_t total = fleet.clients.size() + fleet.servers.size();
+    auto close_one = [&](Connection *conn) {
+        asio::co_spawn(
+            ioc,
+            [&closed, conn]() -> asio::awaitable<void> {
+                (void)co_await conn->async_close();
+                ++closed;
+            },
+            asio::detached);
+    };
+    for (auto &c : fleet.clients) {
+        close_one(c.get());
+    }
+    for (auto &c : fleet.servers) {
+        close_one(c.get());
+    }
+    while (closed < total) {
+        ioc.run_one();
+    }
+    ioc.poll();
+    fleet.clients.clear();
+    fleet.servers.clear();
+}
+
+void bench_backend(StreamBackend backend, std::size_t sessions, std::size_t rounds,
+                   std::size_t body_size) {
+    asio::io_context ioc;
+    if (backend == StreamBackend::io_uring) {
+        // 每个连接一个注册槽（客户端 + 服务端）。
+        (void)configure_io_uring(ioc.get_executor(),
+                                 IoUringOptions{.entries = 4096,
+                                                .registered_slots = sessions * 2,
+                                                .slot_size = 4096});
+    }
+
+    Fleet fleet;
+    if (!open_fleet(ioc, backend, sessions, fleet)) {
+        std::cerr << "failed to open " << sessions << " connections\n";
+        return;
+    }
+
+    const std::vector<byte> body(body_size, 0x5A);
+    const auto msg = make_data_message(0x0001, 6, 11, false, 1,
+                                       bytes_view{body.data(), body.size()});
+    const std::size_t frame_size = kFramePrefixSize + body_size;
+    const std::size_t bytes = sessions * rounds * frame_size * 2;
+    const std::string name =
+        std::string{"HSMS "} +
+        (backend == StreamBackend::io_uring ? "io_uring" : "tcp(epoll)") + ": " +
+        std::to_string(sessions) + " sessions x " + std::to_string(rounds) +
+        " echo";
+
+    BENCH_RUN(name, bytes, 3, {
+        std::size_t finished = 0;
+        for (auto &client : fleet.clients) {
+            asio::co_spawn(
+                ioc,
+                [&, conn = client.get()]() -> asio::awaitable<void> {
+                    for (std::size_t r = 0; r < rounds; ++r) {
+                        if (co_await conn->async_write_message(msg)) {
+                            break;
+                        }
+                        auto [ec, echo] = co_await conn->async_read_message();
+                        if (ec) {
+                            std::cerr << "echo failed: " << ec.message() << "\n";
+                            break;
+                        }
+                    }
+                    ++finished;
+                },
+                asio::detached);
+        }
+        while (finished < sessions) {
+            ioc.run_one();
+        }
+    });
+
+    close_fleet(ioc, fleet);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t sessions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    const std::size_t rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+    const std::size_t body_size = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 64;
+    raise_fd_limit();
+
+    bench_backend(StreamBackend::tcp, sessions, rounds, body_size);
+    if (io_uring_available()) {
+        bench_backend(StreamBackend::io_uring, sessions, rounds, body_size);
+    } else {
+        std::cout << "io_uring backend unavailable (build with "
+                     "-DSECS_ENABLE_IO_URING=ON on Linux); skipped\n";
+    }
+    secs::benchmarks::print_results();
+    return 0;
+}
@@ -0,0 +1,251 @@
+#include "bench_main.hpp"
+
+#include "secs/hsms/connection.hpp"
+#include "secs/hsms/local_stream.hpp"
+#include "secs/hsms/message.hpp"
+
+#include <asio/as_tuple.hpp>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/use_awaitable.hpp>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace secs;
+using namespace secs::core;
+using namespace secs::hsms;
+
+/*
+ * 同机两进程之间的 HSMS 传输对比：TCP 回环 vs Unix 域 socket vs 共享内存环。
+ *
+ * 子进程作为回显端（独立 io_context），父进程测量：
+ * - ping-pong：小消息逐条往返（反映单次往返时延）；
+ * - bulk：1MiB 消息体往返（反映带宽，帧按两次拷贝计）。
+ *
+ * 用法：bench_hsms_local [往返次数=20000] [大消息条数=64]
+ */
+
+namespace {
+
+enum class Transport { tcp, unix_socket, shared_memory };
+
+const char *transport_name(Transport t) {
+    switch (t) {
+    case Transport::tcp:
+        return "tcp loopback";
+    case Transport::unix_socket:
+        return "unix socket";
+    case Transport::shared_memory:
+        return "shared memory";
+    }
+    return "?";
+}
+
+LocalEndpoint local_endpoint(Transport t) {
+    return LocalEndpoint{.path = "/tmp/secs_bench_hsms_local_" +
+                                 std::to_string(::getpid()) + ".sock",
+                         .transport = t == Transport::shared_memory
+                                          ? LocalTransport::shared_memory
+                                          : LocalTransport::unix_socket,
+                         .ring_capacity = std::size_t{4} << 20};
+}
+
+asio::awaitable<void> echo_loop(Connection &conn) {
+    for (;;) {
+        auto [ec, msg] = co_await conn.async_read_message();
+        if (ec) {
+            break;
+        }
+        if (co_await conn.async_write_message(msg)) {
+            break;
+        }
+    }
+    (void)co_await conn.async_close();
+}
+
+// 子进程：监听后经 ready_fd 报告端口（本机传输为 0），回显一个连接直到断开。
+[[noreturn]] void run_echo_child(Transport t, const LocalEndpoint &endpoint,
+                                 int ready_fd) {
+    asio::io_context ioc;
+    std::uint16_t port = 0;
+    std::unique_ptr<asio::ip::tcp::acceptor> tcp_acceptor;
+    LocalAcceptor local_acceptor(ioc.get_executor());
+    if (t == Transport::tcp) {
+        tcp_acceptor = std::make_unique<asio::ip::tcp::acceptor>(
+            ioc, asio::ip::tcp::endpoint{asio::ip::make_address("127.0.0.1"), 0});
+        port = tcp_acceptor->local_endpoint().port();
+    } else if (local_acceptor.listen(endpoint)) {
+        ::_exit(2);
+    }
+    (void)::write(ready_fd, &port, sizeof(port));
+    ::close(ready_fd);
+
+    bool done = false;
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            std::unique_ptr<Connection> conn;
+            if (tcp_acceptor) {
+                auto [ec, sock] = co_await tcp_acceptor->async_accept(
+                    asio::as_tuple(asio::use_awaitable));
+                if (ec) {
+                    done = true;
+                    co_return;
+                }
+                conn = std::make_unique<Connection>(std::move(sock));
+            } else {
+                auto [ec, stream] = co_await local_acceptor.async_accept();
+                if (ec) {
+                    done = true;
+                    co_return;
+                }
+                conn = std::make_unique<Connection>(std::move(stream));
+            }
+            co_await echo_loop(*conn);
+            done = true;
+        },
+        asio::detached);
+    while (!done) {
+        ioc.run_one();
+    }
+    local_acceptor.close();
+    ::_exit(0);
+}
+
+asio::awaitable<void> echo_rounds(Connection &conn, const Message &msg,
+                                  std::size_t rounds, bool &finished) {
+    for (std::size_t i = 0; i < rounds; ++i) {
+        if (co_await conn.async_write_message(msg)) {
+            std::cerr << "write failed\n";
+            break;
+        }
+        auto [ec, echo] = co_await conn.async_read_message();
+        if (ec) {
+            std::cerr << "echo failed: " << ec.message() << "\n";
+            break;
+        }
+    }
+    finished = true;
+}
+
+void run_rounds(asio::io_context &ioc, Connection &conn, const Message &msg,
+                std::size_t rounds) {
+    bool finished = false;
+    asio::co_spawn(ioc, echo_rounds(conn, msg, rounds, finished), asio::detached);
+    ioc.restart(); // 上一轮结束时 io_context 可能因无事可做而停止
+    while (!finished) {
+        ioc.run_one();
+    }
+}
+
+void bench_transport(Transport t, std::size_t pingpong_rounds, std::size_t bulk_rounds) {
+    const auto endpoint = local_endpoint(t);
+    int ready[2] = {-1, -1};
+    if (::pipe(ready) != 0) {
+        return;
+    }
+    const pid_t child = ::fork();
+    if (child < 0) {
+        return;
+    }
+    if (child == 0) {
+        ::close(ready[0]);
+        run_echo_child(t, endpoint, ready[1]);
+    }
+    ::close(ready[1]);
+    std::uint16_t port = 0;
+    const bool ready_ok = ::read(ready[0], &port, sizeof(port)) == sizeof(port);
+    ::close(ready[0]);
+
+    asio::io_context ioc;
+    std::unique_ptr<Connection> conn;
+    bool connecting = ready_ok;
+    if (ready_ok) {
+        asio::co_spawn(
+            ioc,
+            [&]() -> asio::awaitable<void> {
+                if (t == Transport::tcp) {
+                    auto c = std::make_unique<Connection>(ioc.get_executor());
+                    if (!co_await c->async_connect(asio::ip::tcp::endpoint{
+                            asio::ip::make_address("127.0.0.1"), port})) {
+                        conn = std::move(c);
+                    }
+                } else {
+                    auto [ec, stream] =
+                        co_await async_connect_local(ioc.get_executor(), endpoint);
+                    if (!ec) {
+                        conn = std::make_unique<Connection>(std::move(stream));
+                    }
+                }
+                connecting = false;
+            },
+            asio::detached);
+        while (connecting) {
+            ioc.run_one();
+        }
+    }
+
+    if (conn) {
+        const std::vector<byte> small(32, 0x11);
+        const std::vector<byte> large(std::size_t{1} << 20, 0x22);
+        const auto ping = make_data_message(0x0001, 1, 1, true, 1,
+                                            bytes_view{small.data(), small.size()});
+        const auto bulk = make_data_message(0x0001, 6, 11, false, 2,
+                                            bytes_view{large.data(), large.size()});
+        const std::string name = transport_name(t);
+
+        run_rounds(ioc, *conn, ping, 1000); // 预热
+        BENCH_RUN(name + ": ping-pong 32B x " + std::to_string(pingpong_rounds),
+                  pingpong_rounds * (kFramePrefixSize + small.size()) * 2, 3,
+                  run_rounds(ioc, *conn, ping, pingpong_rounds));
+        const double avg_ms = secs::benchmarks::results().back().elapsed_ms;
+        std::cout << name << ": "
+                  << avg_ms * 1000.0 / static_cast<double>(pingpong_rounds)
+                  << " us per round trip\n";
+
+        BENCH_RUN(name + ": bulk 1MiB x " + std::to_string(bulk_rounds),
+                  bulk_rounds * (kFramePrefixSize + large.size()) * 2, 3,
+                  run_rounds(ioc, *conn, bulk, bulk_rounds));
+
+        bool closed = false;
+        asio::co_spawn(
+            ioc,
+            [&]() -> asio::awaitable<void> {
+                (void)co_await conn->async_close();
+                closed = true;
+            },
+            asio::detached);
+        ioc.restart();
+        while (!closed) {
+            ioc.run_one();
+        }
+    } else {
+        std::cerr << transport_name(t) << ": connect failed\n";
+        ::kill(child, SIGTERM);
+    }
+    int status = 0;
+    (void)::waitpid(child, &status, 0);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t pingpong = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    const std::size_t bulk = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 64;
+
+    bench_transport(Transport::tcp, pingpong, bulk);
+    bench_transport(Transport::unix_socket, pingpong, bulk);
+    bench_transport(Transport::shared_memory, pingpong, bulk);
+    secs::benchmarks::print_results();
+    return 0;
+}
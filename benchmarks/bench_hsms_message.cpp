@@ -1,6 +1,7 @@
 #include "bench_main.hpp"
 #include "secs/hsms/message.hpp"
 
+#include <array>
 #include <cstdlib>
 #include <vector>
 
@@ -191,12 +192,48 @@ static void bench_hsms_decode_payload_only() {
     });
 }
 
+static void bench_hsms_shared_body_send_path() {
+    // 发送路径对比（1MB 消息体）：
+    // - copy：API 边界拷贝一次 + make_data_message 拷贝 + encode_frame 拼帧拷贝；
+    // - shared：API 边界 SharedBytes::copy（预留帧前缀）一次，之后只编码 14B 前缀，
+    //   并在 headroom 中拼出连续帧（对应 Connection 写出前的准备工作）。
+    constexpr std::size_t body_size = 1024 * 1024;
+    std::vector<byte> body(body_size, 0xEE);
+    const bytes_view src{body.data(), body.size()};
+
+    BENCH_RUN("HSMS: send path copy (1MB)", body_size, 3, {
+        std::vector<byte> api_copy(src.begin(), src.end());
+        Message msg = make_data_message(
+            0x3000, 6, 11, false, 1, bytes_view{api_copy.data(), api_copy.size()});
+        auto frame = encode_frame(msg);
+        if (frame.size() != kFramePrefixSize + body_size) {
+            std::abort();
+        }
+    });
+
+    std::array<byte, kFramePrefixSize> prefix{};
+    BENCH_RUN("HSMS: send path shared (1MB)", body_size, 3, {
+        auto shared = SharedBytes::copy(src, kFramePrefixSize);
+        Message msg = make_data_message_shared(0x3000, 6, 11, false, 1, shared);
+        if (encode_frame_prefix(msg, prefix)) {
+            std::abort();
+        }
+        const auto frame =
+            msg.shared_body.claim_headroom(bytes_view{prefix.data(), prefix.size()});
+        if (frame.size() != kFramePrefixSize + body_size) {
+            std::abort();
+        }
+        msg.shared_body.release_headroom();
+    });
+}
+
 int main() {
     bench_hsms_max_payload();
     bench_hsms_small_messages();
     bench_hsms_control_messages();
     bench_hsms_various_sizes();
     bench_hsms_decode_payload_only();
+    bench_hsms_shared_body_send_path();
 
     secs::benchmarks::print_results();
     return 0;
@@ -0,0 +1,174 @@
+#include "bench_main.hpp"
+
+#include "secs/core/shared_bytes.hpp"
+#include "secs/hsms/connection.hpp"
+#include "secs/hsms/message.hpp"
+
+#include <asio/as_tuple.hpp>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/steady_timer.hpp>
+#include <asio/use_awaitable.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace secs;
+using namespace secs::core;
+using namespace secs::hsms;
+using namespace std::chrono_literals;
+
+/*
+ * 写队列队头阻塞：大消息持续占满写队列时，小报警消息（S5F1）从 async_write_message
+ * 入队到对端读到的时延。
+ *
+ * 场景（TCP 回环，单线程）：
+ * - 若干个协程循环发送大 S7F3（配方下载），写队列中始终排着多条大帧；
+ * - 另一个协程每隔 2ms 发送一条 S5F1，对端记录其入队到收到的时延。
+ * 分别在“无优先级规则（全部 data 同一通道）”与“S5 → 通道 0、S7 → 通道 3”下运行，
+ * 输出 p50/p99/max（微秒）。已开始写出的帧不会被打断，因此有优先级时报警最多
+ * 等待一帧。
+ *
+ * 用法：bench_hsms_priority [报警条数=200] [大消息字节=4194304] [并发大消息数=4]
+ */
+
+namespace {
+
+struct Latency final {
+    double p50_us{0.0};
+    double p99_us{0.0};
+    double max_us{0.0};
+};
+
+Latency run(bool with_priorities,
+            std::size_t alarms,
+            std::size_t bulk_bytes,
+            std::size_t bulk_senders) {
+    asio::io_context ioc;
+    asio::ip::tcp::acceptor acceptor(
+        ioc, asio::ip::tcp::endpoint{asio::ip::make_address("127.0.0.1"), 0});
+    asio::ip::tcp::socket client_sock(ioc);
+    client_sock.connect(acceptor.local_endpoint());
+    asio::ip::tcp::socket server_sock = acceptor.accept();
+
+    ConnectionOptions tx_opt{};
+    tx_opt.t8 = 0ms;
+    if (with_priorities) {
+        tx_opt.data_priorities = {
+            {.stream = 5, .function = std::nullopt, .lane = 0},
+            {.stream = 7, .function = std::nullopt, .lane = 3},
+        };
+    }
+    Connection tx(std::move(client_sock), tx_opt);
+    Connection rx(std::move(server_sock), ConnectionOptions{.t8 = 0ms});
+
+    const std::vector<byte> bulk_body(bulk_bytes, 0x5A);
+    const auto bulk = make_data_message_shared(
+        0x0001, 7, 3, false, 0,
+        SharedBytes::copy(bytes_view{bulk_body.data(), bulk_body.size()},
+                          kFramePrefixSize));
+
+    std::vector<steady_clock::time_point> sent_at(alarms);
+    std::vector<double> latency_us;
+    latency_us.reserve(alarms);
+    bool stopping = false;
+
+    for (std::size_t i = 0; i < bulk_senders; ++i) {
+        asio::co_spawn(
+            ioc,
+            [&]() -> asio::awaitable<void> {
+                while (!stopping) {
+                    if (co_await tx.async_write_message(bulk)) {
+                        co_return;
+                    }
+                }
+            },
+            asio::detached);
+    }
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            const std::vector<byte> alarm_body(16, 0x01);
+            for (std::size_t i = 0; i < alarms && !stopping; ++i) {
+                asio::steady_timer t(ioc);
+                t.expires_after(2ms);
+                (void)co_await t.async_wait(asio::as_tuple(asio::use_awaitable));
+
+                sent_at[i] = steady_clock::now();
+                const auto alarm = make_data_message(
+                    0x0001, 5, 1, false, static_cast<std::uint32_t>(i + 1),
+                    bytes_view{alarm_body.data(), alarm_body.size()});
+                if (co_await tx.async_write_message(alarm)) {
+                    co_return;
+                }
+            }
+        },
+        asio::detached);
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            while (latency_us.size() < alarms) {
+                auto [ec, msg] = co_await rx.async_read_message();
+                if (ec) {
+                    break;
+                }
+                if (msg.stream() != 5) {
+                    continue;
+                }
+                const auto idx = static_cast<std::size_t>(msg.header.system_bytes - 1);
+                latency_us.push_back(
+                    std::chrono::duration<double, std::micro>(steady_clock::now() -
+                                                              sent_at[idx])
+                        .count());
+            }
+            stopping = true;
+            tx.cancel_and_close();
+            rx.cancel_and_close();
+        },
+        asio::detached);
+
+    ioc.run();
+
+    Latency out{};
+    if (latency_us.empty()) {
+        return out;
+    }
+    std::sort(latency_us.begin(), latency_us.end());
+    out.p50_us = latency_us[latency_us.size() / 2];
+    out.p99_us = latency_us[std::min(latency_us.size() - 1, latency_us.size() * 99 / 100)];
+    out.max_us = latency_us.back();
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t alarms = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+    const std::size_t bulk_bytes =
+        argc > 2 ? std::strtoul(argv[2], nullptr, 10) : std::size_t{4} << 20;
+    const std::size_t bulk_senders = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 4;
+
+    for (const bool with_priorities : {false, true}) {
+        const std::string name = with_priorities ? "S5 lane 0 / S7 lane 3"
+                                                 : "single data lane";
+        Latency l{};
+        BENCH_RUN("HSMS alarm under bulk load (" + name + ")",
+                  0,
+                  1,
+                  l = run(with_priorities, alarms, bulk_bytes, bulk_senders));
+        std::cout << name << ": alarm latency p50=" << l.p50_us
+                  << "us p99=" << l.p99_us << "us max=" << l.max_us << "us\n";
+    }
+
+    secs::benchmarks::print_results();
+    return 0;
+}
@@ -0,0 +1,213 @@
+#include "bench_main.hpp"
+
+#include "secs/hsms/message.hpp"
+#include "secs/hsms/session.hpp"
+
+#include <asio/as_tuple.hpp>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/use_awaitable.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace secs;
+using namespace secs::core;
+using namespace secs::hsms;
+using namespace std::chrono_literals;
+
+/*
+ * 多会话吞吐：N 对 HSMS 会话（TCP 回环）共享一个 io_context，分别用 1 个线程与
+ * M 个线程驱动。每个会话绑定自己的 strand，因此多线程下各会话可以并行推进。
+ *
+ * 每对会话：客户端逐条 async_request_data(S1F1)，服务端回显 S1F2。
+ * 输出总请求数 / 耗时（req/s）。
+ *
+ * 用法：bench_hsms_sessions [会话对数=8] [每会话请求数=5000] [线程数=硬件并发]
+ */
+
+namespace {
+
+SessionOptions session_options() {
+    SessionOptions opt{};
+    opt.session_id = 0x0001;
+    opt.t3 = 5s;
+    opt.t8 = 0ms;
+    opt.linktest_interval = 0ms;
+    opt.auto_reconnect = false;
+    return opt;
+}
+
+struct Fleet final {
+    asio::io_context ioc{};
+    std::vector<std::unique_ptr<Session>> servers{};
+    std::vector<std::unique_ptr<Session>> clients{};
+};
+
+template <class Pred>
+void run_until(asio::io_context &ioc, Pred pred) {
+    while (!pred()) {
+        ioc.run_one();
+    }
+}
+
+// 单线程依次建立 n 对会话（accept 到服务端会话自己的 strand 上）。
+bool open_fleet(Fleet &f, std::size_t n) {
+    asio::ip::tcp::acceptor acceptor(
+        f.ioc, asio::ip::tcp::endpoint{asio::ip::make_address("127.0.0.1"), 0});
+    const auto endpoint = acceptor.local_endpoint();
+
+    for (std::size_t i = 0; i < n; ++i) {
+        f.servers.push_back(std::make_unique<Session>(f.ioc.get_executor(),
+                                                      session_options()));
+        f.clients.push_back(std::make_unique<Session>(f.ioc.get_executor(),
+                                                      session_options()));
+        auto &server = *f.servers.back();
+        auto &client = *f.clients.back();
+
+        int opened = 0;
+        bool failed = false;
+        asio::co_spawn(
+            f.ioc,
+            [&]() -> asio::awaitable<void> {
+                auto [ec, sock] = co_await acceptor.async_accept(
+                    server.executor(), asio::as_tuple(asio::use_awaitable));
+                if (ec || co_await server.async_open_passive(std::move(sock))) {
+                    failed = true;
+                }
+                ++opened;
+            },
+            asio::detached);
+        asio::co_spawn(
+            f.ioc,
+            [&]() -> asio::awaitable<void> {
+                if (co_await client.async_open_active(endpoint)) {
+                    failed = true;
+                }
+                ++opened;
+            },
+            asio::detached);
+        run_until(f.ioc, [&] { return opened == 2; });
+        if (failed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+asio::awaitable<void> echo_loop(Session &server) {
+    for (;;) {
+        auto [ec, batch] = co_await server.async_receive_data_batch(0);
+        if (ec) {
+            co_return;
+        }
+        for (auto &msg : batch) {
+            auto rsp = make_data_message(msg.header.session_id,
+                                         msg.stream(),
+                                         static_cast<std::uint8_t>(msg.function() + 1),
+                                         false,
+                                         msg.header.system_bytes,
+                                         msg.body_view());
+            if (co_await server.async_send(rsp)) {
+                co_return;
+            }
+        }
+    }
+}
+
+// 返回每秒完成的请求数；失败返回 0。
+double run_fleet(std::size_t sessions, std::size_t requests, std::size_t threads) {
+    Fleet f;
+    if (!open_fleet(f, sessions)) {
+        std::cerr << "failed to open HSMS session pairs\n";
+        return 0.0;
+    }
+
+    for (auto &server : f.servers) {
+        asio::co_spawn(server->executor(), echo_loop(*server), asio::detached);
+    }
+
+    const std::vector<byte> body(32, 0x5A);
+    std::atomic<std::size_t> finished{0};
+    std::atomic<bool> ok{true};
+    for (auto &client : f.clients) {
+        asio::co_spawn(
+            client->executor(),
+            [&, c = client.get()]() -> asio::awaitable<void> {
+                for (std::size_t i = 0; i < requests && ok.load(); ++i) {
+                    auto [ec, rsp] = co_await c->async_request_data(
+                        1, 1, bytes_view{body.data(), body.size()});
+                    if (ec || rsp.body.size() != body.size()) {
+                        ok = false;
+                    }
+                }
+                if (finished.fetch_add(1) + 1 == f.clients.size()) {
+                    f.ioc.stop();
+                }
+            },
+            asio::detached);
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (std::size_t i = 1; i < threads; ++i) {
+        pool.emplace_back([&] { f.ioc.run(); });
+    }
+    f.ioc.run();
+    for (auto &t : pool) {
+        t.join();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+
+    // 收尾：停止会话，让 reader/echo 协程在单线程下退出后再析构。
+    for (auto &s : f.servers) {
+        s->stop();
+    }
+    for (auto &s : f.clients) {
+        s->stop();
+    }
+    f.ioc.restart();
+    f.ioc.run_for(1s);
+
+    if (!ok.load()) {
+        std::cerr << "request failed\n";
+        return 0.0;
+    }
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    return static_cast<double>(sessions * requests) / seconds;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t sessions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    const std::size_t requests = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5000;
+    const std::size_t threads =
+        argc > 3 ? std::strtoul(argv[3], nullptr, 10)
+                 : std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+    for (const std::size_t t : {std::size_t{1}, threads}) {
+        const auto name = std::to_string(sessions) + " sessions x " +
+                          std::to_string(requests) + " requests, " +
+                          std::to_string(t) + " thread(s)";
+        double rate = 0.0;
+        BENCH_RUN(name, 0, 1, rate = run_fleet(sessions, requests, t));
+        std::cout << name << ": " << static_cast<std::uint64_t>(rate) << " req/s\n";
+        if (t == threads) {
+            break;
+        }
+    }
+
+    secs::benchmarks::print_results();
+    return 0;
+}
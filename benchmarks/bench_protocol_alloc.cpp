@@ -0,0 +1,280 @@
+#include "bench_main.hpp"
+
+#include "secs/hsms/session.hpp"
+#include "secs/protocol/session.hpp"
+
+#include <asio/as_tuple.hpp>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/strand.hpp>
+#include <asio/use_awaitable.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+/*
+ * 协议层一次请求/响应往返的堆分配次数（含两端：同进程内 client + server）。
+ *
+ * 场景：
+ * - request（同执行器）：在会话执行器上直接 co_await async_request；
+ * - request（跨执行器）：在另一个 strand 上调用，走 co_spawn 切回会话执行器的路径；
+ * - send：单向 async_send（W=0），对端 router 处理但不回包。
+ *
+ * 计数方式：glibc 下接管 malloc 家族（asio 的帧回收器在缓存未命中时可能直接走
+ * aligned_alloc），其它平台退化为替换全局 operator new。
+ *
+ * 用法：bench_protocol_alloc [往返次数=20000]
+ */
+
+namespace {
+
+std::atomic<std::size_t> g_alloc_count{0};
+std::atomic<std::size_t> g_alloc_bytes{0};
+
+void count_alloc(std::size_t n) noexcept {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(n, std::memory_order_relaxed);
+}
+
+} // namespace
+
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(std::size_t);
+void *__libc_calloc(std::size_t, std::size_t);
+void *__libc_realloc(void *, std::size_t);
+void *__libc_memalign(std::size_t, std::size_t);
+void __libc_free(void *);
+
+void *malloc(std::size_t n) {
+    count_alloc(n);
+    return __libc_malloc(n);
+}
+void *calloc(std::size_t m, std::size_t n) {
+    count_alloc(m * n);
+    return __libc_calloc(m, n);
+}
+void *realloc(void *p, std::size_t n) {
+    count_alloc(n);
+    return __libc_realloc(p, n);
+}
+void *aligned_alloc(std::size_t align, std::size_t n) {
+    count_alloc(n);
+    return __libc_memalign(align, n);
+}
+void *memalign(std::size_t align, std::size_t n) {
+    count_alloc(n);
+    return __libc_memalign(align, n);
+}
+int posix_memalign(void **out, std::size_t align, std::size_t n) {
+    count_alloc(n);
+    void *p = __libc_memalign(align, n);
+    if (!p) {
+        return ENOMEM;
+    }
+    *out = p;
+    return 0;
+}
+void free(void *p) { __libc_free(p); }
+}
+#else
+void *operator new(std::size_t n) {
+    count_alloc(n);
+    if (void *p = std::malloc(n == 0 ? 1 : n)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+#endif
+
+using namespace secs;
+using namespace std::chrono_literals;
+
+namespace {
+
+struct Pair final {
+    asio::io_context ioc{};
+    hsms::Session hsms_server;
+    hsms::Session hsms_client;
+    protocol::Session server;
+    protocol::Session client;
+
+    static hsms::SessionOptions hsms_options() {
+        hsms::SessionOptions opt{};
+        opt.session_id = 0x0001;
+        opt.t3 = 5s;
+        opt.t8 = 0ms;
+        opt.linktest_interval = 0ms;
+        opt.auto_reconnect = false;
+        return opt;
+    }
+
+    static protocol::SessionOptions protocol_options() {
+        protocol::SessionOptions opt{};
+        opt.t3 = 5s;
+        return opt;
+    }
+
+    Pair()
+        : hsms_server(ioc.get_executor(), hsms_options()),
+          hsms_client(ioc.get_executor(), hsms_options()),
+          server(hsms_server, 0x0001, protocol_options()),
+          client(hsms_client, 0x0001, protocol_options()) {}
+};
+
+template <class Pred>
+void run_until(asio::io_context &ioc, Pred pred) {
+    while (!pred()) {
+        ioc.run_one();
+    }
+}
+
+bool open_pair(Pair &p) {
+    asio::ip::tcp::acceptor acceptor(
+        p.ioc, asio::ip::tcp::endpoint{asio::ip::make_address("127.0.0.1"), 0});
+    const auto endpoint = acceptor.local_endpoint();
+
+    int opened = 0;
+    bool failed = false;
+    asio::co_spawn(
+        p.ioc,
+        [&]() -> asio::awaitable<void> {
+            auto [ec, sock] =
+                co_await acceptor.async_accept(asio::as_tuple(asio::use_awaitable));
+            if (ec || co_await p.hsms_server.async_open_passive(std::move(sock))) {
+                failed = true;
+            }
+            ++opened;
+        },
+        asio::detached);
+    asio::co_spawn(
+        p.ioc,
+        [&]() -> asio::awaitable<void> {
+            if (co_await p.hsms_client.async_open_active(endpoint)) {
+                failed = true;
+            }
+            ++opened;
+        },
+        asio::detached);
+    run_until(p.ioc, [&] { return opened == 2; });
+    if (failed) {
+        return false;
+    }
+
+    p.server.router().set(
+        1, 1, [](const protocol::DataMessage &msg) -> asio::awaitable<protocol::HandlerResult> {
+            co_return protocol::HandlerResult{std::error_code{}, msg.body};
+        });
+    p.server.router().set(
+        6, 11, [](const protocol::DataMessage &) -> asio::awaitable<protocol::HandlerResult> {
+            co_return protocol::HandlerResult{std::error_code{}, {}};
+        });
+    asio::co_spawn(p.ioc, p.server.async_run(), asio::detached);
+    asio::co_spawn(p.ioc, p.client.async_run(), asio::detached);
+    return true;
+}
+
+enum class Mode { request_same_executor, request_foreign_executor, send };
+
+const char *mode_name(Mode m) {
+    switch (m) {
+    case Mode::request_same_executor:
+        return "request (session executor)";
+    case Mode::request_foreign_executor:
+        return "request (foreign strand)";
+    case Mode::send:
+        return "send (W=0)";
+    }
+    return "?";
+}
+
+// 在 ex 上跑 n 次操作，返回是否全部成功。
+bool run_ops(Pair &p, asio::any_io_executor ex, Mode mode, std::size_t n) {
+    const std::vector<core::byte> body(32, 0x5A);
+    bool done = false;
+    bool ok = true;
+    asio::co_spawn(
+        ex,
+        [&]() -> asio::awaitable<void> {
+            for (std::size_t i = 0; i < n && ok; ++i) {
+                if (mode == Mode::send) {
+                    ok = !co_await p.client.async_send(
+                        6, 11, core::bytes_view{body.data(), body.size()});
+                } else {
+                    auto [ec, rsp] = co_await p.client.async_request(
+                        1, 1, core::bytes_view{body.data(), body.size()});
+                    ok = !ec && rsp.body.size() == body.size();
+                }
+            }
+            done = true;
+        },
+        asio::detached);
+    run_until(p.ioc, [&] { return done; });
+    return ok;
+}
+
+void bench_mode(Pair &p, Mode mode, std::size_t n) {
+    asio::any_io_executor ex = p.client.executor();
+    if (mode == Mode::request_foreign_executor) {
+        ex = asio::make_strand(p.ioc);
+    }
+
+    // 预热：让连接写队列、帧回收缓存、router 等进入稳态。
+    if (!run_ops(p, ex, mode, 1000)) {
+        std::cerr << mode_name(mode) << ": warm-up failed\n";
+        return;
+    }
+
+    const auto count0 = g_alloc_count.load();
+    const auto bytes0 = g_alloc_bytes.load();
+    const bool ok = run_ops(p, ex, mode, n);
+    const auto count = g_alloc_count.load() - count0;
+    const auto bytes = g_alloc_bytes.load() - bytes0;
+    if (!ok) {
+        std::cerr << mode_name(mode) << ": failed\n";
+        return;
+    }
+    std::cout << mode_name(mode) << ": "
+              << static_cast<double>(count) / static_cast<double>(n)
+              << " allocations, "
+              << static_cast<double>(bytes) / static_cast<double>(n)
+              << " bytes per operation\n";
+
+    BENCH_RUN(std::string{"Protocol "} + mode_name(mode) + " x " + std::to_string(n),
+              0, 3, (void)run_ops(p, ex, mode, n));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+
+    Pair p;
+    if (!open_pair(p)) {
+        std::cerr << "failed to open HSMS session pair\n";
+        return 1;
+    }
+    bench_mode(p, Mode::request_same_executor, n);
+    bench_mode(p, Mode::request_foreign_executor, n);
+    bench_mode(p, Mode::send, n);
+
+    p.client.stop();
+    p.server.stop();
+    p.hsms_client.stop();
+    p.hsms_server.stop();
+    p.ioc.poll();
+
+    secs::benchmarks::print_results();
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "bench_main.hpp"
+
+#include "secs/protocol/spool.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace secs::protocol;
+
+namespace fs = std::filesystem;
+
+// 断线期间写入一批 S6F11（典型事件报告 ~200B），重连后读出并逐条确认。
+static std::string bench_dir() {
+    return (fs::temp_directory_path() / "secs_bench_spool").string();
+}
+
+static void bench_spool_push(std::size_t count, std::size_t body_size) {
+    const std::vector<secs::core::byte> body(body_size, 0x5A);
+    const std::string name = "Spool: push " + std::to_string(count) + " x " +
+                             std::to_string(body_size) + "B";
+    BENCH_RUN(name, count * body_size, 5, {
+        fs::remove_all(bench_dir());
+        Spool spool(SpoolOptions{.directory = bench_dir()});
+        if (spool.open()) {
+            std::cerr << "Spool open failed\n";
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            if (spool.push(6, 11, true, {body.data(), body.size()})) {
+                std::cerr << "Spool push failed\n";
+                break;
+            }
+        }
+    });
+}
+
+static void bench_spool_drain(std::size_t count, std::size_t body_size, std::size_t batch) {
+    const std::vector<secs::core::byte> body(body_size, 0x5A);
+    const std::string name = "Spool: read+consume " + std::to_string(count) + " x " +
+                             std::to_string(body_size) + "B (ack every " +
+                             std::to_string(batch) + ")";
+    BENCH_RUN(name, count * body_size, 5, {
+        fs::remove_all(bench_dir());
+        Spool spool(SpoolOptions{.directory = bench_dir()});
+        (void)spool.open();
+        for (std::size_t i = 0; i < count; ++i) {
+            (void)spool.push(6, 11, true, {body.data(), body.size()});
+        }
+        SpoolMessage m;
+        std::size_t n = 0;
+        while (spool.next(m)) {
+            if (++n % batch == 0) {
+                (void)spool.consume_through(m.sequence);
+            }
+        }
+        (void)spool.consume_through(m.sequence);
+        if (!spool.empty()) {
+            std::cerr << "Spool drain incomplete\n";
+        }
+    });
+}
+
+int main() {
+    bench_spool_push(10000, 200);
+    bench_spool_push(1000, 16384);
+    bench_spool_drain(10000, 200, 1);
+    bench_spool_drain(10000, 200, 16);
+    fs::remove_all(bench_dir());
+    secs::benchmarks::print_results();
+    return 0;
+}
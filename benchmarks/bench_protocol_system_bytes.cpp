@@ -0,0 +1,85 @@
+#include "bench_main.hpp"
+
+#include "secs/protocol/system_bytes.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace secs::protocol;
+
+// 每个工作线程的循环：持有 in_flight 个 SystemBytes（模拟未回应的 S1F3），
+// 每轮分配一批、再全部释放。
+static std::size_t run_worker(SystemBytes &sb, int rounds, int in_flight) {
+    std::vector<std::uint32_t> held(static_cast<std::size_t>(in_flight));
+    std::size_t failures = 0;
+    for (int r = 0; r < rounds; ++r) {
+        for (auto &v : held) {
+            if (sb.allocate(v)) {
+                ++failures;
+                v = 0;
+            }
+        }
+        for (auto v : held) {
+            sb.release(v);
+        }
+    }
+    return failures;
+}
+
+static void bench_system_bytes_single_thread() {
+    constexpr int rounds = 100000;
+    constexpr int in_flight = 8;
+    constexpr std::size_t ops = static_cast<std::size_t>(rounds) * in_flight;
+
+    SystemBytes sb;
+    BENCH_RUN("SystemBytes: allocate+release (1 thread)",
+              ops * sizeof(std::uint32_t),
+              5,
+              {
+                  if (run_worker(sb, rounds, in_flight) != 0) {
+                      std::cerr << "SystemBytes allocate failed\n";
+                  }
+              });
+}
+
+static void bench_system_bytes_contended(int threads) {
+    constexpr int rounds = 50000;
+    constexpr int in_flight = 8;
+    const std::size_t ops =
+        static_cast<std::size_t>(rounds) * in_flight * static_cast<std::size_t>(threads);
+
+    SystemBytes sb;
+    const std::string name =
+        "SystemBytes: allocate+release (" + std::to_string(threads) + " threads)";
+    BENCH_RUN(name, ops * sizeof(std::uint32_t), 5, {
+        std::atomic<std::size_t> failures{0};
+        std::vector<std::thread> pool;
+        pool.reserve(static_cast<std::size_t>(threads));
+        for (int t = 0; t < threads; ++t) {
+            pool.emplace_back([&] {
+                failures.fetch_add(run_worker(sb, rounds, in_flight),
+                                   std::memory_order_relaxed);
+            });
+        }
+        for (auto &t : pool) {
+            t.join();
+        }
+        if (failures.load() != 0) {
+            std::cerr << "SystemBytes allocate failed under contention\n";
+        }
+    });
+}
+
+int main() {
+    bench_system_bytes_single_thread();
+    for (int threads : {2, 4, 8}) {
+        bench_system_bytes_contended(threads);
+    }
+
+    secs::benchmarks::print_results();
+    return 0;
+}
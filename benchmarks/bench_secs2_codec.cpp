@@ -82,6 +82,25 @@ static void bench_codec_large_list() {
             std::cerr << "Decode failed: " << ec.message() << "\n";
         }
     });
+
+    // 事件式遍历（不构造 Item 树），与上面的 decode 对比
+    struct SumVisitor final : EncodedVisitor {
+        std::uint64_t sum{0};
+        void on_u4(BigEndianView<std::uint32_t> values) override {
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                sum += values[i];
+            }
+        }
+    };
+    BENCH_RUN("SECS-II: Large list visit (1000 items)", encoded_bytes, 3, {
+        SumVisitor visitor;
+        std::size_t consumed = 0;
+        auto ec = visit_encoded(
+            bytes_view{encoded.data(), encoded.size()}, visitor, consumed);
+        if (ec) {
+            std::cerr << "Visit failed: " << ec.message() << "\n";
+        }
+    });
 }
 
 static void bench_codec_large_ascii() {
@@ -1,5 +1,6 @@
 #include "bench_main.hpp"
 
+#include "secs/ii/codec.hpp"
 #include "secs/ii/item.hpp"
 #include "secs/sml/runtime.hpp"
 
@@ -49,6 +50,38 @@ static void bench_sml_load(std::size_t message_count) {
     });
 }
 
+static void bench_sml_tokenize(std::size_t message_count) {
+    const auto source = make_large_sml(message_count);
+
+    BENCH_RUN("SML: tokenize", source.size(), 5, {
+        Lexer lexer(source);
+        auto result = lexer.tokenize();
+        if (result.ec) {
+            std::cerr << "SML tokenize failed: " << result.ec.message() << "\n";
+        }
+    });
+}
+
+static void bench_sml_parse_parallel(std::size_t message_count) {
+    const auto source = make_large_sml(message_count);
+
+    BENCH_RUN("SML: parse_sml (sequential)", source.size(), 5, {
+        auto result = parse_sml(source);
+        if (result.ec) {
+            std::cerr << "SML parse failed: " << result.ec.message() << "\n";
+        }
+    });
+
+    LibraryLoadOptions opt;
+    opt.split_bytes = 64 * 1024;
+    BENCH_RUN("SML: parse_sml_parallel (all cores)", source.size(), 5, {
+        auto result = parse_sml_parallel(source, opt);
+        if (result.ec) {
+            std::cerr << "SML parse failed: " << result.ec.message() << "\n";
+        }
+    });
+}
+
 static void bench_sml_match(std::size_t message_count) {
     const auto source = make_large_sml(message_count);
 
@@ -88,11 +121,141 @@ static void bench_sml_match(std::size_t message_count) {
     });
 }
 
+static std::string make_rule_heavy_sml(std::size_t rule_count) {
+    // 大量条件规则分散在不同 (S,F) 上，最后一条才是 S6F11 的命中规则：
+    // 线性扫描需要走完全部规则，按 (S,F) 分桶后只需看同 SF 的少数规则。
+    std::string out;
+    out.reserve(rule_count * 48);
+    out += "ack: S6F12 <B 0>.\n";
+    for (std::size_t i = 0; i < rule_count; ++i) {
+        const std::uint32_t idx = static_cast<std::uint32_t>(i);
+        out += "if (S";
+        out += std::to_string((idx % 100u) + 10u);
+        out += "F";
+        out += std::to_string((idx % 200u) + 1u);
+        out += "(2)==<U4 ";
+        out += std::to_string(i);
+        out += ">) ack.\n";
+    }
+    out += "if (S6F11(3)==<U4 1000>) ack.\n";
+    return out;
+}
+
+static void bench_sml_match_many_rules(std::size_t rule_count) {
+    const auto source = make_rule_heavy_sml(rule_count);
+
+    Runtime rt;
+    auto ec = rt.load(source);
+    if (ec) {
+        std::cerr << "SML load failed: " << ec.message() << "\n";
+        return;
+    }
+
+    const Item report = Item::list({Item::u4({1u}), Item::u4({1000u})});
+    std::vector<byte> body;
+    if (encode(report, body)) {
+        std::cerr << "encode failed\n";
+        return;
+    }
+
+    constexpr int inner_loops = 10000;
+    BENCH_RUN("SML: match_response (S6F11, many rules)",
+              body.size() * static_cast<std::size_t>(inner_loops),
+              5,
+              {
+                  std::size_t hits = 0;
+                  for (int i = 0; i < inner_loops; ++i) {
+                      if (rt.match_response(6, 11, report)) {
+                          ++hits;
+                      }
+                  }
+                  if (hits == 0) {
+                      std::cerr << "SML match_response unexpected miss\n";
+                  }
+              });
+
+    BENCH_RUN("SML: match_response_encoded (S6F11, many rules)",
+              body.size() * static_cast<std::size_t>(inner_loops),
+              5,
+              {
+                  std::size_t hits = 0;
+                  for (int i = 0; i < inner_loops; ++i) {
+                      const std::string *name = nullptr;
+                      if (!rt.match_response_encoded(
+                              6, 11, bytes_view{body.data(), body.size()}, name) &&
+                          name) {
+                          ++hits;
+                      }
+                  }
+                  if (hits == 0) {
+                      std::cerr << "SML match_response_encoded unexpected miss\n";
+                  }
+              });
+}
+
+static void bench_sml_encode_message_body() {
+    // 典型事件报告：全部占位符都是单值，命中预编码快路径（拷贝镜像 + 补丁）。
+    const char *source =
+        "rpt: S6F11 W <L <U4 DATAID> <U4 CEID> <L <L <U4 RPTID> "
+        "<L <F4 TEMP> <F4 PRESS> <U2 STEP> <Boolean ALARM>>>>>.\n";
+
+    Runtime rt;
+    auto ec = rt.load(source);
+    if (ec) {
+        std::cerr << "SML load failed: " << ec.message() << "\n";
+        return;
+    }
+
+    RenderContext ctx;
+    ctx.set("DATAID", Item::u4({1u}));
+    ctx.set("CEID", Item::u4({1000u}));
+    ctx.set("RPTID", Item::u4({10u}));
+    ctx.set("TEMP", Item::f4({25.5f}));
+    ctx.set("PRESS", Item::f4({1.01f}));
+    ctx.set("STEP", Item::u2({3u}));
+    ctx.set("ALARM", Item::boolean({false}));
+
+    const auto *msg = rt.get_message("rpt");
+    std::vector<byte> body;
+    if (!msg || rt.encode_message_body("rpt", ctx, body)) {
+        std::cerr << "SML encode_message_body failed\n";
+        return;
+    }
+
+    constexpr int inner_loops = 10000;
+    BENCH_RUN("SML: encode_message_body (patched template)",
+              body.size() * static_cast<std::size_t>(inner_loops),
+              5,
+              {
+                  for (int i = 0; i < inner_loops; ++i) {
+                      (void)rt.encode_message_body("rpt", ctx, body);
+                  }
+              });
+
+    BENCH_RUN("SML: render_item + encode (same template)",
+              body.size() * static_cast<std::size_t>(inner_loops),
+              5,
+              {
+                  for (int i = 0; i < inner_loops; ++i) {
+                      Item rendered{List{}};
+                      (void)render_item(msg->item, ctx, rendered);
+                      body.clear();
+                      (void)encode(rendered, body);
+                  }
+              });
+}
+
 int main() {
     constexpr std::size_t message_count = 1000;
+    constexpr std::size_t large_message_count = 100000;
+    constexpr std::size_t rule_count = 5000;
 
+    bench_sml_tokenize(message_count);
     bench_sml_load(message_count);
+    bench_sml_parse_parallel(large_message_count);
     bench_sml_match(message_count);
+    bench_sml_match_many_rules(rule_count);
+    bench_sml_encode_message_body();
 
     secs::benchmarks::print_results();
     return 0;
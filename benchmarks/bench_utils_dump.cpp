@@ -0,0 +1,140 @@
+#include "bench_main.hpp"
+
+#include "secs/hsms/message.hpp"
+#include "secs/ii/codec.hpp"
+#include "secs/utils/async_dump.hpp"
+#include "secs/utils/hex.hpp"
+#include "secs/utils/hsms_dump.hpp"
+#include "secs/utils/item_dump.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace secs;
+
+namespace {
+
+// 典型数据消息：L[ U4, A, B[] ]。
+std::vector<core::byte> make_body() {
+    std::vector<core::byte> body;
+    const auto item = ii::Item::list({ii::Item::u4({1, 2, 3, 4}),
+                                      ii::Item::ascii(std::string(64, 'X')),
+                                      ii::Item::binary(std::vector<ii::byte>(128, 0x5A))});
+    (void)ii::encode(item, body);
+    return body;
+}
+
+utils::HsmsDumpOptions dump_options() {
+    utils::HsmsDumpOptions opt;
+    opt.include_hex = true;
+    opt.enable_secs2_decode = true;
+    return opt;
+}
+
+// 同步 dump：调用线程上完成 encode + 解码 + 格式化（protocol::Session 非延迟模式的代价）。
+void bench_sync_dump() {
+    constexpr int messages = 20000;
+    const auto body = make_body();
+    const auto msg = hsms::make_data_message(
+        0x0001, 6, 11, true, 1, core::bytes_view{body.data(), body.size()});
+    const auto opt = dump_options();
+
+    BENCH_RUN("Dump: sync HSMS (caller thread)", body.size() * messages, 5, {
+        std::size_t total = 0;
+        for (int i = 0; i < messages; ++i) {
+            const auto frame = hsms::encode_frame(msg);
+            total += utils::dump_hsms_frame(
+                         core::bytes_view{frame.data(), frame.size()}, opt)
+                         .size();
+        }
+        if (total == 0) {
+            std::cerr << "sync dump produced no output\n";
+        }
+    });
+}
+
+// 同步 dump，但复用同一个输出缓冲（append_hsms_frame_dump），不计 encode。
+void bench_append_reused() {
+    constexpr int messages = 20000;
+    const auto body = make_body();
+    const auto msg = hsms::make_data_message(
+        0x0001, 6, 11, true, 1, core::bytes_view{body.data(), body.size()});
+    const auto frame = hsms::encode_frame(msg);
+    const auto opt = dump_options();
+
+    std::string out;
+    BENCH_RUN("Dump: hsms frame (append, reused buffer)", body.size() * messages, 5, {
+        std::size_t total = 0;
+        for (int i = 0; i < messages; ++i) {
+            out.clear();
+            utils::append_hsms_frame_dump(
+                out, core::bytes_view{frame.data(), frame.size()}, opt);
+            total += out.size();
+        }
+        if (total == 0) {
+            std::cerr << "append dump produced no output\n";
+        }
+    });
+}
+
+// 纯 hex dump 与 Item dump（不含 HSMS 解析）。
+void bench_hex_and_item() {
+    constexpr int rounds = 20000;
+    const std::vector<core::byte> bytes(256, 0xA5);
+    const auto item = ii::Item::list({ii::Item::u4({1, 2, 3, 4}),
+                                      ii::Item::f8({0.1, 2.5, 3.75}),
+                                      ii::Item::ascii(std::string(64, 'X'))});
+
+    std::string out;
+    BENCH_RUN("Dump: hex_dump 256B (append)", bytes.size() * rounds, 5, {
+        for (int i = 0; i < rounds; ++i) {
+            out.clear();
+            utils::append_hex_dump(out, core::bytes_view{bytes.data(), bytes.size()});
+        }
+    });
+    BENCH_RUN("Dump: item (append)", static_cast<std::size_t>(rounds), 5, {
+        for (int i = 0; i < rounds; ++i) {
+            out.clear();
+            utils::append_item_dump(out, item);
+        }
+    });
+}
+
+// 延迟 dump：只计调用线程上的入队耗时（格式化在后台线程进行，缓冲区满则丢弃）。
+void bench_deferred_push() {
+    constexpr int messages = 20000;
+    const auto body = make_body();
+    const auto msg = hsms::make_data_message(
+        0x0001, 6, 11, true, 1, core::bytes_view{body.data(), body.size()});
+
+    utils::AsyncDumpOptions opt;
+    opt.buffer_bytes = std::size_t{16} << 20;
+    opt.hsms = dump_options();
+    utils::AsyncDumper dumper(opt);
+
+    BENCH_RUN("Dump: deferred HSMS push (caller thread)", body.size() * messages, 5, {
+        for (int i = 0; i < messages; ++i) {
+            (void)dumper.push_hsms("bench\n",
+                                   msg.header,
+                                   core::bytes_view{msg.body.data(), msg.body.size()});
+        }
+    });
+
+    dumper.flush();
+    std::cout << "deferred dump: dumped=" << dumper.dumped()
+              << " dropped=" << dumper.dropped() << "\n";
+}
+
+} // namespace
+
+int main() {
+    bench_sync_dump();
+    bench_append_reused();
+    bench_hex_and_item();
+    bench_deferred_push();
+
+    secs::benchmarks::print_results();
+    return 0;
+}
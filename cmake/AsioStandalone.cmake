@@ -13,6 +13,13 @@ set(SECS_FETCH_ASIO_GIT_REPOSITORY "https://github.com/chriskohlhoff/asio.git"
 set(SECS_FETCH_ASIO_GIT_TAG "asio-1-30-2"
   CACHE STRING "Git tag/commit used when SECS_FETCH_ASIO is enabled")
 
+# 协程帧/异步操作的线程级回收缓存深度（asio 默认 2）：一次请求/响应会在同一线程上
+# 嵌套 6~8 层 awaitable，缓存过浅时大部分协程帧退化为 malloc/free。
+# 该宏决定 asio::detail::thread_info_base 的布局，必须对所有翻译单元一致，故作为
+# secs_asio 的 INTERFACE 定义传播给下游。
+set(SECS_ASIO_RECYCLING_CACHE_SIZE 8
+  CACHE STRING "Per-thread asio recycling allocator cache slots (ASIO_RECYCLING_ALLOCATOR_CACHE_SIZE)")
+
 function(secs_fetch_asio_include_dir out_var)
   include(FetchContent)
 
@@ -100,6 +107,8 @@ function(secs_ensure_asio_target)
   )
   # ASIO_STANDALONE 表示不依赖 Boost.Asio，ASIO_NO_DEPRECATED 表示禁用遗弃的接口
   target_compile_definitions(secs_asio INTERFACE ASIO_STANDALONE ASIO_NO_DEPRECATED)
+  target_compile_definitions(secs_asio INTERFACE
+    ASIO_RECYCLING_ALLOCATOR_CACHE_SIZE=${SECS_ASIO_RECYCLING_CACHE_SIZE})
 
   find_package(Threads REQUIRED)
   target_link_libraries(secs_asio INTERFACE Threads::Threads)
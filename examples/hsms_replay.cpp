@@ -0,0 +1,115 @@
+/**
+ * @file hsms_replay.cpp
+ * @brief HSMS 抓包回放工具 - 把二进制抓包里的帧重新发给被测端
+ *
+ * 用法: ./hsms_replay <capture_file> [host] [port] [options]
+ *   --speed <x>      回放速度倍率（默认 1.0 = 原始节奏）
+ *   --max            不等待，尽可能快（等价于 --speed 0）
+ *   --tx             回放录制端发出的帧（默认回放录制端收到的帧）
+ *   --session <id>   只回放指定录制通道的帧（支持 0x 前缀）
+ *
+ * 抓包文件可由 hsms_sml_peer --capture <path> 或 hsms::CaptureWriter 生成。
+ * 注意：回放是原样写帧，不做 SELECT 握手；抓包从连接建立开始录制时，
+ * 其中已包含 Select.req 等控制消息。
+ */
+
+#include <secs/hsms/capture.hpp>
+#include <secs/hsms/connection.hpp>
+
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+#include <asio/ip/tcp.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace secs;
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "用法: " << argv[0]
+                  << " <capture_file> [host] [port] [--speed x|--max] [--tx] "
+                     "[--session id]\n";
+        return 2;
+    }
+
+    const std::string path = argv[1];
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 5000;
+    hsms::ReplayOptions replay_opt{};
+
+    int positional = 0;
+    for (int i = 2; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--max") {
+            replay_opt.speed = 0.0;
+        } else if (arg == "--speed" && i + 1 < argc) {
+            replay_opt.speed = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--tx") {
+            replay_opt.direction = hsms::CaptureDirection::tx;
+        } else if (arg == "--session" && i + 1 < argc) {
+            replay_opt.session_id =
+                static_cast<std::uint16_t>(std::strtoul(argv[++i], nullptr, 0));
+        } else if (positional == 0) {
+            host = std::string(arg);
+            ++positional;
+        } else if (positional == 1) {
+            port = static_cast<std::uint16_t>(std::atoi(argv[i]));
+            ++positional;
+        } else {
+            std::cerr << "unknown arg: " << arg << "\n";
+            return 2;
+        }
+    }
+
+    std::vector<core::byte> capture;
+    if (auto ec = hsms::load_capture_file(path, capture)) {
+        std::cerr << "[回放] 读取失败: " << path << " (" << ec.message() << ")\n";
+        return 1;
+    }
+
+    int rc = 0;
+    try {
+        asio::io_context ioc;
+        hsms::Connection conn(ioc.get_executor());
+
+        asio::co_spawn(
+            ioc,
+            [&]() -> asio::awaitable<void> {
+                const asio::ip::tcp::endpoint endpoint(asio::ip::make_address(host),
+                                                       port);
+                if (auto ec = co_await conn.async_connect(endpoint)) {
+                    std::cerr << "[回放] 连接失败: " << ec.message() << "\n";
+                    rc = 1;
+                    co_return;
+                }
+
+                std::cout << "[回放] " << path << " -> " << endpoint << "\n";
+                auto [ec, stats] = co_await hsms::async_replay(
+                    conn, core::bytes_view{capture.data(), capture.size()}, replay_opt);
+
+                const auto ms =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(stats.elapsed)
+                        .count();
+                std::cout << "[回放] 帧数=" << stats.frames << " 字节=" << stats.bytes
+                          << " 耗时=" << ms << "ms\n";
+                if (ec) {
+                    std::cerr << "[回放] 中止: " << ec.message() << "\n";
+                    rc = 1;
+                }
+                (void)co_await conn.async_close();
+            },
+            asio::detached);
+
+        ioc.run();
+    } catch (const std::exception &e) {
+        std::cerr << "[回放] 异常: " << e.what() << "\n";
+        return 1;
+    }
+    return rc;
+}
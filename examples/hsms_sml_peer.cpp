@@ -91,6 +91,8 @@ struct Options final {
     std::vector<std::string> fire_messages{};
 
     LogLevel log_level{LogLevel::info};
+
+    std::string capture_path{};
 };
 
 static void print_usage(const char *argv0) {
@@ -107,6 +109,7 @@ static void print_usage(const char *argv0) {
               << "  --enable-timers             启用 SML 的 every N send 规则\n"
               << "  --fire <name_or_SxFy>        启动后发送一次指定消息（可重复）\n"
               << "  --log-level <lvl>           trace|debug|info|warn|error|critical|off（默认 info）\n"
+              << "  --capture <path>            把收发的 HSMS 帧录制到二进制抓包文件（可用 hsms_replay 回放）\n"
               << "  --help                      显示帮助\n\n"
               << "示例:\n"
               << "  # WSL 作为被动端（监听），Windows 应用作为主动端连接\n"
@@ -578,6 +581,15 @@ static int parse_args(int argc, char **argv, Options &out) {
             continue;
         }
 
+        if (arg == "--capture") {
+            auto v = need_value("--capture");
+            if (!v.has_value()) {
+                return -1;
+            }
+            out.capture_path = std::string(*v);
+            continue;
+        }
+
         std::cerr << "unknown arg: " << arg << "\n";
         return -1;
     }
@@ -637,7 +649,22 @@ int main(int argc, char **argv) {
 
         asio::signal_set signals(ioc, SIGINT, SIGTERM);
 
-        const auto hsms_opt = make_hsms_options(opt);
+        auto hsms_opt = make_hsms_options(opt);
+
+        // 可选录制：所有连接共用一个通道（同一时刻只有一条连接）。
+        secs::hsms::CaptureWriter capture_writer;
+        if (!opt.capture_path.empty()) {
+            auto ec = capture_writer.open(opt.capture_path);
+            if (!ec) {
+                ec = capture_writer.add_channel(opt.session_id, hsms_opt.capture);
+            }
+            if (ec) {
+                std::cerr << "[capture] open failed: " << opt.capture_path << " ("
+                          << ec.message() << ")\n";
+                return 1;
+            }
+            std::cout << "[capture] recording to " << opt.capture_path << "\n";
+        }
 
         if (opt.mode == Mode::active) {
             std::error_code addr_ec;
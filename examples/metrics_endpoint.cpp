@@ -0,0 +1,220 @@
+/**
+ * @file metrics_endpoint.cpp
+ * @brief 指标导出示例 - HSMS 服务器 + 本地 /metrics（Prometheus 文本格式）
+ *
+ * 用法: ./metrics_endpoint [hsms_port] [metrics_port]
+ * 默认端口: 5000 / 9464
+ *
+ * 抓取: curl http://127.0.0.1:9464/metrics
+ *       curl -H 'Accept: application/openmetrics-text' http://127.0.0.1:9464/metrics
+ */
+
+#include <secs/core/metrics.hpp>
+#include <secs/hsms/session.hpp>
+#include <secs/ii/item.hpp>
+#include <secs/protocol/session.hpp>
+#include <secs/utils/protocol_helpers.hpp>
+
+#include <asio/as_tuple.hpp>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/read_until.hpp>
+#include <asio/signal_set.hpp>
+#include <asio/streambuf.hpp>
+#include <asio/use_awaitable.hpp>
+#include <asio/write.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <istream>
+#include <memory>
+#include <string>
+#include <utility>
+
+using namespace secs;
+using namespace std::chrono_literals;
+
+namespace {
+
+// 一个极简 HTTP/1.0 响应：每个连接只处理一个请求。
+asio::awaitable<void> serve_http(asio::ip::tcp::socket socket) {
+    asio::streambuf request;
+    auto [rd_ec, n] = co_await asio::async_read_until(
+        socket, request, "\r\n\r\n", asio::as_tuple(asio::use_awaitable));
+    if (rd_ec) {
+        co_return;
+    }
+    (void)n;
+
+    std::istream is(&request);
+    std::string request_line;
+    std::getline(is, request_line);
+
+    std::string headers;
+    for (std::string line; std::getline(is, line) && line != "\r";) {
+        headers += line;
+    }
+    const bool openmetrics =
+        headers.find("application/openmetrics-text") != std::string::npos;
+
+    std::string status = "200 OK";
+    std::string content_type =
+        openmetrics ? "application/openmetrics-text; version=1.0.0; charset=utf-8"
+                    : "text/plain; version=0.0.4; charset=utf-8";
+    std::string body;
+
+    if (request_line.rfind("GET /metrics ", 0) != 0) {
+        status = "404 Not Found";
+        content_type = "text/plain";
+        body = "not found\n";
+    } else {
+        core::metrics::Snapshot snap;
+        auto ec = core::metrics::default_registry().snapshot(snap);
+        if (!ec) {
+            ec = core::metrics::render_prometheus(snap, body, openmetrics);
+        }
+        if (ec) {
+            status = "500 Internal Server Error";
+            content_type = "text/plain";
+            body = ec.message() + "\n";
+        }
+    }
+
+    std::string response = "HTTP/1.0 " + status + "\r\n";
+    response += "Content-Type: " + content_type + "\r\n";
+    response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    response += body;
+
+    (void)co_await asio::async_write(
+        socket, asio::buffer(response), asio::as_tuple(asio::use_awaitable));
+}
+
+asio::awaitable<void> metrics_loop(asio::ip::tcp::acceptor &acceptor) {
+    while (true) {
+        auto [ec, socket] =
+            co_await acceptor.async_accept(asio::as_tuple(asio::use_awaitable));
+        if (ec) {
+            if (ec == asio::error::operation_aborted) {
+                break;
+            }
+            continue;
+        }
+        asio::co_spawn(acceptor.get_executor(),
+                       serve_http(std::move(socket)),
+                       asio::detached);
+    }
+}
+
+asio::awaitable<void> hsms_loop(asio::ip::tcp::acceptor &acceptor,
+                                hsms::SessionOptions opt) {
+    std::uint64_t seq = 0;
+    while (true) {
+        auto [ec, socket] =
+            co_await acceptor.async_accept(asio::as_tuple(asio::use_awaitable));
+        if (ec) {
+            if (ec == asio::error::operation_aborted) {
+                break;
+            }
+            continue;
+        }
+
+        // 每个连接一个分组：HSMS 与协议层共用，按 peer 地址区分机台。
+        const auto remote = socket.remote_endpoint(ec);
+        core::metrics::Labels labels{{"session", std::to_string(++seq)}};
+        labels.emplace_back("peer",
+                            ec ? std::string("unknown")
+                               : remote.address().to_string());
+        auto group = core::metrics::default_registry().make_group(std::move(labels));
+
+        auto session_opt = opt;
+        session_opt.metrics = group;
+        auto session =
+            std::make_shared<hsms::Session>(acceptor.get_executor(), session_opt);
+
+        asio::co_spawn(
+            acceptor.get_executor(),
+            [session,
+             group,
+             session_id = opt.session_id,
+             s = std::move(socket)]() mutable -> asio::awaitable<void> {
+                if (auto ec = co_await session->async_open_passive(std::move(s))) {
+                    std::cout << "[指标] SELECT 失败: " << ec.message() << "\n";
+                    co_return;
+                }
+
+                protocol::SessionOptions proto_opt{};
+                proto_opt.t3 = 45s;
+                proto_opt.metrics = group;
+                protocol::Session proto(*session, session_id, proto_opt);
+
+                proto.router().set_default(
+                    [](const protocol::DataMessage &)
+                        -> asio::awaitable<protocol::HandlerResult> {
+                        co_return utils::make_handler_result(ii::Item::ascii("OK"));
+                    });
+
+                co_await proto.async_run();
+                proto.stop();
+                session->stop();
+            },
+            asio::detached);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::uint16_t hsms_port = 5000;
+    std::uint16_t metrics_port = 9464;
+    if (argc > 1) {
+        hsms_port = static_cast<std::uint16_t>(std::atoi(argv[1]));
+    }
+    if (argc > 2) {
+        metrics_port = static_cast<std::uint16_t>(std::atoi(argv[2]));
+    }
+
+    std::cout << "=== 指标导出示例 ===\n\n";
+
+    try {
+        asio::io_context ioc;
+
+        hsms::SessionOptions opt;
+        opt.session_id = 0x0001;
+        opt.t3 = 45s;
+        opt.t6 = 5s;
+        opt.t7 = 10s;
+        opt.t8 = 5s;
+
+        asio::ip::tcp::acceptor hsms_acceptor(
+            ioc, asio::ip::tcp::endpoint(asio::ip::tcp::v4(), hsms_port));
+        asio::ip::tcp::acceptor metrics_acceptor(
+            ioc,
+            asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"),
+                                    metrics_port));
+
+        std::cout << "[指标] HSMS 监听端口: " << hsms_port << "\n";
+        std::cout << "[指标] 抓取地址: http://127.0.0.1:" << metrics_port
+                  << "/metrics\n";
+
+        asio::signal_set signals(ioc, SIGINT, SIGTERM);
+        signals.async_wait([&](const std::error_code &, int) {
+            hsms_acceptor.close();
+            metrics_acceptor.close();
+            ioc.stop();
+        });
+
+        asio::co_spawn(ioc, hsms_loop(hsms_acceptor, opt), asio::detached);
+        asio::co_spawn(ioc, metrics_loop(metrics_acceptor), asio::detached);
+
+        ioc.run();
+    } catch (const std::exception &e) {
+        std::cerr << "[指标] 异常: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -82,6 +82,58 @@ typedef enum secs_log_level {
 
 secs_error_t secs_log_set_level(secs_log_level_t level);
 
+/* ----------------------------- 指标 ----------------------------- */
+
+/*
+ * 指标开关（默认关闭）。
+ *
+ * 开启后新创建的 HSMS 会话（及基于它创建的协议层会话）会把计数器/时延直方图
+ * 记录到进程级注册表；每个 HSMS 会话一组标签：
+ *   session="<创建序号，从 1 开始>", session_id="<Device ID>"
+ * 已创建的会话不受影响。
+ */
+secs_error_t secs_metrics_set_enabled(int enabled);
+
+typedef enum secs_metric_type {
+    SECS_METRIC_COUNTER = 0,
+    SECS_METRIC_HISTOGRAM = 1
+} secs_metric_type_t;
+
+/*
+ * 单条指标样本：
+ * - counter：value 为当前值；
+ * - histogram：value 为样本数，sum/max/p50/p90/p99/p999 为原始单位
+ *   （时延为纳秒、尺寸为字节），乘以 scale 得到指标名所示单位（如秒）。
+ */
+typedef struct secs_metric_sample {
+    char *name;
+    char *labels; /* "k=v,k2=v2"（可能为空串） */
+    int type;     /* secs_metric_type_t */
+    uint64_t value;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t p999;
+    double scale;
+} secs_metric_sample_t;
+
+typedef struct secs_metrics_snapshot {
+    secs_metric_sample_t *samples; /* 按 name/labels 排序 */
+    size_t samples_n;
+} secs_metrics_snapshot_t;
+
+/* 抓取当前指标（结果需用 secs_metrics_snapshot_free 释放）。 */
+secs_error_t secs_metrics_snapshot(secs_metrics_snapshot_t *out);
+void secs_metrics_snapshot_free(secs_metrics_snapshot_t *snap);
+
+/*
+ * 渲染为 Prometheus 文本格式（openmetrics!=0 时为 OpenMetrics 文本格式），
+ * 可直接作为 HTTP /metrics 响应体。out_text 需用 secs_free 释放；out_len 可为 NULL。
+ */
+secs_error_t secs_metrics_render(int openmetrics, char **out_text, size_t *out_len);
+
 /* ----------------------------- 上下文（io 线程） -----------------------------
  */
 
@@ -394,6 +446,29 @@ secs_error_t secs_hsms_session_open_active_ip(secs_hsms_session_t *sess,
 secs_error_t secs_hsms_session_open_passive_ip(secs_hsms_session_t *sess,
                                                const char *ip,
                                                uint16_t port);
+
+/*
+ * 同机进程传输（阻塞式，仅 POSIX；对应 C++：hsms::LocalEndpoint）：
+ * - `path` 为 Unix 域 socket 路径，两端 transport 必须一致；
+ * - SHARED_MEMORY：建链后经共享内存环收发，socket 仅用于握手与唤醒；
+ * - open_passive_local 监听 `path` 并接受 1 个连接，完成 SELECT 后返回，
+ *   返回前删除 socket 文件；
+ * - 非 POSIX 平台返回 function_not_supported。
+ */
+typedef enum secs_hsms_local_transport {
+    SECS_HSMS_LOCAL_UNIX_SOCKET = 0,
+    SECS_HSMS_LOCAL_SHARED_MEMORY = 1
+} secs_hsms_local_transport_t;
+
+secs_error_t
+secs_hsms_session_open_active_local(secs_hsms_session_t *sess,
+                                    const char *path,
+                                    secs_hsms_local_transport_t transport);
+secs_error_t
+secs_hsms_session_open_passive_local(secs_hsms_session_t *sess,
+                                     const char *path,
+                                     secs_hsms_local_transport_t transport);
+
 secs_error_t
 secs_hsms_session_open_active_connection(secs_hsms_session_t *sess,
                                          secs_hsms_connection_t **io_conn);
@@ -473,7 +548,9 @@ typedef enum secs_protocol_dump_flags {
     SECS_PROTOCOL_DUMP_TX = 1u << 1,
     SECS_PROTOCOL_DUMP_RX = 1u << 2,
     SECS_PROTOCOL_DUMP_COLOR = 1u << 3,
-    SECS_PROTOCOL_DUMP_SECS2_DECODE = 1u << 4
+    SECS_PROTOCOL_DUMP_SECS2_DECODE = 1u << 4,
+    /* 延迟模式：后台线程格式化并调用 dump_sink（sink 需线程安全），缓冲区满时丢弃 */
+    SECS_PROTOCOL_DUMP_DEFERRED = 1u << 5
 } secs_protocol_dump_flags_t;
 
 typedef struct secs_protocol_session_options_v2 {
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "secs/core/common.hpp"
+
+#include <asio/awaitable.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace secs::core {
+
+/**
+ * @brief 流式消息体去向：接收大消息时，消息体按到达顺序分段交给 sink，
+ * 不在内存中拼出完整缓冲。
+ *
+ * 典型用途：上传几十~几百 MB 的配方（S7F3/S7F6）或 S13 大数据集，直接写入文件/
+ * 映射区域/回调。与 BodySource 对称。
+ *
+ * 约定：
+ * - async_write 按顺序收到全部内容（总长度等于消息体长度），全部写完后调用一次
+ *   async_finish；任一环节失败（包括连接断开、T8 超时）改为调用 abort，之后该
+ *   实例不再被使用；
+ * - contiguous() 非空时（例如 mmap 区域），接收方直接把数据读入该区域，随后以指向
+ *   区域内部的视图调用 async_write（数据已就位，实现无需再拷贝）。
+ */
+class BodySink {
+public:
+    virtual ~BodySink() = default;
+
+    // 已写入的字节数（完成后即消息体长度）。
+    [[nodiscard]] virtual std::size_t size() const noexcept = 0;
+
+    virtual asio::awaitable<std::error_code> async_write(bytes_view chunk) = 0;
+
+    // 消息体全部写完；返回错误时整条消息按接收失败处理。
+    virtual asio::awaitable<std::error_code> async_finish() {
+        co_return std::error_code{};
+    }
+
+    // 接收失败：实现可在此清理半成品（例如删除文件）。
+    virtual void abort(std::error_code reason) noexcept { (void)reason; }
+
+    // 可直接写入的预分配区域，否则返回空视图。
+    [[nodiscard]] virtual mutable_bytes_view contiguous() noexcept { return {}; }
+};
+
+// 为一条入站消息创建 sink 时的上下文。
+struct BodySinkInfo final {
+    std::uint8_t stream{0};
+    std::uint8_t function{0};
+    std::uint32_t system_bytes{0};
+    // 消息体长度：HSMS 在帧头中已知；SECS-I 逐块到达、收完前未知（为空）。
+    std::optional<std::size_t> size{};
+};
+
+// 返回 nullptr 表示该条消息仍按普通方式读入内存（例如 size 小于阈值时）。
+using BodySinkFactory =
+    std::function<std::shared_ptr<BodySink>(const BodySinkInfo &info)>;
+
+// 入站消息体 sink 注册：按 (stream, function) 匹配，function 为空表示该 stream 的
+// 全部 function；精确规则优先于整条 stream 的规则，同级规则取先出现的一条。
+struct BodySinkRule final {
+    std::uint8_t stream{0};
+    std::optional<std::uint8_t> function{};
+    BodySinkFactory factory{};
+};
+
+// 查找匹配的工厂；未命中返回 nullptr。
+[[nodiscard]] const BodySinkFactory *
+find_body_sink_factory(const std::vector<BodySinkRule> &rules,
+                       std::uint8_t stream,
+                       std::uint8_t function) noexcept;
+
+// 分段回调：按顺序收到消息体的每一段。
+using BodySinkChunkFn = std::function<asio::awaitable<std::error_code>(bytes_view chunk)>;
+// 完成回调：成功为空 error_code，失败给出原因。
+using BodySinkDoneFn = std::function<void(std::error_code ec)>;
+
+// 写入文件（截断/新建；同步写，常驻内存只有接收方的分段缓冲）。abort 时删除文件。
+// 失败返回 nullptr，并在 ec 中给出原因。
+[[nodiscard]] std::shared_ptr<BodySink> create_file_sink(const std::string &path,
+                                                         std::error_code &ec);
+
+// 预分配 size 字节并映射文件（contiguous() 为整个区域，接收方直接读入）；
+// 超出 size 的写入返回 buffer_overflow。abort 时删除文件；不支持 mmap 的平台
+// 退化为 create_file_sink。
+[[nodiscard]] std::shared_ptr<BodySink>
+map_file_sink(const std::string &path, std::size_t size, std::error_code &ec);
+
+// 由回调接收分段（on_done 可为空）。
+[[nodiscard]] std::shared_ptr<BodySink> make_callback_sink(BodySinkChunkFn on_chunk,
+                                                           BodySinkDoneFn on_done = {});
+
+} // namespace secs::core
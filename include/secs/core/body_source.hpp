@@ -0,0 +1,73 @@
+#pragma once
+
+#include "secs/core/common.hpp"
+
+#include <asio/awaitable.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace secs::core {
+
+/**
+ * @brief 流式消息体来源：总长度预先已知，内容按顺序分段读出。
+ *
+ * 典型用途：下发几十~几百 MB 的配方（S7F3）或批量数据时，不把整个消息体载入内存：
+ * HSMS 先按 size() 写出长度字段与头部，再逐段读出写入 socket；SECS-I 边读边切块。
+ *
+ * 约定：
+ * - async_read 顺序消费内容，同一实例只能被一次发送使用（不支持回退）；
+ * - 读出的总字节数必须恰好等于 size()，提前结束视为错误（发送方会断开连接，
+ *   因为帧已部分写出）；
+ * - contiguous() 非空时（例如 mmap 区域），发送方直接写出该视图而不调用 async_read，
+ *   此时同一实例可以同时被多个发送使用。
+ */
+class BodySource {
+public:
+    virtual ~BodySource() = default;
+
+    [[nodiscard]] virtual std::size_t size() const noexcept = 0;
+
+    // 读下一段到 dst（最多 dst.size() 字节），返回实际读取的字节数；0 表示内容已结束。
+    virtual asio::awaitable<std::pair<std::error_code, std::size_t>>
+    async_read(mutable_bytes_view dst) = 0;
+
+    // 整个消息体已在内存中时返回其只读视图（长度等于 size()），否则返回空视图。
+    [[nodiscard]] virtual bytes_view contiguous() const noexcept { return {}; }
+};
+
+// 分段生成器：把下一段写入 dst，返回写入字节数（0 表示结束）。
+using BodyChunkFn = std::function<asio::awaitable<std::pair<std::error_code, std::size_t>>(
+    mutable_bytes_view dst)>;
+
+// 读满 dst：来源提前结束返回 invalid_argument。
+asio::awaitable<std::error_code> async_read_full(BodySource &source,
+                                                 mutable_bytes_view dst);
+
+// 打开文件作为消息体（按需读取，常驻内存只有发送方的分段缓冲）。
+// 失败返回 nullptr，并在 ec 中给出原因。
+[[nodiscard]] std::shared_ptr<BodySource> open_file_body(const std::string &path,
+                                                         std::error_code &ec);
+
+// 只读映射文件作为消息体（contiguous() 非空，可被多个发送共享）；
+// 不支持 mmap 的平台退化为 open_file_body。
+[[nodiscard]] std::shared_ptr<BodySource> map_file_body(const std::string &path,
+                                                        std::error_code &ec);
+
+#if !defined(_WIN32)
+// 已打开的文件描述符中 [offset, offset + length) 作为消息体（pread，不改变文件偏移；
+// 不接管 fd，调用方需保证发送完成前 fd 有效）。
+[[nodiscard]] std::shared_ptr<BodySource>
+make_fd_body(int fd, std::uint64_t offset, std::size_t length);
+#endif
+
+// 由生成器协程产生的消息体（总长度 size 需预先给出）。
+[[nodiscard]] std::shared_ptr<BodySource> make_generator_body(std::size_t size,
+                                                              BodyChunkFn next);
+
+} // namespace secs::core
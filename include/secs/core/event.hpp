@@ -1,6 +1,7 @@
 #pragma once
 
 #include "secs/core/common.hpp"
+#include "secs/core/recycling_allocator.hpp"
 
 #include <asio/as_tuple.hpp>
 #include <asio/awaitable.hpp>
@@ -57,7 +58,10 @@ private:
     // 可以使用 expires_after 和 expires_at 来分别设置相对和绝对等待时间
     // 可以使用 cancel 取消所有挂起的等待，已挂起的 async_wait 会尽快
     // 完成并返回 operation_aborted，挂起表示还未完成，回调还未被调用
-    std::list<std::shared_ptr<asio::steady_timer>> waiters_{};
+    // 每次 wait 都要一个定时器与一个链表节点：二者都走线程级回收分配器，
+    // 稳态下（同一线程反复 wait）不再落到 malloc/free。
+    using WaiterPtr = std::shared_ptr<asio::steady_timer>;
+    std::list<WaiterPtr, RecyclingAllocator<WaiterPtr>> waiters_{};
 };
 
 } // namespace secs::core
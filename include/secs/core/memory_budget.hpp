@@ -0,0 +1,148 @@
+#pragma once
+
+#include "secs/core/common.hpp"
+#include "secs/core/metrics.hpp"
+
+#include <asio/awaitable.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <system_error>
+
+namespace secs::core {
+
+/*
+ * 进程级入站内存预算。
+ *
+ * 单条消息的上限（HSMS kMaxPayloadSize、SECS-II DecodeLimits）约束不了“数百个会话同时
+ * 收到大消息”的总量。MemoryBudget 在进程内共享（多个 Connection/StateMachine/解码调用
+ * 持有同一个 shared_ptr），入站缓冲在分配前先从预算中预约字节，用完（消息析构）归还：
+ *
+ * - HSMS Connection：读到长度字段后 async_acquire 消息体大小；预算不足时暂停读该 socket
+ *   （TCP 窗口随之收紧，对端被反压），直到其他消息归还；
+ * - SECS-I Reassembler 与 ii::decode_one：同步路径，try_acquire 失败即返回 out_of_memory
+ *   （SECS-I 回 NAK，由发送方重试）。
+ *
+ * 等待者按 FIFO 授予，避免大消息被持续到来的小消息饿死；单次请求超过总预算时立即失败。
+ *
+ * 线程模型：所有成员函数线程安全（内部互斥）；等待者在各自的执行器上被唤醒。
+ */
+
+struct MemoryBudgetOptions final {
+    // 预算总字节数（例如 2GB）；0 表示不限制（只统计）。
+    std::size_t limit_bytes{std::size_t{1} << 30};
+
+    // 指标分组（可选）：预约/归还字节数、等待次数与时长、拒绝次数。
+    std::shared_ptr<metrics::Group> metrics{};
+};
+
+class MemoryBudget final {
+public:
+    explicit MemoryBudget(MemoryBudgetOptions options = {});
+    ~MemoryBudget();
+
+    MemoryBudget(const MemoryBudget &) = delete;
+    MemoryBudget &operator=(const MemoryBudget &) = delete;
+
+    // 立即预约 n 字节：预算不足（或已有排队的等待者）时返回 false。
+    [[nodiscard]] bool try_acquire(std::size_t n) noexcept;
+
+    // 预约 n 字节，预算不足时等待归还：
+    // - timeout 为空表示一直等待；超时返回 errc::timeout；
+    // - owner 非空时可被 cancel_waits(owner) 取消（返回 errc::cancelled），
+    //   用于连接关闭时结束被反压的读协程；
+    // - n 超过总预算返回 errc::buffer_overflow。
+    asio::awaitable<std::error_code>
+    async_acquire(std::size_t n,
+                  std::optional<duration> timeout = std::nullopt,
+                  const void *owner = nullptr);
+
+    // 归还 n 字节并按 FIFO 唤醒可满足的等待者。
+    void release(std::size_t n) noexcept;
+
+    // 取消 owner 发起的全部等待。
+    void cancel_waits(const void *owner) noexcept;
+
+    // 利用率查询（瞬时值）。
+    [[nodiscard]] std::size_t limit() const noexcept { return options_.limit_bytes; }
+    [[nodiscard]] std::size_t used() const noexcept;
+    [[nodiscard]] std::size_t peak() const noexcept;
+    [[nodiscard]] std::size_t waiting() const noexcept;
+    // used / limit（不限制时为 0）。
+    [[nodiscard]] double utilization() const noexcept;
+
+    // 统计：需要等待的预约次数、被拒绝（try_acquire 失败/超时/超限）的次数。
+    [[nodiscard]] std::uint64_t waits() const noexcept;
+    [[nodiscard]] std::uint64_t rejections() const noexcept;
+
+private:
+    struct Waiter;
+    struct Metrics;
+
+    [[nodiscard]] bool fits_(std::size_t n) const noexcept;
+    void grant_waiters_() noexcept;
+    void note_acquired_(std::size_t n) noexcept;
+
+    MemoryBudgetOptions options_{};
+    std::unique_ptr<Metrics> metrics_{};
+
+    mutable std::mutex mu_{};
+    std::size_t used_{0};
+    std::size_t peak_{0};
+    std::uint64_t waits_{0};
+    std::uint64_t rejections_{0};
+    std::list<std::shared_ptr<Waiter>> waiters_{};
+};
+
+/**
+ * @brief 预算预约的 RAII 持有者：析构时归还全部字节（只可移动）。
+ *
+ * 消息体读入后把预约随消息一起传递（hsms::Message/DataMessage 等以 shared_ptr
+ * 持有），消息体释放时预算随之归还。
+ */
+class MemoryReservation final {
+public:
+    MemoryReservation() = default;
+    explicit MemoryReservation(std::shared_ptr<MemoryBudget> budget) noexcept
+        : budget_(std::move(budget)) {}
+    // 接管已通过 budget->try_acquire/async_acquire 预约的 bytes 字节。
+    MemoryReservation(std::shared_ptr<MemoryBudget> budget, std::size_t bytes) noexcept
+        : budget_(std::move(budget)), bytes_(bytes) {}
+
+    MemoryReservation(MemoryReservation &&other) noexcept;
+    MemoryReservation &operator=(MemoryReservation &&other) noexcept;
+    MemoryReservation(const MemoryReservation &) = delete;
+    MemoryReservation &operator=(const MemoryReservation &) = delete;
+
+    ~MemoryReservation() { reset(); }
+
+    [[nodiscard]] const std::shared_ptr<MemoryBudget> &budget() const noexcept {
+        return budget_;
+    }
+    [[nodiscard]] std::size_t bytes() const noexcept { return bytes_; }
+
+    // 追加预约 n 字节（未绑定预算时总是成功）。
+    [[nodiscard]] bool try_grow(std::size_t n) noexcept;
+
+    // 归还其中 n 字节（n 超过持有量时全部归还）。
+    void shrink(std::size_t n) noexcept;
+
+    // 归还全部字节（仍绑定同一预算）。
+    void reset() noexcept;
+
+private:
+    std::shared_ptr<MemoryBudget> budget_{};
+    std::size_t bytes_{0};
+};
+
+// 消息随身携带的预约（共享持有：消息在各层之间移动/拷贝时不重复计数）。
+using MemoryLease = std::shared_ptr<const MemoryReservation>;
+
+// 把 reservation 包装为 MemoryLease；未占用字节时返回空，内存不足时立即归还并返回空。
+[[nodiscard]] MemoryLease make_memory_lease(MemoryReservation &&reservation) noexcept;
+
+} // namespace secs::core
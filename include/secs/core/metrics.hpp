@@ -0,0 +1,238 @@
+#pragma once
+
+#include "secs/core/common.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace secs::core::metrics {
+
+/**
+ * @brief 标签集合（name -> value，按插入顺序输出）。
+ *
+ * 标签名需满足 Prometheus 规则（[a-zA-Z_][a-zA-Z0-9_]*），本库不做校验；
+ * 标签值在渲染时会按文本格式转义。
+ */
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+// 时延直方图按纳秒记录；注册时用该 scale 以秒为单位输出（*_seconds）。
+inline constexpr double kNanosecondsToSeconds = 1e-9;
+
+enum class MetricType : std::uint8_t {
+    counter = 0,
+    histogram = 1,
+};
+
+/**
+ * @brief 单调递增计数器（热路径无锁、无共享写）。
+ *
+ * 实现：按线程分片（每片独占一条 cache line），add() 只写当前线程所属分片，
+ * 抓取（scrape）时 value() 把各分片求和。多个 io 线程同时累加同一计数器时
+ * 不会在同一 cache line 上争用。
+ */
+class Counter final {
+public:
+    static constexpr std::size_t kShards = 8;
+
+    Counter() = default;
+    Counter(const Counter &) = delete;
+    Counter &operator=(const Counter &) = delete;
+
+    void add(std::uint64_t n = 1) noexcept {
+        shards_[shard_index_()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::uint64_t value() const noexcept;
+
+private:
+    struct alignas(64) Shard final {
+        std::atomic<std::uint64_t> value{0};
+    };
+
+    [[nodiscard]] static std::size_t shard_index_() noexcept;
+
+    std::array<Shard, kShards> shards_{};
+};
+
+/**
+ * @brief 直方图快照（桶计数为非累积值，桶边界见 Histogram::bucket_upper_bound）。
+ */
+struct HistogramSnapshot final {
+    std::uint64_t count{0};
+    std::uint64_t sum{0};
+    std::uint64_t max{0};
+    std::vector<std::uint64_t> buckets{};
+
+    // 分位值（q ∈ [0,1]）：返回所在桶的上界（不超过 max），相对误差 <= 1/8。
+    [[nodiscard]] std::uint64_t value_at_quantile(double q) const noexcept;
+};
+
+/**
+ * @brief HDR 风格的对数-线性直方图（固定内存，记录无锁）。
+ *
+ * 记录 64 位无符号整数（时延统一用纳秒，尺寸用字节）：
+ * - [0, 8) 每个值一个桶；
+ * - 之后每个 2 的幂区间 [2^e, 2^(e+1)) 均分为 8 个子桶；
+ * 共 kBucketCount 个桶，覆盖完整 uint64 范围，相对误差 <= 12.5%。
+ */
+class Histogram final {
+public:
+    static constexpr unsigned kSubBucketBits = 3;
+    static constexpr std::size_t kSubBucketCount = std::size_t{1} << kSubBucketBits;
+    static constexpr std::size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBucketCount;
+
+    Histogram() = default;
+    Histogram(const Histogram &) = delete;
+    Histogram &operator=(const Histogram &) = delete;
+
+    void record(std::uint64_t v) noexcept;
+
+    // 记录时长（纳秒；负值按 0 计）。
+    void record_duration(duration d) noexcept;
+
+    [[nodiscard]] HistogramSnapshot snapshot() const;
+
+    [[nodiscard]] static std::size_t bucket_index(std::uint64_t v) noexcept;
+    // 第 index 个桶的最小值与最大值（均为闭区间端点）。
+    [[nodiscard]] static std::uint64_t bucket_lower_bound(std::size_t index) noexcept;
+    [[nodiscard]] static std::uint64_t bucket_upper_bound(std::size_t index) noexcept;
+
+private:
+    std::array<std::atomic<std::uint64_t>, kBucketCount> buckets_{};
+    std::atomic<std::uint64_t> sum_{0};
+    std::atomic<std::uint64_t> max_{0};
+};
+
+/**
+ * @brief 一条指标样本（snapshot 的输出单元）。
+ *
+ * scale：把记录值换算为指标单位的系数（例如纳秒 -> 秒为 1e-9），
+ * 只用于渲染；histogram 字段保留原始整数。
+ */
+struct MetricSample final {
+    std::string name{};
+    std::string help{};
+    Labels labels{};
+    MetricType type{MetricType::counter};
+    std::uint64_t value{0};
+    HistogramSnapshot histogram{};
+    double scale{1.0};
+};
+
+struct Snapshot final {
+    // 按 (name, labels) 排序：同名指标（同一 family）相邻。
+    std::vector<MetricSample> samples{};
+};
+
+class Registry;
+
+/**
+ * @brief 指标分组：一组共享标签（例如一个会话）的计数器/直方图。
+ *
+ * 说明：
+ * - 由 Registry::make_group 创建，析构时自动从 Registry 注销；
+ * - counter()/histogram() 为 get-or-create：同名同标签返回同一对象，
+ *   因此多次重建的连接/会话可共享一个 Group 而不会产生重复序列；
+ * - 返回的引用在 Group 生命周期内稳定；热路径只需持有引用。
+ * - Registry 必须比其所有 Group 活得更久。
+ */
+class Group final {
+public:
+    Group(Registry &registry, Labels labels);
+    ~Group();
+
+    Group(const Group &) = delete;
+    Group &operator=(const Group &) = delete;
+
+    [[nodiscard]] const Labels &labels() const noexcept { return labels_; }
+
+    // 可能抛出 bad_alloc（仅在组件构造/启用指标时调用）。
+    Counter &counter(std::string_view name,
+                     std::string_view help,
+                     const Labels &extra_labels = {});
+    Histogram &histogram(std::string_view name,
+                         std::string_view help,
+                         const Labels &extra_labels = {},
+                         double scale = 1.0);
+
+private:
+    friend class Registry;
+
+    struct Entry final {
+        std::string name{};
+        std::string help{};
+        Labels labels{};
+        MetricType type{MetricType::counter};
+        double scale{1.0};
+        Counter *counter{nullptr};
+        Histogram *histogram{nullptr};
+    };
+
+    [[nodiscard]] Entry *find_(std::string_view name,
+                               const Labels &extra_labels) noexcept;
+
+    Registry &registry_;
+    Labels labels_{};
+    std::deque<Counter> counters_{};
+    std::deque<Histogram> histograms_{};
+    std::vector<Entry> entries_{};
+};
+
+/**
+ * @brief 指标注册表：汇总所有 Group，提供一致的 snapshot。
+ *
+ * 注册/注销/抓取由内部互斥锁串行化；记录路径（Counter::add /
+ * Histogram::record）不经过该锁。
+ */
+class Registry final {
+public:
+    Registry() = default;
+    Registry(const Registry &) = delete;
+    Registry &operator=(const Registry &) = delete;
+
+    // 创建一个分组（共享 labels）。可能抛出 bad_alloc。
+    [[nodiscard]] std::shared_ptr<Group> make_group(Labels labels = {});
+
+    /**
+     * @brief 抓取当前所有指标。
+     * @return ok；内存不足返回 out_of_memory（out 内容未定义）。
+     */
+    [[nodiscard]] std::error_code snapshot(Snapshot &out) const noexcept;
+
+private:
+    friend class Group;
+
+    void add_(Group *group);
+    void remove_(Group *group) noexcept;
+
+    mutable std::mutex mu_{};
+    std::vector<Group *> groups_{};
+};
+
+// 进程级默认注册表（C API 与示例使用）。
+[[nodiscard]] Registry &default_registry() noexcept;
+
+/**
+ * @brief 渲染为 Prometheus 文本格式（0.0.4）或 OpenMetrics 文本格式。
+ *
+ * 直方图输出时把细粒度桶合并为 2 的幂边界（le = (2^k-1)*scale，精确累计），
+ * 只输出第一个到最后一个非空区间之间的边界，外加 +Inf/_sum/_count。
+ * 结果追加到 out。
+ *
+ * @return ok；内存不足返回 out_of_memory。
+ */
+[[nodiscard]] std::error_code render_prometheus(const Snapshot &snapshot,
+                                                std::string &out,
+                                                bool openmetrics = false) noexcept;
+
+} // namespace secs::core::metrics
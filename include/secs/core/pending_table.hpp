@@ -0,0 +1,286 @@
+#pragma once
+
+#include "secs/core/error.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace secs::core {
+
+/**
+ * @brief 挂起事务表：按 SystemBytes 索引的定长开放寻址表（请求-响应匹配）。
+ *
+ * 结构：
+ * - slab：按块（kChunkEntries 个条目）分配，空闲条目用尽且未达 capacity 时才追加
+ *   一块；已分配的块不移动，条目地址在表生命周期内不变，可以安全地在条目上
+ *   co_await（例如条目内嵌的 core::Event）；
+ * - 索引：线性探测的开放寻址数组（大小为 >= 2*已分配条目数 的 2 的幂，随 slab
+ *   扩容重建），删除使用 backward-shift，不留墓碑；
+ * - 每个条目带 generation：释放时递增，旧 Handle 随之失效。
+ *
+ * capacity 只是上限：内存占用随实际并发的挂起事务数增长，而不是随配置值；
+ * 超过 kMaxCapacity 的配置按 kMaxCapacity 截断（下标为 uint32）。
+ *
+ * 条目有两种“在表”状态：
+ * - linked：可按 key（SystemBytes）find 到，用于匹配入站响应；
+ * - unlinked：已从索引摘除（取消/断线/同 key 被覆盖），但仍由发起方持有，
+ *   直到发起方用 Handle 调用 release()。这样等待中的协程唤醒后仍可读取条目，
+ *   而迟到的响应不会再匹配到它。
+ *
+ * 只在 slab 扩容（追加块、重建索引）时分配，稳态下 emplace/release 不分配。
+ * 本类不做线程安全保证，调用方需自行串行化。
+ */
+template <class T>
+class PendingTable final {
+public:
+    /**
+     * @brief 条目句柄（slab 下标 + generation），由 emplace 返回。
+     */
+    struct Handle final {
+        std::uint32_t index{std::numeric_limits<std::uint32_t>::max()};
+        std::uint32_t generation{0};
+    };
+
+    // capacity 的上限（远大于任何现实的并发事务数，且保证下标不溢出 uint32）。
+    static constexpr std::size_t kMaxCapacity = std::size_t{1} << 20;
+    // slab 每块的条目数。
+    static constexpr std::size_t kChunkEntries = 64;
+
+    explicit PendingTable(std::size_t capacity)
+        : capacity_(std::clamp<std::size_t>(capacity, 1U, kMaxCapacity)) {
+        // 先分配第一块（可能抛 bad_alloc，与历史构造行为一致）。
+        if (!grow_()) {
+            throw std::bad_alloc();
+        }
+    }
+
+    PendingTable(const PendingTable &) = delete;
+    PendingTable &operator=(const PendingTable &) = delete;
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+    // 已占用条目数（linked + unlinked）。
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+    /**
+     * @brief 登记一个挂起事务（原地构造 T）。
+     *
+     * 若 key 已存在（例如 SystemBytes 回绕），旧条目会被 unlink（持有方仍需
+     * release），与 map::insert_or_assign 的覆盖语义一致。
+     *
+     * @return ok；buffer_overflow 表示条目已满；T 构造抛出 bad_alloc 时返回
+     *         out_of_memory，其它异常返回 invalid_argument。
+     */
+    template <class... Args>
+    [[nodiscard]] std::error_code
+    emplace(std::uint32_t key, Handle &out, Args &&...args) noexcept {
+        if (free_head_ == kNone) {
+            if (allocated_ >= capacity_) {
+                return make_error_code(errc::buffer_overflow);
+            }
+            if (!grow_()) {
+                return make_error_code(errc::out_of_memory);
+            }
+        }
+
+        const auto idx = free_head_;
+        auto &e = entry_(idx);
+        try {
+            e.value.emplace(std::forward<Args>(args)...);
+        } catch (const std::bad_alloc &) {
+            return make_error_code(errc::out_of_memory);
+        } catch (...) {
+            return make_error_code(errc::invalid_argument);
+        }
+        free_head_ = e.next_free;
+        ++size_;
+
+        if (const auto old = lookup_(key); old != kNone) {
+            unlink_index_(old);
+        }
+        e.key = key;
+        link_(idx);
+
+        out.index = idx;
+        out.generation = e.generation;
+        return {};
+    }
+
+    // 按 key 查找 linked 条目；不存在返回 nullptr。
+    [[nodiscard]] T *find(std::uint32_t key) noexcept {
+        const auto idx = lookup_(key);
+        return idx == kNone ? nullptr : &*entry_(idx).value;
+    }
+
+    // 按句柄取条目（linked 或 unlinked）；句柄已失效返回 nullptr。
+    [[nodiscard]] T *get(Handle h) noexcept {
+        return valid_(h) ? &*entry_(h.index).value : nullptr;
+    }
+
+    // 从索引摘除（不再能按 key 找到），条目仍由持有方持有。
+    void unlink(Handle h) noexcept {
+        if (valid_(h) && entry_(h.index).linked) {
+            unlink_index_(h.index);
+        }
+    }
+
+    // 销毁条目并归还 slab；之后该句柄（及其所有拷贝）失效。
+    void release(Handle h) noexcept {
+        if (!valid_(h)) {
+            return;
+        }
+        auto &e = entry_(h.index);
+        if (e.linked) {
+            unlink_index_(h.index);
+        }
+        e.value.reset();
+        ++e.generation;
+        e.next_free = free_head_;
+        free_head_ = h.index;
+        --size_;
+    }
+
+    /**
+     * @brief 遍历 linked 条目，pred(key, T&) 返回 true 的条目被 unlink。
+     *
+     * 典型用法：取消/断线时给条目写入错误码并唤醒等待者，同时把它们摘出索引。
+     * pred 不应抛异常。
+     */
+    template <class Pred>
+    void unlink_if(Pred &&pred) noexcept {
+        for (std::uint32_t i = 0; i < allocated_; ++i) {
+            auto &e = entry_(i);
+            if (e.linked && pred(e.key, *e.value)) {
+                unlink_index_(i);
+            }
+        }
+    }
+
+private:
+    static constexpr std::uint32_t kNone = std::numeric_limits<std::uint32_t>::max();
+
+    struct Entry final {
+        std::optional<T> value{};
+        std::uint32_t key{0};
+        std::uint32_t generation{0};
+        std::uint32_t next_free{kNone};
+        bool linked{false};
+    };
+
+    [[nodiscard]] Entry &entry_(std::uint32_t idx) noexcept {
+        return chunks_[idx / kChunkEntries][idx % kChunkEntries];
+    }
+    [[nodiscard]] const Entry &entry_(std::uint32_t idx) const noexcept {
+        return chunks_[idx / kChunkEntries][idx % kChunkEntries];
+    }
+
+    // 追加一块条目（不超过 capacity_），必要时把索引扩到 >= 2*allocated_ 并重建。
+    // 分配失败返回 false，表保持原状。
+    [[nodiscard]] bool grow_() noexcept {
+        const auto n = std::min(kChunkEntries, capacity_ - allocated_);
+        const auto allocated = allocated_ + n;
+        std::size_t index_size = mask_ + 1U;
+        while (index_size < allocated * 2U) {
+            index_size <<= 1U;
+        }
+        try {
+            chunks_.reserve(chunks_.size() + 1U);
+            auto chunk = std::make_unique<Entry[]>(n);
+            std::unique_ptr<std::uint32_t[]> index;
+            if (index_size != mask_ + 1U || !index_) {
+                index = std::make_unique<std::uint32_t[]>(index_size); // 0 = 空
+            }
+            chunks_.push_back(std::move(chunk));
+            if (index) {
+                index_ = std::move(index);
+                mask_ = index_size - 1U;
+                for (std::uint32_t i = 0; i < allocated_; ++i) {
+                    if (entry_(i).linked) {
+                        link_(i);
+                    }
+                }
+            }
+        } catch (...) {
+            return false;
+        }
+
+        // 新条目按下标顺序接到空闲链表头部（此时链表必为空）。
+        for (auto i = allocated; i > allocated_; --i) {
+            auto &e = entry_(static_cast<std::uint32_t>(i - 1U));
+            e.next_free = free_head_;
+            free_head_ = static_cast<std::uint32_t>(i - 1U);
+        }
+        allocated_ = allocated;
+        return true;
+    }
+
+    [[nodiscard]] std::size_t home_(std::uint32_t key) const noexcept {
+        // Fibonacci 散列：连续的 SystemBytes 也能均匀打散。
+        return static_cast<std::size_t>(key * 0x9E3779B1U) & mask_;
+    }
+
+    [[nodiscard]] bool valid_(Handle h) const noexcept {
+        return h.index < allocated_ && entry_(h.index).value.has_value() &&
+               entry_(h.index).generation == h.generation;
+    }
+
+    [[nodiscard]] std::uint32_t lookup_(std::uint32_t key) const noexcept {
+        for (auto pos = home_(key);; pos = (pos + 1U) & mask_) {
+            const auto slot = index_[pos];
+            if (slot == 0U) {
+                return kNone;
+            }
+            if (entry_(slot - 1U).key == key) {
+                return slot - 1U;
+            }
+        }
+    }
+
+    void link_(std::uint32_t idx) noexcept {
+        auto pos = home_(entry_(idx).key);
+        while (index_[pos] != 0U) {
+            pos = (pos + 1U) & mask_;
+        }
+        index_[pos] = idx + 1U;
+        entry_(idx).linked = true;
+    }
+
+    void unlink_index_(std::uint32_t idx) noexcept {
+        auto pos = home_(entry_(idx).key);
+        while (index_[pos] != idx + 1U) {
+            pos = (pos + 1U) & mask_;
+        }
+        entry_(idx).linked = false;
+
+        // backward-shift：把后续探测链上的元素前移，保持“无空洞”不变式。
+        auto hole = pos;
+        for (auto next = (pos + 1U) & mask_; index_[next] != 0U;
+             next = (next + 1U) & mask_) {
+            const auto home = home_(entry_(index_[next] - 1U).key);
+            // next 的元素可以前移到 hole，当且仅当其 home 不在 (hole, next] 之间。
+            if (((next - home) & mask_) >= ((next - hole) & mask_)) {
+                index_[hole] = index_[next];
+                hole = next;
+            }
+        }
+        index_[hole] = 0U;
+    }
+
+    std::size_t capacity_{0};
+    std::size_t allocated_{0};
+    std::size_t mask_{0};
+    std::size_t size_{0};
+    std::uint32_t free_head_{kNone};
+    std::vector<std::unique_ptr<Entry[]>> chunks_;
+    std::unique_ptr<std::uint32_t[]> index_;
+};
+
+} // namespace secs::core
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace secs::core {
+
+namespace detail {
+
+/**
+ * @brief 线程级、按尺寸分级的小块回收缓存（RecyclingAllocator 的后端）。
+ *
+ * - 块尺寸按 kGranularity 向上取整分级，不超过 kMaxBlockSize 的块释放后挂到
+ *   当前线程对应级别的空闲链表（每级最多 kMaxCachedPerClass 块），下次同级分配直接复用；
+ * - 更大的块、或缓存已满/线程正在退出时，直接走 ::operator new/delete；
+ * - 块可以在 A 线程分配、B 线程释放（进入 B 的缓存），同级块尺寸一致，不会混用；
+ * - 线程退出时释放该线程缓存的全部块。
+ */
+struct ThreadBlockCache final {
+    static constexpr std::size_t kGranularity = 64;
+    static constexpr std::size_t kMaxBlockSize = 1024;
+    static constexpr std::size_t kMaxCachedPerClass = 32;
+
+    // 内存不足时抛出 std::bad_alloc。
+    [[nodiscard]] static void *allocate(std::size_t size);
+    static void deallocate(void *p, std::size_t size) noexcept;
+};
+
+} // namespace detail
+
+/**
+ * @brief 使用线程级回收缓存的标准分配器。
+ *
+ * 用于消息热路径上“每条消息一次、生命周期很短”的对象（写请求、Event 等待定时器
+ * 与链表节点等），配合 std::allocate_shared / 容器使用：稳态下同一线程反复
+ * 分配/释放同尺寸对象时不再落到 malloc/free。
+ *
+ * 协程帧本身由 asio 的 awaitable 分配（其线程级回收缓存深度见
+ * CMake 选项 SECS_ASIO_RECYCLING_CACHE_SIZE）。
+ */
+template <class T>
+class RecyclingAllocator {
+public:
+    using value_type = T;
+
+    RecyclingAllocator() noexcept = default;
+    template <class U>
+    RecyclingAllocator(const RecyclingAllocator<U> &) noexcept {}
+
+    [[nodiscard]] T *allocate(std::size_t n) {
+        if constexpr (alignof(T) > alignof(std::max_align_t)) {
+            return static_cast<T *>(
+                ::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+        } else {
+            return static_cast<T *>(detail::ThreadBlockCache::allocate(n * sizeof(T)));
+        }
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        if constexpr (alignof(T) > alignof(std::max_align_t)) {
+            ::operator delete(p, std::align_val_t{alignof(T)});
+        } else {
+            detail::ThreadBlockCache::deallocate(p, n * sizeof(T));
+        }
+    }
+
+    template <class U>
+    bool operator==(const RecyclingAllocator<U> &) const noexcept {
+        return true;
+    }
+    template <class U>
+    bool operator!=(const RecyclingAllocator<U> &) const noexcept {
+        return false;
+    }
+};
+
+} // namespace secs::core
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "secs/core/common.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace secs::core {
+
+/**
+ * @brief 不可变、引用计数的字节缓冲（发送路径零拷贝）。
+ *
+ * 典型用途：上层把已编码的 SECS-II 消息体交给 Session 后，消息体在
+ * “API 边界 -> 会话 -> 连接写出队列”之间只传递引用，不再逐层拷贝。
+ *
+ * 设计要点：
+ * - 负载创建后不可修改；拷贝 SharedBytes 只增加引用计数（线程安全）。
+ * - 可在负载前预留 headroom（例如 HSMS 的 4B 长度字段 + 10B 头部）：
+ *   写出时若能独占 headroom，就把前缀就地写入并一次性写出连续帧；
+ *   同一缓冲同时被多个连接写出时只有一个能占到 headroom，其余退回分散写（gather）。
+ */
+class SharedBytes final {
+public:
+    SharedBytes() noexcept = default;
+
+    // 拷贝 data 到新缓冲（该消息体唯一的一次拷贝），并在负载前预留 headroom 字节。
+    // 内存不足时抛出 std::bad_alloc。
+    [[nodiscard]] static SharedBytes copy(bytes_view data, std::size_t headroom = 0);
+
+    // 接管 vector 的存储（不拷贝负载，无 headroom）。
+    [[nodiscard]] static SharedBytes adopt(std::vector<byte> &&data);
+
+    [[nodiscard]] bytes_view view() const noexcept { return bytes_view{data_, size_}; }
+    [[nodiscard]] const byte *data() const noexcept { return data_; }
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+    // 负载前可用的预留字节数。
+    [[nodiscard]] std::size_t headroom() const noexcept;
+    // 当前引用计数（仅用于诊断/测试；空对象为 0）。
+    [[nodiscard]] long use_count() const noexcept { return storage_.use_count(); }
+
+    /**
+     * @brief 独占 headroom，把 prefix 写到负载正前方。
+     *
+     * 成功时返回 [prefix | 负载] 的连续视图，调用方写出完成后必须调用
+     * release_headroom()；headroom 不足或已被他人占用时返回空视图
+     * （调用方应改用分散写）。
+     */
+    [[nodiscard]] bytes_view claim_headroom(bytes_view prefix) const noexcept;
+    void release_headroom() const noexcept;
+
+private:
+    struct Storage;
+
+    std::shared_ptr<Storage> storage_{};
+    const byte *data_{nullptr};
+    std::size_t size_{0};
+};
+
+} // namespace secs::core
@@ -0,0 +1,258 @@
+#pragma once
+
+#include "secs/core/common.hpp"
+
+#include <asio/awaitable.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace secs::hsms {
+
+class Connection;
+
+/*
+ * HSMS 二进制抓包（capture）格式与录制/回放。
+ *
+ * 文件布局（所有整数均为大端，与 HSMS 线上字节序一致）：
+ *
+ *   文件头（16B）：magic "SECSCAP\0"(8) | version u16 | header_size u16 | reserved u32
+ *   记录  （16B + N）：
+ *     timestamp_ns u64   system_clock 自 Unix epoch 起的纳秒（便于与现场日志对齐）
+ *     frame_len    u32   N：原始 HSMS 帧长度（含 4B 长度字段）
+ *     session_id   u16   录制通道的会话标识（CaptureWriter::add_channel 指定）
+ *     direction    u8    0=rx 1=tx（相对被录制的 Connection）
+ *     flags        u8    保留，写 0
+ *     frame        N 字节
+ *
+ * 录制（热路径不加锁、不分配）：
+ *   Connection ──try_push──> CaptureChannel（每方向一个 SPSC 字节环）
+ *                                 │  后台线程按 flush_interval 批量抽取
+ *                                 ▼
+ *   CaptureWriter：按时间戳归并同一批记录 ──fwrite──> 文件
+ *   环满时记录被丢弃并计数（dropped），绝不阻塞 io 线程。
+ */
+
+inline constexpr std::size_t kCaptureFileHeaderSize = 16;
+inline constexpr std::size_t kCaptureRecordHeaderSize = 16;
+inline constexpr std::uint16_t kCaptureVersion = 1;
+
+enum class CaptureDirection : std::uint8_t {
+    rx = 0,
+    tx = 1,
+};
+
+/**
+ * @brief 一条抓包记录（视图；frame 指向源缓冲区，不拥有内存）。
+ */
+struct CaptureRecordView final {
+    std::uint64_t timestamp_ns{0};
+    CaptureDirection direction{CaptureDirection::rx};
+    std::uint16_t session_id{0};
+    core::bytes_view frame{};
+};
+
+// 追加 16B 文件头到 out（可能抛出 bad_alloc）。
+void append_capture_file_header(std::vector<core::byte> &out);
+
+// 追加一条记录到 out。frame 超过 u32 上限返回 buffer_overflow；内存不足返回 out_of_memory。
+std::error_code append_capture_record(const CaptureRecordView &record,
+                                      std::vector<core::byte> &out) noexcept;
+
+// 当前 system_clock 时间（纳秒，自 Unix epoch）。
+[[nodiscard]] std::uint64_t capture_now_ns() noexcept;
+
+/**
+ * @brief 抓包文件读取器（零拷贝：记录视图直接指向输入缓冲区）。
+ *
+ * 用法：
+ *   CaptureReader r;
+ *   if (auto ec = r.open(bytes)) { ... }
+ *   for (CaptureRecordView rec; r.next(rec);) { ... }
+ *   if (r.error()) { ... }  // 末尾记录被截断等
+ */
+class CaptureReader final {
+public:
+    // 校验文件头；data 必须在读取期间保持有效。
+    [[nodiscard]] std::error_code open(core::bytes_view data) noexcept;
+
+    // 读取下一条记录；到达末尾或出错时返回 false（用 error() 区分）。
+    [[nodiscard]] bool next(CaptureRecordView &out) noexcept;
+
+    // 截断/损坏的记录返回 invalid_argument；正常结束为 ok。
+    [[nodiscard]] std::error_code error() const noexcept { return error_; }
+
+private:
+    core::bytes_view data_{};
+    std::size_t offset_{0};
+    std::error_code error_{};
+};
+
+// 把整个抓包文件读入内存（回放工具使用）。
+[[nodiscard]] std::error_code load_capture_file(const std::string &path,
+                                                std::vector<core::byte> &out) noexcept;
+
+/**
+ * @brief 单个连接的抓包通道：rx/tx 各一个无锁 SPSC 字节环。
+ *
+ * 约束：
+ * - 同一方向同一时刻只能有一个生产者（Connection 的读协程 / writer_loop_ 天然满足）；
+ * - 消费者只有 CaptureWriter 的后台线程；
+ * - try_push 不分配内存，环满时丢弃并计入 dropped()。
+ *
+ * 由 CaptureWriter::add_channel 创建；Writer 关闭后 try_push 仍可安全调用（记录被丢弃）。
+ */
+class CaptureChannel final {
+public:
+    CaptureChannel(std::uint16_t session_id, std::size_t ring_size);
+
+    CaptureChannel(const CaptureChannel &) = delete;
+    CaptureChannel &operator=(const CaptureChannel &) = delete;
+
+    [[nodiscard]] std::uint16_t session_id() const noexcept { return session_id_; }
+
+    /**
+     * @brief 记录一帧（frame 由 head + body 两段拼成，便于读路径免拼接）。
+     * @return true 表示已入环；false 表示环满或已关闭（记录被丢弃）。
+     */
+    bool try_push(CaptureDirection direction,
+                  core::bytes_view head,
+                  core::bytes_view body = {}) noexcept;
+
+    [[nodiscard]] std::uint64_t dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    friend class CaptureWriter;
+
+    struct alignas(64) Ring final {
+        std::unique_ptr<core::byte[]> data{};
+        std::size_t mask{0};
+        alignas(64) std::atomic<std::uint64_t> head{0}; // 生产者写入位置
+        alignas(64) std::atomic<std::uint64_t> tail{0}; // 消费者读取位置
+    };
+
+    // 消费者：把 [tail, head) 复制到 out 末尾并推进 tail。
+    void drain_(Ring &ring, std::vector<core::byte> &out);
+
+    std::uint16_t session_id_{0};
+    std::array<Ring, 2> rings_{};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<bool> closed_{false};
+};
+
+struct CaptureWriterOptions final {
+    // 每个通道每个方向的环大小（向上取整为 2 的幂）。
+    std::size_t channel_ring_size{std::size_t{1} << 20};
+
+    // 后台线程抽取/落盘周期。
+    core::duration flush_interval{std::chrono::milliseconds(10)};
+};
+
+/**
+ * @brief 异步抓包文件写入器：后台线程周期性抽取所有通道并顺序写盘。
+ *
+ * 同一批次内的记录按 timestamp 归并后写出，因此文件在批次粒度上按时间有序
+ * （跨批次也有序，除非某个生产者在两次抽取之间被长时间挂起）。
+ */
+class CaptureWriter final {
+public:
+    explicit CaptureWriter(CaptureWriterOptions options = {});
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter &) = delete;
+    CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+    // 创建/截断文件、写入文件头并启动后台线程。
+    [[nodiscard]] std::error_code open(const std::string &path) noexcept;
+
+    // 新建一个通道（通常每个 Connection 一个）。Writer 未打开时返回 invalid_argument。
+    [[nodiscard]] std::error_code add_channel(std::uint16_t session_id,
+                                              std::shared_ptr<CaptureChannel> &out) noexcept;
+
+    // 停止后台线程：最后一次抽取所有通道、落盘并关闭文件（幂等）。
+    void close() noexcept;
+
+    [[nodiscard]] std::uint64_t records_written() const noexcept {
+        return records_written_.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] std::uint64_t bytes_written() const noexcept {
+        return bytes_written_.load(std::memory_order_relaxed);
+    }
+    // 所有通道（含已释放的通道）累计丢弃数。
+    [[nodiscard]] std::uint64_t dropped() const noexcept;
+
+    // 最近一次写盘错误（ok 表示无错误）。
+    [[nodiscard]] std::error_code last_error() const noexcept;
+
+private:
+    void run_() noexcept;
+    void flush_once_();
+
+    CaptureWriterOptions options_{};
+
+    mutable std::mutex mu_{};
+    std::condition_variable cv_{};
+    bool stopping_{false};
+    std::vector<std::shared_ptr<CaptureChannel>> channels_{};
+    std::uint64_t retired_dropped_{0};
+    std::error_code last_error_{};
+
+    std::FILE *file_{nullptr};
+    std::thread thread_{};
+
+    // 仅后台线程使用的暂存区（复用，避免每批分配）。
+    std::vector<core::byte> staging_{};
+    std::vector<std::pair<std::size_t, std::size_t>> order_{};
+
+    std::atomic<std::uint64_t> records_written_{0};
+    std::atomic<std::uint64_t> bytes_written_{0};
+};
+
+/**
+ * @brief 回放选项。
+ */
+struct ReplayOptions final {
+    // 速度倍率：1.0 按原始节奏；2.0 两倍速；<= 0 表示不等待（最大速度）。
+    double speed{1.0};
+
+    // 只回放该方向的记录。默认 rx：把当时“对端发来”的流量原样重放给被测端。
+    std::optional<CaptureDirection> direction{CaptureDirection::rx};
+
+    // 只回放该录制通道（session_id）的记录；为空表示全部。
+    std::optional<std::uint16_t> session_id{};
+};
+
+struct ReplayStats final {
+    std::uint64_t frames{0};
+    std::uint64_t bytes{0};
+    core::duration elapsed{};
+};
+
+/**
+ * @brief 把抓包记录经 conn 写出（conn 通常连到被测端，或是内存对端）。
+ *
+ * - 每帧先 decode_frame 再 async_write_message，因此复用 Connection 的写队列与指标；
+ * - 按原始节奏回放时，第 i 帧的发送时刻 = 开始时刻 + (ts_i - ts_0) / speed，
+ *   已落后于计划的帧立即发送（不累积漂移）。
+ *
+ * @return 文件损坏返回 invalid_argument；写失败返回 Connection 的错误码。
+ */
+asio::awaitable<std::pair<std::error_code, ReplayStats>>
+async_replay(Connection &conn, core::bytes_view capture, ReplayOptions options = {});
+
+} // namespace secs::hsms
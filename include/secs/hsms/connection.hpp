@@ -1,7 +1,12 @@
 #pragma once
 
+#include "secs/core/body_sink.hpp"
+#include "secs/core/memory_budget.hpp"
+#include "secs/core/body_source.hpp"
 #include "secs/core/common.hpp"
 #include "secs/core/event.hpp"
+#include "secs/core/metrics.hpp"
+#include "secs/hsms/capture.hpp"
 #include "secs/hsms/message.hpp"
 
 #include <asio/any_io_executor.hpp>
@@ -10,23 +15,79 @@
 #include <asio/ip/tcp.hpp>
 #include <asio/use_awaitable.hpp>
 
+#include <array>
 #include <deque>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <system_error>
 #include <utility>
 #include <vector>
 
 namespace secs::hsms {
 
+// 字节流后端：tcp 为 asio socket（Linux 上为 epoll reactor）；io_uring 见
+// hsms/io_uring_stream.hpp，构建未开启或内核不支持时自动回退到 tcp。
+enum class StreamBackend : std::uint8_t {
+    tcp = 0,
+    io_uring = 1,
+};
+
+// data 消息写队列优先级通道数（0 最高）；控制消息始终先于全部 data 通道。
+inline constexpr std::size_t kDataPriorityLanes = 4;
+// 未配置规则的 data 消息所在通道。
+inline constexpr std::uint8_t kDefaultDataLane = 2;
+
+// data 消息优先级规则：按 (stream, function) 把消息归入某个通道。
+// function 为空表示该 stream 的全部 function；精确 (stream, function) 规则优先于整条
+// stream 的规则，同级规则取先出现的一条。lane 超出范围时按最低优先级处理。
+struct DataPriority final {
+    std::uint8_t stream{0};
+    std::optional<std::uint8_t> function{};
+    std::uint8_t lane{kDefaultDataLane};
+};
+
 struct ConnectionOptions final {
     // T8：网络字符间隔超时（字节间隔超时）。0 表示不启用。
     core::duration t8{};
 
-    // 写队列容量上限（control_queue_ + data_queue_ 总和）。
+    // 写队列容量上限（control_queue_ + 全部 data 通道总和）。
     // 用于避免上层持续发送但对端长期不读导致队列无限增长。
     std::size_t max_queue_size{1024};
+
+    // 指标分组（可选）：非空时记录收发帧数/字节数、帧大小与写队列等待时延。
+    std::shared_ptr<core::metrics::Group> metrics{};
+
+    // 抓包通道（可选，见 hsms/capture.hpp）：非空时把收发的原始帧写入该通道。
+    std::shared_ptr<CaptureChannel> capture{};
+
+    // 由 Connection 自行创建流时（executor/socket 构造）使用的后端；注入 Stream 时忽略。
+    StreamBackend backend{StreamBackend::tcp};
+
+    // data 消息优先级规则（见 DataPriority）。例如报警 S5 放入通道 0、配方 S7 与
+    // 大 trace 放入通道 3，则排队中的 S5F1 总是先于排队中的 S7F3 写出。
+    // 注意：已开始写出的帧不会被打断（HSMS 帧不可交织），高优先级消息最多等待一帧。
+    std::vector<DataPriority> data_priorities{};
+
+    // 流式消息体（Message::body_source）每次从来源读出并写入流的分段大小。
+    // 分段缓冲由连接复用，整条大消息常驻内存的只有这一段。
+    std::size_t stream_chunk_size{64 * 1024};
+
+    // 入站 data 消息体 sink 注册（见 core::BodySinkRule）：命中规则且工厂返回非空时，
+    // 消息体按 stream_chunk_size 分段写入 sink（或直接读入其 contiguous() 区域），
+    // 不在内存中拼出完整消息体；此类消息的长度上限放宽到 kMaxStreamedPayloadSize。
+    // 工厂在读协程中同步调用，不应阻塞。
+    std::vector<core::BodySinkRule> body_sinks{};
+
+    // 进程级入站内存预算（可选，多个连接共享同一对象）：读到长度字段后先为消息体预约
+    // 字节，预算不足时暂停读取该连接（不再从 socket 取数据，对端由 TCP 窗口反压），
+    // 直到其他消息释放；预约随 Message::memory_lease 在消息析构时归还。
+    // 写入 sink 的消息体不占预算。
+    std::shared_ptr<core::MemoryBudget> memory_budget{};
+
+    // 等待预算的上限；0 表示一直等待。超时后读失败（errc::timeout），连接随之断开。
+    core::duration memory_wait{};
 };
 
 /**
@@ -53,6 +114,22 @@ public:
     virtual asio::awaitable<std::error_code>
     async_write_all(core::bytes_view src) = 0;
 
+    // 分散写：依次写出 head 与 body（语义等同于一次 async_write_all(head + body)）。
+    // 默认实现调用两次 async_write_all；支持 scatter/gather 的流应覆写为一次系统调用。
+    virtual asio::awaitable<std::error_code>
+    async_write_gather(core::bytes_view head, core::bytes_view body);
+
+    // 底层能否为单次读挂载超时（例如 io_uring 的链接超时）。返回 true 时，
+    // Connection 的 T8 直接调用 async_read_some_for，而不是并行等待读与定时器。
+    [[nodiscard]] virtual bool has_native_read_timeout() const noexcept {
+        return false;
+    }
+
+    // 带超时的 read_some：超时返回 core::errc::timeout。
+    // 默认实现忽略 timeout（仅在 has_native_read_timeout() 为 true 时被调用）。
+    virtual asio::awaitable<std::pair<std::error_code, std::size_t>>
+    async_read_some_for(core::mutable_bytes_view dst, core::duration timeout);
+
     // 若底层不支持“连接”语义（例如纯内存流），这里可以直接返回
     // invalid_argument。
     virtual asio::awaitable<std::error_code>
@@ -80,6 +157,7 @@ public:
 
     asio::awaitable<std::error_code>
     async_connect(const asio::ip::tcp::endpoint &endpoint);
+    // 关闭底层流并取消排队的写；返回时后台写协程已退出，可安全移动赋值/析构。
     asio::awaitable<std::error_code> async_close();
 
     void cancel_and_close() noexcept;
@@ -90,17 +168,46 @@ public:
     void enable_data_writes() noexcept;
     void disable_data_writes(std::error_code reason) noexcept;
 
+    // 替换指标分组（nullptr 表示关闭）；Session 接管外部注入的 Connection 时
+    // 用它把连接指标归入会话的分组。内存不足时静默关闭指标。
+    void set_metrics(std::shared_ptr<core::metrics::Group> group) noexcept;
+
+    // 替换抓包通道（nullptr 表示停止录制）。
+    void set_capture(std::shared_ptr<CaptureChannel> channel) noexcept;
+
+    // 替换 data 消息优先级规则（只影响之后入队的消息）。
+    void set_data_priorities(std::vector<DataPriority> rules) noexcept;
+
+    // 替换入站消息体 sink 注册（只影响之后开始接收的帧）。
+    void set_body_sinks(std::vector<core::BodySinkRule> rules) noexcept;
+
+    // 替换入站内存预算（只影响之后开始接收的帧）。
+    void set_memory_budget(std::shared_ptr<core::MemoryBudget> budget,
+                           core::duration wait = {}) noexcept;
+
     asio::awaitable<std::error_code> async_write_message(const Message &msg);
     asio::awaitable<std::pair<std::error_code, Message>> async_read_message();
 
 private:
     struct WriteRequest final {
+        // 消息体为普通 vector 时：完整帧（拷贝一次，调用方取消等待后仍然有效）。
         std::vector<core::byte> frame{};
+        // 消息体为 SharedBytes 时：只编码帧前缀，消息体按引用计数持有、不拷贝。
+        std::array<core::byte, kFramePrefixSize> prefix{};
+        core::SharedBytes body{};
+        bool shared{false};
+        // 消息体为流式来源时：只编码帧前缀，消息体由 writer_loop_ 分段读出写入。
+        std::shared_ptr<core::BodySource> source{};
         secs::core::Event done{};
         std::error_code ec{};
         bool is_data{false};
+        std::uint8_t lane{kDefaultDataLane};
+        core::steady_clock::time_point enqueued_at{};
     };
 
+    // 连接级指标句柄（定义见 connection.cpp；未启用指标时为空）。
+    struct Metrics;
+
     // 读取“当前帧”的指定字节数，并以 frame_started 控制 T8 的启用时机：
     // - frame_started==false：表示尚未收到该帧的任何字节（等待首字节不受 T8 限制）
     // - frame_started==true：表示该帧已开始接收（后续字节间隔受 T8 限制）
@@ -112,23 +219,45 @@ private:
 
     static std::uint32_t read_u32_be_(const core::byte *p) noexcept;
 
+    // 按 body_sinks 为入站 data 帧创建 sink；未命中/工厂返回空时 sink 为空。
+    [[nodiscard]] std::error_code open_body_sink_(const Header &h,
+                                                  std::size_t body_len,
+                                                  std::shared_ptr<core::BodySink> &sink);
+    // 把 body_len 字节的消息体读入 sink（不调用 finish/abort）。
+    asio::awaitable<std::error_code> async_read_into_sink_(core::BodySink &sink,
+                                                           std::size_t body_len,
+                                                           bool &frame_started);
+
+    // 写出“帧前缀 + 流式消息体”；失败时帧可能已部分写出，调用方需断开连接。
+    asio::awaitable<std::error_code> async_write_streamed_(core::bytes_view prefix,
+                                                           core::BodySource &source);
+
     void start_writer_();
     asio::awaitable<void> writer_loop_();
     void cancel_queued_writes_(std::error_code reason) noexcept;
     void cancel_queued_data_writes_(std::error_code reason) noexcept;
+    [[nodiscard]] std::size_t queued_writes_() const noexcept;
+    [[nodiscard]] std::uint8_t data_lane_(const Message &msg) const noexcept;
 
     std::unique_ptr<Stream> stream_;
     ConnectionOptions options_{};
+    std::shared_ptr<Metrics> metrics_{};
 
-    // 写入串行化 + 控制消息优先级：
+    // 写入串行化 + 优先级：
     // - 统一由 writer_loop_ 串行写出，避免并发 async_write 未定义行为
-    // - control_queue_ 优先于 data_queue_，避免 Deselect/Separate 等控制消息被 data
+    // - control_queue_ 优先于 data_queues_，避免 Deselect/Separate 等控制消息被 data
     //   抢占写入顺序
+    // - data_queues_ 按通道号从小到大取，通道内保持 FIFO
     secs::core::Event write_ready_{};
     std::deque<std::shared_ptr<WriteRequest>> control_queue_{};
-    std::deque<std::shared_ptr<WriteRequest>> data_queue_{};
+    std::array<std::deque<std::shared_ptr<WriteRequest>>, kDataPriorityLanes>
+        data_queues_{};
     bool writer_running_{false};
     bool data_writes_enabled_{true};
+    // 流式消息体的分段缓冲（仅 writer_loop_ 使用，跨消息复用）。
+    std::vector<core::byte> stream_chunk_{};
+    // 入站 sink 的分段缓冲（仅读协程使用，跨消息复用）。
+    std::vector<core::byte> sink_chunk_{};
 };
 
 } // namespace secs::hsms
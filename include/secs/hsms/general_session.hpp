@@ -0,0 +1,246 @@
+#pragma once
+
+#include "secs/core/common.hpp"
+#include "secs/core/event.hpp"
+#include "secs/core/pending_table.hpp"
+#include "secs/hsms/connection.hpp"
+#include "secs/hsms/message.hpp"
+#include "secs/hsms/session.hpp"
+
+#include <asio/any_io_executor.hpp>
+#include <asio/awaitable.hpp>
+#include <asio/ip/tcp.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace secs::hsms {
+
+struct GeneralSessionOptions final {
+    // 本连接承载的逻辑会话 SessionID（低 15 位有效，高位必须为 0）：
+    // - 被动端只接受列表内 SessionID 的 SELECT.req；
+    // - 主动端 async_open_active 建链后按顺序逐个 SELECT。
+    // 运行期可用 GeneralSession::add_session 追加。
+    std::vector<std::uint16_t> session_ids{};
+
+    // 定时器语义同 SessionOptions；T3/T6 按事务计，T7/T8/LINKTEST 按连接计。
+    core::duration t3{std::chrono::seconds{45}};
+    core::duration t5{std::chrono::seconds{10}};
+    core::duration t6{std::chrono::seconds{5}};
+    core::duration t7{std::chrono::seconds{10}};
+    core::duration t8{std::chrono::seconds{5}};
+
+    // 字节流后端（同 SessionOptions::stream_backend）。
+    StreamBackend stream_backend{StreamBackend::tcp};
+
+    // data 消息写队列优先级规则（同 SessionOptions::data_priorities，连接级生效）。
+    std::vector<DataPriority> data_priorities{};
+
+    // 入站 data 消息体 sink 注册（同 SessionOptions::body_sinks，连接级生效）。
+    std::vector<core::BodySinkRule> body_sinks{};
+
+    // 进程级入站内存预算与等待上限（同 SessionOptions::memory_budget/memory_wait）。
+    std::shared_ptr<core::MemoryBudget> memory_budget{};
+    core::duration memory_wait{};
+
+    // LINKTEST 是连接级的：无论承载多少逻辑会话，一条连接只跑一个周期心跳。
+    core::duration linktest_interval{};
+    std::uint32_t linktest_max_consecutive_failures{1};
+
+    bool auto_reconnect{true};
+
+    // 挂起事务上限（所有逻辑会话共享，按 SystemBytes 索引；按需分块增长，
+    // 超过 core::PendingTable 的 kMaxCapacity 时截断）。
+    std::size_t max_pending_requests{256};
+
+    ControlEventFn on_control_event{nullptr};
+    void *on_control_event_user{nullptr};
+
+    // 连接级指标与抓包（含义同 SessionOptions::metrics / capture）。
+    std::shared_ptr<core::metrics::Group> metrics{};
+    std::shared_ptr<CaptureChannel> capture{};
+
+    // 建链治理（同 SessionOptions::governor；整条连接按一次建链计）。
+    std::shared_ptr<ConnectGovernor> governor{};
+};
+
+/**
+ * @brief HSMS-GS 会话：一条连接复用多个逻辑会话（SessionID）。
+ *
+ * 与 Session（HSMS-SS）的区别：
+ * - SELECT/DESELECT/SEPARATE 的 SessionID 为目标逻辑会话，每个逻辑会话有独立的
+ *   选择状态、入站队列与 selected 事件；
+ * - reader_loop_ 按 Header::session_id 分发数据消息，未选择/未注册的 SessionID
+ *   收到数据消息时回 Reject.req（reason=4，Entity Not Selected）；
+ * - LINKTEST（SessionID=0xFFFF）与 T7/T8 仍按连接计，不随逻辑会话数增长。
+ *
+ * 线程模型与 Session 一致：假设在同一 io_context/strand 语境中使用。
+ * 每个逻辑会话可各自绑定一个 protocol::Session（见 protocol/session.hpp）。
+ */
+class GeneralSession final {
+public:
+    explicit GeneralSession(asio::any_io_executor ex,
+                            GeneralSessionOptions options);
+
+    [[nodiscard]] asio::any_io_executor executor() const noexcept {
+        return executor_;
+    }
+
+    // 连接是否已建立（不代表任何逻辑会话已 selected）。
+    [[nodiscard]] bool is_connected() const noexcept { return connected_; }
+
+    // 逻辑会话状态；未注册的 SessionID 返回 disconnected。
+    [[nodiscard]] SessionState state(std::uint16_t session_id) const noexcept;
+    [[nodiscard]] bool is_selected(std::uint16_t session_id) const noexcept {
+        return state(session_id) == SessionState::selected;
+    }
+    [[nodiscard]] std::size_t selected_count() const noexcept;
+
+    [[nodiscard]] std::uint32_t allocate_system_bytes() noexcept {
+        return system_bytes_.fetch_add(1U);
+    }
+
+    // 注册逻辑会话（已注册时直接返回成功）；SessionID 高位为 1 时返回 invalid_argument。
+    // 连接已建立时新会话处于 NOT_SELECTED，需要 async_select 或等待对端 SELECT。
+    std::error_code add_session(std::uint16_t session_id);
+
+    void stop() noexcept;
+
+    // 唤醒在该 SessionID 上等待 async_receive_data 的协程（返回 cancelled）；
+    // 不影响连接与其它逻辑会话（protocol::Session::stop 使用）。
+    void cancel_receive(std::uint16_t session_id) noexcept;
+
+    // 主动端：建链后依次 SELECT 全部已注册 SessionID；任一失败则断线并返回错误。
+    asio::awaitable<std::error_code>
+    async_open_active(const asio::ip::tcp::endpoint &endpoint);
+    asio::awaitable<std::error_code> async_open_active(Connection &&connection);
+
+    // 被动端：等待任一逻辑会话被 SELECT（T7）。
+    asio::awaitable<std::error_code>
+    async_open_passive(asio::ip::tcp::socket socket);
+    asio::awaitable<std::error_code>
+    async_open_passive(Connection &&connection);
+
+    // 主动端自动重连主循环（语义同 Session::async_run_active）。
+    asio::awaitable<std::error_code>
+    async_run_active(const asio::ip::tcp::endpoint &endpoint);
+    asio::awaitable<std::error_code> async_run_active(ConnectFn connect);
+
+    // 单个逻辑会话的控制事务（T6）。已 selected 时 async_select 直接返回成功；
+    // 对端拒绝时返回 invalid_argument，但不影响连接与其它逻辑会话。
+    asio::awaitable<std::error_code> async_select(std::uint16_t session_id);
+    asio::awaitable<std::error_code> async_deselect(std::uint16_t session_id);
+    // 发送 Separate.req 并立即把该逻辑会话退回 NOT_SELECTED（无响应）。
+    asio::awaitable<std::error_code> async_separate(std::uint16_t session_id);
+
+    // 发送任意消息；数据消息要求 header.session_id 对应的逻辑会话已 selected。
+    asio::awaitable<std::error_code> async_send(const Message &msg);
+
+    // 等待该逻辑会话的下一条数据消息。
+    asio::awaitable<std::pair<std::error_code, Message>>
+    async_receive_data(std::uint16_t session_id,
+                       std::optional<core::duration> timeout = std::nullopt);
+
+    // 批量接收（语义同 Session::async_receive_data_batch）。
+    asio::awaitable<std::pair<std::error_code, std::deque<Message>>>
+    async_receive_data_batch(std::uint16_t session_id,
+                             std::size_t max_n,
+                             std::optional<core::duration> timeout = std::nullopt);
+
+    // 在该逻辑会话上发送 W=1 主消息并等待回应（timeout 为空时使用 T3）。
+    asio::awaitable<std::pair<std::error_code, Message>>
+    async_request_data(std::uint16_t session_id,
+                       std::uint8_t stream,
+                       std::uint8_t function,
+                       core::bytes_view body,
+                       std::optional<core::duration> timeout = std::nullopt);
+
+    // 连接级 LINKTEST（SessionID=0xFFFF，T6）。
+    asio::awaitable<std::error_code> async_linktest();
+
+    asio::awaitable<std::error_code>
+    async_wait_selected(std::uint16_t session_id, core::duration timeout);
+
+    asio::awaitable<std::error_code> async_wait_reader_stopped(
+        std::optional<core::duration> timeout = std::nullopt);
+
+private:
+    // 逻辑会话（注册后不删除，指针在 GeneralSession 生命周期内稳定）。
+    struct Entity final {
+        explicit Entity(std::uint16_t id) : session_id(id) {}
+
+        std::uint16_t session_id;
+        SessionState state{SessionState::disconnected};
+        secs::core::Event selected_event{};
+        std::deque<Message> inbound{};
+        secs::core::Event inbound_event{};
+    };
+
+    struct Pending final {
+        Pending(SType expected, std::uint16_t sid)
+            : expected_stype(expected), session_id(sid) {}
+
+        SType expected_stype;
+        std::uint16_t session_id;
+        secs::core::Event ready{};
+        std::error_code ec{};
+        std::optional<Message> response{};
+    };
+    using PendingHandle = core::PendingTable<Pending>::Handle;
+
+    [[nodiscard]] Entity *find_(std::uint16_t session_id) const noexcept;
+
+    void reset_state_() noexcept;
+    void set_selected_(Entity &entity) noexcept;
+    void set_not_selected_(Entity &entity) noexcept;
+    void on_disconnected_(std::error_code reason) noexcept;
+    void emit_control_event_(ControlDirection direction,
+                             const Message &msg) noexcept;
+
+    asio::awaitable<std::error_code> adopt_connection_(Connection &&connection);
+    void start_reader_();
+    asio::awaitable<void> reader_loop_();
+    asio::awaitable<void> handle_data_(Message msg);
+    asio::awaitable<void> write_control_(const Message &msg);
+    asio::awaitable<void> linktest_loop_(std::uint64_t generation);
+
+    asio::awaitable<std::pair<std::error_code, Message>>
+    async_transaction_(const Message &req, SType expected_rsp, core::duration timeout);
+
+    [[nodiscard]] bool fulfill_pending_(Message &msg) noexcept;
+    void cancel_pending_(std::uint16_t session_id, std::error_code reason) noexcept;
+
+    asio::awaitable<std::error_code> async_open_active_with_(const ConnectFn &connect);
+    asio::awaitable<std::error_code> async_sleep_(core::duration d);
+    [[nodiscard]] core::duration reconnect_delay_(std::uint32_t failures) noexcept;
+
+    asio::any_io_executor executor_;
+    GeneralSessionOptions options_{};
+
+    Connection connection_;
+    std::atomic<std::uint32_t> system_bytes_{1};
+
+    std::unordered_map<std::uint16_t, std::unique_ptr<Entity>> entities_{};
+
+    bool connected_{false};
+    bool stop_requested_{false};
+    bool reader_running_{false};
+    std::uint64_t connection_generation_{0};
+
+    secs::core::Event any_selected_event_{};
+    secs::core::Event disconnected_event_{};
+    secs::core::Event reader_stopped_event_{};
+    secs::core::Event stop_event_{};
+
+    core::PendingTable<Pending> pending_;
+};
+
+} // namespace secs::hsms
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "secs/core/common.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+
+namespace secs::hsms {
+
+/*
+ * 建链治理（reconnect storm control）。
+ *
+ * 现场网络抖动时，同一进程里的数百个主动端 Session 会在同一时刻断线、又在
+ * T5 后同一时刻重连 + SELECT，造成 CPU 尖峰并压垮设备端。ConnectGovernor 在
+ * 进程内共享（多个 Session/GeneralSession 持有同一个 shared_ptr），提供两件事：
+ *
+ * 1) 令牌桶：每次“连接 + SELECT”尝试前 reserve() 一个令牌，限制进程整体建链速率；
+ *    令牌可以透支，并发预约者被排到依次靠后的时间点，而不是同时醒来再争抢。
+ * 2) 退避：连续失败/断线后的重连延迟在 T5 基础上指数增长并加抖动，把同一时刻
+ *    掉线的会话打散。
+ *
+ * 线程模型：所有成员函数线程安全（内部互斥），不绑定 executor；等待由调用方
+ * （Session 自己的定时器）完成。
+ */
+
+struct ConnectGovernorOptions final {
+    // 令牌桶：每秒补充的建链令牌数（一次“连接 + SELECT”消耗一个）；<= 0 表示不限速。
+    double rate_per_second{10.0};
+    // 桶容量：允许的突发建链数（至少为 1）。
+    std::uint32_t burst{5};
+
+    // 第 n 次连续失败后的基准延迟 = min(T5 * backoff_multiplier^(n-1), max_backoff)。
+    double backoff_multiplier{2.0};
+    core::duration max_backoff{std::chrono::minutes{2}};
+
+    // 抖动比例 [0, 1]：实际延迟在 [d * (1 - jitter), d] 内均匀取值
+    // （0 表示不抖动；1 为 full jitter）。
+    double jitter{0.5};
+
+    // 抖动随机数种子（0 表示使用 std::random_device）；固定种子得到可复现的序列。
+    std::uint64_t seed{0};
+
+    // 时钟（可选，测试注入）；为空时使用 core::steady_clock::now。
+    std::function<core::steady_clock::time_point()> clock{};
+};
+
+/**
+ * @brief 进程级建链治理器：令牌桶限速 + 指数退避抖动。
+ */
+class ConnectGovernor final {
+public:
+    explicit ConnectGovernor(ConnectGovernorOptions options = {});
+
+    ConnectGovernor(const ConnectGovernor &) = delete;
+    ConnectGovernor &operator=(const ConnectGovernor &) = delete;
+
+    // 预约一个建链令牌，返回调用方在发起连接前需要等待的时长（0 表示立即可用）。
+    [[nodiscard]] core::duration reserve() noexcept;
+
+    // 第 failures（>= 1）次连续失败/断线后的重连延迟（以 base 即 T5 为基准，含抖动）。
+    [[nodiscard]] core::duration backoff(core::duration base,
+                                         std::uint32_t failures) noexcept;
+
+    // 统计：发出的令牌数、其中需要等待（被限速）的次数。
+    [[nodiscard]] std::uint64_t granted() const noexcept;
+    [[nodiscard]] std::uint64_t throttled() const noexcept;
+
+private:
+    [[nodiscard]] core::steady_clock::time_point now_() const;
+
+    ConnectGovernorOptions options_{};
+
+    mutable std::mutex mu_{};
+    double tokens_{0.0};
+    core::steady_clock::time_point last_refill_{};
+    std::mt19937_64 rng_{};
+    std::uint64_t granted_{0};
+    std::uint64_t throttled_{0};
+};
+
+} // namespace secs::hsms
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "secs/hsms/connection.hpp"
+
+#include <asio/any_io_executor.hpp>
+#include <asio/awaitable.hpp>
+#include <asio/ip/tcp.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <system_error>
+#include <utility>
+
+namespace secs::hsms {
+
+/**
+ * @brief 基于 io_uring 的 HSMS 字节流（仅 Linux，可选）。
+ *
+ * 构建：CMake 选项 SECS_ENABLE_IO_URING=ON 时编译真实实现（宏 SECS_HAS_IO_URING）；
+ * 未开启、非 Linux、或运行时内核不支持/禁用 io_uring 时，本文件中的工厂函数返回
+ * function_not_supported。Connection/Session 通过 ConnectionOptions::backend 选择
+ * io_uring 时会自动回退到默认的 TCP（epoll）实现。
+ *
+ * 与默认 TcpStream 的差异：
+ * - 每个 execution_context 共用一个 ring：同一轮事件循环内各连接的提交合并为一次
+ *   io_uring_enter，完成事件经 eventfd 回到 io_context；
+ * - 读：每个连接从 ring 的注册缓冲区（IORING_REGISTER_BUFFERS）分得一个槽，
+ *   READ_FIXED 一次尽量多读，HSMS 的 4B 长度 / 10B 头部等小读直接从槽中取走；
+ *   槽用尽时退回连接私有缓冲的普通读；
+ * - T8：读请求与 IORING_OP_LINK_TIMEOUT 链接提交，超时由内核取消读请求，
+ *   Connection 不再需要“读 + 定时器”并行等待；
+ * - 写：SEND/SENDMSG 直接从调用方内存发送（保持 SharedBytes 零拷贝写出路径）。
+ *
+ * 与 TcpStream 相同，单个流假设在同一执行器语境中使用（单读 + 单写）。
+ */
+struct IoUringOptions final {
+    // SQ 深度（内核会钳制到上限；CQ 深度为其 2 倍）。
+    std::uint32_t entries{4096};
+    // 注册缓冲：槽数量（每连接占一个）与每槽字节数。
+    // 注册内存受 RLIMIT_MEMLOCK 约束，注册失败时所有连接退回普通读。
+    std::size_t registered_slots{1024};
+    std::size_t slot_size{4096};
+};
+
+// 运行时探测：构建开启且内核允许创建 io_uring 实例时返回 true。
+[[nodiscard]] bool io_uring_available() noexcept;
+
+// 设置 ex 所属 execution_context 的 ring 参数；必须在该 context 上创建第一个
+// io_uring 流/acceptor 之前调用，ring 已创建时返回 invalid_argument。
+std::error_code configure_io_uring(const asio::any_io_executor &ex,
+                                   IoUringOptions options) noexcept;
+
+// 创建未连接的流（async_connect 时按端点族创建 socket）。
+std::error_code make_io_uring_stream(asio::any_io_executor ex,
+                                     std::unique_ptr<Stream> &out) noexcept;
+
+// 接管已连接的 asio socket；仅在成功时取走 socket（socket 随后处于关闭状态），
+// 失败时 socket 保持不变，调用方可继续按 TCP 使用。
+std::error_code make_io_uring_stream(asio::ip::tcp::socket &socket,
+                                     std::unique_ptr<Stream> &out) noexcept;
+
+/**
+ * @brief 基于 io_uring multishot accept 的监听器。
+ *
+ * 一个 multishot accept 请求持续产出新连接（内核不支持时退回逐个 accept）；
+ * async_accept() 从已就绪的连接中取出一个，并包装为 io_uring 流。
+ */
+class IoUringAcceptor final {
+public:
+    explicit IoUringAcceptor(asio::any_io_executor ex);
+    ~IoUringAcceptor();
+
+    IoUringAcceptor(const IoUringAcceptor &) = delete;
+    IoUringAcceptor &operator=(const IoUringAcceptor &) = delete;
+
+    // 创建监听 socket（SO_REUSEADDR）并 bind + listen。
+    std::error_code listen(const asio::ip::tcp::endpoint &endpoint,
+                           int backlog = 128) noexcept;
+
+    // 监听地址（端口 0 时返回内核分配的端口）；未监听时返回默认端点。
+    [[nodiscard]] asio::ip::tcp::endpoint local_endpoint() const noexcept;
+    [[nodiscard]] bool is_open() const noexcept;
+
+    asio::awaitable<std::pair<std::error_code, std::unique_ptr<Stream>>>
+    async_accept();
+
+    // 取消挂起的 accept（返回 cancelled）并关闭监听 socket 与未取走的连接。
+    void close() noexcept;
+
+private:
+    struct State;
+
+    asio::any_io_executor executor_;
+    std::shared_ptr<State> state_;
+};
+
+} // namespace secs::hsms
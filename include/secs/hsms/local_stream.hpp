@@ -0,0 +1,81 @@
+#pragma once
+
+#include "secs/hsms/connection.hpp"
+
+#include <asio/any_io_executor.hpp>
+#include <asio/awaitable.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace secs::hsms {
+
+/**
+ * @brief 同机进程间的 HSMS 字节流（仅 POSIX）。
+ *
+ * 两种传输都以 Unix 域 socket 路径作为“地址”，由 LocalAcceptor 监听、
+ * async_connect_local 连接：
+ * - unix_socket：HSMS 帧直接走 Unix 域 socket（AF_UNIX/SOCK_STREAM），省去 TCP/IP 协议栈；
+ * - shared_memory：建链时被动端创建一段共享内存（Linux 为 memfd），经 SCM_RIGHTS
+ *   交给主动端；之后两个方向各一个 SPSC 字节环，读写只做一次 memcpy。
+ *   Unix 域 socket 只作门铃：读端/写端在环空/环满时挂起前置“等待”标志，对端推进
+ *   tail/head 后看到标志才写 1 字节唤醒；对端进程退出时同一 socket 读到 EOF。
+ *
+ * 两端必须使用相同的 transport；共享内存环容量由被动端决定。
+ * 与 TcpStream 相同，单个流假设在同一执行器语境中使用（单读 + 单写）。
+ * 非 POSIX 平台上各入口返回 function_not_supported。
+ */
+enum class LocalTransport : std::uint8_t {
+    unix_socket = 0,
+    shared_memory = 1,
+};
+
+struct LocalEndpoint final {
+    // Unix 域 socket 路径（Linux 下以 '\0' 开头表示抽象命名空间）。
+    std::string path{};
+    LocalTransport transport{LocalTransport::unix_socket};
+    // shared_memory：每个方向的环容量（字节，向上取 2 的幂，至少 4KiB）；
+    // 仅被动端（LocalAcceptor）使用，主动端以握手收到的共享内存为准。
+    std::size_t ring_capacity{std::size_t{1} << 20};
+};
+
+// 连接 endpoint.path；shared_memory 时还会完成共享内存握手。
+asio::awaitable<std::pair<std::error_code, std::unique_ptr<Stream>>>
+async_connect_local(asio::any_io_executor ex, const LocalEndpoint &endpoint);
+
+/**
+ * @brief 本机传输的监听器。
+ *
+ * listen() 时若路径上残留旧的 socket 文件（探测 connect 被拒绝，即无人监听）会先删除；
+ * 仍有进程在监听时返回 address_in_use。close()/析构时删除自己创建的文件。
+ */
+class LocalAcceptor final {
+public:
+    explicit LocalAcceptor(asio::any_io_executor ex);
+    ~LocalAcceptor();
+
+    LocalAcceptor(const LocalAcceptor &) = delete;
+    LocalAcceptor &operator=(const LocalAcceptor &) = delete;
+
+    std::error_code listen(const LocalEndpoint &endpoint, int backlog = 128) noexcept;
+    [[nodiscard]] bool is_open() const noexcept;
+
+    // 接受一个连接；shared_memory 时在返回前完成共享内存握手。
+    asio::awaitable<std::pair<std::error_code, std::unique_ptr<Stream>>>
+    async_accept();
+
+    // 取消挂起的 accept 并关闭监听 socket。
+    void close() noexcept;
+
+private:
+    struct State;
+
+    asio::any_io_executor executor_;
+    std::unique_ptr<State> state_;
+};
+
+} // namespace secs::hsms
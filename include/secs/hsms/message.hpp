@@ -1,10 +1,17 @@
 #pragma once
 
+#include "secs/core/body_sink.hpp"
+#include "secs/core/memory_budget.hpp"
+#include "secs/core/body_source.hpp"
 #include "secs/core/common.hpp"
 #include "secs/core/error.hpp"
+#include "secs/core/shared_bytes.hpp"
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <memory>
 #include <system_error>
 #include <vector>
 
@@ -12,11 +19,17 @@ namespace secs::hsms {
 
 inline constexpr std::size_t kLengthFieldSize = 4;
 inline constexpr std::size_t kHeaderSize = 10;
+// 帧前缀：长度字段 + 头部；发送方可在消息体前预留该大小的 headroom 以便连续写出。
+inline constexpr std::size_t kFramePrefixSize = kLengthFieldSize + kHeaderSize;
 inline constexpr std::uint8_t kPTypeSecs2 = 0x00;
 // HSMS 负载（头部 +
 // 消息体）长度来自网络输入；需要上限避免恶意长度字段触发巨量分配。
 inline constexpr std::uint32_t kMaxPayloadSize =
     16u * 1024u * 1024u; // 16MB 上限
+// 流式消息体的上限：只受 4B 长度字段限制。发送（Message::body_source）时注意对端
+// 需能接收超过 kMaxPayloadSize 的帧；接收时只有命中 sink 注册的 data 消息可超过
+// kMaxPayloadSize（见 ConnectionOptions::body_sinks）。
+inline constexpr std::uint32_t kMaxStreamedPayloadSize = 0xFFFFFFFFu;
 
 enum class SType : std::uint8_t {
     data = 0x00,
@@ -61,6 +74,31 @@ struct Header final {
 struct Message final {
     Header header{};
     std::vector<core::byte> body{};
+    // 发送路径可选：非空时代替 body 作为消息体（引用计数共享，不拷贝）；
+    // 接收路径填充 body（或 body_sink）。
+    core::SharedBytes shared_body{};
+    // 发送路径可选：非空时消息体由该来源流式写出（长度取 body_source->size()，
+    // 内容不经过内存中的完整缓冲），优先于 shared_body/body。
+    std::shared_ptr<core::BodySource> body_source{};
+    // 接收路径可选：消息体已按注册的 sink 写出（body 为空，长度见 body_size()）。
+    std::shared_ptr<core::BodySink> body_sink{};
+    // 接收路径可选：消息体占用的入站内存预算（见 ConnectionOptions::memory_budget），
+    // 最后一个持有者析构时归还。
+    core::MemoryLease memory_lease{};
+
+    // 实际要编码/写出的消息体（流式消息体为空视图，见 body_size()）。
+    [[nodiscard]] core::bytes_view body_view() const noexcept {
+        return shared_body.empty() ? core::bytes_view{body.data(), body.size()}
+                                   : shared_body.view();
+    }
+
+    // 消息体长度（含流式消息体）。
+    [[nodiscard]] std::size_t body_size() const noexcept {
+        if (body_source) {
+            return body_source->size();
+        }
+        return body_sink ? body_sink->size() : body_view().size();
+    }
 
     [[nodiscard]] bool is_data() const noexcept {
         return header.s_type == SType::data;
@@ -111,15 +149,37 @@ struct Message final {
                                         bool w_bit,
                                         std::uint32_t system_bytes,
                                         core::bytes_view body);
+// 同上，但消息体以共享缓冲承载（只增加引用计数，不拷贝）。
+[[nodiscard]] Message make_data_message_shared(std::uint16_t session_id,
+                                               std::uint8_t stream,
+                                               std::uint8_t function,
+                                               bool w_bit,
+                                               std::uint32_t system_bytes,
+                                               core::SharedBytes body);
+// 同上，但消息体由 source 流式提供（只能通过 Connection 写出，不能 encode_frame）。
+[[nodiscard]] Message make_data_message_streamed(std::uint16_t session_id,
+                                                 std::uint8_t stream,
+                                                 std::uint8_t function,
+                                                 bool w_bit,
+                                                 std::uint32_t system_bytes,
+                                                 std::shared_ptr<core::BodySource> source);
 
 // 编码：输出完整 TCP 帧（长度字段 4B + 头部 10B + 消息体）。
 // 注意：
-// - 该函数会校验 payload 上限（kMaxPayloadSize）与 PType（仅支持 0x00=SECS-II）。
+// - 该函数会校验 payload 上限（kMaxPayloadSize）与 PType（仅支持 0x00=SECS-II）；
+//   流式消息体（body_source）返回 invalid_argument。
 // - 如需拿到错误码，请优先使用带 out 参数的重载。
 std::error_code encode_frame(const Message &msg,
                              std::vector<core::byte> &out) noexcept;
 [[nodiscard]] std::vector<core::byte> encode_frame(const Message &msg);
 
+// 编码：只输出帧前缀（长度字段 4B + 头部 10B），消息体由调用方随后写出
+// （分散写/headroom 连续写/流式写）。校验规则与 encode_frame 相同，
+// 流式消息体的上限为 kMaxStreamedPayloadSize。
+std::error_code encode_frame_prefix(
+    const Message &msg,
+    std::array<core::byte, kFramePrefixSize> &out) noexcept;
+
 // 解码：输入完整 TCP 帧（含 4B 长度字段），若成功 consumed 为该帧总长度。
 std::error_code decode_frame(core::bytes_view frame,
                              Message &out,
@@ -128,4 +188,13 @@ std::error_code decode_frame(core::bytes_view frame,
 // 解码：仅解析负载（头部 10B + 消息体），用于连接层读到长度字段后的解析。
 std::error_code decode_payload(core::bytes_view payload, Message &out) noexcept;
 
+// 解码：仅解析 10B 头部字节（不校验 PType/SType），例如 Reject.req 消息体回显的
+// 被拒绝消息头。bytes 不足 10B 时返回 invalid_argument，多余字节忽略。
+std::error_code decode_header(core::bytes_view bytes, Header &out) noexcept;
+
+// 从入站队列头部取走至多 max_n 条消息（max_n==0 或不小于队列长度时整体交换，O(1)）。
+// 供 Session/GeneralSession 的批量接收使用。
+[[nodiscard]] std::deque<Message> take_message_batch(std::deque<Message> &queue,
+                                                     std::size_t max_n);
+
 } // namespace secs::hsms
@@ -2,7 +2,10 @@
 
 #include "secs/core/common.hpp"
 #include "secs/core/event.hpp"
+#include "secs/core/pending_table.hpp"
 #include "secs/hsms/connection.hpp"
+#include "secs/hsms/governor.hpp"
+#include "secs/hsms/local_stream.hpp"
 #include "secs/hsms/message.hpp"
 
 #include <asio/any_io_executor.hpp>
@@ -13,11 +16,13 @@
 #include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <system_error>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace secs::hsms {
 
@@ -58,6 +63,12 @@ struct ControlEvent final {
 using ControlEventFn =
     void (*)(void *user, const ControlEvent &ev) noexcept;
 
+// 主动端建链回调（async_run_active 每次尝试调用一次）：在传入的 Connection 上建立
+// 底层连接（例如 async_connect(endpoint)），或把它替换为注入 Stream 的 Connection
+// （纯内存测试）。返回非空 error_code 表示本次建链失败。
+using ConnectFn =
+    std::function<asio::awaitable<std::error_code>(Connection &connection)>;
+
 struct SessionOptions final {
     // HSMS-SS：data message 的 SessionID（Device ID，低 15 位有效）。
     // 控制消息（SELECT/LINKTEST/SEPARATE 等）SessionID 固定为 0xFFFF。
@@ -73,6 +84,22 @@ struct SessionOptions final {
         std::chrono::seconds{10}}; // T7：未 selected 超时（被动端等待 SELECT）
     core::duration t8{std::chrono::seconds{5}}; // T8：网络字符间隔超时
 
+    // 字节流后端（见 ConnectionOptions::backend）；io_uring 不可用时自动回退到 tcp。
+    StreamBackend stream_backend{StreamBackend::tcp};
+
+    // data 消息写队列优先级规则（见 ConnectionOptions::data_priorities）；
+    // 非空时也覆盖接管的外部 Connection 的规则。
+    std::vector<DataPriority> data_priorities{};
+
+    // 入站 data 消息体 sink 注册（见 ConnectionOptions::body_sinks）；
+    // 非空时也覆盖接管的外部 Connection 的注册。
+    std::vector<core::BodySinkRule> body_sinks{};
+
+    // 进程级入站内存预算与等待上限（见 ConnectionOptions::memory_budget/memory_wait）；
+    // 非空时也覆盖接管的外部 Connection 的设置。
+    std::shared_ptr<core::MemoryBudget> memory_budget{};
+    core::duration memory_wait{};
+
     // 链路测试（LINKTEST）周期（0 表示不自动发送）。
     core::duration linktest_interval{};
     // Linktest 连续失败阈值：达到阈值后断线（默认 1：一次失败即断线，保持当前行为）。
@@ -85,7 +112,8 @@ struct SessionOptions final {
 
     // 挂起事务（system_bytes -> Pending）上限：
     // - 主要用于限制并发 async_request_data/async_linktest 等事务数；
-    // - 达到上限时，事务类 API 会快速失败，避免 pending_ 无界增长。
+    // - 达到上限时，事务类 API 会快速失败，避免 pending_ 无界增长；
+    // - 只是上限：挂起表按需分块增长；超过 core::PendingTable 的 kMaxCapacity 时截断。
     std::size_t max_pending_requests{256};
 
     // 控制消息观测回调（可选）：
@@ -93,6 +121,19 @@ struct SessionOptions final {
     // - 仅用于联调/统计，不建议在回调内执行阻塞或重入 Session API。
     ControlEventFn on_control_event{nullptr};
     void *on_control_event_user{nullptr};
+
+    // 指标分组（可选，见 core::metrics）：非空时记录事务数/超时数、T3/T6 往返
+    // 时延、选择/断线次数；Session 建立或接管的 Connection 也会记入同一分组。
+    std::shared_ptr<core::metrics::Group> metrics{};
+
+    // 抓包通道（可选，见 hsms/capture.hpp）：Session 建立的 Connection 录制到该通道；
+    // 接管外部 Connection 时仅在非空时覆盖其原有通道。重连复用同一通道。
+    std::shared_ptr<CaptureChannel> capture{};
+
+    // 建链治理（可选，见 hsms/governor.hpp）：多个 Session 共享同一个实例时，
+    // async_run_active 每次建链前按令牌桶限速，断线/失败后的重连延迟在 T5 基础上
+    // 指数退避并加抖动。为空时保持固定 T5 重连。
+    std::shared_ptr<ConnectGovernor> governor{};
 };
 
 /**
@@ -102,11 +143,24 @@ struct SessionOptions final {
  * - 连接层（Connection）只做分帧（framing）与读写；Session
  * 做协议控制流与定时器策略。
  * - 不引入额外依赖，错误通过 std::error_code 返回。
+ *
+ * 线程模型：会话绑定一个 strand（传入的执行器已是 strand 时直接复用，否则在其上
+ * 新建），内部协程与状态只在该 strand 上运行/访问。所有 async_* 入口若不在 strand
+ * 上调用，会先派生到 strand 上执行、完成后回到调用方执行器（stop() 例外，见其注释）。
+ * 因此多个 Session 可以分布在同一个多线程 io_context 上。
+ * 注意：注入的 Connection/Stream/socket 应在 executor() 上创建（例如
+ * acceptor.async_accept(session.executor(), ...)），其读写协程跟随自身执行器。
  */
 class Session final {
 public:
+    // ex：会话使用的执行器（可为多线程 io_context 的执行器，见“线程模型”）。
     explicit Session(asio::any_io_executor ex, SessionOptions options);
+    ~Session();
+
+    Session(const Session &) = delete;
+    Session &operator=(const Session &) = delete;
 
+    // 会话 strand（protocol::Session 等上层组件复用它，避免二次切换）。
     [[nodiscard]] asio::any_io_executor executor() const noexcept {
         return executor_;
     }
@@ -122,8 +176,15 @@ public:
         return system_bytes_.fetch_add(1U);
     }
 
+    // 停止会话：置位停止标志并关闭连接。
+    // - 在会话 strand 上调用：同步完成断线通知（挂起事务、等待者立即被唤醒）；
+    // - 在 strand 外调用：同步关闭连接，断线通知延后到 strand 上执行（Session 先析构
+    //   时跳过；io_context 不再运行时不会执行）。需要等待停止完成时用 async_stop()。
     void stop() noexcept;
 
+    // 可在任意执行器上 co_await 的 stop()：切到 strand 上同步完成停止流程后返回。
+    asio::awaitable<std::error_code> async_stop();
+
     asio::awaitable<std::error_code>
     async_open_active(const asio::ip::tcp::endpoint &endpoint);
     asio::awaitable<std::error_code> async_open_active(Connection &&connection);
@@ -132,9 +193,19 @@ public:
     asio::awaitable<std::error_code>
     async_open_passive(Connection &&connection);
 
+    // 同机进程（见 hsms/local_stream.hpp）：主动端按 endpoint 连接 Unix 域 socket /
+    // 共享内存；被动端接管 LocalAcceptor（或任意工厂）产出的 Stream。
+    // 两者都按本会话的 T8/指标/抓包配置建立 Connection。
+    asio::awaitable<std::error_code> async_open_active(const LocalEndpoint &endpoint);
+    asio::awaitable<std::error_code>
+    async_open_passive(std::unique_ptr<Stream> stream);
+
     // 主动端自动重连主循环：直到 stop()，或 auto_reconnect==false 且发生断线。
     asio::awaitable<std::error_code>
     async_run_active(const asio::ip::tcp::endpoint &endpoint);
+    asio::awaitable<std::error_code> async_run_active(const LocalEndpoint &endpoint);
+    // 同上，但每次建链由 connect 完成（自定义拨号、纯内存 Stream 测试等）。
+    asio::awaitable<std::error_code> async_run_active(ConnectFn connect);
 
     asio::awaitable<std::error_code> async_send(const Message &msg);
 
@@ -142,6 +213,12 @@ public:
     asio::awaitable<std::pair<std::error_code, Message>>
     async_receive_data(std::optional<core::duration> timeout = std::nullopt);
 
+    // 批量接收：等待至少一条数据消息，然后一次取走已就绪的至多 max_n 条
+    // （max_n==0 表示不限；取走整个队列时为 O(1) 交换）。按到达顺序返回。
+    asio::awaitable<std::pair<std::error_code, std::deque<Message>>>
+    async_receive_data_batch(std::size_t max_n,
+                             std::optional<core::duration> timeout = std::nullopt);
+
     // 发送数据主消息（W=1），并等待同 SystemBytes 的数据消息作为回应（T3）。
     asio::awaitable<std::pair<std::error_code, Message>> async_request_data(
         std::uint8_t stream, std::uint8_t function, core::bytes_view body);
@@ -175,14 +252,33 @@ private:
         std::error_code ec{};
         std::optional<Message> response{};
     };
+    using PendingHandle = core::PendingTable<Pending>::Handle;
+
+    // 会话级指标句柄（定义见 session.cpp；未启用指标时为空）。
+    struct Metrics;
+
+    // stop() 在 strand 外投递的回调通过它访问会话：析构时在锁内置空。
+    struct StopGuard final {
+        std::mutex mu;
+        Session *self{nullptr};
+    };
 
     void reset_state_() noexcept;
     void set_selected_() noexcept;
     void set_not_selected_() noexcept;
     void on_disconnected_(std::error_code reason) noexcept;
+    void stop_on_strand_() noexcept;
     void emit_control_event_(ControlDirection direction,
                              const Message &msg) noexcept;
 
+    [[nodiscard]] ConnectionOptions connection_options_() const;
+
+    // 建链一次：connect 建立底层连接后执行 SELECT（同 async_open_active）。
+    asio::awaitable<std::error_code> async_open_active_with_(const ConnectFn &connect);
+    // 可被 stop() 打断的等待（重连退避/限速）；被打断返回 cancelled。
+    asio::awaitable<std::error_code> async_sleep_(core::duration d);
+    [[nodiscard]] core::duration reconnect_delay_(std::uint32_t failures) noexcept;
+
     void start_reader_();
     asio::awaitable<void> reader_loop_();
     asio::awaitable<void> linktest_loop_(std::uint64_t generation);
@@ -197,28 +293,36 @@ private:
 
     [[nodiscard]] bool fulfill_pending_(Message &msg) noexcept;
     void cancel_pending_data_(std::error_code reason) noexcept;
+    [[nodiscard]] std::pair<std::error_code, Message>
+    finish_pending_(PendingHandle handle, std::error_code wait_ec) noexcept;
 
     asio::any_io_executor executor_;
     SessionOptions options_{};
+    std::shared_ptr<Metrics> metrics_{};
 
     Connection connection_;
 
     std::atomic<std::uint32_t> system_bytes_{1};
 
-    SessionState state_{SessionState::disconnected};
+    // state_/stop_requested_ 允许在 strand 外读取（state()/stop()），其余状态只在 strand 上访问。
+    std::atomic<SessionState> state_{SessionState::disconnected};
     std::atomic<std::uint64_t> selected_generation_{0};
 
-    bool stop_requested_{false};
+    std::atomic<bool> stop_requested_{false};
     bool reader_running_{false};
 
     secs::core::Event selected_event_{};
     secs::core::Event disconnected_event_{};
     secs::core::Event reader_stopped_event_{};
+    secs::core::Event stop_event_{};
 
     std::deque<Message> inbound_data_{};
     secs::core::Event inbound_event_{};
 
-    std::unordered_map<std::uint32_t, std::shared_ptr<Pending>> pending_{};
+    // 挂起事务表（容量上限 = max_pending_requests，按需分块增长）。
+    core::PendingTable<Pending> pending_;
+
+    std::shared_ptr<StopGuard> stop_guard_;
 };
 
 } // namespace secs::hsms
@@ -2,11 +2,20 @@
 
 #include "secs/ii/item.hpp"
 
+#include <bit>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <string_view>
 #include <system_error>
+#include <type_traits>
 #include <vector>
 
+namespace secs::core {
+class MemoryBudget;
+class MemoryReservation;
+} // namespace secs::core
+
 namespace secs::ii {
 
 enum class errc : int {
@@ -50,6 +59,11 @@ struct DecodeLimits final {
 
     // 整棵树的 payload 总字节数上限（仅累计非 List 的 payload bytes）。
     std::size_t max_total_bytes{64u * 1024u * 1024u}; // 64MB
+
+    // 进程级内存预算（可选，见 core::MemoryBudget）：非空时解码出的节点与 payload
+    // 先从预算预约，预算不足返回 errc::out_of_memory。预约随哪个对象释放取决于
+    // decode_one 的重载（见下）。
+    std::shared_ptr<core::MemoryBudget> memory_budget{};
 };
 
 /**
@@ -89,12 +103,149 @@ decode_one(bytes_view in, Item &out, std::size_t &consumed) noexcept;
 
 /**
  * @brief 从输入缓冲区解码一个 Item（带资源限制）。
+ *
+ * limits.memory_budget 非空时只在解码期间占用预算（用于准入：预算不足即失败），
+ * 返回前归还；解码结果需要长期持有时请使用返回 lease 的重载。
  */
 std::error_code decode_one(bytes_view in,
                            Item &out,
                            std::size_t &consumed,
                            const DecodeLimits &limits) noexcept;
 
+/**
+ * @brief 从输入缓冲区解码一个 Item，解码出的节点与 payload 计入进程级内存预算。
+ *
+ * 说明：
+ * - 每个节点预约 sizeof(Item)，每个叶子再预约其 payload 字节数（近似解码后的占用）；
+ *   预算不足时返回 errc::out_of_memory，而不是先分配、再由分配器失败；
+ * - 成功时预约留在 reservation 中（随解码结果一起持有，析构时归还）；
+ *   失败时 reservation 恢复为调用前的字节数。
+ */
+std::error_code decode_one(bytes_view in,
+                           Item &out,
+                           std::size_t &consumed,
+                           const DecodeLimits &limits,
+                           core::MemoryReservation &reservation) noexcept;
+
+/**
+ * @brief 从输入缓冲区解码一个 Item，预约从 limits.memory_budget 扣除并随 lease 返回。
+ *
+ * 说明：
+ * - 成功时 lease 持有 out 的全部预约，调用方应让 lease 与 out 同生共死
+ *   （例如放在同一个结构体/作用域中）；limits.memory_budget 为空时 lease 为空；
+ * - 失败时预约已全部归还，lease 被置空。
+ */
+std::error_code decode_one(bytes_view in,
+                           Item &out,
+                           std::size_t &consumed,
+                           const DecodeLimits &limits,
+                           std::shared_ptr<const core::MemoryReservation> &lease) noexcept;
+
+/**
+ * @brief 指向 on-wire payload 的大端序数值视图（不拷贝、不分配）。
+ *
+ * 说明：
+ * - raw() 为原始大端字节，长度保证是 sizeof(T) 的整数倍；
+ * - operator[] 按需做字节序转换；浮点按 IEEE754 位模式还原（与 decode_one
+ *   一致）；
+ * - 视图仅在对应回调期间有效，指向 visit_encoded 的输入缓冲区。
+ */
+template <class T>
+class BigEndianView final {
+    static_assert(std::is_arithmetic_v<T>);
+    static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 ||
+                  sizeof(T) == 8);
+
+    using bits_type = std::conditional_t<
+        sizeof(T) == 1,
+        std::uint8_t,
+        std::conditional_t<
+            sizeof(T) == 2,
+            std::uint16_t,
+            std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+
+public:
+    using value_type = T;
+
+    BigEndianView() = default;
+    explicit BigEndianView(bytes_view raw) noexcept : raw_(raw) {}
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return raw_.size() / sizeof(T);
+    }
+    [[nodiscard]] bool empty() const noexcept { return raw_.empty(); }
+    [[nodiscard]] bytes_view raw() const noexcept { return raw_; }
+
+    [[nodiscard]] T operator[](std::size_t index) const noexcept {
+        const auto offset = index * sizeof(T);
+        bits_type v = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            v = static_cast<bits_type>((v << 8) | raw_[offset + i]);
+        }
+        return std::bit_cast<T>(v);
+    }
+
+private:
+    bytes_view raw_{};
+};
+
+/**
+ * @brief SECS-II 事件式（SAX 风格）遍历回调。
+ *
+ * 说明：
+ * - 所有回调默认空实现，按需覆写即可；
+ * - List 以 on_list_begin(n) / on_list_end() 成对出现，中间为 n 个子元素；
+ * - ASCII/Binary/Boolean 直接交出 payload 视图（Boolean 每字节一个值，
+ *   非 0 视为 true）；数值类交出 BigEndianView；
+ * - 所有视图均指向输入缓冲区，回调返回后不应继续持有。
+ */
+class EncodedVisitor {
+public:
+    virtual ~EncodedVisitor() = default;
+
+    virtual void on_list_begin(std::uint32_t /*count*/) {}
+    virtual void on_list_end() {}
+
+    virtual void on_ascii(std::string_view /*value*/) {}
+    virtual void on_binary(bytes_view /*value*/) {}
+    virtual void on_boolean(bytes_view /*values*/) {}
+
+    virtual void on_i1(BigEndianView<std::int8_t> /*values*/) {}
+    virtual void on_i2(BigEndianView<std::int16_t> /*values*/) {}
+    virtual void on_i4(BigEndianView<std::int32_t> /*values*/) {}
+    virtual void on_i8(BigEndianView<std::int64_t> /*values*/) {}
+
+    virtual void on_u1(BigEndianView<std::uint8_t> /*values*/) {}
+    virtual void on_u2(BigEndianView<std::uint16_t> /*values*/) {}
+    virtual void on_u4(BigEndianView<std::uint32_t> /*values*/) {}
+    virtual void on_u8(BigEndianView<std::uint64_t> /*values*/) {}
+
+    virtual void on_f4(BigEndianView<float> /*values*/) {}
+    virtual void on_f8(BigEndianView<double> /*values*/) {}
+};
+
+/**
+ * @brief 事件式遍历输入缓冲区中的一个 Item（不构造 Item 树，不分配内存）。
+ *
+ * 说明：
+ * - 校验规则与 DecodeLimits 语义与 decode_one 完全一致；
+ * - 每个节点校验通过后才回调，因此失败时此前的回调可能已经发生，
+ *   调用方应以返回值为准丢弃部分结果；
+ * - 成功时 consumed 为消耗的输入字节数，失败时为 0；
+ * - 遍历本身不抛异常，visitor 抛出的异常会原样传播。
+ */
+std::error_code visit_encoded(bytes_view in,
+                              EncodedVisitor &visitor,
+                              std::size_t &consumed);
+
+/**
+ * @brief 事件式遍历一个 Item（带资源限制）。
+ */
+std::error_code visit_encoded(bytes_view in,
+                              EncodedVisitor &visitor,
+                              std::size_t &consumed,
+                              const DecodeLimits &limits);
+
 } // namespace secs::ii
 
 namespace std {
@@ -1,11 +1,16 @@
 #pragma once
 
+#include "secs/core/body_sink.hpp"
+#include "secs/core/memory_budget.hpp"
+#include "secs/core/body_source.hpp"
 #include "secs/core/common.hpp"
+#include "secs/core/shared_bytes.hpp"
 
 #include <asio/awaitable.hpp>
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <system_error>
@@ -24,6 +29,22 @@ struct DataMessage final {
     bool w_bit{false};
     std::uint32_t system_bytes{0};
     std::vector<secs::core::byte> body{};
+    // 仅发送路径：非空时代替 body（引用计数共享，不拷贝）；收到的消息填充 body（或 body_sink）。
+    secs::core::SharedBytes shared_body{};
+    // 仅发送路径：非空时消息体由该来源流式写出（见 Session::async_send_streamed），
+    // 优先于 shared_body/body。
+    std::shared_ptr<secs::core::BodySource> body_source{};
+    // 仅接收路径：消息体已写入后端注册的 sink（hsms::SessionOptions::body_sinks /
+    // secs1::StateMachine::set_body_sinks），此时 body 为空。
+    std::shared_ptr<secs::core::BodySink> body_sink{};
+    // 仅接收路径：body 占用的入站内存预算（后端配置了 core::MemoryBudget 时），
+    // 消息（含其拷贝）全部析构后归还；需要长期持有 body 时应 move 走 body 并自行计量。
+    secs::core::MemoryLease memory_lease{};
+
+    [[nodiscard]] secs::core::bytes_view body_view() const noexcept {
+        return shared_body.empty() ? secs::core::bytes_view{body.data(), body.size()}
+                                   : shared_body.view();
+    }
 
     [[nodiscard]] bool is_primary() const noexcept {
         return (function & 0x01U) != 0;
@@ -2,8 +2,13 @@
 
 #include "secs/core/common.hpp"
 #include "secs/core/event.hpp"
+#include "secs/core/metrics.hpp"
+#include "secs/core/pending_table.hpp"
+#include "secs/core/shared_bytes.hpp"
 #include "secs/protocol/router.hpp"
+#include "secs/protocol/spool.hpp"
 #include "secs/protocol/system_bytes.hpp"
+#include "secs/utils/async_dump.hpp"
 #include "secs/utils/hsms_dump.hpp"
 #include "secs/utils/secs1_dump.hpp"
 
@@ -12,15 +17,19 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <system_error>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace secs::hsms {
 class Session;
+class GeneralSession;
+struct Message;
 } // namespace secs::hsms
 
 namespace secs::secs1 {
@@ -35,14 +44,26 @@ struct SessionOptions final {
 
     // HSMS 后端挂起请求上限（system_bytes -> Pending）。
     // 达到上限时，async_request(HSMS) 会快速失败，避免 pending_ 无界增长。
+    // 只是上限：挂起表按需分块增长；超过 core::PendingTable 的 kMaxCapacity 时截断。
     std::size_t max_pending_requests{256};
 
+    // 挂起请求表已满时 async_request(HSMS) 的行为：
+    // - false：立即返回 buffer_overflow（默认）；
+    // - true：在本次请求的超时预算内等待其他请求完成、腾出 slot 后再发送，
+    //   预算耗尽返回 timeout。
+    // async_request_pipeline/async_request_all 不受此项影响，总是等待。
+    bool wait_for_pending_slot{false};
+
     // 接收循环的轮询间隔（仅 async_run/SECS-I 后端使用）：
     // - SECS-I 底层 Link/StateMachine 当前不支持主动 cancel，因此 async_run 需要
     //   通过轮询超时来检查 stop() 并避免永久阻塞。
     // - HSMS 后端由 stop() 主动取消底层读，不依赖轮询。
     secs::core::duration poll_interval{std::chrono::milliseconds{10}};
 
+    // async_run（HSMS 后端）每次唤醒最多取走的入站消息数（0 表示不限）：
+    // 事件报告风暴时一次唤醒处理整批就绪消息，而不是每条消息唤醒一次。
+    std::size_t run_batch_max{256};
+
     // 仅对 SECS-I 后端有效：R-bit（reverse_bit）方向位。
     // - false：Host -> Equipment（R=0）
     // - true：Equipment -> Host（R=1）
@@ -55,7 +76,10 @@ struct SessionOptions final {
      * - 默认关闭，避免产生额外开销与日志噪声；
      * - 开启后会在 protocol 层对每条“发送/接收”的 DataMessage 进行解析并输出；
      * - HSMS 后端输出基于 `secs::utils::dump_hsms_frame`（会额外 encode 一次，仅用于 dump）；
-     * - SECS-I 后端输出基于 `secs::utils::dump_secs1_message`（消息级别，不含 ENQ/EOT/ACK/NAK）。
+     * - SECS-I 后端输出基于 `secs::utils::dump_secs1_message`（消息级别，不含 ENQ/EOT/ACK/NAK）；
+     * - deferred=true 时改为延迟模式（见 `secs::utils::AsyncDumper`）：io 线程只把原始
+     *   header/body 复制进有界环形缓冲，解析、格式化与 sink 调用都在后台线程完成，
+     *   缓冲区满时丢弃并计数（Session::dump_dropped()）。
      */
     struct DumpOptions final {
         // 总开关
@@ -73,6 +97,11 @@ struct SessionOptions final {
         SinkFn sink{nullptr};
         void *sink_user{nullptr};
 
+        // 延迟模式：sink 在后台线程调用（需自行保证线程安全）。
+        bool deferred{false};
+        // 延迟模式环形缓冲容量（字节）。
+        std::size_t deferred_buffer_bytes{std::size_t{1} << 20};
+
         // HSMS dump 选项（backend=HSMS 时生效）
         secs::utils::HsmsDumpOptions hsms{};
 
@@ -81,8 +110,40 @@ struct SessionOptions final {
     };
 
     DumpOptions dump{};
+
+    /**
+     * @brief 指标分组（可选，见 secs::core::metrics）。
+     *
+     * 非空时记录请求数/超时数、T3 往返时延、入站/出站消息数与处理器耗时。
+     * 底层 hsms::Session / secs1::StateMachine 的指标需在各自的选项/接口上启用
+     * （可传入同一个分组）。
+     */
+    std::shared_ptr<secs::core::metrics::Group> metrics{};
+
+    /**
+     * @brief 出站消息 spool（可选，仅 HSMS 后端；需已 open，见 secs::protocol::Spool）。
+     *
+     * 当 spool->accepts(stream, function) 且“链路未 SELECTED 或 spool 中仍有未补发消息”
+     * （保证补发与新消息的先后顺序）时，主消息写入 spool 而不直接发送：
+     * - async_send 返回 ok（写 spool 失败时返回对应错误）；
+     * - async_request 返回 std::errc::operation_in_progress（回应不会交付给调用方）。
+     * 重新 SELECTED 后调用 Session::async_drain_spool 补发。
+     */
+    std::shared_ptr<Spool> spool{};
 };
 
+// 流水线请求中的一项（body 需在调用完成前保持有效）。
+struct PipelineRequest final {
+    std::uint8_t stream{0};
+    std::uint8_t function{0};
+    secs::core::bytes_view body{};
+};
+
+// 流水线回应回调：index 为该项在 requests 中的下标，按提交顺序逐项调用恰好一次；
+// 在 Session 的 executor 上调用，不应抛异常（抛出的异常会被忽略）。
+using PipelineResponseFn =
+    std::function<void(std::size_t index, std::error_code ec, DataMessage &response)>;
+
 /**
  * @brief 协议层会话：统一 HSMS 与 SECS-I 的“发送/请求/接收循环”接口。
  *
@@ -94,6 +155,9 @@ struct SessionOptions final {
  *
  * 说明：
  * - HSMS（全双工）推荐同时运行 async_run，用于接收并分发消息、唤醒挂起的请求。
+ * - HSMS（hsms::Session）后端直接复用底层会话的 strand：协议层与 HSMS 层同一 strand，
+ *   内部调用不再切换；public API 从其它执行器调用时先切到该 strand。多个会话栈可
+ *   分布在同一个多线程 io_context 上。
  * - SECS-I（半双工）当前实现不提供“内部排队/自动串行化”：
  *   1) `async_request/async_send` 请不要并发调用；
  *   2) 若你需要在多线程环境中使用，建议把所有调用统一调度到一个
@@ -108,6 +172,11 @@ public:
     Session(secs::hsms::Session &hsms,
             std::uint16_t session_id,
             SessionOptions options = {});
+    // HSMS-GS：绑定 GeneralSession 上的一个逻辑会话（session_id 需已注册）。
+    // 同一 GeneralSession 可为每个 SessionID 各建一个 protocol::Session。
+    Session(secs::hsms::GeneralSession &hsms,
+            std::uint16_t session_id,
+            SessionOptions options = {});
     Session(secs::secs1::StateMachine &secs1,
             std::uint16_t device_id,
             SessionOptions options = {});
@@ -144,6 +213,27 @@ public:
     asio::awaitable<std::error_code> async_send(std::uint8_t stream,
                                                 std::uint8_t function,
                                                 secs::core::bytes_view body);
+    // 同 async_send，消息体以共享缓冲传入：从 API 到连接写出全程只传引用、不拷贝。
+    // 建议用 SharedBytes::copy(body, secs::hsms::kFramePrefixSize) 预留帧前缀，
+    // 使 HSMS 写出为一次连续写。
+    asio::awaitable<std::error_code> async_send_shared(std::uint8_t stream,
+                                                       std::uint8_t function,
+                                                       secs::core::SharedBytes body);
+
+    /**
+     * @brief 流式发送大消息（W=0）：消息体由 source 按需读出，不在内存中保留完整副本。
+     *
+     * - HSMS：长度字段取 source->size()，消息体按 ConnectionOptions::stream_chunk_size
+     *   分段写出（mmap 来源直接写出映射区）；上限为 hsms::kMaxStreamedPayloadSize，
+     *   超过 16MB 时对端需能接收大帧；
+     * - SECS-I：边读边切块，块数上限不变；
+     * - 流式消息不写入 spool，也不输出 dump（消息体不在内存中）。
+     * 发送期间该连接的写队列被这条消息占用（HSMS 帧不可交织）。
+     */
+    asio::awaitable<std::error_code>
+    async_send_streamed(std::uint8_t stream,
+                        std::uint8_t function,
+                        std::shared_ptr<secs::core::BodySource> source);
 
     // 发送主消息（W=1）并等待从消息（T3 超时）。
     asio::awaitable<std::pair<std::error_code, DataMessage>>
@@ -151,6 +241,64 @@ public:
                   std::uint8_t function,
                   secs::core::bytes_view body,
                   std::optional<secs::core::duration> timeout = std::nullopt);
+    // 同 async_request，消息体以共享缓冲传入（见 async_send_shared）。
+    asio::awaitable<std::pair<std::error_code, DataMessage>>
+    async_request_shared(std::uint8_t stream,
+                         std::uint8_t function,
+                         secs::core::SharedBytes body,
+                         std::optional<secs::core::duration> timeout = std::nullopt);
+
+    // 同 async_request，消息体流式发送（见 async_send_streamed）。T3 从消息写完后才
+    // 开始有意义，大消息请按传输耗时放宽 timeout。
+    asio::awaitable<std::pair<std::error_code, DataMessage>>
+    async_request_streamed(std::uint8_t stream,
+                           std::uint8_t function,
+                           std::shared_ptr<secs::core::BodySource> source,
+                           std::optional<secs::core::duration> timeout = std::nullopt);
+
+    /**
+     * @brief 流水线请求：按顺序发出一批 W=1 主消息，最多 window 条同时等待回应。
+     *
+     * - 窗口已满时等待最早的在途请求完成后再发下一条（背压，而不是 buffer_overflow）；
+     *   挂起请求表被其他 async_request 占满时同样等待；
+     * - 每条请求各自计 T3（timeout 覆盖 options.t3），从该条发出时开始计时；
+     * - 回应经 on_response 按提交顺序交付：先完成的后序回应会暂存，直到前面的都已交付；
+     * - 单条失败（如 T3 超时）不会中止后续请求；stop() 后剩余项
+     *   以 cancelled 交付。
+     * - SECS-I 为半双工，退化为逐条 async_request（window 不生效）。
+     *
+     * @return 第一条失败项的错误码；全部成功时为 ok。
+     */
+    asio::awaitable<std::error_code>
+    async_request_pipeline(std::span<const PipelineRequest> requests,
+                           PipelineResponseFn on_response,
+                           std::size_t window = 16,
+                           std::optional<secs::core::duration> timeout = std::nullopt);
+
+    // 同 async_request_pipeline，把全部结果按提交顺序收集为 vector 返回。
+    asio::awaitable<std::vector<std::pair<std::error_code, DataMessage>>>
+    async_request_all(std::span<const PipelineRequest> requests,
+                      std::size_t window = 16,
+                      std::optional<secs::core::duration> timeout = std::nullopt);
+
+    /**
+     * @brief 补发 options.spool 中的消息（仅 HSMS 后端，链路需已 SELECTED）。
+     *
+     * 按 spool 顺序发送：W=0 消息发出即确认；W=1 消息最多 window 条同时等待回应
+     * （回应内容丢弃），按顺序确认并从 spool 移除。任一发送失败或 T3 超时即停止，
+     * 该条及之后的消息保留在 spool 中。补发期间新的可 spool 消息追加到 spool 尾部，
+     * 同样由本次补发发出。
+     *
+     * @return 错误码与本次确认移除的消息数。
+     */
+    asio::awaitable<std::pair<std::error_code, std::size_t>>
+    async_drain_spool(std::size_t window = 16);
+
+    // 延迟 dump：阻塞等待已入队的记录全部输出（未启用延迟模式时立即返回）。
+    void flush_dump() noexcept;
+
+    // 延迟 dump 因缓冲区满而丢弃的记录数（未启用延迟模式时为 0）。
+    [[nodiscard]] std::uint64_t dump_dropped() const noexcept;
 
 private:
     enum class Backend : std::uint8_t {
@@ -168,42 +316,89 @@ private:
         std::error_code ec{};
         std::optional<DataMessage> response{};
     };
+    using PendingHandle = secs::core::PendingTable<Pending>::Handle;
+
+    // 协议层指标句柄（定义见 session.cpp；未启用指标时为空）。
+    struct Metrics;
 
     asio::awaitable<std::error_code>
     async_send_message_(const DataMessage &msg);
     asio::awaitable<std::pair<std::error_code, DataMessage>>
     async_receive_message_(std::optional<secs::core::duration> timeout);
+    // HSMS：等待至少一条入站数据消息，一次取走至多 options_.run_batch_max 条。
+    asio::awaitable<std::pair<std::error_code, std::vector<DataMessage>>>
+    async_receive_batch_(std::optional<secs::core::duration> timeout);
+    // HSMS 入站数据消息：dump/计数后转换为 DataMessage（消息体移出 msg）。
+    [[nodiscard]] DataMessage accept_hsms_rx_(secs::hsms::Message &msg);
 
     asio::awaitable<void> handle_inbound_(DataMessage msg);
     [[nodiscard]] bool try_fulfill_pending_(DataMessage &msg) noexcept;
     void cancel_all_pending_(std::error_code reason) noexcept;
+    [[nodiscard]] std::pair<std::error_code, DataMessage>
+    finish_pending_(PendingHandle handle, std::error_code wait_ec) noexcept;
 
     void ensure_hsms_run_loop_started_();
 
+    // HSMS：登记挂起项并发出 W=1 请求；成功时由 await_hsms_reply_ 收尾并释放挂起项。
+    // slot_deadline 非空时，挂起表已满则等待腾出 slot（到期返回 timeout）。
+    asio::awaitable<std::error_code>
+    begin_hsms_request_(
+        const DataMessage &req,
+        std::uint8_t expected_function,
+        PendingHandle &handle,
+        std::optional<secs::core::steady_clock::time_point> slot_deadline = std::nullopt);
+    asio::awaitable<std::pair<std::error_code, DataMessage>>
+    await_hsms_reply_(PendingHandle handle, secs::core::duration t3);
+
+    [[nodiscard]] bool hsms_link_selected_() const noexcept;
+    // 该主消息是否应写入 options_.spool（见 SessionOptions::spool）。
+    [[nodiscard]] bool should_spool_(std::uint8_t stream,
+                                     std::uint8_t function) const noexcept;
+
+    // 记录一次 async_request 的结果（成功：T3 往返时延；timeout：超时计数）。
+    void note_request_done_(const std::error_code &ec,
+                            secs::core::steady_clock::time_point started) noexcept;
+
     // 为了避免 Pending::ready(core::Event) 在多线程 io_context 下出现跨线程并发访问，
     // public API 会把实际逻辑收敛到同一 executor/strand 上执行。
     asio::awaitable<void> async_run_impl_();
     asio::awaitable<std::error_code>
     async_poll_once_impl_(std::optional<secs::core::duration> timeout);
+    // source 非空时为流式消息体（body 忽略）。
     asio::awaitable<std::error_code>
     async_send_impl_(std::uint8_t stream,
                      std::uint8_t function,
-                     secs::core::bytes_view body);
+                     secs::core::SharedBytes body,
+                     std::shared_ptr<secs::core::BodySource> source = nullptr);
+    asio::awaitable<std::pair<std::error_code, std::size_t>>
+    async_drain_spool_impl_(std::size_t window);
+    asio::awaitable<std::error_code>
+    async_request_pipeline_impl_(std::span<const PipelineRequest> requests,
+                                 const PipelineResponseFn &on_response,
+                                 std::size_t window,
+                                 std::optional<secs::core::duration> timeout);
     asio::awaitable<std::pair<std::error_code, DataMessage>>
     async_request_impl_(std::uint8_t stream,
                         std::uint8_t function,
-                        secs::core::bytes_view body,
-                        std::optional<secs::core::duration> timeout);
+                        secs::core::SharedBytes body,
+                        std::optional<secs::core::duration> timeout,
+                        std::shared_ptr<secs::core::BodySource> source = nullptr);
 
     Backend backend_{Backend::hsms};
     asio::any_io_executor executor_{};
     SessionOptions options_{};
+    std::shared_ptr<Metrics> metrics_{};
+    // 延迟 dump 后台格式化器（options_.dump.enable && deferred 时创建）。
+    std::shared_ptr<secs::utils::AsyncDumper> dumper_{};
 
     SystemBytes system_bytes_{};
     Router router_{};
 
+    // 挂起请求表（仅 HSMS 后端使用；容量 = max_pending_requests）。
     mutable std::mutex pending_mu_{};
-    std::unordered_map<std::uint32_t, std::shared_ptr<Pending>> pending_{};
+    secs::core::PendingTable<Pending> pending_;
+    // 挂起项释放时置位，唤醒等待 slot 的请求（见 begin_hsms_request_）。
+    secs::core::Event pending_slot_freed_{};
 
     bool stop_requested_{false};
     bool run_loop_active_{false};
@@ -211,6 +406,7 @@ private:
     std::mutex run_mu_{};
 
     secs::hsms::Session *hsms_{nullptr};
+    secs::hsms::GeneralSession *hsms_gs_{nullptr};
     std::uint16_t hsms_session_id_{0};
 
     secs::secs1::StateMachine *secs1_{nullptr};
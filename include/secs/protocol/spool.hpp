@@ -0,0 +1,190 @@
+#pragma once
+
+#include "secs/core/common.hpp"
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace secs::protocol {
+
+/*
+ * 出站消息持久化 spool（SEMI E30 Spooling）。
+ *
+ * 链路断开/未 SELECTED 时，把允许 spool 的主消息顺序写盘；重新 SELECTED 后由
+ * protocol::Session::async_drain_spool 按原顺序流水线补发，确认送达后再从队首移除
+ * （至少一次语义：进程在“已发出、未确认”之间崩溃，重启后该消息会再发一次）。
+ *
+ * 目录布局（所有整数均为大端）：
+ *
+ *   spool.idx   96B，运行期 mmap 映射：
+ *                 文件头 16B：magic "SECSSPI\0"(8) | version u16 | reserved(6)
+ *                 槽 A/B 各 40B：generation u64 | segment u64 | offset u64 |
+ *                               sequence u64 | crc32 u32 | reserved u32
+ *               队首位置交替写入两个槽，恢复时取 CRC 有效且 generation 最大者，
+ *               因此任一槽写到一半崩溃都不会丢失队首。
+ *
+ *   <id>.seg    只追加的段文件（id 为 16 位十六进制）：
+ *                 文件头 16B：magic "SECSSPL\0"(8) | version u16 | header_size u16 | reserved u32
+ *                 记录 24B + N：body_len u32 | crc32 u32 | sequence u64 |
+ *                              stream u8 | function u8 | flags u8(bit0=W) | reserved u8 |
+ *                              reserved u32 | body N 字节
+ *               crc32 覆盖记录头（crc 字段按 0 计）与 body。
+ *
+ * 恢复（open）：删除队首之前的段；逐段校验记录，截掉第一条残缺/校验失败记录
+ * 及其之后的内容（典型为写到一半的尾记录）。
+ *
+ * 线程模型：非线程安全；与绑定的 protocol::Session 在同一 executor/strand 上使用。
+ */
+
+inline constexpr std::size_t kSpoolSegmentHeaderSize = 16;
+inline constexpr std::size_t kSpoolRecordHeaderSize = 24;
+inline constexpr std::size_t kSpoolIndexFileSize = 96;
+inline constexpr std::uint16_t kSpoolVersion = 1;
+
+struct SpoolOptions final {
+    // spool 目录（不存在时自动创建）。
+    std::string directory{};
+
+    // 单个段文件的目标大小；超过后新消息写入下一个段（单条消息可超过该值）。
+    std::size_t segment_bytes{std::size_t{4} << 20};
+
+    // 磁盘占用上限（所有段文件合计），至少为 2 * segment_bytes。
+    std::uint64_t max_bytes{std::uint64_t{64} << 20};
+
+    // 满时策略（E30 OverWriteSpool）：
+    // - false：拒绝新消息（push 返回 buffer_overflow，计入 rejected()）；
+    // - true：按段丢弃最旧的消息（计入 dropped()）。
+    bool overwrite_when_full{false};
+
+    // 每次 push 后 fsync 段文件、每次确认后 msync 索引（抵御掉电；默认只抵御进程崩溃）。
+    bool sync_writes{false};
+};
+
+// 一条 spool 消息（sequence 单调递增，跨重启保持）。
+struct SpoolMessage final {
+    std::uint64_t sequence{0};
+    std::uint8_t stream{0};
+    std::uint8_t function{0};
+    bool w_bit{false};
+    std::vector<core::byte> body{};
+};
+
+/**
+ * @brief 磁盘 spool：段式追加日志 + mmap 队首索引。
+ *
+ * 读取与确认分离，便于流水线补发：
+ *   spool.rewind();
+ *   for (SpoolMessage m; spool.next(m);) { 发送 m ... }   // 不移除
+ *   spool.consume_through(m.sequence);                      // 确认后才移除
+ */
+class Spool final {
+public:
+    explicit Spool(SpoolOptions options);
+    ~Spool();
+
+    Spool(const Spool &) = delete;
+    Spool &operator=(const Spool &) = delete;
+
+    // 创建目录、映射索引并恢复已有段。选项非法返回 invalid_argument。
+    [[nodiscard]] std::error_code open() noexcept;
+    void close() noexcept;
+    [[nodiscard]] bool is_open() const noexcept { return open_; }
+
+    // spool 过滤（对应 E30 S2F43）：只有启用的 (stream, function) 会被 push 接受。
+    // E30 不允许 spool Stream 1；stream>127、function 为偶数（从消息）同样返回 invalid_argument。
+    std::error_code enable_stream(std::uint8_t stream) noexcept;
+    std::error_code enable(std::uint8_t stream, std::uint8_t function) noexcept;
+    void disable_stream(std::uint8_t stream) noexcept;
+    void clear_filter() noexcept;
+    [[nodiscard]] bool accepts(std::uint8_t stream,
+                               std::uint8_t function) const noexcept;
+
+    // 追加一条消息（不检查过滤，调用方先用 accepts 判断）。
+    std::error_code push(std::uint8_t stream,
+                         std::uint8_t function,
+                         bool w_bit,
+                         core::bytes_view body) noexcept;
+
+    // 读取下一条尚未读过的消息（不移除）；读到末尾或出错时返回 false（用 last_error() 区分）。
+    [[nodiscard]] bool next(SpoolMessage &out) noexcept;
+
+    // 把读取位置退回队首（补发中断后重来）。
+    void rewind() noexcept;
+
+    // 确认 sequence 及之前已读出的消息：推进并持久化队首，删除已消费完的段。
+    std::error_code consume_through(std::uint64_t sequence) noexcept;
+
+    // 丢弃全部消息（对应 E30 S6F23 Purge）。
+    std::error_code purge() noexcept;
+
+    [[nodiscard]] std::uint64_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] std::uint64_t disk_bytes() const noexcept { return disk_bytes_; }
+    [[nodiscard]] std::uint64_t dropped() const noexcept { return dropped_; }
+    [[nodiscard]] std::uint64_t rejected() const noexcept { return rejected_; }
+    [[nodiscard]] std::error_code last_error() const noexcept { return last_error_; }
+
+private:
+    struct Segment final {
+        std::uint64_t id{0};
+        std::uint64_t bytes{0};     // 文件大小（含段头）
+        std::uint64_t first_seq{0}; // 段内第一条记录的 sequence
+        std::uint64_t records{0};
+    };
+
+    struct Position final {
+        std::uint64_t segment{0};
+        std::uint64_t offset{0};
+        std::uint64_t sequence{0}; // 该位置上（下一条）记录的 sequence
+    };
+
+    class IndexFile;
+
+    [[nodiscard]] std::string segment_path_(std::uint64_t id) const;
+    std::error_code recover_() noexcept;
+    std::error_code start_segment_(std::uint64_t id) noexcept;
+    std::error_code make_room_(std::uint64_t need) noexcept;
+    void drop_head_segment_() noexcept;
+    void normalize_head_() noexcept;
+    void persist_head_() noexcept;
+    void close_read_file_() noexcept;
+    [[nodiscard]] Segment *find_segment_(std::uint64_t id) noexcept;
+
+    SpoolOptions options_{};
+    bool open_{false};
+
+    std::array<std::bitset<256>, 128> filter_{};
+
+    std::unique_ptr<IndexFile> index_{};
+    std::deque<Segment> segments_{};
+    std::FILE *write_file_{nullptr};
+
+    Position head_{};
+    Position read_{};
+    // 已读出、尚未确认的消息（sequence 与其后一条的位置），用于 consume_through。
+    std::deque<Position> outstanding_{};
+
+    std::FILE *read_file_{nullptr};
+    std::uint64_t read_file_id_{0};
+    std::uint64_t read_file_pos_{0};
+    bool read_file_pos_valid_{false};
+
+    std::uint64_t next_seq_{1};
+    std::uint64_t size_{0};
+    std::uint64_t disk_bytes_{0};
+    std::uint64_t dropped_{0};
+    std::uint64_t rejected_{0};
+    std::error_code last_error_{};
+
+    std::vector<core::byte> scratch_{};
+};
+
+} // namespace secs::protocol
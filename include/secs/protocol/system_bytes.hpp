@@ -1,12 +1,11 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
-#include <deque>
 #include <limits>
-#include <mutex>
 #include <system_error>
-#include <unordered_set>
 
 namespace secs::protocol {
 
@@ -19,11 +18,19 @@ namespace secs::protocol {
  * SystemBytes）。
  * - 本分配器仅保证“本端发出的消息”在 in_use
  * 集合中的唯一性；不尝试与对端全局去重。
- * - 默认假设在同一执行器/线程语境下使用；若跨线程使用，本类内部使用 mutex
- * 保护数据结构。
+ * - 无锁实现：单调递增的候选计数器 + 固定大小的在用槽表（kWindowSize 个槽，
+ *   值 v 占用槽 (v-1) % kWindowSize）。allocate/release/is_in_use 均为 O(1)
+ *   的原子操作，不做任何堆分配，可被多个线程并发调用。
+ * - 同一时刻最多 kWindowSize 个值在用；某个值长期不释放时，只会挡住与它同槽
+ *   的后续候选（分配时跳过），不会影响其它值。
+ * - 释放的值不会被立即复用：候选值按计数器单调前进，绕过一整圈后才会再次
+ *   命中（小空间下即为下一轮扫描），这也降低了“迟到的回应误匹配新请求”的概率。
  */
 class SystemBytes final {
 public:
+    // 同时在用的 SystemBytes 上限（槽表大小，2 的幂）。
+    static constexpr std::size_t kWindowSize = 4096;
+
     /**
      * @brief 创建 SystemBytes 分配器。
      *
@@ -40,11 +47,14 @@ public:
         std::uint32_t max_value =
             std::numeric_limits<std::uint32_t>::max()) noexcept;
 
+    SystemBytes(const SystemBytes &) = delete;
+    SystemBytes &operator=(const SystemBytes &) = delete;
+
     /**
      * @brief 分配一个新的 SystemBytes。
      *
-     * @return ok 成功；buffer_overflow 表示可用空间被耗尽（极端情况：2^32-1
-     * 全部在用）。
+     * @return ok 成功；buffer_overflow 表示可用空间被耗尽（在用数量达到
+     * min(kWindowSize, max_value)，或一整圈候选都与在用值同槽）。
      */
     [[nodiscard]] std::error_code allocate(std::uint32_t &out) noexcept;
 
@@ -54,16 +64,25 @@ public:
     void release(std::uint32_t system_bytes) noexcept;
 
     [[nodiscard]] bool is_in_use(std::uint32_t system_bytes) const noexcept;
+
+    /**
+     * @brief 当前在用数量（扫描槽表，O(kWindowSize)；用于诊断/测试）。
+     */
     [[nodiscard]] std::size_t in_use_count() const noexcept;
 
 private:
-    [[nodiscard]] std::uint32_t next_candidate_() noexcept;
+    [[nodiscard]] std::uint32_t value_of_(std::uint64_t ticket) const noexcept;
+    [[nodiscard]] std::size_t slot_of_(std::uint32_t system_bytes) const noexcept;
 
-    mutable std::mutex mu_{};
-    std::uint32_t next_{1U};
     std::uint32_t max_{std::numeric_limits<std::uint32_t>::max()};
-    std::deque<std::uint32_t> free_{};
-    std::unordered_set<std::uint32_t> in_use_{};
+    bool full_range_{true};
+    std::size_t capacity_{kWindowSize};
+
+    // 票号计数器独占一条 cache line，避免与槽表伪共享。
+    alignas(64) std::atomic<std::uint64_t> next_{0};
+
+    // 槽内保存占用该槽的 SystemBytes；0 表示空闲。
+    alignas(64) std::array<std::atomic<std::uint32_t>, kWindowSize> slots_{};
 };
 
 } // namespace secs::protocol
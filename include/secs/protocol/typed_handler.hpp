@@ -2,6 +2,7 @@
 
 #include "secs/core/common.hpp"
 #include "secs/core/error.hpp"
+#include "secs/core/memory_budget.hpp"
 #include "secs/ii/codec.hpp"
 #include "secs/ii/item.hpp"
 #include "secs/protocol/router.hpp"
@@ -66,6 +67,8 @@ class TypedHandler {
 public:
     struct DecodeOptions final {
         // SECS-II 解码资源限制（用于约束不可信输入的资源消耗）。
+        // limits.memory_budget 为空时沿用消息体所计入的预算（msg.memory_lease），
+        // 即会话/后端配置的 memory_budget；两者都为空时不计预算。
         ii::DecodeLimits limits{};
 
         // 是否要求 consumed==msg.body.size()（严格消费整个输入）。
@@ -118,13 +121,26 @@ public:
                 core::make_error_code(core::errc::invalid_argument), {}};
         }
 
+        const ii::DecodeLimits *limits = &decode_options_.limits;
+        ii::DecodeLimits session_limits;
+        if (!limits->memory_budget && msg.memory_lease &&
+            msg.memory_lease->budget()) {
+            session_limits = decode_options_.limits;
+            session_limits.memory_budget = msg.memory_lease->budget();
+            limits = &session_limits;
+        }
+
+        // request_lease 持有 request_item 的预算预约，与之同在协程帧中，
+        // handle() 返回后随 request_item 一起释放。
         ii::Item request_item{ii::List{}};
+        secs::core::MemoryLease request_lease;
         std::size_t consumed = 0;
         const auto decode_ec = ii::decode_one(
             secs::core::bytes_view{msg.body.data(), msg.body.size()},
             request_item,
             consumed,
-            decode_options_.limits);
+            *limits,
+            request_lease);
 
         if (decode_ec) {
             co_return HandlerResult{decode_ec, {}};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "secs/core/common.hpp"
+#include "secs/core/memory_budget.hpp"
 
 #include <cstddef>
 #include <cstdint>
@@ -116,12 +117,25 @@ public:
 
     std::error_code accept(const DecodedBlock &block);
 
+    // 消息体已交给外部 sink：清空已累积的数据，之后 accept 只校验块序列与头部。
+    void discard_body() noexcept;
+
+    // 累积消息体前从进程级预算预约字节（nullptr 表示不限制）：预算不足时 accept 返回
+    // core::errc::out_of_memory 且不改变重组状态，调用方可 NAK 让对端重发该块。
+    void set_memory_budget(std::shared_ptr<secs::core::MemoryBudget> budget) noexcept;
+
+    // 取走已完成消息的消息体与对应的预约（避免再拷贝一次消息体）。
+    [[nodiscard]] std::vector<secs::core::byte> take_body() noexcept;
+    [[nodiscard]] secs::core::MemoryReservation take_reservation() noexcept;
+
 private:
     std::optional<std::uint16_t> expected_device_id_;
     bool has_header_{false};
+    bool discard_body_{false};
     Header header_{};
     std::uint16_t next_block_{1};
     std::vector<secs::core::byte> body_{};
+    secs::core::MemoryReservation reservation_{};
 };
 
 } // namespace secs::secs1
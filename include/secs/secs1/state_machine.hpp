@@ -1,6 +1,9 @@
 #pragma once
 
+#include "secs/core/body_sink.hpp"
+#include "secs/core/body_source.hpp"
 #include "secs/core/common.hpp"
+#include "secs/core/metrics.hpp"
 #include "secs/secs1/block.hpp"
 #include "secs/secs1/link.hpp"
 #include "secs/secs1/timer.hpp"
@@ -9,6 +12,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <system_error>
 #include <unordered_map>
@@ -27,6 +31,10 @@ enum class State : std::uint8_t {
 struct ReceivedMessage final {
     Header header{};
     std::vector<secs::core::byte> body{};
+    // 命中 set_body_sinks 注册时：消息体已写入该 sink，body 为空。
+    std::shared_ptr<secs::core::BodySink> body_sink{};
+    // 设置 set_memory_budget 时：消息体占用的预算，最后一个持有者析构时归还。
+    secs::core::MemoryLease memory_lease{};
 };
 
 /**
@@ -75,6 +83,10 @@ public:
 
     asio::awaitable<std::error_code> async_send(const Header &header,
                                                 secs::core::bytes_view body);
+    // 流式发送：消息体从 source 边读边切块（内存中只保留当前块），
+    // 块数上限与 async_send 相同（32767 块，约 7.6MB）。
+    asio::awaitable<std::error_code> async_send(const Header &header,
+                                                secs::core::BodySource &source);
 
     asio::awaitable<std::pair<std::error_code, ReceivedMessage>>
     async_receive(std::optional<secs::core::duration> timeout = std::nullopt);
@@ -82,27 +94,60 @@ public:
     asio::awaitable<std::pair<std::error_code, ReceivedMessage>>
     async_transact(const Header &header, secs::core::bytes_view body);
 
+    // 启用/关闭指标（nullptr 表示关闭，见 core::metrics）：记录块/消息数、
+    // 重试与 NAK 次数、消息大小与发送耗时。应在空闲（state()==idle）时调用；
+    // 内存不足时静默关闭指标。
+    void set_metrics(std::shared_ptr<secs::core::metrics::Group> group) noexcept;
+
+    // 入站消息体 sink 注册（见 core::BodySinkRule）：消息第 1 块通过校验后按
+    // (stream, function) 创建 sink（BodySinkInfo::size 为空），之后每块数据在 ACK 前写入
+    // sink，不在 Reassembler 中累积。接收失败时 sink 被 abort。应在空闲时调用。
+    void set_body_sinks(std::vector<secs::core::BodySinkRule> rules) noexcept;
+
+    // 进程级入站内存预算（见 core::MemoryBudget，nullptr 表示不限制）：重组消息体的
+    // 每块在 ACK 前预约；预算不足时回 NAK（对端按重试次数重发该块），不丢弃其它
+    // 未完成消息。应在空闲时调用，只影响之后开始的消息。
+    void set_memory_budget(std::shared_ptr<secs::core::MemoryBudget> budget) noexcept;
+
 private:
+    // 状态机指标句柄（定义见 state_machine.cpp；未启用指标时为空）。
+    struct Metrics;
+
     struct InFlight final {
         Reassembler re{std::nullopt};
         secs::core::steady_clock::time_point last_block{};
+        std::shared_ptr<secs::core::BodySink> sink{};
     };
 
     asio::awaitable<std::error_code> async_send_control(secs::core::byte b);
 
+    // 发送一个块帧：ENQ/EOT 握手 + 写帧 + 等待 ACK（含重试）；失败时 state_ 复位为 idle。
+    asio::awaitable<std::error_code> async_send_block_(secs::core::bytes_view frame);
+    // 整条消息发送完成：state_ 复位并记录指标。
+    void note_sent_(std::size_t body_size,
+                    secs::core::steady_clock::time_point started) noexcept;
+
     asio::awaitable<std::pair<std::error_code, secs::core::byte>>
     async_read_byte(std::optional<secs::core::duration> timeout);
 
+    // 按 body_sinks_ 为刚开始的消息创建 sink（未命中/工厂返回空时不变）。
+    std::error_code open_body_sink_(InFlight &st);
+    // 丢弃全部未完成的重组状态，已创建的 sink 以 reason abort。
+    void drop_in_flight_(std::error_code reason) noexcept;
+
     Link &link_;
     std::optional<std::uint16_t> expected_device_id_{};
     Timeouts timeouts_{};
     std::size_t retry_limit_{3};
     State state_{State::idle};
+    std::shared_ptr<Metrics> metrics_{};
 
     // 多 Block Message Interleaving：按 system_bytes 追踪多个并行重组器。
     // async_receive() 每次返回“任意一个已完成”的消息，其余未完成消息会留在 in_flight_
     // 中等待后续 block。
     std::unordered_map<std::uint32_t, InFlight> in_flight_{};
+    std::vector<secs::core::BodySinkRule> body_sinks_{};
+    std::shared_ptr<secs::core::MemoryBudget> memory_budget_{};
 
     // 重复块（ACK 丢失导致的重发）检测：记录“最近一次成功接收并 ACK 的块”。
     // 注意：该信息跨 async_receive() 调用保留，用于处理“最后一个块被重发”的情况。
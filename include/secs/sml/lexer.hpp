@@ -2,6 +2,8 @@
 
 #include "secs/sml/token.hpp"
 
+#include <deque>
+#include <string>
 #include <string_view>
 #include <system_error>
 #include <vector>
@@ -20,7 +22,17 @@ const std::error_category &lexer_error_category() noexcept;
 std::error_code make_error_code(lexer_errc e) noexcept;
 
 struct LexerResult {
+    LexerResult() = default;
+    // 只可移动：拷贝出的 tokens 仍指向源对象的 owned_strings，源对象析构后悬空。
+    LexerResult(LexerResult &&) = default;
+    LexerResult &operator=(LexerResult &&) = default;
+    LexerResult(const LexerResult &) = delete;
+    LexerResult &operator=(const LexerResult &) = delete;
+
     std::vector<Token> tokens;
+    // 含转义的字符串字面量解码后的存储（tokens 中的 String 可能指向这里）。
+    // deque 在 move 时元素地址不变，因此移动后 tokens 仍然有效。
+    std::deque<std::string> owned_strings;
     std::error_code ec;
     std::uint32_t error_line{0};
     std::uint32_t error_column{0};
@@ -37,20 +49,48 @@ struct LexerResult {
  * - 数字: 123, 0x1F, 0.5567
  * - 关键字: if, every, send, W, L, A, B, Boolean, U1-U8, I1-I8, F4, F8
  * - 注释: 块注释和行注释
+ *
+ * Token 的 value 直接引用源文本（零拷贝），仅含转义的字符串会解码到 Lexer
+ * 自有的存储；因此 source 与 Lexer 必须比产出的 Token 活得更久。
  */
 class Lexer {
 public:
-    explicit Lexer(std::string_view source) noexcept;
+    /**
+     * @param first_line source 第一行的行号（解析大文件的某个切片时用于保持
+     *                   报错行号与原文件一致；切片须从行首开始）
+     */
+    explicit Lexer(std::string_view source, std::uint32_t first_line = 1) noexcept;
 
+    /**
+     * @brief 一次性扫描全部 Token（末尾为 Eof）
+     *
+     * 转义字符串的存储会转移到 LexerResult::owned_strings。
+     */
     [[nodiscard]] LexerResult tokenize() noexcept;
 
+    /**
+     * @brief 流式扫描：返回下一个 Token（供 Parser 边扫描边解析）
+     *
+     * - 到达末尾后持续返回 Eof；
+     * - 出错时返回 TokenType::Error，之后持续返回同一错误，错误详情见 error()/
+     *   error_message()。
+     */
+    [[nodiscard]] Token next_token() noexcept;
+
+    [[nodiscard]] std::error_code error() const noexcept { return ec_; }
+    [[nodiscard]] const std::string &error_message() const noexcept {
+        return error_message_;
+    }
+
 private:
+    enum class comment_kind : std::uint8_t { none, skipped, unterminated };
+
     [[nodiscard]] bool at_end() const noexcept;
     [[nodiscard]] char peek() const noexcept;
     [[nodiscard]] char peek_next() const noexcept;
     char advance() noexcept;
     void skip_whitespace() noexcept;
-    bool skip_comment(LexerResult &result) noexcept;
+    comment_kind skip_comment() noexcept;
 
     Token scan_token() noexcept;
     Token scan_identifier() noexcept;
@@ -58,15 +98,12 @@ private:
     Token scan_number() noexcept;
 
     Token make_token(TokenType type) const noexcept;
-    Token make_token(TokenType type, std::string value) const noexcept;
+    Token make_token(TokenType type, std::string_view value) const noexcept;
     Token make_error(lexer_errc kind, std::string_view message) noexcept;
     Token make_error(std::string_view message) noexcept {
         return make_error(lexer_errc::invalid_character, message);
     }
 
-    [[nodiscard]] TokenType
-    identifier_type(std::string_view text) const noexcept;
-
     std::string_view source_;
     std::size_t current_{0};
     std::size_t token_start_{0};
@@ -74,7 +111,11 @@ private:
     std::uint32_t column_{1};
     std::uint32_t token_line_{1};
     std::uint32_t token_column_{1};
-    lexer_errc last_error_kind_{lexer_errc::invalid_character};
+
+    std::deque<std::string> owned_strings_;
+    std::error_code ec_;
+    std::string error_message_;
+    Token error_token_{};
 };
 
 } // namespace secs::sml
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "secs/sml/ast.hpp"
+#include "secs/sml/parser.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace secs::sml {
+
+/**
+ * @brief SML 库（多文件 / 大文件）并行加载选项
+ */
+struct LibraryLoadOptions final {
+    // 工作线程数；0 表示 std::thread::hardware_concurrency()。
+    std::size_t threads{0};
+
+    // 单个源文本超过该大小时，在顶层语句边界（语句结束的 '.' 所在行的行尾）
+    // 切成约 split_bytes 大小的切片并行解析；0 表示不切分。
+    std::size_t split_bytes{256 * 1024};
+};
+
+/**
+ * @brief 多文件解析结果
+ *
+ * 错误字段与 ParseResult 一致，额外给出出错文件路径；多个文件/切片出错时，
+ * 报告“按输入顺序第一个”出错的位置（与线程调度无关）。
+ */
+struct LibraryParseResult final {
+    Document document;
+    std::error_code ec;
+    std::string error_path;
+    std::uint32_t error_line{0};
+    std::uint32_t error_column{0};
+    std::string error_message;
+};
+
+/**
+ * @brief 并行解析单个（通常较大的）SML 源文本
+ *
+ * 结果与 parse_sml(source) 完全一致：按顶层语句切片并行解析后，按源文本顺序
+ * 拼接 messages/conditions/timers；报错行号仍是相对整个 source 的行号。
+ */
+[[nodiscard]] ParseResult
+parse_sml_parallel(std::string_view source,
+                   const LibraryLoadOptions &options = {}) noexcept;
+
+/**
+ * @brief 内存映射并行解析多个 SML 文件
+ *
+ * 说明：
+ * - 文件以只读 mmap 映射（Windows 退化为整体读入），解析期间不做额外拷贝；
+ * - 各文件（及大文件的切片）在线程池上并行解析；
+ * - 合并规则确定：结果等价于“按 paths 顺序拼接所有文件后 parse_sml”，因此同名/
+ *   同 SF 消息的冲突解析与单文件加载完全一致（见 Runtime::get_message 的选择规则）。
+ *
+ * @return 打开/映射失败时 ec 为对应的系统错误码（std::generic_category），
+ *         语法/词法错误为 sml.parser / sml.lexer。
+ */
+[[nodiscard]] LibraryParseResult
+parse_sml_files(const std::vector<std::string> &paths,
+                const LibraryLoadOptions &options = {}) noexcept;
+
+} // namespace secs::sml
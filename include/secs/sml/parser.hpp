@@ -1,6 +1,7 @@
 #pragma once
 
 #include "secs/sml/ast.hpp"
+#include "secs/sml/lexer.hpp"
 #include "secs/sml/token.hpp"
 
 #include <string_view>
@@ -35,11 +36,17 @@ struct ParseResult {
  * @brief SML 语法分析器
  *
  * 将 Token 序列转换为 AST (Document)。
- * 使用递归下降解析。
+ * 使用递归下降解析，只需 1 个 Token 的前瞻。
+ *
+ * 两种输入方式：
+ * - Parser(tokens)：解析已物化的 Token 序列（Token 引用的存储须在 parse 期间存活）；
+ * - Parser(lexer)：流式，按需从 Lexer 拉取 Token，不物化完整序列；词法错误会
+ *   作为 ParseResult 的错误返回（错误码域为 sml.lexer）。
  */
 class Parser {
 public:
     explicit Parser(std::vector<Token> tokens) noexcept;
+    explicit Parser(Lexer &lexer) noexcept;
 
     [[nodiscard]] ParseResult parse() noexcept;
 
@@ -50,6 +57,7 @@ private:
     const Token &advance() noexcept;
     bool check(TokenType type) const noexcept;
     bool match(TokenType type) noexcept;
+    [[nodiscard]] Token fetch() noexcept;
 
     // 解析规则
     bool parse_statement() noexcept;
@@ -78,8 +86,11 @@ private:
                   std::string_view message) noexcept;
     void error_at(const Token &token, std::string_view message) noexcept;
 
-    std::vector<Token> tokens_;
-    std::size_t current_{0};
+    std::vector<Token> tokens_; // 批量模式的输入
+    std::size_t next_index_{0};
+    Lexer *lexer_{nullptr};     // 流式模式的输入
+    Token lookahead_{TokenType::Eof};
+    Token previous_{TokenType::Eof};
 
     Document document_;
     std::error_code ec_;
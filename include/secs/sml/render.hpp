@@ -7,6 +7,7 @@
 #include <string_view>
 #include <system_error>
 #include <unordered_map>
+#include <vector>
 
 namespace secs::sml {
 
@@ -79,6 +80,48 @@ render_item(const TemplateItem &tpl,
             const RenderContext &ctx,
             secs::ii::Item &out) noexcept;
 
+/**
+ * @brief 预编码模板：SECS-II 字节镜像 + 占位符补丁表（load 时编译）
+ *
+ * 说明：
+ * - 镜像按“每个数值/Binary/Boolean 占位符恰好展开为 1 个值”的假设编码，
+ *   占位符位置先写 0，并在 slots 中记录其偏移与宽度；
+ * - 发送时若每个占位符都在 ctx 中提供了“同类型且恰好 1 个值”，只需拷贝镜像
+ *   并按偏移写入大端值（见 patch_template）；否则调用方应回退到 render_item；
+ * - ASCII 占位符的长度不固定，含 ASCII 占位符的模板不生成镜像（fast_path=false）。
+ */
+struct EncodedTemplate final {
+    struct Slot final {
+        std::size_t offset{0};                           // 在 image 中的偏移
+        std::string var;                                 // 变量名
+        secs::ii::format_code format{secs::ii::format_code::u1};
+    };
+
+    std::vector<secs::ii::byte> image;
+    std::vector<Slot> slots;
+    bool fast_path{false};
+};
+
+/**
+ * @brief 编译模板为 EncodedTemplate
+ *
+ * @return 可走快路径返回 true；不支持（ASCII 占位符、超长等）返回 false，
+ *         此时 out.fast_path=false。
+ */
+[[nodiscard]] bool compile_template(const TemplateItem &tpl,
+                                    EncodedTemplate &out) noexcept;
+
+/**
+ * @brief 快路径：拷贝预编码镜像并打补丁
+ *
+ * @return 成功返回 true（out 为完整 body）；任一占位符缺失、类型不符或值个数
+ *         不为 1 时返回 false，调用方应回退到 render_item + encode（由其给出
+ *         准确的错误码或展开结果）。
+ */
+[[nodiscard]] bool patch_template(const EncodedTemplate &compiled,
+                                  const RenderContext &ctx,
+                                  std::vector<secs::ii::byte> &out) noexcept;
+
 } // namespace secs::sml
 
 namespace std {
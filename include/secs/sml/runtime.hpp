@@ -1,9 +1,13 @@
 #pragma once
 
+#include "secs/core/common.hpp"
 #include "secs/core/error.hpp"
+#include "secs/ii/codec.hpp"
 #include "secs/sml/ast.hpp"
 #include "secs/sml/lexer.hpp"
+#include "secs/sml/library.hpp"
 #include "secs/sml/parser.hpp"
+#include "secs/sml/render.hpp"
 
 #include <chrono>
 #include <functional>
@@ -17,14 +21,12 @@
 
 namespace secs::sml {
 
-class RenderContext;
-
 /**
  * @brief SML 运行时
  *
  * 提供:
  * - 消息模板查找 (O(1))
- * - 条件响应匹配
+ * - 条件响应匹配（load 时按 (S,F) 预编译，匹配只扫描同 SF 的规则）
  * - 定时规则访问
  */
 class Runtime {
@@ -41,6 +43,16 @@ public:
      */
     void load(Document doc) noexcept;
 
+    /**
+     * @brief 内存映射并行加载多个 SML 文件（见 parse_sml_files）
+     *
+     * 合并结果等价于按 paths 顺序拼接后 load(source)；需要出错文件/行列信息时
+     * 请直接调用 parse_sml_files()。
+     */
+    [[nodiscard]] std::error_code
+    load_files(const std::vector<std::string> &paths,
+               const LibraryLoadOptions &options = {}) noexcept;
+
     /**
      * @brief 获取消息模板
      * @param name 消息名称；也支持直接传入 SxFy（例如 "S2F22"）
@@ -84,6 +96,28 @@ public:
                    const ii::Item &item,
                    const RenderContext &ctx) const noexcept;
 
+    /**
+     * @brief 直接在 SECS-II 编码后的 body 上匹配条件响应（不构造 Item）
+     *
+     * 说明：
+     * - body 须为一个完整编码的 Item（与 ii::decode_one 的校验规则一致，
+     *   允许尾随字节）；非法 body 返回对应的 ii::errc；
+     * - 规则选择与 match_response() 完全一致（按文档顺序首个命中）；
+     * - 期望值在 load 时已预编码，绝大多数规则以 memcmp 比较；
+     *   期望值中任意层级含 F4/F8（浮点编码不能按字节比较）或 Boolean 时，
+     *   回退为解码该元素后比较；
+     * - 命中时 out_name 指向 Runtime 内部的响应名（生命周期同 Runtime），
+     *   未命中为 nullptr；
+     * - limits 用于校验 body；limits.memory_budget 非空时回退路径解码出的元素
+     *   在比较期间计入该预算（预算不足视为未命中该规则）。
+     */
+    [[nodiscard]] std::error_code
+    match_response_encoded(std::uint8_t stream,
+                           std::uint8_t function,
+                           secs::core::bytes_view body,
+                           const std::string *&out_name,
+                           const ii::DecodeLimits &limits = {}) const noexcept;
+
     /**
      * @brief 渲染并编码消息模板（用于“代码主动发送”）
      *
@@ -96,6 +130,10 @@ public:
      *
      * @return 渲染失败返回 sml.render；编码失败返回 ii::errc；找不到消息返回
      * secs.core/invalid_argument。
+     *
+     * 说明：load 时已把模板预编码为字节镜像（见 EncodedTemplate）；若每个占位符
+     * 在 ctx 中都是“同类型且恰好 1 个值”，这里只做拷贝 + 补丁，否则回退到
+     * render_item + encode，两条路径输出逐字节一致。
      */
     [[nodiscard]] std::error_code
     encode_message_body(std::string_view name_or_sf,
@@ -145,12 +183,32 @@ private:
         }
     };
 
+    /**
+     * @brief load 时预编译的条件规则
+     *
+     * - (S,F) 已解析完毕，规则按 (S,F) 分桶，桶内保持文档顺序；
+     * - 不含占位符的期望值预先渲染为 Item 并预编码为字节，匹配时不再渲染；
+     * - 含占位符的期望值（仅直接构造 Document 时可能出现）保留在匹配时渲染。
+     */
+    struct CompiledCondition {
+        std::size_t rule_index{0};       // conditions 下标
+        std::optional<std::size_t> item_index; // 先序编号（1-based）
+        std::optional<ii::Item> expected;      // 预渲染的期望值
+        std::vector<secs::core::byte> expected_bytes; // expected 的编码
+        bool memcmp_comparable{false}; // 可直接按编码字节比较
+        bool needs_render{false};      // 期望值含占位符，匹配时渲染
+    };
+
     [[nodiscard]] bool build_index() noexcept;
-    [[nodiscard]] bool match_condition(const Condition &cond,
-                                       std::uint8_t stream,
-                                       std::uint8_t function,
-                                       const ii::Item &item,
-                                       const RenderContext &ctx) const noexcept;
+    [[nodiscard]] bool build_condition_index();
+    [[nodiscard]] const std::vector<std::size_t> *
+    conditions_for(std::uint8_t stream, std::uint8_t function) const noexcept;
+    [[nodiscard]] bool match_compiled(const CompiledCondition &cc,
+                                      const ii::Item &item,
+                                      const RenderContext &ctx) const;
+    [[nodiscard]] bool match_compiled_encoded(const CompiledCondition &cc,
+                                              secs::core::bytes_view body,
+                                              const ii::DecodeLimits &limits) const;
     [[nodiscard]] bool items_equal(const ii::Item &a,
                                    const ii::Item &b) const noexcept;
 
@@ -163,6 +221,11 @@ private:
                      // 透明查找，避免临时分配）
     std::unordered_map<std::uint16_t, std::size_t>
         sf_index_; // (stream<<8|function) -> messages 下标
+    std::vector<EncodedTemplate>
+        compiled_messages_; // 与 document_.messages 一一对应的预编码模板
+    std::vector<CompiledCondition> compiled_conditions_;
+    std::unordered_map<std::uint16_t, std::vector<std::size_t>>
+        condition_index_; // (stream<<8|function) -> compiled_conditions_ 下标
     bool loaded_{false};
 };
 
@@ -171,18 +234,9 @@ private:
  */
 [[nodiscard]] inline ParseResult parse_sml(std::string_view source) noexcept {
     try {
+        // 流式：Parser 按需从 Lexer 拉取 Token，不物化完整 Token 序列。
         Lexer lexer(source);
-        auto lex_result = lexer.tokenize();
-        if (lex_result.ec) {
-            ParseResult result;
-            result.ec = lex_result.ec;
-            result.error_line = lex_result.error_line;
-            result.error_column = lex_result.error_column;
-            result.error_message = std::move(lex_result.error_message);
-            return result;
-        }
-
-        Parser parser(std::move(lex_result.tokens));
+        Parser parser(lexer);
         return parser.parse();
     } catch (const std::bad_alloc &) {
         ParseResult result;
@@ -1,7 +1,6 @@
 #pragma once
 
 #include <cstdint>
-#include <string>
 #include <string_view>
 
 namespace secs::sml {
@@ -51,9 +50,15 @@ enum class TokenType : std::uint8_t {
     Error,
 };
 
+/**
+ * @brief 词法单元
+ *
+ * value 为零拷贝视图：指向源文本，或（含转义的字符串 / 错误信息）指向 Lexer
+ * 或 LexerResult 持有的存储；使用 Token 期间须保证二者存活。
+ */
 struct Token {
     TokenType type{TokenType::Error};
-    std::string value{};
+    std::string_view value{};
     std::uint32_t line{1};
     std::uint32_t column{1};
 
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "secs/core/common.hpp"
+#include "secs/hsms/message.hpp"
+#include "secs/secs1/block.hpp"
+#include "secs/utils/hsms_dump.hpp"
+#include "secs/utils/secs1_dump.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace secs::utils {
+
+/**
+ * @brief 异步 dump 的配置。
+ */
+struct AsyncDumpOptions final {
+    // 环形缓冲容量（字节）。单条记录 = 固定记录头 + 标题 + 消息体；放不下时丢弃并计数。
+    std::size_t buffer_bytes{std::size_t{1} << 20};
+
+    // 输出回调（在后台线程调用）；为空时只格式化不输出。
+    using SinkFn = void (*)(void *user, const char *data, std::size_t size) noexcept;
+    SinkFn sink{nullptr};
+    void *sink_user{nullptr};
+
+    HsmsDumpOptions hsms{};
+    Secs1DumpOptions secs1{};
+};
+
+/**
+ * @brief 延迟 dump：调用方只把原始字节复制进有界环形缓冲，由后台线程解析并格式化。
+ *
+ * 热路径（push_*）：
+ * - 一次短临界区内的 memcpy，不分配内存、不编解码、不格式化；
+ * - 缓冲区满时立即丢弃该条并计入 dropped()，绝不阻塞调用方。
+ *
+ * 后台线程按入队顺序输出，每条输出 = title + dump_hsms_frame / dump_secs1_message 的结果，
+ * 与同步 dump 的文本一致。
+ *
+ * 线程安全：push_* / flush / 计数器可从任意线程并发调用。
+ */
+class AsyncDumper final {
+public:
+    explicit AsyncDumper(AsyncDumpOptions options = {});
+    ~AsyncDumper();
+
+    AsyncDumper(const AsyncDumper &) = delete;
+    AsyncDumper &operator=(const AsyncDumper &) = delete;
+
+    // 入队一条 HSMS 消息（header + body）。返回 false 表示已丢弃（缓冲区满或已停止）。
+    bool push_hsms(std::string_view title,
+                   const secs::hsms::Header &header,
+                   secs::core::bytes_view body) noexcept;
+
+    // 入队一条已重组的 SECS-I 消息（header + body）。
+    bool push_secs1(std::string_view title,
+                    const secs::secs1::Header &header,
+                    secs::core::bytes_view body) noexcept;
+
+    // 阻塞等待调用前已入队的记录全部输出（测试/退出前使用）。
+    void flush() noexcept;
+
+    // 输出剩余记录后停止后台线程（幂等）；之后 push_* 一律丢弃。
+    void stop() noexcept;
+
+    [[nodiscard]] std::uint64_t dumped() const noexcept;
+    [[nodiscard]] std::uint64_t dropped() const noexcept;
+
+private:
+    enum class Kind : std::uint8_t {
+        hsms = 0,
+        secs1 = 1,
+    };
+
+    // 环内每条记录的固定头（进程内使用，按本机字节序原样 memcpy）。
+    struct RecordHead final {
+        std::uint32_t size{0}; // 记录总长（含本结构体、标题与消息体）
+        std::uint32_t body_size{0};
+        Kind kind{Kind::hsms};
+        std::uint8_t title_size{0};
+        secs::hsms::Header hsms{};
+        secs::secs1::Header secs1{};
+    };
+
+    bool push_(RecordHead head,
+               std::string_view title,
+               secs::core::bytes_view body) noexcept;
+    void write_(std::uint64_t pos, const void *src, std::size_t n) noexcept;
+    void run_() noexcept;
+    void format_batch_(std::uint64_t &ok, std::uint64_t &failed) noexcept;
+
+    AsyncDumpOptions options_{};
+    std::unique_ptr<secs::core::byte[]> ring_{};
+    std::size_t capacity_{0};
+
+    mutable std::mutex mu_{};
+    std::condition_variable cv_{};      // 生产者 -> 后台线程
+    std::condition_variable done_cv_{}; // 后台线程 -> flush()
+    std::uint64_t head_{0};             // 写入位置（单调递增）
+    std::uint64_t tail_{0};             // 已取走位置
+    std::uint64_t formatted_{0};        // 已输出位置
+    std::uint64_t dumped_{0};
+    std::uint64_t dropped_{0};
+    bool stopping_{false};
+    bool finished_{false};
+
+    // 仅后台线程使用（复用，避免每批分配）。
+    std::vector<secs::core::byte> staging_{};
+    std::vector<secs::core::byte> frame_{};
+    std::string text_{};
+
+    std::thread thread_{};
+};
+
+} // namespace secs::utils
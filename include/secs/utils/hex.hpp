@@ -42,6 +42,13 @@ struct HexDumpOptions final {
 [[nodiscard]] std::string hex_dump(secs::core::bytes_view bytes,
                                    HexDumpOptions options = {});
 
+/**
+ * @brief 同 hex_dump，但把结果追加到 out 末尾（可复用 out 的容量，避免每次分配）。
+ */
+void append_hex_dump(std::string &out,
+                     secs::core::bytes_view bytes,
+                     HexDumpOptions options = {});
+
 /**
  * @brief 解析 16 进制字符串为 bytes。
  *
@@ -51,4 +51,16 @@ struct HsmsDumpOptions final {
 [[nodiscard]] std::string dump_hsms_payload(secs::core::bytes_view payload,
                                             HsmsDumpOptions options = {});
 
+/**
+ * @brief 同 dump_hsms_frame / dump_hsms_payload，但把结果追加到 out 末尾。
+ *
+ * 高频 dump（例如日志每条报文都输出）时复用同一个 out，可避免逐条分配。
+ */
+void append_hsms_frame_dump(std::string &out,
+                            secs::core::bytes_view frame,
+                            HsmsDumpOptions options = {});
+void append_hsms_payload_dump(std::string &out,
+                              secs::core::bytes_view payload,
+                              HsmsDumpOptions options = {});
+
 } // namespace secs::utils
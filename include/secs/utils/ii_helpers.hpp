@@ -1,6 +1,7 @@
 #pragma once
 
 #include "secs/core/common.hpp"
+#include "secs/core/memory_budget.hpp"
 #include "secs/ii/codec.hpp"
 #include "secs/ii/item.hpp"
 
@@ -29,6 +30,9 @@ struct DecodeOneItemResult final {
 
     // 是否完整消耗输入缓冲区（consumed == in.size()）。
     bool fully_consumed{false};
+
+    // limits.memory_budget 非空时：item 占用的预算预约，随本结构体一起释放。
+    secs::core::MemoryLease memory_lease{};
 };
 
 /**
@@ -45,4 +45,11 @@ struct ItemDumpOptions final {
 [[nodiscard]] std::string dump_item(const secs::ii::Item &item,
                                     ItemDumpOptions options = {});
 
+/**
+ * @brief 同 dump_item，但把结果追加到 out 末尾（可复用 out 的容量，避免每次分配）。
+ */
+void append_item_dump(std::string &out,
+                      const secs::ii::Item &item,
+                      ItemDumpOptions options = {});
+
 } // namespace secs::utils
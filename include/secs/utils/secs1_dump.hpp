@@ -52,6 +52,17 @@ struct Secs1DumpOptions final {
                                              secs::core::bytes_view body,
                                              Secs1DumpOptions options = {});
 
+/**
+ * @brief 同 dump_secs1_block_frame / dump_secs1_message，但把结果追加到 out 末尾。
+ */
+void append_secs1_block_frame_dump(std::string &out,
+                                   secs::core::bytes_view frame,
+                                   Secs1DumpOptions options = {});
+void append_secs1_message_dump(std::string &out,
+                               const secs::secs1::Header &header,
+                               secs::core::bytes_view body,
+                               Secs1DumpOptions options = {});
+
 /**
  * @brief SECS-I 多 block 消息重组器（并可选解码 SECS-II）。
  *
@@ -95,12 +106,20 @@ public:
      *
      * 仅在最近一次 accept_frame 令 message_ready=true 时有效。
      * 失败时返回错误码，并保持 out 未定义（调用方可自行 reset/out）。
+     * limits.memory_budget 非空时仅在解码期间计入预算；需要让 out 持续计入时
+     * 使用带 lease 的重载，并让 lease 与 out 一起持有。
      */
     std::error_code decode_message_body_as_secs2(secs::ii::Item &out,
                                                  std::size_t &consumed,
                                                  const secs::ii::DecodeLimits
                                                      &limits) const noexcept;
 
+    std::error_code
+    decode_message_body_as_secs2(secs::ii::Item &out,
+                                 std::size_t &consumed,
+                                 const secs::ii::DecodeLimits &limits,
+                                 secs::core::MemoryLease &lease) const noexcept;
+
 private:
     secs::secs1::Reassembler reassembler_;
     secs::secs1::Header message_header_{};
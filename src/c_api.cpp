@@ -3,7 +3,9 @@
 #include "secs/core/error.hpp"
 #include "secs/core/event.hpp"
 #include "secs/core/log.hpp"
+#include "secs/core/metrics.hpp"
 #include "secs/hsms/connection.hpp"
+#include "secs/hsms/local_stream.hpp"
 #include "secs/hsms/message.hpp"
 #include "secs/hsms/session.hpp"
 #include "secs/ii/codec.hpp"
@@ -25,6 +27,7 @@
 #include <asio/use_awaitable.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstdlib>
@@ -503,6 +506,21 @@ make_decode_limits(const secs_ii_decode_limits_t *limits) noexcept {
     return out;
 }
 
+// secs_metrics_set_enabled 打开后，新建的 HSMS 会话各自在默认注册表中创建一个
+// 分组（session=创建序号，session_id=Device ID），由其上的协议层会话共享。
+std::atomic<bool> g_metrics_enabled{false};
+std::atomic<std::uint64_t> g_metrics_session_seq{0};
+
+[[nodiscard]] std::shared_ptr<secs::core::metrics::Group>
+make_session_metrics_group(std::uint16_t session_id) {
+    if (!g_metrics_enabled.load(std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    const auto seq = g_metrics_session_seq.fetch_add(1, std::memory_order_relaxed) + 1U;
+    return secs::core::metrics::default_registry().make_group(
+        {{"session", std::to_string(seq)}, {"session_id", std::to_string(session_id)}});
+}
+
 [[nodiscard]] secs::hsms::SessionOptions
 make_hsms_options(const secs_hsms_session_options_t *options) {
     secs::hsms::SessionOptions opt{};
@@ -516,6 +534,7 @@ make_hsms_options(const secs_hsms_session_options_t *options) {
                                                       secs::core::duration{});
     opt.auto_reconnect = options->auto_reconnect != 0;
     opt.passive_accept_select = options->passive_accept_select != 0;
+    opt.metrics = make_session_metrics_group(opt.session_id);
     return opt;
 }
 
@@ -538,6 +557,7 @@ make_hsms_options_v2(const secs_hsms_session_options_v2_t *options) {
 
     opt.auto_reconnect = options->auto_reconnect != 0;
     opt.passive_accept_select = options->passive_accept_select != 0;
+    opt.metrics = make_session_metrics_group(opt.session_id);
     return opt;
 }
 
@@ -616,6 +636,120 @@ secs_error_t secs_log_set_level(secs_log_level_t level) {
     });
 }
 
+// ----------------------------- 指标 -----------------------------
+
+secs_error_t secs_metrics_set_enabled(int enabled) {
+    g_metrics_enabled.store(enabled != 0, std::memory_order_relaxed);
+    return ok();
+}
+
+secs_error_t secs_metrics_snapshot(secs_metrics_snapshot_t *out) {
+    return guard_error([&]() -> secs_error_t {
+        if (!out) {
+            return c_api_err(SECS_C_API_INVALID_ARGUMENT);
+        }
+        out->samples = nullptr;
+        out->samples_n = 0;
+
+        secs::core::metrics::Snapshot snap;
+        const auto ec = secs::core::metrics::default_registry().snapshot(snap);
+        if (ec) {
+            return from_error_code(ec);
+        }
+        if (snap.samples.empty()) {
+            return ok();
+        }
+
+        auto *samples = static_cast<secs_metric_sample_t *>(
+            std::calloc(snap.samples.size(), sizeof(secs_metric_sample_t)));
+        if (!samples) {
+            return c_api_err(SECS_C_API_OUT_OF_MEMORY);
+        }
+        out->samples = samples;
+
+        for (const auto &s : snap.samples) {
+            auto &dst = samples[out->samples_n++];
+
+            std::string labels;
+            for (const auto &[k, v] : s.labels) {
+                if (!labels.empty()) {
+                    labels += ',';
+                }
+                labels += k;
+                labels += '=';
+                labels += v;
+            }
+            dst.name = dup_string(s.name);
+            dst.labels = dup_string(labels);
+            if (!dst.name || !dst.labels) {
+                secs_metrics_snapshot_free(out);
+                return c_api_err(SECS_C_API_OUT_OF_MEMORY);
+            }
+
+            dst.scale = s.scale;
+            dst.value = s.value;
+            if (s.type == secs::core::metrics::MetricType::histogram) {
+                const auto &h = s.histogram;
+                dst.type = SECS_METRIC_HISTOGRAM;
+                dst.sum = h.sum;
+                dst.max = h.max;
+                dst.p50 = h.value_at_quantile(0.50);
+                dst.p90 = h.value_at_quantile(0.90);
+                dst.p99 = h.value_at_quantile(0.99);
+                dst.p999 = h.value_at_quantile(0.999);
+            } else {
+                dst.type = SECS_METRIC_COUNTER;
+            }
+        }
+        return ok();
+    });
+}
+
+void secs_metrics_snapshot_free(secs_metrics_snapshot_t *snap) {
+    if (!snap) {
+        return;
+    }
+    for (std::size_t i = 0; i < snap->samples_n; ++i) {
+        std::free(snap->samples[i].name);
+        std::free(snap->samples[i].labels);
+    }
+    std::free(snap->samples);
+    snap->samples = nullptr;
+    snap->samples_n = 0;
+}
+
+secs_error_t secs_metrics_render(int openmetrics, char **out_text, size_t *out_len) {
+    return guard_error([&]() -> secs_error_t {
+        if (!out_text) {
+            return c_api_err(SECS_C_API_INVALID_ARGUMENT);
+        }
+        *out_text = nullptr;
+        if (out_len) {
+            *out_len = 0;
+        }
+
+        secs::core::metrics::Snapshot snap;
+        auto ec = secs::core::metrics::default_registry().snapshot(snap);
+        if (ec) {
+            return from_error_code(ec);
+        }
+        std::string text;
+        ec = secs::core::metrics::render_prometheus(snap, text, openmetrics != 0);
+        if (ec) {
+            return from_error_code(ec);
+        }
+
+        *out_text = dup_string(text);
+        if (!*out_text) {
+            return c_api_err(SECS_C_API_OUT_OF_MEMORY);
+        }
+        if (out_len) {
+            *out_len = text.size();
+        }
+        return ok();
+    });
+}
+
 // ----------------------------- 上下文 -----------------------------
 
 secs_error_t secs_context_create_with_options(secs_context_t **out_ctx,
@@ -1239,18 +1373,17 @@ secs_error_t secs_sml_runtime_match_response(const secs_sml_runtime_t *rt,
             return c_api_err(SECS_C_API_INVALID_ARGUMENT);
         *out_name = nullptr;
 
-        secs::ii::Item decoded{secs::ii::List{}};
-        std::size_t consumed = 0;
-        auto dec_ec = secs::ii::decode_one(
+        // 直接在编码后的 body 上匹配：错误语义与 decode_one 一致，但不建树。
+        const std::string *matched = nullptr;
+        auto match_ec = rt->rt.match_response_encoded(
+            stream,
+            function,
             bytes_view{reinterpret_cast<const byte *>(body_bytes), body_n},
-            decoded,
-            consumed);
-        if (dec_ec) {
-            return from_error_code(dec_ec);
+            matched);
+        if (match_ec) {
+            return from_error_code(match_ec);
         }
-
-        auto matched = rt->rt.match_response(stream, function, decoded);
-        if (!matched.has_value()) {
+        if (!matched) {
             return ok();
         }
 
@@ -1526,6 +1659,72 @@ secs_error_t secs_hsms_session_open_passive_ip(secs_hsms_session_t *sess,
     });
 }
 
+static bool to_local_endpoint(const char *path,
+                              secs_hsms_local_transport_t transport,
+                              secs::hsms::LocalEndpoint &out) {
+    if (!path || path[0] == '\0')
+        return false;
+    switch (transport) {
+    case SECS_HSMS_LOCAL_UNIX_SOCKET:
+        out.transport = secs::hsms::LocalTransport::unix_socket;
+        break;
+    case SECS_HSMS_LOCAL_SHARED_MEMORY:
+        out.transport = secs::hsms::LocalTransport::shared_memory;
+        break;
+    default:
+        return false;
+    }
+    out.path = path;
+    return true;
+}
+
+secs_error_t
+secs_hsms_session_open_active_local(secs_hsms_session_t *sess,
+                                    const char *path,
+                                    secs_hsms_local_transport_t transport) {
+    return guard_error([&]() -> secs_error_t {
+        secs::hsms::LocalEndpoint ep{};
+        if (!sess || !sess->ctx || !sess->sess ||
+            !to_local_endpoint(path, transport, ep))
+            return c_api_err(SECS_C_API_INVALID_ARGUMENT);
+
+        return run_blocking_ec(
+            sess->ctx,
+            [s = sess->sess, ep = std::move(ep)]() -> asio::awaitable<std::error_code> {
+                co_return co_await s->async_open_active(ep);
+            });
+    });
+}
+
+secs_error_t
+secs_hsms_session_open_passive_local(secs_hsms_session_t *sess,
+                                     const char *path,
+                                     secs_hsms_local_transport_t transport) {
+    return guard_error([&]() -> secs_error_t {
+        secs::hsms::LocalEndpoint ep{};
+        if (!sess || !sess->ctx || !sess->sess ||
+            !to_local_endpoint(path, transport, ep))
+            return c_api_err(SECS_C_API_INVALID_ARGUMENT);
+
+        return run_blocking_ec(
+            sess->ctx,
+            [s = sess->sess, ep = std::move(ep)]() -> asio::awaitable<std::error_code> {
+                secs::hsms::LocalAcceptor acceptor{s->executor()};
+                if (auto ec = acceptor.listen(ep)) {
+                    co_return ec;
+                }
+
+                auto [acc_ec, stream] = co_await acceptor.async_accept();
+                acceptor.close();
+                if (acc_ec) {
+                    co_return acc_ec;
+                }
+
+                co_return co_await s->async_open_passive(std::move(stream));
+            });
+    });
+}
+
 static secs_error_t hsms_open_with_connection(secs_hsms_session_t *sess,
                                               secs_hsms_connection_t **io_conn,
                                               bool passive) {
@@ -1861,6 +2060,10 @@ make_proto_options_v2(const secs_protocol_session_options_v2_t *options,
             out.dump.secs1.enable_secs2_decode = true;
         }
 
+        if ((flags & SECS_PROTOCOL_DUMP_DEFERRED) != 0) {
+            out.dump.deferred = true;
+        }
+
         if (options->dump_sink && state) {
             state->dump_sink = options->dump_sink;
             state->dump_sink_user = options->dump_sink_user;
@@ -1898,8 +2101,10 @@ secs_error_t secs_protocol_session_create_from_hsms(
         auto state = std::make_shared<protocol_state>();
         state->ctx = ctx;
         state->hsms_keepalive = hsms_sess->sess;
+        auto proto_opt = make_proto_options(options);
+        proto_opt.metrics = hsms_sess->options.metrics;
         state->sess = std::make_unique<secs::protocol::Session>(
-            *state->hsms_keepalive, session_id, make_proto_options(options));
+            *state->hsms_keepalive, session_id, std::move(proto_opt));
 
         // 启动 async_run：保证请求-响应匹配与入站路由在后台持续运行。
         // 注意：协程捕获 shared_ptr，确保即使 C 侧提前 destroy，run_loop 也不会
@@ -1943,10 +2148,10 @@ secs_error_t secs_protocol_session_create_from_hsms_v2(
         auto state = std::make_shared<protocol_state>();
         state->ctx = ctx;
         state->hsms_keepalive = hsms_sess->sess;
+        auto proto_opt = make_proto_options_v2(options, state.get());
+        proto_opt.metrics = hsms_sess->options.metrics;
         state->sess = std::make_unique<secs::protocol::Session>(
-            *state->hsms_keepalive,
-            session_id,
-            make_proto_options_v2(options, state.get()));
+            *state->hsms_keepalive, session_id, std::move(proto_opt));
 
         // 启动 async_run：保证请求-响应匹配与入站路由在后台持续运行。
         // 注意：协程捕获 shared_ptr，确保即使 C 侧提前 destroy，run_loop 也不会
@@ -2176,16 +2381,22 @@ secs_protocol_session_set_sml_default_handler(secs_protocol_session_t *sess,
                         make_error_code(errc::invalid_argument), {}};
                 }
 
-                secs::ii::Item decoded{secs::ii::List{}};
-                std::size_t consumed = 0;
-                const auto dec_ec = secs::ii::decode_one(
-                    bytes_view{msg.body.data(), msg.body.size()}, decoded, consumed);
-                if (dec_ec) {
-                    co_return secs::protocol::HandlerResult{dec_ec, {}};
+                // 回退解码计入消息体所在的入站预算（会话配置了 memory_budget 时）。
+                secs::ii::DecodeLimits limits{};
+                if (msg.memory_lease) {
+                    limits.memory_budget = msg.memory_lease->budget();
                 }
-
-                auto matched = runtime->match_response(msg.stream, msg.function, decoded);
-                if (!matched.has_value()) {
+                const std::string *matched = nullptr;
+                const auto match_ec = runtime->match_response_encoded(
+                    msg.stream,
+                    msg.function,
+                    bytes_view{msg.body.data(), msg.body.size()},
+                    matched,
+                    limits);
+                if (match_ec) {
+                    co_return secs::protocol::HandlerResult{match_ec, {}};
+                }
+                if (!matched) {
                     co_return secs::protocol::HandlerResult{
                         make_error_code(errc::invalid_argument), {}};
                 }
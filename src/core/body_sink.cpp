@@ -0,0 +1,314 @@
+#include "secs/core/body_sink.hpp"
+
+#include "secs/core/error.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace secs::core {
+namespace {
+
+/*
+ * 消息体去向实现。
+ *
+ * 文件写入为同步 write：接收方每次只交付一个分段（HSMS 默认 64KB、SECS-I 244B），
+ * 写入页缓存即返回；与 BodySource 的 pread 一样不为此引入线程池。
+ */
+
+#if !defined(_WIN32)
+
+class FileBodySink final : public BodySink {
+public:
+    FileBodySink(int fd, std::string path) noexcept : fd_(fd), path_(std::move(path)) {}
+
+    FileBodySink(const FileBodySink &) = delete;
+    FileBodySink &operator=(const FileBodySink &) = delete;
+
+    ~FileBodySink() override {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept override { return written_; }
+
+    asio::awaitable<std::error_code> async_write(bytes_view chunk) override {
+        std::size_t offset = 0;
+        while (offset < chunk.size()) {
+            const auto n = ::write(fd_, chunk.data() + offset, chunk.size() - offset);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                co_return std::error_code{errno, std::generic_category()};
+            }
+            offset += static_cast<std::size_t>(n);
+        }
+        written_ += chunk.size();
+        co_return std::error_code{};
+    }
+
+    asio::awaitable<std::error_code> async_finish() override {
+        const int fd = fd_;
+        fd_ = -1;
+        if (::close(fd) != 0) {
+            co_return std::error_code{errno, std::generic_category()};
+        }
+        co_return std::error_code{};
+    }
+
+    void abort(std::error_code) noexcept override {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        (void)std::remove(path_.c_str());
+    }
+
+private:
+    int fd_{-1};
+    std::string path_;
+    std::size_t written_{0};
+};
+
+// 文件映射去向：contiguous() 为整个区域；async_write 收到区域内部视图时只推进偏移。
+class MappedBodySink final : public BodySink {
+public:
+    MappedBodySink(byte *data, std::size_t capacity, std::string path) noexcept
+        : data_(data), capacity_(capacity), path_(std::move(path)) {}
+
+    MappedBodySink(const MappedBodySink &) = delete;
+    MappedBodySink &operator=(const MappedBodySink &) = delete;
+
+    ~MappedBodySink() override { unmap_(); }
+
+    [[nodiscard]] std::size_t size() const noexcept override { return written_; }
+
+    asio::awaitable<std::error_code> async_write(bytes_view chunk) override {
+        if (chunk.size() > capacity_ - written_) {
+            co_return make_error_code(errc::buffer_overflow);
+        }
+        if (chunk.data() != data_ + written_ && !chunk.empty()) {
+            std::memcpy(data_ + written_, chunk.data(), chunk.size());
+        }
+        written_ += chunk.size();
+        co_return std::error_code{};
+    }
+
+    void abort(std::error_code) noexcept override {
+        unmap_();
+        (void)std::remove(path_.c_str());
+    }
+
+    [[nodiscard]] mutable_bytes_view contiguous() noexcept override {
+        return mutable_bytes_view{data_, capacity_};
+    }
+
+private:
+    void unmap_() noexcept {
+        if (data_ && capacity_ != 0) {
+            ::munmap(data_, capacity_);
+        }
+        data_ = nullptr;
+        capacity_ = 0;
+    }
+
+    byte *data_{nullptr};
+    std::size_t capacity_{0};
+    std::size_t written_{0};
+    std::string path_;
+};
+
+#else // _WIN32
+
+class FileBodySink final : public BodySink {
+public:
+    FileBodySink(std::ofstream file, std::string path)
+        : file_(std::move(file)), path_(std::move(path)) {}
+
+    [[nodiscard]] std::size_t size() const noexcept override { return written_; }
+
+    asio::awaitable<std::error_code> async_write(bytes_view chunk) override {
+        file_.write(reinterpret_cast<const char *>(chunk.data()),
+                    static_cast<std::streamsize>(chunk.size()));
+        if (!file_) {
+            co_return std::make_error_code(std::errc::io_error);
+        }
+        written_ += chunk.size();
+        co_return std::error_code{};
+    }
+
+    asio::awaitable<std::error_code> async_finish() override {
+        file_.close();
+        if (!file_) {
+            co_return std::make_error_code(std::errc::io_error);
+        }
+        co_return std::error_code{};
+    }
+
+    void abort(std::error_code) noexcept override {
+        file_.close();
+        (void)std::remove(path_.c_str());
+    }
+
+private:
+    std::ofstream file_;
+    std::string path_;
+    std::size_t written_{0};
+};
+
+#endif // _WIN32
+
+class CallbackBodySink final : public BodySink {
+public:
+    CallbackBodySink(BodySinkChunkFn on_chunk, BodySinkDoneFn on_done)
+        : on_chunk_(std::move(on_chunk)), on_done_(std::move(on_done)) {}
+
+    [[nodiscard]] std::size_t size() const noexcept override { return written_; }
+
+    asio::awaitable<std::error_code> async_write(bytes_view chunk) override {
+        if (on_chunk_) {
+            auto ec = co_await on_chunk_(chunk);
+            if (ec) {
+                co_return ec;
+            }
+        }
+        written_ += chunk.size();
+        co_return std::error_code{};
+    }
+
+    asio::awaitable<std::error_code> async_finish() override {
+        if (on_done_) {
+            on_done_(std::error_code{});
+        }
+        co_return std::error_code{};
+    }
+
+    void abort(std::error_code reason) noexcept override {
+        if (on_done_) {
+            try {
+                on_done_(reason);
+            } catch (...) {
+            }
+        }
+    }
+
+private:
+    BodySinkChunkFn on_chunk_;
+    BodySinkDoneFn on_done_;
+    std::size_t written_{0};
+};
+
+} // namespace
+
+const BodySinkFactory *find_body_sink_factory(const std::vector<BodySinkRule> &rules,
+                                              std::uint8_t stream,
+                                              std::uint8_t function) noexcept {
+    const BodySinkFactory *stream_rule = nullptr;
+    for (const auto &rule : rules) {
+        if (rule.stream != stream || !rule.factory) {
+            continue;
+        }
+        if (!rule.function.has_value()) {
+            if (!stream_rule) {
+                stream_rule = &rule.factory;
+            }
+            continue;
+        }
+        if (*rule.function == function) {
+            return &rule.factory;
+        }
+    }
+    return stream_rule;
+}
+
+std::shared_ptr<BodySink> create_file_sink(const std::string &path, std::error_code &ec) {
+    ec.clear();
+#if defined(_WIN32)
+    std::ofstream f(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!f) {
+        ec = std::make_error_code(std::errc::permission_denied);
+        return nullptr;
+    }
+    try {
+        return std::make_shared<FileBodySink>(std::move(f), path);
+    } catch (const std::bad_alloc &) {
+        ec = make_error_code(errc::out_of_memory);
+        return nullptr;
+    }
+#else
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        ec = std::error_code{errno, std::generic_category()};
+        return nullptr;
+    }
+    try {
+        return std::make_shared<FileBodySink>(fd, path);
+    } catch (const std::bad_alloc &) {
+        ::close(fd);
+        ec = make_error_code(errc::out_of_memory);
+        return nullptr;
+    }
+#endif
+}
+
+std::shared_ptr<BodySink>
+map_file_sink(const std::string &path, std::size_t size, std::error_code &ec) {
+#if defined(_WIN32)
+    (void)size;
+    return create_file_sink(path, ec);
+#else
+    ec.clear();
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        ec = std::error_code{errno, std::generic_category()};
+        return nullptr;
+    }
+    byte *data = nullptr;
+    if (size != 0) {
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ec = std::error_code{errno, std::generic_category()};
+            ::close(fd);
+            (void)std::remove(path.c_str());
+            return nullptr;
+        }
+        void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const int err = errno;
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            (void)std::remove(path.c_str());
+            ec = std::error_code{err, std::generic_category()};
+            return nullptr;
+        }
+        data = static_cast<byte *>(p);
+    }
+    ::close(fd); // 映射建立后即可关闭 fd
+    try {
+        return std::make_shared<MappedBodySink>(data, size, path);
+    } catch (const std::bad_alloc &) {
+        if (data) {
+            ::munmap(data, size);
+        }
+        (void)std::remove(path.c_str());
+        ec = make_error_code(errc::out_of_memory);
+        return nullptr;
+    }
+#endif
+}
+
+std::shared_ptr<BodySink> make_callback_sink(BodySinkChunkFn on_chunk,
+                                             BodySinkDoneFn on_done) {
+    return std::make_shared<CallbackBodySink>(std::move(on_chunk), std::move(on_done));
+}
+
+} // namespace secs::core
@@ -0,0 +1,294 @@
+#include "secs/core/body_source.hpp"
+
+#include "secs/core/error.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace secs::core {
+namespace {
+
+/*
+ * 消息体来源实现。
+ *
+ * 文件读取为同步 pread：发送方每次只读一个分段（HSMS 默认 64KB、SECS-I 244B），
+ * 热数据在页缓存中，阻塞时间与一次 memcpy 同量级；不为此引入线程池。
+ */
+
+#if !defined(_WIN32)
+
+// fd 区间来源：owns_fd 为 true 时析构关闭 fd（open_file_body）。
+class FdBodySource final : public BodySource {
+public:
+    FdBodySource(int fd, std::uint64_t offset, std::size_t length, bool owns_fd) noexcept
+        : fd_(fd), offset_(offset), size_(length), owns_fd_(owns_fd) {}
+
+    FdBodySource(const FdBodySource &) = delete;
+    FdBodySource &operator=(const FdBodySource &) = delete;
+
+    ~FdBodySource() override {
+        if (owns_fd_ && fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept override { return size_; }
+
+    asio::awaitable<std::pair<std::error_code, std::size_t>>
+    async_read(mutable_bytes_view dst) override {
+        const auto want = std::min(dst.size(), size_ - read_);
+        if (want == 0) {
+            co_return std::pair{std::error_code{}, std::size_t{0}};
+        }
+        for (;;) {
+            const auto n = ::pread(fd_,
+                                   dst.data(),
+                                   want,
+                                   static_cast<off_t>(offset_ + read_));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                co_return std::pair{std::error_code{errno, std::generic_category()},
+                                    std::size_t{0}};
+            }
+            read_ += static_cast<std::size_t>(n);
+            co_return std::pair{std::error_code{}, static_cast<std::size_t>(n)};
+        }
+    }
+
+private:
+    int fd_{-1};
+    std::uint64_t offset_{0};
+    std::size_t size_{0};
+    std::size_t read_{0};
+    bool owns_fd_{false};
+};
+
+// 只读映射来源：contiguous() 返回整个映射，async_read 仅供不识别 contiguous 的调用方。
+class MappedBodySource final : public BodySource {
+public:
+    MappedBodySource(const byte *data, std::size_t size) noexcept
+        : data_(data), size_(size) {}
+
+    MappedBodySource(const MappedBodySource &) = delete;
+    MappedBodySource &operator=(const MappedBodySource &) = delete;
+
+    ~MappedBodySource() override {
+        if (data_ && size_ != 0) {
+            ::munmap(const_cast<byte *>(data_), size_);
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept override { return size_; }
+
+    asio::awaitable<std::pair<std::error_code, std::size_t>>
+    async_read(mutable_bytes_view dst) override {
+        const auto n = std::min(dst.size(), size_ - read_);
+        if (n != 0) {
+            std::memcpy(dst.data(), data_ + read_, n);
+            read_ += n;
+        }
+        co_return std::pair{std::error_code{}, n};
+    }
+
+    [[nodiscard]] bytes_view contiguous() const noexcept override {
+        return bytes_view{data_, size_};
+    }
+
+private:
+    const byte *data_{nullptr};
+    std::size_t size_{0};
+    std::size_t read_{0};
+};
+
+#else // _WIN32
+
+class StreamBodySource final : public BodySource {
+public:
+    StreamBodySource(std::ifstream file, std::size_t size)
+        : file_(std::move(file)), size_(size) {}
+
+    [[nodiscard]] std::size_t size() const noexcept override { return size_; }
+
+    asio::awaitable<std::pair<std::error_code, std::size_t>>
+    async_read(mutable_bytes_view dst) override {
+        const auto want = std::min(dst.size(), size_ - read_);
+        if (want == 0) {
+            co_return std::pair{std::error_code{}, std::size_t{0}};
+        }
+        file_.read(reinterpret_cast<char *>(dst.data()),
+                   static_cast<std::streamsize>(want));
+        const auto n = static_cast<std::size_t>(file_.gcount());
+        if (n == 0 && file_.bad()) {
+            co_return std::pair{std::make_error_code(std::errc::io_error),
+                                std::size_t{0}};
+        }
+        read_ += n;
+        co_return std::pair{std::error_code{}, n};
+    }
+
+private:
+    std::ifstream file_;
+    std::size_t size_{0};
+    std::size_t read_{0};
+};
+
+#endif // _WIN32
+
+class GeneratorBodySource final : public BodySource {
+public:
+    GeneratorBodySource(std::size_t size, BodyChunkFn next)
+        : size_(size), next_(std::move(next)) {}
+
+    [[nodiscard]] std::size_t size() const noexcept override { return size_; }
+
+    asio::awaitable<std::pair<std::error_code, std::size_t>>
+    async_read(mutable_bytes_view dst) override {
+        const auto want = std::min(dst.size(), size_ - read_);
+        if (want == 0 || !next_) {
+            co_return std::pair{std::error_code{}, std::size_t{0}};
+        }
+        auto [ec, n] = co_await next_(dst.first(want));
+        if (ec) {
+            co_return std::pair{ec, std::size_t{0}};
+        }
+        // 生成器多给的字节不计入（按声明的总长度截断）。
+        n = std::min(n, want);
+        read_ += n;
+        co_return std::pair{std::error_code{}, n};
+    }
+
+private:
+    std::size_t size_{0};
+    std::size_t read_{0};
+    BodyChunkFn next_;
+};
+
+} // namespace
+
+asio::awaitable<std::error_code> async_read_full(BodySource &source,
+                                                 mutable_bytes_view dst) {
+    std::size_t offset = 0;
+    while (offset < dst.size()) {
+        auto [ec, n] = co_await source.async_read(dst.subspan(offset));
+        if (ec) {
+            co_return ec;
+        }
+        if (n == 0) {
+            co_return make_error_code(errc::invalid_argument);
+        }
+        offset += n;
+    }
+    co_return std::error_code{};
+}
+
+std::shared_ptr<BodySource> open_file_body(const std::string &path,
+                                           std::error_code &ec) {
+    ec.clear();
+#if defined(_WIN32)
+    std::ifstream f(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!f) {
+        ec = std::make_error_code(std::errc::no_such_file_or_directory);
+        return nullptr;
+    }
+    const auto size = static_cast<std::size_t>(f.tellg());
+    f.seekg(0);
+    try {
+        return std::make_shared<StreamBodySource>(std::move(f), size);
+    } catch (const std::bad_alloc &) {
+        ec = make_error_code(errc::out_of_memory);
+        return nullptr;
+    }
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        ec = std::error_code{errno, std::generic_category()};
+        return nullptr;
+    }
+    struct ::stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ec = std::error_code{errno, std::generic_category()};
+        ::close(fd);
+        return nullptr;
+    }
+#if defined(POSIX_FADV_SEQUENTIAL)
+    (void)::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    try {
+        return std::make_shared<FdBodySource>(
+            fd, 0, static_cast<std::size_t>(st.st_size), true);
+    } catch (const std::bad_alloc &) {
+        ::close(fd);
+        ec = make_error_code(errc::out_of_memory);
+        return nullptr;
+    }
+#endif
+}
+
+std::shared_ptr<BodySource> map_file_body(const std::string &path,
+                                          std::error_code &ec) {
+#if defined(_WIN32)
+    return open_file_body(path, ec);
+#else
+    ec.clear();
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        ec = std::error_code{errno, std::generic_category()};
+        return nullptr;
+    }
+    struct ::stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ec = std::error_code{errno, std::generic_category()};
+        ::close(fd);
+        return nullptr;
+    }
+    const auto size = static_cast<std::size_t>(st.st_size);
+    const byte *data = nullptr;
+    if (size != 0) {
+        void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        const int err = errno;
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            ec = std::error_code{err, std::generic_category()};
+            return nullptr;
+        }
+        (void)::madvise(p, size, MADV_SEQUENTIAL);
+        data = static_cast<const byte *>(p);
+    }
+    ::close(fd); // 映射建立后即可关闭 fd
+    try {
+        return std::make_shared<MappedBodySource>(data, size);
+    } catch (const std::bad_alloc &) {
+        if (data) {
+            ::munmap(const_cast<byte *>(data), size);
+        }
+        ec = make_error_code(errc::out_of_memory);
+        return nullptr;
+    }
+#endif
+}
+
+#if !defined(_WIN32)
+std::shared_ptr<BodySource>
+make_fd_body(int fd, std::uint64_t offset, std::size_t length) {
+    return std::make_shared<FdBodySource>(fd, offset, length, false);
+}
+#endif
+
+std::shared_ptr<BodySource> make_generator_body(std::size_t size, BodyChunkFn next) {
+    return std::make_shared<GeneratorBodySource>(size, std::move(next));
+}
+
+} // namespace secs::core
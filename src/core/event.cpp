@@ -4,6 +4,7 @@
 
 #include <asio/error.hpp>
 
+#include <memory>
 #include <new>
 
 namespace secs::core {
@@ -65,7 +66,8 @@ Event::async_wait(std::optional<steady_clock::duration> timeout) {
     auto ex = co_await asio::this_coro::executor;
     std::shared_ptr<asio::steady_timer> timer;
     try {
-        timer = std::make_shared<asio::steady_timer>(ex);
+        timer = std::allocate_shared<asio::steady_timer>(
+            RecyclingAllocator<asio::steady_timer>(), ex);
     } catch (const std::bad_alloc &) {
         co_return make_error_code(errc::out_of_memory);
     } catch (...) {
@@ -79,7 +81,7 @@ Event::async_wait(std::optional<steady_clock::duration> timeout) {
         timer->expires_at(asio::steady_timer::time_point::max());
     }
 
-    std::list<std::shared_ptr<asio::steady_timer>>::iterator it;
+    decltype(waiters_)::iterator it;
     try {
         it = waiters_.insert(waiters_.end(), timer);
     } catch (const std::bad_alloc &) {
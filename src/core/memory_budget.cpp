@@ -0,0 +1,289 @@
+#include "secs/core/memory_budget.hpp"
+
+#include "secs/core/error.hpp"
+
+#include <asio/as_tuple.hpp>
+#include <asio/post.hpp>
+#include <asio/steady_timer.hpp>
+#include <asio/this_coro.hpp>
+#include <asio/use_awaitable.hpp>
+
+#include <algorithm>
+#include <new>
+
+namespace secs::core {
+
+/*
+ * 等待者唤醒：授予/取消都在持锁时改写 state，再把“让定时器立即到期”投递到等待者
+ * 自己的执行器上执行（expires_after(0)：已挂起的 async_wait 被取消，
+ * 尚未挂起的 async_wait 立即完成），因此不会漏掉在 async_wait 之前到达的唤醒。
+ * 前提：async_acquire 在单线程执行器或 strand 上调用（与 Event 相同的约定）。
+ */
+struct MemoryBudget::Waiter final {
+    enum class State : std::uint8_t { pending, granted, cancelled };
+
+    Waiter(asio::any_io_executor ex, std::size_t n, const void *o)
+        : timer(std::move(ex)), bytes(n), owner(o) {}
+
+    asio::steady_timer timer;
+    std::size_t bytes{0};
+    const void *owner{nullptr};
+    State state{State::pending};
+
+    static void wake(const std::shared_ptr<Waiter> &w) noexcept {
+        try {
+            asio::post(w->timer.get_executor(),
+                       [w]() { w->timer.expires_after(duration::zero()); });
+        } catch (...) {
+            // 投递失败（内存不足）：等待者只能靠自身超时醒来。
+        }
+    }
+};
+
+struct MemoryBudget::Metrics final {
+    explicit Metrics(std::shared_ptr<metrics::Group> g)
+        : group(std::move(g)),
+          acquired(group->counter("secs_memory_budget_bytes_total",
+                                  "Inbound buffer bytes acquired from/released to the "
+                                  "process memory budget.",
+                                  {{"op", "acquire"}})),
+          released(group->counter("secs_memory_budget_bytes_total",
+                                  "Inbound buffer bytes acquired from/released to the "
+                                  "process memory budget.",
+                                  {{"op", "release"}})),
+          waits(group->counter("secs_memory_budget_waits_total",
+                               "Acquisitions that had to wait for budget (reads paused).")),
+          rejections(group->counter(
+              "secs_memory_budget_rejections_total",
+              "Acquisitions refused (budget exhausted, timed out or oversized).")),
+          wait_time(group->histogram("secs_memory_budget_wait_seconds",
+                                     "Time an acquisition waited for budget.",
+                                     {},
+                                     metrics::kNanosecondsToSeconds)) {}
+
+    std::shared_ptr<metrics::Group> group;
+    metrics::Counter &acquired;
+    metrics::Counter &released;
+    metrics::Counter &waits;
+    metrics::Counter &rejections;
+    metrics::Histogram &wait_time;
+};
+
+MemoryBudget::MemoryBudget(MemoryBudgetOptions options) : options_(std::move(options)) {
+    if (options_.metrics) {
+        metrics_ = std::make_unique<Metrics>(options_.metrics);
+    }
+}
+
+MemoryBudget::~MemoryBudget() = default;
+
+bool MemoryBudget::fits_(std::size_t n) const noexcept {
+    return options_.limit_bytes == 0 || n <= options_.limit_bytes - used_;
+}
+
+void MemoryBudget::note_acquired_(std::size_t n) noexcept {
+    used_ += n;
+    peak_ = std::max(peak_, used_);
+    if (metrics_) {
+        metrics_->acquired.add(n);
+    }
+}
+
+bool MemoryBudget::try_acquire(std::size_t n) noexcept {
+    if (n == 0) {
+        return true;
+    }
+    std::lock_guard lk(mu_);
+    if (!waiters_.empty() || !fits_(n)) {
+        ++rejections_;
+        if (metrics_) {
+            metrics_->rejections.add();
+        }
+        return false;
+    }
+    note_acquired_(n);
+    return true;
+}
+
+asio::awaitable<std::error_code>
+MemoryBudget::async_acquire(std::size_t n,
+                            std::optional<duration> timeout,
+                            const void *owner) {
+    if (n == 0) {
+        co_return std::error_code{};
+    }
+
+    // 在加锁之前取执行器：持锁区间内不出现 co_await（不会挂起）。
+    auto ex = co_await asio::this_coro::executor;
+    std::shared_ptr<Waiter> w;
+    {
+        std::lock_guard lk(mu_);
+        if (options_.limit_bytes != 0 && n > options_.limit_bytes) {
+            ++rejections_;
+            if (metrics_) {
+                metrics_->rejections.add();
+            }
+            co_return make_error_code(errc::buffer_overflow);
+        }
+        if (waiters_.empty() && fits_(n)) {
+            note_acquired_(n);
+            co_return std::error_code{};
+        }
+        try {
+            w = std::make_shared<Waiter>(std::move(ex), n, owner);
+            waiters_.push_back(w);
+        } catch (const std::bad_alloc &) {
+            co_return make_error_code(errc::out_of_memory);
+        }
+        ++waits_;
+        if (metrics_) {
+            metrics_->waits.add();
+        }
+    }
+
+    const auto started = steady_clock::now();
+    if (timeout.has_value()) {
+        w->timer.expires_after(*timeout);
+    } else {
+        w->timer.expires_at(steady_clock::time_point::max());
+    }
+    (void)co_await w->timer.async_wait(asio::as_tuple(asio::use_awaitable));
+
+    std::lock_guard lk(mu_);
+    if (metrics_) {
+        metrics_->wait_time.record_duration(steady_clock::now() - started);
+    }
+    if (w->state == Waiter::State::granted) {
+        co_return std::error_code{};
+    }
+    waiters_.remove(w);
+    // 排在队首的等待者离开后，后面较小的请求可能已可满足。
+    grant_waiters_();
+    ++rejections_;
+    if (metrics_) {
+        metrics_->rejections.add();
+    }
+    co_return make_error_code(w->state == Waiter::State::cancelled ? errc::cancelled
+                                                                   : errc::timeout);
+}
+
+void MemoryBudget::grant_waiters_() noexcept {
+    while (!waiters_.empty()) {
+        auto &w = waiters_.front();
+        if (!fits_(w->bytes)) {
+            break;
+        }
+        note_acquired_(w->bytes);
+        w->state = Waiter::State::granted;
+        Waiter::wake(w);
+        waiters_.pop_front();
+    }
+}
+
+void MemoryBudget::release(std::size_t n) noexcept {
+    if (n == 0) {
+        return;
+    }
+    std::lock_guard lk(mu_);
+    used_ -= std::min(n, used_);
+    if (metrics_) {
+        metrics_->released.add(n);
+    }
+    grant_waiters_();
+}
+
+void MemoryBudget::cancel_waits(const void *owner) noexcept {
+    if (!owner) {
+        return;
+    }
+    std::lock_guard lk(mu_);
+    for (auto it = waiters_.begin(); it != waiters_.end();) {
+        if ((*it)->owner != owner) {
+            ++it;
+            continue;
+        }
+        (*it)->state = Waiter::State::cancelled;
+        Waiter::wake(*it);
+        it = waiters_.erase(it);
+    }
+    grant_waiters_();
+}
+
+std::size_t MemoryBudget::used() const noexcept {
+    std::lock_guard lk(mu_);
+    return used_;
+}
+
+std::size_t MemoryBudget::peak() const noexcept {
+    std::lock_guard lk(mu_);
+    return peak_;
+}
+
+std::size_t MemoryBudget::waiting() const noexcept {
+    std::lock_guard lk(mu_);
+    return waiters_.size();
+}
+
+double MemoryBudget::utilization() const noexcept {
+    if (options_.limit_bytes == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(used()) / static_cast<double>(options_.limit_bytes);
+}
+
+std::uint64_t MemoryBudget::waits() const noexcept {
+    std::lock_guard lk(mu_);
+    return waits_;
+}
+
+std::uint64_t MemoryBudget::rejections() const noexcept {
+    std::lock_guard lk(mu_);
+    return rejections_;
+}
+
+MemoryReservation::MemoryReservation(MemoryReservation &&other) noexcept
+    : budget_(std::move(other.budget_)), bytes_(other.bytes_) {
+    other.bytes_ = 0;
+}
+
+MemoryReservation &MemoryReservation::operator=(MemoryReservation &&other) noexcept {
+    if (this != &other) {
+        reset();
+        budget_ = std::move(other.budget_);
+        bytes_ = other.bytes_;
+        other.bytes_ = 0;
+    }
+    return *this;
+}
+
+bool MemoryReservation::try_grow(std::size_t n) noexcept {
+    if (budget_ && !budget_->try_acquire(n)) {
+        return false;
+    }
+    bytes_ += n;
+    return true;
+}
+
+void MemoryReservation::shrink(std::size_t n) noexcept {
+    n = std::min(n, bytes_);
+    if (budget_) {
+        budget_->release(n);
+    }
+    bytes_ -= n;
+}
+
+void MemoryReservation::reset() noexcept { shrink(bytes_); }
+
+MemoryLease make_memory_lease(MemoryReservation &&reservation) noexcept {
+    if (reservation.bytes() == 0) {
+        return nullptr;
+    }
+    try {
+        return std::make_shared<const MemoryReservation>(std::move(reservation));
+    } catch (...) {
+        reservation.reset();
+        return nullptr;
+    }
+}
+
+} // namespace secs::core
@@ -0,0 +1,464 @@
+#include "secs/core/metrics.hpp"
+
+#include "secs/core/error.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <new>
+
+namespace secs::core::metrics {
+namespace {
+
+/*
+ * 指标子系统的约束：
+ * - 记录路径（Counter::add / Histogram::record）只做 relaxed 原子加，不加锁、
+ *   不分配；未启用指标的组件只付出一次空指针判断；
+ * - 抓取路径（Registry::snapshot / render_prometheus）允许加锁与分配，
+ *   频率由外部 scrape 决定（通常秒级）。
+ */
+
+void append_u64(std::string &out, std::uint64_t v) {
+    char buf[24];
+    const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, r.ptr);
+}
+
+void append_double(std::string &out, double v) {
+    if (std::isinf(v)) {
+        out += v > 0 ? "+Inf" : "-Inf";
+        return;
+    }
+    if (std::isnan(v)) {
+        out += "NaN";
+        return;
+    }
+    char buf[32];
+    const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, r.ptr);
+}
+
+// 换算单位：scale 为 1/N（如纳秒 -> 秒）时改用除法，避免 3*1e-9 这类
+// 乘法误差把 le 渲染成 3.0000000000000004e-09。
+[[nodiscard]] double apply_scale(double v, double scale) noexcept {
+    if (scale > 0.0 && scale < 1.0) {
+        const double inv = std::round(1.0 / scale);
+        if (std::abs(inv * scale - 1.0) < 1e-12) {
+            return v / inv;
+        }
+    }
+    return v * scale;
+}
+
+// scale==1 时按整数输出（字节数、计数），否则按浮点输出（秒）。
+void append_scaled(std::string &out, std::uint64_t v, double scale) {
+    if (scale == 1.0) {
+        append_u64(out, v);
+    } else {
+        append_double(out, apply_scale(static_cast<double>(v), scale));
+    }
+}
+
+void append_escaped(std::string &out, std::string_view s, bool escape_quote) {
+    for (const char c : s) {
+        if (c == '\\') {
+            out += "\\\\";
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if (c == '"' && escape_quote) {
+            out += "\\\"";
+        } else {
+            out += c;
+        }
+    }
+}
+
+// 输出 {k="v",...,le="x"}；labels 为空且无 le 时不输出花括号。
+void append_labels(std::string &out,
+                   const Labels &labels,
+                   std::string_view le = {}) {
+    if (labels.empty() && le.empty()) {
+        return;
+    }
+    out += '{';
+    bool first = true;
+    for (const auto &[k, v] : labels) {
+        if (!first) {
+            out += ',';
+        }
+        first = false;
+        out += k;
+        out += "=\"";
+        append_escaped(out, v, true);
+        out += '"';
+    }
+    if (!le.empty()) {
+        if (!first) {
+            out += ',';
+        }
+        out += "le=\"";
+        out += le;
+        out += '"';
+    }
+    out += '}';
+}
+
+[[nodiscard]] bool ends_with(std::string_view s, std::string_view suffix) noexcept {
+    return s.size() >= suffix.size() &&
+           s.substr(s.size() - suffix.size()) == suffix;
+}
+
+// 2 的幂粗粒度区间：0 -> 0；[2^(k-1), 2^k-1] -> k（1..64）。
+[[nodiscard]] unsigned coarse_index(std::uint64_t v) noexcept {
+    return static_cast<unsigned>(std::bit_width(v));
+}
+
+[[nodiscard]] std::uint64_t coarse_upper_bound(unsigned k) noexcept {
+    return k >= 64 ? std::numeric_limits<std::uint64_t>::max()
+                   : (std::uint64_t{1} << k) - 1U;
+}
+
+void render_histogram(std::string &out,
+                      const MetricSample &s,
+                      std::string_view name) {
+    const auto &h = s.histogram;
+
+    std::array<std::uint64_t, 65> coarse{};
+    for (std::size_t i = 0; i < h.buckets.size(); ++i) {
+        if (h.buckets[i] != 0) {
+            coarse[coarse_index(Histogram::bucket_lower_bound(i))] += h.buckets[i];
+        }
+    }
+
+    unsigned first = 0;
+    unsigned last = 0;
+    bool any = false;
+    for (unsigned k = 0; k < coarse.size(); ++k) {
+        if (coarse[k] != 0) {
+            if (!any) {
+                first = k;
+            }
+            last = k;
+            any = true;
+        }
+    }
+
+    std::string le;
+    std::uint64_t cumulative = 0;
+    if (any) {
+        for (unsigned k = first; k <= last; ++k) {
+            cumulative += coarse[k];
+            le.clear();
+            append_double(
+                le, apply_scale(static_cast<double>(coarse_upper_bound(k)), s.scale));
+            out += name;
+            out += "_bucket";
+            append_labels(out, s.labels, le);
+            out += ' ';
+            append_u64(out, cumulative);
+            out += '\n';
+        }
+    }
+
+    out += name;
+    out += "_bucket";
+    append_labels(out, s.labels, "+Inf");
+    out += ' ';
+    append_u64(out, h.count);
+    out += '\n';
+
+    out += name;
+    out += "_sum";
+    append_labels(out, s.labels);
+    out += ' ';
+    append_scaled(out, h.sum, s.scale);
+    out += '\n';
+
+    out += name;
+    out += "_count";
+    append_labels(out, s.labels);
+    out += ' ';
+    append_u64(out, h.count);
+    out += '\n';
+}
+
+} // namespace
+
+// ----------------------------- Counter -----------------------------
+
+std::size_t Counter::shard_index_() noexcept {
+    // 每个线程首次使用时领取一个分片号（轮转），此后固定。
+    static std::atomic<std::size_t> next{0};
+    thread_local const std::size_t index =
+        next.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return index;
+}
+
+std::uint64_t Counter::value() const noexcept {
+    std::uint64_t total = 0;
+    for (const auto &s : shards_) {
+        total += s.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+// ----------------------------- Histogram -----------------------------
+
+std::size_t Histogram::bucket_index(std::uint64_t v) noexcept {
+    if (v < kSubBucketCount) {
+        return static_cast<std::size_t>(v);
+    }
+    const auto e = static_cast<unsigned>(63 - std::countl_zero(v));
+    const auto sub = static_cast<std::size_t>((v >> (e - kSubBucketBits)) &
+                                              (kSubBucketCount - 1U));
+    return (e - kSubBucketBits + 1U) * kSubBucketCount + sub;
+}
+
+std::uint64_t Histogram::bucket_lower_bound(std::size_t index) noexcept {
+    if (index < kSubBucketCount) {
+        return index;
+    }
+    const auto e = static_cast<unsigned>(index / kSubBucketCount) + kSubBucketBits - 1U;
+    const auto sub = static_cast<std::uint64_t>(index % kSubBucketCount);
+    return (kSubBucketCount + sub) << (e - kSubBucketBits);
+}
+
+std::uint64_t Histogram::bucket_upper_bound(std::size_t index) noexcept {
+    if (index < kSubBucketCount) {
+        return index;
+    }
+    const auto e = static_cast<unsigned>(index / kSubBucketCount) + kSubBucketBits - 1U;
+    return bucket_lower_bound(index) + ((std::uint64_t{1} << (e - kSubBucketBits)) - 1U);
+}
+
+void Histogram::record(std::uint64_t v) noexcept {
+    buckets_[bucket_index(v)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(v, std::memory_order_relaxed);
+
+    auto cur = max_.load(std::memory_order_relaxed);
+    while (v > cur &&
+           !max_.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::record_duration(duration d) noexcept {
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    record(ns < 0 ? 0U : static_cast<std::uint64_t>(ns));
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+    HistogramSnapshot out;
+    out.buckets.resize(kBucketCount);
+    // count 由桶求和得到，保证与桶分布自洽（+Inf 桶 == _count）。
+    for (std::size_t i = 0; i < kBucketCount; ++i) {
+        const auto n = buckets_[i].load(std::memory_order_relaxed);
+        out.buckets[i] = n;
+        out.count += n;
+    }
+    out.sum = sum_.load(std::memory_order_relaxed);
+    out.max = max_.load(std::memory_order_relaxed);
+    return out;
+}
+
+std::uint64_t HistogramSnapshot::value_at_quantile(double q) const noexcept {
+    if (count == 0 || buckets.empty()) {
+        return 0;
+    }
+    q = std::clamp(q, 0.0, 1.0);
+    auto rank = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(count)));
+    rank = std::clamp<std::uint64_t>(rank, 1U, count);
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(Histogram::bucket_upper_bound(i), max);
+        }
+    }
+    return max;
+}
+
+// ----------------------------- Group / Registry -----------------------------
+
+Group::Group(Registry &registry, Labels labels)
+    : registry_(registry), labels_(std::move(labels)) {
+    registry_.add_(this);
+}
+
+Group::~Group() { registry_.remove_(this); }
+
+Group::Entry *Group::find_(std::string_view name,
+                           const Labels &extra_labels) noexcept {
+    for (auto &e : entries_) {
+        if (e.name == name && e.labels == extra_labels) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+Counter &Group::counter(std::string_view name,
+                        std::string_view help,
+                        const Labels &extra_labels) {
+    std::lock_guard lk(registry_.mu_);
+    if (auto *e = find_(name, extra_labels); e && e->counter) {
+        return *e->counter;
+    }
+    entries_.reserve(entries_.size() + 1U);
+    auto &c = counters_.emplace_back();
+    entries_.push_back(Entry{std::string(name),
+                             std::string(help),
+                             extra_labels,
+                             MetricType::counter,
+                             1.0,
+                             &c,
+                             nullptr});
+    return c;
+}
+
+Histogram &Group::histogram(std::string_view name,
+                            std::string_view help,
+                            const Labels &extra_labels,
+                            double scale) {
+    std::lock_guard lk(registry_.mu_);
+    if (auto *e = find_(name, extra_labels); e && e->histogram) {
+        return *e->histogram;
+    }
+    entries_.reserve(entries_.size() + 1U);
+    auto &h = histograms_.emplace_back();
+    entries_.push_back(Entry{std::string(name),
+                             std::string(help),
+                             extra_labels,
+                             MetricType::histogram,
+                             scale,
+                             nullptr,
+                             &h});
+    return h;
+}
+
+std::shared_ptr<Group> Registry::make_group(Labels labels) {
+    return std::make_shared<Group>(*this, std::move(labels));
+}
+
+void Registry::add_(Group *group) {
+    std::lock_guard lk(mu_);
+    groups_.push_back(group);
+}
+
+void Registry::remove_(Group *group) noexcept {
+    std::lock_guard lk(mu_);
+    const auto it = std::find(groups_.begin(), groups_.end(), group);
+    if (it != groups_.end()) {
+        groups_.erase(it);
+    }
+}
+
+std::error_code Registry::snapshot(Snapshot &out) const noexcept {
+    try {
+        out.samples.clear();
+        {
+            std::lock_guard lk(mu_);
+            for (const auto *g : groups_) {
+                for (const auto &e : g->entries_) {
+                    MetricSample s;
+                    s.name = e.name;
+                    s.help = e.help;
+                    s.labels.reserve(g->labels_.size() + e.labels.size());
+                    s.labels = g->labels_;
+                    s.labels.insert(s.labels.end(), e.labels.begin(), e.labels.end());
+                    s.type = e.type;
+                    s.scale = e.scale;
+                    if (e.counter) {
+                        s.value = e.counter->value();
+                    } else if (e.histogram) {
+                        s.histogram = e.histogram->snapshot();
+                        s.value = s.histogram.count;
+                    }
+                    out.samples.push_back(std::move(s));
+                }
+            }
+        }
+
+        std::stable_sort(out.samples.begin(),
+                         out.samples.end(),
+                         [](const MetricSample &a, const MetricSample &b) {
+                             if (a.name != b.name) {
+                                 return a.name < b.name;
+                             }
+                             return a.labels < b.labels;
+                         });
+        return {};
+    } catch (const std::bad_alloc &) {
+        return make_error_code(errc::out_of_memory);
+    } catch (...) {
+        return make_error_code(errc::invalid_argument);
+    }
+}
+
+Registry &default_registry() noexcept {
+    static Registry registry;
+    return registry;
+}
+
+// ----------------------------- 渲染 -----------------------------
+
+std::error_code render_prometheus(const Snapshot &snapshot,
+                                  std::string &out,
+                                  bool openmetrics) noexcept {
+    try {
+        const auto &samples = snapshot.samples;
+        std::size_t i = 0;
+        while (i < samples.size()) {
+            const auto &head = samples[i];
+            const bool is_counter = head.type == MetricType::counter;
+
+            // OpenMetrics：counter family 名不带 _total，样本名带 _total。
+            std::string_view family = head.name;
+            std::string sample_name = head.name;
+            if (openmetrics && is_counter) {
+                if (ends_with(family, "_total")) {
+                    family.remove_suffix(6);
+                } else {
+                    sample_name += "_total";
+                }
+            }
+
+            out += "# HELP ";
+            out += family;
+            out += ' ';
+            append_escaped(out, head.help, false);
+            out += '\n';
+            out += "# TYPE ";
+            out += family;
+            out += is_counter ? " counter\n" : " histogram\n";
+
+            for (; i < samples.size() && samples[i].name == head.name; ++i) {
+                const auto &s = samples[i];
+                if (s.type != head.type) {
+                    continue; // 同名不同类型：只保留 family 首个类型
+                }
+                if (s.type == MetricType::counter) {
+                    out += sample_name;
+                    append_labels(out, s.labels);
+                    out += ' ';
+                    append_u64(out, s.value);
+                    out += '\n';
+                } else {
+                    render_histogram(out, s, s.name);
+                }
+            }
+        }
+        if (openmetrics) {
+            out += "# EOF\n";
+        }
+        return {};
+    } catch (const std::bad_alloc &) {
+        return make_error_code(errc::out_of_memory);
+    } catch (...) {
+        return make_error_code(errc::invalid_argument);
+    }
+}
+
+} // namespace secs::core::metrics
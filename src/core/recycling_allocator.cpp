@@ -0,0 +1,88 @@
+#include "secs/core/recycling_allocator.hpp"
+
+namespace secs::core::detail {
+
+namespace {
+
+constexpr std::size_t kClassCount =
+    ThreadBlockCache::kMaxBlockSize / ThreadBlockCache::kGranularity;
+
+struct FreeBlock final {
+    FreeBlock *next;
+};
+
+struct Cache final {
+    FreeBlock *heads[kClassCount]{};
+    std::size_t counts[kClassCount]{};
+
+    ~Cache();
+};
+
+// 线程的 thread_local 析构之后仍可能有块被释放（例如该线程上最后析构的对象）：
+// 置位后一律直接交还 ::operator delete，不再访问已析构的缓存。
+thread_local bool t_cache_destroyed = false;
+thread_local Cache t_cache;
+
+Cache::~Cache() {
+    t_cache_destroyed = true;
+    for (auto *&head : heads) {
+        while (head) {
+            FreeBlock *next = head->next;
+            ::operator delete(head);
+            head = next;
+        }
+    }
+}
+
+std::size_t class_of(std::size_t size) noexcept {
+    return (size - 1) / ThreadBlockCache::kGranularity;
+}
+
+} // namespace
+
+void *ThreadBlockCache::allocate(std::size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    if (size > kMaxBlockSize) {
+        return ::operator new(size);
+    }
+
+    const auto c = class_of(size);
+    if (!t_cache_destroyed) {
+        auto &cache = t_cache;
+        if (FreeBlock *block = cache.heads[c]) {
+            cache.heads[c] = block->next;
+            --cache.counts[c];
+            return block;
+        }
+    }
+    // 按级别尺寸分配：块释放后可服务同级的任意请求。
+    return ::operator new((c + 1) * kGranularity);
+}
+
+void ThreadBlockCache::deallocate(void *p, std::size_t size) noexcept {
+    if (!p) {
+        return;
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    if (size > kMaxBlockSize || t_cache_destroyed) {
+        ::operator delete(p);
+        return;
+    }
+
+    const auto c = class_of(size);
+    auto &cache = t_cache;
+    if (cache.counts[c] >= kMaxCachedPerClass) {
+        ::operator delete(p);
+        return;
+    }
+    auto *block = static_cast<FreeBlock *>(p);
+    block->next = cache.heads[c];
+    cache.heads[c] = block;
+    ++cache.counts[c];
+}
+
+} // namespace secs::core::detail
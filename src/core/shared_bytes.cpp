@@ -0,0 +1,72 @@
+#include "secs/core/shared_bytes.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+namespace secs::core {
+
+/*
+ * SharedBytes 存储：
+ * - copy()：一次分配 [headroom | payload]，负载只拷贝一次；
+ * - adopt()：直接持有传入的 vector，不拷贝、无 headroom。
+ *
+ * headroom 是“可写”的唯一区域：claim_headroom() 用原子标志保证同一时刻只有一个
+ * 写出方在其中放置帧前缀，负载本身始终只读。
+ */
+struct SharedBytes::Storage final {
+    std::unique_ptr<byte[]> raw{};
+    std::vector<byte> adopted{};
+    std::size_t headroom{0};
+    std::atomic<bool> headroom_busy{false};
+};
+
+SharedBytes SharedBytes::copy(bytes_view data, std::size_t headroom) {
+    auto storage = std::make_shared<Storage>();
+    storage->raw = std::make_unique_for_overwrite<byte[]>(headroom + data.size());
+    storage->headroom = headroom;
+    if (!data.empty()) {
+        std::memcpy(storage->raw.get() + headroom, data.data(), data.size());
+    }
+
+    SharedBytes out;
+    out.data_ = storage->raw.get() + headroom;
+    out.size_ = data.size();
+    out.storage_ = std::move(storage);
+    return out;
+}
+
+SharedBytes SharedBytes::adopt(std::vector<byte> &&data) {
+    auto storage = std::make_shared<Storage>();
+    storage->adopted = std::move(data);
+
+    SharedBytes out;
+    out.data_ = storage->adopted.data();
+    out.size_ = storage->adopted.size();
+    out.storage_ = std::move(storage);
+    return out;
+}
+
+std::size_t SharedBytes::headroom() const noexcept {
+    return storage_ ? storage_->headroom : 0;
+}
+
+bytes_view SharedBytes::claim_headroom(bytes_view prefix) const noexcept {
+    if (!storage_ || prefix.empty() || prefix.size() > storage_->headroom) {
+        return {};
+    }
+    if (storage_->headroom_busy.exchange(true, std::memory_order_acquire)) {
+        return {};
+    }
+    auto *begin = const_cast<byte *>(data_) - prefix.size();
+    std::memcpy(begin, prefix.data(), prefix.size());
+    return bytes_view{begin, prefix.size() + size_};
+}
+
+void SharedBytes::release_headroom() const noexcept {
+    if (storage_) {
+        storage_->headroom_busy.store(false, std::memory_order_release);
+    }
+}
+
+} // namespace secs::core
@@ -0,0 +1,518 @@
+#include "secs/hsms/capture.hpp"
+
+#include "secs/core/error.hpp"
+#include "secs/hsms/connection.hpp"
+#include "secs/hsms/message.hpp"
+
+#include <asio/as_tuple.hpp>
+#include <asio/steady_timer.hpp>
+#include <asio/use_awaitable.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <new>
+
+namespace secs::hsms {
+namespace {
+
+constexpr std::array<core::byte, 8> kMagic{'S', 'E', 'C', 'S', 'C', 'A', 'P', '\0'};
+constexpr std::size_t kMinRingSize = 4096;
+
+void put_u16_be(core::byte *p, std::uint16_t v) noexcept {
+    p[0] = static_cast<core::byte>(v >> 8U);
+    p[1] = static_cast<core::byte>(v);
+}
+
+void put_u32_be(core::byte *p, std::uint32_t v) noexcept {
+    for (int i = 3; i >= 0; --i) {
+        p[i] = static_cast<core::byte>(v);
+        v >>= 8U;
+    }
+}
+
+void put_u64_be(core::byte *p, std::uint64_t v) noexcept {
+    for (int i = 7; i >= 0; --i) {
+        p[i] = static_cast<core::byte>(v);
+        v >>= 8U;
+    }
+}
+
+[[nodiscard]] std::uint16_t get_u16_be(const core::byte *p) noexcept {
+    return static_cast<std::uint16_t>((static_cast<std::uint16_t>(p[0]) << 8U) | p[1]);
+}
+
+[[nodiscard]] std::uint32_t get_u32_be(const core::byte *p) noexcept {
+    std::uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) {
+        v = (v << 8U) | p[i];
+    }
+    return v;
+}
+
+[[nodiscard]] std::uint64_t get_u64_be(const core::byte *p) noexcept {
+    std::uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) {
+        v = (v << 8U) | p[i];
+    }
+    return v;
+}
+
+void encode_record_header(core::byte *p,
+                          std::uint64_t timestamp_ns,
+                          std::uint32_t frame_len,
+                          std::uint16_t session_id,
+                          CaptureDirection direction) noexcept {
+    put_u64_be(p, timestamp_ns);
+    put_u32_be(p + 8, frame_len);
+    put_u16_be(p + 12, session_id);
+    p[14] = static_cast<core::byte>(direction);
+    p[15] = 0;
+}
+
+[[nodiscard]] std::size_t round_up_pow2(std::size_t n) noexcept {
+    std::size_t v = kMinRingSize;
+    while (v < n) {
+        v <<= 1U;
+    }
+    return v;
+}
+
+} // namespace
+
+void append_capture_file_header(std::vector<core::byte> &out) {
+    std::array<core::byte, kCaptureFileHeaderSize> h{};
+    std::memcpy(h.data(), kMagic.data(), kMagic.size());
+    put_u16_be(h.data() + 8, kCaptureVersion);
+    put_u16_be(h.data() + 10, static_cast<std::uint16_t>(kCaptureFileHeaderSize));
+    out.insert(out.end(), h.begin(), h.end());
+}
+
+std::error_code append_capture_record(const CaptureRecordView &record,
+                                      std::vector<core::byte> &out) noexcept {
+    if (record.frame.size() > std::numeric_limits<std::uint32_t>::max()) {
+        return core::make_error_code(core::errc::buffer_overflow);
+    }
+    try {
+        const auto old = out.size();
+        out.resize(old + kCaptureRecordHeaderSize + record.frame.size());
+        encode_record_header(out.data() + old,
+                             record.timestamp_ns,
+                             static_cast<std::uint32_t>(record.frame.size()),
+                             record.session_id,
+                             record.direction);
+        if (!record.frame.empty()) {
+            std::memcpy(out.data() + old + kCaptureRecordHeaderSize,
+                        record.frame.data(),
+                        record.frame.size());
+        }
+    } catch (const std::bad_alloc &) {
+        return core::make_error_code(core::errc::out_of_memory);
+    } catch (...) {
+        return core::make_error_code(core::errc::invalid_argument);
+    }
+    return {};
+}
+
+std::uint64_t capture_now_ns() noexcept {
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    return ns.count() < 0 ? 0U : static_cast<std::uint64_t>(ns.count());
+}
+
+std::error_code CaptureReader::open(core::bytes_view data) noexcept {
+    data_ = {};
+    offset_ = 0;
+    error_ = {};
+    if (data.size() < kCaptureFileHeaderSize ||
+        std::memcmp(data.data(), kMagic.data(), kMagic.size()) != 0 ||
+        get_u16_be(data.data() + 8) != kCaptureVersion) {
+        return core::make_error_code(core::errc::invalid_argument);
+    }
+    const auto header_size = get_u16_be(data.data() + 10);
+    if (header_size < kCaptureFileHeaderSize || header_size > data.size()) {
+        return core::make_error_code(core::errc::invalid_argument);
+    }
+    data_ = data;
+    offset_ = header_size;
+    return {};
+}
+
+bool CaptureReader::next(CaptureRecordView &out) noexcept {
+    if (error_ || offset_ >= data_.size()) {
+        return false;
+    }
+    const auto remaining = data_.size() - offset_;
+    if (remaining < kCaptureRecordHeaderSize) {
+        error_ = core::make_error_code(core::errc::invalid_argument);
+        return false;
+    }
+    const auto *p = data_.data() + offset_;
+    const auto frame_len = static_cast<std::size_t>(get_u32_be(p + 8));
+    const auto direction = p[14];
+    if (frame_len > remaining - kCaptureRecordHeaderSize ||
+        direction > static_cast<core::byte>(CaptureDirection::tx)) {
+        error_ = core::make_error_code(core::errc::invalid_argument);
+        return false;
+    }
+
+    out.timestamp_ns = get_u64_be(p);
+    out.session_id = get_u16_be(p + 12);
+    out.direction = static_cast<CaptureDirection>(direction);
+    out.frame = data_.subspan(offset_ + kCaptureRecordHeaderSize, frame_len);
+    offset_ += kCaptureRecordHeaderSize + frame_len;
+    return true;
+}
+
+std::error_code load_capture_file(const std::string &path,
+                                  std::vector<core::byte> &out) noexcept {
+    try {
+        std::ifstream f(path, std::ios::in | std::ios::binary);
+        if (!f) {
+            return std::make_error_code(std::errc::no_such_file_or_directory);
+        }
+        out.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        if (f.bad()) {
+            return std::make_error_code(std::errc::io_error);
+        }
+    } catch (const std::bad_alloc &) {
+        return core::make_error_code(core::errc::out_of_memory);
+    } catch (...) {
+        return core::make_error_code(core::errc::invalid_argument);
+    }
+    return {};
+}
+
+CaptureChannel::CaptureChannel(std::uint16_t session_id, std::size_t ring_size)
+    : session_id_(session_id) {
+    const auto size = round_up_pow2(ring_size);
+    for (auto &ring : rings_) {
+        ring.data = std::make_unique_for_overwrite<core::byte[]>(size);
+        ring.mask = size - 1U;
+    }
+}
+
+bool CaptureChannel::try_push(CaptureDirection direction,
+                              core::bytes_view head,
+                              core::bytes_view body) noexcept {
+    if (closed_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    auto &ring = rings_[static_cast<std::size_t>(direction) & 1U];
+    const auto frame_len = head.size() + body.size();
+    const auto need = kCaptureRecordHeaderSize + frame_len;
+    const auto capacity = ring.mask + 1U;
+
+    const auto h = ring.head.load(std::memory_order_relaxed);
+    const auto t = ring.tail.load(std::memory_order_acquire);
+    if (frame_len > std::numeric_limits<std::uint32_t>::max() ||
+        need > capacity - static_cast<std::size_t>(h - t)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    std::array<core::byte, kCaptureRecordHeaderSize> header{};
+    encode_record_header(header.data(),
+                         capture_now_ns(),
+                         static_cast<std::uint32_t>(frame_len),
+                         session_id_,
+                         direction);
+
+    // 环形拷贝：超过末尾的部分回绕到开头。
+    auto pos = h;
+    const auto copy_in = [&](core::bytes_view src) noexcept {
+        if (src.empty()) {
+            return;
+        }
+        const auto at = static_cast<std::size_t>(pos) & ring.mask;
+        const auto first = std::min(src.size(), capacity - at);
+        std::memcpy(ring.data.get() + at, src.data(), first);
+        if (first < src.size()) {
+            std::memcpy(ring.data.get(), src.data() + first, src.size() - first);
+        }
+        pos += src.size();
+    };
+    copy_in(core::bytes_view{header.data(), header.size()});
+    copy_in(head);
+    copy_in(body);
+
+    ring.head.store(pos, std::memory_order_release);
+    return true;
+}
+
+void CaptureChannel::drain_(Ring &ring, std::vector<core::byte> &out) {
+    const auto h = ring.head.load(std::memory_order_acquire);
+    const auto t = ring.tail.load(std::memory_order_relaxed);
+    const auto n = static_cast<std::size_t>(h - t);
+    if (n == 0) {
+        return;
+    }
+    const auto capacity = ring.mask + 1U;
+    const auto at = static_cast<std::size_t>(t) & ring.mask;
+    const auto first = std::min(n, capacity - at);
+
+    const auto old = out.size();
+    out.resize(old + n);
+    std::memcpy(out.data() + old, ring.data.get() + at, first);
+    if (first < n) {
+        std::memcpy(out.data() + old + first, ring.data.get(), n - first);
+    }
+    ring.tail.store(h, std::memory_order_release);
+}
+
+CaptureWriter::CaptureWriter(CaptureWriterOptions options)
+    : options_(std::move(options)) {}
+
+CaptureWriter::~CaptureWriter() { close(); }
+
+std::error_code CaptureWriter::open(const std::string &path) noexcept {
+    std::lock_guard lk(mu_);
+    if (file_ || stopping_) {
+        return core::make_error_code(core::errc::invalid_argument);
+    }
+
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        return {errno, std::generic_category()};
+    }
+    (void)std::setvbuf(f, nullptr, _IOFBF, std::size_t{1} << 20U);
+
+    try {
+        std::vector<core::byte> header;
+        append_capture_file_header(header);
+        if (std::fwrite(header.data(), 1, header.size(), f) != header.size()) {
+            (void)std::fclose(f);
+            return std::make_error_code(std::errc::io_error);
+        }
+        file_ = f;
+        thread_ = std::thread([this] { run_(); });
+    } catch (const std::bad_alloc &) {
+        (void)std::fclose(f);
+        file_ = nullptr;
+        return core::make_error_code(core::errc::out_of_memory);
+    } catch (...) {
+        (void)std::fclose(f);
+        file_ = nullptr;
+        return core::make_error_code(core::errc::invalid_argument);
+    }
+    return {};
+}
+
+std::error_code
+CaptureWriter::add_channel(std::uint16_t session_id,
+                           std::shared_ptr<CaptureChannel> &out) noexcept {
+    std::lock_guard lk(mu_);
+    if (!file_ || stopping_) {
+        return core::make_error_code(core::errc::invalid_argument);
+    }
+    try {
+        auto ch = std::make_shared<CaptureChannel>(session_id, options_.channel_ring_size);
+        channels_.push_back(ch);
+        out = std::move(ch);
+    } catch (const std::bad_alloc &) {
+        return core::make_error_code(core::errc::out_of_memory);
+    } catch (...) {
+        return core::make_error_code(core::errc::invalid_argument);
+    }
+    return {};
+}
+
+void CaptureWriter::close() noexcept {
+    {
+        std::lock_guard lk(mu_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+        for (const auto &ch : channels_) {
+            ch->closed_.store(true, std::memory_order_release);
+        }
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    std::lock_guard lk(mu_);
+    if (file_) {
+        if (std::fclose(file_) != 0 && !last_error_) {
+            last_error_ = std::make_error_code(std::errc::io_error);
+        }
+        file_ = nullptr;
+    }
+}
+
+std::uint64_t CaptureWriter::dropped() const noexcept {
+    std::lock_guard lk(mu_);
+    auto total = retired_dropped_;
+    for (const auto &ch : channels_) {
+        total += ch->dropped();
+    }
+    return total;
+}
+
+std::error_code CaptureWriter::last_error() const noexcept {
+    std::lock_guard lk(mu_);
+    return last_error_;
+}
+
+void CaptureWriter::run_() noexcept {
+    for (;;) {
+        bool stop = false;
+        {
+            std::unique_lock lk(mu_);
+            cv_.wait_for(lk, options_.flush_interval, [this] { return stopping_; });
+            stop = stopping_;
+        }
+
+        try {
+            flush_once_();
+        } catch (const std::bad_alloc &) {
+            std::lock_guard lk(mu_);
+            last_error_ = core::make_error_code(core::errc::out_of_memory);
+        } catch (...) {
+            std::lock_guard lk(mu_);
+            last_error_ = core::make_error_code(core::errc::invalid_argument);
+        }
+
+        if (stop) {
+            break;
+        }
+    }
+}
+
+void CaptureWriter::flush_once_() {
+    staging_.clear();
+    order_.clear();
+
+    // 抽取时不持锁：通道列表只会在本线程删除元素，add_channel 只追加，
+    // 因此按下标遍历并在每步短暂加锁取指针即可。
+    for (std::size_t i = 0;; ++i) {
+        std::shared_ptr<CaptureChannel> ch;
+        {
+            std::lock_guard lk(mu_);
+            if (i >= channels_.size()) {
+                break;
+            }
+            ch = channels_[i];
+        }
+        for (auto &ring : ch->rings_) {
+            ch->drain_(ring, staging_);
+        }
+    }
+
+    if (staging_.empty()) {
+        return;
+    }
+
+    // 切分记录（环内存放的已是文件格式），按时间戳稳定排序后写出。
+    bool sorted = true;
+    std::uint64_t last_ts = 0;
+    for (std::size_t off = 0; off < staging_.size();) {
+        const auto len = kCaptureRecordHeaderSize +
+                         static_cast<std::size_t>(get_u32_be(staging_.data() + off + 8));
+        const auto ts = get_u64_be(staging_.data() + off);
+        sorted = sorted && ts >= last_ts;
+        last_ts = ts;
+        order_.emplace_back(off, len);
+        off += len;
+    }
+
+    std::size_t written = 0;
+    if (sorted) {
+        written = std::fwrite(staging_.data(), 1, staging_.size(), file_);
+    } else {
+        std::stable_sort(order_.begin(), order_.end(), [this](const auto &a, const auto &b) {
+            return get_u64_be(staging_.data() + a.first) <
+                   get_u64_be(staging_.data() + b.first);
+        });
+        for (const auto &[off, len] : order_) {
+            written += std::fwrite(staging_.data() + off, 1, len, file_);
+        }
+    }
+    const bool write_ok = written == staging_.size() && std::fflush(file_) == 0;
+
+    records_written_.fetch_add(order_.size(), std::memory_order_relaxed);
+    bytes_written_.fetch_add(written, std::memory_order_relaxed);
+
+    std::lock_guard lk(mu_);
+    if (!write_ok) {
+        last_error_ = std::make_error_code(std::errc::io_error);
+    }
+    // 回收已无生产者（仅本 Writer 持有）且已抽空的通道。
+    std::erase_if(channels_, [this](const std::shared_ptr<CaptureChannel> &ch) {
+        if (ch.use_count() != 1) {
+            return false;
+        }
+        for (const auto &ring : ch->rings_) {
+            if (ring.head.load(std::memory_order_acquire) !=
+                ring.tail.load(std::memory_order_relaxed)) {
+                return false;
+            }
+        }
+        retired_dropped_ += ch->dropped();
+        return true;
+    });
+}
+
+asio::awaitable<std::pair<std::error_code, ReplayStats>>
+async_replay(Connection &conn, core::bytes_view capture, ReplayOptions options) {
+    ReplayStats stats;
+    CaptureReader reader;
+    if (auto ec = reader.open(capture)) {
+        co_return std::pair{ec, stats};
+    }
+
+    const auto started = core::steady_clock::now();
+    const bool paced = options.speed > 0.0;
+    asio::steady_timer timer(conn.executor());
+    std::optional<std::uint64_t> first_ts;
+
+    for (CaptureRecordView rec; reader.next(rec);) {
+        if (options.direction && rec.direction != *options.direction) {
+            continue;
+        }
+        if (options.session_id && rec.session_id != *options.session_id) {
+            continue;
+        }
+
+        Message msg;
+        std::size_t consumed = 0;
+        if (decode_frame(rec.frame, msg, consumed) || consumed != rec.frame.size()) {
+            co_return std::pair{core::make_error_code(core::errc::invalid_argument), stats};
+        }
+
+        if (paced) {
+            if (!first_ts) {
+                first_ts = rec.timestamp_ns;
+            }
+            const auto offset_ns =
+                rec.timestamp_ns > *first_ts ? rec.timestamp_ns - *first_ts : 0U;
+            const auto due =
+                started + std::chrono::duration_cast<core::duration>(
+                              std::chrono::duration<double, std::nano>(
+                                  static_cast<double>(offset_ns) / options.speed));
+            if (due > core::steady_clock::now()) {
+                timer.expires_at(due);
+                auto [ec] = co_await timer.async_wait(asio::as_tuple(asio::use_awaitable));
+                if (ec) {
+                    co_return std::pair{ec, stats};
+                }
+            }
+        }
+
+        if (auto ec = co_await conn.async_write_message(msg)) {
+            co_return std::pair{ec, stats};
+        }
+        ++stats.frames;
+        stats.bytes += rec.frame.size();
+    }
+
+    stats.elapsed = core::steady_clock::now() - started;
+    co_return std::pair{reader.error(), stats};
+}
+
+} // namespace secs::hsms
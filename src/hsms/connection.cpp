@@ -1,6 +1,8 @@
 #include "secs/hsms/connection.hpp"
 
 #include "secs/core/error.hpp"
+#include "secs/core/recycling_allocator.hpp"
+#include "secs/hsms/io_uring_stream.hpp"
 
 #include <asio/as_tuple.hpp>
 #include <asio/co_spawn.hpp>
@@ -8,10 +10,12 @@
 #include <asio/deferred.hpp>
 #include <asio/experimental/cancellation_condition.hpp>
 #include <asio/experimental/parallel_group.hpp>
+#include <asio/post.hpp>
 #include <asio/steady_timer.hpp>
 #include <asio/use_awaitable.hpp>
 #include <asio/write.hpp>
 
+#include <algorithm>
 #include <array>
 #include <new>
 #include <stdexcept>
@@ -32,8 +36,9 @@ namespace {
  * - 控制消息优先于 data 消息写出，避免 SELECT/SEPARATE 等控制流被 data 抢占。
  *
  * T8（网络字符间隔超时）：
- * - 采用“并行等待 read_some 与 timer”的方式实现；
- * - 若 timer 先到，则 cancel 底层流，让读协程尽快返回，再向上报告 timeout。
+ * - 默认采用“并行等待 read_some 与 timer”的方式实现；
+ * - 若 timer 先到，则 cancel 底层流，让读协程尽快返回，再向上报告 timeout；
+ * - 流支持单次读超时（Stream::has_native_read_timeout）时直接交给底层。
  */
 
 class TcpStream final : public Stream {
@@ -83,6 +88,22 @@ public:
         co_return std::error_code{};
     }
 
+    asio::awaitable<std::error_code>
+    async_write_gather(core::bytes_view head, core::bytes_view body) override {
+        const std::array<asio::const_buffer, 2> buffers{
+            asio::buffer(head.data(), head.size()),
+            asio::buffer(body.data(), body.size())};
+        auto [ec, n] = co_await asio::async_write(
+            socket_, buffers, asio::as_tuple(asio::use_awaitable));
+        if (ec) {
+            co_return ec;
+        }
+        if (n != head.size() + body.size()) {
+            co_return core::make_error_code(core::errc::invalid_argument);
+        }
+        co_return std::error_code{};
+    }
+
     asio::awaitable<std::error_code>
     async_connect(const asio::ip::tcp::endpoint &endpoint) override {
         auto [ec] = co_await socket_.async_connect(
@@ -95,18 +116,187 @@ private:
     asio::ip::tcp::socket socket_;
 };
 
+std::unique_ptr<Stream> make_stream(asio::any_io_executor ex, StreamBackend backend) {
+    if (backend == StreamBackend::io_uring) {
+        std::unique_ptr<Stream> stream;
+        if (!make_io_uring_stream(ex, stream)) {
+            return stream;
+        }
+        // io_uring 不可用（未编译/内核禁用）：回退到 TCP。
+    }
+    return std::make_unique<TcpStream>(ex);
+}
+
+std::unique_ptr<Stream> make_stream(asio::ip::tcp::socket socket,
+                                    StreamBackend backend) {
+    if (backend == StreamBackend::io_uring) {
+        std::unique_ptr<Stream> stream;
+        if (!make_io_uring_stream(socket, stream)) {
+            return stream;
+        }
+    }
+    return std::make_unique<TcpStream>(std::move(socket));
+}
+
 } // namespace
 
+asio::awaitable<std::error_code>
+Stream::async_write_gather(core::bytes_view head, core::bytes_view body) {
+    auto ec = co_await async_write_all(head);
+    if (ec || body.empty()) {
+        co_return ec;
+    }
+    co_return co_await async_write_all(body);
+}
+
+asio::awaitable<std::pair<std::error_code, std::size_t>>
+Stream::async_read_some_for(core::mutable_bytes_view dst, core::duration timeout) {
+    (void)timeout;
+    co_return co_await async_read_some(dst);
+}
+
+struct Connection::Metrics final {
+    explicit Metrics(std::shared_ptr<core::metrics::Group> g)
+        : group(std::move(g)),
+          frames_tx(group->counter("secs_hsms_frames_total",
+                                   "HSMS frames written/read.",
+                                   {{"direction", "tx"}})),
+          frames_rx(group->counter("secs_hsms_frames_total",
+                                   "HSMS frames written/read.",
+                                   {{"direction", "rx"}})),
+          bytes_tx(group->counter("secs_hsms_bytes_total",
+                                  "HSMS bytes written/read (including length field).",
+                                  {{"direction", "tx"}})),
+          bytes_rx(group->counter("secs_hsms_bytes_total",
+                                  "HSMS bytes written/read (including length field).",
+                                  {{"direction", "rx"}})),
+          t8_timeouts(group->counter("secs_hsms_t8_timeouts_total",
+                                     "HSMS T8 inter-character timeouts.")),
+          frame_size_tx(group->histogram("secs_hsms_frame_size_bytes",
+                                         "HSMS frame size.",
+                                         {{"direction", "tx"}})),
+          frame_size_rx(group->histogram("secs_hsms_frame_size_bytes",
+                                         "HSMS frame size.",
+                                         {{"direction", "rx"}})),
+          write_queue_wait(group->histogram(
+              "secs_hsms_write_queue_wait_seconds",
+              "Time a frame waits in the write queue before being written.",
+              {},
+              core::metrics::kNanosecondsToSeconds)) {}
+
+    std::shared_ptr<core::metrics::Group> group;
+    core::metrics::Counter &frames_tx;
+    core::metrics::Counter &frames_rx;
+    core::metrics::Counter &bytes_tx;
+    core::metrics::Counter &bytes_rx;
+    core::metrics::Counter &t8_timeouts;
+    core::metrics::Histogram &frame_size_tx;
+    core::metrics::Histogram &frame_size_rx;
+    core::metrics::Histogram &write_queue_wait;
+};
+
 Connection::Connection(asio::any_io_executor ex, ConnectionOptions options)
-    : stream_(std::make_unique<TcpStream>(ex)), options_(options) {}
+    : stream_(make_stream(ex, options.backend)), options_(std::move(options)) {
+    set_metrics(options_.metrics);
+}
 
 Connection::Connection(asio::ip::tcp::socket socket, ConnectionOptions options)
-    : stream_(std::make_unique<TcpStream>(std::move(socket))),
-      options_(options) {}
+    : stream_(make_stream(std::move(socket), options.backend)),
+      options_(std::move(options)) {
+    set_metrics(options_.metrics);
+}
 
 Connection::Connection(std::unique_ptr<Stream> stream,
                        ConnectionOptions options)
-    : stream_(std::move(stream)), options_(options) {}
+    : stream_(std::move(stream)), options_(std::move(options)) {
+    set_metrics(options_.metrics);
+}
+
+void Connection::set_metrics(std::shared_ptr<core::metrics::Group> group) noexcept {
+    metrics_.reset();
+    options_.metrics = group;
+    if (!group) {
+        return;
+    }
+    try {
+        metrics_ = std::make_shared<Metrics>(std::move(group));
+    } catch (...) {
+        // 指标仅用于观测：注册失败（内存不足）时关闭指标，不影响连接可用性。
+        options_.metrics.reset();
+    }
+}
+
+void Connection::set_capture(std::shared_ptr<CaptureChannel> channel) noexcept {
+    options_.capture = std::move(channel);
+}
+
+void Connection::set_data_priorities(std::vector<DataPriority> rules) noexcept {
+    options_.data_priorities = std::move(rules);
+}
+
+void Connection::set_body_sinks(std::vector<core::BodySinkRule> rules) noexcept {
+    options_.body_sinks = std::move(rules);
+}
+
+void Connection::set_memory_budget(std::shared_ptr<core::MemoryBudget> budget,
+                                   core::duration wait) noexcept {
+    if (options_.memory_budget) {
+        options_.memory_budget->cancel_waits(this);
+    }
+    options_.memory_budget = std::move(budget);
+    options_.memory_wait = wait;
+}
+
+std::error_code Connection::open_body_sink_(const Header &h,
+                                            std::size_t body_len,
+                                            std::shared_ptr<core::BodySink> &sink) {
+    const auto stream = static_cast<std::uint8_t>(h.header_byte2 & 0x7FU);
+    const auto *factory =
+        core::find_body_sink_factory(options_.body_sinks, stream, h.header_byte3);
+    if (!factory) {
+        return {};
+    }
+    try {
+        sink = (*factory)(core::BodySinkInfo{.stream = stream,
+                                             .function = h.header_byte3,
+                                             .system_bytes = h.system_bytes,
+                                             .size = body_len});
+    } catch (const std::bad_alloc &) {
+        return core::make_error_code(core::errc::out_of_memory);
+    } catch (...) {
+        return core::make_error_code(core::errc::invalid_argument);
+    }
+    return {};
+}
+
+std::uint8_t Connection::data_lane_(const Message &msg) const noexcept {
+    const auto stream = msg.stream();
+    const auto function = msg.function();
+    const DataPriority *stream_rule = nullptr;
+    for (const auto &rule : options_.data_priorities) {
+        if (rule.stream != stream) {
+            continue;
+        }
+        if (!rule.function.has_value()) {
+            if (stream_rule == nullptr) {
+                stream_rule = &rule;
+            }
+        } else if (*rule.function == function) {
+            stream_rule = &rule;
+            break;
+        }
+    }
+    const auto lane = stream_rule ? stream_rule->lane : kDefaultDataLane;
+    return std::min(lane, static_cast<std::uint8_t>(kDataPriorityLanes - 1));
+}
+
+std::size_t Connection::queued_writes_() const noexcept {
+    auto n = control_queue_.size();
+    for (const auto &q : data_queues_) {
+        n += q.size();
+    }
+    return n;
+}
 
 asio::any_io_executor Connection::executor() const noexcept {
     if (!stream_) {
@@ -143,6 +333,16 @@ asio::awaitable<std::error_code> Connection::async_close() {
     disable_data_writes(core::make_error_code(core::errc::cancelled));
     cancel_queued_writes_(core::make_error_code(core::errc::cancelled));
     write_ready_.cancel();
+    // 结束因内存预算被暂停的读协程。
+    if (options_.memory_budget) {
+        options_.memory_budget->cancel_waits(this);
+    }
+
+    // writer_loop_ 引用 *this（写队列与 write_ready_），被取消后要等下一轮调度才真正
+    // 退出；返回前等它结束，调用方随后才能安全地移动赋值/析构本对象（重连换连接）。
+    while (writer_running_) {
+        co_await asio::post(co_await asio::this_coro::executor, asio::use_awaitable);
+    }
     co_return std::error_code{};
 }
 
@@ -154,6 +354,10 @@ void Connection::cancel_and_close() noexcept {
     disable_data_writes(core::make_error_code(core::errc::cancelled));
     cancel_queued_writes_(core::make_error_code(core::errc::cancelled));
     write_ready_.cancel();
+    // 结束因内存预算被暂停的读协程。
+    if (options_.memory_budget) {
+        options_.memory_budget->cancel_waits(this);
+    }
 }
 
 void Connection::enable_data_writes() noexcept { data_writes_enabled_ = true; }
@@ -168,20 +372,60 @@ void Connection::cancel_queued_writes_(std::error_code reason) noexcept {
         req->ec = reason;
         req->done.set();
     }
-    for (auto &req : data_queue_) {
-        req->ec = reason;
-        req->done.set();
-    }
     control_queue_.clear();
-    data_queue_.clear();
+    cancel_queued_data_writes_(reason);
 }
 
 void Connection::cancel_queued_data_writes_(std::error_code reason) noexcept {
-    for (auto &req : data_queue_) {
-        req->ec = reason;
-        req->done.set();
+    for (auto &q : data_queues_) {
+        for (auto &req : q) {
+            req->ec = reason;
+            req->done.set();
+        }
+        q.clear();
     }
-    data_queue_.clear();
+}
+
+asio::awaitable<std::error_code>
+Connection::async_write_streamed_(core::bytes_view prefix, core::BodySource &source) {
+    // 来源已整体在内存中（mmap）：与 SharedBytes 相同，一次分散写。
+    const auto whole = source.contiguous();
+    if (!whole.empty() || source.size() == 0) {
+        auto ec = co_await stream_->async_write_gather(prefix, whole);
+        if (!ec && options_.capture) {
+            (void)options_.capture->try_push(CaptureDirection::tx, prefix, whole);
+        }
+        co_return ec;
+    }
+
+    const auto chunk_size = std::max<std::size_t>(options_.stream_chunk_size, 1);
+    try {
+        if (stream_chunk_.size() != chunk_size) {
+            stream_chunk_.resize(chunk_size);
+        }
+    } catch (const std::bad_alloc &) {
+        co_return core::make_error_code(core::errc::out_of_memory);
+    }
+
+    // 分段写出：前缀与第一段合并为一次分散写。整帧不在内存中，不写抓包。
+    auto remaining = source.size();
+    bool first = true;
+    while (remaining != 0) {
+        const auto n = std::min(remaining, stream_chunk_.size());
+        const core::mutable_bytes_view chunk{stream_chunk_.data(), n};
+        auto ec = co_await core::async_read_full(source, chunk);
+        if (!ec && first) {
+            ec = co_await stream_->async_write_gather(prefix, chunk);
+        } else if (!ec) {
+            ec = co_await stream_->async_write_all(chunk);
+        }
+        if (ec) {
+            co_return ec;
+        }
+        first = false;
+        remaining -= n;
+    }
+    co_return std::error_code{};
 }
 
 void Connection::start_writer_() {
@@ -210,10 +454,18 @@ asio::awaitable<void> Connection::writer_loop_() {
             // 控制消息优先级：控制流应抢占数据流写入，避免握手/断线控制被延后。
             req = std::move(control_queue_.front());
             control_queue_.pop_front();
-        } else if (!data_queue_.empty()) {
-            req = std::move(data_queue_.front());
-            data_queue_.pop_front();
         } else {
+            // data：每写一帧都重新选“最高优先级的非空通道”，新到的高优先级消息
+            // 不必等低优先级通道排空。
+            for (auto &q : data_queues_) {
+                if (!q.empty()) {
+                    req = std::move(q.front());
+                    q.pop_front();
+                    break;
+                }
+            }
+        }
+        if (!req) {
             write_ready_.reset();
             const auto ec = co_await write_ready_.async_wait();
             if (ec) {
@@ -222,8 +474,46 @@ asio::awaitable<void> Connection::writer_loop_() {
             continue;
         }
 
-        const auto ec = co_await stream_->async_write_all(
-            core::bytes_view{req->frame.data(), req->frame.size()});
+        if (metrics_) {
+            metrics_->write_queue_wait.record_duration(core::steady_clock::now() -
+                                                       req->enqueued_at);
+        }
+        std::error_code ec;
+        std::size_t frame_size = 0;
+        if (req->source) {
+            const core::bytes_view prefix{req->prefix.data(), req->prefix.size()};
+            frame_size = prefix.size() + req->source->size();
+            ec = co_await async_write_streamed_(prefix, *req->source);
+        } else if (req->shared) {
+            // 零拷贝：能独占 headroom 时写出连续帧，否则分散写前缀 + 共享消息体。
+            const core::bytes_view prefix{req->prefix.data(), req->prefix.size()};
+            const auto body = req->body.view();
+            frame_size = prefix.size() + body.size();
+            const auto contiguous = req->body.claim_headroom(prefix);
+            if (!contiguous.empty()) {
+                ec = co_await stream_->async_write_all(contiguous);
+                req->body.release_headroom();
+            } else {
+                ec = co_await stream_->async_write_gather(prefix, body);
+            }
+            if (!ec && options_.capture) {
+                (void)options_.capture->try_push(CaptureDirection::tx, prefix, body);
+            }
+        } else {
+            frame_size = req->frame.size();
+            ec = co_await stream_->async_write_all(
+                core::bytes_view{req->frame.data(), req->frame.size()});
+            if (!ec && options_.capture) {
+                (void)options_.capture->try_push(
+                    CaptureDirection::tx,
+                    core::bytes_view{req->frame.data(), req->frame.size()});
+            }
+        }
+        if (!ec && metrics_) {
+            metrics_->frames_tx.add();
+            metrics_->bytes_tx.add(frame_size);
+            metrics_->frame_size_tx.record(frame_size);
+        }
         req->ec = ec;
         req->done.set();
         if (ec) {
@@ -251,6 +541,16 @@ Connection::async_read_some_with_t8(core::byte *dst, std::size_t n) {
             core::mutable_bytes_view{dst, n});
     }
 
+    // 底层支持单次读超时（io_uring 链接超时）：由内核取消超时的读，无需定时器竞争。
+    if (stream_->has_native_read_timeout()) {
+        auto result = co_await stream_->async_read_some_for(
+            core::mutable_bytes_view{dst, n}, options_.t8);
+        if (result.first == core::make_error_code(core::errc::timeout) && metrics_) {
+            metrics_->t8_timeouts.add();
+        }
+        co_return result;
+    }
+
     // T8（网络字符间隔超时）的实现思路：
     // - 并行等待“读到任意字节”与“定时器到期”，谁先完成就采用谁的结果。
     // - 若定时器先到：取消底层流，让读协程尽快返回，然后向上报告超时。
@@ -286,6 +586,9 @@ Connection::async_read_some_with_t8(core::byte *dst, std::size_t n) {
     }
 
     // 定时器先完成：按 T8 超时处理。
+    if (metrics_) {
+        metrics_->t8_timeouts.add();
+    }
     stream_->cancel();
     co_return std::pair{core::make_error_code(core::errc::timeout),
                         std::size_t{0}};
@@ -329,6 +632,43 @@ Connection::async_read_exactly(core::mutable_bytes_view dst,
     co_return std::error_code{};
 }
 
+asio::awaitable<std::error_code>
+Connection::async_read_into_sink_(core::BodySink &sink,
+                                  std::size_t body_len,
+                                  bool &frame_started) {
+    const auto chunk_size = std::max<std::size_t>(options_.stream_chunk_size, 1);
+
+    // sink 提供了足够大的预分配区域（mmap）：直接分段读入，再以区域内视图提交。
+    const auto region = sink.contiguous();
+    const bool in_place = region.size() >= body_len;
+    if (!in_place) {
+        try {
+            if (sink_chunk_.size() != chunk_size) {
+                sink_chunk_.resize(chunk_size);
+            }
+        } catch (const std::bad_alloc &) {
+            co_return core::make_error_code(core::errc::out_of_memory);
+        }
+    }
+
+    std::size_t offset = 0;
+    while (offset < body_len) {
+        const auto n = std::min(body_len - offset, chunk_size);
+        const core::mutable_bytes_view chunk =
+            in_place ? region.subspan(offset, n)
+                     : core::mutable_bytes_view{sink_chunk_.data(), n};
+        auto ec = co_await async_read_exactly(chunk, frame_started);
+        if (!ec) {
+            ec = co_await sink.async_write(chunk);
+        }
+        if (ec) {
+            co_return ec;
+        }
+        offset += n;
+    }
+    co_return std::error_code{};
+}
+
 asio::awaitable<std::error_code>
 Connection::async_write_message(const Message &msg) {
     if (!stream_) {
@@ -343,28 +683,44 @@ Connection::async_write_message(const Message &msg) {
 
     const auto max_queue_size =
         options_.max_queue_size == 0 ? std::size_t{1} : options_.max_queue_size;
-    auto queued = control_queue_.size() + data_queue_.size();
+    auto queued = queued_writes_();
     if (queued >= max_queue_size) {
         // 控制消息优先：若队列被 data 塞满，则丢弃队列中的 data，为控制消息让路。
         if (!msg.is_data()) {
             cancel_queued_data_writes_(
                 core::make_error_code(core::errc::buffer_overflow));
-            queued = control_queue_.size() + data_queue_.size();
+            queued = queued_writes_();
         }
         if (queued >= max_queue_size) {
             co_return core::make_error_code(core::errc::buffer_overflow);
         }
     }
 
-    auto req = std::make_shared<WriteRequest>();
-    auto enc = encode_frame(msg, req->frame);
+    // 每条消息一个写请求：走线程级回收分配器，避免每条消息一次 malloc/free。
+    auto req = std::allocate_shared<WriteRequest>(
+        core::RecyclingAllocator<WriteRequest>());
+    std::error_code enc;
+    if (msg.body_source) {
+        enc = encode_frame_prefix(msg, req->prefix);
+        req->source = msg.body_source;
+    } else if (!msg.shared_body.empty()) {
+        enc = encode_frame_prefix(msg, req->prefix);
+        req->body = msg.shared_body;
+        req->shared = true;
+    } else {
+        enc = encode_frame(msg, req->frame);
+    }
     if (enc) {
         co_return enc;
     }
     req->is_data = msg.is_data();
+    if (metrics_) {
+        req->enqueued_at = core::steady_clock::now();
+    }
 
     if (req->is_data) {
-        data_queue_.push_back(req);
+        req->lane = data_lane_(msg);
+        data_queues_[req->lane].push_back(req);
     } else {
         control_queue_.push_back(req);
     }
@@ -380,31 +736,33 @@ Connection::async_write_message(const Message &msg) {
 
 asio::awaitable<std::pair<std::error_code, Message>>
 Connection::async_read_message() {
-    std::array<core::byte, kLengthFieldSize> len_buf{};
+    // 长度字段与 header 读入同一块缓冲区：抓包时可直接作为帧的前 14B 使用。
+    std::array<core::byte, kLengthFieldSize + kHeaderSize> head_buf{};
     bool frame_started = false;
     auto ec = co_await async_read_exactly(
-        core::mutable_bytes_view{len_buf.data(), len_buf.size()}, frame_started);
+        core::mutable_bytes_view{head_buf.data(), kLengthFieldSize}, frame_started);
     if (ec) {
         co_return std::pair{ec, Message{}};
     }
 
-    const std::uint32_t payload_len = read_u32_be_(len_buf.data());
+    const std::uint32_t payload_len = read_u32_be_(head_buf.data());
     if (payload_len < kHeaderSize) {
         co_return std::pair{core::make_error_code(core::errc::invalid_argument),
                             Message{}};
     }
-    if (payload_len > kMaxPayloadSize) {
+    // 超过 kMaxPayloadSize 的帧只可能交给 sink：未注册 sink 时不再读头部，直接拒绝。
+    const bool oversized = payload_len > kMaxPayloadSize;
+    if (oversized && options_.body_sinks.empty()) {
         co_return std::pair{core::make_error_code(core::errc::buffer_overflow),
                             Message{}};
     }
 
     // 读入 HSMS payload（10B header + body）：
     // - 先读 header 并解析；
-    // - 再把 body 直接读入 Message::body，避免临时 payload 缓冲与二次拷贝。
-    std::array<core::byte, kHeaderSize> header_buf{};
+    // - 再把 body 直接读入 Message::body（或注册的 sink），避免临时 payload 缓冲与二次拷贝。
+    core::byte *const header_buf = head_buf.data() + kLengthFieldSize;
     ec = co_await async_read_exactly(
-        core::mutable_bytes_view{header_buf.data(), header_buf.size()},
-        frame_started);
+        core::mutable_bytes_view{header_buf, kHeaderSize}, frame_started);
     if (ec) {
         co_return std::pair{ec, Message{}};
     }
@@ -417,7 +775,7 @@ Connection::async_read_message() {
     h.header_byte3 = header_buf[3];
     h.p_type = header_buf[4];
     h.s_type = static_cast<SType>(header_buf[5]);
-    h.system_bytes = read_u32_be_(header_buf.data() + 6);
+    h.system_bytes = read_u32_be_(header_buf + 6);
 
     if (h.p_type != kPTypeSecs2) {
         co_return std::pair{core::make_error_code(core::errc::invalid_argument),
@@ -429,7 +787,43 @@ Connection::async_read_message() {
 
     const auto body_len_u32 = payload_len - static_cast<std::uint32_t>(kHeaderSize);
     const auto body_len = static_cast<std::size_t>(body_len_u32);
-    if (body_len != 0U) {
+
+    std::shared_ptr<core::BodySink> sink;
+    if (h.s_type == SType::data && !options_.body_sinks.empty()) {
+        ec = open_body_sink_(h, body_len, sink);
+        if (ec) {
+            co_return std::pair{ec, Message{}};
+        }
+    }
+    if (oversized && !sink) {
+        co_return std::pair{core::make_error_code(core::errc::buffer_overflow),
+                            Message{}};
+    }
+
+    if (sink) {
+        ec = co_await async_read_into_sink_(*sink, body_len, frame_started);
+        if (!ec) {
+            ec = co_await sink->async_finish();
+        }
+        if (ec) {
+            sink->abort(ec);
+            co_return std::pair{ec, Message{}};
+        }
+        msg.body_sink = std::move(sink);
+    } else if (body_len != 0U) {
+        // 先预约再分配：预算不足时在这里暂停读取（反压对端），而不是先占用内存。
+        if (const auto &budget = options_.memory_budget) {
+            std::optional<core::duration> wait;
+            if (options_.memory_wait > core::duration::zero()) {
+                wait = options_.memory_wait;
+            }
+            ec = co_await budget->async_acquire(body_len, wait, this);
+            if (ec) {
+                co_return std::pair{ec, Message{}};
+            }
+            msg.memory_lease =
+                core::make_memory_lease(core::MemoryReservation(budget, body_len));
+        }
         try {
             msg.body.resize(body_len);
         } catch (const std::length_error &) {
@@ -451,6 +845,21 @@ Connection::async_read_message() {
         }
     }
 
+    if (metrics_) {
+        const auto frame_size =
+            static_cast<std::uint64_t>(kLengthFieldSize) + payload_len;
+        metrics_->frames_rx.add();
+        metrics_->bytes_rx.add(frame_size);
+        metrics_->frame_size_rx.record(frame_size);
+    }
+    // 写入 sink 的消息体已不在内存中，不录制。
+    if (options_.capture && !msg.body_sink) {
+        (void)options_.capture->try_push(
+            CaptureDirection::rx,
+            core::bytes_view{head_buf.data(), head_buf.size()},
+            core::bytes_view{msg.body.data(), msg.body.size()});
+    }
+
     co_return std::pair{std::error_code{}, std::move(msg)};
 }
 
@@ -0,0 +1,831 @@
+#include "secs/hsms/general_session.hpp"
+
+#include "secs/core/error.hpp"
+
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace secs::hsms {
+namespace {
+
+// 连接级控制消息（LINKTEST 等）的 SessionID。
+constexpr std::uint16_t kConnectionControlSessionId = 0xFFFF;
+
+// Select.rsp 状态码（E37）：0=建立，1=已处于 selected；4=SessionID 未注册。
+constexpr std::uint8_t kSelectOk = 0;
+constexpr std::uint8_t kSelectAlreadyActive = 1;
+constexpr std::uint8_t kSelectNoSuchEntity = 4;
+
+// Deselect.rsp 状态码：0=成功，1=该逻辑会话未处于 selected。
+constexpr std::uint8_t kDeselectOk = 0;
+constexpr std::uint8_t kDeselectNotEstablished = 1;
+
+// Reject.req reason code。
+constexpr std::uint8_t kRejectStypeNotSupported = 1;
+constexpr std::uint8_t kRejectEntityNotSelected = 4;
+
+} // namespace
+
+/*
+ * GeneralSession 的并发模型与 Session 相同（单 reader_loop_ + pending_ + Event），
+ * 区别只在于“选择状态/入站队列”从会话级下沉到 Entity：
+ *
+ *   reader_loop_ ──► data    ──► fulfill_pending_（SystemBytes + SessionID）
+ *                │               └─► entities_[session_id]->inbound
+ *                └─► control ──► SELECT/DESELECT/SEPARATE：目标 Entity
+ *                                LINKTEST：连接级（0xFFFF）
+ *
+ * 断线时所有 Entity 一并回到 disconnected，挂起事务统一取消。
+ */
+GeneralSession::GeneralSession(asio::any_io_executor ex,
+                               GeneralSessionOptions options)
+    : executor_(ex), options_(std::move(options)),
+      connection_(ex,
+                  ConnectionOptions{.t8 = options_.t8,
+                                    .metrics = options_.metrics,
+                                    .capture = options_.capture,
+                                    .backend = options_.stream_backend,
+                                    .data_priorities = options_.data_priorities,
+                                    .body_sinks = options_.body_sinks,
+                                    .memory_budget = options_.memory_budget,
+                                    .memory_wait = options_.memory_wait}),
+      pending_(options_.max_pending_requests) {
+    reader_stopped_event_.set();
+    for (const auto id : options_.session_ids) {
+        (void)add_session(id);
+    }
+}
+
+GeneralSession::Entity *
+GeneralSession::find_(std::uint16_t session_id) const noexcept {
+    const auto it = entities_.find(session_id);
+    return it == entities_.end() ? nullptr : it->second.get();
+}
+
+SessionState GeneralSession::state(std::uint16_t session_id) const noexcept {
+    const auto *entity = find_(session_id);
+    return entity ? entity->state : SessionState::disconnected;
+}
+
+std::size_t GeneralSession::selected_count() const noexcept {
+    return static_cast<std::size_t>(
+        std::count_if(entities_.begin(), entities_.end(), [](const auto &kv) {
+            return kv.second->state == SessionState::selected;
+        }));
+}
+
+std::error_code GeneralSession::add_session(std::uint16_t session_id) {
+    if ((session_id & 0x8000U) != 0) {
+        return core::make_error_code(core::errc::invalid_argument);
+    }
+    if (find_(session_id) != nullptr) {
+        return {};
+    }
+
+    try {
+        auto entity = std::make_unique<Entity>(session_id);
+        if (connected_) {
+            entity->state = SessionState::connected;
+        }
+        entities_.emplace(session_id, std::move(entity));
+    } catch (const std::bad_alloc &) {
+        return core::make_error_code(core::errc::out_of_memory);
+    }
+    return {};
+}
+
+void GeneralSession::reset_state_() noexcept {
+    connected_ = true;
+    // 数据写门禁按 Entity 在 async_send 中检查，连接层始终放行。
+    connection_.enable_data_writes();
+
+    any_selected_event_.reset();
+    disconnected_event_.reset();
+
+    for (auto &[id, entity] : entities_) {
+        entity->state = SessionState::connected;
+        entity->selected_event.reset();
+        entity->inbound.clear();
+        entity->inbound_event.reset();
+    }
+    pending_.unlink_if([](std::uint32_t, Pending &) noexcept { return true; });
+}
+
+void GeneralSession::set_selected_(Entity &entity) noexcept {
+    if (entity.state == SessionState::selected) {
+        return;
+    }
+    entity.state = SessionState::selected;
+    entity.selected_event.set();
+    any_selected_event_.set();
+    SPDLOG_DEBUG("hsms-gs selected: session_id={}", entity.session_id);
+}
+
+void GeneralSession::set_not_selected_(Entity &entity) noexcept {
+    if (entity.state != SessionState::selected) {
+        return;
+    }
+    entity.state = SessionState::connected;
+    entity.selected_event.reset();
+
+    entity.inbound.clear();
+    entity.inbound_event.cancel();
+    entity.inbound_event.reset();
+
+    cancel_pending_(entity.session_id, core::make_error_code(core::errc::cancelled));
+    SPDLOG_DEBUG("hsms-gs not-selected: session_id={}", entity.session_id);
+}
+
+void GeneralSession::on_disconnected_(std::error_code reason) noexcept {
+    SPDLOG_DEBUG("hsms-gs disconnected: ec={}({})", reason.value(), reason.message());
+    connected_ = false;
+    connection_.disable_data_writes(reason);
+
+    for (auto &[id, entity] : entities_) {
+        entity->state = SessionState::disconnected;
+        entity->selected_event.cancel();
+        entity->selected_event.reset();
+        entity->inbound.clear();
+        entity->inbound_event.cancel();
+        entity->inbound_event.reset();
+    }
+    any_selected_event_.cancel();
+    any_selected_event_.reset();
+    reader_running_ = false;
+    disconnected_event_.set();
+
+    pending_.unlink_if([reason](std::uint32_t, Pending &pending) noexcept {
+        pending.ec = reason;
+        pending.ready.cancel();
+        return true;
+    });
+}
+
+void GeneralSession::emit_control_event_(ControlDirection direction,
+                                         const Message &msg) noexcept {
+    if (!options_.on_control_event || !msg.is_control()) {
+        return;
+    }
+
+    ControlEvent ev{};
+    ev.direction = direction;
+    ev.state = state(msg.header.session_id);
+    if (connected_ && ev.state == SessionState::disconnected) {
+        ev.state = SessionState::connected; // 连接级控制消息 / 未注册 SessionID
+    }
+    ev.s_type = msg.header.s_type;
+    ev.session_id = msg.header.session_id;
+    ev.system_bytes = msg.header.system_bytes;
+    ev.header_byte2 = msg.header.header_byte2;
+    ev.header_byte3 = msg.header.header_byte3;
+    if (msg.header.s_type == SType::reject_req &&
+        msg.body.size() == static_cast<std::size_t>(kHeaderSize)) {
+        ev.has_rejected_header =
+            !decode_header(core::bytes_view{msg.body.data(), msg.body.size()},
+                           ev.rejected_header);
+    }
+
+    try {
+        options_.on_control_event(options_.on_control_event_user, ev);
+    } catch (...) {
+        // 回调仅用于观测/统计，不应影响会话可用性。
+    }
+}
+
+void GeneralSession::stop() noexcept {
+    stop_requested_ = true;
+    stop_event_.set();
+    connection_.cancel_and_close();
+
+    SPDLOG_DEBUG("hsms-gs stop requested");
+    on_disconnected_(core::make_error_code(core::errc::cancelled));
+}
+
+void GeneralSession::cancel_receive(std::uint16_t session_id) noexcept {
+    if (auto *entity = find_(session_id)) {
+        entity->inbound_event.cancel();
+    }
+}
+
+void GeneralSession::start_reader_() {
+    reader_running_ = true;
+    reader_stopped_event_.reset();
+
+    asio::co_spawn(
+        executor_,
+        [this]() -> asio::awaitable<void> {
+            co_await reader_loop_();
+        }, // GCOVR_EXCL_LINE：co_spawn 内联分支不计入覆盖率
+        asio::detached);
+
+    if (options_.linktest_interval != core::duration{}) {
+        const auto gen = connection_generation_;
+        try {
+            asio::co_spawn(
+                executor_,
+                [this, gen]() -> asio::awaitable<void> {
+                    co_await linktest_loop_(gen);
+                }, // GCOVR_EXCL_LINE：co_spawn 内联分支不计入覆盖率
+                asio::detached);
+        } catch (...) {
+            // 失败时仅意味着自动 LINKTEST 不可用（同 Session::set_selected_）。
+        }
+    }
+}
+
+asio::awaitable<void> GeneralSession::write_control_(const Message &msg) {
+    const auto ec = co_await connection_.async_write_message(msg);
+    if (!ec) {
+        emit_control_event_(ControlDirection::tx, msg);
+    }
+}
+
+asio::awaitable<void> GeneralSession::handle_data_(Message msg) {
+    if (fulfill_pending_(msg)) {
+        co_return;
+    }
+
+    auto *entity = find_(msg.header.session_id);
+    if (entity == nullptr || entity->state != SessionState::selected) {
+        // HSMS-GS：未选择/未注册的逻辑会话收到数据，回 Reject.req 让对端感知。
+        co_await write_control_(
+            make_reject_req(kRejectEntityNotSelected, msg.header));
+        co_return;
+    }
+    entity->inbound.push_back(std::move(msg));
+    entity->inbound_event.set();
+}
+
+asio::awaitable<void> GeneralSession::reader_loop_() {
+    while (!stop_requested_) {
+        auto [ec, msg] = co_await connection_.async_read_message();
+        if (ec) {
+            connection_.cancel_and_close();
+            if (connected_) {
+                on_disconnected_(ec);
+            }
+            break;
+        }
+
+        if (msg.is_data()) {
+            co_await handle_data_(std::move(msg));
+            continue;
+        }
+
+        emit_control_event_(ControlDirection::rx, msg);
+        const auto sid = msg.header.session_id;
+        const auto sb = msg.header.system_bytes;
+        auto *entity = find_(sid);
+
+        bool should_exit = false;
+        switch (msg.header.s_type) {
+        case SType::select_req: {
+            if (entity == nullptr) {
+                co_await write_control_(make_select_rsp(sid, kSelectNoSuchEntity, sb));
+                break;
+            }
+            if (entity->state == SessionState::selected) {
+                co_await write_control_(make_select_rsp(sid, kSelectAlreadyActive, sb));
+                break;
+            }
+            // 先进入 selected 再回复：对端收到 Select.rsp 后立即发来的数据不会被拒绝。
+            set_selected_(*entity);
+            co_await write_control_(make_select_rsp(sid, kSelectOk, sb));
+            break;
+        }
+        case SType::select_rsp: {
+            const bool matched = fulfill_pending_(msg);
+            if (matched && entity && msg.header.header_byte2 == kSelectOk) {
+                set_selected_(*entity);
+            }
+            break;
+        }
+        case SType::deselect_req: {
+            if (entity == nullptr || entity->state != SessionState::selected) {
+                co_await write_control_(
+                    make_deselect_rsp(sid, kDeselectNotEstablished, sb));
+                break;
+            }
+            set_not_selected_(*entity);
+            co_await write_control_(make_deselect_rsp(sid, kDeselectOk, sb));
+            break;
+        }
+        case SType::deselect_rsp: {
+            const bool matched = fulfill_pending_(msg);
+            if (matched && entity && msg.header.header_byte2 == kDeselectOk) {
+                set_not_selected_(*entity);
+            }
+            break;
+        }
+        case SType::linktest_req: {
+            co_await write_control_(make_linktest_rsp(sid, sb));
+            break;
+        }
+        case SType::linktest_rsp: {
+            (void)fulfill_pending_(msg);
+            break;
+        }
+        case SType::reject_req: {
+            // 不影响选择状态；可通过 options_.on_control_event 观测。
+            break;
+        }
+        case SType::separate_req: {
+            if (entity != nullptr) {
+                // HSMS-GS：只结束该逻辑会话，连接与其它逻辑会话保持。
+                set_not_selected_(*entity);
+                break;
+            }
+            // SessionID=0xFFFF（HSMS-SS 风格）或未注册：按整条连接断开处理。
+            (void)co_await connection_.async_close();
+            on_disconnected_(core::make_error_code(core::errc::cancelled));
+            should_exit = true;
+            break;
+        }
+        default: {
+            co_await write_control_(
+                make_reject_req(kRejectStypeNotSupported, msg.header));
+            break;
+        }
+        }
+
+        if (should_exit) {
+            break;
+        }
+    }
+
+    reader_running_ = false;
+    reader_stopped_event_.set();
+}
+
+asio::awaitable<void> GeneralSession::linktest_loop_(std::uint64_t generation) {
+    std::uint32_t consecutive_failures = 0;
+    const std::uint32_t max_failures =
+        std::max<std::uint32_t>(1U, options_.linktest_max_consecutive_failures);
+
+    while (!stop_requested_ && connected_ && connection_generation_ == generation) {
+        auto ec =
+            co_await disconnected_event_.async_wait(options_.linktest_interval);
+        if (ec != core::make_error_code(core::errc::timeout)) {
+            co_return; // 已断线（或被取消）
+        }
+        if (!connected_ || connection_generation_ != generation) {
+            co_return;
+        }
+
+        ec = co_await async_linktest();
+        if (ec) {
+            if (++consecutive_failures >= max_failures) {
+                (void)co_await connection_.async_close();
+                co_return;
+            }
+            continue;
+        }
+        consecutive_failures = 0;
+    }
+}
+
+asio::awaitable<std::error_code>
+GeneralSession::async_wait_reader_stopped(std::optional<core::duration> timeout) {
+    co_return co_await reader_stopped_event_.async_wait(timeout);
+}
+
+bool GeneralSession::fulfill_pending_(Message &msg) noexcept {
+    auto *pending = pending_.find(msg.header.system_bytes);
+    if (pending == nullptr || pending->expected_stype != msg.header.s_type ||
+        pending->session_id != msg.header.session_id) {
+        return false;
+    }
+
+    pending->response = std::move(msg);
+    pending->ec = std::error_code{};
+    pending->ready.set();
+    return true;
+}
+
+void GeneralSession::cancel_pending_(std::uint16_t session_id,
+                                     std::error_code reason) noexcept {
+    // 只取消数据事务：控制事务（SELECT/DESELECT）由 T6 与各自响应收敛，
+    // 例如 Deselect.rsp 已完成的挂起项不能在退回 NOT_SELECTED 时被改成 cancelled。
+    pending_.unlink_if([session_id, reason](std::uint32_t, Pending &pending) noexcept {
+        if (pending.session_id != session_id ||
+            pending.expected_stype != SType::data) {
+            return false;
+        }
+        pending.ec = reason;
+        pending.ready.cancel();
+        return true;
+    });
+}
+
+asio::awaitable<std::pair<std::error_code, Message>>
+GeneralSession::async_transaction_(const Message &req,
+                                   SType expected_rsp,
+                                   core::duration timeout) {
+    PendingHandle handle{};
+    auto ec = pending_.emplace(
+        req.header.system_bytes, handle, expected_rsp, req.header.session_id);
+    if (ec) {
+        co_return std::pair{ec, Message{}};
+    }
+
+    ec = co_await connection_.async_write_message(req);
+    if (ec) {
+        pending_.release(handle);
+        co_return std::pair{ec, Message{}};
+    }
+    emit_control_event_(ControlDirection::tx, req);
+
+    ec = co_await pending_.get(handle)->ready.async_wait(timeout);
+
+    auto *pending = pending_.get(handle);
+    std::pair<std::error_code, Message> result{ec, Message{}};
+    if (ec == core::make_error_code(core::errc::timeout)) {
+        // 超时只返回 timeout，是否断线由调用方决定（同 Session）。
+    } else if (ec) {
+        result.first = pending->ec ? pending->ec : ec;
+    } else if (pending->ec) {
+        result.first = pending->ec;
+    } else if (!pending->response.has_value()) {
+        result.first = core::make_error_code(core::errc::invalid_argument);
+    } else {
+        result.second = std::move(*pending->response);
+    }
+    pending_.release(handle);
+    co_return result;
+}
+
+asio::awaitable<std::error_code>
+GeneralSession::adopt_connection_(Connection &&connection) {
+    if (stop_requested_) {
+        co_return core::make_error_code(core::errc::cancelled);
+    }
+
+    if (reader_running_) {
+        // 确保不会有两个 reader_loop_ 同时存在（同 Session::async_open_*）。
+        (void)co_await connection_.async_close();
+        (void)co_await disconnected_event_.async_wait(options_.t6);
+    }
+    // 旧连接即使 reader 已退出（例如对端 SEPARATE），其 writer 协程仍可能引用
+    // connection_；先关闭并等它退出，再移动赋值。
+    (void)co_await connection_.async_close();
+
+    connection_ = std::move(connection);
+    if (options_.metrics) {
+        connection_.set_metrics(options_.metrics);
+    }
+    if (options_.capture) {
+        connection_.set_capture(options_.capture);
+    }
+    if (!options_.data_priorities.empty()) {
+        connection_.set_data_priorities(options_.data_priorities);
+    }
+    if (!options_.body_sinks.empty()) {
+        connection_.set_body_sinks(options_.body_sinks);
+    }
+    if (options_.memory_budget) {
+        connection_.set_memory_budget(options_.memory_budget, options_.memory_wait);
+    }
+    ++connection_generation_;
+    reset_state_();
+    start_reader_();
+    co_return std::error_code{};
+}
+
+asio::awaitable<std::error_code>
+GeneralSession::async_open_active(const asio::ip::tcp::endpoint &endpoint) {
+    co_return co_await async_open_active_with_(
+        [&endpoint](Connection &conn) -> asio::awaitable<std::error_code> {
+            co_return co_await conn.async_connect(endpoint);
+        });
+}
+
+asio::awaitable<std::error_code>
+GeneralSession::async_open_active_with_(const ConnectFn &connect) {
+    if (stop_requested_) {
+        co_return core::make_error_code(core::errc::cancelled);
+    }
+
+    Connection conn(executor_,
+                    ConnectionOptions{.t8 = options_.t8,
+                                      .metrics = options_.metrics,
+                                      .capture = options_.capture,
+                                      .backend = options_.stream_backend,
+                                      .data_priorities = options_.data_priorities,
+                                      .body_sinks = options_.body_sinks,
+                                      .memory_budget = options_.memory_budget,
+                                      .memory_wait = options_.memory_wait});
+    auto ec = co_await connect(conn);
+    if (ec) {
+        on_disconnected_(ec);
+        co_return ec;
+    }
+    co_return co_await async_open_active(std::move(conn));
+}
+
+asio::awaitable<std::error_code>
+GeneralSession::async_open_active(Connection &&connection) {
+    auto ec = co_await adopt_connection_(std::move(connection));
+    if (ec) {
+        co_return ec;
+    }
+
+    // 注册顺序不保证，这里按 SessionID 升序 SELECT，便于对端日志比对。
+    std::vector<std::uint16_t> ids;
+    ids.reserve(entities_.size());
+    for (const auto &[id, entity] : entities_) {
+        ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end());
+
+    for (const auto id : ids) {
+        ec = co_await async_select(id);
+        if (ec) {
+            // 与 Session 一致：建链阶段的 SELECT 失败按通信失败处理，断线收敛。
+            connection_.cancel_and_close();
+            if (connected_) {
+                on_disconnected_(ec);
+            }
+            co_return ec;
+        }
+    }
+    SPDLOG_DEBUG("hsms-gs open_active: {} session(s) selected", ids.size());
+    co_return std::error_code{};
+}
+
+asio::awaitable<std::error_code>
+GeneralSession::async_open_passive(asio::ip::tcp::socket socket) {
+    if (stop_requested_) {
+        co_return core::make_error_code(core::errc::cancelled);
+    }
+
+    Connection conn(std::move(socket),
+                    ConnectionOptions{.t8 = options_.t8,
+                                      .metrics = options_.metrics,
+                                      .capture = options_.capture,
+                                      .backend = options_.stream_backend,
+                                      .data_priorities = options_.data_priorities,
+                                      .body_sinks = options_.body_sinks,
+                                      .memory_budget = options_.memory_budget,
+                                      .memory_wait = options_.memory_wait});
+    co_return co_await async_open_passive(std::move(conn));
+}
+
+asio::awaitable<std::error_code>
+GeneralSession::async_open_passive(Connection &&connection) {
+    auto ec = co_await adopt_connection_(std::move(connection));
+    if (ec) {
+        co_return ec;
+    }
+
+    // T7：连接建立后在限定时间内没有任何逻辑会话被 SELECT，则断线。
+    ec = co_await any_selected_event_.async_wait(options_.t7);
+    if (ec) {
+        (void)co_await connection_.async_close();
+        if (connected_) {
+            on_disconnected_(ec);
+        }
+        co_return ec;
+    }
+    co_return std::error_code{};
+}
+
+asio::awaitable<std::error_code>
+GeneralSession::async_run_active(const asio::ip::tcp::endpoint &endpoint) {
+    co_return co_await async_run_active(
+        [endpoint](Connection &conn) -> asio::awaitable<std::error_code> {
+            co_return co_await conn.async_connect(endpoint);
+        });
+}
+
+asio::awaitable<std::error_code> GeneralSession::async_run_active(ConnectFn connect) {
+    // 同 Session::async_run_active：governor 限速建链，连续失败指数退避。
+    std::uint32_t failures = 0;
+    while (!stop_requested_) {
+        if (options_.governor) {
+            if (co_await async_sleep_(options_.governor->reserve())) {
+                break;
+            }
+        }
+
+        auto ec = co_await async_open_active_with_(connect);
+        if (ec) {
+            if (!options_.auto_reconnect || stop_requested_) {
+                co_return ec;
+            }
+            if (co_await async_sleep_(reconnect_delay_(++failures))) {
+                break;
+            }
+            continue;
+        }
+
+        failures = 0;
+        (void)co_await disconnected_event_.async_wait(std::nullopt);
+        if (!options_.auto_reconnect || stop_requested_) {
+            co_return std::error_code{};
+        }
+        if (co_await async_sleep_(reconnect_delay_(++failures))) {
+            break;
+        }
+    }
+    co_return std::error_code{};
+}
+
+core::duration GeneralSession::reconnect_delay_(std::uint32_t failures) noexcept {
+    if (!options_.governor) {
+        return options_.t5;
+    }
+    return options_.governor->backoff(options_.t5, failures);
+}
+
+asio::awaitable<std::error_code> GeneralSession::async_sleep_(core::duration d) {
+    if (stop_requested_) {
+        co_return core::make_error_code(core::errc::cancelled);
+    }
+    if (d <= core::duration{}) {
+        co_return std::error_code{};
+    }
+    const auto ec = co_await stop_event_.async_wait(d);
+    if (ec == core::make_error_code(core::errc::timeout)) {
+        co_return std::error_code{};
+    }
+    co_return ec ? ec : core::make_error_code(core::errc::cancelled);
+}
+
+asio::awaitable<std::error_code>
+GeneralSession::async_select(std::uint16_t session_id) {
+    auto *entity = find_(session_id);
+    if (!connected_ || entity == nullptr) {
+        co_return core::make_error_code(core::errc::invalid_argument);
+    }
+    if (entity->state == SessionState::selected) {
+        co_return std::error_code{};
+    }
+
+    const auto req = make_select_req(session_id, allocate_system_bytes());
+    auto [ec, rsp] = co_await async_transaction_(req, SType::select_rsp, options_.t6);
+    if (ec) {
+        co_return ec;
+    }
+    if (rsp.header.header_byte2 != kSelectOk) {
+        co_return core::make_error_code(core::errc::invalid_argument);
+    }
+    set_selected_(*entity);
+    co_return std::error_code{};
+}
+
+asio::awaitable<std::error_code>
+GeneralSession::async_deselect(std::uint16_t session_id) {
+    auto *entity = find_(session_id);
+    if (entity == nullptr || entity->state != SessionState::selected) {
+        co_return core::make_error_code(core::errc::invalid_argument);
+    }
+
+    const auto req = make_deselect_req(session_id, allocate_system_bytes());
+    auto [ec, rsp] = co_await async_transaction_(req, SType::deselect_rsp, options_.t6);
+    if (ec) {
+        co_return ec;
+    }
+    if (rsp.header.header_byte2 != kDeselectOk) {
+        co_return core::make_error_code(core::errc::invalid_argument);
+    }
+    set_not_selected_(*entity);
+    co_return std::error_code{};
+}
+
+asio::awaitable<std::error_code>
+GeneralSession::async_separate(std::uint16_t session_id) {
+    auto *entity = find_(session_id);
+    if (entity == nullptr || entity->state != SessionState::selected) {
+        co_return core::make_error_code(core::errc::invalid_argument);
+    }
+
+    // 先退回 NOT_SELECTED，保证 Separate.req 之后本端不再交付/发送该会话的数据。
+    set_not_selected_(*entity);
+    const auto req = make_separate_req(session_id, allocate_system_bytes());
+    const auto ec = co_await connection_.async_write_message(req);
+    if (!ec) {
+        emit_control_event_(ControlDirection::tx, req);
+    }
+    co_return ec;
+}
+
+asio::awaitable<std::error_code> GeneralSession::async_send(const Message &msg) {
+    if (!connected_ || !connection_.is_open()) {
+        co_return core::make_error_code(core::errc::invalid_argument);
+    }
+    if (msg.is_data() && !is_selected(msg.header.session_id)) {
+        co_return core::make_error_code(core::errc::invalid_argument);
+    }
+
+    auto ec = co_await connection_.async_write_message(msg);
+    if (!ec) {
+        emit_control_event_(ControlDirection::tx, msg);
+    }
+    co_return ec;
+}
+
+asio::awaitable<std::pair<std::error_code, Message>>
+GeneralSession::async_receive_data(std::uint16_t session_id,
+                                   std::optional<core::duration> timeout) {
+    auto *entity = find_(session_id);
+    if (entity == nullptr) {
+        co_return std::pair{core::make_error_code(core::errc::invalid_argument),
+                            Message{}};
+    }
+
+    while (entity->inbound.empty()) {
+        auto ec = co_await entity->inbound_event.async_wait(timeout);
+        if (ec) {
+            co_return std::pair{ec, Message{}};
+        }
+    }
+
+    Message msg = std::move(entity->inbound.front());
+    entity->inbound.pop_front();
+    if (entity->inbound.empty()) {
+        entity->inbound_event.reset();
+    }
+    co_return std::pair{std::error_code{}, std::move(msg)};
+}
+
+asio::awaitable<std::pair<std::error_code, std::deque<Message>>>
+GeneralSession::async_receive_data_batch(std::uint16_t session_id,
+                                         std::size_t max_n,
+                                         std::optional<core::duration> timeout) {
+    auto *entity = find_(session_id);
+    if (entity == nullptr) {
+        co_return std::pair{core::make_error_code(core::errc::invalid_argument),
+                            std::deque<Message>{}};
+    }
+
+    while (entity->inbound.empty()) {
+        auto ec = co_await entity->inbound_event.async_wait(timeout);
+        if (ec) {
+            co_return std::pair{ec, std::deque<Message>{}};
+        }
+    }
+
+    auto batch = take_message_batch(entity->inbound, max_n);
+    if (entity->inbound.empty()) {
+        entity->inbound_event.reset();
+    }
+    co_return std::pair{std::error_code{}, std::move(batch)};
+}
+
+asio::awaitable<std::pair<std::error_code, Message>>
+GeneralSession::async_request_data(std::uint16_t session_id,
+                                   std::uint8_t stream,
+                                   std::uint8_t function,
+                                   core::bytes_view body,
+                                   std::optional<core::duration> timeout) {
+    if (!is_selected(session_id)) {
+        co_return std::pair{core::make_error_code(core::errc::invalid_argument),
+                            Message{}};
+    }
+
+    const auto req = make_data_message(
+        session_id, stream, function, true, allocate_system_bytes(), body);
+    co_return co_await async_transaction_(
+        req, SType::data, timeout.value_or(options_.t3));
+}
+
+asio::awaitable<std::error_code> GeneralSession::async_linktest() {
+    if (!connected_) {
+        co_return core::make_error_code(core::errc::invalid_argument);
+    }
+
+    const auto req =
+        make_linktest_req(kConnectionControlSessionId, allocate_system_bytes());
+    auto [ec, rsp] = co_await async_transaction_(req, SType::linktest_rsp, options_.t6);
+    co_return ec;
+}
+
+asio::awaitable<std::error_code>
+GeneralSession::async_wait_selected(std::uint16_t session_id,
+                                    core::duration timeout) {
+    auto *entity = find_(session_id);
+    if (entity == nullptr) {
+        co_return core::make_error_code(core::errc::invalid_argument);
+    }
+
+    const auto deadline = core::steady_clock::now() + timeout;
+    while (!stop_requested_) {
+        if (entity->state == SessionState::selected) {
+            co_return std::error_code{};
+        }
+        const auto now = core::steady_clock::now();
+        if (now >= deadline) {
+            co_return core::make_error_code(core::errc::timeout);
+        }
+        auto ec = co_await entity->selected_event.async_wait(deadline - now);
+        if (ec && ec != core::make_error_code(core::errc::cancelled)) {
+            co_return ec;
+        }
+    }
+    co_return core::make_error_code(core::errc::cancelled);
+}
+
+} // namespace secs::hsms
@@ -0,0 +1,103 @@
+#include "secs/hsms/governor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace secs::hsms {
+
+/*
+ * ConnectGovernor 实现。
+ *
+ * 令牌桶按“透支”方式记账：tokens_ 可以为负，表示已经预约出去、尚未补充到的令牌。
+ * 第 k 个超出突发容量的预约需要等待 k / rate 秒，因此同一时刻涌入的重连请求会被
+ * 均匀排开，而不是在某个时刻再次集中醒来。
+ *
+ * 退避在 double 纳秒上计算，避免 multiplier^n 溢出 duration 的整数表示。
+ */
+
+ConnectGovernor::ConnectGovernor(ConnectGovernorOptions options)
+    : options_(std::move(options)) {
+    options_.burst = std::max<std::uint32_t>(options_.burst, 1U);
+    options_.jitter = std::clamp(options_.jitter, 0.0, 1.0);
+    if (!(options_.backoff_multiplier >= 1.0)) {
+        options_.backoff_multiplier = 1.0;
+    }
+
+    tokens_ = static_cast<double>(options_.burst);
+    last_refill_ = now_();
+
+    std::uint64_t seed = options_.seed;
+    if (seed == 0) {
+        std::random_device rd;
+        seed = (static_cast<std::uint64_t>(rd()) << 32U) ^ rd();
+    }
+    rng_.seed(seed);
+}
+
+core::steady_clock::time_point ConnectGovernor::now_() const {
+    return options_.clock ? options_.clock() : core::steady_clock::now();
+}
+
+core::duration ConnectGovernor::reserve() noexcept {
+    std::lock_guard lk(mu_);
+    ++granted_;
+    if (!(options_.rate_per_second > 0.0)) {
+        return core::duration{};
+    }
+
+    core::steady_clock::time_point now{};
+    try {
+        now = now_();
+    } catch (...) {
+        // 注入的时钟抛异常时按“不限速”处理，不影响重连本身。
+        return core::duration{};
+    }
+
+    const auto elapsed = std::chrono::duration<double>(now - last_refill_).count();
+    if (elapsed > 0.0) {
+        tokens_ = std::min(static_cast<double>(options_.burst),
+                           tokens_ + elapsed * options_.rate_per_second);
+        last_refill_ = now;
+    }
+
+    tokens_ -= 1.0;
+    if (tokens_ >= 0.0) {
+        return core::duration{};
+    }
+    ++throttled_;
+    const std::chrono::duration<double> wait{-tokens_ / options_.rate_per_second};
+    return std::chrono::ceil<core::duration>(wait);
+}
+
+core::duration ConnectGovernor::backoff(core::duration base,
+                                        std::uint32_t failures) noexcept {
+    if (base <= core::duration{}) {
+        return core::duration{};
+    }
+    const auto exponent = static_cast<double>(std::min<std::uint32_t>(
+        failures == 0 ? 0U : failures - 1U, 64U));
+    const double cap = static_cast<double>(std::max(options_.max_backoff, base).count());
+    double d = static_cast<double>(base.count()) *
+               std::pow(options_.backoff_multiplier, exponent);
+    d = std::min(d, cap);
+
+    if (options_.jitter > 0.0) {
+        std::lock_guard lk(mu_);
+        const double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng_);
+        d *= 1.0 - options_.jitter * u;
+    }
+    return core::duration{static_cast<core::duration::rep>(d)};
+}
+
+std::uint64_t ConnectGovernor::granted() const noexcept {
+    std::lock_guard lk(mu_);
+    return granted_;
+}
+
+std::uint64_t ConnectGovernor::throttled() const noexcept {
+    std::lock_guard lk(mu_);
+    return throttled_;
+}
+
+} // namespace secs::hsms
@@ -0,0 +1,1262 @@
+#include "secs/hsms/io_uring_stream.hpp"
+
+#include "secs/core/error.hpp"
+
+#if defined(SECS_HAS_IO_URING)
+#include "secs/core/event.hpp"
+
+#include <asio/dispatch.hpp>
+#include <asio/error.hpp>
+#include <asio/execution/context.hpp>
+#include <asio/execution_context.hpp>
+#include <asio/posix/stream_descriptor.hpp>
+#include <asio/post.hpp>
+#include <asio/query.hpp>
+
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#endif
+
+namespace secs::hsms {
+
+#if defined(SECS_HAS_IO_URING)
+namespace {
+
+/*
+ * io_uring 后端实现（直接使用系统调用，不依赖 liburing）。
+ *
+ * 结构：
+ * - Ring：mmap 的 SQ/CQ、注册缓冲槽、在途请求表（user_data -> 完成回调）。
+ *   所有成员受 mu_ 保护：多线程 io_context 下不同执行器可能同时提交。
+ * - IoUringService：每个 execution_context 一个，持有 Ring；Ring 注册的 eventfd
+ *   在内核写入 CQE 时变为可读，由 asio reactor 唤醒后统一收割。
+ * - 提交合并：push() 只把 SQE 放进 SQ，并向 io_context post 一次 flush；
+ *   同一轮事件循环内所有连接的请求由一次 io_uring_enter 提交。
+ *
+ * 内存安全：
+ * - 读请求只写入流状态对象自己的缓冲（注册槽/私有缓冲），流状态由在途请求的
+ *   回调共同持有，协程或 Stream 先行销毁也不会让内核写入已释放的内存；
+ * - 写请求直接引用调用方内存：Connection 的写协程在完成前不会释放帧/消息体；
+ * - 服务关闭时取消全部在途请求并等待其完成，之后才释放 ring 与缓冲。
+ */
+
+int sys_io_uring_setup(unsigned entries, io_uring_params *params) noexcept {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                       unsigned flags, const void *arg = nullptr,
+                       std::size_t argsz = 0) noexcept {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit,
+                                      min_complete, flags, arg, argsz));
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, const void *arg,
+                          unsigned nr_args) noexcept {
+    return static_cast<int>(
+        ::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+std::error_code errno_code(int e) noexcept {
+    return std::error_code(e, std::system_category());
+}
+
+std::error_code eof_code() noexcept {
+    return asio::error::make_error_code(asio::error::eof);
+}
+
+unsigned load_acquire(const unsigned *p) noexcept {
+    return std::atomic_ref<const unsigned>(*p).load(std::memory_order_acquire);
+}
+
+void store_release(unsigned *p, unsigned v) noexcept {
+    std::atomic_ref<unsigned>(*p).store(v, std::memory_order_release);
+}
+
+// 完成回调：res 为 CQE 结果（负值为 -errno），more 表示 multishot 请求仍然有效。
+using Completion = std::function<void(int res, bool more)>;
+
+class Ring final : public std::enable_shared_from_this<Ring> {
+public:
+    explicit Ring(asio::any_io_executor ex) : executor_(std::move(ex)) {}
+
+    Ring(const Ring &) = delete;
+    Ring &operator=(const Ring &) = delete;
+
+    ~Ring() {
+        close_ring_();
+        if (slab_ != MAP_FAILED) {
+            ::munmap(slab_, slab_size_);
+        }
+    }
+
+    std::error_code init(const IoUringOptions &options, int event_fd) noexcept {
+        io_uring_params params{};
+        params.flags = IORING_SETUP_CLAMP;
+        const int fd = sys_io_uring_setup(std::max<std::uint32_t>(options.entries, 2U),
+                                          &params);
+        if (fd < 0) {
+            return errno_code(errno);
+        }
+        fd_ = fd;
+
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        }
+        sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) {
+            return fail_init_(errno);
+        }
+        cq_ring_ = single_mmap
+                       ? sq_ring_
+                       : ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) {
+            return fail_init_(errno);
+        }
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            return fail_init_(errno);
+        }
+        sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+        auto *sq = static_cast<char *>(sq_ring_);
+        sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_flags_ = reinterpret_cast<unsigned *>(sq + params.sq_off.flags);
+        sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        sq_entries_ = params.sq_entries;
+        sq_local_tail_ = *sq_tail_;
+
+        auto *cq = static_cast<char *>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        ext_arg_ = (params.features & IORING_FEAT_EXT_ARG) != 0;
+
+        if (sys_io_uring_register(fd_, IORING_REGISTER_EVENTFD, &event_fd, 1) < 0) {
+            return fail_init_(errno);
+        }
+        register_slots_(options);
+        try {
+            // descriptor 接管 eventfd 的所有权。
+            event_.emplace(executor_, event_fd);
+        } catch (...) {
+            close_ring_();
+            return core::make_error_code(core::errc::out_of_memory);
+        }
+        return {};
+    }
+
+    // 放入一个 SQE（可选再链接一个，例如 LINK_TIMEOUT），返回第一个请求的 id；
+    // ring 已关闭、SQ 已满或内存不足时返回 0。
+    std::uint64_t push(io_uring_sqe sqe, Completion done,
+                       const io_uring_sqe *linked = nullptr,
+                       Completion linked_done = {}) noexcept {
+        std::lock_guard lk(mu_);
+        if (fd_ < 0) {
+            return 0;
+        }
+        const unsigned need = linked ? 2U : 1U;
+        if (sq_space_() < need) {
+            submit_locked_();
+            if (sq_space_() < need) {
+                return 0;
+            }
+        }
+
+        const std::uint64_t id = next_id_;
+        const bool track_linked = linked != nullptr && static_cast<bool>(linked_done);
+        try {
+            inflight_.emplace(id, std::move(done));
+            if (track_linked) {
+                inflight_.emplace(id + 1, std::move(linked_done));
+            }
+        } catch (...) {
+            inflight_.erase(id);
+            return 0;
+        }
+        next_id_ += need;
+
+        sqe.user_data = id;
+        if (linked) {
+            sqe.flags |= IOSQE_IO_LINK;
+        }
+        place_(sqe);
+        if (linked) {
+            io_uring_sqe second = *linked;
+            second.user_data = track_linked ? id + 1 : 0;
+            place_(second);
+        }
+        schedule_flush_locked_();
+        return id;
+    }
+
+    // 请求取消 id 对应的在途请求；其完成回调仍会以 -ECANCELED（或实际结果）调用。
+    void cancel(std::uint64_t id) noexcept {
+        if (id == 0) {
+            return;
+        }
+        io_uring_sqe sqe{};
+        sqe.opcode = IORING_OP_ASYNC_CANCEL;
+        sqe.fd = -1;
+        sqe.addr = id;
+
+        std::lock_guard lk(mu_);
+        if (fd_ < 0 || inflight_.find(id) == inflight_.end()) {
+            return;
+        }
+        if (sq_space_() == 0) {
+            submit_locked_();
+            if (sq_space_() == 0) {
+                return;
+            }
+        }
+        sqe.user_data = 0;
+        place_(sqe);
+        schedule_flush_locked_();
+    }
+
+    void flush() noexcept {
+        std::lock_guard lk(mu_);
+        flush_posted_ = false;
+        submit_locked_();
+        arm_locked_();
+    }
+
+    // 取消全部在途请求并等待其完成（最多约 1s），然后关闭 ring。
+    void shutdown() noexcept {
+        std::vector<std::pair<Completion, std::pair<int, bool>>> dropped;
+        {
+            std::lock_guard lk(mu_);
+            if (fd_ < 0) {
+                return;
+            }
+            // reactor 已先于本服务 shutdown，此时销毁 descriptor 是安全的。
+            event_.reset();
+            event_waiting_ = false;
+            const auto deadline =
+                std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            try {
+                while (!inflight_.empty() &&
+                       std::chrono::steady_clock::now() < deadline) {
+                    for (const auto &entry : inflight_) {
+                        if (sq_space_() == 0) {
+                            break;
+                        }
+                        io_uring_sqe sqe{};
+                        sqe.opcode = IORING_OP_ASYNC_CANCEL;
+                        sqe.fd = -1;
+                        sqe.addr = entry.first;
+                        place_(sqe);
+                    }
+                    submit_locked_();
+                    wait_one_locked_();
+                    collect_locked_(&dropped);
+                }
+            } catch (...) {
+                // 内存不足：放弃等待，直接关闭。
+            }
+            for (auto &entry : inflight_) {
+                dropped.emplace_back(std::move(entry.second), std::pair{0, false});
+            }
+            inflight_.clear();
+            close_ring_();
+        }
+        // dropped 在锁外析构：回调持有的流状态析构时会归还缓冲槽（需要加锁）。
+    }
+
+    // 注册缓冲槽：返回槽号，无可用槽时返回 -1。
+    int acquire_slot() noexcept {
+        std::lock_guard lk(mu_);
+        if (free_slots_.empty()) {
+            return -1;
+        }
+        const int slot = free_slots_.back();
+        free_slots_.pop_back();
+        return slot;
+    }
+
+    void release_slot(int slot) noexcept {
+        std::lock_guard lk(mu_);
+        free_slots_.push_back(slot);
+    }
+
+    [[nodiscard]] core::byte *slot_data(int slot) const noexcept {
+        return static_cast<core::byte *>(slab_) +
+               static_cast<std::size_t>(slot) * slot_size_;
+    }
+    [[nodiscard]] std::size_t slot_size() const noexcept { return slot_size_; }
+
+private:
+    std::error_code fail_init_(int e) noexcept {
+        close_ring_();
+        return errno_code(e);
+    }
+
+    void close_ring_() noexcept {
+        if (sqes_ != nullptr) {
+            ::munmap(sqes_, sqes_size_);
+            sqes_ = nullptr;
+        }
+        if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+            ::munmap(cq_ring_, cq_ring_size_);
+        }
+        cq_ring_ = MAP_FAILED;
+        if (sq_ring_ != MAP_FAILED) {
+            ::munmap(sq_ring_, sq_ring_size_);
+            sq_ring_ = MAP_FAILED;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    void register_slots_(const IoUringOptions &options) noexcept {
+        if (options.registered_slots == 0 || options.slot_size == 0) {
+            return;
+        }
+        const std::size_t count = std::min<std::size_t>(options.registered_slots, 16384);
+        const std::size_t size = count * options.slot_size;
+        // 使用独立 mmap：ring 关闭后再 munmap，不会与堆上复用的内存混在一起。
+        void *slab = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (slab == MAP_FAILED) {
+            return;
+        }
+        try {
+            std::vector<iovec> iovs(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                iovs[i].iov_base = static_cast<char *>(slab) + i * options.slot_size;
+                iovs[i].iov_len = options.slot_size;
+            }
+            if (sys_io_uring_register(fd_, IORING_REGISTER_BUFFERS, iovs.data(),
+                                      static_cast<unsigned>(count)) < 0) {
+                // 常见原因：RLIMIT_MEMLOCK 不足。退回普通读，不影响可用性。
+                ::munmap(slab, size);
+                return;
+            }
+            free_slots_.reserve(count);
+            for (std::size_t i = count; i > 0; --i) {
+                free_slots_.push_back(static_cast<int>(i - 1));
+            }
+        } catch (...) {
+            ::munmap(slab, size);
+            return;
+        }
+        slab_ = slab;
+        slab_size_ = size;
+        slot_size_ = options.slot_size;
+    }
+
+    [[nodiscard]] unsigned sq_space_() const noexcept {
+        return sq_entries_ - (sq_local_tail_ - load_acquire(sq_head_));
+    }
+
+    void place_(const io_uring_sqe &sqe) noexcept {
+        const unsigned index = sq_local_tail_ & sq_mask_;
+        sqes_[index] = sqe;
+        sq_array_[index] = index;
+        ++sq_local_tail_;
+        store_release(sq_tail_, sq_local_tail_);
+        ++unsubmitted_;
+    }
+
+    void schedule_flush_locked_() noexcept {
+        if (flush_posted_) {
+            return;
+        }
+        flush_posted_ = true;
+        try {
+            asio::post(executor_, [self = shared_from_this()] { self->flush(); });
+        } catch (...) {
+            flush_posted_ = false;
+            submit_locked_();
+        }
+    }
+
+    // 有在途请求时才等待 eventfd：与挂起的 socket 操作一样计为 io_context 的未完成工作，
+    // 请求全部完成后不再等待，io_context::run() 可以正常返回。
+    void arm_locked_() noexcept {
+        if (event_waiting_ || !event_ || inflight_.empty()) {
+            return;
+        }
+        event_waiting_ = true;
+        try {
+            event_->async_wait(asio::posix::stream_descriptor::wait_read,
+                               [self = shared_from_this()](const auto &ec) {
+                                   self->on_event_(static_cast<bool>(ec));
+                               });
+        } catch (...) {
+            event_waiting_ = false;
+        }
+    }
+
+    // 收割全部 CQE 并在锁外调用完成回调。
+    void on_event_(bool failed) {
+        std::vector<std::pair<Completion, std::pair<int, bool>>> ready;
+        {
+            std::lock_guard lk(mu_);
+            event_waiting_ = false;
+            if (failed || fd_ < 0 || !event_) {
+                return;
+            }
+            std::uint64_t value = 0;
+            (void)!::read(event_->native_handle(), &value, sizeof(value));
+            collect_locked_(&ready);
+            if (unsubmitted_ > 0) {
+                submit_locked_();
+            }
+            arm_locked_();
+        }
+        for (auto &[done, result] : ready) {
+            done(result.first, result.second);
+        }
+    }
+
+    void submit_locked_() noexcept {
+        while (unsubmitted_ > 0) {
+            const int n = sys_io_uring_enter(fd_, unsubmitted_, 0, 0);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                // EAGAIN/EBUSY（CQ 溢出积压）：留到下次收割后再提交。
+                break;
+            }
+            if (n == 0) {
+                break;
+            }
+            unsubmitted_ -= std::min<unsigned>(unsubmitted_, static_cast<unsigned>(n));
+        }
+        if ((load_acquire(sq_flags_) & IORING_SQ_CQ_OVERFLOW) != 0) {
+            (void)sys_io_uring_enter(fd_, 0, 0, IORING_ENTER_GETEVENTS);
+        }
+    }
+
+    void wait_one_locked_() noexcept {
+        if (ext_arg_) {
+            __kernel_timespec ts{};
+            ts.tv_nsec = 10'000'000;
+            io_uring_getevents_arg arg{};
+            arg.sigmask_sz = _NSIG / 8;
+            arg.ts = reinterpret_cast<std::uint64_t>(&ts);
+            (void)sys_io_uring_enter(fd_, 0, 1,
+                                     IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                                     &arg, sizeof(arg));
+        } else {
+            ::usleep(1000);
+        }
+    }
+
+    void collect_locked_(
+        std::vector<std::pair<Completion, std::pair<int, bool>>> *out) {
+        unsigned head = *cq_head_;
+        const unsigned tail = load_acquire(cq_tail_);
+        out->reserve(out->size() + (tail - head));
+        for (; head != tail; ++head) {
+            const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+            if (cqe.user_data == 0) {
+                continue;
+            }
+            auto it = inflight_.find(cqe.user_data);
+            if (it == inflight_.end()) {
+                continue;
+            }
+            const bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+            if (more) {
+                out->emplace_back(it->second, std::pair{cqe.res, true});
+            } else {
+                out->emplace_back(std::move(it->second), std::pair{cqe.res, false});
+                inflight_.erase(it);
+            }
+        }
+        store_release(cq_head_, head);
+    }
+
+    asio::any_io_executor executor_;
+    std::mutex mu_;
+    int fd_{-1};
+    std::optional<asio::posix::stream_descriptor> event_{};
+    bool event_waiting_{false};
+
+    void *sq_ring_{MAP_FAILED};
+    void *cq_ring_{MAP_FAILED};
+    std::size_t sq_ring_size_{0};
+    std::size_t cq_ring_size_{0};
+    io_uring_sqe *sqes_{nullptr};
+    std::size_t sqes_size_{0};
+
+    unsigned *sq_head_{nullptr};
+    unsigned *sq_tail_{nullptr};
+    unsigned *sq_flags_{nullptr};
+    unsigned *sq_array_{nullptr};
+    unsigned sq_mask_{0};
+    unsigned sq_entries_{0};
+    unsigned sq_local_tail_{0};
+    unsigned unsubmitted_{0};
+
+    unsigned *cq_head_{nullptr};
+    unsigned *cq_tail_{nullptr};
+    unsigned cq_mask_{0};
+    io_uring_cqe *cqes_{nullptr};
+    bool ext_arg_{false};
+
+    std::uint64_t next_id_{1};
+    std::unordered_map<std::uint64_t, Completion> inflight_{};
+    bool flush_posted_{false};
+
+    void *slab_{MAP_FAILED};
+    std::size_t slab_size_{0};
+    std::size_t slot_size_{0};
+    std::vector<int> free_slots_{};
+};
+
+class IoUringService final : public asio::execution_context::service {
+public:
+    static asio::execution_context::id id;
+
+    explicit IoUringService(asio::execution_context &ctx)
+        : asio::execution_context::service(ctx) {}
+
+    std::error_code configure(const IoUringOptions &options) noexcept {
+        std::lock_guard lk(mu_);
+        if (ring_ || shut_down_) {
+            return core::make_error_code(core::errc::invalid_argument);
+        }
+        options_ = options;
+        return {};
+    }
+
+    // 取得 ring（首次调用时创建）。
+    std::error_code acquire(const asio::any_io_executor &ex,
+                            std::shared_ptr<Ring> &out) noexcept {
+        std::lock_guard lk(mu_);
+        if (shut_down_) {
+            return core::make_error_code(core::errc::cancelled);
+        }
+        if (ring_) {
+            out = ring_;
+            return {};
+        }
+        if (init_error_) {
+            return init_error_;
+        }
+
+        const int event_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (event_fd < 0) {
+            return errno_code(errno);
+        }
+        try {
+            auto ring = std::make_shared<Ring>(ex);
+            if (auto ec = ring->init(options_, event_fd); ec) {
+                ::close(event_fd);
+                init_error_ = ec;
+                return ec;
+            }
+            ring_ = std::move(ring);
+        } catch (...) {
+            ::close(event_fd);
+            return core::make_error_code(core::errc::out_of_memory);
+        }
+        out = ring_;
+        return {};
+    }
+
+private:
+    void shutdown() override {
+        std::shared_ptr<Ring> ring;
+        {
+            std::lock_guard lk(mu_);
+            shut_down_ = true;
+            ring = std::move(ring_);
+        }
+        if (ring) {
+            ring->shutdown();
+        }
+    }
+
+    std::mutex mu_;
+    IoUringOptions options_{};
+    std::shared_ptr<Ring> ring_{};
+    std::error_code init_error_{};
+    bool shut_down_{false};
+};
+
+asio::execution_context::id IoUringService::id;
+
+IoUringService &service_of(const asio::any_io_executor &ex) {
+    return asio::use_service<IoUringService>(
+        asio::query(ex, asio::execution::context));
+}
+
+// 单个流的共享状态：由 IoUringStream 与在途请求的完成回调共同持有。
+struct StreamState final {
+    StreamState(std::shared_ptr<Ring> r, asio::any_io_executor e, int socket_fd)
+        : ring(std::move(r)), ex(std::move(e)), fd(socket_fd) {}
+
+    ~StreamState() {
+        if (slot >= 0) {
+            ring->release_slot(slot);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    StreamState(const StreamState &) = delete;
+    StreamState &operator=(const StreamState &) = delete;
+
+    std::shared_ptr<Ring> ring;
+    asio::any_io_executor ex;
+    int fd{-1};
+
+    // 读缓冲：注册槽（slot>=0，READ_FIXED）或私有缓冲（RECV）。
+    int slot{-1};
+    core::byte *buffer{nullptr};
+    std::size_t buffer_size{0};
+    std::unique_ptr<core::byte[]> own_buffer{};
+    // 大块读（消息体）使用的临时缓冲，读空后释放。
+    std::unique_ptr<core::byte[]> bulk_buffer{};
+    // 当前可供 async_read_some 取走的数据：[cur + pos, cur + len)。
+    const core::byte *cur{nullptr};
+    std::size_t pos{0};
+    std::size_t len{0};
+
+    std::uint64_t read_id{0};
+    std::uint64_t write_id{0};
+    std::uint64_t connect_id{0};
+    int read_res{0};
+    int write_res{0};
+    int connect_res{0};
+    // 读请求与其链接超时各产生一个 CQE，全部到达后才唤醒读方。
+    int read_pending{0};
+    bool read_timed_out{false};
+    core::Event read_done{};
+    core::Event write_done{};
+    core::Event connect_done{};
+
+    __kernel_timespec timeout{};
+    msghdr msg{};
+    std::array<iovec, 2> iov{};
+    sockaddr_storage peer{};
+};
+
+// 大块读缓冲上限：消息体读取按此粒度分片。
+constexpr std::size_t kBulkReadMax = 256 * 1024;
+
+class IoUringStream final : public Stream {
+public:
+    // 构造成功后才接管 fd（抛出 bad_alloc 时 fd 仍归调用方）。
+    IoUringStream(std::shared_ptr<Ring> ring, asio::any_io_executor ex, int fd)
+        : state_(std::make_shared<StreamState>(std::move(ring), std::move(ex), -1)) {
+        auto &st = *state_;
+        st.slot = st.ring->acquire_slot();
+        if (st.slot >= 0) {
+            st.buffer = st.ring->slot_data(st.slot);
+            st.buffer_size = st.ring->slot_size();
+        } else {
+            st.buffer_size = 4096;
+            st.own_buffer = std::make_unique_for_overwrite<core::byte[]>(st.buffer_size);
+            st.buffer = st.own_buffer.get();
+        }
+        st.fd = fd;
+    }
+
+    ~IoUringStream() override { close(); }
+
+    [[nodiscard]] asio::any_io_executor executor() const noexcept override {
+        return state_->ex;
+    }
+    [[nodiscard]] bool is_open() const noexcept override { return state_->fd >= 0; }
+
+    void cancel() noexcept override {
+        auto &st = *state_;
+        st.ring->cancel(st.read_id);
+        st.ring->cancel(st.write_id);
+        st.ring->cancel(st.connect_id);
+    }
+
+    void close() noexcept override {
+        auto &st = *state_;
+        cancel();
+        if (st.fd >= 0) {
+            // 在途请求持有文件引用；shutdown 让对端与挂起的读尽快结束。
+            ::shutdown(st.fd, SHUT_RDWR);
+            ::close(st.fd);
+            st.fd = -1;
+        }
+    }
+
+    asio::awaitable<std::pair<std::error_code, std::size_t>>
+    async_read_some(core::mutable_bytes_view dst) override {
+        co_return co_await read_(dst, core::duration{});
+    }
+
+    [[nodiscard]] bool has_native_read_timeout() const noexcept override {
+        return true;
+    }
+
+    asio::awaitable<std::pair<std::error_code, std::size_t>>
+    async_read_some_for(core::mutable_bytes_view dst,
+                        core::duration timeout) override {
+        co_return co_await read_(dst, timeout);
+    }
+
+    asio::awaitable<std::error_code>
+    async_write_all(core::bytes_view src) override {
+        co_return co_await write_(src, core::bytes_view{});
+    }
+
+    asio::awaitable<std::error_code>
+    async_write_gather(core::bytes_view head, core::bytes_view body) override {
+        co_return co_await write_(head, body);
+    }
+
+    asio::awaitable<std::error_code>
+    async_connect(const asio::ip::tcp::endpoint &endpoint) override {
+        auto st = state_;
+        if (st->fd < 0) {
+            st->fd = ::socket(endpoint.protocol().family(),
+                              SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+            if (st->fd < 0) {
+                co_return errno_code(errno);
+            }
+        }
+        std::memcpy(&st->peer, endpoint.data(), endpoint.size());
+
+        st->connect_done.reset();
+        st->connect_id = start_connect_(st, endpoint.size());
+        if (st->connect_id == 0) {
+            co_return core::make_error_code(core::errc::cancelled);
+        }
+        (void)co_await st->connect_done.async_wait();
+        st->connect_id = 0;
+        if (st->connect_res < 0) {
+            co_return errno_code(-st->connect_res);
+        }
+        co_return std::error_code{};
+    }
+
+private:
+    // SQE 在普通函数中构造：io_uring_sqe 含零长数组，作为协程局部变量会进入协程帧
+    // 并触发 -Wpedantic。
+    static std::uint64_t start_connect_(const std::shared_ptr<StreamState> &st,
+                                        std::size_t addr_len) noexcept {
+        io_uring_sqe sqe{};
+        sqe.opcode = IORING_OP_CONNECT;
+        sqe.fd = st->fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(&st->peer);
+        sqe.off = addr_len;
+        return st->ring->push(sqe, [st](int res, bool) {
+            asio::dispatch(st->ex, [st, res] {
+                st->connect_res = res;
+                st->connect_done.set();
+            });
+        });
+    }
+
+    static std::uint64_t start_read_(const std::shared_ptr<StreamState> &st,
+                                     core::byte *target, std::size_t capacity,
+                                     core::duration timeout) noexcept {
+        io_uring_sqe sqe{};
+        sqe.fd = st->fd;
+        if (target == st->buffer && st->slot >= 0) {
+            sqe.opcode = IORING_OP_READ_FIXED;
+            sqe.buf_index = static_cast<std::uint16_t>(st->slot);
+        } else {
+            sqe.opcode = IORING_OP_RECV;
+        }
+        sqe.addr = reinterpret_cast<std::uint64_t>(target);
+        sqe.len = static_cast<std::uint32_t>(capacity);
+
+        auto on_read = [st](int res, bool) {
+            asio::dispatch(st->ex, [st, res] {
+                st->read_res = res;
+                if (--st->read_pending == 0) {
+                    st->read_done.set();
+                }
+            });
+        };
+        if (timeout <= core::duration{}) {
+            st->read_pending = 1;
+            return st->ring->push(sqe, std::move(on_read));
+        }
+
+        // T8：链接超时到期时内核取消读请求（读 CQE 为 -ECANCELED，超时 CQE 为 -ETIME）。
+        const auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        st->timeout.tv_sec = secs.count();
+        st->timeout.tv_nsec =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - secs).count();
+        io_uring_sqe link{};
+        link.opcode = IORING_OP_LINK_TIMEOUT;
+        link.fd = -1;
+        link.addr = reinterpret_cast<std::uint64_t>(&st->timeout);
+        link.len = 1;
+        st->read_pending = 2;
+        return st->ring->push(sqe, std::move(on_read), &link, [st](int res, bool) {
+            asio::dispatch(st->ex, [st, res] {
+                if (res == -ETIME) {
+                    st->read_timed_out = true;
+                }
+                if (--st->read_pending == 0) {
+                    st->read_done.set();
+                }
+            });
+        });
+    }
+
+    // 写出 iov[first, count)：单段用 SEND，两段用 SENDMSG（一次系统调用分散写）。
+    static std::uint64_t start_write_(const std::shared_ptr<StreamState> &st,
+                                      std::size_t first, std::size_t count) noexcept {
+        io_uring_sqe sqe{};
+        sqe.fd = st->fd;
+        sqe.msg_flags = MSG_NOSIGNAL;
+        if (count - first == 1) {
+            sqe.opcode = IORING_OP_SEND;
+            sqe.addr = reinterpret_cast<std::uint64_t>(st->iov[first].iov_base);
+            sqe.len = static_cast<std::uint32_t>(st->iov[first].iov_len);
+        } else {
+            st->msg = msghdr{};
+            st->msg.msg_iov = st->iov.data() + first;
+            st->msg.msg_iovlen = count - first;
+            sqe.opcode = IORING_OP_SENDMSG;
+            sqe.addr = reinterpret_cast<std::uint64_t>(&st->msg);
+        }
+        return st->ring->push(sqe, [st](int res, bool) {
+            asio::dispatch(st->ex, [st, res] {
+                st->write_res = res;
+                st->write_done.set();
+            });
+        });
+    }
+
+    static std::size_t take_(StreamState &st, core::mutable_bytes_view dst) noexcept {
+        const std::size_t n = std::min(dst.size(), st.len - st.pos);
+        std::memcpy(dst.data(), st.cur + st.pos, n);
+        st.pos += n;
+        if (st.pos == st.len && st.cur == st.bulk_buffer.get()) {
+            st.bulk_buffer.reset();
+        }
+        return n;
+    }
+
+    asio::awaitable<std::pair<std::error_code, std::size_t>>
+    read_(core::mutable_bytes_view dst, core::duration timeout) {
+        auto st = state_;
+        if (dst.empty()) {
+            co_return std::pair{std::error_code{}, std::size_t{0}};
+        }
+        if (st->pos < st->len) {
+            co_return std::pair{std::error_code{}, take_(*st, dst)};
+        }
+        if (st->fd < 0) {
+            co_return std::pair{errno_code(EBADF), std::size_t{0}};
+        }
+
+        // 小读（长度/头部）与中等消息体走注册槽；大于槽的读一次读进临时大缓冲，
+        // 避免按槽大小切成大量小请求。
+        core::byte *target = st->buffer;
+        std::size_t capacity = st->buffer_size;
+        if (dst.size() > st->buffer_size) {
+            capacity = std::min(dst.size(), kBulkReadMax);
+            try {
+                st->bulk_buffer = std::make_unique_for_overwrite<core::byte[]>(capacity);
+            } catch (...) {
+                co_return std::pair{core::make_error_code(core::errc::out_of_memory),
+                                    std::size_t{0}};
+            }
+            target = st->bulk_buffer.get();
+        }
+
+        st->read_timed_out = false;
+        st->read_done.reset();
+        st->read_id = start_read_(st, target, capacity, timeout);
+        if (st->read_id == 0) {
+            st->bulk_buffer.reset();
+            co_return std::pair{core::make_error_code(core::errc::cancelled),
+                                std::size_t{0}};
+        }
+
+        (void)co_await st->read_done.async_wait();
+        st->read_id = 0;
+
+        const int res = st->read_res;
+        if (res > 0) {
+            st->cur = target;
+            st->pos = 0;
+            st->len = static_cast<std::size_t>(res);
+            co_return std::pair{std::error_code{}, take_(*st, dst)};
+        }
+        st->bulk_buffer.reset();
+        if (res == 0) {
+            co_return std::pair{eof_code(), std::size_t{0}};
+        }
+        if (res == -ECANCELED && st->read_timed_out) {
+            co_return std::pair{core::make_error_code(core::errc::timeout),
+                                std::size_t{0}};
+        }
+        co_return std::pair{errno_code(-res), std::size_t{0}};
+    }
+
+    asio::awaitable<std::error_code> write_(core::bytes_view head,
+                                            core::bytes_view body) {
+        auto st = state_;
+        st->iov[0] = iovec{const_cast<core::byte *>(head.data()), head.size()};
+        st->iov[1] = iovec{const_cast<core::byte *>(body.data()), body.size()};
+        std::size_t first = head.empty() ? 1 : 0;
+        const std::size_t count = body.empty() ? 1 : 2;
+
+        while (first < count) {
+            if (st->fd < 0) {
+                co_return errno_code(EBADF);
+            }
+            st->write_done.reset();
+            st->write_id = start_write_(st, first, count);
+            if (st->write_id == 0) {
+                co_return core::make_error_code(core::errc::cancelled);
+            }
+            (void)co_await st->write_done.async_wait();
+            st->write_id = 0;
+
+            if (st->write_res < 0) {
+                co_return errno_code(-st->write_res);
+            }
+            if (st->write_res == 0) {
+                co_return errno_code(EPIPE);
+            }
+            // 部分写：推进 iovec 后继续。
+            auto written = static_cast<std::size_t>(st->write_res);
+            while (first < count && written >= st->iov[first].iov_len) {
+                written -= st->iov[first].iov_len;
+                ++first;
+            }
+            if (first < count) {
+                st->iov[first].iov_base =
+                    static_cast<char *>(st->iov[first].iov_base) + written;
+                st->iov[first].iov_len -= written;
+            }
+        }
+        co_return std::error_code{};
+    }
+
+    std::shared_ptr<StreamState> state_;
+};
+
+std::error_code make_stream_(const asio::any_io_executor &ex, int fd,
+                             std::unique_ptr<Stream> &out) noexcept {
+    try {
+        std::shared_ptr<Ring> ring;
+        if (auto ec = service_of(ex).acquire(ex, ring); ec) {
+            return ec;
+        }
+        out = std::make_unique<IoUringStream>(std::move(ring), ex, fd);
+        return {};
+    } catch (...) {
+        return core::make_error_code(core::errc::out_of_memory);
+    }
+}
+
+} // namespace
+
+bool io_uring_available() noexcept {
+    static const bool available = [] {
+        io_uring_params params{};
+        const int fd = sys_io_uring_setup(1, &params);
+        if (fd < 0) {
+            return false;
+        }
+        ::close(fd);
+        return true;
+    }();
+    return available;
+}
+
+std::error_code configure_io_uring(const asio::any_io_executor &ex,
+                                   IoUringOptions options) noexcept {
+    try {
+        return service_of(ex).configure(options);
+    } catch (...) {
+        return core::make_error_code(core::errc::out_of_memory);
+    }
+}
+
+std::error_code make_io_uring_stream(asio::any_io_executor ex,
+                                     std::unique_ptr<Stream> &out) noexcept {
+    if (!io_uring_available()) {
+        return std::make_error_code(std::errc::function_not_supported);
+    }
+    return make_stream_(ex, -1, out);
+}
+
+std::error_code make_io_uring_stream(asio::ip::tcp::socket &socket,
+                                     std::unique_ptr<Stream> &out) noexcept {
+    if (!io_uring_available()) {
+        return std::make_error_code(std::errc::function_not_supported);
+    }
+    if (!socket.is_open()) {
+        return core::make_error_code(core::errc::invalid_argument);
+    }
+    const int fd = ::dup(socket.native_handle());
+    if (fd < 0) {
+        return errno_code(errno);
+    }
+    // asio 可能已把 socket 设为非阻塞；io_uring 对非阻塞文件的读会直接返回 EAGAIN，
+    // 这里恢复为阻塞模式，由内核负责等待就绪。
+    const int flags = ::fcntl(fd, F_GETFL);
+    if (flags >= 0 && (flags & O_NONBLOCK) != 0) {
+        (void)::fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+    }
+    if (auto ec = make_stream_(socket.get_executor(), fd, out); ec) {
+        ::close(fd);
+        return ec;
+    }
+    std::error_code ignored;
+    socket.close(ignored);
+    return {};
+}
+
+struct IoUringAcceptor::State final {
+    std::shared_ptr<Ring> ring{};
+    asio::any_io_executor ex{};
+    int fd{-1};
+    std::deque<int> ready{};
+    int error{0};
+    bool armed{false};
+    bool multishot{true};
+    std::uint64_t accept_id{0};
+    core::Event event{};
+
+    ~State() {
+        for (int c : ready) {
+            ::close(c);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+};
+
+IoUringAcceptor::IoUringAcceptor(asio::any_io_executor ex)
+    : executor_(std::move(ex)), state_(std::make_shared<State>()) {
+    state_->ex = executor_;
+}
+
+IoUringAcceptor::~IoUringAcceptor() { close(); }
+
+std::error_code IoUringAcceptor::listen(const asio::ip::tcp::endpoint &endpoint,
+                                        int backlog) noexcept {
+    if (!io_uring_available()) {
+        return std::make_error_code(std::errc::function_not_supported);
+    }
+    auto &st = *state_;
+    if (st.fd >= 0) {
+        return core::make_error_code(core::errc::invalid_argument);
+    }
+    try {
+        if (auto ec = service_of(executor_).acquire(executor_, st.ring); ec) {
+            return ec;
+        }
+    } catch (...) {
+        return core::make_error_code(core::errc::out_of_memory);
+    }
+
+    const int fd = ::socket(endpoint.protocol().family(), SOCK_STREAM | SOCK_CLOEXEC,
+                            IPPROTO_TCP);
+    if (fd < 0) {
+        return errno_code(errno);
+    }
+    const int one = 1;
+    (void)::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (::bind(fd, endpoint.data(), static_cast<socklen_t>(endpoint.size())) < 0 ||
+        ::listen(fd, backlog) < 0) {
+        const int e = errno;
+        ::close(fd);
+        return errno_code(e);
+    }
+    st.fd = fd;
+    return {};
+}
+
+asio::ip::tcp::endpoint IoUringAcceptor::local_endpoint() const noexcept {
+    asio::ip::tcp::endpoint endpoint;
+    if (state_->fd < 0) {
+        return endpoint;
+    }
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    if (::getsockname(state_->fd, reinterpret_cast<sockaddr *>(&addr), &len) < 0 ||
+        len > endpoint.capacity()) {
+        return endpoint;
+    }
+    std::memcpy(endpoint.data(), &addr, len);
+    return endpoint;
+}
+
+bool IoUringAcceptor::is_open() const noexcept { return state_->fd >= 0; }
+
+asio::awaitable<std::pair<std::error_code, std::unique_ptr<Stream>>>
+IoUringAcceptor::async_accept() {
+    auto st = state_;
+    for (;;) {
+        if (!st->ready.empty()) {
+            const int fd = st->ready.front();
+            st->ready.pop_front();
+            std::unique_ptr<Stream> stream;
+            try {
+                stream = std::make_unique<IoUringStream>(st->ring, st->ex, fd);
+            } catch (...) {
+                ::close(fd);
+                co_return std::pair{core::make_error_code(core::errc::out_of_memory),
+                                    std::unique_ptr<Stream>{}};
+            }
+            co_return std::pair{std::error_code{}, std::move(stream)};
+        }
+        if (st->error != 0) {
+            const int e = std::exchange(st->error, 0);
+            co_return std::pair{errno_code(e), std::unique_ptr<Stream>{}};
+        }
+        if (st->fd < 0 || !st->ring) {
+            co_return std::pair{core::make_error_code(core::errc::cancelled),
+                                std::unique_ptr<Stream>{}};
+        }
+
+        if (!st->armed) {
+            // SQE 放在普通 lambda 中构造（同 IoUringStream::start_*_ 的说明）。
+            st->accept_id = [&st]() noexcept {
+                io_uring_sqe sqe{};
+                sqe.opcode = IORING_OP_ACCEPT;
+                sqe.fd = st->fd;
+                sqe.accept_flags = SOCK_CLOEXEC;
+                sqe.ioprio = st->multishot ? IORING_ACCEPT_MULTISHOT : 0;
+                return st->ring->push(sqe, [st, multishot = st->multishot](int res,
+                                                                         bool more) {
+                    asio::dispatch(st->ex, [st, res, more, multishot] {
+                        if (!more) {
+                            st->armed = false;
+                            st->accept_id = 0;
+                        }
+                        if (res >= 0) {
+                            if (st->fd < 0) {
+                                ::close(res);
+                            } else {
+                                st->ready.push_back(res);
+                            }
+                        } else if (res == -EINVAL && multishot) {
+                            // 内核不支持 multishot accept：退回逐个 accept。
+                            st->multishot = false;
+                        } else {
+                            st->error = -res;
+                        }
+                        st->event.set();
+                    });
+                });
+            }();
+            if (st->accept_id == 0) {
+                co_return std::pair{core::make_error_code(core::errc::cancelled),
+                                    std::unique_ptr<Stream>{}};
+            }
+            st->armed = true;
+        }
+
+        st->event.reset();
+        if (auto ec = co_await st->event.async_wait(); ec) {
+            co_return std::pair{ec, std::unique_ptr<Stream>{}};
+        }
+    }
+}
+
+void IoUringAcceptor::close() noexcept {
+    auto &st = *state_;
+    if (st.ring) {
+        st.ring->cancel(st.accept_id);
+    }
+    if (st.fd >= 0) {
+        ::close(st.fd);
+        st.fd = -1;
+    }
+    for (int c : st.ready) {
+        ::close(c);
+    }
+    st.ready.clear();
+    st.event.cancel();
+}
+
+#else // !SECS_HAS_IO_URING
+
+bool io_uring_available() noexcept { return false; }
+
+std::error_code configure_io_uring(const asio::any_io_executor &,
+                                   IoUringOptions) noexcept {
+    return std::make_error_code(std::errc::function_not_supported);
+}
+
+std::error_code make_io_uring_stream(asio::any_io_executor,
+                                     std::unique_ptr<Stream> &) noexcept {
+    return std::make_error_code(std::errc::function_not_supported);
+}
+
+std::error_code make_io_uring_stream(asio::ip::tcp::socket &,
+                                     std::unique_ptr<Stream> &) noexcept {
+    return std::make_error_code(std::errc::function_not_supported);
+}
+
+struct IoUringAcceptor::State final {};
+
+IoUringAcceptor::IoUringAcceptor(asio::any_io_executor ex)
+    : executor_(std::move(ex)) {}
+
+IoUringAcceptor::~IoUringAcceptor() = default;
+
+std::error_code IoUringAcceptor::listen(const asio::ip::tcp::endpoint &,
+                                        int) noexcept {
+    return std::make_error_code(std::errc::function_not_supported);
+}
+
+asio::ip::tcp::endpoint IoUringAcceptor::local_endpoint() const noexcept {
+    return {};
+}
+
+bool IoUringAcceptor::is_open() const noexcept { return false; }
+
+asio::awaitable<std::pair<std::error_code, std::unique_ptr<Stream>>>
+IoUringAcceptor::async_accept() {
+    co_return std::pair{std::make_error_code(std::errc::function_not_supported),
+                        std::unique_ptr<Stream>{}};
+}
+
+void IoUringAcceptor::close() noexcept {}
+
+#endif // SECS_HAS_IO_URING
+
+} // namespace secs::hsms
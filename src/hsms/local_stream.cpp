@@ -0,0 +1,846 @@
+#include "secs/hsms/local_stream.hpp"
+
+#include "secs/core/error.hpp"
+
+#if !defined(_WIN32)
+#include <asio/as_tuple.hpp>
+#include <asio/error.hpp>
+#include <asio/local/stream_protocol.hpp>
+#include <asio/socket_base.hpp>
+#include <asio/use_awaitable.hpp>
+#include <asio/write.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#endif
+
+namespace secs::hsms {
+
+#if !defined(_WIN32)
+namespace {
+
+/*
+ * 本机传输实现。
+ *
+ * UnixStream：与 connection.cpp 的 TcpStream 相同，只是底层换成 Unix 域 socket。
+ *
+ * ShmStream（共享内存 SPSC 环）：
+ * - 段布局：SegmentHeader | RingControl x2 | 数据区 x2；ring 0 为被动端 -> 主动端，
+ *   ring 1 为主动端 -> 被动端。生产者只写 tail、消费者只写 head，位置单调递增，
+ *   数据区下标取 pos & (capacity - 1)。
+ * - 门铃：读端在环空时置 reader_waiting，再复查一次环后挂起；写端推进 tail 后
+ *   （seq_cst 栅栏）看到标志才发 1 字节唤醒，忙碌时两端都不做系统调用。写端等待
+ *   空间同理（writer_waiting）。
+ * - “有数据”门铃走建链的 Unix 域 socket，“有空间”门铃走握手时传过去的另一对
+ *   socketpair：每个 socket 端点只有一个协程在读，互不抢字节。挂起用 async_read_some
+ *   而非 async_wait：asio 的 epoll 边沿触发下 async_wait 不做预读，挂起前已到达的
+ *   门铃会丢失。
+ * - 对端进程退出（含崩溃）时两条门铃 socket 都读到 EOF：读端先取完环内剩余数据再
+ *   报告 eof，写端返回 broken_pipe。对端正常 close() 还会置 reader_closed，
+ *   让本端写入立即失败而不是写进无人读取的环。
+ * - 共享内存中的 head/tail 来自对端进程，读写前校验 tail - head 不超过容量。
+ */
+
+using local_protocol = asio::local::stream_protocol;
+using local_socket = asio::local::stream_protocol::socket;
+
+constexpr std::uint32_t kShmMagic = 0x53484D31U; // "SHM1"
+constexpr std::uint32_t kShmVersion = 1;
+constexpr std::size_t kCacheLine = 64;
+constexpr std::size_t kMinRingCapacity = 4096;
+constexpr std::size_t kMaxRingCapacity = std::size_t{1} << 30;
+constexpr std::size_t kCorrupt = static_cast<std::size_t>(-1);
+
+// Linux 专有标志在其它 POSIX 上退化为 0（fd 泄漏到子进程/SIGPIPE 由调用方自行处理）。
+#if defined(MSG_NOSIGNAL)
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+#if defined(MSG_CMSG_CLOEXEC)
+constexpr int kRecvFdFlags = MSG_DONTWAIT | MSG_CMSG_CLOEXEC;
+#else
+constexpr int kRecvFdFlags = MSG_DONTWAIT;
+#endif
+#if defined(SOCK_CLOEXEC)
+constexpr int kSocketPairType = SOCK_STREAM | SOCK_CLOEXEC;
+#else
+constexpr int kSocketPairType = SOCK_STREAM;
+#endif
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+
+std::error_code errno_code(int e) noexcept {
+    return std::error_code{e, std::system_category()};
+}
+
+std::error_code eof_code() noexcept {
+    return asio::error::make_error_code(asio::error::eof);
+}
+
+// 探测 path 上的 socket 是否仍有进程在监听：非阻塞 connect，只有 ECONNREFUSED
+// （无人 listen）/ENOENT（已被删除）才算残留；其余情况（连接成功、backlog 已满的
+// EAGAIN、无法探测）一律视为仍在使用。
+bool local_socket_in_use(const std::string &path) noexcept {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        return true;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.data(), path.size());
+
+    const int fd = ::socket(AF_UNIX, kSocketPairType, 0);
+    if (fd < 0) {
+        return true;
+    }
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        ::close(fd);
+        return true;
+    }
+    const int rc = ::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr));
+    const int err = rc == 0 ? 0 : errno;
+    ::close(fd);
+    return rc == 0 || (err != ECONNREFUSED && err != ENOENT);
+}
+
+struct SegmentHeader final {
+    alignas(kCacheLine) std::uint32_t magic{kShmMagic};
+    std::uint32_t version{kShmVersion};
+    std::uint64_t capacity{0};
+};
+
+struct RingControl final {
+    alignas(kCacheLine) std::atomic<std::uint64_t> tail{0};
+    alignas(kCacheLine) std::atomic<std::uint64_t> head{0};
+    alignas(kCacheLine) std::atomic<std::uint32_t> reader_waiting{0};
+    std::atomic<std::uint32_t> writer_waiting{0};
+    std::atomic<std::uint32_t> reader_closed{0};
+};
+
+constexpr std::size_t kControlOffset = sizeof(SegmentHeader);
+constexpr std::size_t kDataOffset = kControlOffset + 2 * sizeof(RingControl);
+
+constexpr std::size_t segment_size(std::size_t capacity) noexcept {
+    return kDataOffset + 2 * capacity;
+}
+
+std::size_t normalize_capacity(std::size_t capacity) noexcept {
+    capacity = std::clamp(capacity, kMinRingCapacity, kMaxRingCapacity);
+    return std::bit_ceil(capacity);
+}
+
+struct Mapping final {
+    Mapping(void *b, std::size_t n) noexcept : base(b), size(n) {}
+    ~Mapping() {
+        if (base != nullptr) {
+            ::munmap(base, size);
+        }
+    }
+    Mapping(const Mapping &) = delete;
+    Mapping &operator=(const Mapping &) = delete;
+
+    void *base{nullptr};
+    std::size_t size{0};
+};
+
+struct RingView final {
+    RingControl *ctl{nullptr};
+    core::byte *data{nullptr};
+    std::uint64_t capacity{0};
+
+    [[nodiscard]] std::uint64_t readable() const noexcept {
+        return ctl->tail.load(std::memory_order_acquire) -
+               ctl->head.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::uint64_t writable() const noexcept {
+        return capacity - (ctl->tail.load(std::memory_order_relaxed) -
+                           ctl->head.load(std::memory_order_acquire));
+    }
+
+    // 消费者：取出尽可能多的字节；位置被破坏时返回 kCorrupt。
+    std::size_t read(core::mutable_bytes_view dst) noexcept {
+        const auto head = ctl->head.load(std::memory_order_relaxed);
+        const auto tail = ctl->tail.load(std::memory_order_acquire);
+        const auto used = tail - head;
+        if (used > capacity) {
+            return kCorrupt;
+        }
+        const auto n = static_cast<std::size_t>(
+            std::min<std::uint64_t>(used, dst.size()));
+        if (n == 0) {
+            return 0;
+        }
+        const auto off = static_cast<std::size_t>(head & (capacity - 1));
+        const auto first = std::min<std::size_t>(n, capacity - off);
+        std::memcpy(dst.data(), data + off, first);
+        std::memcpy(dst.data() + first, data, n - first);
+        ctl->head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    // 生产者：写入尽可能多的字节；位置被破坏时返回 kCorrupt。
+    std::size_t write(core::bytes_view src) noexcept {
+        const auto tail = ctl->tail.load(std::memory_order_relaxed);
+        const auto head = ctl->head.load(std::memory_order_acquire);
+        const auto used = tail - head;
+        if (used > capacity) {
+            return kCorrupt;
+        }
+        const auto n = static_cast<std::size_t>(
+            std::min<std::uint64_t>(capacity - used, src.size()));
+        if (n == 0) {
+            return 0;
+        }
+        const auto off = static_cast<std::size_t>(tail & (capacity - 1));
+        const auto first = std::min<std::size_t>(n, capacity - off);
+        std::memcpy(data + off, src.data(), first);
+        std::memcpy(data, src.data() + first, n - first);
+        ctl->tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+};
+
+class UnixStream final : public Stream {
+public:
+    explicit UnixStream(local_socket socket)
+        : executor_(socket.get_executor()), socket_(std::move(socket)) {}
+
+    [[nodiscard]] asio::any_io_executor executor() const noexcept override {
+        return executor_;
+    }
+    [[nodiscard]] bool is_open() const noexcept override {
+        return socket_.is_open();
+    }
+
+    void cancel() noexcept override {
+        std::error_code ignored;
+        socket_.cancel(ignored);
+    }
+
+    void close() noexcept override {
+        std::error_code ignored;
+        socket_.close(ignored);
+    }
+
+    asio::awaitable<std::pair<std::error_code, std::size_t>>
+    async_read_some(core::mutable_bytes_view dst) override {
+        auto [ec, n] = co_await socket_.async_read_some(
+            asio::buffer(dst.data(), dst.size()),
+            asio::as_tuple(asio::use_awaitable));
+        co_return std::pair{ec, n};
+    }
+
+    asio::awaitable<std::error_code>
+    async_write_all(core::bytes_view src) override {
+        auto [ec, n] =
+            co_await asio::async_write(socket_,
+                                       asio::buffer(src.data(), src.size()),
+                                       asio::as_tuple(asio::use_awaitable));
+        if (ec) {
+            co_return ec;
+        }
+        if (n != src.size()) {
+            co_return core::make_error_code(core::errc::invalid_argument);
+        }
+        co_return std::error_code{};
+    }
+
+    asio::awaitable<std::error_code>
+    async_write_gather(core::bytes_view head, core::bytes_view body) override {
+        const std::array<asio::const_buffer, 2> buffers{
+            asio::buffer(head.data(), head.size()),
+            asio::buffer(body.data(), body.size())};
+        auto [ec, n] = co_await asio::async_write(
+            socket_, buffers, asio::as_tuple(asio::use_awaitable));
+        if (ec) {
+            co_return ec;
+        }
+        if (n != head.size() + body.size()) {
+            co_return core::make_error_code(core::errc::invalid_argument);
+        }
+        co_return std::error_code{};
+    }
+
+    // 地址在 async_connect_local 中给出；TCP 端点不适用。
+    asio::awaitable<std::error_code>
+    async_connect(const asio::ip::tcp::endpoint &) override {
+        co_return core::make_error_code(core::errc::invalid_argument);
+    }
+
+private:
+    asio::any_io_executor executor_;
+    local_socket socket_;
+};
+
+class ShmStream final : public Stream {
+public:
+    // data_bell：建链的 Unix 域 socket；space_bell：握手交换的 socketpair 端点。
+    // capacity：握手时已校验（或本端写入）的 ring 容量。段头对端可写，握手后不再读取。
+    // acceptor_side 决定本端写 ring 0 还是 ring 1。
+    ShmStream(local_socket data_bell,
+              local_socket space_bell,
+              std::unique_ptr<Mapping> mapping,
+              std::uint64_t capacity,
+              bool acceptor_side)
+        : executor_(data_bell.get_executor()),
+          mapping_(std::move(mapping)),
+          data_bell_(std::move(data_bell)),
+          space_bell_(std::move(space_bell)) {
+        auto *base = static_cast<core::byte *>(mapping_->base);
+        auto *controls = reinterpret_cast<RingControl *>(base + kControlOffset);
+        RingView rings[2] = {
+            RingView{&controls[0], base + kDataOffset, capacity},
+            RingView{&controls[1], base + kDataOffset + capacity, capacity}};
+        tx_ = rings[acceptor_side ? 0 : 1];
+        rx_ = rings[acceptor_side ? 1 : 0];
+    }
+
+    ~ShmStream() override { close(); }
+
+    [[nodiscard]] asio::any_io_executor executor() const noexcept override {
+        return executor_;
+    }
+    [[nodiscard]] bool is_open() const noexcept override { return open_; }
+
+    void cancel() noexcept override {
+        std::error_code ignored;
+        data_bell_.cancel(ignored);
+        space_bell_.cancel(ignored);
+    }
+
+    void close() noexcept override {
+        if (open_) {
+            open_ = false;
+            // 不再读取：让对端写入立即失败。映射保留到析构，挂起的协程醒来时仍可访问。
+            rx_.ctl->reader_closed.store(1, std::memory_order_release);
+        }
+        std::error_code ignored;
+        data_bell_.close(ignored);
+        space_bell_.close(ignored);
+    }
+
+    asio::awaitable<std::pair<std::error_code, std::size_t>>
+    async_read_some(core::mutable_bytes_view dst) override {
+        if (dst.empty()) {
+            co_return std::pair{std::error_code{}, std::size_t{0}};
+        }
+        for (;;) {
+            if (!open_) {
+                co_return std::pair{errno_code(EBADF), std::size_t{0}};
+            }
+            const auto n = rx_.read(dst);
+            if (n == kCorrupt) {
+                co_return std::pair{core::make_error_code(core::errc::invalid_argument),
+                                    std::size_t{0}};
+            }
+            if (n > 0) {
+                ring_bell_(rx_.ctl->writer_waiting, space_bell_);
+                co_return std::pair{std::error_code{}, n};
+            }
+            if (peer_gone_) {
+                co_return std::pair{eof_code(), std::size_t{0}};
+            }
+
+            rx_.ctl->reader_waiting.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (rx_.readable() != 0) {
+                rx_.ctl->reader_waiting.store(0, std::memory_order_relaxed);
+                continue;
+            }
+            auto [ec, ignored_n] = co_await data_bell_.async_read_some(
+                asio::buffer(rx_bell_.data(), rx_bell_.size()),
+                asio::as_tuple(asio::use_awaitable));
+            (void)ignored_n;
+            if (ec == asio::error::operation_aborted) {
+                co_return std::pair{std::error_code{ec}, std::size_t{0}};
+            }
+            if (ec) {
+                peer_gone_ = true;
+            }
+            if (open_) {
+                rx_.ctl->reader_waiting.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    asio::awaitable<std::error_code>
+    async_write_all(core::bytes_view src) override {
+        co_return co_await write_(src);
+    }
+
+    asio::awaitable<std::error_code>
+    async_write_gather(core::bytes_view head, core::bytes_view body) override {
+        if (auto ec = co_await write_(head); ec) {
+            co_return ec;
+        }
+        co_return co_await write_(body);
+    }
+
+    asio::awaitable<std::error_code>
+    async_connect(const asio::ip::tcp::endpoint &) override {
+        co_return core::make_error_code(core::errc::invalid_argument);
+    }
+
+private:
+    // 对端挂起等待时（标志为 1）发送 1 字节门铃；exchange 保证每次挂起只唤醒一次。
+    static void ring_bell_(std::atomic<std::uint32_t> &waiting,
+                           local_socket &bell) noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) == 0 ||
+            waiting.exchange(0, std::memory_order_relaxed) == 0) {
+            return;
+        }
+        const core::byte b = 1;
+        // 门铃缓冲已满说明对端尚有未取走的门铃，丢弃即可。
+        (void)::send(bell.native_handle(), &b, 1, MSG_DONTWAIT | kSendFlags);
+    }
+
+    asio::awaitable<std::error_code> write_(core::bytes_view src) {
+        while (!src.empty()) {
+            if (!open_) {
+                co_return errno_code(EBADF);
+            }
+            if (peer_gone_ ||
+                tx_.ctl->reader_closed.load(std::memory_order_acquire) != 0) {
+                co_return errno_code(EPIPE);
+            }
+            const auto n = tx_.write(src);
+            if (n == kCorrupt) {
+                co_return core::make_error_code(core::errc::invalid_argument);
+            }
+            if (n > 0) {
+                src = src.subspan(n);
+                ring_bell_(tx_.ctl->reader_waiting, data_bell_);
+                continue;
+            }
+
+            tx_.ctl->writer_waiting.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (tx_.writable() != 0) {
+                tx_.ctl->writer_waiting.store(0, std::memory_order_relaxed);
+                continue;
+            }
+            auto [ec, ignored_n] = co_await space_bell_.async_read_some(
+                asio::buffer(tx_bell_.data(), tx_bell_.size()),
+                asio::as_tuple(asio::use_awaitable));
+            (void)ignored_n;
+            if (ec == asio::error::operation_aborted) {
+                co_return std::error_code{ec};
+            }
+            if (ec) {
+                peer_gone_ = true;
+            }
+            if (open_) {
+                tx_.ctl->writer_waiting.store(0, std::memory_order_relaxed);
+            }
+        }
+        co_return std::error_code{};
+    }
+
+    asio::any_io_executor executor_;
+    std::unique_ptr<Mapping> mapping_;
+    RingView tx_{};
+    RingView rx_{};
+    bool open_{true};
+    bool peer_gone_{false};
+    std::array<core::byte, 64> rx_bell_{};
+    std::array<core::byte, 64> tx_bell_{};
+    local_socket data_bell_;
+    local_socket space_bell_;
+};
+
+// 握手消息：1 字节负载 + SCM_RIGHTS（共享内存 fd、对端的“有空间”门铃 fd）。
+constexpr core::byte kHandshakeByte = 0x53; // 'S'
+
+std::error_code send_fds(int sock, int shm_fd, int bell_fd) noexcept {
+    core::byte payload = kHandshakeByte;
+    iovec iov{&payload, 1};
+    alignas(cmsghdr) std::array<char, CMSG_SPACE(2 * sizeof(int))> control{};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    auto *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+    const int fds[2] = {shm_fd, bell_fd};
+    std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    for (;;) {
+        if (::sendmsg(sock, &msg, kSendFlags) == 1) {
+            return {};
+        }
+        if (errno != EINTR) {
+            return errno_code(errno);
+        }
+    }
+}
+
+// 握手已可读时调用：取出 1 字节负载与两个 fd（失败时关闭已收到的 fd）。
+std::error_code recv_fds(int sock, int &shm_fd, int &bell_fd) noexcept {
+    core::byte payload = 0;
+    iovec iov{&payload, 1};
+    alignas(cmsghdr) std::array<char, CMSG_SPACE(2 * sizeof(int))> control{};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    ssize_t n = 0;
+    do {
+        n = ::recvmsg(sock, &msg, kRecvFdFlags);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        return errno_code(errno);
+    }
+    if (n == 0) {
+        return eof_code();
+    }
+
+    int fds[2] = {-1, -1};
+    std::size_t count = 0;
+    for (auto *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            std::memcpy(fds, CMSG_DATA(cmsg), std::min<std::size_t>(count, 2) * sizeof(int));
+        }
+    }
+    if (payload != kHandshakeByte || count != 2 || (msg.msg_flags & MSG_CTRUNC) != 0) {
+        for (std::size_t i = 0; i < std::min<std::size_t>(count, 2); ++i) {
+            ::close(fds[i]);
+        }
+        return core::make_error_code(core::errc::invalid_argument);
+    }
+    shm_fd = fds[0];
+    bell_fd = fds[1];
+    return {};
+}
+
+int create_shm_fd() noexcept {
+#if defined(__linux__)
+    return ::memfd_create("secs-hsms-shm", MFD_CLOEXEC);
+#else
+    // 其它 POSIX：随机名 shm_open 后立即 unlink，只留 fd。
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "/secs-hsms-%ld-%d-%u",
+                      static_cast<long>(::getpid()), attempt,
+                      static_cast<unsigned>(reinterpret_cast<std::uintptr_t>(name)));
+        const int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            ::shm_unlink(name);
+            return fd;
+        }
+        if (errno != EEXIST) {
+            return -1;
+        }
+    }
+    return -1;
+#endif
+}
+
+std::error_code map_segment(int fd, std::size_t size, std::unique_ptr<Mapping> &out) noexcept {
+    void *base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        return errno_code(errno);
+    }
+    try {
+        out = std::make_unique<Mapping>(base, size);
+    } catch (...) {
+        ::munmap(base, size);
+        return core::make_error_code(core::errc::out_of_memory);
+    }
+    return {};
+}
+
+// 被动端：创建共享内存段与“有空间”门铃 socketpair，交给对端后构造流。
+std::error_code accept_shared_memory(local_socket &socket,
+                                     std::size_t ring_capacity,
+                                     std::unique_ptr<Stream> &out) noexcept {
+    const auto capacity = normalize_capacity(ring_capacity);
+    const auto size = segment_size(capacity);
+
+    const int shm_fd = create_shm_fd();
+    if (shm_fd < 0) {
+        return errno_code(errno);
+    }
+    std::unique_ptr<Mapping> mapping;
+    std::error_code ec;
+    if (::ftruncate(shm_fd, static_cast<off_t>(size)) != 0) {
+        ec = errno_code(errno);
+    } else {
+        ec = map_segment(shm_fd, size, mapping);
+    }
+    if (ec) {
+        ::close(shm_fd);
+        return ec;
+    }
+
+    auto *base = static_cast<core::byte *>(mapping->base);
+    auto *header = new (base) SegmentHeader{};
+    header->capacity = capacity;
+    auto *controls = reinterpret_cast<RingControl *>(base + kControlOffset);
+    new (&controls[0]) RingControl{};
+    new (&controls[1]) RingControl{};
+
+    int pair[2] = {-1, -1};
+    if (::socketpair(AF_UNIX, kSocketPairType, 0, pair) != 0) {
+        ec = errno_code(errno);
+        ::close(shm_fd);
+        return ec;
+    }
+    ec = send_fds(socket.native_handle(), shm_fd, pair[1]);
+    ::close(shm_fd);
+    ::close(pair[1]);
+    if (ec) {
+        ::close(pair[0]);
+        return ec;
+    }
+
+    try {
+        local_socket space_bell(socket.get_executor());
+        std::error_code assign_ec;
+        space_bell.assign(local_protocol{}, pair[0], assign_ec);
+        if (assign_ec) {
+            ::close(pair[0]);
+            return assign_ec;
+        }
+        out = std::make_unique<ShmStream>(std::move(socket),
+                                          std::move(space_bell),
+                                          std::move(mapping),
+                                          static_cast<std::uint64_t>(capacity),
+                                          true);
+    } catch (...) {
+        return core::make_error_code(core::errc::out_of_memory);
+    }
+    return {};
+}
+
+// 主动端：握手消息已可读时调用，映射共享内存并构造流。
+std::error_code connect_shared_memory(local_socket &socket,
+                                      std::unique_ptr<Stream> &out) noexcept {
+    int shm_fd = -1;
+    int bell_fd = -1;
+    if (auto ec = recv_fds(socket.native_handle(), shm_fd, bell_fd); ec) {
+        return ec;
+    }
+
+    std::unique_ptr<Mapping> mapping;
+    std::error_code ec;
+    struct stat st {};
+    if (::fstat(shm_fd, &st) != 0) {
+        ec = errno_code(errno);
+    } else if (static_cast<std::size_t>(st.st_size) < kDataOffset) {
+        ec = core::make_error_code(core::errc::invalid_argument);
+    } else {
+        ec = map_segment(shm_fd, static_cast<std::size_t>(st.st_size), mapping);
+    }
+    ::close(shm_fd);
+    // 段头只读取一次（volatile：不允许编译器之后重新从共享内存加载）：对端仍可改写，
+    // 之后一律使用这里校验过的 capacity。
+    std::uint64_t capacity = 0;
+    if (!ec) {
+        const auto *header = static_cast<const SegmentHeader *>(mapping->base);
+        capacity = *static_cast<const volatile std::uint64_t *>(&header->capacity);
+        if (header->magic != kShmMagic || header->version != kShmVersion ||
+            capacity < kMinRingCapacity || capacity > kMaxRingCapacity ||
+            !std::has_single_bit(capacity) ||
+            segment_size(static_cast<std::size_t>(capacity)) > mapping->size) {
+            ec = core::make_error_code(core::errc::invalid_argument);
+        }
+    }
+    if (ec) {
+        ::close(bell_fd);
+        return ec;
+    }
+
+    try {
+        local_socket space_bell(socket.get_executor());
+        std::error_code assign_ec;
+        space_bell.assign(local_protocol{}, bell_fd, assign_ec);
+        if (assign_ec) {
+            ::close(bell_fd);
+            return assign_ec;
+        }
+        out = std::make_unique<ShmStream>(std::move(socket),
+                                          std::move(space_bell),
+                                          std::move(mapping),
+                                          capacity,
+                                          false);
+    } catch (...) {
+        return core::make_error_code(core::errc::out_of_memory);
+    }
+    return {};
+}
+
+} // namespace
+
+asio::awaitable<std::pair<std::error_code, std::unique_ptr<Stream>>>
+async_connect_local(asio::any_io_executor ex, const LocalEndpoint &endpoint) {
+    if (endpoint.path.empty()) {
+        co_return std::pair{core::make_error_code(core::errc::invalid_argument),
+                            std::unique_ptr<Stream>{}};
+    }
+    const local_protocol::endpoint peer{endpoint.path};
+    const auto transport = endpoint.transport;
+
+    local_socket socket(ex);
+    auto [ec] = co_await socket.async_connect(peer, asio::as_tuple(asio::use_awaitable));
+    if (ec) {
+        co_return std::pair{std::error_code{ec}, std::unique_ptr<Stream>{}};
+    }
+
+    std::unique_ptr<Stream> stream;
+    if (transport == LocalTransport::unix_socket) {
+        stream = std::make_unique<UnixStream>(std::move(socket));
+        co_return std::pair{std::error_code{}, std::move(stream)};
+    }
+
+    // 先窥视握手字节（读操作走 reactor 的预读，不会错过已到达的数据），再 recvmsg 取 fd。
+    core::byte peek = 0;
+    auto [pec, pn] = co_await socket.async_receive(
+        asio::buffer(&peek, 1), asio::socket_base::message_peek,
+        asio::as_tuple(asio::use_awaitable));
+    if (pec) {
+        co_return std::pair{std::error_code{pec}, std::unique_ptr<Stream>{}};
+    }
+    (void)pn;
+    auto hec = connect_shared_memory(socket, stream);
+    co_return std::pair{hec, std::move(stream)};
+}
+
+struct LocalAcceptor::State final {
+    explicit State(asio::any_io_executor ex) : acceptor(ex) {}
+
+    local_protocol::acceptor acceptor;
+    LocalEndpoint endpoint{};
+    bool bound{false};
+};
+
+LocalAcceptor::LocalAcceptor(asio::any_io_executor ex)
+    : executor_(ex), state_(std::make_unique<State>(ex)) {}
+
+LocalAcceptor::~LocalAcceptor() { close(); }
+
+std::error_code LocalAcceptor::listen(const LocalEndpoint &endpoint,
+                                      int backlog) noexcept {
+    try {
+        if (endpoint.path.empty() || state_->acceptor.is_open()) {
+            return core::make_error_code(core::errc::invalid_argument);
+        }
+        const bool abstract = endpoint.path.front() == '\0';
+        if (!abstract) {
+            // 只删除残留的 socket 文件（无人监听），不误删同名普通文件，也不抢占
+            // 另一个仍在监听的进程的地址。
+            struct stat st {};
+            if (::lstat(endpoint.path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+                if (local_socket_in_use(endpoint.path)) {
+                    return std::make_error_code(std::errc::address_in_use);
+                }
+                ::unlink(endpoint.path.c_str());
+            }
+        }
+
+        const local_protocol::endpoint ep{endpoint.path};
+        std::error_code ec;
+        // 先记录地址：bind 成功后 listen 失败时 close() 需要按该路径删除 socket 文件。
+        state_->endpoint = endpoint;
+        state_->acceptor.open(ep.protocol(), ec);
+        if (!ec) {
+            state_->acceptor.bind(ep, ec);
+        }
+        if (!ec) {
+            state_->bound = !abstract;
+            state_->acceptor.listen(backlog, ec);
+        }
+        if (ec) {
+            close();
+            state_->endpoint = LocalEndpoint{};
+            return ec;
+        }
+        return {};
+    } catch (...) {
+        return core::make_error_code(core::errc::out_of_memory);
+    }
+}
+
+bool LocalAcceptor::is_open() const noexcept { return state_->acceptor.is_open(); }
+
+asio::awaitable<std::pair<std::error_code, std::unique_ptr<Stream>>>
+LocalAcceptor::async_accept() {
+    auto &st = *state_;
+    auto [ec, socket] = co_await st.acceptor.async_accept(asio::as_tuple(asio::use_awaitable));
+    if (ec) {
+        co_return std::pair{std::error_code{ec}, std::unique_ptr<Stream>{}};
+    }
+
+    std::unique_ptr<Stream> stream;
+    if (st.endpoint.transport == LocalTransport::unix_socket) {
+        stream = std::make_unique<UnixStream>(std::move(socket));
+        co_return std::pair{std::error_code{}, std::move(stream)};
+    }
+    auto hec = accept_shared_memory(socket, st.endpoint.ring_capacity, stream);
+    co_return std::pair{hec, std::move(stream)};
+}
+
+void LocalAcceptor::close() noexcept {
+    std::error_code ignored;
+    state_->acceptor.close(ignored);
+    if (state_->bound) {
+        ::unlink(state_->endpoint.path.c_str());
+        state_->bound = false;
+    }
+}
+
+#else // _WIN32
+
+asio::awaitable<std::pair<std::error_code, std::unique_ptr<Stream>>>
+async_connect_local(asio::any_io_executor, const LocalEndpoint &) {
+    co_return std::pair{std::make_error_code(std::errc::function_not_supported),
+                        std::unique_ptr<Stream>{}};
+}
+
+struct LocalAcceptor::State final {};
+
+LocalAcceptor::LocalAcceptor(asio::any_io_executor ex) : executor_(std::move(ex)) {}
+
+LocalAcceptor::~LocalAcceptor() = default;
+
+std::error_code LocalAcceptor::listen(const LocalEndpoint &, int) noexcept {
+    return std::make_error_code(std::errc::function_not_supported);
+}
+
+bool LocalAcceptor::is_open() const noexcept { return false; }
+
+asio::awaitable<std::pair<std::error_code, std::unique_ptr<Stream>>>
+LocalAcceptor::async_accept() {
+    co_return std::pair{std::make_error_code(std::errc::function_not_supported),
+                        std::unique_ptr<Stream>{}};
+}
+
+void LocalAcceptor::close() noexcept {}
+
+#endif // _WIN32
+
+} // namespace secs::hsms
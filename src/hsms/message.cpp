@@ -4,6 +4,7 @@
 #include <cstring>
 #include <new>
 #include <stdexcept>
+#include <utility>
 
 namespace secs::hsms {
 namespace {
@@ -151,6 +152,30 @@ Message make_data_message(std::uint16_t session_id,
     return m;
 }
 
+Message make_data_message_shared(std::uint16_t session_id,
+                                 std::uint8_t stream,
+                                 std::uint8_t function,
+                                 bool w_bit,
+                                 std::uint32_t system_bytes,
+                                 core::SharedBytes body) {
+    Message m = make_data_message(
+        session_id, stream, function, w_bit, system_bytes, core::bytes_view{});
+    m.shared_body = std::move(body);
+    return m;
+}
+
+Message make_data_message_streamed(std::uint16_t session_id,
+                                   std::uint8_t stream,
+                                   std::uint8_t function,
+                                   bool w_bit,
+                                   std::uint32_t system_bytes,
+                                   std::shared_ptr<core::BodySource> source) {
+    Message m = make_data_message(
+        session_id, stream, function, w_bit, system_bytes, core::bytes_view{});
+    m.body_source = std::move(source);
+    return m;
+}
+
 std::vector<core::byte> encode_frame(const Message &msg) {
     std::vector<core::byte> out;
     auto ec = encode_frame(msg, out);
@@ -163,26 +188,19 @@ std::vector<core::byte> encode_frame(const Message &msg) {
 std::error_code encode_frame(const Message &msg,
                              std::vector<core::byte> &out) noexcept {
     out.clear();
-
-    if (msg.header.p_type != kPTypeSecs2) {
-        return core::make_error_code(core::errc::invalid_argument);
-    }
-
-    const auto header_size = static_cast<std::size_t>(kHeaderSize);
-    const auto max_payload_size = static_cast<std::size_t>(kMaxPayloadSize);
-    if (max_payload_size < header_size) {
+    if (msg.body_source) {
         return core::make_error_code(core::errc::invalid_argument);
     }
 
-    const std::size_t max_body_size = max_payload_size - header_size;
-    if (msg.body.size() > max_body_size) {
-        return core::make_error_code(core::errc::buffer_overflow);
+    std::array<core::byte, kFramePrefixSize> prefix{};
+    auto ec = encode_frame_prefix(msg, prefix);
+    if (ec) {
+        return ec;
     }
 
-    const auto payload_len = static_cast<std::uint32_t>(header_size +
-                                                        msg.body.size());
+    const auto body = msg.body_view();
     try {
-        out.resize(static_cast<std::size_t>(kLengthFieldSize) + payload_len);
+        out.resize(kFramePrefixSize + body.size());
     } catch (const std::bad_alloc &) {
         return core::make_error_code(core::errc::out_of_memory);
     } catch (const std::length_error &) {
@@ -191,6 +209,35 @@ std::error_code encode_frame(const Message &msg,
         return core::make_error_code(core::errc::invalid_argument);
     }
 
+    std::memcpy(out.data(), prefix.data(), prefix.size());
+    if (!body.empty()) {
+        std::memcpy(out.data() + kFramePrefixSize, body.data(), body.size());
+    }
+
+    return {};
+}
+
+std::error_code encode_frame_prefix(
+    const Message &msg,
+    std::array<core::byte, kFramePrefixSize> &out) noexcept {
+    if (msg.header.p_type != kPTypeSecs2) {
+        return core::make_error_code(core::errc::invalid_argument);
+    }
+
+    const auto header_size = static_cast<std::size_t>(kHeaderSize);
+    const auto max_payload_size = static_cast<std::size_t>(
+        msg.body_source ? kMaxStreamedPayloadSize : kMaxPayloadSize);
+    if (max_payload_size < header_size) {
+        return core::make_error_code(core::errc::invalid_argument);
+    }
+
+    const std::size_t body_size = msg.body_size();
+    const std::size_t max_body_size = max_payload_size - header_size;
+    if (body_size > max_body_size) {
+        return core::make_error_code(core::errc::buffer_overflow);
+    }
+
+    const auto payload_len = static_cast<std::uint32_t>(header_size + body_size);
     write_u32_be(out.data(), payload_len);
 
     auto *h = out.data() + kLengthFieldSize;
@@ -201,10 +248,21 @@ std::error_code encode_frame(const Message &msg,
     h[5] = static_cast<core::byte>(msg.header.s_type);
     write_u32_be(h + 6, msg.header.system_bytes);
 
-    if (!msg.body.empty()) {
-        std::memcpy(h + kHeaderSize, msg.body.data(), msg.body.size());
+    return {};
+}
+
+std::error_code decode_header(core::bytes_view bytes, Header &out) noexcept {
+    if (bytes.size() < kHeaderSize) {
+        return core::make_error_code(core::errc::invalid_argument);
     }
 
+    const auto *p = bytes.data();
+    out.session_id = read_u16_be(p + 0);
+    out.header_byte2 = p[2];
+    out.header_byte3 = p[3];
+    out.p_type = p[4];
+    out.s_type = static_cast<SType>(p[5]);
+    out.system_bytes = read_u32_be(p + 6);
     return {};
 }
 
@@ -217,14 +275,8 @@ std::error_code decode_payload(core::bytes_view payload,
         return core::make_error_code(core::errc::buffer_overflow);
     }
 
-    const auto *p = payload.data();
     Header h;
-    h.session_id = read_u16_be(p + 0);
-    h.header_byte2 = p[2];
-    h.header_byte3 = p[3];
-    h.p_type = p[4];
-    h.s_type = static_cast<SType>(p[5]);
-    h.system_bytes = read_u32_be(p + 6);
+    (void)decode_header(payload, h);
 
     if (h.p_type != kPTypeSecs2) {
         return core::make_error_code(core::errc::invalid_argument);
@@ -276,4 +328,18 @@ std::error_code decode_frame(core::bytes_view frame,
     return {};
 }
 
+std::deque<Message> take_message_batch(std::deque<Message> &queue,
+                                       std::size_t max_n) {
+    std::deque<Message> out;
+    if (max_n == 0 || max_n >= queue.size()) {
+        out.swap(queue);
+        return out;
+    }
+    for (std::size_t i = 0; i < max_n; ++i) {
+        out.push_back(std::move(queue.front()));
+        queue.pop_front();
+    }
+    return out;
+}
+
 } // namespace secs::hsms
@@ -1,17 +1,22 @@
 #include "secs/hsms/session.hpp"
 
 #include "secs/core/error.hpp"
-#include "secs/hsms/timer.hpp"
 
 #include <asio/as_tuple.hpp>
 #include <asio/co_spawn.hpp>
 #include <asio/detached.hpp>
 #include <asio/steady_timer.hpp>
+#include <asio/post.hpp>
 #include <asio/this_coro.hpp>
 #include <asio/use_awaitable.hpp>
 
+#include <asio/io_context.hpp>
+#include <asio/strand.hpp>
+
 #include <algorithm>
+#include <new>
 #include <spdlog/spdlog.h>
+#include <type_traits>
 #include <vector>
 
 namespace secs::hsms {
@@ -22,8 +27,94 @@ constexpr std::uint16_t kHsmsSsControlSessionId = 0xFFFF;
 constexpr std::uint8_t kRspOk = 0;
 constexpr std::uint8_t kRspReject = 1;
 
+// 会话绑定的 strand：传入的执行器已是 strand 时直接复用（多个组件可共享同一 strand），
+// 否则在其上新建一个。
+asio::any_io_executor bind_strand(const asio::any_io_executor &ex) {
+    if (ex.target<asio::strand<asio::any_io_executor>>() != nullptr ||
+        ex.target<asio::strand<asio::io_context::executor_type>>() != nullptr) {
+        return ex;
+    }
+    return asio::make_strand(ex);
+}
+
+// 当前线程是否正在执行 ex（bind_strand 的结果）上的处理器。
+bool running_on_strand(const asio::any_io_executor &ex) noexcept {
+    if (const auto *s = ex.target<asio::strand<asio::any_io_executor>>()) {
+        return s->running_in_this_thread();
+    }
+    if (const auto *s = ex.target<asio::strand<asio::io_context::executor_type>>()) {
+        return s->running_in_this_thread();
+    }
+    return false;
+}
+
+std::error_code failed_as(std::error_code ec, std::type_identity<std::error_code>) {
+    return ec;
+}
+
+template <class V>
+std::pair<std::error_code, V>
+failed_as(std::error_code ec, std::type_identity<std::pair<std::error_code, V>>) {
+    return std::pair{ec, V{}};
+}
+
+// 调用方不在会话 strand 上时：把 op 派生到 strand 上执行并等待完成（完成后回到
+// 调用方执行器）。派生失败不抛异常，按 API 的返回形态给出错误码。
+template <class T>
+asio::awaitable<T> run_on_strand(const asio::any_io_executor &strand,
+                                 asio::awaitable<T> op) {
+    try {
+        co_return co_await asio::co_spawn(strand, std::move(op), asio::use_awaitable);
+    } catch (const std::bad_alloc &) {
+        co_return failed_as(core::make_error_code(core::errc::out_of_memory),
+                            std::type_identity<T>{});
+    } catch (...) {
+        co_return failed_as(core::make_error_code(core::errc::invalid_argument),
+                            std::type_identity<T>{});
+    }
+}
+
 } // namespace
 
+struct Session::Metrics final {
+    explicit Metrics(std::shared_ptr<core::metrics::Group> g)
+        : group(std::move(g)),
+          control_transactions(group->counter("secs_hsms_transactions_total",
+                                              "HSMS transactions started.",
+                                              {{"kind", "control"}})),
+          data_transactions(group->counter("secs_hsms_transactions_total",
+                                           "HSMS transactions started.",
+                                           {{"kind", "data"}})),
+          control_timeouts(group->counter("secs_hsms_transaction_timeouts_total",
+                                          "HSMS transactions timed out (T6/T3).",
+                                          {{"kind", "control"}})),
+          data_timeouts(group->counter("secs_hsms_transaction_timeouts_total",
+                                       "HSMS transactions timed out (T6/T3).",
+                                       {{"kind", "data"}})),
+          selects(group->counter("secs_hsms_selected_total",
+                                 "Transitions into SELECTED state.")),
+          disconnects(group->counter("secs_hsms_disconnects_total",
+                                     "HSMS disconnects.")),
+          t3_rtt(group->histogram("secs_hsms_t3_rtt_seconds",
+                                  "Data transaction round-trip time (send to reply).",
+                                  {},
+                                  core::metrics::kNanosecondsToSeconds)),
+          control_rtt(group->histogram("secs_hsms_control_rtt_seconds",
+                                       "Control transaction round-trip time.",
+                                       {},
+                                       core::metrics::kNanosecondsToSeconds)) {}
+
+    std::shared_ptr<core::metrics::Group> group;
+    core::metrics::Counter &control_transactions;
+    core::metrics::Counter &data_transactions;
+    core::metrics::Counter &control_timeouts;
+    core::metrics::Counter &data_timeouts;
+    core::metrics::Counter &selects;
+    core::metrics::Counter &disconnects;
+    core::metrics::Histogram &t3_rtt;
+    core::metrics::Histogram &control_rtt;
+};
+
 /*
  * HSMS::Session 的协程并发模型（便于理解“为什么要有
  * pending_/Event/reader_loop_”）：
@@ -53,11 +144,22 @@ constexpr std::uint8_t kRspReject = 1;
 // 置为已完成（避免等待方无意义阻塞）。 该事件会在 start_reader_() 时
 // reset，并在 reader_loop_ 退出时 set。
 Session::Session(asio::any_io_executor ex, SessionOptions options)
-    : executor_(ex), options_(options),
-      connection_(ex, ConnectionOptions{.t8 = options.t8}) {
+    : executor_(bind_strand(ex)), options_(options),
+      metrics_(options.metrics ? std::make_shared<Metrics>(options.metrics)
+                               : nullptr),
+      connection_(executor_, connection_options_()),
+      pending_(options.max_pending_requests),
+      stop_guard_(std::make_shared<StopGuard>()) {
+    stop_guard_->self = this;
     reader_stopped_event_.set();
 }
 
+Session::~Session() {
+    // 等待正在执行的 stop() 投递回调结束，之后的回调不再访问本对象。
+    std::lock_guard lk(stop_guard_->mu);
+    stop_guard_->self = nullptr;
+}
+
 void Session::reset_state_() noexcept {
     state_ = SessionState::connected;
     connection_.disable_data_writes(core::make_error_code(core::errc::cancelled));
@@ -67,7 +169,9 @@ void Session::reset_state_() noexcept {
     disconnected_event_.reset();
 
     inbound_data_.clear();
-    pending_.clear();
+    // 仍在等待的事务由发起方自行 release；这里只摘出索引，避免旧连接的
+    // 响应被新连接匹配。
+    pending_.unlink_if([](std::uint32_t, Pending &) noexcept { return true; });
 }
 
 void Session::set_selected_() noexcept {
@@ -76,6 +180,9 @@ void Session::set_selected_() noexcept {
     }
     state_ = SessionState::selected;
     connection_.enable_data_writes();
+    if (metrics_) {
+        metrics_->selects.add();
+    }
     const auto gen = selected_generation_.fetch_add(1U) + 1U;
     selected_event_.set();
     SPDLOG_DEBUG("hsms selected: generation={}", gen);
@@ -117,6 +224,9 @@ void Session::set_not_selected_() noexcept {
 
 void Session::on_disconnected_(std::error_code reason) noexcept {
     SPDLOG_DEBUG("hsms disconnected: ec={}({})", reason.value(), reason.message());
+    if (metrics_ && state_ != SessionState::disconnected) {
+        metrics_->disconnects.add();
+    }
     state_ = SessionState::disconnected;
     connection_.disable_data_writes(reason);
 
@@ -128,11 +238,11 @@ void Session::on_disconnected_(std::error_code reason) noexcept {
     reader_running_ = false;
     disconnected_event_.set();
 
-    for (auto &[_, pending] : pending_) {
-        pending->ec = reason;
-        pending->ready.cancel();
-    }
-    pending_.clear();
+    pending_.unlink_if([reason](std::uint32_t, Pending &pending) noexcept {
+        pending.ec = reason;
+        pending.ready.cancel();
+        return true;
+    });
     inbound_data_.clear();
 }
 
@@ -156,22 +266,9 @@ void Session::emit_control_event_(ControlDirection direction,
 
     if (msg.header.s_type == SType::reject_req &&
         msg.body.size() == static_cast<std::size_t>(kHeaderSize)) {
-        const auto *p = msg.body.data();
-        Header h{};
-        h.session_id = static_cast<std::uint16_t>(
-            (static_cast<std::uint16_t>(p[0]) << 8U) |
-            static_cast<std::uint16_t>(p[1]));
-        h.header_byte2 = p[2];
-        h.header_byte3 = p[3];
-        h.p_type = p[4];
-        h.s_type = static_cast<SType>(p[5]);
-        h.system_bytes = (static_cast<std::uint32_t>(p[6]) << 24U) |
-                         (static_cast<std::uint32_t>(p[7]) << 16U) |
-                         (static_cast<std::uint32_t>(p[8]) << 8U) |
-                         static_cast<std::uint32_t>(p[9]);
-
-        ev.has_rejected_header = true;
-        ev.rejected_header = h;
+        ev.has_rejected_header =
+            !decode_header(core::bytes_view{msg.body.data(), msg.body.size()},
+                           ev.rejected_header);
     }
 
     try {
@@ -182,7 +279,39 @@ void Session::emit_control_event_(ControlDirection direction,
 }
 
 void Session::stop() noexcept {
+    // 标志立即可见（之后的 open_*/重连循环直接返回 cancelled）。
+    stop_requested_ = true;
+    if (running_on_strand(executor_)) {
+        stop_on_strand_();
+        return;
+    }
+    // 不在 strand 上：断线通知投递到 strand（持有 StopGuard 而不是 this，Session
+    // 先析构时回调什么也不做）；先投递再同步关闭连接，保证通知排在读协程的错误完成
+    // 之前，挂起事务以 cancelled 结束。io_context 不再运行时连接照样被关闭。
+    try {
+        asio::post(executor_, [guard = stop_guard_]() noexcept {
+            std::lock_guard lk(guard->mu);
+            if (guard->self) {
+                guard->self->stop_on_strand_();
+            }
+        });
+    } catch (...) {
+        // best-effort：投递失败时由读协程在 strand 上完成断线通知。
+    }
+    connection_.cancel_and_close();
+}
+
+asio::awaitable<std::error_code> Session::async_stop() {
+    if ((co_await asio::this_coro::executor) != executor_) {
+        co_return co_await run_on_strand(executor_, async_stop());
+    }
     stop_requested_ = true;
+    stop_on_strand_();
+    co_return std::error_code{};
+}
+
+void Session::stop_on_strand_() noexcept {
+    stop_event_.set();
     connection_.cancel_and_close();
 
     SPDLOG_DEBUG("hsms stop requested");
@@ -419,17 +548,18 @@ asio::awaitable<void> Session::linktest_loop_(std::uint64_t generation) {
 
 asio::awaitable<std::error_code>
 Session::async_wait_reader_stopped(std::optional<core::duration> timeout) {
+    if ((co_await asio::this_coro::executor) != executor_) {
+        co_return co_await run_on_strand(executor_, async_wait_reader_stopped(timeout));
+    }
     co_return co_await reader_stopped_event_.async_wait(timeout);
 }
 
 bool Session::fulfill_pending_(Message &msg) noexcept {
-    const auto it = pending_.find(msg.header.system_bytes);
-    if (it == pending_.end()) {
+    auto *pending = pending_.find(msg.header.system_bytes);
+    if (pending == nullptr) {
         return false;
     }
 
-    const auto &pending = it->second;
-
     if (pending->expected_stype != msg.header.s_type) {
         return false;
     }
@@ -441,21 +571,36 @@ bool Session::fulfill_pending_(Message &msg) noexcept {
 }
 
 void Session::cancel_pending_data_(std::error_code reason) noexcept {
-    std::vector<std::uint32_t> to_erase;
-    to_erase.reserve(pending_.size());
-
-    for (const auto &[sb, pending] : pending_) {
-        if (pending->expected_stype != SType::data) {
-            continue;
+    pending_.unlink_if([reason](std::uint32_t, Pending &pending) noexcept {
+        if (pending.expected_stype != SType::data) {
+            return false;
         }
-        pending->ec = reason;
-        pending->ready.cancel();
-        to_erase.push_back(sb);
-    }
+        pending.ec = reason;
+        pending.ready.cancel();
+        return true;
+    });
+}
 
-    for (const auto sb : to_erase) {
-        pending_.erase(sb);
+std::pair<std::error_code, Message>
+Session::finish_pending_(PendingHandle handle, std::error_code wait_ec) noexcept {
+    // 条目只由发起方 release，因此这里 handle 一定有效；防御性判空。
+    auto *pending = pending_.get(handle);
+    std::pair<std::error_code, Message> result{wait_ec, Message{}};
+    if (pending == nullptr) {
+        result.first = core::make_error_code(core::errc::invalid_argument);
+    } else if (wait_ec == core::make_error_code(core::errc::timeout)) {
+        // 超时（T3/T6）：只返回 timeout，不在此处强制断线。
+    } else if (wait_ec) {
+        result.first = pending->ec ? pending->ec : wait_ec;
+    } else if (pending->ec) {
+        result.first = pending->ec;
+    } else if (!pending->response.has_value()) {
+        result.first = core::make_error_code(core::errc::invalid_argument);
+    } else {
+        result.second = std::move(*pending->response);
     }
+    pending_.release(handle);
+    return result;
 }
 
 asio::awaitable<std::pair<std::error_code, Message>>
@@ -463,106 +608,125 @@ Session::async_control_transaction_(const Message &req,
                                     SType expected_rsp,
                                     core::duration timeout) {
     // 控制事务：把请求登记到 pending_，由 reader_loop_ 收到响应后唤醒。
-    const auto max_pending =
-        options_.max_pending_requests == 0 ? std::size_t{1}
-                                           : options_.max_pending_requests;
-    if (pending_.size() >= max_pending) {
-        co_return std::pair{core::make_error_code(core::errc::buffer_overflow),
-                            Message{}};
-    }
-
-    const auto sb = req.header.system_bytes;
-    auto pending = std::make_shared<Pending>(expected_rsp);
-    pending_.insert_or_assign(sb, pending);
-
-    auto ec = co_await connection_.async_write_message(req);
+    // pending_ 已满（max_pending_requests）时 emplace 返回 buffer_overflow。
+    PendingHandle handle{};
+    auto ec = pending_.emplace(req.header.system_bytes, handle, expected_rsp);
     if (ec) {
-        pending_.erase(sb);
         co_return std::pair{ec, Message{}};
     }
-    emit_control_event_(ControlDirection::tx, req);
 
-    ec = co_await pending->ready.async_wait(timeout);
-    if (ec == core::make_error_code(core::errc::timeout)) {
-        // 控制事务超时（T6）：只返回 timeout，不在此处强制断线。
-        //
-        // 说明：
-        // - SELECT 等握手失败是否“立即断线”属于更高层的策略（见 async_open_*）。
-        // - LINKTEST 周期心跳通常需要“连续失败阈值”，因此也不能在这里一刀切断线。
-        pending_.erase(sb);
-        co_return std::pair{ec, Message{}};
+    const auto started = core::steady_clock::now();
+    if (metrics_) {
+        metrics_->control_transactions.add();
     }
-
-    pending_.erase(sb);
+    ec = co_await connection_.async_write_message(req);
     if (ec) {
-        co_return std::pair{pending->ec ? pending->ec : ec, Message{}};
-    }
-    if (pending->ec) {
-        co_return std::pair{pending->ec, Message{}};
-    }
-    if (!pending->response.has_value()) {
-        co_return std::pair{core::make_error_code(core::errc::invalid_argument),
-                            Message{}};
+        pending_.release(handle);
+        co_return std::pair{ec, Message{}};
     }
+    emit_control_event_(ControlDirection::tx, req);
 
-    co_return std::pair{std::error_code{}, *pending->response};
+    // 说明：
+    // - SELECT 等握手失败是否“立即断线”属于更高层的策略（见 async_open_*）。
+    // - LINKTEST 周期心跳通常需要“连续失败阈值”，因此超时也不能在这里一刀切断线。
+    ec = co_await pending_.get(handle)->ready.async_wait(timeout);
+    auto result = finish_pending_(handle, ec);
+    if (metrics_) {
+        if (!result.first) {
+            metrics_->control_rtt.record_duration(core::steady_clock::now() - started);
+        } else if (result.first == core::make_error_code(core::errc::timeout)) {
+            metrics_->control_timeouts.add();
+        }
+    }
+    co_return result;
 }
 
 asio::awaitable<std::pair<std::error_code, Message>>
 Session::async_data_transaction_(const Message &req, core::duration timeout) {
     // 数据事务（W=1）：同样用 pending_ 做请求-响应匹配；按 HSMS-SS 语义，
     // T3 超时只取消事务，不强制断线。
-    const auto max_pending =
-        options_.max_pending_requests == 0 ? std::size_t{1}
-                                           : options_.max_pending_requests;
-    if (pending_.size() >= max_pending) {
-        co_return std::pair{core::make_error_code(core::errc::buffer_overflow),
-                            Message{}};
-    }
-
-    const auto sb = req.header.system_bytes;
-    auto pending = std::make_shared<Pending>(SType::data);
-    pending_.insert_or_assign(sb, pending);
-
-    auto ec = co_await connection_.async_write_message(req);
+    PendingHandle handle{};
+    auto ec = pending_.emplace(req.header.system_bytes, handle, SType::data);
     if (ec) {
-        pending_.erase(sb);
         co_return std::pair{ec, Message{}};
     }
 
-    ec = co_await pending->ready.async_wait(timeout);
-    if (ec == core::make_error_code(core::errc::timeout)) {
-        pending_.erase(sb);
+    const auto started = core::steady_clock::now();
+    if (metrics_) {
+        metrics_->data_transactions.add();
+    }
+    ec = co_await connection_.async_write_message(req);
+    if (ec) {
+        pending_.release(handle);
         co_return std::pair{ec, Message{}};
     }
 
-    pending_.erase(sb);
-    if (ec) {
-        co_return std::pair{pending->ec ? pending->ec : ec, Message{}};
+    ec = co_await pending_.get(handle)->ready.async_wait(timeout);
+    auto result = finish_pending_(handle, ec);
+    if (metrics_) {
+        if (!result.first) {
+            metrics_->t3_rtt.record_duration(core::steady_clock::now() - started);
+        } else if (result.first == core::make_error_code(core::errc::timeout)) {
+            metrics_->data_timeouts.add();
+        }
     }
-    if (pending->ec) {
-        co_return std::pair{pending->ec, Message{}};
+    co_return result;
+}
+
+asio::awaitable<std::error_code>
+Session::async_open_active(const asio::ip::tcp::endpoint &endpoint) {
+    if ((co_await asio::this_coro::executor) != executor_) {
+        co_return co_await run_on_strand(executor_, async_open_active(endpoint));
     }
-    if (!pending->response.has_value()) {
-        co_return std::pair{core::make_error_code(core::errc::invalid_argument),
-                            Message{}};
+    SPDLOG_DEBUG("hsms open_active: port={} session_id={}",
+                 endpoint.port(),
+                 options_.session_id);
+
+    co_return co_await async_open_active_with_(
+        [&endpoint](Connection &conn) -> asio::awaitable<std::error_code> {
+            co_return co_await conn.async_connect(endpoint);
+        });
+}
+
+asio::awaitable<std::error_code>
+Session::async_open_active(const LocalEndpoint &endpoint) {
+    if ((co_await asio::this_coro::executor) != executor_) {
+        co_return co_await run_on_strand(executor_, async_open_active(endpoint));
     }
+    SPDLOG_DEBUG("hsms open_active(local): transport={} session_id={}",
+                 static_cast<int>(endpoint.transport),
+                 options_.session_id);
+
+    co_return co_await async_open_active_with_(
+        [this, &endpoint](Connection &conn) -> asio::awaitable<std::error_code> {
+            auto [ec, stream] = co_await async_connect_local(executor_, endpoint);
+            if (ec) {
+                co_return ec;
+            }
+            conn = Connection(std::move(stream), connection_options_());
+            co_return std::error_code{};
+        });
+}
 
-    co_return std::pair{std::error_code{}, *pending->response};
+ConnectionOptions Session::connection_options_() const {
+    return ConnectionOptions{.t8 = options_.t8,
+                             .metrics = options_.metrics,
+                             .capture = options_.capture,
+                             .backend = options_.stream_backend,
+                             .data_priorities = options_.data_priorities,
+                             .body_sinks = options_.body_sinks,
+                             .memory_budget = options_.memory_budget,
+                             .memory_wait = options_.memory_wait};
 }
 
 asio::awaitable<std::error_code>
-Session::async_open_active(const asio::ip::tcp::endpoint &endpoint) {
+Session::async_open_active_with_(const ConnectFn &connect) {
     if (stop_requested_) {
         co_return core::make_error_code(core::errc::cancelled);
     }
 
-    SPDLOG_DEBUG("hsms open_active: port={} session_id={}",
-                 endpoint.port(),
-                 options_.session_id);
-
-    Connection conn(executor_, ConnectionOptions{.t8 = options_.t8});
-    auto ec = co_await conn.async_connect(endpoint);
+    Connection conn(executor_, connection_options_());
+    auto ec = co_await connect(conn);
     if (ec) {
         on_disconnected_(ec);
         co_return ec;
@@ -573,6 +737,10 @@ Session::async_open_active(const asio::ip::tcp::endpoint &endpoint) {
 
 asio::awaitable<std::error_code>
 Session::async_open_active(Connection &&connection) {
+    if ((co_await asio::this_coro::executor) != executor_) {
+        co_return co_await run_on_strand(
+            executor_, async_open_active(std::move(connection)));
+    }
     if (stop_requested_) {
         co_return core::make_error_code(core::errc::cancelled);
     }
@@ -585,8 +753,26 @@ Session::async_open_active(Connection &&connection) {
         (void)co_await connection_.async_close();
         (void)co_await disconnected_event_.async_wait(options_.t6);
     }
+    // 旧连接即使 reader 已退出（例如对端 SEPARATE），其 writer 协程仍可能引用
+    // connection_；先关闭并等它退出，再移动赋值。
+    (void)co_await connection_.async_close();
 
     connection_ = std::move(connection);
+    if (options_.metrics) {
+        connection_.set_metrics(options_.metrics);
+    }
+    if (options_.capture) {
+        connection_.set_capture(options_.capture);
+    }
+    if (!options_.data_priorities.empty()) {
+        connection_.set_data_priorities(options_.data_priorities);
+    }
+    if (!options_.body_sinks.empty()) {
+        connection_.set_body_sinks(options_.body_sinks);
+    }
+    if (options_.memory_budget) {
+        connection_.set_memory_budget(options_.memory_budget, options_.memory_wait);
+    }
     reset_state_();
 
     start_reader_();
@@ -614,18 +800,45 @@ Session::async_open_active(Connection &&connection) {
 
 asio::awaitable<std::error_code>
 Session::async_open_passive(asio::ip::tcp::socket socket) {
+    if ((co_await asio::this_coro::executor) != executor_) {
+        co_return co_await run_on_strand(
+            executor_, async_open_passive(std::move(socket)));
+    }
     if (stop_requested_) {
         co_return core::make_error_code(core::errc::cancelled);
     }
 
     SPDLOG_DEBUG("hsms open_passive(socket): session_id={}", options_.session_id);
 
-    Connection conn(std::move(socket), ConnectionOptions{.t8 = options_.t8});
+    Connection conn(std::move(socket), connection_options_());
+    co_return co_await async_open_passive(std::move(conn));
+}
+
+asio::awaitable<std::error_code>
+Session::async_open_passive(std::unique_ptr<Stream> stream) {
+    if ((co_await asio::this_coro::executor) != executor_) {
+        co_return co_await run_on_strand(
+            executor_, async_open_passive(std::move(stream)));
+    }
+    if (stop_requested_) {
+        co_return core::make_error_code(core::errc::cancelled);
+    }
+    if (!stream) {
+        co_return core::make_error_code(core::errc::invalid_argument);
+    }
+
+    SPDLOG_DEBUG("hsms open_passive(stream): session_id={}", options_.session_id);
+
+    Connection conn(std::move(stream), connection_options_());
     co_return co_await async_open_passive(std::move(conn));
 }
 
 asio::awaitable<std::error_code>
 Session::async_open_passive(Connection &&connection) {
+    if ((co_await asio::this_coro::executor) != executor_) {
+        co_return co_await run_on_strand(
+            executor_, async_open_passive(std::move(connection)));
+    }
     if (stop_requested_) {
         co_return core::make_error_code(core::errc::cancelled);
     }
@@ -637,8 +850,26 @@ Session::async_open_passive(Connection &&connection) {
         (void)co_await connection_.async_close();
         (void)co_await disconnected_event_.async_wait(options_.t6);
     }
+    // 旧连接即使 reader 已退出（例如对端 SEPARATE），其 writer 协程仍可能引用
+    // connection_；先关闭并等它退出，再移动赋值。
+    (void)co_await connection_.async_close();
 
     connection_ = std::move(connection);
+    if (options_.metrics) {
+        connection_.set_metrics(options_.metrics);
+    }
+    if (options_.capture) {
+        connection_.set_capture(options_.capture);
+    }
+    if (!options_.data_priorities.empty()) {
+        connection_.set_data_priorities(options_.data_priorities);
+    }
+    if (!options_.body_sinks.empty()) {
+        connection_.set_body_sinks(options_.body_sinks);
+    }
+    if (options_.memory_budget) {
+        connection_.set_memory_budget(options_.memory_budget, options_.memory_wait);
+    }
     reset_state_();
     start_reader_();
 
@@ -655,31 +886,91 @@ Session::async_open_passive(Connection &&connection) {
 
 asio::awaitable<std::error_code>
 Session::async_run_active(const asio::ip::tcp::endpoint &endpoint) {
+    co_return co_await async_run_active(
+        [endpoint](Connection &conn) -> asio::awaitable<std::error_code> {
+            co_return co_await conn.async_connect(endpoint);
+        });
+}
+
+asio::awaitable<std::error_code>
+Session::async_run_active(const LocalEndpoint &endpoint) {
+    co_return co_await async_run_active(
+        [this, endpoint](Connection &conn) -> asio::awaitable<std::error_code> {
+            auto [ec, stream] = co_await async_connect_local(executor_, endpoint);
+            if (ec) {
+                co_return ec;
+            }
+            conn = Connection(std::move(stream), connection_options_());
+            co_return std::error_code{};
+        });
+}
+
+asio::awaitable<std::error_code> Session::async_run_active(ConnectFn connect) {
+    if ((co_await asio::this_coro::executor) != executor_) {
+        co_return co_await run_on_strand(
+            executor_, async_run_active(std::move(connect)));
+    }
+    // failures：连续失败次数（断线后首次重连记为 1），用于 governor 指数退避。
+    std::uint32_t failures = 0;
     while (!stop_requested_) {
-        auto ec = co_await async_open_active(endpoint);
+        if (options_.governor) {
+            // 进程级限速：一次“连接 + SELECT”消耗一个令牌。
+            if (co_await async_sleep_(options_.governor->reserve())) {
+                break;
+            }
+        }
+
+        auto ec = co_await async_open_active_with_(connect);
         if (ec) {
             if (!options_.auto_reconnect || stop_requested_) {
                 co_return ec;
             }
-            // 连接失败：按 T5 退避后重试。
-            Timer timer(executor_);
-            (void)co_await timer.async_wait_for(options_.t5);
+            // 连接失败：按 T5（或 governor 退避）后重试。
+            if (co_await async_sleep_(reconnect_delay_(++failures))) {
+                break;
+            }
             continue;
         }
 
-        // 等待断线，然后按 T5 退避后重连。
+        // 等待断线，然后按 T5（或 governor 退避）后重连。
+        failures = 0;
         (void)co_await disconnected_event_.async_wait(std::nullopt);
         if (!options_.auto_reconnect || stop_requested_) {
             co_return std::error_code{};
         }
-
-        Timer timer(executor_);
-        (void)co_await timer.async_wait_for(options_.t5);
+        if (co_await async_sleep_(reconnect_delay_(++failures))) {
+            break;
+        }
     }
     co_return std::error_code{};
 }
 
+core::duration Session::reconnect_delay_(std::uint32_t failures) noexcept {
+    if (!options_.governor) {
+        return options_.t5;
+    }
+    return options_.governor->backoff(options_.t5, failures);
+}
+
+asio::awaitable<std::error_code> Session::async_sleep_(core::duration d) {
+    if (stop_requested_) {
+        co_return core::make_error_code(core::errc::cancelled);
+    }
+    if (d <= core::duration{}) {
+        co_return std::error_code{};
+    }
+    // stop_event_ 只在 stop() 时置位：超时即“睡够了”，被唤醒即被 stop 打断。
+    const auto ec = co_await stop_event_.async_wait(d);
+    if (ec == core::make_error_code(core::errc::timeout)) {
+        co_return std::error_code{};
+    }
+    co_return ec ? ec : core::make_error_code(core::errc::cancelled);
+}
+
 asio::awaitable<std::error_code> Session::async_send(const Message &msg) {
+    if ((co_await asio::this_coro::executor) != executor_) {
+        co_return co_await run_on_strand(executor_, async_send(msg));
+    }
     if (!connection_.is_open()) {
         co_return core::make_error_code(core::errc::invalid_argument);
     }
@@ -693,7 +984,7 @@ asio::awaitable<std::error_code> Session::async_send(const Message &msg) {
                      static_cast<int>(msg.function()),
                      msg.w_bit() ? 1 : 0,
                      msg.header.system_bytes,
-                     msg.body.size());
+                     msg.body_size());
     } else {
         SPDLOG_DEBUG("hsms send control: stype={} sb={}",
                      static_cast<int>(msg.header.s_type),
@@ -709,6 +1000,9 @@ asio::awaitable<std::error_code> Session::async_send(const Message &msg) {
 
 asio::awaitable<std::pair<std::error_code, Message>>
 Session::async_receive_data(std::optional<core::duration> timeout) {
+    if ((co_await asio::this_coro::executor) != executor_) {
+        co_return co_await run_on_strand(executor_, async_receive_data(timeout));
+    }
     while (inbound_data_.empty()) {
         auto ec = co_await inbound_event_.async_wait(timeout);
         if (ec) {
@@ -724,6 +1018,27 @@ Session::async_receive_data(std::optional<core::duration> timeout) {
     co_return std::pair{std::error_code{}, std::move(msg)};
 }
 
+asio::awaitable<std::pair<std::error_code, std::deque<Message>>>
+Session::async_receive_data_batch(std::size_t max_n,
+                                  std::optional<core::duration> timeout) {
+    if ((co_await asio::this_coro::executor) != executor_) {
+        co_return co_await run_on_strand(
+            executor_, async_receive_data_batch(max_n, timeout));
+    }
+    while (inbound_data_.empty()) {
+        auto ec = co_await inbound_event_.async_wait(timeout);
+        if (ec) {
+            co_return std::pair{ec, std::deque<Message>{}};
+        }
+    }
+
+    auto batch = take_message_batch(inbound_data_, max_n);
+    if (inbound_data_.empty()) {
+        inbound_event_.reset();
+    }
+    co_return std::pair{std::error_code{}, std::move(batch)};
+}
+
 asio::awaitable<std::pair<std::error_code, Message>>
 Session::async_request_data(std::uint8_t stream,
                             std::uint8_t function,
@@ -736,6 +1051,10 @@ Session::async_request_data(std::uint8_t stream,
                             std::uint8_t function,
                             core::bytes_view body,
                             std::optional<core::duration> timeout) {
+    if ((co_await asio::this_coro::executor) != executor_) {
+        co_return co_await run_on_strand(
+            executor_, async_request_data(stream, function, body, timeout));
+    }
     if (state_ != SessionState::selected) {
         co_return std::pair{core::make_error_code(core::errc::invalid_argument),
                             Message{}};
@@ -754,6 +1073,9 @@ Session::async_request_data(std::uint8_t stream,
 }
 
 asio::awaitable<std::error_code> Session::async_linktest() {
+    if ((co_await asio::this_coro::executor) != executor_) {
+        co_return co_await run_on_strand(executor_, async_linktest());
+    }
     if (state_ != SessionState::selected) {
         co_return core::make_error_code(core::errc::invalid_argument);
     }
@@ -774,6 +1096,10 @@ asio::awaitable<std::error_code> Session::async_linktest() {
 asio::awaitable<std::error_code>
 Session::async_wait_selected(std::uint64_t min_generation,
                              core::duration timeout) {
+    if ((co_await asio::this_coro::executor) != executor_) {
+        co_return co_await run_on_strand(
+            executor_, async_wait_selected(min_generation, timeout));
+    }
     const auto deadline = core::steady_clock::now() + timeout;
     while (!stop_requested_) {
         if (state_ == SessionState::selected &&
@@ -1,5 +1,7 @@
 #include "secs/ii/codec.hpp"
 
+#include "secs/core/memory_budget.hpp"
+
 #include <algorithm>
 #include <bit>
 #include <cstddef>
@@ -9,6 +11,7 @@
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <type_traits>
 
 namespace secs::ii {
@@ -28,9 +31,10 @@ namespace {
  *   - 有符号整数：转为等宽无符号后写出（保留补码位级形态）
  *   - 浮点：std::bit_cast 得到 IEEE754 的位级形态后写出
  *
- * - 本实现提供两类 API：
+ * - 本实现提供三类 API：
  *   - encode()/encode_to()：编码
  *   - decode_one()：从输入缓冲区解析一个 Item（流式），并返回 consumed 字节数
+ *   - visit_encoded()：事件式遍历（不构造 Item），与 decode_one 共用头部解析与限制
  *
  * 备注：
  * - 由于 List 支持递归嵌套，decode
@@ -112,6 +116,8 @@ constexpr std::uint8_t make_format_byte(format_code code,
 struct DecodeBudget final {
     std::size_t total_items{0};
     std::size_t total_bytes{0};
+    // 进程级内存预算（可选，仅 decode_one）：节点与 payload 在构造前预约。
+    core::MemoryReservation *reservation{nullptr};
 };
 
 class SpanWriter final {
@@ -666,6 +672,104 @@ std::optional<format_code> format_code_from_bits(std::uint8_t bits) noexcept {
     }
 }
 
+// 读取 FormatByte + Length 并做基础合法性校验（decode_item/visit_item 共用）。
+std::error_code read_item_header(SpanReader &r,
+                                 format_code &out_fmt,
+                                 std::uint32_t &out_length) noexcept {
+    byte format_byte = 0;
+    auto ec = r.read_u8(format_byte);
+    if (ec) {
+        return ec;
+    }
+
+    const auto length_bytes =
+        static_cast<std::uint8_t>(format_byte & 0x03u);
+    if (length_bytes == 0 || length_bytes > 3) {
+        return make_error_code(errc::invalid_header);
+    }
+
+    std::uint32_t length = 0;
+    ec = r.read_be_u32(length_bytes, length);
+    if (ec) {
+        return ec;
+    }
+    if (length > kMaxLength) {
+        return make_error_code(errc::length_overflow);
+    }
+
+    const auto fmt_bits = static_cast<std::uint8_t>(format_byte >> 2);
+    const auto fmt = format_code_from_bits(fmt_bits);
+    if (!fmt) {
+        return make_error_code(errc::invalid_format);
+    }
+
+    out_fmt = *fmt;
+    out_length = length;
+    return {};
+}
+
+std::error_code check_list_budget(std::uint32_t length,
+                                  const DecodeBudget &budget,
+                                  const DecodeLimits &limits) noexcept {
+    if (length > limits.max_list_items) {
+        return make_error_code(errc::list_too_large);
+    }
+    const std::size_t want = static_cast<std::size_t>(budget.total_items) +
+                             static_cast<std::size_t>(length);
+    if (want > limits.max_total_items) {
+        return make_error_code(errc::total_budget_exceeded);
+    }
+    return {};
+}
+
+// 先按限制检查 payload 长度，再从输入中切出 payload（不拷贝）。
+std::error_code read_leaf_payload(SpanReader &r,
+                                  std::uint32_t length,
+                                  DecodeBudget &budget,
+                                  const DecodeLimits &limits,
+                                  bytes_view &out) noexcept {
+    if (length > limits.max_payload_bytes) {
+        return make_error_code(errc::payload_too_large);
+    }
+    std::size_t next_total_bytes = 0;
+    if (!checked_add(budget.total_bytes,
+                     static_cast<std::size_t>(length),
+                     next_total_bytes)) {
+        return make_error_code(errc::total_budget_exceeded);
+    }
+    if (next_total_bytes > limits.max_total_bytes) {
+        return make_error_code(errc::total_budget_exceeded);
+    }
+
+    auto ec = r.read_payload(length, out);
+    if (ec) {
+        return ec;
+    }
+    if (budget.reservation && !budget.reservation->try_grow(length)) {
+        return make_error_code(errc::out_of_memory);
+    }
+    budget.total_bytes = next_total_bytes;
+    return {};
+}
+
+constexpr std::size_t element_size_of(format_code fmt) noexcept {
+    switch (fmt) {
+    case format_code::i2:
+    case format_code::u2:
+        return 2;
+    case format_code::i4:
+    case format_code::u4:
+    case format_code::f4:
+        return 4;
+    case format_code::i8:
+    case format_code::u8:
+    case format_code::f8:
+        return 8;
+    default:
+        return 1;
+    }
+}
+
 template <class UInt>
 UInt read_be_uint(bytes_view payload, std::size_t offset) noexcept {
     UInt v = 0;
@@ -722,44 +826,22 @@ decode_item(SpanReader &r,
         return make_error_code(errc::total_budget_exceeded);
     }
     ++budget.total_items;
-
-    byte format_byte = 0;
-    auto ec = r.read_u8(format_byte);
-    if (ec) {
-        return ec;
-    }
-
-    const auto length_bytes =
-        static_cast<std::uint8_t>(format_byte & 0x03u);
-    if (length_bytes == 0 || length_bytes > 3) {
-        return make_error_code(errc::invalid_header);
+    if (budget.reservation && !budget.reservation->try_grow(sizeof(Item))) {
+        return make_error_code(errc::out_of_memory);
     }
 
+    format_code fmt = format_code::list;
     std::uint32_t length = 0;
-    ec = r.read_be_u32(length_bytes, length);
+    auto ec = read_item_header(r, fmt, length);
     if (ec) {
         return ec;
     }
-    if (length > kMaxLength) {
-        return make_error_code(errc::length_overflow);
-    }
-
-    const auto fmt_bits = static_cast<std::uint8_t>(format_byte >> 2);
-    const auto fmt = format_code_from_bits(fmt_bits);
-    if (!fmt) {
-        return make_error_code(errc::invalid_format);
-    }
 
-    if (*fmt == format_code::list) {
+    if (fmt == format_code::list) {
         // List 的 Length 表示“子元素个数”，因此按 count 递归解析每个子项。
-        if (length > limits.max_list_items) {
-            return make_error_code(errc::list_too_large);
-        }
-        const std::size_t want =
-            static_cast<std::size_t>(budget.total_items) +
-            static_cast<std::size_t>(length);
-        if (want > limits.max_total_items) {
-            return make_error_code(errc::total_budget_exceeded);
+        ec = check_list_budget(length, budget, limits);
+        if (ec) {
+            return ec;
         }
         List items;
         items.reserve(length);
@@ -777,27 +859,13 @@ decode_item(SpanReader &r,
         return {};
     }
 
-    if (length > limits.max_payload_bytes) {
-        return make_error_code(errc::payload_too_large);
-    }
-    std::size_t next_total_bytes = 0;
-    if (!checked_add(budget.total_bytes,
-                     static_cast<std::size_t>(length),
-                     next_total_bytes)) {
-        return make_error_code(errc::total_budget_exceeded);
-    }
-    if (next_total_bytes > limits.max_total_bytes) {
-        return make_error_code(errc::total_budget_exceeded);
-    }
-
     bytes_view payload{};
-    ec = r.read_payload(length, payload);
+    ec = read_leaf_payload(r, length, budget, limits, payload);
     if (ec) {
         return ec;
     }
-    budget.total_bytes = next_total_bytes;
 
-    switch (*fmt) {
+    switch (fmt) {
     case format_code::ascii: {
         std::string s(reinterpret_cast<const char *>(payload.data()),
                       payload.size());
@@ -919,6 +987,100 @@ decode_item(SpanReader &r,
     }
 }
 
+std::error_code visit_item(SpanReader &r,
+                           EncodedVisitor &visitor,
+                           std::size_t depth,
+                           DecodeBudget &budget,
+                           const DecodeLimits &limits) {
+    // 与 decode_item 相同的校验顺序与限制，只是不构造 Item：
+    // 每个节点校验通过后立即回调，payload 以指向输入缓冲区的视图交出。
+    if (depth > limits.max_depth) {
+        return make_error_code(errc::invalid_header);
+    }
+    if (budget.total_items >= limits.max_total_items) {
+        return make_error_code(errc::total_budget_exceeded);
+    }
+    ++budget.total_items;
+
+    format_code fmt = format_code::list;
+    std::uint32_t length = 0;
+    auto ec = read_item_header(r, fmt, length);
+    if (ec) {
+        return ec;
+    }
+
+    if (fmt == format_code::list) {
+        ec = check_list_budget(length, budget, limits);
+        if (ec) {
+            return ec;
+        }
+        visitor.on_list_begin(length);
+        for (std::uint32_t i = 0; i < length; ++i) {
+            ec = visit_item(r, visitor, depth + 1, budget, limits);
+            if (ec) {
+                return ec;
+            }
+        }
+        visitor.on_list_end();
+        return {};
+    }
+
+    bytes_view payload{};
+    ec = read_leaf_payload(r, length, budget, limits, payload);
+    if (ec) {
+        return ec;
+    }
+    if (payload.size() % element_size_of(fmt) != 0) {
+        return make_error_code(errc::length_mismatch);
+    }
+
+    switch (fmt) {
+    case format_code::ascii:
+        visitor.on_ascii(
+            std::string_view{reinterpret_cast<const char *>(payload.data()),
+                             payload.size()});
+        return {};
+    case format_code::binary:
+        visitor.on_binary(payload);
+        return {};
+    case format_code::boolean:
+        visitor.on_boolean(payload);
+        return {};
+    case format_code::i1:
+        visitor.on_i1(BigEndianView<std::int8_t>{payload});
+        return {};
+    case format_code::i2:
+        visitor.on_i2(BigEndianView<std::int16_t>{payload});
+        return {};
+    case format_code::i4:
+        visitor.on_i4(BigEndianView<std::int32_t>{payload});
+        return {};
+    case format_code::i8:
+        visitor.on_i8(BigEndianView<std::int64_t>{payload});
+        return {};
+    case format_code::u1:
+        visitor.on_u1(BigEndianView<std::uint8_t>{payload});
+        return {};
+    case format_code::u2:
+        visitor.on_u2(BigEndianView<std::uint16_t>{payload});
+        return {};
+    case format_code::u4:
+        visitor.on_u4(BigEndianView<std::uint32_t>{payload});
+        return {};
+    case format_code::u8:
+        visitor.on_u8(BigEndianView<std::uint64_t>{payload});
+        return {};
+    case format_code::f4:
+        visitor.on_f4(BigEndianView<float>{payload});
+        return {};
+    case format_code::f8:
+        visitor.on_f8(BigEndianView<double>{payload});
+        return {};
+    default:
+        return make_error_code(errc::invalid_format);
+    }
+}
+
 } // namespace
 
 const std::error_category &error_category() noexcept {
@@ -992,6 +1154,11 @@ std::error_code decode_one(bytes_view in,
                            Item &out,
                            std::size_t &consumed,
                            const DecodeLimits &limits) noexcept {
+    if (limits.memory_budget) {
+        // 只做准入：预约在返回时随 reservation 析构归还。
+        core::MemoryReservation reservation(limits.memory_budget);
+        return decode_one(in, out, consumed, limits, reservation);
+    }
     SpanReader r(in);
     DecodeBudget budget{};
     try {
@@ -1011,4 +1178,69 @@ std::error_code decode_one(bytes_view in,
     }
 }
 
+std::error_code decode_one(bytes_view in,
+                           Item &out,
+                           std::size_t &consumed,
+                           const DecodeLimits &limits,
+                           core::MemoryReservation &reservation) noexcept {
+    SpanReader r(in);
+    DecodeBudget budget{};
+    budget.reservation = &reservation;
+    const auto before = reservation.bytes();
+    std::error_code ec;
+    try {
+        ec = decode_item(r, out, 0, budget, limits);
+    } catch (const std::bad_alloc &) {
+        ec = make_error_code(errc::out_of_memory);
+    } catch (...) {
+        ec = make_error_code(errc::invalid_header);
+    }
+    if (ec) {
+        reservation.shrink(reservation.bytes() - before);
+        consumed = 0;
+        return ec;
+    }
+    consumed = r.consumed();
+    return {};
+}
+
+std::error_code decode_one(bytes_view in,
+                           Item &out,
+                           std::size_t &consumed,
+                           const DecodeLimits &limits,
+                           std::shared_ptr<const core::MemoryReservation> &lease) noexcept {
+    lease.reset();
+    if (!limits.memory_budget) {
+        return decode_one(in, out, consumed, limits);
+    }
+    core::MemoryReservation reservation(limits.memory_budget);
+    const auto ec = decode_one(in, out, consumed, limits, reservation);
+    if (ec) {
+        return ec;
+    }
+    lease = core::make_memory_lease(std::move(reservation));
+    return {};
+}
+
+std::error_code visit_encoded(bytes_view in,
+                              EncodedVisitor &visitor,
+                              std::size_t &consumed) {
+    return visit_encoded(in, visitor, consumed, DecodeLimits{});
+}
+
+std::error_code visit_encoded(bytes_view in,
+                              EncodedVisitor &visitor,
+                              std::size_t &consumed,
+                              const DecodeLimits &limits) {
+    SpanReader r(in);
+    DecodeBudget budget{};
+    auto ec = visit_item(r, visitor, 0, budget, limits);
+    if (ec) {
+        consumed = 0;
+        return ec;
+    }
+    consumed = r.consumed();
+    return {};
+}
+
 } // namespace secs::ii
@@ -1,6 +1,7 @@
 #include "secs/protocol/session.hpp"
 
 #include "secs/core/error.hpp"
+#include "secs/hsms/general_session.hpp"
 #include "secs/hsms/message.hpp"
 #include "secs/hsms/session.hpp"
 #include "secs/secs1/block.hpp"
@@ -14,6 +15,7 @@
 #include <asio/use_awaitable.hpp>
 
 #include <chrono>
+#include <deque>
 #include <new>
 #include <sstream>
 #include <string_view>
@@ -49,6 +51,12 @@ namespace {
 using secs::core::errc;
 using secs::core::make_error_code;
 
+// 立即完成的 awaitable：供非协程入口的快速失败路径使用（热路径不经过）。
+template <class T>
+asio::awaitable<T> ready_(T value) {
+    co_return value;
+}
+
 enum class DumpDirection : std::uint8_t {
     tx = 0,
     rx = 1,
@@ -59,12 +67,13 @@ enum class DumpBackend : std::uint8_t {
     secs1 = 1,
 };
 
-[[nodiscard]] const char *dump_dir_name_(DumpDirection d) noexcept {
-    return (d == DumpDirection::tx) ? "TX" : "RX";
-}
-
-[[nodiscard]] const char *dump_backend_name_(DumpBackend b) noexcept {
-    return (b == DumpBackend::hsms) ? "HSMS" : "SECS-I";
+// 默认输出：走库内 spdlog（INFO 级别），便于运行时直接看到 dump。
+void spdlog_dump_sink_(void *, const char *data, std::size_t size) noexcept {
+    try {
+        SPDLOG_INFO("{}", std::string_view{data, size});
+    } catch (...) {
+        // dump 仅用于调试，不应影响业务协程的可用性。
+    }
 }
 
 void emit_dump_(const SessionOptions::DumpOptions &opt,
@@ -76,21 +85,33 @@ void emit_dump_(const SessionOptions::DumpOptions &opt,
         opt.sink(opt.sink_user, text.data(), text.size());
         return;
     }
-    // 默认输出：走库内 spdlog（INFO 级别），便于运行时直接看到 dump。
-    try {
-        SPDLOG_INFO("{}", text);
-    } catch (...) {
-        // dump 仅用于调试，不应影响业务协程的可用性。
-    }
+    spdlog_dump_sink_(nullptr, text.data(), text.size());
 }
 
-[[nodiscard]] std::string dump_banner_(DumpDirection dir, DumpBackend backend) {
-    std::ostringstream oss;
-    oss << "====================\n";
-    oss << "protocol dump: " << dump_dir_name_(dir) << ' '
-        << dump_backend_name_(backend) << '\n';
-    oss << "====================\n";
-    return oss.str();
+// 横幅只依赖方向与后端，预先生成，避免延迟模式在 io 线程上格式化。
+[[nodiscard]] std::string_view dump_banner_(DumpDirection dir,
+                                            DumpBackend backend) noexcept {
+    static constexpr std::string_view kBanners[2][2] = {
+        {"====================\nprotocol dump: TX HSMS\n====================\n",
+         "====================\nprotocol dump: TX SECS-I\n====================\n"},
+        {"====================\nprotocol dump: RX HSMS\n====================\n",
+         "====================\nprotocol dump: RX SECS-I\n====================\n"},
+    };
+    return kBanners[static_cast<int>(dir)][static_cast<int>(backend)];
+}
+
+[[nodiscard]] std::shared_ptr<secs::utils::AsyncDumper>
+make_dumper_(const SessionOptions::DumpOptions &opt) {
+    if (!opt.enable || !opt.deferred) {
+        return nullptr;
+    }
+    secs::utils::AsyncDumpOptions async_opt{};
+    async_opt.buffer_bytes = opt.deferred_buffer_bytes;
+    async_opt.sink = opt.sink ? opt.sink : spdlog_dump_sink_;
+    async_opt.sink_user = opt.sink ? opt.sink_user : nullptr;
+    async_opt.hsms = opt.hsms;
+    async_opt.secs1 = opt.secs1;
+    return std::make_shared<secs::utils::AsyncDumper>(std::move(async_opt));
 }
 
 [[nodiscard]] std::string dump_hsms_(DumpDirection dir,
@@ -105,9 +126,9 @@ void emit_dump_(const SessionOptions::DumpOptions &opt,
         return oss.str();
     }
 
-    auto out = dump_banner_(dir, DumpBackend::hsms);
-    out += secs::utils::dump_hsms_frame(
-        secs::core::bytes_view{frame.data(), frame.size()}, opt.hsms);
+    std::string out(dump_banner_(dir, DumpBackend::hsms));
+    secs::utils::append_hsms_frame_dump(
+        out, secs::core::bytes_view{frame.data(), frame.size()}, opt.hsms);
     return out;
 }
 
@@ -115,8 +136,8 @@ void emit_dump_(const SessionOptions::DumpOptions &opt,
                                      const secs::secs1::Header &header,
                                      secs::core::bytes_view body,
                                      const SessionOptions::DumpOptions &opt) {
-    auto out = dump_banner_(dir, DumpBackend::secs1);
-    out += secs::utils::dump_secs1_message(header, body, opt.secs1);
+    std::string out(dump_banner_(dir, DumpBackend::secs1));
+    secs::utils::append_secs1_message_dump(out, header, body, opt.secs1);
     return out;
 }
 
@@ -148,13 +169,73 @@ normalize_timeout(secs::core::duration d) noexcept {
 
 } // namespace
 
+struct Session::Metrics final {
+    explicit Metrics(std::shared_ptr<secs::core::metrics::Group> g)
+        : group(std::move(g)),
+          requests(group->counter("secs_protocol_requests_total",
+                                  "Protocol requests (W=1 primaries) sent.")),
+          request_timeouts(group->counter("secs_protocol_request_timeouts_total",
+                                          "Protocol requests that hit T3.")),
+          messages_tx(group->counter("secs_protocol_messages_total",
+                                     "Data messages sent/received.",
+                                     {{"direction", "tx"}})),
+          messages_rx(group->counter("secs_protocol_messages_total",
+                                     "Data messages sent/received.",
+                                     {{"direction", "rx"}})),
+          unhandled(group->counter("secs_protocol_unhandled_total",
+                                   "Inbound primaries without a handler.")),
+          handler_errors(group->counter("secs_protocol_handler_errors_total",
+                                        "Handlers that returned an error.")),
+          spooled(group->counter("secs_protocol_spooled_total",
+                                 "Primaries written to the spool instead of sent.")),
+          spool_drained(group->counter("secs_protocol_spool_drained_total",
+                                       "Spooled messages delivered and removed.")),
+          t3_rtt(group->histogram("secs_protocol_t3_rtt_seconds",
+                                  "Request round-trip time (send to matched reply).",
+                                  {},
+                                  secs::core::metrics::kNanosecondsToSeconds)),
+          handler_time(group->histogram("secs_protocol_handler_seconds",
+                                        "Time spent in inbound message handlers.",
+                                        {},
+                                        secs::core::metrics::kNanosecondsToSeconds)) {}
+
+    std::shared_ptr<secs::core::metrics::Group> group;
+    secs::core::metrics::Counter &requests;
+    secs::core::metrics::Counter &request_timeouts;
+    secs::core::metrics::Counter &messages_tx;
+    secs::core::metrics::Counter &messages_rx;
+    secs::core::metrics::Counter &unhandled;
+    secs::core::metrics::Counter &handler_errors;
+    secs::core::metrics::Counter &spooled;
+    secs::core::metrics::Counter &spool_drained;
+    secs::core::metrics::Histogram &t3_rtt;
+    secs::core::metrics::Histogram &handler_time;
+};
+
 Session::Session(secs::hsms::Session &hsms,
                  std::uint16_t session_id,
                  SessionOptions options)
+    : backend_(Backend::hsms),
+      // hsms::Session 自身绑定 strand：共用它，协议层调用 HSMS 层时无需再切换执行器。
+      executor_(hsms.executor()),
+      options_(options),
+      metrics_(options.metrics ? std::make_shared<Metrics>(options.metrics)
+                               : nullptr),
+      dumper_(make_dumper_(options.dump)),
+      pending_(options.max_pending_requests), hsms_(&hsms),
+      hsms_session_id_(session_id) {}
+
+Session::Session(secs::hsms::GeneralSession &hsms,
+                 std::uint16_t session_id,
+                 SessionOptions options)
     : backend_(Backend::hsms),
       executor_(asio::make_strand(hsms.executor())),
       options_(options),
-      hsms_(&hsms), hsms_session_id_(session_id) {}
+      metrics_(options.metrics ? std::make_shared<Metrics>(options.metrics)
+                               : nullptr),
+      dumper_(make_dumper_(options.dump)),
+      pending_(options.max_pending_requests), hsms_gs_(&hsms),
+      hsms_session_id_(session_id) {}
 
 Session::Session(secs::secs1::StateMachine &secs1,
                  std::uint16_t device_id,
@@ -162,8 +243,24 @@ Session::Session(secs::secs1::StateMachine &secs1,
     : backend_(Backend::secs1),
       executor_(asio::make_strand(secs1.executor())),
       options_(options),
+      metrics_(options.metrics ? std::make_shared<Metrics>(options.metrics)
+                               : nullptr),
+      dumper_(make_dumper_(options.dump)),
+      pending_(1), // SECS-I 请求侧自行驱动接收，不使用 pending_
       secs1_(&secs1), secs1_device_id_(device_id) {}
 
+void Session::note_request_done_(const std::error_code &ec,
+                                 secs::core::steady_clock::time_point started) noexcept {
+    if (!metrics_) {
+        return;
+    }
+    if (!ec) {
+        metrics_->t3_rtt.record_duration(secs::core::steady_clock::now() - started);
+    } else if (ec == make_error_code(errc::timeout)) {
+        metrics_->request_timeouts.add();
+    }
+}
+
 void Session::ensure_hsms_run_loop_started_() {
     std::lock_guard lk(run_mu_);
     if (run_loop_spawned_) {
@@ -171,12 +268,7 @@ void Session::ensure_hsms_run_loop_started_() {
     }
     run_loop_spawned_ = true;
 
-    asio::co_spawn(
-        executor_,
-        [this]() -> asio::awaitable<void> {
-            co_await async_run_impl_();
-        }, // GCOVR_EXCL_LINE：co_spawn 内联分支不计入覆盖率
-        asio::detached);
+    asio::co_spawn(executor_, async_run_impl_(), asio::detached);
 }
 
 void Session::stop() noexcept {
@@ -190,17 +282,32 @@ void Session::stop() noexcept {
 
             stop_requested_ = true;
             cancel_all_pending_(make_error_code(errc::cancelled));
+            pending_slot_freed_.cancel();
 
             // HSMS 后端：主动取消底层阻塞读，避免依赖 poll_interval 轮询退出。
             if (backend_ == Backend::hsms && hsms_) {
                 hsms_->stop();
             }
+            // HSMS-GS：连接由多个逻辑会话共享，只唤醒本会话的接收等待。
+            if (backend_ == Backend::hsms && hsms_gs_) {
+                hsms_gs_->cancel_receive(hsms_session_id_);
+            }
         });
     } catch (...) {
         // best-effort：dispatch/post 失败通常意味着资源不足，此处不抛异常。
     }
 }
 
+void Session::flush_dump() noexcept {
+    if (dumper_) {
+        dumper_->flush();
+    }
+}
+
+std::uint64_t Session::dump_dropped() const noexcept {
+    return dumper_ ? dumper_->dropped() : 0;
+}
+
 asio::awaitable<void> Session::async_run() {
     const auto ex = co_await asio::this_coro::executor;
     if (ex == executor_) {
@@ -209,13 +316,7 @@ asio::awaitable<void> Session::async_run() {
     }
 
     try {
-        co_await asio::co_spawn(
-            executor_,
-            [this]() -> asio::awaitable<void> {
-                co_await async_run_impl_();
-                co_return;
-            },
-            asio::use_awaitable);
+        co_await asio::co_spawn(executor_, async_run_impl_(), asio::use_awaitable);
     } catch (...) {
         // co_spawn 失败（例如资源不足）时，不应抛异常导致上层协程崩溃。
     }
@@ -239,12 +340,29 @@ asio::awaitable<void> Session::async_run_impl_() {
                                     : normalize_timeout(options_.poll_interval);
 
     while (!stop_requested_) {
+        if (backend_ == Backend::hsms) {
+            // 一次唤醒取走整批就绪消息，逐条处理；处理期间 stop() 则丢弃余下部分。
+            auto [ec, batch] = co_await async_receive_batch_(timeout);
+            if (ec) {
+                // 先置位 stop，再 cancel pending：避免并发新请求扩大窗口。
+                stop_requested_ = true;
+                cancel_all_pending_(ec);
+                break;
+            }
+            for (auto &msg : batch) {
+                if (stop_requested_) {
+                    break;
+                }
+                co_await handle_inbound_(std::move(msg));
+            }
+            continue;
+        }
+
         auto [ec, msg] = co_await async_receive_message_(timeout);
         if (ec == make_error_code(errc::timeout)) {
             continue;
         }
         if (ec) {
-            // 先置位 stop，再 cancel pending：避免并发新请求扩大窗口。
             stop_requested_ = true;
             cancel_all_pending_(ec);
             break;
@@ -262,11 +380,7 @@ Session::async_poll_once(std::optional<secs::core::duration> timeout) {
 
     try {
         co_return co_await asio::co_spawn(
-            executor_,
-            [this, timeout]() -> asio::awaitable<std::error_code> {
-                co_return co_await async_poll_once_impl_(timeout);
-            },
-            asio::use_awaitable);
+            executor_, async_poll_once_impl_(timeout), asio::use_awaitable);
     } catch (const std::bad_alloc &) {
         co_return make_error_code(errc::out_of_memory);
     } catch (...) {
@@ -295,17 +409,29 @@ Session::async_poll_once_impl_(std::optional<secs::core::duration> timeout) {
 
 asio::awaitable<std::error_code> Session::async_send(
     std::uint8_t stream, std::uint8_t function, secs::core::bytes_view body) {
+    // API 边界：消息体在这里拷贝唯一一次，并预留 HSMS 帧前缀。
+    // 本函数不是协程：直接返回 async_send_shared 的 awaitable，少一层协程帧。
+    secs::core::SharedBytes shared;
+    try {
+        shared = secs::core::SharedBytes::copy(body, secs::hsms::kFramePrefixSize);
+    } catch (const std::bad_alloc &) {
+        return ready_(make_error_code(errc::out_of_memory));
+    }
+    return async_send_shared(stream, function, std::move(shared));
+}
+
+asio::awaitable<std::error_code> Session::async_send_shared(
+    std::uint8_t stream, std::uint8_t function, secs::core::SharedBytes body) {
     const auto ex = co_await asio::this_coro::executor;
     if (ex == executor_) {
-        co_return co_await async_send_impl_(stream, function, body);
+        co_return co_await async_send_impl_(stream, function, std::move(body));
     }
 
     try {
+        // 直接派生 impl 协程（不再包一层 lambda 协程）：body 移入其协程帧。
         co_return co_await asio::co_spawn(
             executor_,
-            [this, stream, function, body]() -> asio::awaitable<std::error_code> {
-                co_return co_await async_send_impl_(stream, function, body);
-            },
+            async_send_impl_(stream, function, std::move(body)),
             asio::use_awaitable);
     } catch (const std::bad_alloc &) {
         co_return make_error_code(errc::out_of_memory);
@@ -314,12 +440,48 @@ asio::awaitable<std::error_code> Session::async_send(
     }
 }
 
-asio::awaitable<std::error_code> Session::async_send_impl_(
-    std::uint8_t stream, std::uint8_t function, secs::core::bytes_view body) {
+asio::awaitable<std::error_code> Session::async_send_streamed(
+    std::uint8_t stream,
+    std::uint8_t function,
+    std::shared_ptr<secs::core::BodySource> source) {
+    if (!source) {
+        co_return make_error_code(errc::invalid_argument);
+    }
+    const auto ex = co_await asio::this_coro::executor;
+    if (ex == executor_) {
+        co_return co_await async_send_impl_(stream, function, {}, std::move(source));
+    }
+
+    try {
+        co_return co_await asio::co_spawn(
+            executor_,
+            async_send_impl_(stream, function, {}, std::move(source)),
+            asio::use_awaitable);
+    } catch (const std::bad_alloc &) {
+        co_return make_error_code(errc::out_of_memory);
+    } catch (...) {
+        co_return make_error_code(errc::invalid_argument);
+    }
+}
+
+asio::awaitable<std::error_code>
+Session::async_send_impl_(std::uint8_t stream,
+                          std::uint8_t function,
+                          secs::core::SharedBytes body,
+                          std::shared_ptr<secs::core::BodySource> source) {
     if (!is_valid_stream(stream) || !is_primary_function(function)) {
         co_return make_error_code(errc::invalid_argument);
     }
 
+    // 流式消息体不在内存中，无法写入 spool：直接发送。
+    if (!source && should_spool_(stream, function)) {
+        const auto ec = options_.spool->push(stream, function, false, body.view());
+        if (!ec && metrics_) {
+            metrics_->spooled.add();
+        }
+        co_return ec;
+    }
+
     std::uint32_t sb = 0;
     auto alloc_ec = system_bytes_.allocate(sb);
     if (alloc_ec) {
@@ -331,13 +493,14 @@ asio::awaitable<std::error_code> Session::async_send_impl_(
     msg.function = function;
     msg.w_bit = false;
     msg.system_bytes = sb;
-    msg.body.assign(body.begin(), body.end());
+    msg.shared_body = std::move(body);
+    msg.body_source = std::move(source);
 
     SPDLOG_DEBUG("protocol async_send: S{}F{} W=0 sb={} body_n={}",
                  static_cast<int>(msg.stream),
                  static_cast<int>(msg.function),
                  msg.system_bytes,
-                 msg.body.size());
+                 msg.body_source ? msg.body_source->size() : msg.shared_body.size());
 
     auto ec = co_await async_send_message_(msg);
     if (ec) {
@@ -355,21 +518,56 @@ Session::async_request(std::uint8_t stream,
                        std::uint8_t function,
                        secs::core::bytes_view body,
                        std::optional<secs::core::duration> timeout) {
+    // 同 async_send：非协程，直接返回 async_request_shared 的 awaitable。
+    secs::core::SharedBytes shared;
+    try {
+        shared = secs::core::SharedBytes::copy(body, secs::hsms::kFramePrefixSize);
+    } catch (const std::bad_alloc &) {
+        return ready_(std::pair{make_error_code(errc::out_of_memory), DataMessage{}});
+    }
+    return async_request_shared(stream, function, std::move(shared), timeout);
+}
+
+asio::awaitable<std::pair<std::error_code, DataMessage>>
+Session::async_request_shared(std::uint8_t stream,
+                              std::uint8_t function,
+                              secs::core::SharedBytes body,
+                              std::optional<secs::core::duration> timeout) {
     const auto ex = co_await asio::this_coro::executor;
     if (ex == executor_) {
-        co_return co_await async_request_impl_(stream, function, body, timeout);
+        co_return co_await async_request_impl_(stream, function, std::move(body), timeout);
     }
 
     try {
         co_return co_await asio::co_spawn(
             executor_,
-            [this, stream, function, body, timeout]()
-                -> asio::awaitable<std::pair<std::error_code, DataMessage>> {
-                co_return co_await async_request_impl_(stream,
-                                                      function,
-                                                      body,
-                                                      timeout);
-            },
+            async_request_impl_(stream, function, std::move(body), timeout),
+            asio::use_awaitable);
+    } catch (const std::bad_alloc &) {
+        co_return std::pair{make_error_code(errc::out_of_memory), DataMessage{}};
+    } catch (...) {
+        co_return std::pair{make_error_code(errc::invalid_argument), DataMessage{}};
+    }
+}
+
+asio::awaitable<std::pair<std::error_code, DataMessage>>
+Session::async_request_streamed(std::uint8_t stream,
+                                std::uint8_t function,
+                                std::shared_ptr<secs::core::BodySource> source,
+                                std::optional<secs::core::duration> timeout) {
+    if (!source) {
+        co_return std::pair{make_error_code(errc::invalid_argument), DataMessage{}};
+    }
+    const auto ex = co_await asio::this_coro::executor;
+    if (ex == executor_) {
+        co_return co_await async_request_impl_(
+            stream, function, {}, timeout, std::move(source));
+    }
+
+    try {
+        co_return co_await asio::co_spawn(
+            executor_,
+            async_request_impl_(stream, function, {}, timeout, std::move(source)),
             asio::use_awaitable);
     } catch (const std::bad_alloc &) {
         co_return std::pair{make_error_code(errc::out_of_memory), DataMessage{}};
@@ -381,13 +579,22 @@ Session::async_request(std::uint8_t stream,
 asio::awaitable<std::pair<std::error_code, DataMessage>>
 Session::async_request_impl_(std::uint8_t stream,
                              std::uint8_t function,
-                             secs::core::bytes_view body,
-                             std::optional<secs::core::duration> timeout) {
+                             secs::core::SharedBytes body,
+                             std::optional<secs::core::duration> timeout,
+                             std::shared_ptr<secs::core::BodySource> source) {
     if (!is_valid_stream(stream) || !is_primary_function(function) ||
         !can_compute_secondary_function(function)) {
         co_return std::pair{make_error_code(errc::invalid_argument),
                             DataMessage{}};
     }
+    if (!source && should_spool_(stream, function)) {
+        const auto ec = options_.spool->push(stream, function, true, body.view());
+        if (!ec && metrics_) {
+            metrics_->spooled.add();
+        }
+        co_return std::pair{ec ? ec : std::make_error_code(std::errc::operation_in_progress),
+                            DataMessage{}};
+    }
     if (stop_requested_) {
         co_return std::pair{make_error_code(errc::cancelled), DataMessage{}};
     }
@@ -406,7 +613,13 @@ Session::async_request_impl_(std::uint8_t stream,
     req.function = function;
     req.w_bit = true;
     req.system_bytes = sb;
-    req.body.assign(body.begin(), body.end());
+    req.shared_body = std::move(body);
+    req.body_source = std::move(source);
+
+    const auto started = secs::core::steady_clock::now();
+    if (metrics_) {
+        metrics_->requests.add();
+    }
 
     // HSMS：用接收循环统一接收并分发，避免多个请求并发读造成竞争。
     if (backend_ == Backend::hsms) {
@@ -417,73 +630,39 @@ Session::async_request_impl_(std::uint8_t stream,
                      static_cast<int>(function),
                      static_cast<int>(expected_function),
                      sb,
-                     req.body.size());
+                     req.shared_body.size());
 
-        auto pending = std::make_shared<Pending>(stream, expected_function);
-        {
-            std::lock_guard lk(pending_mu_);
-            const auto max_pending =
-                options_.max_pending_requests == 0 ? std::size_t{1}
-                                                   : options_.max_pending_requests;
-            if (pending_.size() >= max_pending) {
-                system_bytes_.release(sb);
-                co_return std::pair{make_error_code(errc::buffer_overflow),
-                                    DataMessage{}};
-            }
-            pending_.insert_or_assign(sb, pending);
+        PendingHandle handle{};
+        std::optional<secs::core::steady_clock::time_point> slot_deadline;
+        if (options_.wait_for_pending_slot) {
+            slot_deadline = started + t3;
         }
-
-        auto send_ec = co_await async_send_message_(req);
+        const auto send_ec =
+            co_await begin_hsms_request_(req, expected_function, handle, slot_deadline);
         if (send_ec) {
-            SPDLOG_DEBUG("protocol async_request(HSMS) send failed: sb={} ec={}({})",
-                         sb,
-                         send_ec.value(),
-                         send_ec.message());
-            {
-                std::lock_guard lk(pending_mu_);
-                pending_.erase(sb);
-            }
             system_bytes_.release(sb);
+            note_request_done_(send_ec, started);
             co_return std::pair{send_ec, DataMessage{}};
         }
 
-        auto wait_ec = co_await pending->ready.async_wait(t3);
-        {
-            std::lock_guard lk(pending_mu_);
-            pending_.erase(sb);
-        }
+        auto result = co_await await_hsms_reply_(handle, t3);
         system_bytes_.release(sb);
 
-        if (wait_ec == make_error_code(errc::timeout)) {
+        if (result.first == make_error_code(errc::timeout)) {
             SPDLOG_DEBUG("protocol async_request(HSMS) timeout: sb={} t3_ms={}",
                          sb,
                          std::chrono::duration_cast<std::chrono::milliseconds>(t3)
                              .count());
-            co_return std::pair{wait_ec, DataMessage{}};
-        }
-        if (wait_ec) {
-            SPDLOG_DEBUG("protocol async_request(HSMS) wait failed: sb={} ec={}({})",
-                         sb,
-                         wait_ec.value(),
-                         wait_ec.message());
-            co_return std::pair{pending->ec ? pending->ec : wait_ec,
-                                DataMessage{}};
-        }
-        if (pending->ec) {
-            SPDLOG_DEBUG("protocol async_request(HSMS) pending failed: sb={} ec={}({})",
+        } else if (result.first) {
+            SPDLOG_DEBUG("protocol async_request(HSMS) failed: sb={} ec={}({})",
                          sb,
-                         pending->ec.value(),
-                         pending->ec.message());
-            co_return std::pair{pending->ec, DataMessage{}};
+                         result.first.value(),
+                         result.first.message());
+        } else {
+            SPDLOG_DEBUG("protocol async_request(HSMS) done: sb={}", sb);
         }
-        if (!pending->response.has_value()) {
-            SPDLOG_DEBUG("protocol async_request(HSMS) pending has no response: sb={}",
-                         sb);
-            co_return std::pair{make_error_code(errc::invalid_argument),
-                                DataMessage{}};
-        }
-        SPDLOG_DEBUG("protocol async_request(HSMS) done: sb={}", sb);
-        co_return std::pair{std::error_code{}, *pending->response};
+        note_request_done_(result.first, started);
+        co_return result;
     }
 
     // SECS-I：半双工，请求侧自己驱动接收循环，并在期间处理可能的入站主消息。
@@ -492,7 +671,7 @@ Session::async_request_impl_(std::uint8_t stream,
                  static_cast<int>(function),
                  static_cast<int>(expected_function),
                  sb,
-                 req.body.size());
+                 req.shared_body.size());
     auto send_ec = co_await async_send_message_(req);
     if (send_ec) {
         SPDLOG_DEBUG("protocol async_request(SECS-I) send failed: sb={} ec={}({})",
@@ -512,6 +691,7 @@ Session::async_request_impl_(std::uint8_t stream,
                          std::chrono::duration_cast<std::chrono::milliseconds>(t3)
                              .count());
             system_bytes_.release(sb);
+            note_request_done_(make_error_code(errc::timeout), started);
             co_return std::pair{make_error_code(errc::timeout), DataMessage{}};
         }
 
@@ -523,6 +703,7 @@ Session::async_request_impl_(std::uint8_t stream,
                          ec.value(),
                          ec.message());
             system_bytes_.release(sb);
+            note_request_done_(ec, started);
             co_return std::pair{ec, DataMessage{}};
         }
 
@@ -533,6 +714,7 @@ Session::async_request_impl_(std::uint8_t stream,
         if (matches) {
             SPDLOG_DEBUG("protocol async_request(SECS-I) done: sb={}", sb);
             system_bytes_.release(sb);
+            note_request_done_(std::error_code{}, started);
             co_return std::pair{std::error_code{}, std::move(msg)};
         }
 
@@ -547,20 +729,47 @@ Session::async_send_message_(const DataMessage &msg) {
     }
 
     if (backend_ == Backend::hsms) {
-        if (!hsms_) {
+        if (!hsms_ && !hsms_gs_) {
             co_return make_error_code(errc::invalid_argument);
         }
-        const auto wire = secs::hsms::make_data_message(
-            hsms_session_id_,
-            msg.stream,
-            msg.function,
-            msg.w_bit,
-            msg.system_bytes,
-            secs::core::bytes_view{msg.body.data(), msg.body.size()});
-        if (options_.dump.enable && options_.dump.dump_tx) {
-            emit_dump_(options_.dump, dump_hsms_(DumpDirection::tx, wire, options_.dump));
+        // 共享/流式消息体只传引用；普通 vector 消息体（如 handler 回应）仍按值拷贝。
+        auto wire =
+            msg.shared_body.empty()
+                ? secs::hsms::make_data_message(hsms_session_id_,
+                                                msg.stream,
+                                                msg.function,
+                                                msg.w_bit,
+                                                msg.system_bytes,
+                                                msg.body_view())
+                : secs::hsms::make_data_message_shared(hsms_session_id_,
+                                                       msg.stream,
+                                                       msg.function,
+                                                       msg.w_bit,
+                                                       msg.system_bytes,
+                                                       msg.shared_body);
+        wire.body_source = msg.body_source;
+        // 流式消息体不在内存中：不输出 dump。
+        if (options_.dump.enable && options_.dump.dump_tx && !msg.body_source) {
+            if (dumper_) {
+                (void)dumper_->push_hsms(
+                    dump_banner_(DumpDirection::tx, DumpBackend::hsms),
+                    wire.header,
+                    wire.body_view());
+            } else {
+                emit_dump_(options_.dump,
+                           dump_hsms_(DumpDirection::tx, wire, options_.dump));
+            }
+        }
+        std::error_code ec;
+        if (hsms_) {
+            ec = co_await hsms_->async_send(wire);
+        } else {
+            ec = co_await hsms_gs_->async_send(wire);
+        }
+        if (!ec && metrics_) {
+            metrics_->messages_tx.add();
         }
-        co_return co_await hsms_->async_send(wire);
+        co_return ec;
     }
 
     if (!secs1_) {
@@ -577,15 +786,27 @@ Session::async_send_message_(const DataMessage &msg) {
     h.block_number = 1;
     h.system_bytes = msg.system_bytes;
 
-    if (options_.dump.enable && options_.dump.dump_tx) {
-        emit_dump_(options_.dump,
-                   dump_secs1_(DumpDirection::tx,
-                              h,
-                              secs::core::bytes_view{msg.body.data(), msg.body.size()},
-                              options_.dump));
+    if (options_.dump.enable && options_.dump.dump_tx && !msg.body_source) {
+        if (dumper_) {
+            (void)dumper_->push_secs1(
+                dump_banner_(DumpDirection::tx, DumpBackend::secs1),
+                h,
+                msg.body_view());
+        } else {
+            emit_dump_(options_.dump,
+                       dump_secs1_(DumpDirection::tx, h, msg.body_view(), options_.dump));
+        }
     }
-    co_return co_await secs1_->async_send(
-        h, secs::core::bytes_view{msg.body.data(), msg.body.size()});
+    std::error_code ec;
+    if (msg.body_source) {
+        ec = co_await secs1_->async_send(h, *msg.body_source);
+    } else {
+        ec = co_await secs1_->async_send(h, msg.body_view());
+    }
+    if (!ec && metrics_) {
+        metrics_->messages_tx.add();
+    }
+    co_return ec;
 }
 
 asio::awaitable<std::pair<std::error_code, DataMessage>>
@@ -595,28 +816,22 @@ Session::async_receive_message_(std::optional<secs::core::duration> timeout) {
     }
 
     if (backend_ == Backend::hsms) {
-        if (!hsms_) {
+        if (!hsms_ && !hsms_gs_) {
             co_return std::pair{make_error_code(errc::invalid_argument),
                                 DataMessage{}};
         }
 
-        auto [ec, msg] = co_await hsms_->async_receive_data(timeout);
+        std::pair<std::error_code, secs::hsms::Message> received;
+        if (hsms_) {
+            received = co_await hsms_->async_receive_data(timeout);
+        } else {
+            received = co_await hsms_gs_->async_receive_data(hsms_session_id_, timeout);
+        }
+        auto &[ec, msg] = received;
         if (ec) {
             co_return std::pair{ec, DataMessage{}};
         }
-
-        if (options_.dump.enable && options_.dump.dump_rx) {
-            emit_dump_(options_.dump,
-                       dump_hsms_(DumpDirection::rx, msg, options_.dump));
-        }
-
-        DataMessage out{};
-        out.stream = msg.stream();
-        out.function = msg.function();
-        out.w_bit = msg.w_bit();
-        out.system_bytes = msg.header.system_bytes;
-        out.body = std::move(msg.body);
-        co_return std::pair{std::error_code{}, std::move(out)};
+        co_return std::pair{std::error_code{}, accept_hsms_rx_(msg)};
     }
 
     if (!secs1_) {
@@ -629,23 +844,95 @@ Session::async_receive_message_(std::optional<secs::core::duration> timeout) {
         co_return std::pair{ec, DataMessage{}};
     }
 
-    if (options_.dump.enable && options_.dump.dump_rx) {
-        emit_dump_(options_.dump,
-                   dump_secs1_(DumpDirection::rx,
-                              msg.header,
-                              secs::core::bytes_view{msg.body.data(), msg.body.size()},
-                              options_.dump));
+    // 写入 sink 的消息体不在内存中，不 dump。
+    if (options_.dump.enable && options_.dump.dump_rx && !msg.body_sink) {
+        if (dumper_) {
+            (void)dumper_->push_secs1(
+                dump_banner_(DumpDirection::rx, DumpBackend::secs1),
+                msg.header,
+                secs::core::bytes_view{msg.body.data(), msg.body.size()});
+        } else {
+            emit_dump_(options_.dump,
+                       dump_secs1_(DumpDirection::rx,
+                                  msg.header,
+                                  secs::core::bytes_view{msg.body.data(),
+                                                         msg.body.size()},
+                                  options_.dump));
+        }
     }
 
+    if (metrics_) {
+        metrics_->messages_rx.add();
+    }
     DataMessage out{};
     out.stream = msg.header.stream;
     out.function = msg.header.function;
     out.w_bit = msg.header.wait_bit;
     out.system_bytes = msg.header.system_bytes;
     out.body = std::move(msg.body);
+    out.body_sink = std::move(msg.body_sink);
+    out.memory_lease = std::move(msg.memory_lease);
     co_return std::pair{std::error_code{}, std::move(out)};
 }
 
+asio::awaitable<std::pair<std::error_code, std::vector<DataMessage>>>
+Session::async_receive_batch_(std::optional<secs::core::duration> timeout) {
+    if (stop_requested_) {
+        co_return std::pair{make_error_code(errc::cancelled), std::vector<DataMessage>{}};
+    }
+    if (!hsms_ && !hsms_gs_) {
+        co_return std::pair{make_error_code(errc::invalid_argument),
+                            std::vector<DataMessage>{}};
+    }
+
+    std::pair<std::error_code, std::deque<secs::hsms::Message>> received;
+    if (hsms_) {
+        received = co_await hsms_->async_receive_data_batch(options_.run_batch_max,
+                                                            timeout);
+    } else {
+        received = co_await hsms_gs_->async_receive_data_batch(
+            hsms_session_id_, options_.run_batch_max, timeout);
+    }
+    auto &[ec, batch] = received;
+    if (ec) {
+        co_return std::pair{ec, std::vector<DataMessage>{}};
+    }
+
+    std::vector<DataMessage> out;
+    out.reserve(batch.size());
+    for (auto &msg : batch) {
+        out.push_back(accept_hsms_rx_(msg));
+    }
+    co_return std::pair{std::error_code{}, std::move(out)};
+}
+
+DataMessage Session::accept_hsms_rx_(secs::hsms::Message &msg) {
+    if (options_.dump.enable && options_.dump.dump_rx && !msg.body_sink) {
+        if (dumper_) {
+            (void)dumper_->push_hsms(
+                dump_banner_(DumpDirection::rx, DumpBackend::hsms),
+                msg.header,
+                secs::core::bytes_view{msg.body.data(), msg.body.size()});
+        } else {
+            emit_dump_(options_.dump,
+                       dump_hsms_(DumpDirection::rx, msg, options_.dump));
+        }
+    }
+
+    if (metrics_) {
+        metrics_->messages_rx.add();
+    }
+    DataMessage out{};
+    out.stream = msg.stream();
+    out.function = msg.function();
+    out.w_bit = msg.w_bit();
+    out.system_bytes = msg.header.system_bytes;
+    out.body = std::move(msg.body);
+    out.body_sink = std::move(msg.body_sink);
+    out.memory_lease = std::move(msg.memory_lease);
+    return out;
+}
+
 asio::awaitable<void> Session::handle_inbound_(DataMessage msg) {
     if (try_fulfill_pending_(msg)) {
         co_return;
@@ -664,6 +951,9 @@ asio::awaitable<void> Session::handle_inbound_(DataMessage msg) {
                      msg.w_bit ? 1 : 0,
                      msg.system_bytes,
                      msg.body.size());
+        if (metrics_) {
+            metrics_->unhandled.add();
+        }
         co_return;
     }
 
@@ -674,7 +964,15 @@ asio::awaitable<void> Session::handle_inbound_(DataMessage msg) {
                  msg.w_bit ? 1 : 0,
                  msg.system_bytes,
                  msg.body.size());
+    const auto handler_started = secs::core::steady_clock::now();
     auto [ec, rsp_body] = co_await handler(msg);
+    if (metrics_) {
+        metrics_->handler_time.record_duration(secs::core::steady_clock::now() -
+                                               handler_started);
+        if (ec) {
+            metrics_->handler_errors.add();
+        }
+    }
     if (ec) {
         SPDLOG_DEBUG("protocol handler returned error: S{}F{} sb={} ec={}({})",
                      static_cast<int>(msg.stream),
@@ -697,28 +995,27 @@ asio::awaitable<void> Session::handle_inbound_(DataMessage msg) {
     rsp.function = secondary_function(msg.function);
     rsp.w_bit = false;
     rsp.system_bytes = msg.system_bytes;
-    rsp.body = std::move(rsp_body);
+    rsp.shared_body = secs::core::SharedBytes::adopt(std::move(rsp_body));
     SPDLOG_DEBUG("protocol auto-reply secondary: S{}F{} sb={} body_n={}",
                  static_cast<int>(rsp.stream),
                  static_cast<int>(rsp.function),
                  rsp.system_bytes,
-                 rsp.body.size());
+                 rsp.shared_body.size());
     (void)co_await async_send_message_(rsp);
 }
 
 bool Session::try_fulfill_pending_(DataMessage &msg) noexcept {
-    std::shared_ptr<Pending> pending;
+    Pending *pending = nullptr;
     {
         std::lock_guard lk(pending_mu_);
-        const auto it = pending_.find(msg.system_bytes);
-        if (it == pending_.end()) {
+        pending = pending_.find(msg.system_bytes);
+        if (pending == nullptr) {
             return false;
         }
-        pending = it->second;
     }
 
-    // pending_ 的写入只来自
-    // async_request（make_shared），因此这里不做空指针分支。
+    // 条目只会被发起请求的协程 release，而该协程与本函数运行在同一 strand 上，
+    // 因此锁外访问 pending 是安全的。
     if (!msg.is_secondary() || msg.w_bit) {
         return false;
     }
@@ -739,17 +1036,485 @@ bool Session::try_fulfill_pending_(DataMessage &msg) noexcept {
 }
 
 void Session::cancel_all_pending_(std::error_code reason) noexcept {
-    std::unordered_map<std::uint32_t, std::shared_ptr<Pending>> moved;
+    std::lock_guard lk(pending_mu_);
+    pending_.unlink_if([reason](std::uint32_t, Pending &pending) noexcept {
+        pending.ec = reason;
+        pending.ready.cancel();
+        return true;
+    });
+}
+
+std::pair<std::error_code, DataMessage>
+Session::finish_pending_(PendingHandle handle, std::error_code wait_ec) noexcept {
+    auto *pending = pending_.get(handle);
+    std::pair<std::error_code, DataMessage> result{wait_ec, DataMessage{}};
+    if (pending == nullptr) {
+        result.first = make_error_code(errc::invalid_argument);
+    } else if (wait_ec == make_error_code(errc::timeout)) {
+        // T3 超时：只返回 timeout。
+    } else if (wait_ec) {
+        result.first = pending->ec ? pending->ec : wait_ec;
+    } else if (pending->ec) {
+        result.first = pending->ec;
+    } else if (!pending->response.has_value()) {
+        result.first = make_error_code(errc::invalid_argument);
+    } else {
+        result.second = std::move(*pending->response);
+    }
+    pending_.release(handle);
+    pending_slot_freed_.set();
+    return result;
+}
+
+asio::awaitable<std::error_code>
+Session::begin_hsms_request_(
+    const DataMessage &req,
+    std::uint8_t expected_function,
+    PendingHandle &handle,
+    std::optional<secs::core::steady_clock::time_point> slot_deadline) {
+    for (;;) {
+        std::error_code ec;
+        {
+            std::lock_guard lk(pending_mu_);
+            // pending_ 已满（max_pending_requests）时返回 buffer_overflow。
+            ec = pending_.emplace(req.system_bytes, handle, req.stream, expected_function);
+        }
+        if (!ec) {
+            break;
+        }
+        if (ec != make_error_code(errc::buffer_overflow) || !slot_deadline.has_value()) {
+            co_return ec;
+        }
+
+        // 背压：等某个挂起项释放后重试（多个等待者同时被唤醒，抢不到的继续等）。
+        const auto now = secs::core::steady_clock::now();
+        if (now >= *slot_deadline) {
+            co_return make_error_code(errc::timeout);
+        }
+        pending_slot_freed_.reset();
+        const auto wait_ec = co_await pending_slot_freed_.async_wait(*slot_deadline - now);
+        if (wait_ec) {
+            co_return wait_ec;
+        }
+        if (stop_requested_) {
+            co_return make_error_code(errc::cancelled);
+        }
+    }
+
+    auto send_ec = co_await async_send_message_(req);
+    if (send_ec) {
+        SPDLOG_DEBUG("protocol async_request(HSMS) send failed: sb={} ec={}({})",
+                     req.system_bytes,
+                     send_ec.value(),
+                     send_ec.message());
+        {
+            std::lock_guard lk(pending_mu_);
+            pending_.release(handle);
+        }
+        pending_slot_freed_.set();
+    }
+    co_return send_ec;
+}
+
+asio::awaitable<std::pair<std::error_code, DataMessage>>
+Session::await_hsms_reply_(PendingHandle handle, secs::core::duration t3) {
+    // 条目只由本协程 release，slab 地址稳定：可以在锁外等待。
+    secs::core::Event *ready = nullptr;
     {
         std::lock_guard lk(pending_mu_);
-        moved.swap(pending_);
+        ready = &pending_.get(handle)->ready;
+    }
+    auto wait_ec = co_await ready->async_wait(t3);
+
+    std::lock_guard lk(pending_mu_);
+    co_return finish_pending_(handle, wait_ec);
+}
+
+bool Session::hsms_link_selected_() const noexcept {
+    if (hsms_) {
+        return hsms_->is_selected();
+    }
+    if (hsms_gs_) {
+        return hsms_gs_->is_selected(hsms_session_id_);
+    }
+    return false;
+}
+
+bool Session::should_spool_(std::uint8_t stream, std::uint8_t function) const noexcept {
+    const auto &spool = options_.spool;
+    if (backend_ != Backend::hsms || !spool || !spool->is_open() ||
+        !spool->accepts(stream, function)) {
+        return false;
+    }
+    // spool 非空时新消息也要排在其后，避免补发期间乱序。
+    return !hsms_link_selected_() || !spool->empty();
+}
+
+asio::awaitable<std::error_code>
+Session::async_request_pipeline(std::span<const PipelineRequest> requests,
+                                PipelineResponseFn on_response,
+                                std::size_t window,
+                                std::optional<secs::core::duration> timeout) {
+    const auto ex = co_await asio::this_coro::executor;
+    if (ex == executor_) {
+        co_return co_await async_request_pipeline_impl_(
+            requests, on_response, window, timeout);
+    }
+
+    try {
+        // on_response 按引用传入 impl：本协程挂起等待期间一直有效。
+        co_return co_await asio::co_spawn(
+            executor_,
+            async_request_pipeline_impl_(requests, on_response, window, timeout),
+            asio::use_awaitable);
+    } catch (const std::bad_alloc &) {
+        co_return make_error_code(errc::out_of_memory);
+    } catch (...) {
+        co_return make_error_code(errc::invalid_argument);
+    }
+}
+
+asio::awaitable<std::vector<std::pair<std::error_code, DataMessage>>>
+Session::async_request_all(std::span<const PipelineRequest> requests,
+                           std::size_t window,
+                           std::optional<secs::core::duration> timeout) {
+    std::vector<std::pair<std::error_code, DataMessage>> results;
+    try {
+        results.resize(requests.size());
+    } catch (...) {
+        co_return results;
+    }
+    std::size_t delivered = 0;
+    const auto ec = co_await async_request_pipeline(
+        requests,
+        [&results, &delivered](std::size_t index, std::error_code item_ec, DataMessage &rsp) {
+            results[index].first = item_ec;
+            results[index].second = std::move(rsp);
+            ++delivered;
+        },
+        window,
+        timeout);
+    // 回调按顺序交付；流水线未能启动（如 co_spawn 失败）时，其余项标记为该错误。
+    for (std::size_t i = delivered; i < results.size(); ++i) {
+        results[i].first = ec;
+    }
+    co_return results;
+}
+
+asio::awaitable<std::error_code>
+Session::async_request_pipeline_impl_(std::span<const PipelineRequest> requests,
+                                      const PipelineResponseFn &on_response,
+                                      std::size_t window,
+                                      std::optional<secs::core::duration> timeout) {
+    if (window == 0) {
+        window = 1;
+    }
+
+    std::error_code first_ec{};
+    const auto deliver = [&](std::size_t index, std::error_code ec, DataMessage &rsp) {
+        if (ec && !first_ec) {
+            first_ec = ec;
+        }
+        if (!on_response) {
+            return;
+        }
+        try {
+            on_response(index, ec, rsp);
+        } catch (...) {
+            // 回调异常不应打断流水线（其余回应仍需交付）。
+        }
+    };
+
+    // SECS-I 半双工：同一时刻只能有一个事务，逐条请求。
+    if (backend_ != Backend::hsms) {
+        for (std::size_t i = 0; i < requests.size(); ++i) {
+            const auto &item = requests[i];
+            auto [ec, rsp] =
+                co_await async_request_impl_(
+                    item.stream,
+                    item.function,
+                    secs::core::SharedBytes::copy(item.body, secs::hsms::kFramePrefixSize),
+                    timeout);
+            deliver(i, ec, rsp);
+        }
+        co_return first_ec;
+    }
+
+    /*
+     * HSMS 流水线：
+     * - 发送在本协程内按提交顺序串行进行；W=1 回应由独立协程等待，最多 window 条在途；
+     * - 结果写入按提交顺序排列的 slots，只有队首已完成时才交付，保证回调顺序；
+     * - 在途协程引用本协程的局部变量，返回前必须等它们全部结束。
+     */
+    struct Slot final {
+        bool done{false};
+        std::error_code ec{};
+        DataMessage response{};
+    };
+    std::deque<Slot> slots;
+    std::size_t delivered = 0;
+    std::size_t waiting = 0;
+    secs::core::Event wake{};
+
+    const auto flush = [&]() {
+        while (!slots.empty() && slots.front().done) {
+            auto &front = slots.front();
+            deliver(delivered, front.ec, front.response);
+            slots.pop_front();
+            ++delivered;
+        }
+    };
+
+    const auto t3 = timeout.value_or(options_.t3);
+    ensure_hsms_run_loop_started_();
+
+    for (const auto &item : requests) {
+        while (waiting >= window) {
+            wake.reset();
+            (void)co_await wake.async_wait();
+        }
+        flush();
+
+        auto &slot = slots.emplace_back();
+
+        // 参数非法/需写 spool/已 stop：与 async_request 相同的快速路径，不占用窗口。
+        if (stop_requested_ || !is_valid_stream(item.stream) ||
+            !is_primary_function(item.function) ||
+            !can_compute_secondary_function(item.function) ||
+            should_spool_(item.stream, item.function)) {
+            auto [ec, rsp] = co_await async_request_impl_(
+                item.stream,
+                item.function,
+                secs::core::SharedBytes::copy(item.body, secs::hsms::kFramePrefixSize),
+                timeout);
+            slot.ec = ec;
+            slot.response = std::move(rsp);
+            slot.done = true;
+            continue;
+        }
+
+        std::uint32_t sb = 0;
+        if (const auto alloc_ec = system_bytes_.allocate(sb)) {
+            slot.ec = alloc_ec;
+            slot.done = true;
+            continue;
+        }
+
+        DataMessage req{};
+        req.stream = item.stream;
+        req.function = item.function;
+        req.w_bit = true;
+        req.system_bytes = sb;
+        req.shared_body =
+            secs::core::SharedBytes::copy(item.body, secs::hsms::kFramePrefixSize);
+
+        const auto started = secs::core::steady_clock::now();
+        if (metrics_) {
+            metrics_->requests.add();
+        }
+
+        PendingHandle handle{};
+        const auto send_ec = co_await begin_hsms_request_(
+            req, secondary_function(req.function), handle, started + t3);
+        if (send_ec) {
+            system_bytes_.release(sb);
+            note_request_done_(send_ec, started);
+            slot.ec = send_ec;
+            slot.done = true;
+            continue;
+        }
+
+        ++waiting;
+        asio::co_spawn(
+            executor_,
+            [this, &slot, &waiting, &wake, handle, sb, t3, started]()
+                -> asio::awaitable<void> {
+                auto [ec, rsp] = co_await await_hsms_reply_(handle, t3);
+                system_bytes_.release(sb);
+                note_request_done_(ec, started);
+                slot.ec = ec;
+                slot.response = std::move(rsp);
+                slot.done = true;
+                --waiting;
+                wake.set();
+            },
+            asio::detached);
+    }
+
+    while (waiting > 0) {
+        wake.reset();
+        (void)co_await wake.async_wait();
+    }
+    flush();
+
+    SPDLOG_DEBUG("protocol request pipeline: n={} window={} ec={}({})",
+                 requests.size(),
+                 window,
+                 first_ec.value(),
+                 first_ec.message());
+    co_return first_ec;
+}
+
+asio::awaitable<std::pair<std::error_code, std::size_t>>
+Session::async_drain_spool(std::size_t window) {
+    const auto ex = co_await asio::this_coro::executor;
+    if (ex == executor_) {
+        co_return co_await async_drain_spool_impl_(window);
+    }
+
+    try {
+        co_return co_await asio::co_spawn(
+            executor_, async_drain_spool_impl_(window), asio::use_awaitable);
+    } catch (const std::bad_alloc &) {
+        co_return std::pair{make_error_code(errc::out_of_memory), std::size_t{0}};
+    } catch (...) {
+        co_return std::pair{make_error_code(errc::invalid_argument), std::size_t{0}};
     }
+}
 
-    for (auto &[sb, pending] : moved) {
-        (void)sb;
-        pending->ec = reason;
-        pending->ready.cancel();
+asio::awaitable<std::pair<std::error_code, std::size_t>>
+Session::async_drain_spool_impl_(std::size_t window) {
+    const auto spool = options_.spool;
+    if (backend_ != Backend::hsms || !spool || !spool->is_open()) {
+        co_return std::pair{make_error_code(errc::invalid_argument), std::size_t{0}};
     }
+    if (stop_requested_) {
+        co_return std::pair{make_error_code(errc::cancelled), std::size_t{0}};
+    }
+    if (!hsms_link_selected_()) {
+        co_return std::pair{make_error_code(errc::invalid_argument), std::size_t{0}};
+    }
+    if (window == 0) {
+        window = 1;
+    }
+    ensure_hsms_run_loop_started_();
+
+    /*
+     * 流水线补发：
+     * - 发送在本协程内按 spool 顺序串行进行（写入连接的顺序 = spool 顺序）；
+     * - W=1 消息发出后由独立协程等待回应，最多 window 条同时在途；
+     * - 确认严格按顺序：只有队首连续完成的消息才 consume_through，
+     *   中途失败时从失败那条起全部保留。
+     * 在途协程引用本协程的局部变量，因此返回前必须等它们全部结束。
+     */
+    struct Inflight final {
+        std::uint64_t sequence{0};
+        bool done{false};
+        std::error_code ec{};
+    };
+    std::deque<Inflight> inflight;
+    std::size_t waiting = 0;
+    secs::core::Event wake{};
+    std::error_code first_ec{};
+    std::size_t confirmed = 0;
+
+    const auto commit = [&]() noexcept {
+        std::optional<std::uint64_t> last;
+        while (!inflight.empty() && inflight.front().done && !inflight.front().ec) {
+            last = inflight.front().sequence;
+            inflight.pop_front();
+            ++confirmed;
+            if (metrics_) {
+                metrics_->spool_drained.add();
+            }
+        }
+        if (last.has_value()) {
+            (void)spool->consume_through(*last);
+        }
+    };
+
+    spool->rewind();
+    SpoolMessage m;
+    while (!first_ec && !stop_requested_) {
+        while (waiting >= window && !first_ec) {
+            wake.reset();
+            (void)co_await wake.async_wait();
+        }
+        commit();
+        if (first_ec) {
+            break;
+        }
+        if (!spool->next(m)) {
+            first_ec = spool->last_error();
+            break;
+        }
+
+        std::uint32_t sb = 0;
+        if (const auto alloc_ec = system_bytes_.allocate(sb)) {
+            first_ec = alloc_ec;
+            break;
+        }
+        DataMessage req{};
+        req.stream = m.stream;
+        req.function = m.function;
+        req.w_bit = m.w_bit && can_compute_secondary_function(m.function);
+        req.system_bytes = sb;
+        // 接管 spool 读出的 vector，写出时不再拷贝。
+        req.shared_body = secs::core::SharedBytes::adopt(std::move(m.body));
+
+        inflight.push_back(Inflight{m.sequence});
+        auto &slot = inflight.back();
+
+        if (!req.w_bit) {
+            slot.ec = co_await async_send_message_(req);
+            slot.done = true;
+            system_bytes_.release(sb);
+            if (slot.ec) {
+                first_ec = slot.ec;
+            }
+            commit();
+            continue;
+        }
+
+        PendingHandle handle{};
+        const auto send_ec =
+            co_await begin_hsms_request_(req, secondary_function(req.function), handle);
+        if (send_ec) {
+            system_bytes_.release(sb);
+            slot.ec = send_ec;
+            slot.done = true;
+            first_ec = send_ec;
+            break;
+        }
+
+        ++waiting;
+        asio::co_spawn(
+            executor_,
+            [this, &slot, &waiting, &wake, &first_ec, handle, sb]()
+                -> asio::awaitable<void> {
+                auto [ec, rsp] = co_await await_hsms_reply_(handle, options_.t3);
+                (void)rsp;
+                system_bytes_.release(sb);
+                slot.ec = ec;
+                slot.done = true;
+                if (ec && !first_ec) {
+                    first_ec = ec;
+                }
+                --waiting;
+                wake.set();
+            },
+            asio::detached);
+    }
+
+    while (waiting > 0) {
+        wake.reset();
+        (void)co_await wake.async_wait();
+    }
+    commit();
+    if (!inflight.empty()) {
+        // 失败那条及之后的消息保留：下次补发从队首重新读取。
+        spool->rewind();
+    }
+    if (!first_ec && stop_requested_) {
+        first_ec = make_error_code(errc::cancelled);
+    }
+
+    SPDLOG_DEBUG("protocol drain spool: confirmed={} remaining={} ec={}({})",
+                 confirmed,
+                 spool->size(),
+                 first_ec.value(),
+                 first_ec.message());
+    co_return std::pair{first_ec, confirmed};
 }
 
 } // namespace secs::protocol
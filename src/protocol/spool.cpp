@@ -0,0 +1,945 @@
+#include "secs/protocol/spool.hpp"
+
+#include "secs/core/error.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <new>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace secs::protocol {
+namespace {
+
+/*
+ * Spool 实现要点：
+ *
+ * - 写：记录头 + body 两次 fwrite 后 fflush（进程崩溃后内容仍在页缓存/磁盘上），
+ *   sync_writes=true 时再 fsync；写失败时把段文件截回写入前的长度。
+ * - 读：独立的只读 FILE，顺序读取时不做 fseek，避免丢弃 stdio 读缓冲。
+ * - 队首：每次确认只改写 mmap 索引中的一个槽（无系统调用）；两个槽交替使用，
+ *   generation 递增，恢复时选 CRC 有效且 generation 最大的槽。
+ * - 序号：sequence 每条记录 +1，同一段内连续；段内校验失败即截断，因此段内
+ *   “记录数 = 末序号 - 首序号 + 1”，队首段的未消费数可直接由序号算出。
+ */
+
+using secs::core::errc;
+using secs::core::make_error_code;
+namespace fs = std::filesystem;
+
+constexpr std::array<core::byte, 8> kIndexMagic{'S', 'E', 'C', 'S', 'S', 'P', 'I', '\0'};
+constexpr std::array<core::byte, 8> kSegmentMagic{'S', 'E', 'C', 'S', 'S', 'P', 'L', '\0'};
+constexpr std::size_t kIndexHeaderSize = 16;
+constexpr std::size_t kIndexSlotSize = 40;
+constexpr std::size_t kIndexSlotCrcOffset = 32;
+constexpr const char *kIndexFileName = "spool.idx";
+constexpr const char *kSegmentSuffix = ".seg";
+constexpr std::uint8_t kFlagWBit = 0x01;
+
+static_assert(kIndexHeaderSize + 2 * kIndexSlotSize == kSpoolIndexFileSize);
+
+void put_u16_be(core::byte *p, std::uint16_t v) noexcept {
+    p[0] = static_cast<core::byte>(v >> 8U);
+    p[1] = static_cast<core::byte>(v);
+}
+
+void put_u32_be(core::byte *p, std::uint32_t v) noexcept {
+    for (int i = 3; i >= 0; --i) {
+        p[i] = static_cast<core::byte>(v);
+        v >>= 8U;
+    }
+}
+
+void put_u64_be(core::byte *p, std::uint64_t v) noexcept {
+    for (int i = 7; i >= 0; --i) {
+        p[i] = static_cast<core::byte>(v);
+        v >>= 8U;
+    }
+}
+
+[[nodiscard]] std::uint16_t get_u16_be(const core::byte *p) noexcept {
+    return static_cast<std::uint16_t>((static_cast<std::uint16_t>(p[0]) << 8U) | p[1]);
+}
+
+[[nodiscard]] std::uint32_t get_u32_be(const core::byte *p) noexcept {
+    std::uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) {
+        v = (v << 8U) | p[i];
+    }
+    return v;
+}
+
+[[nodiscard]] std::uint64_t get_u64_be(const core::byte *p) noexcept {
+    std::uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) {
+        v = (v << 8U) | p[i];
+    }
+    return v;
+}
+
+// CRC-32（IEEE 802.3，反射多项式 0xEDB88320），查表实现。
+constexpr std::array<std::uint32_t, 256> kCrcTable = [] {
+    std::array<std::uint32_t, 256> t{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1U) ? (0xEDB88320U ^ (c >> 1U)) : (c >> 1U);
+        }
+        t[i] = c;
+    }
+    return t;
+}();
+
+[[nodiscard]] std::uint32_t crc32_update(std::uint32_t crc,
+                                         const core::byte *p,
+                                         std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        crc = kCrcTable[(crc ^ p[i]) & 0xFFU] ^ (crc >> 8U);
+    }
+    return crc;
+}
+
+// 记录 CRC：记录头（crc 字段按 0 计）+ body。
+[[nodiscard]] std::uint32_t record_crc(const core::byte *header,
+                                       const core::byte *body,
+                                       std::size_t body_len) noexcept {
+    constexpr core::byte kZero[4] = {0, 0, 0, 0};
+    std::uint32_t c = 0xFFFFFFFFU;
+    c = crc32_update(c, header, 4);
+    c = crc32_update(c, kZero, 4);
+    c = crc32_update(c, header + 8, kSpoolRecordHeaderSize - 8);
+    c = crc32_update(c, body, body_len);
+    return ~c;
+}
+
+struct RecordHeader final {
+    std::uint32_t body_len{0};
+    std::uint32_t crc{0};
+    std::uint64_t sequence{0};
+    std::uint8_t stream{0};
+    std::uint8_t function{0};
+    std::uint8_t flags{0};
+};
+
+void encode_record_header(core::byte *p, const RecordHeader &h) noexcept {
+    std::memset(p, 0, kSpoolRecordHeaderSize);
+    put_u32_be(p, h.body_len);
+    put_u64_be(p + 8, h.sequence);
+    p[16] = h.stream;
+    p[17] = h.function;
+    p[18] = h.flags;
+}
+
+[[nodiscard]] RecordHeader decode_record_header(const core::byte *p) noexcept {
+    RecordHeader h{};
+    h.body_len = get_u32_be(p);
+    h.crc = get_u32_be(p + 4);
+    h.sequence = get_u64_be(p + 8);
+    h.stream = p[16];
+    h.function = p[17];
+    h.flags = p[18];
+    return h;
+}
+
+void sync_file(std::FILE *f) noexcept {
+#if defined(_WIN32)
+    (void)::_commit(::_fileno(f));
+#else
+    (void)::fsync(::fileno(f));
+#endif
+}
+
+[[nodiscard]] bool parse_segment_name(const fs::path &path, std::uint64_t &id) {
+    if (path.extension() != kSegmentSuffix) {
+        return false;
+    }
+    const auto stem = path.stem().string();
+    if (stem.size() != 16) {
+        return false;
+    }
+    std::uint64_t v = 0;
+    for (const char c : stem) {
+        std::uint64_t d = 0;
+        if (c >= '0' && c <= '9') {
+            d = static_cast<std::uint64_t>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            d = static_cast<std::uint64_t>(c - 'a' + 10);
+        } else {
+            return false;
+        }
+        v = (v << 4U) | d;
+    }
+    id = v;
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief spool.idx：队首位置的 A/B 双槽（POSIX 下 MAP_SHARED 映射，写槽即落到页缓存）。
+ */
+class Spool::IndexFile final {
+public:
+    IndexFile() = default;
+    IndexFile(const IndexFile &) = delete;
+    IndexFile &operator=(const IndexFile &) = delete;
+    ~IndexFile() { close(); }
+
+    [[nodiscard]] std::error_code open(const std::string &path) noexcept {
+        close();
+        bool fresh = false;
+#if defined(_WIN32)
+        file_ = std::fopen(path.c_str(), "r+b");
+        if (file_ == nullptr) {
+            file_ = std::fopen(path.c_str(), "w+b");
+            if (file_ == nullptr) {
+                return {errno, std::generic_category()};
+            }
+        }
+        shadow_.fill(0);
+        const auto n = std::fread(shadow_.data(), 1, shadow_.size(), file_);
+        fresh = n != shadow_.size();
+        data_ = shadow_.data();
+#else
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return {errno, std::generic_category()};
+        }
+        struct ::stat st {};
+        if (::fstat(fd, &st) != 0) {
+            const int err = errno;
+            ::close(fd);
+            return {err, std::generic_category()};
+        }
+        fresh = static_cast<std::size_t>(st.st_size) != kSpoolIndexFileSize;
+        if (fresh && ::ftruncate(fd, static_cast<off_t>(kSpoolIndexFileSize)) != 0) {
+            const int err = errno;
+            ::close(fd);
+            return {err, std::generic_category()};
+        }
+        void *p = ::mmap(nullptr, kSpoolIndexFileSize, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd, 0);
+        const int err = errno;
+        ::close(fd); // 映射建立后即可关闭 fd
+        if (p == MAP_FAILED) {
+            return {err, std::generic_category()};
+        }
+        data_ = static_cast<core::byte *>(p);
+#endif
+        if (!fresh &&
+            std::memcmp(data_, kIndexMagic.data(), kIndexMagic.size()) != 0) {
+            // 长度正确但不是 spool 索引：不覆盖未知文件。
+            close();
+            return make_error_code(errc::invalid_argument);
+        }
+        if (fresh) {
+            std::memset(data_, 0, kSpoolIndexFileSize);
+            std::memcpy(data_, kIndexMagic.data(), kIndexMagic.size());
+            put_u16_be(data_ + 8, kSpoolVersion);
+            write_through_(0, kSpoolIndexFileSize);
+        }
+        return {};
+    }
+
+    // 读取有效槽中 generation 最大者；两个槽都无效时返回 false。
+    [[nodiscard]] bool load(Position &out) noexcept {
+        bool found = false;
+        for (std::size_t i = 0; i < 2; ++i) {
+            const core::byte *slot = data_ + kIndexHeaderSize + i * kIndexSlotSize;
+            const auto generation = get_u64_be(slot);
+            if (generation == 0) {
+                continue;
+            }
+            std::uint32_t c = 0xFFFFFFFFU;
+            c = ~crc32_update(c, slot, kIndexSlotCrcOffset);
+            if (c != get_u32_be(slot + kIndexSlotCrcOffset)) {
+                continue;
+            }
+            if (!found || generation > generation_) {
+                generation_ = generation;
+                out.segment = get_u64_be(slot + 8);
+                out.offset = get_u64_be(slot + 16);
+                out.sequence = get_u64_be(slot + 24);
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    void store(const Position &pos) noexcept {
+        ++generation_;
+        const std::size_t off =
+            kIndexHeaderSize + static_cast<std::size_t>(generation_ & 1U) * kIndexSlotSize;
+        core::byte *slot = data_ + off;
+        put_u64_be(slot, generation_);
+        put_u64_be(slot + 8, pos.segment);
+        put_u64_be(slot + 16, pos.offset);
+        put_u64_be(slot + 24, pos.sequence);
+        std::uint32_t c = 0xFFFFFFFFU;
+        c = ~crc32_update(c, slot, kIndexSlotCrcOffset);
+        put_u32_be(slot + kIndexSlotCrcOffset, c);
+        put_u32_be(slot + kIndexSlotCrcOffset + 4, 0);
+        write_through_(off, kIndexSlotSize);
+    }
+
+    void sync() noexcept {
+#if defined(_WIN32)
+        if (file_ != nullptr) {
+            sync_file(file_);
+        }
+#else
+        if (data_ != nullptr) {
+            (void)::msync(data_, kSpoolIndexFileSize, MS_SYNC);
+        }
+#endif
+    }
+
+    void close() noexcept {
+#if defined(_WIN32)
+        if (file_ != nullptr) {
+            (void)std::fclose(file_);
+            file_ = nullptr;
+        }
+#else
+        if (data_ != nullptr) {
+            ::munmap(data_, kSpoolIndexFileSize);
+        }
+#endif
+        data_ = nullptr;
+    }
+
+private:
+    // 非映射平台：把改动的区间写回文件。
+    void write_through_(std::size_t off, std::size_t n) noexcept {
+#if defined(_WIN32)
+        if (std::fseek(file_, static_cast<long>(off), SEEK_SET) == 0) {
+            (void)std::fwrite(data_ + off, 1, n, file_);
+            (void)std::fflush(file_);
+        }
+#else
+        (void)off;
+        (void)n;
+#endif
+    }
+
+    core::byte *data_{nullptr};
+    std::uint64_t generation_{0};
+#if defined(_WIN32)
+    std::FILE *file_{nullptr};
+    std::array<core::byte, kSpoolIndexFileSize> shadow_{};
+#endif
+};
+
+Spool::Spool(SpoolOptions options) : options_(std::move(options)) {}
+
+Spool::~Spool() { close(); }
+
+std::string Spool::segment_path_(std::uint64_t id) const {
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::string name(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        name[static_cast<std::size_t>(i)] = kHex[id & 0x0FU];
+        id >>= 4U;
+    }
+    name += kSegmentSuffix;
+    return (fs::path(options_.directory) / name).string();
+}
+
+std::error_code Spool::open() noexcept {
+    if (open_) {
+        return {};
+    }
+    if (options_.directory.empty() ||
+        options_.segment_bytes < kSpoolSegmentHeaderSize + kSpoolRecordHeaderSize ||
+        options_.max_bytes / 2 < options_.segment_bytes) {
+        return make_error_code(errc::invalid_argument);
+    }
+
+    try {
+        std::error_code ec;
+        fs::create_directories(options_.directory, ec);
+        if (ec) {
+            return ec;
+        }
+
+        index_ = std::make_unique<IndexFile>();
+        ec = index_->open((fs::path(options_.directory) / kIndexFileName).string());
+        if (ec) {
+            index_.reset();
+            return ec;
+        }
+
+        ec = recover_();
+        if (ec) {
+            close();
+            return ec;
+        }
+    } catch (const std::bad_alloc &) {
+        close();
+        return make_error_code(errc::out_of_memory);
+    } catch (...) {
+        close();
+        return make_error_code(errc::invalid_argument);
+    }
+
+    open_ = true;
+    return {};
+}
+
+std::error_code Spool::recover_() noexcept {
+    Position saved{};
+    const bool has_saved = index_->load(saved);
+
+    std::vector<std::uint64_t> ids;
+    std::error_code ec;
+    for (fs::directory_iterator it(options_.directory, ec), end; !ec && it != end;
+         it.increment(ec)) {
+        std::uint64_t id = 0;
+        if (it->is_regular_file() && parse_segment_name(it->path(), id)) {
+            ids.push_back(id);
+        }
+    }
+    if (ec) {
+        return ec;
+    }
+    std::sort(ids.begin(), ids.end());
+
+    segments_.clear();
+    disk_bytes_ = 0;
+    next_seq_ = has_saved ? std::max<std::uint64_t>(saved.sequence, 1) : 1;
+
+    std::array<core::byte, kSpoolRecordHeaderSize> rh{};
+    for (const auto id : ids) {
+        const auto path = segment_path_(id);
+        if (has_saved && id < saved.segment) {
+            // 队首之前的段已全部确认（删除前崩溃留下的残留）。
+            fs::remove(path, ec);
+            continue;
+        }
+
+        std::FILE *f = std::fopen(path.c_str(), "rb");
+        if (f == nullptr) {
+            return {errno, std::generic_category()};
+        }
+        std::array<core::byte, kSpoolSegmentHeaderSize> sh{};
+        const bool header_ok =
+            std::fread(sh.data(), 1, sh.size(), f) == sh.size() &&
+            std::memcmp(sh.data(), kSegmentMagic.data(), kSegmentMagic.size()) == 0 &&
+            get_u16_be(sh.data() + 10) == kSpoolSegmentHeaderSize;
+        if (!header_ok) {
+            // 段头都没写完：创建段时崩溃，直接丢弃。
+            (void)std::fclose(f);
+            fs::remove(path, ec);
+            continue;
+        }
+
+        Segment seg{};
+        seg.id = id;
+        std::uint64_t offset = kSpoolSegmentHeaderSize;
+        for (;;) {
+            if (std::fread(rh.data(), 1, rh.size(), f) != rh.size()) {
+                break;
+            }
+            const auto h = decode_record_header(rh.data());
+            try {
+                scratch_.resize(h.body_len);
+            } catch (...) {
+                break; // 长度字段损坏（巨大值）：按残缺记录截断
+            }
+            if (std::fread(scratch_.data(), 1, h.body_len, f) != h.body_len ||
+                record_crc(rh.data(), scratch_.data(), h.body_len) != h.crc) {
+                break;
+            }
+            if (seg.records != 0 && h.sequence != seg.first_seq + seg.records) {
+                break;
+            }
+            if (seg.records == 0) {
+                seg.first_seq = h.sequence;
+            }
+            ++seg.records;
+            offset += kSpoolRecordHeaderSize + h.body_len;
+            next_seq_ = std::max(next_seq_, h.sequence + 1);
+        }
+        (void)std::fclose(f);
+        scratch_.clear();
+
+        if (fs::file_size(path, ec) != offset || ec) {
+            // 截掉写到一半的尾记录（或校验失败之后的全部内容）。
+            fs::resize_file(path, offset, ec);
+            if (ec) {
+                return ec;
+            }
+        }
+        if (seg.records == 0) {
+            seg.first_seq = next_seq_;
+        }
+        seg.bytes = offset;
+        disk_bytes_ += offset;
+        segments_.push_back(seg);
+    }
+
+    // 确定队首：索引有效且指向现存段内时采用，否则从最早的段开始。
+    Position head{};
+    const Segment *head_seg = nullptr;
+    if (has_saved) {
+        for (const auto &seg : segments_) {
+            if (seg.id == saved.segment) {
+                head_seg = &seg;
+                break;
+            }
+        }
+    }
+    if (head_seg != nullptr && saved.offset >= kSpoolSegmentHeaderSize &&
+        saved.offset <= head_seg->bytes && saved.sequence >= head_seg->first_seq &&
+        saved.sequence <= head_seg->first_seq + head_seg->records) {
+        head = saved;
+    } else if (head_seg != nullptr && saved.offset > head_seg->bytes) {
+        // 索引指向被截掉的尾部：该段剩余内容视为已确认。
+        head = {head_seg->id, head_seg->bytes, head_seg->first_seq + head_seg->records};
+    } else if (!segments_.empty()) {
+        const auto &front = segments_.front();
+        head = {front.id, kSpoolSegmentHeaderSize, front.first_seq};
+    }
+
+    if (segments_.empty()) {
+        const std::uint64_t id = has_saved ? saved.segment + 1 : 1;
+        ec = start_segment_(id);
+        if (ec) {
+            return ec;
+        }
+        head = {id, kSpoolSegmentHeaderSize, next_seq_};
+    } else {
+        write_file_ = std::fopen(segment_path_(segments_.back().id).c_str(), "ab");
+        if (write_file_ == nullptr) {
+            return {errno, std::generic_category()};
+        }
+    }
+
+    std::uint64_t total = 0;
+    for (const auto &seg : segments_) {
+        total += seg.records;
+    }
+    size_ = total - (head.sequence - segments_.front().first_seq);
+
+    head_ = head;
+    normalize_head_();
+    read_ = head_;
+    outstanding_.clear();
+    persist_head_();
+    return {};
+}
+
+std::error_code Spool::start_segment_(std::uint64_t id) noexcept {
+    if (write_file_ != nullptr) {
+        (void)std::fclose(write_file_);
+        write_file_ = nullptr;
+    }
+
+    const auto path = segment_path_(id);
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    if (f == nullptr) {
+        return {errno, std::generic_category()};
+    }
+    std::array<core::byte, kSpoolSegmentHeaderSize> header{};
+    std::memcpy(header.data(), kSegmentMagic.data(), kSegmentMagic.size());
+    put_u16_be(header.data() + 8, kSpoolVersion);
+    put_u16_be(header.data() + 10, static_cast<std::uint16_t>(kSpoolSegmentHeaderSize));
+    if (std::fwrite(header.data(), 1, header.size(), f) != header.size() ||
+        std::fflush(f) != 0) {
+        (void)std::fclose(f);
+        std::error_code ignored;
+        fs::remove(path, ignored);
+        return std::make_error_code(std::errc::io_error);
+    }
+    if (options_.sync_writes) {
+        sync_file(f);
+    }
+
+    Segment seg{};
+    seg.id = id;
+    seg.bytes = kSpoolSegmentHeaderSize;
+    seg.first_seq = next_seq_;
+    try {
+        segments_.push_back(seg);
+    } catch (...) {
+        (void)std::fclose(f);
+        return make_error_code(errc::out_of_memory);
+    }
+    write_file_ = f;
+    disk_bytes_ += kSpoolSegmentHeaderSize;
+    return {};
+}
+
+Spool::Segment *Spool::find_segment_(std::uint64_t id) noexcept {
+    for (auto &seg : segments_) {
+        if (seg.id == id) {
+            return &seg;
+        }
+    }
+    return nullptr;
+}
+
+void Spool::close_read_file_() noexcept {
+    if (read_file_ != nullptr) {
+        (void)std::fclose(read_file_);
+        read_file_ = nullptr;
+    }
+    read_file_pos_valid_ = false;
+}
+
+void Spool::persist_head_() noexcept {
+    if (!index_) {
+        return;
+    }
+    index_->store(head_);
+    if (options_.sync_writes) {
+        index_->sync();
+    }
+}
+
+void Spool::normalize_head_() noexcept {
+    // 队首之前的段、以及已消费完且后面还有段的队首段：删除，队首移到下一段开头。
+    while (segments_.size() > 1) {
+        const auto &front = segments_.front();
+        const bool behind_head = front.id < head_.segment;
+        if (!behind_head && (front.id != head_.segment || head_.offset < front.bytes)) {
+            break;
+        }
+        std::error_code ignored;
+        fs::remove(segment_path_(front.id), ignored);
+        if (read_file_ != nullptr && read_file_id_ == front.id) {
+            close_read_file_();
+        }
+        disk_bytes_ -= front.bytes;
+        segments_.pop_front();
+
+        if (!behind_head) {
+            const auto &next = segments_.front();
+            head_ = {next.id, kSpoolSegmentHeaderSize, next.first_seq};
+        }
+    }
+    if (read_.segment < head_.segment ||
+        (read_.segment == head_.segment && read_.offset < head_.offset)) {
+        read_ = head_;
+    }
+}
+
+void Spool::drop_head_segment_() noexcept {
+    const auto front = segments_.front();
+    const auto end_seq = front.first_seq + front.records;
+    const auto unconsumed = end_seq > head_.sequence ? end_seq - head_.sequence : 0;
+    dropped_ += unconsumed;
+    size_ -= std::min(size_, unconsumed);
+
+    while (!outstanding_.empty() && outstanding_.front().segment == front.id) {
+        outstanding_.pop_front();
+    }
+    // 让 normalize_head_ 删除该段：队首视为已到段尾。
+    head_ = {front.id, front.bytes, end_seq};
+    normalize_head_();
+    persist_head_();
+}
+
+void Spool::close() noexcept {
+    if (write_file_ != nullptr) {
+        (void)std::fflush(write_file_);
+        if (options_.sync_writes) {
+            sync_file(write_file_);
+        }
+        (void)std::fclose(write_file_);
+        write_file_ = nullptr;
+    }
+    close_read_file_();
+    if (index_) {
+        if (open_) {
+            index_->sync();
+        }
+        index_.reset();
+    }
+    segments_.clear();
+    outstanding_.clear();
+    open_ = false;
+}
+
+std::error_code Spool::enable_stream(std::uint8_t stream) noexcept {
+    if (stream == 1 || stream > 127) {
+        return make_error_code(errc::invalid_argument);
+    }
+    for (std::size_t f = 1; f < 256; f += 2) {
+        filter_[stream].set(f);
+    }
+    return {};
+}
+
+std::error_code Spool::enable(std::uint8_t stream, std::uint8_t function) noexcept {
+    if (stream == 1 || stream > 127 || (function & 1U) == 0) {
+        return make_error_code(errc::invalid_argument);
+    }
+    filter_[stream].set(function);
+    return {};
+}
+
+void Spool::disable_stream(std::uint8_t stream) noexcept {
+    if (stream <= 127) {
+        filter_[stream].reset();
+    }
+}
+
+void Spool::clear_filter() noexcept {
+    for (auto &bits : filter_) {
+        bits.reset();
+    }
+}
+
+bool Spool::accepts(std::uint8_t stream, std::uint8_t function) const noexcept {
+    return stream <= 127 && filter_[stream].test(function);
+}
+
+std::error_code Spool::push(std::uint8_t stream,
+                            std::uint8_t function,
+                            bool w_bit,
+                            core::bytes_view body) noexcept {
+    if (!open_ || write_file_ == nullptr) {
+        return make_error_code(errc::invalid_argument);
+    }
+    if (body.size() > std::numeric_limits<std::uint32_t>::max()) {
+        return make_error_code(errc::buffer_overflow);
+    }
+    const std::uint64_t need = kSpoolRecordHeaderSize + body.size();
+
+    const bool rotate = segments_.back().records != 0 &&
+                        segments_.back().bytes + need > options_.segment_bytes;
+    const std::uint64_t extra = rotate ? kSpoolSegmentHeaderSize : 0;
+    if (!options_.overwrite_when_full && disk_bytes_ + extra + need > options_.max_bytes) {
+        ++rejected_;
+        return make_error_code(errc::buffer_overflow);
+    }
+
+    if (rotate) {
+        const auto ec = start_segment_(segments_.back().id + 1);
+        if (ec) {
+            last_error_ = ec;
+            return ec;
+        }
+        // 旧写入段可能已被全部确认：此时可以删除。
+        normalize_head_();
+    }
+
+    // 覆盖模式：按段丢弃最旧的消息，直到放得下（当前写入段不丢）。
+    while (disk_bytes_ + need > options_.max_bytes && segments_.size() > 1) {
+        drop_head_segment_();
+    }
+    if (disk_bytes_ + need > options_.max_bytes) {
+        ++rejected_;
+        return make_error_code(errc::buffer_overflow);
+    }
+
+    auto &seg = segments_.back();
+    RecordHeader h{};
+    h.body_len = static_cast<std::uint32_t>(body.size());
+    h.sequence = next_seq_;
+    h.stream = stream;
+    h.function = function;
+    h.flags = w_bit ? kFlagWBit : 0;
+    std::array<core::byte, kSpoolRecordHeaderSize> rh{};
+    encode_record_header(rh.data(), h);
+    put_u32_be(rh.data() + 4, record_crc(rh.data(), body.data(), body.size()));
+
+    const bool ok =
+        std::fwrite(rh.data(), 1, rh.size(), write_file_) == rh.size() &&
+        (body.empty() ||
+         std::fwrite(body.data(), 1, body.size(), write_file_) == body.size()) &&
+        std::fflush(write_file_) == 0;
+    if (!ok) {
+        // 截回写入前的长度，保证段文件里不留半条记录。
+        std::error_code ignored;
+        (void)std::fclose(write_file_);
+        fs::resize_file(segment_path_(seg.id), seg.bytes, ignored);
+        write_file_ = std::fopen(segment_path_(seg.id).c_str(), "ab");
+        last_error_ = std::make_error_code(std::errc::io_error);
+        return last_error_;
+    }
+    if (options_.sync_writes) {
+        sync_file(write_file_);
+    }
+
+    if (seg.records == 0) {
+        seg.first_seq = next_seq_;
+    }
+    ++seg.records;
+    seg.bytes += need;
+    disk_bytes_ += need;
+    ++next_seq_;
+    ++size_;
+    return {};
+}
+
+bool Spool::next(SpoolMessage &out) noexcept {
+    last_error_ = {};
+    if (!open_) {
+        last_error_ = make_error_code(errc::invalid_argument);
+        return false;
+    }
+
+    const Segment *seg = nullptr;
+    for (;;) {
+        seg = find_segment_(read_.segment);
+        if (seg == nullptr) {
+            read_ = head_;
+            seg = find_segment_(read_.segment);
+            if (seg == nullptr) {
+                return false;
+            }
+        }
+        if (read_.offset < seg->bytes) {
+            break;
+        }
+        if (seg->id == segments_.back().id) {
+            return false;
+        }
+        const auto *next_seg = find_segment_(seg->id + 1);
+        if (next_seg == nullptr) {
+            // 段号不连续（中间段在恢复时被丢弃）：取下一个更大的段。
+            for (const auto &s : segments_) {
+                if (s.id > seg->id) {
+                    next_seg = &s;
+                    break;
+                }
+            }
+        }
+        read_ = {next_seg->id, kSpoolSegmentHeaderSize, next_seg->first_seq};
+    }
+
+    if (read_file_ == nullptr || read_file_id_ != read_.segment) {
+        close_read_file_();
+        read_file_ = std::fopen(segment_path_(read_.segment).c_str(), "rb");
+        if (read_file_ == nullptr) {
+            last_error_ = {errno, std::generic_category()};
+            return false;
+        }
+        read_file_id_ = read_.segment;
+    }
+    if (!read_file_pos_valid_ || read_file_pos_ != read_.offset) {
+        if (std::fseek(read_file_, static_cast<long>(read_.offset), SEEK_SET) != 0) {
+            close_read_file_();
+            last_error_ = std::make_error_code(std::errc::io_error);
+            return false;
+        }
+        read_file_pos_ = read_.offset;
+        read_file_pos_valid_ = true;
+    }
+
+    std::array<core::byte, kSpoolRecordHeaderSize> rh{};
+    if (std::fread(rh.data(), 1, rh.size(), read_file_) != rh.size()) {
+        std::clearerr(read_file_);
+        read_file_pos_valid_ = false;
+        last_error_ = std::make_error_code(std::errc::io_error);
+        return false;
+    }
+    const auto h = decode_record_header(rh.data());
+    try {
+        out.body.resize(h.body_len);
+    } catch (...) {
+        read_file_pos_valid_ = false;
+        last_error_ = make_error_code(errc::out_of_memory);
+        return false;
+    }
+    if (std::fread(out.body.data(), 1, h.body_len, read_file_) != h.body_len) {
+        std::clearerr(read_file_);
+        read_file_pos_valid_ = false;
+        last_error_ = std::make_error_code(std::errc::io_error);
+        return false;
+    }
+    if (record_crc(rh.data(), out.body.data(), h.body_len) != h.crc) {
+        read_file_pos_valid_ = false;
+        last_error_ = make_error_code(errc::invalid_argument);
+        return false;
+    }
+
+    out.sequence = h.sequence;
+    out.stream = h.stream;
+    out.function = h.function;
+    out.w_bit = (h.flags & kFlagWBit) != 0;
+
+    read_.offset += kSpoolRecordHeaderSize + h.body_len;
+    read_.sequence = h.sequence + 1;
+    read_file_pos_ = read_.offset;
+    try {
+        outstanding_.push_back(read_);
+    } catch (...) {
+        // 无法记录位置时不交付该消息：回退读取位置。
+        read_.offset -= kSpoolRecordHeaderSize + h.body_len;
+        read_.sequence = h.sequence;
+        read_file_pos_valid_ = false;
+        last_error_ = make_error_code(errc::out_of_memory);
+        return false;
+    }
+    return true;
+}
+
+void Spool::rewind() noexcept {
+    read_ = head_;
+    outstanding_.clear();
+}
+
+std::error_code Spool::consume_through(std::uint64_t sequence) noexcept {
+    if (!open_) {
+        return make_error_code(errc::invalid_argument);
+    }
+    bool moved = false;
+    // outstanding_ 中保存的是“记录之后”的位置，其 sequence = 记录序号 + 1。
+    while (!outstanding_.empty() && outstanding_.front().sequence <= sequence + 1) {
+        head_ = outstanding_.front();
+        outstanding_.pop_front();
+        if (size_ != 0) {
+            --size_;
+        }
+        moved = true;
+    }
+    if (moved) {
+        normalize_head_();
+        persist_head_();
+    }
+    return {};
+}
+
+std::error_code Spool::purge() noexcept {
+    if (!open_) {
+        return make_error_code(errc::invalid_argument);
+    }
+    close_read_file_();
+    if (write_file_ != nullptr) {
+        (void)std::fclose(write_file_);
+        write_file_ = nullptr;
+    }
+    const std::uint64_t last_id = segments_.empty() ? head_.segment : segments_.back().id;
+    std::error_code ignored;
+    for (const auto &seg : segments_) {
+        fs::remove(segment_path_(seg.id), ignored);
+    }
+    segments_.clear();
+    outstanding_.clear();
+    disk_bytes_ = 0;
+    size_ = 0;
+
+    const auto ec = start_segment_(last_id + 1);
+    head_ = {last_id + 1, kSpoolSegmentHeaderSize, next_seq_};
+    read_ = head_;
+    persist_head_();
+    if (ec) {
+        last_error_ = ec;
+    }
+    return ec;
+}
+
+} // namespace secs::protocol
@@ -4,7 +4,6 @@
 
 #include <algorithm>
 #include <limits>
-#include <new>
 
 namespace secs::protocol {
 namespace {
@@ -18,112 +17,106 @@ constexpr std::uint32_t kMinSystemBytes = 1U;
 } // namespace
 
 /*
- * SystemBytes 分配策略：
+ * SystemBytes 分配策略（无锁）：
  * - 0 作为保留值永不分配（HSMS/SECS-I 的 SystemBytes 语义中通常不使用 0）
- * - 优先复用已释放的值（free_ 队列）
- * - 否则从 next_ 递增寻找未占用值，达到 max_ 后回绕到 1
- * - 用 in_use_ 集合防止“同一时刻重复分配”
+ * - next_ 是 64 位单调票号：默认全范围时票号低 32 位即候选值（落到 0 时跳过），
+ *   小空间时候选值为 (t % max_) + 1；两者都会在到达 max_ 后回绕到 1
+ * - 候选值 v 固定映射到槽 (v-1) % capacity_；CAS(0 -> v) 成功即占用成功，
+ *   失败说明同槽还有在用值，继续取下一个票号
+ * - release 以 CAS(v -> 0) 清槽，重复释放/释放未在用的值都会 CAS 失败而被忽略
+ *
+ * 连续 capacity_ 个候选值恰好覆盖全部槽，因此“尝试 capacity_ 次仍失败”
+ * 即可判定耗尽（并发竞争下可能偏保守地提前返回 buffer_overflow）。
+ * 热路径每次分配 1 次 fetch_add + 1 次 CAS，释放 1 次 CAS；不维护单独的在用计数，
+ * in_use_count() 通过扫描槽表得到（仅用于诊断/测试）。
  */
 SystemBytes::SystemBytes(std::uint32_t initial,
                          std::uint32_t max_value) noexcept
-    : next_(initial), max_(max_value) {
+    : max_(max_value) {
     if (max_ == 0U) {
         max_ = std::numeric_limits<std::uint32_t>::max();
     }
     if (max_ < kMinSystemBytes) {
         max_ = kMinSystemBytes;
     }
+    full_range_ = max_ == std::numeric_limits<std::uint32_t>::max();
+    capacity_ = std::min<std::size_t>(kWindowSize, max_);
 
-    if (next_ == 0U || next_ > max_) {
-        next_ = kMinSystemBytes;
+    if (initial == 0U || initial > max_) {
+        initial = kMinSystemBytes;
     }
+    next_.store(full_range_ ? static_cast<std::uint64_t>(initial)
+                            : static_cast<std::uint64_t>(initial) - 1U,
+                std::memory_order_relaxed);
 }
 
-std::uint32_t SystemBytes::next_candidate_() noexcept {
-    const auto current = next_;
-    if (next_ == max_) {
-        next_ = kMinSystemBytes;
-    } else {
-        next_ += 1U;
+std::uint32_t SystemBytes::value_of_(std::uint64_t ticket) const noexcept {
+    if (full_range_) {
+        return static_cast<std::uint32_t>(ticket); // 0 由调用方跳过
     }
-    return current;
+    return static_cast<std::uint32_t>(ticket % max_) + kMinSystemBytes;
+}
+
+std::size_t SystemBytes::slot_of_(std::uint32_t system_bytes) const noexcept {
+    const auto index = static_cast<std::size_t>(system_bytes - kMinSystemBytes);
+    if (capacity_ == kWindowSize) {
+        return index & (kWindowSize - 1U);
+    }
+    return index % capacity_;
 }
 
 std::error_code SystemBytes::allocate(std::uint32_t &out) noexcept {
-    try {
-        std::lock_guard lk(mu_);
-
-        if (!free_.empty()) {
-            const auto sb = free_.front();
-            free_.pop_front();
-            in_use_.insert(sb);
-            out = sb;
-            return std::error_code{};
+    for (std::size_t i = 0; i < capacity_; ++i) {
+        const auto candidate =
+            value_of_(next_.fetch_add(1U, std::memory_order_relaxed));
+        if (!is_valid_system_bytes(candidate)) {
+            --i; // 全范围回绕经过 0：不计入尝试次数
+            continue;
         }
+        auto &slot = slots_[slot_of_(candidate)];
 
-        const auto max_usable = static_cast<std::size_t>(max_);
-        if (in_use_.size() >= max_usable) {
-            return secs::core::make_error_code(secs::core::errc::buffer_overflow);
+        // 先读后 CAS：同槽被占用时避免无谓的独占 cache line。
+        if (slot.load(std::memory_order_relaxed) != 0U) {
+            continue;
         }
-
-        // 正常情况下 in_use 很小，这里最多尝试 in_use.size()+2 次即可找到空闲值。
-        const std::size_t attempts =
-            std::min<std::size_t>(in_use_.size() + 2U, max_usable);
-        for (std::size_t i = 0; i < attempts; ++i) {
-            const auto candidate = next_candidate_();
-            if (in_use_.insert(candidate).second) {
-                out = candidate;
-                return std::error_code{};
-            }
+        std::uint32_t expected = 0U;
+        if (slot.compare_exchange_strong(expected,
+                                         candidate,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+            out = candidate;
+            return std::error_code{};
         }
-
-        return secs::core::make_error_code(secs::core::errc::buffer_overflow);
-    } catch (const std::bad_alloc &) {
-        return secs::core::make_error_code(secs::core::errc::out_of_memory);
-    } catch (...) {
-        return secs::core::make_error_code(secs::core::errc::invalid_argument);
     }
+
+    return secs::core::make_error_code(secs::core::errc::buffer_overflow);
 }
 
 void SystemBytes::release(std::uint32_t system_bytes) noexcept {
     if (!is_valid_system_bytes(system_bytes) || system_bytes > max_) {
         return;
     }
-    try {
-        std::lock_guard lk(mu_);
-        if (in_use_.erase(system_bytes) == 0U) {
-            return;
-        }
-        try {
-            free_.push_back(system_bytes);
-        } catch (...) {
-            // 释放队列追加失败（例如 OOM）：允许丢弃该 system_bytes，避免 noexcept
-            // 路径触发 std::terminate。
-        }
-    } catch (...) {
-        // 兜底：mutex/容器操作异常时吞掉，避免 noexcept 路径触发 std::terminate。
-    }
+    std::uint32_t expected = system_bytes;
+    (void)slots_[slot_of_(system_bytes)].compare_exchange_strong(
+        expected, 0U, std::memory_order_release, std::memory_order_relaxed);
 }
 
 bool SystemBytes::is_in_use(std::uint32_t system_bytes) const noexcept {
     if (!is_valid_system_bytes(system_bytes) || system_bytes > max_) {
         return false;
     }
-    try {
-        std::lock_guard lk(mu_);
-        return in_use_.find(system_bytes) != in_use_.end();
-    } catch (...) {
-        return false;
-    }
+    return slots_[slot_of_(system_bytes)].load(std::memory_order_acquire) ==
+           system_bytes;
 }
 
 std::size_t SystemBytes::in_use_count() const noexcept {
-    try {
-        std::lock_guard lk(mu_);
-        return in_use_.size();
-    } catch (...) {
-        return 0;
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < capacity_; ++i) {
+        if (slots_[i].load(std::memory_order_relaxed) != 0U) {
+            ++count;
+        }
     }
+    return count;
 }
 
 } // namespace secs::protocol
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <string>
+#include <utility>
 
 namespace secs::secs1 {
 namespace {
@@ -236,7 +237,30 @@ void Reassembler::reset() noexcept {
     has_header_ = false;
     header_ = Header{};
     next_block_ = 1;
+    discard_body_ = false;
     body_.clear();
+    reservation_.reset();
+}
+
+void Reassembler::discard_body() noexcept {
+    discard_body_ = true;
+    body_.clear();
+    reservation_.reset();
+}
+
+void Reassembler::set_memory_budget(
+    std::shared_ptr<secs::core::MemoryBudget> budget) noexcept {
+    reservation_ = secs::core::MemoryReservation(std::move(budget));
+}
+
+std::vector<secs::core::byte> Reassembler::take_body() noexcept {
+    return std::exchange(body_, {});
+}
+
+secs::core::MemoryReservation Reassembler::take_reservation() noexcept {
+    auto out = std::move(reservation_);
+    reservation_ = secs::core::MemoryReservation(out.budget());
+    return out;
 }
 
 bool Reassembler::has_message() const noexcept {
@@ -258,6 +282,9 @@ std::error_code Reassembler::accept(const DecodedBlock &block) {
         if (block.header.block_number != 1) {
             return make_error_code(errc::block_sequence_error);
         }
+        if (!reservation_.try_grow(block.data.size())) {
+            return secs::core::make_error_code(secs::core::errc::out_of_memory);
+        }
         header_ = block.header;
         header_.end_bit = block.header.end_bit;
         has_header_ = true;
@@ -288,7 +315,12 @@ std::error_code Reassembler::accept(const DecodedBlock &block) {
         return make_error_code(errc::block_sequence_error);
     }
 
-    body_.insert(body_.end(), block.data.begin(), block.data.end());
+    if (!discard_body_) {
+        if (!reservation_.try_grow(block.data.size())) {
+            return secs::core::make_error_code(secs::core::errc::out_of_memory);
+        }
+        body_.insert(body_.end(), block.data.begin(), block.data.end());
+    }
     header_.end_bit = block.header.end_bit;
     next_block_ = static_cast<std::uint16_t>(next_block_ + 1);
     return {};
@@ -3,6 +3,8 @@
 #include "secs/core/error.hpp"
 
 #include <algorithm>
+#include <array>
+#include <new>
 #include <spdlog/spdlog.h>
 
 namespace secs::secs1 {
@@ -37,8 +39,71 @@ StateMachine::StateMachine(Link &link,
     : link_(link), expected_device_id_(expected_device_id), timeouts_(timeouts),
       retry_limit_(retry_limit) {}
 
+struct StateMachine::Metrics final {
+    explicit Metrics(std::shared_ptr<secs::core::metrics::Group> g)
+        : group(std::move(g)),
+          blocks_tx(group->counter("secs_secs1_blocks_total",
+                                   "SECS-I blocks acknowledged (tx) / accepted (rx).",
+                                   {{"direction", "tx"}})),
+          blocks_rx(group->counter("secs_secs1_blocks_total",
+                                   "SECS-I blocks acknowledged (tx) / accepted (rx).",
+                                   {{"direction", "rx"}})),
+          messages_tx(group->counter("secs_secs1_messages_total",
+                                     "SECS-I messages sent/received.",
+                                     {{"direction", "tx"}})),
+          messages_rx(group->counter("secs_secs1_messages_total",
+                                     "SECS-I messages sent/received.",
+                                     {{"direction", "rx"}})),
+          handshake_retries(group->counter("secs_secs1_retries_total",
+                                           "SECS-I send retries after NAK/T2 timeout.",
+                                           {{"phase", "handshake"}})),
+          block_retries(group->counter("secs_secs1_retries_total",
+                                       "SECS-I send retries after NAK/T2 timeout.",
+                                       {{"phase", "block"}})),
+          naks_sent(group->counter("secs_secs1_naks_sent_total",
+                                   "NAKs sent for invalid/unexpected blocks.")),
+          message_size_tx(group->histogram("secs_secs1_message_size_bytes",
+                                           "SECS-I message body size.",
+                                           {{"direction", "tx"}})),
+          message_size_rx(group->histogram("secs_secs1_message_size_bytes",
+                                           "SECS-I message body size.",
+                                           {{"direction", "rx"}})),
+          send_time(group->histogram("secs_secs1_send_seconds",
+                                     "Time to send one message (ENQ to last ACK).",
+                                     {},
+                                     secs::core::metrics::kNanosecondsToSeconds)) {}
+
+    std::shared_ptr<secs::core::metrics::Group> group;
+    secs::core::metrics::Counter &blocks_tx;
+    secs::core::metrics::Counter &blocks_rx;
+    secs::core::metrics::Counter &messages_tx;
+    secs::core::metrics::Counter &messages_rx;
+    secs::core::metrics::Counter &handshake_retries;
+    secs::core::metrics::Counter &block_retries;
+    secs::core::metrics::Counter &naks_sent;
+    secs::core::metrics::Histogram &message_size_tx;
+    secs::core::metrics::Histogram &message_size_rx;
+    secs::core::metrics::Histogram &send_time;
+};
+
+void StateMachine::set_metrics(
+    std::shared_ptr<secs::core::metrics::Group> group) noexcept {
+    metrics_.reset();
+    if (!group) {
+        return;
+    }
+    try {
+        metrics_ = std::make_shared<Metrics>(std::move(group));
+    } catch (...) {
+        // 指标仅用于观测：注册失败时关闭指标，不影响收发。
+    }
+}
+
 asio::awaitable<std::error_code>
 StateMachine::async_send_control(secs::core::byte b) {
+    if (b == kNak && metrics_) {
+        metrics_->naks_sent.add();
+    }
     secs::core::byte tmp = b;
     co_return co_await link_.async_write(secs::core::bytes_view{&tmp, 1});
 }
@@ -81,107 +146,198 @@ StateMachine::async_send(const Header &header, secs::core::bytes_view body) {
 
     // SECS-I 规定单个块的数据最大 244 字节：这里把 body 切分并编码成多个帧。
     auto frames = fragment_message(header, body);
+    const auto started = secs::core::steady_clock::now();
 
     for (const auto &frame : frames) {
-        // 注意：兼容更多 SECS-I 实现，这里按“每个块都执行一次 ENQ/EOT 握手”的方式
-        // 发送。单块消息与旧行为一致；多块消息会在 ACK 后再次 ENQ。
-        state_ = State::wait_eot;
-
-        bool handshake_ok = false;
-        for (std::size_t attempt = 0; attempt < retry_limit_; ++attempt) {
-            // 发 ENQ：请求占用链路。
-            auto ec = co_await async_send_control(kEnq);
-            if (ec) {
-                SPDLOG_DEBUG("secs1 async_send ENQ failed: ec={}({})",
-                             ec.value(),
-                             ec.message());
-                state_ = State::idle;
-                co_return ec;
-            }
+        auto ec = co_await async_send_block_(
+            secs::core::bytes_view{frame.data(), frame.size()});
+        if (ec) {
+            co_return ec;
+        }
+    }
 
-            // 等待对端响应（T2）。EOT/ACK 视为允许发送；NAK/超时则重试。
-            auto [rec_ec, resp] =
-                co_await async_read_byte(timeouts_.t2_protocol);
-            if (!rec_ec && (resp == kEot || resp == kAck)) {
-                handshake_ok = true;
-                break;
-            }
-            if (!rec_ec && resp == kNak) {
-                continue;
-            }
-            if (is_timeout(rec_ec)) {
-                continue;
-            }
-            if (rec_ec) {
-                SPDLOG_DEBUG(
-                    "secs1 async_send handshake receive failed: ec={}({})",
-                    rec_ec.value(),
-                    rec_ec.message());
-                state_ = State::idle;
-                co_return rec_ec;
-            }
+    note_sent_(body.size(), started);
+    co_return std::error_code{};
+}
+
+asio::awaitable<std::error_code>
+StateMachine::async_send(const Header &header, secs::core::BodySource &source) {
+    if (state_ != State::idle) {
+        co_return secs::core::make_error_code(
+            secs::core::errc::invalid_argument);
+    }
+
+    // 整体在内存中的来源（mmap）直接走普通路径。
+    const auto whole = source.contiguous();
+    if (!whole.empty()) {
+        co_return co_await async_send(header, whole);
+    }
+
+    const auto total = source.size();
+    const auto blocks =
+        total == 0 ? std::size_t{1}
+                   : (total + kMaxBlockDataSize - 1) / kMaxBlockDataSize;
+    if (blocks > 0x7FFFu) {
+        co_return secs::core::make_error_code(
+            secs::core::errc::invalid_argument);
+    }
+
+    SPDLOG_DEBUG(
+        "secs1 async_send(streamed) start: dev_id={} S{}F{} W={} sb={} body_n={}",
+        header.device_id,
+        static_cast<int>(header.stream),
+        static_cast<int>(header.function),
+        header.wait_bit ? 1 : 0,
+        header.system_bytes,
+        total);
+
+    // 边读边切块：内存中只有当前块的数据与帧（重传时复用同一帧）。
+    std::array<secs::core::byte, kMaxBlockDataSize> data{};
+    std::vector<secs::core::byte> frame;
+    frame.reserve(kMaxBlockFrameSize);
+    const auto started = secs::core::steady_clock::now();
+    // 读来源期间也占住状态机，避免并发调用插入到块之间。
+    state_ = State::wait_eot;
+
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < blocks; ++i) {
+        const auto n = std::min(total - offset, kMaxBlockDataSize);
+        const secs::core::mutable_bytes_view chunk{data.data(), n};
+        auto ec = co_await secs::core::async_read_full(source, chunk);
+        if (!ec) {
+            auto hdr = header;
+            hdr.block_number = static_cast<std::uint16_t>(i + 1);
+            hdr.end_bit = (i + 1) == blocks;
+            ec = encode_block(hdr, chunk, frame);
+        }
+        if (ec) {
             state_ = State::idle;
-            SPDLOG_DEBUG(
-                "secs1 async_send handshake protocol_error (resp=0x{:02X})",
-                static_cast<unsigned int>(resp));
-            co_return make_error_code(errc::protocol_error);
+            co_return ec;
+        }
+        ec = co_await async_send_block_(
+            secs::core::bytes_view{frame.data(), frame.size()});
+        if (ec) {
+            co_return ec;
         }
+        offset += n;
+    }
+
+    note_sent_(total, started);
+    co_return std::error_code{};
+}
 
-        if (!handshake_ok) {
+void StateMachine::note_sent_(std::size_t body_size,
+                              secs::core::steady_clock::time_point started) noexcept {
+    state_ = State::idle;
+    if (metrics_) {
+        metrics_->messages_tx.add();
+        metrics_->message_size_tx.record(body_size);
+        metrics_->send_time.record_duration(secs::core::steady_clock::now() - started);
+    }
+    SPDLOG_DEBUG("secs1 async_send done");
+}
+
+asio::awaitable<std::error_code>
+StateMachine::async_send_block_(secs::core::bytes_view frame) {
+    // 注意：兼容更多 SECS-I 实现，这里按“每个块都执行一次 ENQ/EOT 握手”的方式
+    // 发送。单块消息与旧行为一致；多块消息会在 ACK 后再次 ENQ。
+    state_ = State::wait_eot;
+
+    bool handshake_ok = false;
+    for (std::size_t attempt = 0; attempt < retry_limit_; ++attempt) {
+        // 发 ENQ：请求占用链路。
+        auto ec = co_await async_send_control(kEnq);
+        if (ec) {
+            SPDLOG_DEBUG("secs1 async_send ENQ failed: ec={}({})",
+                         ec.value(),
+                         ec.message());
             state_ = State::idle;
-            SPDLOG_DEBUG("secs1 async_send handshake too_many_retries");
-            co_return make_error_code(errc::too_many_retries);
+            co_return ec;
         }
 
-        state_ = State::wait_check;
-        std::size_t attempts = 0;
-
-        for (;;) {
-            // 发送 1 个完整帧，然后等待 ACK/NAK（T2）。
-            auto ec = co_await link_.async_write(
-                secs::core::bytes_view{frame.data(), frame.size()});
-            if (ec) {
-                SPDLOG_DEBUG("secs1 async_send frame write failed: ec={}({})",
-                             ec.value(),
-                             ec.message());
-                state_ = State::idle;
-                co_return ec;
+        // 等待对端响应（T2）。EOT/ACK 视为允许发送；NAK/超时则重试。
+        auto [rec_ec, resp] =
+            co_await async_read_byte(timeouts_.t2_protocol);
+        if (!rec_ec && (resp == kEot || resp == kAck)) {
+            handshake_ok = true;
+            break;
+        }
+        if ((!rec_ec && resp == kNak) || is_timeout(rec_ec)) {
+            if (metrics_ && attempt + 1 < retry_limit_) {
+                metrics_->handshake_retries.add();
             }
+            continue;
+        }
+        if (rec_ec) {
+            SPDLOG_DEBUG(
+                "secs1 async_send handshake receive failed: ec={}({})",
+                rec_ec.value(),
+                rec_ec.message());
+            state_ = State::idle;
+            co_return rec_ec;
+        }
+        state_ = State::idle;
+        SPDLOG_DEBUG(
+            "secs1 async_send handshake protocol_error (resp=0x{:02X})",
+            static_cast<unsigned int>(resp));
+        co_return make_error_code(errc::protocol_error);
+    }
 
-            auto [rec_ec, resp] =
-                co_await async_read_byte(timeouts_.t2_protocol);
-            if (!rec_ec && resp == kAck) {
-                break;
-            }
-            // 注意：这里严格期待 ACK/NAK（或超时触发重传）。
-            // 若对端实现违规（例如多线程并发写串口，在 ACK 之前就发送 ENQ），
-            // 这里可能读到 ENQ；这会被判为协议错误并终止本次发送。
-            if ((!rec_ec && resp == kNak) || is_timeout(rec_ec)) {
-                ++attempts;
-                if (attempts >= retry_limit_) {
-                    state_ = State::idle;
-                    SPDLOG_DEBUG("secs1 async_send frame too_many_retries");
-                    co_return make_error_code(errc::too_many_retries);
-                }
-                continue;
+    if (!handshake_ok) {
+        state_ = State::idle;
+        SPDLOG_DEBUG("secs1 async_send handshake too_many_retries");
+        co_return make_error_code(errc::too_many_retries);
+    }
+
+    state_ = State::wait_check;
+    std::size_t attempts = 0;
+
+    for (;;) {
+        // 发送 1 个完整帧，然后等待 ACK/NAK（T2）。
+        auto ec = co_await link_.async_write(frame);
+        if (ec) {
+            SPDLOG_DEBUG("secs1 async_send frame write failed: ec={}({})",
+                         ec.value(),
+                         ec.message());
+            state_ = State::idle;
+            co_return ec;
+        }
+
+        auto [rec_ec, resp] =
+            co_await async_read_byte(timeouts_.t2_protocol);
+        if (!rec_ec && resp == kAck) {
+            if (metrics_) {
+                metrics_->blocks_tx.add();
             }
-            if (rec_ec) {
-                SPDLOG_DEBUG("secs1 async_send frame receive failed: ec={}({})",
-                             rec_ec.value(),
-                             rec_ec.message());
+            co_return std::error_code{};
+        }
+        // 注意：这里严格期待 ACK/NAK（或超时触发重传）。
+        // 若对端实现违规（例如多线程并发写串口，在 ACK 之前就发送 ENQ），
+        // 这里可能读到 ENQ；这会被判为协议错误并终止本次发送。
+        if ((!rec_ec && resp == kNak) || is_timeout(rec_ec)) {
+            ++attempts;
+            if (attempts >= retry_limit_) {
                 state_ = State::idle;
-                co_return rec_ec;
+                SPDLOG_DEBUG("secs1 async_send frame too_many_retries");
+                co_return make_error_code(errc::too_many_retries);
             }
+            if (metrics_) {
+                metrics_->block_retries.add();
+            }
+            continue;
+        }
+        if (rec_ec) {
+            SPDLOG_DEBUG("secs1 async_send frame receive failed: ec={}({})",
+                         rec_ec.value(),
+                         rec_ec.message());
             state_ = State::idle;
-            SPDLOG_DEBUG("secs1 async_send frame protocol_error (resp=0x{:02X})",
-                         static_cast<unsigned int>(resp));
-            co_return make_error_code(errc::protocol_error);
+            co_return rec_ec;
         }
+        state_ = State::idle;
+        SPDLOG_DEBUG("secs1 async_send frame protocol_error (resp=0x{:02X})",
+                     static_cast<unsigned int>(resp));
+        co_return make_error_code(errc::protocol_error);
     }
-
-    state_ = State::idle;
-    SPDLOG_DEBUG("secs1 async_send done");
-    co_return std::error_code{};
 }
 
 asio::awaitable<std::pair<std::error_code, ReceivedMessage>>
@@ -249,7 +405,8 @@ StateMachine::async_receive(std::optional<secs::core::duration> timeout) {
                 const auto now = secs::core::steady_clock::now();
                 if (now >= deadline) {
                     // Block 间超时：认为多块消息接收已中断，丢弃全部 in-flight 状态。
-                    in_flight_.clear();
+                    drop_in_flight_(
+                        secs::core::make_error_code(secs::core::errc::timeout));
                     state_ = State::idle;
                     co_return std::pair{
                         secs::core::make_error_code(secs::core::errc::timeout),
@@ -263,7 +420,7 @@ StateMachine::async_receive(std::optional<secs::core::duration> timeout) {
                         "secs1 async_receive waiting next block start failed: ec={}({})",
                         ec.value(),
                         ec.message());
-                    in_flight_.clear();
+                    drop_in_flight_(ec);
                     state_ = State::idle;
                     co_return std::pair{ec, ReceivedMessage{}};
                 }
@@ -276,7 +433,7 @@ StateMachine::async_receive(std::optional<secs::core::duration> timeout) {
                             "secs1 async_receive send EOT(for next block) failed: ec={}({})",
                             eot_ec.value(),
                             eot_ec.message());
-                        in_flight_.clear();
+                        drop_in_flight_(eot_ec);
                         state_ = State::idle;
                         co_return std::pair{eot_ec, ReceivedMessage{}};
                     }
@@ -308,7 +465,7 @@ StateMachine::async_receive(std::optional<secs::core::duration> timeout) {
             SPDLOG_DEBUG("secs1 async_receive length read failed: ec={}({})",
                          len_ec.value(),
                          len_ec.message());
-            in_flight_.clear();
+            drop_in_flight_(len_ec);
             state_ = State::idle;
             co_return std::pair{len_ec, ReceivedMessage{}};
         }
@@ -316,7 +473,7 @@ StateMachine::async_receive(std::optional<secs::core::duration> timeout) {
         const auto length = static_cast<std::size_t>(len_b);
         if (length < kHeaderSize || length > kMaxBlockLength) {
             (void)co_await async_send_control(kNak);
-            in_flight_.clear();
+            drop_in_flight_(make_error_code(errc::invalid_block));
             state_ = State::idle;
             SPDLOG_DEBUG("secs1 async_receive invalid length: {}", length);
             co_return std::pair{make_error_code(errc::invalid_block),
@@ -335,7 +492,7 @@ StateMachine::async_receive(std::optional<secs::core::duration> timeout) {
                 SPDLOG_DEBUG("secs1 async_receive frame byte read failed: ec={}({})",
                              b_ec.value(),
                              b_ec.message());
-                in_flight_.clear();
+                drop_in_flight_(b_ec);
                 state_ = State::idle;
                 co_return std::pair{b_ec, ReceivedMessage{}};
             }
@@ -349,7 +506,7 @@ StateMachine::async_receive(std::optional<secs::core::duration> timeout) {
             (void)co_await async_send_control(kNak);
             ++nack_count;
             if (nack_count >= retry_limit_) {
-                in_flight_.clear();
+                drop_in_flight_(make_error_code(errc::too_many_retries));
                 state_ = State::idle;
                 SPDLOG_DEBUG("secs1 async_receive too_many_retries (decode)");
                 co_return std::pair{make_error_code(errc::too_many_retries),
@@ -393,21 +550,43 @@ StateMachine::async_receive(std::optional<secs::core::duration> timeout) {
             // interleaving：允许“新消息”在旧消息未结束时插入，但必须从 BlockNumber=1 开始。
             if (decoded.header.block_number != 1) {
                 (void)co_await async_send_control(kNak);
-                in_flight_.clear();
+                drop_in_flight_(make_error_code(errc::block_sequence_error));
                 state_ = State::idle;
                 co_return std::pair{make_error_code(errc::block_sequence_error),
                                     ReceivedMessage{}};
             }
             InFlight st{};
             st.re = Reassembler(expected_device_id_);
+            st.re.set_memory_budget(memory_budget_);
             st.last_block = secs::core::steady_clock::now();
             it = in_flight_.emplace(sb, std::move(st)).first;
         }
 
         auto acc_ec = it->second.re.accept(decoded);
+        if (!acc_ec && decoded.header.block_number == 1 && !body_sinks_.empty()) {
+            acc_ec = open_body_sink_(it->second);
+        }
+        if (!acc_ec && it->second.sink) {
+            // 消息体交给 sink：ACK 之前写入，写失败按 NAK 处理。
+            acc_ec = co_await it->second.sink->async_write(decoded.data);
+        }
+        if (acc_ec == secs::core::errc::out_of_memory && !it->second.sink) {
+            // 内存预算不足：该块未被接受，NAK 让对端稍后重发，其它重组状态保留。
+            if (decoded.header.block_number == 1) {
+                in_flight_.erase(it);
+            }
+            (void)co_await async_send_control(kNak);
+            ++nack_count;
+            if (nack_count >= retry_limit_) {
+                drop_in_flight_(acc_ec);
+                state_ = State::idle;
+                co_return std::pair{acc_ec, ReceivedMessage{}};
+            }
+            continue;
+        }
         if (acc_ec) {
             (void)co_await async_send_control(kNak);
-            in_flight_.clear();
+            drop_in_flight_(acc_ec);
             state_ = State::idle;
             co_return std::pair{acc_ec, ReceivedMessage{}};
         }
@@ -420,19 +599,84 @@ StateMachine::async_receive(std::optional<secs::core::duration> timeout) {
         (void)co_await async_send_control(kAck);
         next_block_timeout = timeouts_.t4_interblock;
         allow_enq_or_length = true;
+        if (metrics_) {
+            metrics_->blocks_rx.add();
+        }
 
         if (it->second.re.has_message()) {
             ReceivedMessage msg{};
             msg.header = it->second.re.message_header();
-            auto body_view = it->second.re.message_body();
-            msg.body.assign(body_view.begin(), body_view.end());
+            std::size_t body_size = 0;
+            if (it->second.sink) {
+                msg.body_sink = std::move(it->second.sink);
+                body_size = msg.body_sink->size();
+            } else {
+                msg.body = it->second.re.take_body();
+                msg.memory_lease =
+                    secs::core::make_memory_lease(it->second.re.take_reservation());
+                body_size = msg.body.size();
+            }
             in_flight_.erase(it);
             state_ = State::idle;
+            if (msg.body_sink) {
+                auto fin_ec = co_await msg.body_sink->async_finish();
+                if (fin_ec) {
+                    msg.body_sink->abort(fin_ec);
+                    co_return std::pair{fin_ec, ReceivedMessage{}};
+                }
+            }
+            if (metrics_) {
+                metrics_->messages_rx.add();
+                metrics_->message_size_rx.record(body_size);
+            }
             co_return std::pair{std::error_code{}, std::move(msg)};
         }
     }
 }
 
+void StateMachine::set_body_sinks(std::vector<secs::core::BodySinkRule> rules) noexcept {
+    body_sinks_ = std::move(rules);
+}
+
+void StateMachine::set_memory_budget(
+    std::shared_ptr<secs::core::MemoryBudget> budget) noexcept {
+    memory_budget_ = std::move(budget);
+}
+
+std::error_code StateMachine::open_body_sink_(InFlight &st) {
+    const auto &h = st.re.message_header();
+    const auto *factory =
+        secs::core::find_body_sink_factory(body_sinks_, h.stream, h.function);
+    if (!factory) {
+        return {};
+    }
+    try {
+        // SECS-I 消息体逐块到达，收完前长度未知。
+        st.sink = (*factory)(secs::core::BodySinkInfo{.stream = h.stream,
+                                                      .function = h.function,
+                                                      .system_bytes = h.system_bytes,
+                                                      .size = std::nullopt});
+    } catch (const std::bad_alloc &) {
+        return secs::core::make_error_code(secs::core::errc::out_of_memory);
+    } catch (...) {
+        return secs::core::make_error_code(secs::core::errc::invalid_argument);
+    }
+    if (st.sink) {
+        st.re.discard_body();
+    }
+    return {};
+}
+
+void StateMachine::drop_in_flight_(std::error_code reason) noexcept {
+    for (auto &[sb, st] : in_flight_) {
+        (void)sb;
+        if (st.sink) {
+            st.sink->abort(reason);
+        }
+    }
+    in_flight_.clear();
+}
+
 asio::awaitable<std::pair<std::error_code, ReceivedMessage>>
 StateMachine::async_transact(const Header &header,
                              secs::core::bytes_view body) {
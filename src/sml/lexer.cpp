@@ -1,9 +1,6 @@
 #include "secs/sml/lexer.hpp"
 
-#include <algorithm>
-#include <cctype>
-#include <charconv>
-#include <unordered_map>
+#include <string>
 
 namespace secs::sml {
 
@@ -16,7 +13,11 @@ namespace secs::sml {
  *
  * 支持能力：
  * - 行注释（// ...）与块注释（以 `/ *` 开始，以 `* /` 结束）
- * - 字符串、数字、标识符、关键字（见 kKeywords）
+ * - 字符串、数字、标识符、关键字（见 classify_identifier）
+ *
+ * 零拷贝：
+ * - Token::value 直接引用源文本；只有含转义的字符串才解码到 owned_strings_；
+ * - next_token() 支持与 Parser 流式协作，无需物化完整 Token 序列。
  *
  * 错误策略：
  * - 遇到非法字符、未闭合字符串、未闭合块注释等情况：
@@ -50,26 +51,110 @@ public:
 
 const LexerErrorCategory kLexerErrorCategory{};
 
-const std::unordered_map<std::string_view, TokenType> kKeywords = {
-    {"if", TokenType::KwIf},
-    {"every", TokenType::KwEvery},
-    {"send", TokenType::KwSend},
-    {"W", TokenType::KwW},
-    {"L", TokenType::KwL},
-    {"A", TokenType::KwA},
-    {"B", TokenType::KwB},
-    {"Boolean", TokenType::KwBoolean},
-    {"U1", TokenType::KwU1},
-    {"U2", TokenType::KwU2},
-    {"U4", TokenType::KwU4},
-    {"U8", TokenType::KwU8},
-    {"I1", TokenType::KwI1},
-    {"I2", TokenType::KwI2},
-    {"I4", TokenType::KwI4},
-    {"I8", TokenType::KwI8},
-    {"F4", TokenType::KwF4},
-    {"F8", TokenType::KwF8},
-};
+// ASCII 字符分类：不依赖 locale，且可内联（<cctype> 的 isalpha 等需查表 + 函数调用）。
+[[nodiscard]] constexpr bool is_digit(char c) noexcept {
+    return c >= '0' && c <= '9';
+}
+[[nodiscard]] constexpr bool is_alpha(char c) noexcept {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+[[nodiscard]] constexpr bool is_ident_char(char c) noexcept {
+    return is_alpha(c) || is_digit(c) || c == '_';
+}
+[[nodiscard]] constexpr bool is_xdigit(char c) noexcept {
+    return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// 关键字分类：先按长度、再按首字符分派，不做哈希与堆分配（区分大小写）。
+[[nodiscard]] constexpr TokenType classify_identifier(std::string_view text) noexcept {
+    switch (text.size()) {
+    case 1:
+        switch (text[0]) {
+        case 'W':
+            return TokenType::KwW;
+        case 'L':
+            return TokenType::KwL;
+        case 'A':
+            return TokenType::KwA;
+        case 'B':
+            return TokenType::KwB;
+        default:
+            break;
+        }
+        break;
+    case 2:
+        switch (text[0]) {
+        case 'i':
+            if (text[1] == 'f') {
+                return TokenType::KwIf;
+            }
+            break;
+        case 'U':
+            switch (text[1]) {
+            case '1':
+                return TokenType::KwU1;
+            case '2':
+                return TokenType::KwU2;
+            case '4':
+                return TokenType::KwU4;
+            case '8':
+                return TokenType::KwU8;
+            default:
+                break;
+            }
+            break;
+        case 'I':
+            switch (text[1]) {
+            case '1':
+                return TokenType::KwI1;
+            case '2':
+                return TokenType::KwI2;
+            case '4':
+                return TokenType::KwI4;
+            case '8':
+                return TokenType::KwI8;
+            default:
+                break;
+            }
+            break;
+        case 'F':
+            if (text[1] == '4') {
+                return TokenType::KwF4;
+            }
+            if (text[1] == '8') {
+                return TokenType::KwF8;
+            }
+            break;
+        default:
+            break;
+        }
+        break;
+    case 4:
+        if (text == "send") {
+            return TokenType::KwSend;
+        }
+        break;
+    case 5:
+        if (text == "every") {
+            return TokenType::KwEvery;
+        }
+        break;
+    case 7:
+        if (text == "Boolean") {
+            return TokenType::KwBoolean;
+        }
+        break;
+    default:
+        break;
+    }
+    return TokenType::Identifier;
+}
+
+static_assert(classify_identifier("Boolean") == TokenType::KwBoolean);
+static_assert(classify_identifier("U4") == TokenType::KwU4);
+static_assert(classify_identifier("F8") == TokenType::KwF8);
+static_assert(classify_identifier("S1F1") == TokenType::Identifier);
+static_assert(classify_identifier("boolean") == TokenType::Identifier);
 
 } // namespace
 
@@ -81,43 +166,60 @@ std::error_code make_error_code(lexer_errc e) noexcept {
     return {static_cast<int>(e), kLexerErrorCategory};
 }
 
-Lexer::Lexer(std::string_view source) noexcept : source_(source) {}
+Lexer::Lexer(std::string_view source, std::uint32_t first_line) noexcept
+    : source_(source), line_(first_line), token_line_(first_line) {}
 
 LexerResult Lexer::tokenize() noexcept {
     LexerResult result;
 
-    while (!at_end()) {
-        skip_whitespace();
-        if (at_end())
-            break;
+    for (;;) {
+        Token token = next_token();
+        if (token.type == TokenType::Error) {
+            result.ec = ec_;
+            result.error_line = token.line;
+            result.error_column = token.column;
+            result.error_message = error_message_;
+            return result;
+        }
 
-        // 跳过注释
-        if (skip_comment(result)) {
-            if (result.ec) {
-                return result;
-            }
-            continue;
+        result.tokens.push_back(token);
+        if (token.type == TokenType::Eof) {
+            break;
         }
+    }
+
+    result.owned_strings = std::move(owned_strings_);
+    return result;
+}
+
+Token Lexer::next_token() noexcept {
+    if (ec_) {
+        return error_token_;
+    }
+
+    for (;;) {
+        skip_whitespace();
 
         token_start_ = current_;
         token_line_ = line_;
         token_column_ = column_;
-
-        last_error_kind_ = lexer_errc::invalid_character;
-        Token token = scan_token();
-        if (token.type == TokenType::Error) {
-            result.ec = make_error_code(last_error_kind_);
-            result.error_line = token.line;
-            result.error_column = token.column;
-            result.error_message = token.value;
-            return result;
+        if (at_end()) {
+            return make_token(TokenType::Eof);
         }
 
-        result.tokens.push_back(std::move(token));
+        // 跳过注释
+        const auto comment = skip_comment();
+        if (comment == comment_kind::none) {
+            break;
+        }
+        if (comment == comment_kind::unterminated) {
+            // 未闭合的块注释：视为词法错误，位置指向注释起点。
+            return make_error(lexer_errc::unterminated_comment,
+                              "unterminated block comment");
+        }
     }
 
-    result.tokens.push_back(make_token(TokenType::Eof));
-    return result;
+    return scan_token();
 }
 
 bool Lexer::at_end() const noexcept { return current_ >= source_.size(); }
@@ -156,27 +258,20 @@ void Lexer::skip_whitespace() noexcept {
     }
 }
 
-bool Lexer::skip_comment(LexerResult &result) noexcept {
+Lexer::comment_kind Lexer::skip_comment() noexcept {
     if (peek() == '/' && peek_next() == '*') {
         // 块注释：/* ... */
-        const auto start_line = line_;
-        const auto start_column = column_;
         advance(); // /
         advance(); // *
         while (!at_end()) {
             if (peek() == '*' && peek_next() == '/') {
                 advance(); // *
                 advance(); // /
-                return true;
+                return comment_kind::skipped;
             }
             advance();
         }
-        // 未闭合的块注释：视为词法错误，便于上层定位输入问题。
-        result.ec = make_error_code(lexer_errc::unterminated_comment);
-        result.error_line = start_line;
-        result.error_column = start_column;
-        result.error_message = "unterminated block comment";
-        return true;
+        return comment_kind::unterminated;
     }
 
     if (peek() == '/' && peek_next() == '/') {
@@ -184,10 +279,10 @@ bool Lexer::skip_comment(LexerResult &result) noexcept {
         while (!at_end() && peek() != '\n') {
             advance();
         }
-        return true;
+        return comment_kind::skipped;
     }
 
-    return false;
+    return comment_kind::none;
 }
 
 Token Lexer::scan_token() noexcept {
@@ -226,15 +321,14 @@ Token Lexer::scan_token() noexcept {
     }
 
     // 标识符或关键字
-    if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+    if (is_alpha(c) || c == '_') {
         --current_;
         --column_;
         return scan_identifier();
     }
 
     // 数字：支持十进制整数、十六进制整数（0x..）与浮点数（含科学计数法）
-    if (std::isdigit(static_cast<unsigned char>(c)) ||
-        (c == '-' && std::isdigit(static_cast<unsigned char>(peek())))) {
+    if (is_digit(c) || (c == '-' && is_digit(peek()))) {
         --current_;
         --column_;
         return scan_number();
@@ -245,51 +339,50 @@ Token Lexer::scan_token() noexcept {
 
 Token Lexer::scan_identifier() noexcept {
     std::size_t start = current_;
-    while (!at_end() && (std::isalnum(static_cast<unsigned char>(peek())) ||
-                         peek() == '_')) {
+    while (!at_end() && is_ident_char(peek())) {
         advance();
     }
 
-    std::string_view text = source_.substr(start, current_ - start);
-    TokenType type = identifier_type(text);
-    return make_token(type, std::string(text));
+    const std::string_view text = source_.substr(start, current_ - start);
+    return make_token(classify_identifier(text), text);
 }
 
 Token Lexer::scan_string(char quote) noexcept {
-    std::string value;
+    const std::size_t start = current_;
+    // 无转义时直接引用源文本；遇到第一个转义才把已扫描部分拷出并逐字符解码。
+    std::string *unescaped = nullptr;
     while (!at_end() && peek() != quote) {
         if (peek() == '\n') {
             return make_error(lexer_errc::unterminated_string,
                               "unterminated string (newline in string)");
         }
         if (peek() == '\\' && peek_next() != '\0') {
+            if (!unescaped) {
+                unescaped = &owned_strings_.emplace_back(
+                    source_.substr(start, current_ - start));
+            }
             advance(); // 反斜杠
             char escaped = advance();
             switch (escaped) {
             case 'n':
-                value += '\n';
+                *unescaped += '\n';
                 break;
             case 't':
-                value += '\t';
+                *unescaped += '\t';
                 break;
             case 'r':
-                value += '\r';
-                break;
-            case '\\':
-                value += '\\';
-                break;
-            case '"':
-                value += '"';
-                break;
-            case '\'':
-                value += '\'';
+                *unescaped += '\r';
                 break;
             default:
-                value += escaped;
+                // \\、\"、\' 以及未知转义：取字面字符
+                *unescaped += escaped;
                 break;
             }
         } else {
-            value += advance();
+            const char c = advance();
+            if (unescaped) {
+                *unescaped += c;
+            }
         }
     }
 
@@ -298,8 +391,12 @@ Token Lexer::scan_string(char quote) noexcept {
                           "unterminated string");
     }
 
+    const std::size_t end = current_;
     advance(); // 结束引号
-    return make_token(TokenType::String, std::move(value));
+    if (unescaped) {
+        return make_token(TokenType::String, std::string_view(*unescaped));
+    }
+    return make_token(TokenType::String, source_.substr(start, end - start));
 }
 
 Token Lexer::scan_number() noexcept {
@@ -313,28 +410,27 @@ Token Lexer::scan_number() noexcept {
     if (peek() == '0' && (peek_next() == 'x' || peek_next() == 'X')) {
         advance(); // 0
         advance(); // x 或 X
-        if (at_end() || !std::isxdigit(static_cast<unsigned char>(peek()))) {
+        if (at_end() || !is_xdigit(peek())) {
             return make_error(lexer_errc::invalid_hex_literal,
                               "invalid hexadecimal literal");
         }
-        while (!at_end() && std::isxdigit(static_cast<unsigned char>(peek()))) {
+        while (!at_end() && is_xdigit(peek())) {
             advance();
         }
-        std::string_view text = source_.substr(start, current_ - start);
-        return make_token(TokenType::Integer, std::string(text));
+        return make_token(TokenType::Integer,
+                          source_.substr(start, current_ - start));
     }
 
     // 整数部分
-    while (!at_end() && std::isdigit(static_cast<unsigned char>(peek()))) {
+    while (!at_end() && is_digit(peek())) {
         advance();
     }
 
     // 判断是否为浮点数：要求 '.' 后至少有一位数字，避免把 "S1F1." 的 '.'
     // 误吞成小数点
-    if (peek() == '.' &&
-        std::isdigit(static_cast<unsigned char>(peek_next()))) {
+    if (peek() == '.' && is_digit(peek_next())) {
         advance(); // .
-        while (!at_end() && std::isdigit(static_cast<unsigned char>(peek()))) {
+        while (!at_end() && is_digit(peek())) {
             advance();
         }
         // 指数部分：e/E[+/-]后跟数字
@@ -343,43 +439,35 @@ Token Lexer::scan_number() noexcept {
             if (peek() == '+' || peek() == '-') {
                 advance();
             }
-            while (!at_end() &&
-                   std::isdigit(static_cast<unsigned char>(peek()))) {
+            while (!at_end() && is_digit(peek())) {
                 advance();
             }
         }
-        std::string_view text = source_.substr(start, current_ - start);
-        return make_token(TokenType::Float, std::string(text));
+        return make_token(TokenType::Float,
+                          source_.substr(start, current_ - start));
     }
 
-    std::string_view text = source_.substr(start, current_ - start);
-    return make_token(TokenType::Integer, std::string(text));
+    return make_token(TokenType::Integer, source_.substr(start, current_ - start));
 }
 
 Token Lexer::make_token(TokenType type) const noexcept {
-    return Token{
-        type,
-        std::string(source_.substr(token_start_, current_ - token_start_)),
-        token_line_,
-        token_column_};
+    return Token{type,
+                 source_.substr(token_start_, current_ - token_start_),
+                 token_line_,
+                 token_column_};
 }
 
-Token Lexer::make_token(TokenType type, std::string value) const noexcept {
-    return Token{type, std::move(value), token_line_, token_column_};
+Token Lexer::make_token(TokenType type,
+                        std::string_view value) const noexcept {
+    return Token{type, value, token_line_, token_column_};
 }
 
 Token Lexer::make_error(lexer_errc kind, std::string_view message) noexcept {
-    last_error_kind_ = kind;
-    return Token{
-        TokenType::Error, std::string(message), token_line_, token_column_};
-}
-
-TokenType Lexer::identifier_type(std::string_view text) const noexcept {
-    auto it = kKeywords.find(text);
-    if (it != kKeywords.end()) {
-        return it->second;
-    }
-    return TokenType::Identifier;
+    ec_ = make_error_code(kind);
+    error_message_.assign(message);
+    error_token_ = Token{
+        TokenType::Error, error_message_, token_line_, token_column_};
+    return error_token_;
 }
 
 } // namespace secs::sml
@@ -0,0 +1,451 @@
+#include "secs/sml/library.hpp"
+
+#include "secs/core/error.hpp"
+#include "secs/sml/lexer.hpp"
+#include "secs/sml/runtime.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <exception>
+#include <new>
+#include <thread>
+#include <utility>
+
+#if defined(_WIN32)
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace secs::sml {
+
+/*
+ * SML 库并行加载。
+ *
+ * 流程：
+ * 1) 逐个 mmap 源文件（只读，不拷贝）；
+ * 2) 并行：对每个源文本做一次轻量字节扫描，在顶层语句边界切片；
+ * 3) 并行：每个切片独立 Lexer + Parser（切片从行首开始，Lexer 以原文件行号起算）；
+ * 4) 串行：按 (文件, 切片) 顺序拼接 Document —— 与线程调度无关，结果等价于
+ *    对拼接后的全文调用 parse_sml()。
+ *
+ * 之所以可以按语句切片：Parser 的顶层循环在语句之间不携带任何状态，
+ * 语句只会追加到 messages/conditions/timers。
+ */
+
+namespace {
+
+// 只读文件映射（RAII）。空文件不做映射，view() 返回空视图。
+class MappedFile final {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept { swap(other); }
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            reset();
+            swap(other);
+        }
+        return *this;
+    }
+    ~MappedFile() { reset(); }
+
+    [[nodiscard]] std::error_code open(const std::string &path) {
+        reset();
+#if defined(_WIN32)
+        std::ifstream f(path, std::ios::in | std::ios::binary);
+        if (!f) {
+            return std::make_error_code(std::errc::no_such_file_or_directory);
+        }
+        buffer_.assign(std::istreambuf_iterator<char>(f),
+                       std::istreambuf_iterator<char>());
+        if (f.bad()) {
+            return std::make_error_code(std::errc::io_error);
+        }
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+        return {};
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return {errno, std::generic_category()};
+        }
+        struct ::stat st {};
+        if (::fstat(fd, &st) != 0) {
+            const int err = errno;
+            ::close(fd);
+            return {err, std::generic_category()};
+        }
+        const auto size = static_cast<std::size_t>(st.st_size);
+        if (size == 0) {
+            ::close(fd);
+            return {};
+        }
+        void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        const int err = errno;
+        ::close(fd); // 映射建立后即可关闭 fd
+        if (p == MAP_FAILED) {
+            return {err, std::generic_category()};
+        }
+        (void)::madvise(p, size, MADV_SEQUENTIAL);
+        data_ = static_cast<const char *>(p);
+        size_ = size;
+        return {};
+#endif
+    }
+
+    [[nodiscard]] std::string_view view() const noexcept {
+        return size_ == 0 ? std::string_view{} : std::string_view{data_, size_};
+    }
+
+private:
+    void reset() noexcept {
+#if defined(_WIN32)
+        buffer_.clear();
+#else
+        if (data_ && size_ != 0) {
+            ::munmap(const_cast<char *>(data_), size_);
+        }
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    void swap(MappedFile &other) noexcept {
+#if defined(_WIN32)
+        buffer_.swap(other.buffer_);
+#endif
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+    }
+
+#if defined(_WIN32)
+    std::string buffer_;
+#endif
+    const char *data_{nullptr};
+    std::size_t size_{0};
+};
+
+// 源文本切片：text 从行首开始，first_line 为其在原文本中的行号。
+struct Slice final {
+    std::size_t source_index{0};
+    std::string_view text;
+    std::uint32_t first_line{1};
+};
+
+// 在顶层语句边界切片。扫描规则与 Lexer 保持一致：跳过字符串（含转义）与
+// 注释，按 '<'/'>'、'('/')' 计算嵌套深度；深度为 0 的 '.' 之后若直到行尾只有
+// 空白/注释，则该行尾是一个合法切点。切片达到 target 字节后在下一个切点切开。
+void split_statements(std::size_t source_index,
+                      std::string_view src,
+                      std::size_t target,
+                      std::vector<Slice> &out) {
+    if (target == 0 || src.size() <= target) {
+        out.push_back(Slice{source_index, src, 1});
+        return;
+    }
+
+    std::size_t chunk_start = 0;
+    std::uint32_t chunk_line = 1;
+    std::uint32_t line = 1;
+    std::size_t angle = 0;
+    std::size_t paren = 0;
+    bool statement_ended = false;
+
+    std::size_t i = 0;
+    const std::size_t n = src.size();
+    while (i < n) {
+        const char c = src[i];
+        const char next = i + 1 < n ? src[i + 1] : '\0';
+
+        if (c == '/' && next == '/') {
+            while (i < n && src[i] != '\n') {
+                ++i;
+            }
+            continue; // 换行交给下方统一处理
+        }
+        if (c == '/' && next == '*') {
+            i += 2;
+            while (i < n && !(src[i] == '*' && i + 1 < n && src[i + 1] == '/')) {
+                if (src[i] == '\n') {
+                    ++line;
+                }
+                ++i;
+            }
+            i = std::min(n, i + 2);
+            continue;
+        }
+        if (c == '"' || c == '\'') {
+            ++i;
+            while (i < n && src[i] != c && src[i] != '\n') {
+                if (src[i] == '\\' && i + 1 < n) {
+                    if (src[i + 1] == '\n') {
+                        ++line;
+                    }
+                    ++i;
+                }
+                ++i;
+            }
+            if (i < n && src[i] == c) {
+                ++i;
+            }
+            statement_ended = false;
+            continue;
+        }
+
+        switch (c) {
+        case '\n':
+            ++line;
+            if (statement_ended && i + 1 - chunk_start >= target) {
+                out.push_back(Slice{source_index,
+                                    src.substr(chunk_start, i + 1 - chunk_start),
+                                    chunk_line});
+                chunk_start = i + 1;
+                chunk_line = line;
+                statement_ended = false;
+            }
+            break;
+        case ' ':
+        case '\t':
+        case '\r':
+            break;
+        case '<':
+            ++angle;
+            statement_ended = false;
+            break;
+        case '>':
+            angle -= angle != 0 ? 1 : 0;
+            statement_ended = false;
+            break;
+        case '(':
+            ++paren;
+            statement_ended = false;
+            break;
+        case ')':
+            paren -= paren != 0 ? 1 : 0;
+            statement_ended = false;
+            break;
+        case '.':
+            statement_ended = angle == 0 && paren == 0;
+            break;
+        default:
+            statement_ended = false;
+            break;
+        }
+        ++i;
+    }
+
+    if (chunk_start < n || out.empty()) {
+        out.push_back(
+            Slice{source_index, src.substr(chunk_start), chunk_line});
+    }
+}
+
+// threads=0 表示按 CPU 核数。
+[[nodiscard]] std::size_t effective_threads(std::size_t requested) noexcept {
+    if (requested != 0) {
+        return requested;
+    }
+    return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+}
+
+// 在至多 threads 个线程（含调用线程）上执行 fn(0..count-1)。
+// 线程创建失败时退化为更少的线程，任务仍全部执行。
+template <class Fn>
+void run_parallel(std::size_t count, std::size_t threads, Fn &&fn) {
+    threads = std::min(effective_threads(threads), count);
+
+    std::atomic<std::size_t> next{0};
+    auto worker = [&]() noexcept {
+        for (;;) {
+            const auto idx = next.fetch_add(1, std::memory_order_relaxed);
+            if (idx >= count) {
+                return;
+            }
+            fn(idx);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    if (threads > 1) {
+        try {
+            pool.reserve(threads - 1);
+            for (std::size_t t = 1; t < threads; ++t) {
+                pool.emplace_back(worker);
+            }
+        } catch (...) {
+            // 资源不足：已有线程 + 调用线程继续完成全部任务
+        }
+    }
+    worker();
+    for (auto &t : pool) {
+        t.join();
+    }
+}
+
+ParseResult parse_slice(const Slice &slice) noexcept {
+    try {
+        Lexer lexer(slice.text, slice.first_line);
+        Parser parser(lexer);
+        return parser.parse();
+    } catch (const std::bad_alloc &) {
+        ParseResult result;
+        result.ec = secs::core::make_error_code(secs::core::errc::out_of_memory);
+        result.error_message = "out of memory";
+        return result;
+    } catch (...) {
+        ParseResult result;
+        result.ec = secs::core::make_error_code(secs::core::errc::invalid_argument);
+        result.error_message = "unexpected exception";
+        return result;
+    }
+}
+
+template <class T>
+void append_moved(std::vector<T> &dst, std::vector<T> &src) {
+    if (dst.empty()) {
+        dst = std::move(src);
+        return;
+    }
+    dst.insert(dst.end(),
+               std::make_move_iterator(src.begin()),
+               std::make_move_iterator(src.end()));
+}
+
+// 并行解析多个源文本；出错时 out_error_source 为第一个出错源文本的下标。
+LibraryParseResult parse_sources(const std::vector<std::string_view> &sources,
+                                 const LibraryLoadOptions &options,
+                                 std::size_t &out_error_source) {
+    // 1) 切片：每个源文本独立扫描（单线程时切片没有收益，直接整段解析）
+    const std::size_t split_bytes =
+        effective_threads(options.threads) > 1 ? options.split_bytes : 0;
+    std::vector<std::vector<Slice>> per_source(sources.size());
+    run_parallel(sources.size(), options.threads, [&](std::size_t i) noexcept {
+        try {
+            split_statements(i, sources[i], split_bytes, per_source[i]);
+        } catch (...) {
+            // 切片失败（OOM）：整段作为一个切片
+            per_source[i].assign(1, Slice{i, sources[i], 1});
+        }
+    });
+
+    std::vector<Slice> slices;
+    for (auto &v : per_source) {
+        append_moved(slices, v);
+    }
+
+    // 2) 并行解析
+    std::vector<ParseResult> parsed(slices.size());
+    run_parallel(slices.size(), options.threads, [&](std::size_t i) noexcept {
+        parsed[i] = parse_slice(slices[i]);
+    });
+
+    // 3) 按输入顺序合并（确定性）
+    LibraryParseResult result;
+    for (std::size_t i = 0; i < parsed.size(); ++i) {
+        auto &r = parsed[i];
+        if (r.ec) {
+            result.document = Document{};
+            result.ec = r.ec;
+            result.error_line = r.error_line;
+            result.error_column = r.error_column;
+            result.error_message = std::move(r.error_message);
+            out_error_source = slices[i].source_index;
+            return result;
+        }
+        append_moved(result.document.messages, r.document.messages);
+        append_moved(result.document.conditions, r.document.conditions);
+        append_moved(result.document.timers, r.document.timers);
+    }
+    return result;
+}
+
+} // namespace
+
+ParseResult parse_sml_parallel(std::string_view source,
+                               const LibraryLoadOptions &options) noexcept {
+    ParseResult out;
+    try {
+        std::size_t error_source = 0;
+        auto result = parse_sources({source}, options, error_source);
+        out.document = std::move(result.document);
+        out.ec = result.ec;
+        out.error_line = result.error_line;
+        out.error_column = result.error_column;
+        out.error_message = std::move(result.error_message);
+    } catch (const std::bad_alloc &) {
+        out = ParseResult{};
+        out.ec = secs::core::make_error_code(secs::core::errc::out_of_memory);
+        out.error_message = "out of memory";
+    } catch (...) {
+        out = ParseResult{};
+        out.ec = secs::core::make_error_code(secs::core::errc::invalid_argument);
+        out.error_message = "unexpected exception";
+    }
+    return out;
+}
+
+LibraryParseResult parse_sml_files(const std::vector<std::string> &paths,
+                                   const LibraryLoadOptions &options) noexcept {
+    try {
+        std::vector<MappedFile> files(paths.size());
+        std::vector<std::string_view> sources;
+        sources.reserve(paths.size());
+        for (std::size_t i = 0; i < paths.size(); ++i) {
+            const auto ec = files[i].open(paths[i]);
+            if (ec) {
+                LibraryParseResult result;
+                result.ec = ec;
+                result.error_path = paths[i];
+                result.error_message = "cannot open file: " + ec.message();
+                return result;
+            }
+            sources.push_back(files[i].view());
+        }
+
+        std::size_t error_source = 0;
+        auto result = parse_sources(sources, options, error_source);
+        if (result.ec) {
+            result.error_path = paths[error_source];
+        }
+        return result;
+    } catch (const std::bad_alloc &) {
+        LibraryParseResult result;
+        result.ec = secs::core::make_error_code(secs::core::errc::out_of_memory);
+        result.error_message = "out of memory";
+        return result;
+    } catch (...) {
+        LibraryParseResult result;
+        result.ec = secs::core::make_error_code(secs::core::errc::invalid_argument);
+        result.error_message = "unexpected exception";
+        return result;
+    }
+}
+
+std::error_code Runtime::load_files(const std::vector<std::string> &paths,
+                                    const LibraryLoadOptions &options) noexcept {
+    try {
+        auto result = parse_sml_files(paths, options);
+        if (result.ec) {
+            return result.ec;
+        }
+
+        load(std::move(result.document));
+        if (!loaded_) {
+            return secs::core::make_error_code(secs::core::errc::out_of_memory);
+        }
+        return {};
+    } catch (const std::bad_alloc &) {
+        return secs::core::make_error_code(secs::core::errc::out_of_memory);
+    } catch (...) {
+        return secs::core::make_error_code(secs::core::errc::invalid_argument);
+    }
+}
+
+} // namespace secs::sml
@@ -3,6 +3,7 @@
 #include <charconv>
 #include <cstdlib>
 #include <limits>
+#include <string>
 
 namespace secs::sml {
 
@@ -10,7 +11,7 @@ namespace secs::sml {
  * SML（SECS Message Language）语法分析器实现。
  *
  * 输入/输出：
- * - 输入：Lexer 产生的 Token 序列
+ * - 输入：Lexer 产生的 Token 序列，或直接从 Lexer 流式拉取（见 fetch()）
  * - 输出：Document AST（消息模板、定时规则、条件响应规则等）
  *
  * 解析要点：
@@ -162,9 +163,31 @@ parse_int64_literal(std::string_view text) noexcept {
 }
 
 double parse_float_value(std::string_view text) {
-    // token.value 来自 std::string，按 C++20 约定以 '\0' 结尾，可直接交给
-    // strtod。
-    return std::strtod(text.data(), nullptr);
+    // token.value 是指向源文本的视图（不以 '\0' 结尾），不能交给 strtod。
+    // F4/F8 也接受 Integer token：十六进制整数按数值转换（与 strtod 行为一致）。
+    std::string_view digits = text;
+    const bool negative = !digits.empty() && digits.front() == '-';
+    if (negative) {
+        digits.remove_prefix(1);
+    }
+    if (digits.size() > 2 && digits[0] == '0' &&
+        (digits[1] == 'x' || digits[1] == 'X')) {
+        const auto mag = parse_uint64_literal(digits);
+        const double v = mag ? static_cast<double>(*mag) : 0.0;
+        return negative ? -v : v;
+    }
+
+    double value = 0.0;
+    const auto [ptr, ec] =
+        std::from_chars(text.data(), text.data() + text.size(), value);
+    (void)ptr;
+    if (ec == std::errc::result_out_of_range) {
+        // from_chars 越界时不写 value；按 strtod 的语义取值（上溢为 ±HUGE_VAL，
+        // 下溢为 0 或次正规数），与改用 from_chars 之前的结果一致。
+        const std::string terminated(text);
+        return std::strtod(terminated.c_str(), nullptr);
+    }
+    return value;
 }
 
 template <class T>
@@ -255,7 +278,10 @@ std::error_code make_error_code(parser_errc e) noexcept {
 Parser::Parser(std::vector<Token> tokens) noexcept
     : tokens_(std::move(tokens)) {}
 
+Parser::Parser(Lexer &lexer) noexcept : lexer_(&lexer) {}
+
 ParseResult Parser::parse() noexcept {
+    lookahead_ = fetch();
     while (!at_end() && !had_error_) {
         parse_statement();
     }
@@ -269,15 +295,40 @@ ParseResult Parser::parse() noexcept {
     return result;
 }
 
+Token Parser::fetch() noexcept {
+    if (lexer_) {
+        Token token = lexer_->next_token();
+        if (token.type == TokenType::Error) {
+            // 词法错误优先于后续任何语法错误：记录后以 Eof 结束解析。
+            if (!had_error_) {
+                had_error_ = true;
+                ec_ = lexer_->error();
+                error_line_ = token.line;
+                error_column_ = token.column;
+                error_message_ = lexer_->error_message();
+            }
+            return Token{TokenType::Eof, {}, token.line, token.column};
+        }
+        return token;
+    }
+
+    if (next_index_ < tokens_.size()) {
+        return tokens_[next_index_++];
+    }
+    return Token{TokenType::Eof};
+}
+
 bool Parser::at_end() const noexcept { return peek().type == TokenType::Eof; }
 
-const Token &Parser::peek() const noexcept { return tokens_[current_]; }
+const Token &Parser::peek() const noexcept { return lookahead_; }
 
-const Token &Parser::previous() const noexcept { return tokens_[current_ - 1]; }
+const Token &Parser::previous() const noexcept { return previous_; }
 
 const Token &Parser::advance() noexcept {
-    if (!at_end())
-        ++current_;
+    if (!at_end()) {
+        previous_ = lookahead_;
+        lookahead_ = fetch();
+    }
     return previous();
 }
 
@@ -317,7 +368,7 @@ bool Parser::parse_message_def() noexcept {
     // 3. 匿名消息：SxFy [W] <Item>.
     // 4. 匿名消息：SxFy.（无消息体）
 
-    std::string first_token;
+    std::string_view first_token;
 
     if (!check(TokenType::Identifier) && !check(TokenType::LAngle)) {
         error("expected message definition");
@@ -349,7 +400,8 @@ bool Parser::parse_message_def() noexcept {
     // 解析 SxFy
     if (!parse_sf_string(first_token, msg.stream, msg.function)) {
         error(parser_errc::invalid_stream_function,
-              "invalid stream/function format: " + first_token);
+              std::string("invalid stream/function format: ")
+                  .append(first_token));
         return false;
     }
 
@@ -540,11 +592,11 @@ std::optional<TemplateItem> Parser::parse_ascii() noexcept {
 
     TplASCII a;
     if (check(TokenType::String)) {
-        a.value = advance().value;
+        a.value = std::string(advance().value);
         return TemplateItem(std::move(a));
     }
     if (check(TokenType::Identifier)) {
-        a.value = VarRef{advance().value};
+        a.value = VarRef{std::string(advance().value)};
         return TemplateItem(std::move(a));
     }
 
@@ -559,7 +611,7 @@ std::optional<TemplateItem> Parser::parse_binary() noexcept {
     TplBinary b;
     while (check(TokenType::Integer) || check(TokenType::Identifier)) {
         if (check(TokenType::Identifier)) {
-            b.values.emplace_back(VarRef{advance().value});
+            b.values.emplace_back(VarRef{std::string(advance().value)});
             continue;
         }
 
@@ -581,7 +633,7 @@ std::optional<TemplateItem> Parser::parse_boolean() noexcept {
     TplBoolean b;
     while (check(TokenType::Integer) || check(TokenType::Identifier)) {
         if (check(TokenType::Identifier)) {
-            b.values.emplace_back(VarRef{advance().value});
+            b.values.emplace_back(VarRef{std::string(advance().value)});
             continue;
         }
 
@@ -604,7 +656,7 @@ std::optional<TemplateItem> Parser::parse_unsigned(TokenType type) noexcept {
         TplU1 v;
         while (check(TokenType::Integer) || check(TokenType::Identifier)) {
             if (check(TokenType::Identifier)) {
-                v.values.emplace_back(VarRef{advance().value});
+                v.values.emplace_back(VarRef{std::string(advance().value)});
                 continue;
             }
 
@@ -622,7 +674,7 @@ std::optional<TemplateItem> Parser::parse_unsigned(TokenType type) noexcept {
         TplU2 v;
         while (check(TokenType::Integer) || check(TokenType::Identifier)) {
             if (check(TokenType::Identifier)) {
-                v.values.emplace_back(VarRef{advance().value});
+                v.values.emplace_back(VarRef{std::string(advance().value)});
                 continue;
             }
 
@@ -640,7 +692,7 @@ std::optional<TemplateItem> Parser::parse_unsigned(TokenType type) noexcept {
         TplU4 v;
         while (check(TokenType::Integer) || check(TokenType::Identifier)) {
             if (check(TokenType::Identifier)) {
-                v.values.emplace_back(VarRef{advance().value});
+                v.values.emplace_back(VarRef{std::string(advance().value)});
                 continue;
             }
 
@@ -658,7 +710,7 @@ std::optional<TemplateItem> Parser::parse_unsigned(TokenType type) noexcept {
         TplU8 v;
         while (check(TokenType::Integer) || check(TokenType::Identifier)) {
             if (check(TokenType::Identifier)) {
-                v.values.emplace_back(VarRef{advance().value});
+                v.values.emplace_back(VarRef{std::string(advance().value)});
                 continue;
             }
 
@@ -684,7 +736,7 @@ std::optional<TemplateItem> Parser::parse_signed(TokenType type) noexcept {
         TplI1 v;
         while (check(TokenType::Integer) || check(TokenType::Identifier)) {
             if (check(TokenType::Identifier)) {
-                v.values.emplace_back(VarRef{advance().value});
+                v.values.emplace_back(VarRef{std::string(advance().value)});
                 continue;
             }
 
@@ -703,7 +755,7 @@ std::optional<TemplateItem> Parser::parse_signed(TokenType type) noexcept {
         TplI2 v;
         while (check(TokenType::Integer) || check(TokenType::Identifier)) {
             if (check(TokenType::Identifier)) {
-                v.values.emplace_back(VarRef{advance().value});
+                v.values.emplace_back(VarRef{std::string(advance().value)});
                 continue;
             }
 
@@ -722,7 +774,7 @@ std::optional<TemplateItem> Parser::parse_signed(TokenType type) noexcept {
         TplI4 v;
         while (check(TokenType::Integer) || check(TokenType::Identifier)) {
             if (check(TokenType::Identifier)) {
-                v.values.emplace_back(VarRef{advance().value});
+                v.values.emplace_back(VarRef{std::string(advance().value)});
                 continue;
             }
 
@@ -741,7 +793,7 @@ std::optional<TemplateItem> Parser::parse_signed(TokenType type) noexcept {
         TplI8 v;
         while (check(TokenType::Integer) || check(TokenType::Identifier)) {
             if (check(TokenType::Identifier)) {
-                v.values.emplace_back(VarRef{advance().value});
+                v.values.emplace_back(VarRef{std::string(advance().value)});
                 continue;
             }
 
@@ -767,7 +819,7 @@ std::optional<TemplateItem> Parser::parse_float(TokenType type) noexcept {
         while (check(TokenType::Float) || check(TokenType::Integer) ||
                check(TokenType::Identifier)) {
             if (check(TokenType::Identifier)) {
-                v.values.emplace_back(VarRef{advance().value});
+                v.values.emplace_back(VarRef{std::string(advance().value)});
                 continue;
             }
             v.values.emplace_back(
@@ -779,7 +831,7 @@ std::optional<TemplateItem> Parser::parse_float(TokenType type) noexcept {
         while (check(TokenType::Float) || check(TokenType::Integer) ||
                check(TokenType::Identifier)) {
             if (check(TokenType::Identifier)) {
-                v.values.emplace_back(VarRef{advance().value});
+                v.values.emplace_back(VarRef{std::string(advance().value)});
                 continue;
             }
             v.values.emplace_back(parse_float_value(advance().value));
@@ -865,7 +917,10 @@ void Parser::error_at(parser_errc code,
     ec_ = make_error_code(code);
     error_line_ = token.line;
     error_column_ = token.column;
-    error_message_ = std::string(message) + " at '" + token.value + "'";
+    error_message_.assign(message);
+    error_message_ += " at '";
+    error_message_ += token.value;
+    error_message_ += '\'';
 }
 
 } // namespace secs::sml
@@ -2,6 +2,8 @@
 
 #include "secs/core/error.hpp"
 
+#include <bit>
+#include <cstdint>
 #include <new>
 #include <system_error>
 #include <type_traits>
@@ -145,6 +147,186 @@ template <class T, class IiT, class MakeFn>
     return {};
 }
 
+// ---------------------------------------------------------------------------
+// 预编码模板（EncodedTemplate）
+// ---------------------------------------------------------------------------
+
+// 与 ii::codec 的头部编码规则保持一致：Length 字段取最短的 1..3 字节。
+[[nodiscard]] bool append_header(secs::ii::format_code code,
+                                 std::size_t length,
+                                 std::vector<secs::ii::byte> &out) {
+    if (length > secs::ii::kMaxLength) {
+        return false;
+    }
+    const auto v = static_cast<std::uint32_t>(length);
+    const std::uint8_t length_bytes = v <= 0xFFu ? 1 : (v <= 0xFFFFu ? 2 : 3);
+    out.push_back(static_cast<secs::ii::byte>(
+        (static_cast<std::uint8_t>(code) << 2) | length_bytes));
+    for (std::uint8_t i = 0; i < length_bytes; ++i) {
+        const auto shift = static_cast<unsigned>(8u * (length_bytes - 1u - i));
+        out.push_back(static_cast<secs::ii::byte>((v >> shift) & 0xFFu));
+    }
+    return true;
+}
+
+template <class UInt>
+void put_be(secs::ii::byte *dst, UInt v) noexcept {
+    for (std::size_t i = 0; i < sizeof(UInt); ++i) {
+        const auto shift = static_cast<unsigned>(8u * (sizeof(UInt) - 1u - i));
+        dst[i] = static_cast<secs::ii::byte>((v >> shift) & 0xFFu);
+    }
+}
+
+template <class T>
+void put_value(secs::ii::byte *dst, T v) noexcept {
+    if constexpr (std::is_same_v<T, bool>) {
+        dst[0] = static_cast<secs::ii::byte>(v ? 0x01 : 0x00);
+    } else if constexpr (sizeof(T) == 1) {
+        dst[0] = static_cast<secs::ii::byte>(v);
+    } else if constexpr (sizeof(T) == 2) {
+        put_be(dst, std::bit_cast<std::uint16_t>(v));
+    } else if constexpr (sizeof(T) == 4) {
+        put_be(dst, std::bit_cast<std::uint32_t>(v));
+    } else {
+        put_be(dst, std::bit_cast<std::uint64_t>(v));
+    }
+}
+
+template <class T>
+[[nodiscard]] bool compile_values(secs::ii::format_code code,
+                                  const std::vector<ValueExpr<T>> &exprs,
+                                  EncodedTemplate &out) {
+    constexpr std::size_t width = std::is_same_v<T, bool> ? 1 : sizeof(T);
+    if (!append_header(code, exprs.size() * width, out.image)) {
+        return false;
+    }
+    for (const auto &expr : exprs) {
+        const auto offset = out.image.size();
+        out.image.resize(offset + width);
+        if (const auto *lit = std::get_if<T>(&expr)) {
+            put_value(out.image.data() + offset, *lit);
+        } else {
+            const auto &ref = std::get<VarRef>(expr);
+            out.slots.push_back(EncodedTemplate::Slot{offset, ref.name, code});
+        }
+    }
+    return true;
+}
+
+[[nodiscard]] bool compile_node(const TemplateItem &tpl, EncodedTemplate &out) {
+    using secs::ii::format_code;
+    return std::visit(
+        [&](const auto &alt) -> bool {
+            using T = std::decay_t<decltype(alt)>;
+            if constexpr (std::is_same_v<T, TplList>) {
+                if (!append_header(format_code::list, alt.size(), out.image)) {
+                    return false;
+                }
+                for (const auto &child : alt) {
+                    if (!compile_node(child, out)) {
+                        return false;
+                    }
+                }
+                return true;
+            } else if constexpr (std::is_same_v<T, TplASCII>) {
+                const auto *s = std::get_if<std::string>(&alt.value);
+                if (!s) {
+                    return false; // 变长替换：只能走慢路径
+                }
+                if (!append_header(format_code::ascii, s->size(), out.image)) {
+                    return false;
+                }
+                out.image.insert(out.image.end(), s->begin(), s->end());
+                return true;
+            } else if constexpr (std::is_same_v<T, TplBinary>) {
+                return compile_values(format_code::binary, alt.values, out);
+            } else if constexpr (std::is_same_v<T, TplBoolean>) {
+                return compile_values(format_code::boolean, alt.values, out);
+            } else if constexpr (std::is_same_v<T, TplI1>) {
+                return compile_values(format_code::i1, alt.values, out);
+            } else if constexpr (std::is_same_v<T, TplI2>) {
+                return compile_values(format_code::i2, alt.values, out);
+            } else if constexpr (std::is_same_v<T, TplI4>) {
+                return compile_values(format_code::i4, alt.values, out);
+            } else if constexpr (std::is_same_v<T, TplI8>) {
+                return compile_values(format_code::i8, alt.values, out);
+            } else if constexpr (std::is_same_v<T, TplU1>) {
+                return compile_values(format_code::u1, alt.values, out);
+            } else if constexpr (std::is_same_v<T, TplU2>) {
+                return compile_values(format_code::u2, alt.values, out);
+            } else if constexpr (std::is_same_v<T, TplU4>) {
+                return compile_values(format_code::u4, alt.values, out);
+            } else if constexpr (std::is_same_v<T, TplU8>) {
+                return compile_values(format_code::u8, alt.values, out);
+            } else if constexpr (std::is_same_v<T, TplF4>) {
+                return compile_values(format_code::f4, alt.values, out);
+            } else if constexpr (std::is_same_v<T, TplF8>) {
+                return compile_values(format_code::f8, alt.values, out);
+            } else {
+                return false;
+            }
+        },
+        tpl.storage());
+}
+
+// 取变量中“恰好 1 个值”的数值类 Item 并写入补丁位置。
+template <class IiT>
+[[nodiscard]] bool patch_single(const secs::ii::Item &v,
+                                secs::ii::byte *dst) noexcept {
+    const auto *tv = v.get_if<IiT>();
+    if (!tv || tv->values.size() != 1) {
+        return false;
+    }
+    put_value(dst, tv->values.front());
+    return true;
+}
+
+[[nodiscard]] bool patch_slot(const EncodedTemplate::Slot &slot,
+                              const secs::ii::Item &v,
+                              secs::ii::byte *dst) noexcept {
+    using secs::ii::format_code;
+    switch (slot.format) {
+    case format_code::binary: {
+        const auto *bin = v.get_if<secs::ii::Binary>();
+        if (!bin || bin->value.size() != 1) {
+            return false;
+        }
+        dst[0] = bin->value.front();
+        return true;
+    }
+    case format_code::boolean: {
+        const auto *bv = v.get_if<secs::ii::Boolean>();
+        if (!bv || bv->values.size() != 1) {
+            return false;
+        }
+        put_value(dst, static_cast<bool>(bv->values.front()));
+        return true;
+    }
+    case format_code::i1:
+        return patch_single<secs::ii::I1>(v, dst);
+    case format_code::i2:
+        return patch_single<secs::ii::I2>(v, dst);
+    case format_code::i4:
+        return patch_single<secs::ii::I4>(v, dst);
+    case format_code::i8:
+        return patch_single<secs::ii::I8>(v, dst);
+    case format_code::u1:
+        return patch_single<secs::ii::U1>(v, dst);
+    case format_code::u2:
+        return patch_single<secs::ii::U2>(v, dst);
+    case format_code::u4:
+        return patch_single<secs::ii::U4>(v, dst);
+    case format_code::u8:
+        return patch_single<secs::ii::U8>(v, dst);
+    case format_code::f4:
+        return patch_single<secs::ii::F4>(v, dst);
+    case format_code::f8:
+        return patch_single<secs::ii::F8>(v, dst);
+    default:
+        return false;
+    }
+}
+
 } // namespace
 
 const std::error_category &render_error_category() noexcept {
@@ -225,4 +407,46 @@ std::error_code render_item(const TemplateItem &tpl,
     }
 }
 
+bool compile_template(const TemplateItem &tpl, EncodedTemplate &out) noexcept {
+    out.image.clear();
+    out.slots.clear();
+    out.fast_path = false;
+    try {
+        if (!compile_node(tpl, out)) {
+            out.image.clear();
+            out.slots.clear();
+            return false;
+        }
+        out.image.shrink_to_fit();
+        out.fast_path = true;
+        return true;
+    } catch (...) {
+        out.image.clear();
+        out.slots.clear();
+        return false;
+    }
+}
+
+bool patch_template(const EncodedTemplate &compiled,
+                    const RenderContext &ctx,
+                    std::vector<secs::ii::byte> &out) noexcept {
+    if (!compiled.fast_path) {
+        return false;
+    }
+    try {
+        out.assign(compiled.image.begin(), compiled.image.end());
+        for (const auto &slot : compiled.slots) {
+            const auto *v = ctx.get(slot.var);
+            if (!v || !patch_slot(slot, *v, out.data() + slot.offset)) {
+                out.clear();
+                return false;
+            }
+        }
+        return true;
+    } catch (...) {
+        out.clear();
+        return false;
+    }
+}
+
 } // namespace secs::sml
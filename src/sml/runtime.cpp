@@ -1,10 +1,12 @@
 #include "secs/sml/runtime.hpp"
 
+#include "secs/core/memory_budget.hpp"
 #include "secs/ii/codec.hpp"
 #include "secs/sml/render.hpp"
 
 #include <charconv>
 #include <cmath>
+#include <cstring>
 #include <limits>
 #include <new>
 
@@ -15,14 +17,15 @@ namespace secs::sml {
  *
  * 主要职责：
  * - build_index()：构建 “name -> tell index” 与 “(S,F) -> index” 的索引，便于 O(1)
- *   查找消息模板；
+ *   查找消息模板；同时把条件规则预编译并按 (S,F) 分桶、把消息模板预编码为字节镜像；
  * - match_response()：按条件规则匹配入站消息，返回对应的响应消息名；
+ * - match_response_encoded()：直接在编码后的 body 上匹配（预编码期望值 + memcmp）；
  * - items_equal()：为条件匹配提供 Item 比较语义（其中浮点采用容差比较，提高规则
  *   易用性；其它类型复用 ii::Item 的严格相等）。
  *
  * 与 SECS-II 的关系：
- * - Runtime 处理的是“结构化 Item”（ii::Item），不直接处理 on-wire 编解码；
- * - 需要从字节解析时，应先用 ii::codec 解码为 Item，再交给 Runtime 匹配。
+ * - match_response() 处理的是“结构化 Item”（ii::Item）；
+ * - 入站消息本身就是字节时，优先使用 match_response_encoded()，省去解码建树。
  */
 
 namespace {
@@ -114,6 +117,146 @@ find_preorder_nth(const ii::Item &root, std::size_t n) noexcept {
     return found;
 }
 
+[[nodiscard]] constexpr std::uint16_t sf_key(std::uint8_t stream,
+                                             std::uint8_t function) noexcept {
+    return static_cast<std::uint16_t>((static_cast<std::uint16_t>(stream) << 8) |
+                                      static_cast<std::uint16_t>(function));
+}
+
+// Boolean 解码时会把非 0 字节归一化为 true，编码字节不唯一，不能直接 memcmp。
+[[nodiscard]] bool contains_boolean(const ii::Item &item) noexcept {
+    if (item.get_if<ii::Boolean>()) {
+        return true;
+    }
+    if (const auto *list = item.get_if<ii::List>()) {
+        for (const auto &child : *list) {
+            if (contains_boolean(child)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// 浮点按容差比较（items_equal），-0.0/0.0、NaN 的位模式也与数值语义不一致，不能 memcmp。
+[[nodiscard]] bool contains_float(const ii::Item &item) noexcept {
+    if (item.get_if<ii::F4>() || item.get_if<ii::F8>()) {
+        return true;
+    }
+    if (const auto *list = item.get_if<ii::List>()) {
+        for (const auto &child : *list) {
+            if (contains_float(child)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// 读取位于 pos 的 Item 头部（调用方保证 body 已通过 ii 校验，这里仍做边界检查）。
+[[nodiscard]] bool read_encoded_header(ii::bytes_view body,
+                                       std::size_t pos,
+                                       bool &is_list,
+                                       std::uint32_t &length,
+                                       std::size_t &header_size) noexcept {
+    if (pos >= body.size()) {
+        return false;
+    }
+    const auto format_byte = body[pos];
+    const auto length_bytes = static_cast<std::size_t>(format_byte & 0x03u);
+    if (length_bytes == 0 || body.size() - pos - 1 < length_bytes) {
+        return false;
+    }
+    std::uint32_t v = 0;
+    for (std::size_t i = 0; i < length_bytes; ++i) {
+        v = (v << 8) | static_cast<std::uint32_t>(body[pos + 1 + i]);
+    }
+    is_list = (format_byte >> 2) == static_cast<std::uint8_t>(ii::format_code::list);
+    length = v;
+    header_size = 1 + length_bytes;
+    return true;
+}
+
+// find_preorder_nth 的字节版本：SECS-II 编码本身就是先序序列，第 n 个头部即
+// 第 n 个节点；找到后跳过其整棵子树，得到该节点的完整编码区间。
+[[nodiscard]] bool find_preorder_nth_encoded(ii::bytes_view body,
+                                             std::size_t n,
+                                             ii::bytes_view &out) noexcept {
+    if (n < 1) {
+        return false;
+    }
+
+    bool is_list = false;
+    std::uint32_t length = 0;
+    std::size_t header_size = 0;
+
+    std::size_t pos = 0;
+    for (std::size_t cur = 1; cur < n; ++cur) {
+        if (!read_encoded_header(body, pos, is_list, length, header_size)) {
+            return false;
+        }
+        pos += header_size + (is_list ? 0 : length);
+    }
+
+    const auto begin = pos;
+    std::size_t pending = 1;
+    while (pending > 0) {
+        if (!read_encoded_header(body, pos, is_list, length, header_size)) {
+            return false;
+        }
+        --pending;
+        pos += header_size;
+        if (is_list) {
+            pending += length;
+        } else {
+            if (body.size() - pos < length) {
+                return false;
+            }
+            pos += length;
+        }
+    }
+
+    out = body.subspan(begin, pos - begin);
+    return true;
+}
+
+// 逐节点比较两段编码：格式码、长度值与叶子 payload 必须一致，长度字段占几个字节不参与
+// 比较（解码端接受非最短的 1..3 字节长度，期望值总是最短编码）。
+[[nodiscard]] bool encoded_items_equal(ii::bytes_view a, ii::bytes_view b) noexcept {
+    std::size_t pa = 0;
+    std::size_t pb = 0;
+    std::size_t pending = 1;
+    while (pending > 0) {
+        bool a_list = false;
+        bool b_list = false;
+        std::uint32_t a_len = 0;
+        std::uint32_t b_len = 0;
+        std::size_t a_hdr = 0;
+        std::size_t b_hdr = 0;
+        if (!read_encoded_header(a, pa, a_list, a_len, a_hdr) ||
+            !read_encoded_header(b, pb, b_list, b_len, b_hdr)) {
+            return false;
+        }
+        if ((a[pa] >> 2) != (b[pb] >> 2) || a_len != b_len) {
+            return false;
+        }
+        --pending;
+        pa += a_hdr;
+        pb += b_hdr;
+        if (a_list) {
+            pending += a_len;
+            continue;
+        }
+        if (a.size() - pa < a_len || b.size() - pb < b_len ||
+            std::memcmp(a.data() + pa, b.data() + pb, a_len) != 0) {
+            return false;
+        }
+        pa += a_len;
+        pb += b_len;
+    }
+    return pa == a.size() && pb == b.size();
+}
+
 } // namespace
 
 std::error_code Runtime::load(std::string_view source) noexcept {
@@ -147,6 +290,9 @@ void Runtime::load(Document doc) noexcept {
 bool Runtime::build_index() noexcept {
     name_index_.clear();
     sf_index_.clear();
+    compiled_messages_.clear();
+    compiled_conditions_.clear();
+    condition_index_.clear();
     try {
         for (std::size_t i = 0; i < document_.messages.size(); ++i) {
             const auto &msg = document_.messages[i];
@@ -160,22 +306,88 @@ bool Runtime::build_index() noexcept {
             // - 匿名消息（name 为空）始终占优：与历史行为一致（优先按 sf_index_ 命中）。
             // - 命名消息仅在“该 SF 尚未有匿名定义”时进入索引；同 SF 多条命名消息时，
             //   保持“第一条命中”的兼容语义（历史实现为 O(N) 线性扫描并返回首个匹配）。
-            std::uint16_t key = (static_cast<std::uint16_t>(msg.stream) << 8) |
-                                static_cast<std::uint16_t>(msg.function);
+            const auto key = sf_key(msg.stream, msg.function);
             if (msg.name.empty()) {
                 sf_index_[key] = i;
             } else if (sf_index_.find(key) == sf_index_.end()) {
                 sf_index_[key] = i;
             }
         }
-        return true;
+
+        // 预编码消息模板：不支持快路径的模板（ASCII 占位符等）保留 fast_path=false，
+        // 发送时走 render_item + encode。
+        compiled_messages_.resize(document_.messages.size());
+        for (std::size_t i = 0; i < document_.messages.size(); ++i) {
+            (void)compile_template(document_.messages[i].item,
+                                   compiled_messages_[i]);
+        }
+        // 条件规则依赖消息名解析，必须在消息索引建好之后编译。
+        return build_condition_index();
     } catch (...) {
         name_index_.clear();
         sf_index_.clear();
+        compiled_conditions_.clear();
+        condition_index_.clear();
         return false;
     }
 }
 
+bool Runtime::build_condition_index() {
+    const auto &rules = document_.conditions;
+    compiled_conditions_.reserve(rules.size());
+
+    const RenderContext empty_ctx{};
+    for (std::size_t i = 0; i < rules.size(); ++i) {
+        const auto &cond = rules[i].condition;
+
+        // 条件可以直接写 SxFy，也可以是消息名（与 get_message 的解析顺序相反：
+        // 这里优先按 SxFy 解释，保持历史匹配语义）。
+        std::uint8_t stream = 0;
+        std::uint8_t function = 0;
+        if (!parse_sf(cond.message_name, stream, function)) {
+            const MessageDef *msg = get_message(cond.message_name);
+            if (!msg) {
+                continue; // 消息名不存在：该规则永远不会命中
+            }
+            stream = msg->stream;
+            function = msg->function;
+        }
+
+        CompiledCondition cc;
+        cc.rule_index = i;
+        if (cond.index && cond.expected) {
+            cc.item_index = cond.index;
+
+            ii::Item rendered{ii::List{}};
+            if (render_item(*cond.expected, empty_ctx, rendered)) {
+                cc.needs_render = true;
+            } else {
+                // 浮点（任意层级）按容差比较，Boolean 编码不唯一：两者都不能按字节比较。
+                if (!contains_float(rendered) && !contains_boolean(rendered) &&
+                    !ii::encode(rendered, cc.expected_bytes)) {
+                    cc.memcmp_comparable = true;
+                }
+                cc.expected = std::move(rendered);
+            }
+        }
+
+        condition_index_[sf_key(stream, function)].push_back(
+            compiled_conditions_.size());
+        compiled_conditions_.push_back(std::move(cc));
+    }
+    return true;
+}
+
+const std::vector<std::size_t> *
+Runtime::conditions_for(std::uint8_t stream,
+                        std::uint8_t function) const noexcept {
+    auto it = condition_index_.find(sf_key(stream, function));
+    if (it == condition_index_.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
 const MessageDef *Runtime::get_message(std::string_view name) const noexcept {
     auto it = name_index_.find(name);
     if (it != name_index_.end()) {
@@ -193,9 +405,7 @@ const MessageDef *Runtime::get_message(std::string_view name) const noexcept {
 
 const MessageDef *Runtime::get_message(std::uint8_t stream,
                                        std::uint8_t function) const noexcept {
-    std::uint16_t key = (static_cast<std::uint16_t>(stream) << 8) |
-                        static_cast<std::uint16_t>(function);
-    auto it = sf_index_.find(key);
+    auto it = sf_index_.find(sf_key(stream, function));
     if (it != sf_index_.end()) {
         return &document_.messages[it->second];
     }
@@ -206,17 +416,8 @@ std::optional<std::string>
 Runtime::match_response(std::uint8_t stream,
                         std::uint8_t function,
                         const ii::Item &item) const noexcept {
-    try {
-        RenderContext ctx{};
-        for (const auto &rule : document_.conditions) {
-            if (match_condition(rule.condition, stream, function, item, ctx)) {
-                return rule.response_name;
-            }
-        }
-        return std::nullopt;
-    } catch (...) {
-        return std::nullopt;
-    }
+    const RenderContext ctx{};
+    return match_response(stream, function, item, ctx);
 }
 
 std::optional<std::string>
@@ -225,9 +426,15 @@ Runtime::match_response(std::uint8_t stream,
                         const ii::Item &item,
                         const RenderContext &ctx) const noexcept {
     try {
-        for (const auto &rule : document_.conditions) {
-            if (match_condition(rule.condition, stream, function, item, ctx)) {
-                return rule.response_name;
+        const auto *bucket = conditions_for(stream, function);
+        if (!bucket) {
+            return std::nullopt;
+        }
+        // 桶内保持文档顺序；同一规则只属于一个 (S,F)，因此桶内首个命中即全局首个命中。
+        for (const auto idx : *bucket) {
+            const auto &cc = compiled_conditions_[idx];
+            if (match_compiled(cc, item, ctx)) {
+                return document_.conditions[cc.rule_index].response_name;
             }
         }
         return std::nullopt;
@@ -236,6 +443,42 @@ Runtime::match_response(std::uint8_t stream,
     }
 }
 
+std::error_code
+Runtime::match_response_encoded(std::uint8_t stream,
+                                std::uint8_t function,
+                                secs::core::bytes_view body,
+                                const std::string *&out_name,
+                                const ii::DecodeLimits &limits) const noexcept {
+    out_name = nullptr;
+    try {
+        // 先做一次不建树的完整校验，保证与“decode_one 后匹配”的错误语义一致。
+        ii::EncodedVisitor validator;
+        std::size_t consumed = 0;
+        const auto ec = ii::visit_encoded(body, validator, consumed, limits);
+        if (ec) {
+            return ec;
+        }
+        body = body.first(consumed);
+
+        const auto *bucket = conditions_for(stream, function);
+        if (!bucket) {
+            return {};
+        }
+        for (const auto idx : *bucket) {
+            const auto &cc = compiled_conditions_[idx];
+            if (match_compiled_encoded(cc, body, limits)) {
+                out_name = &document_.conditions[cc.rule_index].response_name;
+                return {};
+            }
+        }
+        return {};
+    } catch (const std::bad_alloc &) {
+        return secs::core::make_error_code(secs::core::errc::out_of_memory);
+    } catch (...) {
+        return secs::core::make_error_code(secs::core::errc::invalid_argument);
+    }
+}
+
 std::error_code
 Runtime::encode_message_body(std::string_view name_or_sf,
                              const RenderContext &ctx,
@@ -251,15 +494,25 @@ Runtime::encode_message_body(std::string_view name_or_sf,
             return secs::core::make_error_code(secs::core::errc::invalid_argument);
         }
 
-        secs::ii::Item rendered{secs::ii::List{}};
-        const auto render_ec = secs::sml::render_item(msg->item, ctx, rendered);
-        if (render_ec) {
-            return render_ec;
-        }
+        const auto msg_index =
+            static_cast<std::size_t>(msg - document_.messages.data());
+        const bool patched =
+            msg_index < compiled_messages_.size() &&
+            patch_template(compiled_messages_[msg_index], ctx, out_body);
+        if (!patched) {
+            // 慢路径：多值展开、变长 ASCII，以及需要给出准确错误码的场景。
+            out_body.clear();
+            secs::ii::Item rendered{secs::ii::List{}};
+            const auto render_ec =
+                secs::sml::render_item(msg->item, ctx, rendered);
+            if (render_ec) {
+                return render_ec;
+            }
 
-        const auto enc_ec = secs::ii::encode(rendered, out_body);
-        if (enc_ec) {
-            return enc_ec;
+            const auto enc_ec = secs::ii::encode(rendered, out_body);
+            if (enc_ec) {
+                return enc_ec;
+            }
         }
 
         if (out_stream) {
@@ -279,56 +532,73 @@ Runtime::encode_message_body(std::string_view name_or_sf,
     }
 }
 
-bool Runtime::match_condition(const Condition &cond,
-                              std::uint8_t stream,
-                              std::uint8_t function,
-                              const ii::Item &item,
-                              const RenderContext &ctx) const noexcept {
-    // 检查消息名是否匹配
-    // 条件可以是消息名（如 s1f1），也可以直接写成 SxFy 格式（如 S1F1）
-
-    // 尝试解析为 SxFy
-    std::uint8_t cond_stream = 0, cond_function = 0;
-    const bool is_sf = parse_sf(cond.message_name, cond_stream, cond_function);
-
-    // 如果是 SxFy 格式，直接比较
-    if (is_sf) {
-        if (stream != cond_stream || function != cond_function) {
-            return false;
-        }
-    } else {
-        // 按消息名查找
-        const MessageDef *msg = get_message(cond.message_name);
-        if (!msg || msg->stream != stream || msg->function != function) {
-            return false;
-        }
+bool Runtime::match_compiled(const CompiledCondition &cc,
+                             const ii::Item &item,
+                             const RenderContext &ctx) const {
+    if (!cc.item_index) {
+        return true; // 仅按 (S,F) 匹配
     }
 
-    // 如果有索引和期望值，检查 Item
-    if (cond.index && cond.expected) {
-        // 兼容 sample.sml：索引采用“先序遍历编号（包含根节点）”。
-        // 注意：仅当根节点为 List 时允许索引匹配（避免对非 List 输入产生歧义）。
-        if (!item.get_if<ii::List>()) {
-            return false;
-        }
-
-        const std::size_t idx = *cond.index;
-        const ii::Item *elem = find_preorder_nth(item, idx);
-        if (!elem) {
-            return false;
-        }
+    // 兼容 sample.sml：索引采用“先序遍历编号（包含根节点）”。
+    // 注意：仅当根节点为 List 时允许索引匹配（避免对非 List 输入产生歧义）。
+    if (!item.get_if<ii::List>()) {
+        return false;
+    }
+    const ii::Item *elem = find_preorder_nth(item, *cc.item_index);
+    if (!elem) {
+        return false;
+    }
 
+    if (cc.needs_render) {
+        const auto &cond = document_.conditions[cc.rule_index].condition;
         ii::Item expected{ii::List{}};
         if (render_item(*cond.expected, ctx, expected)) {
             return false;
         }
+        return items_equal(*elem, expected);
+    }
+    return items_equal(*elem, *cc.expected);
+}
 
-        if (!items_equal(*elem, expected)) {
-            return false;
+bool Runtime::match_compiled_encoded(const CompiledCondition &cc,
+                                     secs::core::bytes_view body,
+                                     const ii::DecodeLimits &limits) const {
+    if (!cc.item_index) {
+        return true;
+    }
+    // 无渲染上下文：含占位符的期望值无法渲染，与 match_response(item) 一致视为不命中。
+    if (cc.needs_render) {
+        return false;
+    }
+    if (body.empty() ||
+        (body[0] >> 2) != static_cast<std::uint8_t>(ii::format_code::list)) {
+        return false;
+    }
+
+    ii::bytes_view elem{};
+    if (!find_preorder_nth_encoded(body, *cc.item_index, elem)) {
+        return false;
+    }
+
+    if (cc.memcmp_comparable) {
+        // 长度字段宽度相同（常见情况）时整段 memcmp；否则逐节点比较。
+        if (elem.size() == cc.expected_bytes.size() &&
+            std::memcmp(elem.data(), cc.expected_bytes.data(), elem.size()) == 0) {
+            return true;
         }
+        return encoded_items_equal(
+            elem, ii::bytes_view{cc.expected_bytes.data(), cc.expected_bytes.size()});
     }
 
-    return true;
+    // 回退路径：仅解码被比较的那个元素，再按 items_equal 语义比较；
+    // lease 与 decoded 同作用域，比较期间一直计入预算。
+    ii::Item decoded{ii::List{}};
+    secs::core::MemoryLease lease;
+    std::size_t consumed = 0;
+    if (ii::decode_one(elem, decoded, consumed, limits, lease)) {
+        return false;
+    }
+    return items_equal(decoded, *cc.expected);
 }
 
 bool Runtime::items_equal(const ii::Item &a, const ii::Item &b) const noexcept {
@@ -0,0 +1,215 @@
+#include "secs/utils/async_dump.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace secs::utils {
+namespace {
+
+// 把 HSMS 头部按线上格式写回，拼出完整帧交给 append_hsms_frame_dump。
+void build_hsms_frame_(const secs::hsms::Header &h,
+                       secs::core::bytes_view body,
+                       std::vector<secs::core::byte> &out) {
+    const auto len = static_cast<std::uint32_t>(secs::hsms::kHeaderSize + body.size());
+    out.resize(secs::hsms::kLengthFieldSize + secs::hsms::kHeaderSize + body.size());
+    auto *p = out.data();
+    p[0] = static_cast<secs::core::byte>(len >> 24U);
+    p[1] = static_cast<secs::core::byte>(len >> 16U);
+    p[2] = static_cast<secs::core::byte>(len >> 8U);
+    p[3] = static_cast<secs::core::byte>(len);
+    p[4] = static_cast<secs::core::byte>(h.session_id >> 8U);
+    p[5] = static_cast<secs::core::byte>(h.session_id);
+    p[6] = h.header_byte2;
+    p[7] = h.header_byte3;
+    p[8] = h.p_type;
+    p[9] = static_cast<secs::core::byte>(h.s_type);
+    p[10] = static_cast<secs::core::byte>(h.system_bytes >> 24U);
+    p[11] = static_cast<secs::core::byte>(h.system_bytes >> 16U);
+    p[12] = static_cast<secs::core::byte>(h.system_bytes >> 8U);
+    p[13] = static_cast<secs::core::byte>(h.system_bytes);
+    if (!body.empty()) {
+        std::memcpy(p + 14, body.data(), body.size());
+    }
+}
+
+} // namespace
+
+AsyncDumper::AsyncDumper(AsyncDumpOptions options)
+    : options_(std::move(options)),
+      capacity_(std::max<std::size_t>(options_.buffer_bytes, sizeof(RecordHead))) {
+    static_assert(std::is_trivially_copyable_v<RecordHead>);
+    ring_ = std::make_unique<secs::core::byte[]>(capacity_);
+    staging_.reserve(capacity_);
+    thread_ = std::thread([this] { run_(); });
+}
+
+AsyncDumper::~AsyncDumper() { stop(); }
+
+bool AsyncDumper::push_hsms(std::string_view title,
+                            const secs::hsms::Header &header,
+                            secs::core::bytes_view body) noexcept {
+    RecordHead head{};
+    head.kind = Kind::hsms;
+    head.hsms = header;
+    return push_(head, title, body);
+}
+
+bool AsyncDumper::push_secs1(std::string_view title,
+                             const secs::secs1::Header &header,
+                             secs::core::bytes_view body) noexcept {
+    RecordHead head{};
+    head.kind = Kind::secs1;
+    head.secs1 = header;
+    return push_(head, title, body);
+}
+
+bool AsyncDumper::push_(RecordHead head,
+                        std::string_view title,
+                        secs::core::bytes_view body) noexcept {
+    if (title.size() > std::numeric_limits<std::uint8_t>::max()) {
+        title = title.substr(0, std::numeric_limits<std::uint8_t>::max());
+    }
+    const std::size_t need = sizeof(RecordHead) + title.size() + body.size();
+
+    std::unique_lock lk(mu_);
+    if (stopping_ || need > capacity_ ||
+        capacity_ - static_cast<std::size_t>(head_ - tail_) < need) {
+        ++dropped_;
+        return false;
+    }
+
+    head.size = static_cast<std::uint32_t>(need);
+    head.body_size = static_cast<std::uint32_t>(body.size());
+    head.title_size = static_cast<std::uint8_t>(title.size());
+
+    const bool was_empty = (head_ == tail_);
+    auto pos = head_;
+    write_(pos, &head, sizeof(head));
+    pos += sizeof(head);
+    write_(pos, title.data(), title.size());
+    pos += title.size();
+    write_(pos, body.data(), body.size());
+    head_ += need;
+    lk.unlock();
+
+    if (was_empty) {
+        cv_.notify_one();
+    }
+    return true;
+}
+
+void AsyncDumper::write_(std::uint64_t pos, const void *src, std::size_t n) noexcept {
+    if (n == 0) {
+        return;
+    }
+    const auto off = static_cast<std::size_t>(pos % capacity_);
+    const auto first = std::min(n, capacity_ - off);
+    std::memcpy(ring_.get() + off, src, first);
+    if (first < n) {
+        std::memcpy(ring_.get(), static_cast<const secs::core::byte *>(src) + first,
+                    n - first);
+    }
+}
+
+void AsyncDumper::flush() noexcept {
+    std::unique_lock lk(mu_);
+    const auto target = head_;
+    done_cv_.wait(lk, [&] { return formatted_ >= target || finished_; });
+}
+
+void AsyncDumper::stop() noexcept {
+    {
+        std::lock_guard lk(mu_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+std::uint64_t AsyncDumper::dumped() const noexcept {
+    std::lock_guard lk(mu_);
+    return dumped_;
+}
+
+std::uint64_t AsyncDumper::dropped() const noexcept {
+    std::lock_guard lk(mu_);
+    return dropped_;
+}
+
+void AsyncDumper::run_() noexcept {
+    std::unique_lock lk(mu_);
+    for (;;) {
+        cv_.wait(lk, [&] { return head_ != tail_ || stopping_; });
+        if (head_ == tail_) {
+            break; // stopping_ 且已全部输出
+        }
+
+        // 在锁内把待处理区间整体搬到暂存区并立即释放环空间，格式化在锁外进行。
+        // staging_ 已在构造时预留 capacity_，此处 resize 不会分配。
+        const auto end = head_;
+        const auto n = static_cast<std::size_t>(end - tail_);
+        const auto off = static_cast<std::size_t>(tail_ % capacity_);
+        const auto first = std::min(n, capacity_ - off);
+        staging_.resize(n);
+        std::memcpy(staging_.data(), ring_.get() + off, first);
+        if (first < n) {
+            std::memcpy(staging_.data() + first, ring_.get(), n - first);
+        }
+        tail_ = end;
+        lk.unlock();
+
+        std::uint64_t ok = 0;
+        std::uint64_t failed = 0;
+        format_batch_(ok, failed);
+
+        lk.lock();
+        dumped_ += ok;
+        dropped_ += failed;
+        formatted_ = end;
+        done_cv_.notify_all();
+    }
+    finished_ = true;
+    done_cv_.notify_all();
+}
+
+void AsyncDumper::format_batch_(std::uint64_t &ok, std::uint64_t &failed) noexcept {
+    for (std::size_t pos = 0; pos < staging_.size();) {
+        RecordHead head{};
+        std::memcpy(&head, staging_.data() + pos, sizeof(head));
+        const auto *title =
+            reinterpret_cast<const char *>(staging_.data() + pos + sizeof(head));
+        const secs::core::bytes_view body{
+            staging_.data() + pos + sizeof(head) + head.title_size, head.body_size};
+        pos += head.size;
+
+        try {
+            text_.assign(title, head.title_size);
+            if (head.kind == Kind::hsms) {
+                build_hsms_frame_(head.hsms, body, frame_);
+                append_hsms_frame_dump(text_,
+                                       secs::core::bytes_view{frame_.data(), frame_.size()},
+                                       options_.hsms);
+            } else {
+                append_secs1_message_dump(text_, head.secs1, body, options_.secs1);
+            }
+        } catch (...) {
+            // dump 仅用于调试：格式化失败（内存不足）只丢弃该条，保持后台线程存活。
+            ++failed;
+            continue;
+        }
+
+        if (options_.sink) {
+            options_.sink(options_.sink_user, text_.data(), text_.size());
+        }
+        ++ok;
+    }
+}
+
+} // namespace secs::utils
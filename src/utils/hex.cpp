@@ -1,9 +1,10 @@
 #include "secs/utils/hex.hpp"
 
+#include "text_append.hpp"
+
 #include <algorithm>
 #include <cctype>
-#include <iomanip>
-#include <sstream>
+#include <cstdint>
 
 namespace secs::utils {
 namespace {
@@ -76,8 +77,9 @@ struct Ansi final {
 
 } // namespace
 
-std::string hex_dump(secs::core::bytes_view bytes, HexDumpOptions options) {
-    std::ostringstream oss;
+void append_hex_dump(std::string &out,
+                     secs::core::bytes_view bytes,
+                     HexDumpOptions options) {
     const bool enable_color = options.enable_color;
     const auto *reset = ansi_(enable_color, Ansi::reset);
     const auto *dim = ansi_(enable_color, Ansi::dim);
@@ -92,53 +94,68 @@ std::string hex_dump(secs::core::bytes_view bytes, HexDumpOptions options) {
                                       ? static_cast<std::size_t>(16)
                                       : options.bytes_per_line);
 
+    // 预估：每字节 "HH " + ASCII 列 1 字符，外加每行偏移/颜色码。
+    const std::size_t lines = (max_bytes + per_line - 1) / per_line;
+    out.reserve(out.size() + max_bytes * 4 + lines * 48);
+
     for (std::size_t offset = 0; offset < max_bytes; offset += per_line) {
         const std::size_t line_n = std::min(per_line, max_bytes - offset);
 
         if (options.show_offset) {
-            oss << dim;
-            oss << std::setw(4) << std::setfill('0') << std::hex << offset
-                << ": ";
-            oss << reset;
+            out += dim;
+            detail::append_hex_padded(out, offset, 4);
+            out += ": ";
+            out += reset;
         }
 
-        oss << bytes_color;
-        for (std::size_t i = 0; i < line_n; ++i) {
-            const auto b = bytes[offset + i];
-            oss << std::setw(2) << std::setfill('0') << std::hex
-                << static_cast<int>(b);
-            if (i + 1 != line_n) {
-                oss << ' ';
+        out += bytes_color;
+        {
+            // "HH HH ... HH"：一次扩容后按表直接写入。
+            const std::size_t pos = out.size();
+            out.resize(pos + line_n * 3 - 1);
+            char *p = out.data() + pos;
+            for (std::size_t i = 0; i < line_n; ++i) {
+                p = detail::put_hex2(p, static_cast<std::uint8_t>(bytes[offset + i]));
+                if (i + 1 != line_n) {
+                    *p++ = ' ';
+                }
             }
         }
-        oss << reset;
+        out += reset;
 
         if (options.show_ascii) {
             // 对齐：补齐未输出的字节位，保证 ASCII 列对齐。
             if (line_n < per_line) {
-                const std::size_t missing = per_line - line_n;
                 // 每个 byte 输出 "HH "（末尾可能无空格），这里粗略补齐 3*missing。
-                oss << std::string(missing * 3, ' ');
+                out.append((per_line - line_n) * 3, ' ');
             } else {
-                oss << ' ';
+                out.push_back(' ');
             }
-            oss << "  ";
-            oss << ascii_color;
+            out += "  ";
+            out += ascii_color;
             for (std::size_t i = 0; i < line_n; ++i) {
-                oss << to_printable_ascii_(bytes[offset + i]);
+                out.push_back(to_printable_ascii_(bytes[offset + i]));
             }
-            oss << reset;
+            out += reset;
         }
 
-        oss << '\n';
+        out.push_back('\n');
     }
 
     if (options.max_bytes != 0 && total > options.max_bytes) {
-        oss << error << "... (truncated, total=" << std::dec << total << " bytes)"
-            << reset << '\n';
+        out += error;
+        out += "... (truncated, total=";
+        detail::append_dec(out, total);
+        out += " bytes)";
+        out += reset;
+        out.push_back('\n');
     }
+}
 
-    return oss.str();
+std::string hex_dump(secs::core::bytes_view bytes, HexDumpOptions options) {
+    std::string out;
+    append_hex_dump(out, bytes, options);
+    return out;
 }
 
 std::error_code parse_hex(std::string_view text,
@@ -1,12 +1,12 @@
 #include "secs/utils/hsms_dump.hpp"
 
 #include "secs/core/error.hpp"
+#include "secs/core/memory_budget.hpp"
 #include "secs/ii/codec.hpp"
 
+#include "text_append.hpp"
+
 #include <cstdint>
-#include <iomanip>
-#include <optional>
-#include <sstream>
 
 namespace secs::utils {
 namespace {
@@ -51,19 +51,16 @@ struct Ansi final {
     }
 }
 
-[[nodiscard]] std::string fmt_hex_u16_(std::uint16_t v) {
-    std::ostringstream oss;
-    oss << "0x" << std::hex << std::setw(4) << std::setfill('0') << v;
-    return oss.str();
-}
-
-[[nodiscard]] std::string fmt_hex_u32_(std::uint32_t v) {
-    std::ostringstream oss;
-    oss << "0x" << std::hex << std::setw(8) << std::setfill('0') << v;
-    return oss.str();
+// `  key=value` 形式的一行（value 由调用方追加）。
+void append_key_(std::string &out, const char *key, const char *reset, const char *name) {
+    out += "  ";
+    out += key;
+    out += name;
+    out += reset;
+    out.push_back('=');
 }
 
-void append_message_summary_(std::ostringstream &oss,
+void append_message_summary_(std::string &out,
                              const secs::hsms::Message &msg,
                              bool enable_color) {
     const auto *reset = ansi_(enable_color, Ansi::reset);
@@ -74,36 +71,65 @@ void append_message_summary_(std::ostringstream &oss,
 
     const auto stype_u8 = static_cast<std::uint8_t>(msg.header.s_type);
 
-    oss << header << "HSMS:" << reset << '\n';
-    oss << "  " << key << "session_id" << reset << "=" << value
-        << fmt_hex_u16_(msg.header.session_id) << reset << '\n';
-    oss << "  " << key << "header_byte2" << reset << "=" << value << "0x"
-        << std::hex << std::setw(2) << std::setfill('0')
-        << static_cast<int>(msg.header.header_byte2) << std::dec << reset << '\n';
-    oss << "  " << key << "header_byte3" << reset << "=" << value << "0x"
-        << std::hex << std::setw(2) << std::setfill('0')
-        << static_cast<int>(msg.header.header_byte3) << std::dec << reset << '\n';
-    oss << "  " << key << "p_type" << reset << "=" << value << "0x" << std::hex
-        << std::setw(2) << std::setfill('0') << static_cast<int>(msg.header.p_type)
-        << std::dec << reset << '\n';
-    oss << "  " << key << "s_type" << reset << "=" << value << "0x" << std::hex
-        << std::setw(2) << std::setfill('0') << static_cast<int>(stype_u8) << std::dec
-        << reset << " (" << dim << stype_name_(msg.header.s_type) << reset << ")\n";
-    oss << "  " << key << "system_bytes" << reset << "=" << value
-        << fmt_hex_u32_(msg.header.system_bytes) << reset << '\n';
+    out += header;
+    out += "HSMS:";
+    out += reset;
+    out.push_back('\n');
+
+    const auto hex_field = [&](const char *name, auto v) {
+        append_key_(out, key, reset, name);
+        out += value;
+        detail::append_hex_prefixed(out, v);
+        out += reset;
+    };
+    hex_field("session_id", msg.header.session_id);
+    out.push_back('\n');
+    hex_field("header_byte2", msg.header.header_byte2);
+    out.push_back('\n');
+    hex_field("header_byte3", msg.header.header_byte3);
+    out.push_back('\n');
+    hex_field("p_type", msg.header.p_type);
+    out.push_back('\n');
+    hex_field("s_type", stype_u8);
+    out += " (";
+    out += dim;
+    out += stype_name_(msg.header.s_type);
+    out += reset;
+    out += ")\n";
+    hex_field("system_bytes", msg.header.system_bytes);
+    out.push_back('\n');
 
     if (msg.is_data()) {
-        oss << "  " << key << "data" << reset << ": " << value << "S"
-            << static_cast<int>(msg.stream()) << "F" << static_cast<int>(msg.function())
-            << reset << " " << key << "W" << reset << "=" << value
-            << (msg.w_bit() ? 1 : 0) << reset << '\n';
+        out += "  ";
+        out += key;
+        out += "data";
+        out += reset;
+        out += ": ";
+        out += value;
+        out.push_back('S');
+        detail::append_dec(out, msg.stream());
+        out.push_back('F');
+        detail::append_dec(out, msg.function());
+        out += reset;
+        out.push_back(' ');
+        out += key;
+        out.push_back('W');
+        out += reset;
+        out.push_back('=');
+        out += value;
+        out.push_back(msg.w_bit() ? '1' : '0');
+        out += reset;
+        out.push_back('\n');
     }
 
-    oss << "  " << key << "body" << reset << "=" << value << msg.body.size() << reset
-        << " bytes\n";
+    append_key_(out, key, reset, "body");
+    out += value;
+    detail::append_dec(out, msg.body.size());
+    out += reset;
+    out += " bytes\n";
 }
 
-void maybe_append_secs2_(std::ostringstream &oss,
+void maybe_append_secs2_(std::string &out,
                          const secs::hsms::Message &msg,
                          const HsmsDumpOptions &options) {
     const auto *reset = ansi_(options.enable_color, Ansi::reset);
@@ -123,36 +149,63 @@ void maybe_append_secs2_(std::ostringstream &oss,
         return;
     }
 
+    // lease 与 item 同作用域：格式化期间 item 一直计入预算。
     secs::ii::Item item = secs::ii::Item::list({});
+    secs::core::MemoryLease lease;
     std::size_t consumed = 0;
     const auto ec =
         secs::ii::decode_one(secs::core::bytes_view{msg.body.data(), msg.body.size()},
                              item,
                              consumed,
-                             options.secs2_limits);
+                             options.secs2_limits,
+                             lease);
+
+    out += header;
+    out += "SECS-II:";
+    out += reset;
+    out.push_back('\n');
     if (ec) {
-        oss << header << "SECS-II:" << reset << '\n';
-        oss << "  " << error << "decode_failed" << reset << ": " << error
-            << ec.message() << reset << '\n';
+        out += "  ";
+        out += error;
+        out += "decode_failed";
+        out += reset;
+        out += ": ";
+        out += error;
+        out += ec.message();
+        out += reset;
+        out.push_back('\n');
         return;
     }
 
-    oss << header << "SECS-II:" << reset << '\n';
-    oss << "  " << key << "consumed" << reset << "=" << value << consumed << reset
-        << "/" << value << msg.body.size() << reset;
+    append_key_(out, key, reset, "consumed");
+    out += value;
+    detail::append_dec(out, consumed);
+    out += reset;
+    out.push_back('/');
+    out += value;
+    detail::append_dec(out, msg.body.size());
+    out += reset;
     if (consumed != msg.body.size()) {
-        oss << ' ' << dim << "(not fully consumed)" << reset;
+        out.push_back(' ');
+        out += dim;
+        out += "(not fully consumed)";
+        out += reset;
     }
-    oss << '\n';
-    oss << "  " << key << "item" << reset << ": " << dump_item(item, options.item)
-        << '\n';
+    out.push_back('\n');
+    out += "  ";
+    out += key;
+    out += "item";
+    out += reset;
+    out += ": ";
+    append_item_dump(out, item, options.item);
+    out.push_back('\n');
 }
 
 } // namespace
 
-std::string dump_hsms_frame(secs::core::bytes_view frame,
+void append_hsms_frame_dump(std::string &out,
+                            secs::core::bytes_view frame,
                             HsmsDumpOptions options) {
-    std::ostringstream oss;
     const bool enable_color = options.enable_color;
     const auto *reset = ansi_(enable_color, Ansi::reset);
     const auto *label = ansi_(enable_color, Ansi::label);
@@ -160,47 +213,79 @@ std::string dump_hsms_frame(secs::core::bytes_view frame,
     const auto *error = ansi_(enable_color, Ansi::error);
 
     if (options.include_hex) {
-        oss << label << "RAW(HSMS frame):" << reset << '\n';
-        oss << hex_dump(frame, options.hex);
+        out += label;
+        out += "RAW(HSMS frame):";
+        out += reset;
+        out.push_back('\n');
+        append_hex_dump(out, frame, options.hex);
     }
 
     secs::hsms::Message msg{};
     std::size_t consumed = 0;
     const auto ec = secs::hsms::decode_frame(frame, msg, consumed);
     if (ec) {
-        oss << error << "HSMS decode_frame failed: " << ec.message() << reset << '\n';
-        return oss.str();
+        out += error;
+        out += "HSMS decode_frame failed: ";
+        out += ec.message();
+        out += reset;
+        out.push_back('\n');
+        return;
     }
 
-    oss << dim << "consumed=" << consumed << "/" << frame.size() << reset << '\n';
-    append_message_summary_(oss, msg, enable_color);
-    maybe_append_secs2_(oss, msg, options);
-    return oss.str();
+    out += dim;
+    out += "consumed=";
+    detail::append_dec(out, consumed);
+    out.push_back('/');
+    detail::append_dec(out, frame.size());
+    out += reset;
+    out.push_back('\n');
+    append_message_summary_(out, msg, enable_color);
+    maybe_append_secs2_(out, msg, options);
 }
 
-std::string dump_hsms_payload(secs::core::bytes_view payload,
+void append_hsms_payload_dump(std::string &out,
+                              secs::core::bytes_view payload,
                               HsmsDumpOptions options) {
-    std::ostringstream oss;
     const bool enable_color = options.enable_color;
     const auto *reset = ansi_(enable_color, Ansi::reset);
     const auto *label = ansi_(enable_color, Ansi::label);
     const auto *error = ansi_(enable_color, Ansi::error);
 
     if (options.include_hex) {
-        oss << label << "RAW(HSMS payload):" << reset << '\n';
-        oss << hex_dump(payload, options.hex);
+        out += label;
+        out += "RAW(HSMS payload):";
+        out += reset;
+        out.push_back('\n');
+        append_hex_dump(out, payload, options.hex);
     }
 
     secs::hsms::Message msg{};
     const auto ec = secs::hsms::decode_payload(payload, msg);
     if (ec) {
-        oss << error << "HSMS decode_payload failed: " << ec.message() << reset << '\n';
-        return oss.str();
+        out += error;
+        out += "HSMS decode_payload failed: ";
+        out += ec.message();
+        out += reset;
+        out.push_back('\n');
+        return;
     }
 
-    append_message_summary_(oss, msg, enable_color);
-    maybe_append_secs2_(oss, msg, options);
-    return oss.str();
+    append_message_summary_(out, msg, enable_color);
+    maybe_append_secs2_(out, msg, options);
+}
+
+std::string dump_hsms_frame(secs::core::bytes_view frame,
+                            HsmsDumpOptions options) {
+    std::string out;
+    append_hsms_frame_dump(out, frame, options);
+    return out;
+}
+
+std::string dump_hsms_payload(secs::core::bytes_view payload,
+                              HsmsDumpOptions options) {
+    std::string out;
+    append_hsms_payload_dump(out, payload, options);
+    return out;
 }
 
 } // namespace secs::utils
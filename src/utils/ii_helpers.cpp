@@ -16,7 +16,8 @@ decode_one_item(secs::core::bytes_view in,
     result.consumed = 0;
     result.fully_consumed = false;
 
-    const auto ec = secs::ii::decode_one(in, result.item, result.consumed, limits);
+    const auto ec = secs::ii::decode_one(
+        in, result.item, result.consumed, limits, result.memory_lease);
     if (ec) {
         return {ec, DecodeOneItemResult{}};
     }
@@ -2,12 +2,12 @@
 
 #include "secs/utils/hex.hpp"
 
+#include "text_append.hpp"
+
 #include <algorithm>
 #include <cstdint>
-#include <iomanip>
-#include <limits>
-#include <sstream>
 #include <type_traits>
+#include <variant>
 
 namespace secs::utils {
 namespace {
@@ -26,15 +26,15 @@ struct Ansi final {
 }
 
 struct DumpContext final {
-    std::ostringstream oss;
-    ItemDumpOptions options{};
+    std::string &out;
+    const ItemDumpOptions &options;
 };
 
-[[nodiscard]] std::string indent_(std::size_t depth, std::size_t spaces) {
-    return std::string(depth * spaces, ' ');
+void append_indent_(std::string &out, std::size_t depth, std::size_t spaces) {
+    out.append(depth * spaces, ' ');
 }
 
-void append_escaped_ascii_(std::ostringstream &oss,
+void append_escaped_ascii_(std::string &out,
                            const std::string &s,
                            std::size_t max_bytes,
                            bool enable_color) {
@@ -44,35 +44,35 @@ void append_escaped_ascii_(std::ostringstream &oss,
     const std::size_t total = s.size();
     const std::size_t n = (max_bytes == 0 ? total : std::min(total, max_bytes));
 
-    oss << string;
-    oss << '"';
+    out += string;
+    out.push_back('"');
     for (std::size_t i = 0; i < n; ++i) {
         const auto c = static_cast<unsigned char>(s[i]);
         if (c == '\\') {
-            oss << "\\\\";
+            out += "\\\\";
             continue;
         }
         if (c == '"') {
-            oss << "\\\"";
+            out += "\\\"";
             continue;
         }
         if (c >= 0x20 && c <= 0x7E) {
-            oss << static_cast<char>(c);
+            out.push_back(static_cast<char>(c));
             continue;
         }
         // 非可打印字符：用 \xHH。
-        oss << "\\x" << std::hex << std::setw(2) << std::setfill('0')
-            << static_cast<int>(c) << std::dec;
+        out += "\\x";
+        detail::append_hex2(out, c);
     }
     if (max_bytes != 0 && total > max_bytes) {
-        oss << "...";
+        out += "...";
     }
-    oss << '"';
-    oss << reset;
+    out.push_back('"');
+    out += reset;
 }
 
 template <class T>
-void append_array_(std::ostringstream &oss,
+void append_array_(std::string &out,
                    const char *type_name,
                    const std::vector<T> &values,
                    std::size_t max_items,
@@ -86,30 +86,38 @@ void append_array_(std::ostringstream &oss,
     const std::size_t total = values.size();
     const std::size_t n = (max_items == 0 ? total : std::min(total, max_items));
 
-    oss << type << type_name << '[' << total << ']' << reset;
+    out += type;
+    out += type_name;
+    out.push_back('[');
+    detail::append_dec(out, total);
+    out.push_back(']');
+    out += reset;
     if (total == 0) {
         return;
     }
-    oss << ' ';
-    oss << value;
+    out.push_back(' ');
+    out += value;
     for (std::size_t i = 0; i < n; ++i) {
         if constexpr (std::is_floating_point_v<T>) {
             // 浮点默认用较高精度，便于定位差异。
-            oss << std::setprecision(10) << values[i];
+            detail::append_float(out, values[i]);
         } else {
-            oss << values[i];
+            detail::append_dec(out, values[i]);
         }
         if (i + 1 != n) {
-            oss << ' ';
+            out.push_back(' ');
         }
     }
-    oss << reset;
+    out += reset;
     if (max_items != 0 && total > max_items) {
-        oss << ' ' << dim << "..." << reset;
+        out.push_back(' ');
+        out += dim;
+        out += "...";
+        out += reset;
     }
 }
 
-void append_bool_array_(std::ostringstream &oss,
+void append_bool_array_(std::string &out,
                         const std::vector<bool> &values,
                         std::size_t max_items,
                         bool enable_color) {
@@ -121,25 +129,32 @@ void append_bool_array_(std::ostringstream &oss,
     const std::size_t total = values.size();
     const std::size_t n = (max_items == 0 ? total : std::min(total, max_items));
 
-    oss << type << "BOOLEAN[" << total << ']' << reset;
+    out += type;
+    out += "BOOLEAN[";
+    detail::append_dec(out, total);
+    out.push_back(']');
+    out += reset;
     if (total == 0) {
         return;
     }
-    oss << ' ';
-    oss << value_color;
+    out.push_back(' ');
+    out += value_color;
     for (std::size_t i = 0; i < n; ++i) {
-        oss << (values[i] ? '1' : '0');
+        out.push_back(values[i] ? '1' : '0');
         if (i + 1 != n) {
-            oss << ' ';
+            out.push_back(' ');
         }
     }
-    oss << reset;
+    out += reset;
     if (max_items != 0 && total > max_items) {
-        oss << ' ' << dim << "..." << reset;
+        out.push_back(' ');
+        out += dim;
+        out += "...";
+        out += reset;
     }
 }
 
-void append_binary_(std::ostringstream &oss,
+void append_binary_(std::string &out,
                     const std::vector<secs::ii::byte> &bytes,
                     std::size_t max_bytes,
                     bool enable_color) {
@@ -151,23 +166,35 @@ void append_binary_(std::ostringstream &oss,
     const std::size_t total = bytes.size();
     const std::size_t n = (max_bytes == 0 ? total : std::min(total, max_bytes));
 
-    oss << type << "BINARY[" << total << ']' << reset;
+    out += type;
+    out += "BINARY[";
+    detail::append_dec(out, total);
+    out.push_back(']');
+    out += reset;
     if (total == 0) {
         return;
     }
-    oss << ' ';
-
-    oss << value_color;
-    for (std::size_t i = 0; i < n; ++i) {
-        oss << std::hex << std::setw(2) << std::setfill('0')
-            << static_cast<int>(bytes[i]) << std::dec;
-        if (i + 1 != n) {
-            oss << ' ';
+    out.push_back(' ');
+
+    out += value_color;
+    {
+        // "HH HH ... HH"：一次扩容后按表直接写入。
+        const std::size_t pos = out.size();
+        out.resize(pos + n * 3 - 1);
+        char *p = out.data() + pos;
+        for (std::size_t i = 0; i < n; ++i) {
+            p = detail::put_hex2(p, static_cast<std::uint8_t>(bytes[i]));
+            if (i + 1 != n) {
+                *p++ = ' ';
+            }
         }
     }
-    oss << reset;
+    out += reset;
     if (max_bytes != 0 && total > max_bytes) {
-        oss << ' ' << dim << "..." << reset;
+        out.push_back(' ');
+        out += dim;
+        out += "...";
+        out += reset;
     }
 }
 
@@ -175,6 +202,7 @@ void append_item_(DumpContext &ctx, const secs::ii::Item &item, std::size_t dept
 
 void append_list_(DumpContext &ctx, const secs::ii::List &list, std::size_t depth) {
     const auto &opt = ctx.options;
+    auto &out = ctx.out;
     const bool enable_color = opt.enable_color;
     const auto *reset = ansi_(enable_color, Ansi::reset);
     const auto *type = ansi_(enable_color, Ansi::type);
@@ -184,47 +212,74 @@ void append_list_(DumpContext &ctx, const secs::ii::List &list, std::size_t dept
     const std::size_t n =
         (opt.max_list_items == 0 ? total : std::min(total, opt.max_list_items));
 
-    ctx.oss << type << "L[" << total << ']' << reset;
+    out += type;
+    out += "L[";
+    detail::append_dec(out, total);
+    out.push_back(']');
+    out += reset;
 
     if (total == 0) {
         return;
     }
 
     if (depth >= opt.max_depth) {
-        ctx.oss << ' ' << dim << "..." << reset;
+        out.push_back(' ');
+        out += dim;
+        out += "...";
+        out += reset;
         return;
     }
 
     if (!opt.multiline) {
-        ctx.oss << ' ' << dim << "{ " << reset;
+        out.push_back(' ');
+        out += dim;
+        out += "{ ";
+        out += reset;
         for (std::size_t i = 0; i < n; ++i) {
             append_item_(ctx, list[i], depth + 1);
             if (i + 1 != n) {
-                ctx.oss << ", ";
+                out += ", ";
             }
         }
         if (opt.max_list_items != 0 && total > opt.max_list_items) {
-            ctx.oss << ", " << dim << "..." << reset;
+            out += ", ";
+            out += dim;
+            out += "...";
+            out += reset;
         }
-        ctx.oss << ' ' << dim << '}' << reset;
+        out.push_back(' ');
+        out += dim;
+        out.push_back('}');
+        out += reset;
         return;
     }
 
-    ctx.oss << ' ' << dim << "{\n" << reset;
+    out.push_back(' ');
+    out += dim;
+    out += "{\n";
+    out += reset;
     for (std::size_t i = 0; i < n; ++i) {
-        ctx.oss << indent_(depth + 1, opt.indent_spaces);
+        append_indent_(out, depth + 1, opt.indent_spaces);
         append_item_(ctx, list[i], depth + 1);
-        ctx.oss << '\n';
+        out.push_back('\n');
     }
     if (opt.max_list_items != 0 && total > opt.max_list_items) {
-        ctx.oss << indent_(depth + 1, opt.indent_spaces) << dim << "..." << reset
-                << '\n';
+        append_indent_(out, depth + 1, opt.indent_spaces);
+        out += dim;
+        out += "...";
+        out += reset;
+        out.push_back('\n');
     }
-    ctx.oss << indent_(depth, opt.indent_spaces) << dim << '}' << reset;
+    append_indent_(out, depth, opt.indent_spaces);
+    out += dim;
+    out.push_back('}');
+    out += reset;
 }
 
 void append_item_(DumpContext &ctx, const secs::ii::Item &item, std::size_t depth) {
-    const bool enable_color = ctx.options.enable_color;
+    const auto &opt = ctx.options;
+    auto &out = ctx.out;
+    const bool enable_color = opt.enable_color;
     const auto *reset = ansi_(enable_color, Ansi::reset);
     const auto *type = ansi_(enable_color, Ansi::type);
     const auto *error = ansi_(enable_color, Ansi::error);
@@ -236,96 +291,41 @@ void append_item_(DumpContext &ctx, const secs::ii::Item &item, std::size_t dept
             if constexpr (std::is_same_v<T, secs::ii::List>) {
                 append_list_(ctx, v, depth);
             } else if constexpr (std::is_same_v<T, secs::ii::ASCII>) {
-                ctx.oss << type << "A[" << v.value.size() << ']' << reset << ' ';
-                append_escaped_ascii_(
-                    ctx.oss,
-                    v.value,
-                    ctx.options.max_payload_bytes,
-                    enable_color);
+                out += type;
+                out += "A[";
+                detail::append_dec(out, v.value.size());
+                out.push_back(']');
+                out += reset;
+                out.push_back(' ');
+                append_escaped_ascii_(out, v.value, opt.max_payload_bytes, enable_color);
             } else if constexpr (std::is_same_v<T, secs::ii::Binary>) {
-                append_binary_(
-                    ctx.oss,
-                    v.value,
-                    ctx.options.max_payload_bytes,
-                    enable_color);
+                append_binary_(out, v.value, opt.max_payload_bytes, enable_color);
             } else if constexpr (std::is_same_v<T, secs::ii::Boolean>) {
-                append_bool_array_(
-                    ctx.oss,
-                    v.values,
-                    ctx.options.max_array_items,
-                    enable_color);
+                append_bool_array_(out, v.values, opt.max_array_items, enable_color);
             } else if constexpr (std::is_same_v<T, secs::ii::I1>) {
-                append_array_(
-                    ctx.oss,
-                    "I1",
-                    v.values,
-                    ctx.options.max_array_items,
-                    enable_color);
+                append_array_(out, "I1", v.values, opt.max_array_items, enable_color);
             } else if constexpr (std::is_same_v<T, secs::ii::I2>) {
-                append_array_(
-                    ctx.oss,
-                    "I2",
-                    v.values,
-                    ctx.options.max_array_items,
-                    enable_color);
+                append_array_(out, "I2", v.values, opt.max_array_items, enable_color);
             } else if constexpr (std::is_same_v<T, secs::ii::I4>) {
-                append_array_(
-                    ctx.oss,
-                    "I4",
-                    v.values,
-                    ctx.options.max_array_items,
-                    enable_color);
+                append_array_(out, "I4", v.values, opt.max_array_items, enable_color);
             } else if constexpr (std::is_same_v<T, secs::ii::I8>) {
-                append_array_(
-                    ctx.oss,
-                    "I8",
-                    v.values,
-                    ctx.options.max_array_items,
-                    enable_color);
+                append_array_(out, "I8", v.values, opt.max_array_items, enable_color);
             } else if constexpr (std::is_same_v<T, secs::ii::U1>) {
-                append_array_(
-                    ctx.oss,
-                    "U1",
-                    v.values,
-                    ctx.options.max_array_items,
-                    enable_color);
+                append_array_(out, "U1", v.values, opt.max_array_items, enable_color);
             } else if constexpr (std::is_same_v<T, secs::ii::U2>) {
-                append_array_(
-                    ctx.oss,
-                    "U2",
-                    v.values,
-                    ctx.options.max_array_items,
-                    enable_color);
+                append_array_(out, "U2", v.values, opt.max_array_items, enable_color);
             } else if constexpr (std::is_same_v<T, secs::ii::U4>) {
-                append_array_(
-                    ctx.oss,
-                    "U4",
-                    v.values,
-                    ctx.options.max_array_items,
-                    enable_color);
+                append_array_(out, "U4", v.values, opt.max_array_items, enable_color);
             } else if constexpr (std::is_same_v<T, secs::ii::U8>) {
-                append_array_(
-                    ctx.oss,
-                    "U8",
-                    v.values,
-                    ctx.options.max_array_items,
-                    enable_color);
+                append_array_(out, "U8", v.values, opt.max_array_items, enable_color);
             } else if constexpr (std::is_same_v<T, secs::ii::F4>) {
-                append_array_(
-                    ctx.oss,
-                    "F4",
-                    v.values,
-                    ctx.options.max_array_items,
-                    enable_color);
+                append_array_(out, "F4", v.values, opt.max_array_items, enable_color);
             } else if constexpr (std::is_same_v<T, secs::ii::F8>) {
-                append_array_(
-                    ctx.oss,
-                    "F8",
-                    v.values,
-                    ctx.options.max_array_items,
-                    enable_color);
+                append_array_(out, "F8", v.values, opt.max_array_items, enable_color);
             } else {
-                ctx.oss << error << "(unknown item)" << reset;
+                out += error;
+                out += "(unknown item)";
+                out += reset;
             }
         },
         item.storage());
@@ -333,12 +333,17 @@ void append_item_(DumpContext &ctx, const secs::ii::Item &item, std::size_t dept
 
 } // namespace
 
-std::string dump_item(const secs::ii::Item &item, ItemDumpOptions options) {
-    DumpContext ctx;
-    ctx.options = options;
-
+void append_item_dump(std::string &out,
+                      const secs::ii::Item &item,
+                      ItemDumpOptions options) {
+    DumpContext ctx{out, options};
     append_item_(ctx, item, 0);
-    return ctx.oss.str();
+}
+
+std::string dump_item(const secs::ii::Item &item, ItemDumpOptions options) {
+    std::string out;
+    append_item_dump(out, item, options);
+    return out;
 }
 
 } // namespace secs::utils
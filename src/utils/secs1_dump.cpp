@@ -1,11 +1,12 @@
 #include "secs/utils/secs1_dump.hpp"
 
 #include "secs/core/error.hpp"
+#include "secs/core/memory_budget.hpp"
 #include "secs/ii/codec.hpp"
 
+#include "text_append.hpp"
+
 #include <cstdint>
-#include <iomanip>
-#include <sstream>
 
 namespace secs::utils {
 namespace {
@@ -24,19 +25,79 @@ struct Ansi final {
     return enable ? code : "";
 }
 
-[[nodiscard]] std::string fmt_hex_u16_(std::uint16_t v) {
-    std::ostringstream oss;
-    oss << "0x" << std::hex << std::setw(4) << std::setfill('0') << v;
-    return oss.str();
+// `  key=value` 中的 `  key=` 部分（value 由调用方追加）。
+void append_key_(std::string &out,
+                 const char *key,
+                 const char *reset,
+                 const char *name,
+                 bool leading_indent = true) {
+    if (leading_indent) {
+        out += "  ";
+    } else {
+        out.push_back(' ');
+    }
+    out += key;
+    out += name;
+    out += reset;
+    out.push_back('=');
+}
+
+void append_flag_(std::string &out, const char *value, const char *reset, bool v) {
+    out += value;
+    out.push_back(v ? '1' : '0');
+    out += reset;
+}
+
+// device_id / SxFy W / ... 中与 block 与 message 共用的前三行。
+void append_header_lines_(std::string &out,
+                          const secs::secs1::Header &h,
+                          bool enable_color) {
+    const auto *reset = ansi_(enable_color, Ansi::reset);
+    const auto *key = ansi_(enable_color, Ansi::key);
+    const auto *value = ansi_(enable_color, Ansi::value);
+
+    append_key_(out, key, reset, "device_id");
+    out += value;
+    detail::append_hex_prefixed(out, h.device_id);
+    out += reset;
+    append_key_(out, key, reset, "reverse_bit", false);
+    append_flag_(out, value, reset, h.reverse_bit);
+    out.push_back('\n');
+
+    out += "  ";
+    out += value;
+    out.push_back('S');
+    detail::append_dec(out, h.stream);
+    out.push_back('F');
+    detail::append_dec(out, h.function);
+    out += reset;
+    append_key_(out, key, reset, "W", false);
+    append_flag_(out, value, reset, h.wait_bit);
+    out.push_back('\n');
 }
 
-[[nodiscard]] std::string fmt_hex_u32_(std::uint32_t v) {
-    std::ostringstream oss;
-    oss << "0x" << std::hex << std::setw(8) << std::setfill('0') << v;
-    return oss.str();
+void append_system_bytes_and_size_(std::string &out,
+                                   std::uint32_t system_bytes,
+                                   const char *size_name,
+                                   std::size_t size,
+                                   bool enable_color) {
+    const auto *reset = ansi_(enable_color, Ansi::reset);
+    const auto *key = ansi_(enable_color, Ansi::key);
+    const auto *value = ansi_(enable_color, Ansi::value);
+
+    append_key_(out, key, reset, "system_bytes");
+    out += value;
+    detail::append_hex_prefixed(out, system_bytes);
+    out += reset;
+    out.push_back('\n');
+    append_key_(out, key, reset, size_name);
+    out += value;
+    detail::append_dec(out, size);
+    out += reset;
+    out += " bytes\n";
 }
 
-void append_block_summary_(std::ostringstream &oss,
+void append_block_summary_(std::string &out,
                            const secs::secs1::DecodedBlock &block,
                            bool enable_color) {
     const auto *reset = ansi_(enable_color, Ansi::reset);
@@ -45,23 +106,23 @@ void append_block_summary_(std::ostringstream &oss,
     const auto *value = ansi_(enable_color, Ansi::value);
 
     const auto &h = block.header;
-    oss << header << "SECS-I:" << reset << '\n';
-    oss << "  " << key << "device_id" << reset << "=" << value
-        << fmt_hex_u16_(h.device_id) << reset << ' ' << key << "reverse_bit"
-        << reset << "=" << value << (h.reverse_bit ? 1 : 0) << reset << '\n';
-    oss << "  " << value << "S" << static_cast<int>(h.stream) << "F"
-        << static_cast<int>(h.function) << reset << ' ' << key << "W" << reset
-        << "=" << value << (h.wait_bit ? 1 : 0) << reset << '\n';
-    oss << "  " << key << "block_number" << reset << "=" << value << h.block_number
-        << reset << ' ' << key << "end_bit" << reset << "=" << value
-        << (h.end_bit ? 1 : 0) << reset << '\n';
-    oss << "  " << key << "system_bytes" << reset << "=" << value
-        << fmt_hex_u32_(h.system_bytes) << reset << '\n';
-    oss << "  " << key << "data" << reset << "=" << value << block.data.size()
-        << reset << " bytes\n";
+    out += header;
+    out += "SECS-I:";
+    out += reset;
+    out.push_back('\n');
+    append_header_lines_(out, h, enable_color);
+    append_key_(out, key, reset, "block_number");
+    out += value;
+    detail::append_dec(out, h.block_number);
+    out += reset;
+    append_key_(out, key, reset, "end_bit", false);
+    append_flag_(out, value, reset, h.end_bit);
+    out.push_back('\n');
+    append_system_bytes_and_size_(out, h.system_bytes, "data", block.data.size(),
+                                  enable_color);
 }
 
-void maybe_append_secs2_(std::ostringstream &oss,
+void maybe_append_secs2_(std::string &out,
                          secs::core::bytes_view body,
                          const Secs1DumpOptions &options) {
     const auto *reset = ansi_(options.enable_color, Ansi::reset);
@@ -78,65 +139,95 @@ void maybe_append_secs2_(std::ostringstream &oss,
         return;
     }
 
+    // lease 与 item 同作用域：格式化期间 item 一直计入预算。
     secs::ii::Item item = secs::ii::Item::list({});
+    secs::core::MemoryLease lease;
     std::size_t consumed = 0;
     const auto ec =
-        secs::ii::decode_one(body, item, consumed, options.secs2_limits);
+        secs::ii::decode_one(body, item, consumed, options.secs2_limits, lease);
+
+    out += header;
+    out += "SECS-II:";
+    out += reset;
+    out.push_back('\n');
     if (ec) {
-        oss << header << "SECS-II:" << reset << '\n';
-        oss << "  " << error << "decode_failed" << reset << ": " << error
-            << ec.message() << reset << '\n';
+        out += "  ";
+        out += error;
+        out += "decode_failed";
+        out += reset;
+        out += ": ";
+        out += error;
+        out += ec.message();
+        out += reset;
+        out.push_back('\n');
         return;
     }
 
-    oss << header << "SECS-II:" << reset << '\n';
-    oss << "  " << key << "consumed" << reset << "=" << value << consumed << reset
-        << "/" << value << body.size() << reset;
+    append_key_(out, key, reset, "consumed");
+    out += value;
+    detail::append_dec(out, consumed);
+    out += reset;
+    out.push_back('/');
+    out += value;
+    detail::append_dec(out, body.size());
+    out += reset;
     if (consumed != body.size()) {
-        oss << ' ' << dim << "(not fully consumed)" << reset;
+        out.push_back(' ');
+        out += dim;
+        out += "(not fully consumed)";
+        out += reset;
     }
-    oss << '\n';
-    oss << "  " << key << "item" << reset << ": " << dump_item(item, options.item)
-        << '\n';
+    out.push_back('\n');
+    out += "  ";
+    out += key;
+    out += "item";
+    out += reset;
+    out += ": ";
+    append_item_dump(out, item, options.item);
+    out.push_back('\n');
 }
 
 } // namespace
 
-std::string dump_secs1_block_frame(secs::core::bytes_view frame,
+void append_secs1_block_frame_dump(std::string &out,
+                                   secs::core::bytes_view frame,
                                    Secs1DumpOptions options) {
-    std::ostringstream oss;
     const bool enable_color = options.enable_color;
     const auto *reset = ansi_(enable_color, Ansi::reset);
     const auto *label = ansi_(enable_color, Ansi::label);
     const auto *error = ansi_(enable_color, Ansi::error);
 
     if (options.include_hex) {
-        oss << label << "RAW(SECS-I block frame):" << reset << '\n';
-        oss << hex_dump(frame, options.hex);
+        out += label;
+        out += "RAW(SECS-I block frame):";
+        out += reset;
+        out.push_back('\n');
+        append_hex_dump(out, frame, options.hex);
     }
 
     secs::secs1::DecodedBlock block{};
     const auto ec = secs::secs1::decode_block(frame, block);
     if (ec) {
-        oss << error << "SECS-I decode_block failed: " << ec.message() << reset
-            << '\n';
-        return oss.str();
+        out += error;
+        out += "SECS-I decode_block failed: ";
+        out += ec.message();
+        out += reset;
+        out.push_back('\n');
+        return;
     }
 
-    append_block_summary_(oss, block, enable_color);
+    append_block_summary_(out, block, enable_color);
 
     // 单 block 完整消息：end_bit=1 且 block_number=1。
     if (block.header.end_bit && block.header.block_number == 1) {
-        maybe_append_secs2_(oss, block.data, options);
+        maybe_append_secs2_(out, block.data, options);
     }
-
-    return oss.str();
 }
 
-std::string dump_secs1_message(const secs::secs1::Header &header,
+void append_secs1_message_dump(std::string &out,
+                               const secs::secs1::Header &header,
                                secs::core::bytes_view body,
                                Secs1DumpOptions options) {
-    std::ostringstream oss;
     const bool enable_color = options.enable_color;
     const auto *reset = ansi_(enable_color, Ansi::reset);
     const auto *header_color = ansi_(enable_color, Ansi::header);
@@ -144,27 +235,41 @@ std::string dump_secs1_message(const secs::secs1::Header &header,
     const auto *key = ansi_(enable_color, Ansi::key);
     const auto *value = ansi_(enable_color, Ansi::value);
 
-    oss << header_color << "SECS-I message:" << reset << '\n';
-    oss << "  " << key << "device_id" << reset << "=" << value
-        << fmt_hex_u16_(header.device_id) << reset << ' ' << key << "reverse_bit"
-        << reset << "=" << value << (header.reverse_bit ? 1 : 0) << reset << '\n';
-    oss << "  " << value << "S" << static_cast<int>(header.stream) << "F"
-        << static_cast<int>(header.function) << reset << ' ' << key << "W"
-        << reset << "=" << value << (header.wait_bit ? 1 : 0) << reset << '\n';
-    oss << "  " << key << "blocks_end_bit" << reset << "=" << value
-        << (header.end_bit ? 1 : 0) << reset << '\n';
-    oss << "  " << key << "system_bytes" << reset << "=" << value
-        << fmt_hex_u32_(header.system_bytes) << reset << '\n';
-    oss << "  " << key << "body" << reset << "=" << value << body.size() << reset
-        << " bytes\n";
+    out += header_color;
+    out += "SECS-I message:";
+    out += reset;
+    out.push_back('\n');
+    append_header_lines_(out, header, enable_color);
+    append_key_(out, key, reset, "blocks_end_bit");
+    append_flag_(out, value, reset, header.end_bit);
+    out.push_back('\n');
+    append_system_bytes_and_size_(out, header.system_bytes, "body", body.size(),
+                                  enable_color);
 
     if (options.include_hex) {
-        oss << label << "RAW(SECS-I message body):" << reset << '\n';
-        oss << hex_dump(body, options.hex);
+        out += label;
+        out += "RAW(SECS-I message body):";
+        out += reset;
+        out.push_back('\n');
+        append_hex_dump(out, body, options.hex);
     }
 
-    maybe_append_secs2_(oss, body, options);
-    return oss.str();
+    maybe_append_secs2_(out, body, options);
+}
+
+std::string dump_secs1_block_frame(secs::core::bytes_view frame,
+                                   Secs1DumpOptions options) {
+    std::string out;
+    append_secs1_block_frame_dump(out, frame, options);
+    return out;
+}
+
+std::string dump_secs1_message(const secs::secs1::Header &header,
+                               secs::core::bytes_view body,
+                               Secs1DumpOptions options) {
+    std::string out;
+    append_secs1_message_dump(out, header, body, options);
+    return out;
 }
 
 Secs1MessageReassembler::Secs1MessageReassembler(
@@ -207,41 +312,10 @@ std::error_code Secs1MessageReassembler::accept_frame(secs::core::bytes_view fra
 }
 
 std::string Secs1MessageReassembler::dump_message(Secs1DumpOptions options) const {
-    std::ostringstream oss;
-    const bool enable_color = options.enable_color;
-    const auto *reset = ansi_(enable_color, Ansi::reset);
-    const auto *header = ansi_(enable_color, Ansi::header);
-    const auto *label = ansi_(enable_color, Ansi::label);
-    const auto *key = ansi_(enable_color, Ansi::key);
-    const auto *value = ansi_(enable_color, Ansi::value);
-
-    oss << header << "SECS-I message:" << reset << '\n';
-    oss << "  " << key << "device_id" << reset << "=" << value
-        << fmt_hex_u16_(message_header_.device_id) << reset << ' ' << key
-        << "reverse_bit" << reset << "=" << value
-        << (message_header_.reverse_bit ? 1 : 0) << reset << '\n';
-    oss << "  " << value << "S" << static_cast<int>(message_header_.stream) << "F"
-        << static_cast<int>(message_header_.function) << reset << ' ' << key
-        << "W" << reset << "=" << value << (message_header_.wait_bit ? 1 : 0)
-        << reset << '\n';
-    oss << "  " << key << "blocks_end_bit" << reset << "=" << value
-        << (message_header_.end_bit ? 1 : 0) << reset << '\n';
-    oss << "  " << key << "system_bytes" << reset << "=" << value
-        << fmt_hex_u32_(message_header_.system_bytes) << reset << '\n';
-    oss << "  " << key << "body" << reset << "=" << value << message_body_.size()
-        << reset << " bytes\n";
-
-    if (options.include_hex) {
-        oss << label << "RAW(SECS-I message body):" << reset << '\n';
-        oss << hex_dump(secs::core::bytes_view{message_body_.data(), message_body_.size()},
-                        options.hex);
-    }
-
-    maybe_append_secs2_(
-        oss,
+    return dump_secs1_message(
+        message_header_,
         secs::core::bytes_view{message_body_.data(), message_body_.size()},
         options);
-    return oss.str();
 }
 
 std::error_code Secs1MessageReassembler::decode_message_body_as_secs2(
@@ -260,4 +334,23 @@ std::error_code Secs1MessageReassembler::decode_message_body_as_secs2(
         limits);
 }
 
+std::error_code Secs1MessageReassembler::decode_message_body_as_secs2(
+    secs::ii::Item &out,
+    std::size_t &consumed,
+    const secs::ii::DecodeLimits &limits,
+    secs::core::MemoryLease &lease) const noexcept {
+    consumed = 0;
+    lease.reset();
+    if (message_body_.empty()) {
+        return secs::core::make_error_code(secs::core::errc::invalid_argument);
+    }
+
+    return secs::ii::decode_one(
+        secs::core::bytes_view{message_body_.data(), message_body_.size()},
+        out,
+        consumed,
+        limits,
+        lease);
+}
+
 } // namespace secs::utils
@@ -0,0 +1,86 @@
+#pragma once
+
+// utils 内部使用的文本追加工具（不安装、不属于公共接口）。
+//
+// dump 系列函数都把输出直接追加到调用方提供的 std::string：
+// - 十六进制使用 256 项查表，一次写两个字符；
+// - 十进制/浮点使用 std::to_chars，不经过 iostream 与 locale。
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+namespace secs::utils::detail {
+
+inline constexpr char kHexDigits[] = "0123456789abcdef";
+
+// kHexPairs[2*b], kHexPairs[2*b+1] 为字节 b 的两位小写十六进制。
+inline constexpr std::array<char, 512> kHexPairs = [] {
+    std::array<char, 512> t{};
+    for (std::size_t i = 0; i < 256; ++i) {
+        t[2 * i] = kHexDigits[i >> 4U];
+        t[2 * i + 1] = kHexDigits[i & 0x0FU];
+    }
+    return t;
+}();
+
+// 把字节 b 的两位十六进制写到 p（调用方保证空间）。
+inline char *put_hex2(char *p, std::uint8_t b) noexcept {
+    p[0] = kHexPairs[2U * b];
+    p[1] = kHexPairs[2U * b + 1U];
+    return p + 2;
+}
+
+inline void append_hex2(std::string &out, std::uint8_t b) {
+    out.append(&kHexPairs[2U * b], 2);
+}
+
+// 十六进制，至少 width 位（不足补 0，超出则完整输出；等价于 setw(width) + setfill('0')）。
+inline void append_hex_padded(std::string &out, std::uint64_t v, std::size_t width) {
+    char buf[16];
+    std::size_t n = 0;
+    do {
+        buf[n++] = kHexDigits[v & 0x0FU];
+        v >>= 4U;
+    } while (v != 0);
+    if (width > n) {
+        out.append(width - n, '0');
+    }
+    while (n != 0) {
+        out.push_back(buf[--n]);
+    }
+}
+
+// "0x" + 定宽十六进制（u8=2 位，u16=4 位，u32=8 位）。
+template <class T>
+inline void append_hex_prefixed(std::string &out, T v) {
+    static_assert(std::is_unsigned_v<T>);
+    out += "0x";
+    append_hex_padded(out, static_cast<std::uint64_t>(v), sizeof(T) * 2);
+}
+
+// 整数十进制（int8_t/uint8_t 也按数值输出，而不是字符）。
+template <class T>
+inline void append_dec(std::string &out, T v) {
+    static_assert(std::is_integral_v<T>);
+    char buf[24];
+    const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, r.ptr);
+}
+
+// 浮点：与 printf("%.10g") 一致（原实现为 ostream << setprecision(10)）。
+template <class T>
+inline void append_float(std::string &out, T v) {
+    static_assert(std::is_floating_point_v<T>);
+    char buf[64];
+    const auto r = std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::general, 10);
+    if (r.ec == std::errc{}) {
+        out.append(buf, r.ptr);
+    }
+}
+
+} // namespace secs::utils::detail
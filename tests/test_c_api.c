@@ -299,6 +299,88 @@ static void test_hsms_open_passive_ip_invalid_cases(void) {
     secs_context_destroy(ctx);
 }
 
+struct open_local_args {
+    secs_hsms_session_t *sess;
+    const char *path;
+    secs_error_t out_err;
+};
+
+static void *open_passive_local_thread(void *p) {
+    struct open_local_args *args = (struct open_local_args *)p;
+    args->out_err = secs_hsms_session_open_passive_local(
+        args->sess, args->path, SECS_HSMS_LOCAL_SHARED_MEMORY);
+    return NULL;
+}
+
+static void test_hsms_open_local_shared_memory(void) {
+    secs_context_t *ctx = NULL;
+    expect_ok("secs_context_create(ctx)", secs_context_create(&ctx));
+
+    secs_hsms_session_options_t opt;
+    memset(&opt, 0, sizeof(opt));
+    opt.session_id = 0x0102;
+    opt.t3_ms = 2000;
+    opt.t5_ms = 200;
+    opt.t6_ms = 2000;
+    opt.t7_ms = 2000;
+    opt.t8_ms = 500;
+    opt.linktest_interval_ms = 0;
+    opt.auto_reconnect = 0;
+    opt.passive_accept_select = 1;
+
+    secs_hsms_session_t *server = NULL;
+    secs_hsms_session_t *client = NULL;
+    expect_ok("secs_hsms_session_create(server)", secs_hsms_session_create(ctx, &opt, &server));
+    expect_ok("secs_hsms_session_create(client)", secs_hsms_session_create(ctx, &opt, &client));
+
+    /* 参数校验：空路径 / 未知 transport。 */
+    expect_err("secs_hsms_session_open_active_local(NULL path)",
+               secs_hsms_session_open_active_local(client, NULL, SECS_HSMS_LOCAL_UNIX_SOCKET));
+    expect_err("secs_hsms_session_open_passive_local(empty path)",
+               secs_hsms_session_open_passive_local(server, "", SECS_HSMS_LOCAL_UNIX_SOCKET));
+    expect_err("secs_hsms_session_open_active_local(bad transport)",
+               secs_hsms_session_open_active_local(
+                   client, "/tmp/x.sock", (secs_hsms_local_transport_t)7));
+
+    char path[96];
+    snprintf(path, sizeof(path), "/tmp/secs_test_c_api_%ld.sock", (long)time(NULL));
+
+    struct open_local_args args;
+    memset(&args, 0, sizeof(args));
+    args.sess = server;
+    args.path = path;
+    pthread_t th;
+    if (pthread_create(&th, NULL, open_passive_local_thread, &args) != 0) {
+        fprintf(stderr, "FAIL: pthread_create\n");
+        ++g_failures;
+        return;
+    }
+
+    /* 被动端在线程中开始监听：连接失败时稍后重试。 */
+    secs_error_t err = {0, NULL};
+    for (int i = 0; i < 200; ++i) {
+        err = secs_hsms_session_open_active_local(client, path, SECS_HSMS_LOCAL_SHARED_MEMORY);
+        if (err.value == 0) {
+            break;
+        }
+        struct timespec ts = {0, 5 * 1000 * 1000};
+        nanosleep(&ts, NULL);
+    }
+    expect_ok("secs_hsms_session_open_active_local", err);
+
+    (void)pthread_join(th, NULL);
+    expect_ok("secs_hsms_session_open_passive_local", args.out_err);
+    if (err.value == 0) {
+        expect_ok("secs_hsms_session_linktest(local)", secs_hsms_session_linktest(client));
+    }
+
+    (void)secs_hsms_session_stop(client);
+    (void)secs_hsms_session_stop(server);
+    secs_hsms_session_destroy(client);
+    secs_hsms_session_destroy(server);
+    secs_context_destroy(ctx);
+}
+
 static void test_invalid_argument_fast_fail(void) {
     /* 这些用例不追求业务意义，主要用于覆盖“参数校验/快速失败”分支，且必须不阻塞/不崩溃。
      */
@@ -815,6 +897,70 @@ static void test_hsms_session_create_v2_smoke(void) {
     secs_context_destroy(ctx);
 }
 
+static void test_metrics_snapshot_and_render(void) {
+    expect_err("secs_metrics_snapshot(NULL)", secs_metrics_snapshot(NULL));
+    expect_err("secs_metrics_render(NULL)", secs_metrics_render(0, NULL, NULL));
+
+    expect_ok("secs_metrics_set_enabled(1)", secs_metrics_set_enabled(1));
+
+    secs_context_t *ctx = NULL;
+    expect_ok("secs_context_create(metrics)", secs_context_create(&ctx));
+
+    secs_hsms_session_options_v2_t opt;
+    memset(&opt, 0, sizeof(opt));
+    opt.session_id = 0x2020;
+    opt.passive_accept_select = 1;
+
+    secs_hsms_session_t *sess = NULL;
+    expect_ok("secs_hsms_session_create_v2(metrics)",
+              secs_hsms_session_create_v2(ctx, &opt, &sess));
+
+    secs_metrics_snapshot_t snap;
+    memset(&snap, 0, sizeof(snap));
+    expect_ok("secs_metrics_snapshot", secs_metrics_snapshot(&snap));
+
+    int found_counter = 0;
+    int found_histogram = 0;
+    for (size_t i = 0; i < snap.samples_n; ++i) {
+        const secs_metric_sample_t *s = &snap.samples[i];
+        if (!strstr(s->labels, "session_id=8224")) {
+            continue;
+        }
+        if (strcmp(s->name, "secs_hsms_transactions_total") == 0 &&
+            s->type == SECS_METRIC_COUNTER && s->value == 0) {
+            found_counter = 1;
+        }
+        if (strcmp(s->name, "secs_hsms_t3_rtt_seconds") == 0 &&
+            s->type == SECS_METRIC_HISTOGRAM && s->scale > 0.0) {
+            found_histogram = 1;
+        }
+    }
+    if (!found_counter || !found_histogram) {
+        fprintf(stderr, "FAIL: metrics snapshot missing hsms session samples\n");
+        ++g_failures;
+    }
+    secs_metrics_snapshot_free(&snap);
+    if (snap.samples != NULL || snap.samples_n != 0) {
+        fprintf(stderr, "FAIL: secs_metrics_snapshot_free did not reset\n");
+        ++g_failures;
+    }
+
+    char *text = NULL;
+    size_t text_n = 0;
+    expect_ok("secs_metrics_render(openmetrics)", secs_metrics_render(1, &text, &text_n));
+    if (!text || text_n != strlen(text) ||
+        !strstr(text, "# TYPE secs_hsms_transactions counter") ||
+        !strstr(text, "# EOF")) {
+        fprintf(stderr, "FAIL: secs_metrics_render(openmetrics) output\n");
+        ++g_failures;
+    }
+    secs_free(text);
+
+    secs_hsms_session_destroy(sess);
+    secs_context_destroy(ctx);
+    expect_ok("secs_metrics_set_enabled(0)", secs_metrics_set_enabled(0));
+}
+
 static void test_ii_all_types_and_views(void) {
     /* Binary */
     {
@@ -2362,11 +2508,13 @@ int main(void) {
     test_context_create_with_options_smoke();
     test_invalid_argument_fast_fail();
     test_hsms_session_create_v2_smoke();
+    test_metrics_snapshot_and_render();
     test_ii_encode_decode_and_malicious();
     test_ii_all_types_and_views();
     test_sml_runtime_basic();
     test_sml_runtime_placeholders();
     test_hsms_open_passive_ip_invalid_cases();
+    test_hsms_open_local_shared_memory();
     test_hsms_protocol_loopback();
 
     if (g_failures == 0) {
@@ -0,0 +1,192 @@
+#include "secs/core/body_sink.hpp"
+#include "secs/core/error.hpp"
+
+#include "test_main.hpp"
+
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+using secs::core::BodySink;
+using secs::core::byte;
+using secs::core::bytes_view;
+
+std::vector<byte> make_payload(std::size_t n) {
+    std::vector<byte> v(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        v[i] = static_cast<byte>(i * 5 + 1);
+    }
+    return v;
+}
+
+std::string temp_path(const char *name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::vector<byte> read_file(const std::string &path) {
+    std::ifstream f(path, std::ios::binary);
+    return std::vector<byte>(std::istreambuf_iterator<char>(f),
+                             std::istreambuf_iterator<char>());
+}
+
+// 以 chunk 字节为单位写入 data，finish=false 时以 abort 结束。
+std::error_code feed(BodySink &sink,
+                     const std::vector<byte> &data,
+                     std::size_t chunk,
+                     bool finish) {
+    asio::io_context ioc;
+    std::error_code result;
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            for (std::size_t off = 0; off < data.size(); off += chunk) {
+                const auto n = std::min(chunk, data.size() - off);
+                result = co_await sink.async_write(bytes_view{data.data() + off, n});
+                if (result) {
+                    co_return;
+                }
+            }
+            if (finish) {
+                result = co_await sink.async_finish();
+            } else {
+                sink.abort(secs::core::make_error_code(secs::core::errc::cancelled));
+            }
+        },
+        asio::detached);
+    ioc.run();
+    return result;
+}
+
+void test_file_sink_writes_and_abort_removes() {
+    const auto payload = make_payload(10000);
+    const auto path = temp_path("secs_test_body_sink.bin");
+
+    std::error_code ec;
+    auto sink = secs::core::create_file_sink(path, ec);
+    TEST_EXPECT_OK(ec);
+    TEST_EXPECT(sink != nullptr);
+    if (sink) {
+        TEST_EXPECT_OK(feed(*sink, payload, 4096, true));
+        TEST_EXPECT_EQ(sink->size(), payload.size());
+        TEST_EXPECT(read_file(path) == payload);
+    }
+
+    // 接收失败：半成品文件被删除。
+    auto aborted = secs::core::create_file_sink(path, ec);
+    TEST_EXPECT(aborted != nullptr);
+    if (aborted) {
+        TEST_EXPECT_OK(feed(*aborted, payload, 1000, false));
+        TEST_EXPECT(!std::filesystem::exists(path));
+    }
+
+    auto bad = secs::core::create_file_sink(path + ".dir/missing", ec);
+    TEST_EXPECT(bad == nullptr);
+    TEST_EXPECT(static_cast<bool>(ec));
+}
+
+void test_mapped_sink_accepts_in_place_and_bounds_writes() {
+    const auto payload = make_payload(5000);
+    const auto path = temp_path("secs_test_body_sink_map.bin");
+
+    std::error_code ec;
+    auto sink = secs::core::map_file_sink(path, payload.size(), ec);
+    TEST_EXPECT_OK(ec);
+    TEST_EXPECT(sink != nullptr);
+    if (!sink) {
+        return;
+    }
+#if !defined(_WIN32)
+    // 接收方直接读入映射区域，再以区域内部视图提交。
+    auto region = sink->contiguous();
+    TEST_EXPECT_EQ(region.size(), payload.size());
+    std::copy(payload.begin(), payload.begin() + 3000, region.begin());
+    const std::vector<byte> tail(payload.begin() + 3000, payload.end());
+    asio::io_context ioc;
+    std::error_code in_place_ec;
+    std::error_code overflow_ec;
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            in_place_ec = co_await sink->async_write(bytes_view{region.data(), 3000});
+            if (!in_place_ec) {
+                in_place_ec = co_await sink->async_write(bytes_view{tail.data(), tail.size()});
+            }
+            const std::array<byte, 1> extra{0};
+            overflow_ec = co_await sink->async_write(bytes_view{extra.data(), extra.size()});
+            (void)co_await sink->async_finish();
+        },
+        asio::detached);
+    ioc.run();
+    TEST_EXPECT_OK(in_place_ec);
+    TEST_EXPECT_EQ(overflow_ec,
+                   secs::core::make_error_code(secs::core::errc::buffer_overflow));
+    sink.reset();
+#else
+    TEST_EXPECT_OK(feed(*sink, payload, 999, true));
+    sink.reset();
+#endif
+    TEST_EXPECT(read_file(path) == payload);
+    std::remove(path.c_str());
+}
+
+void test_callback_sink_and_rule_lookup() {
+    std::vector<byte> got;
+    std::error_code done_ec = secs::core::make_error_code(secs::core::errc::timeout);
+    auto sink = secs::core::make_callback_sink(
+        [&](bytes_view chunk) -> asio::awaitable<std::error_code> {
+            got.insert(got.end(), chunk.begin(), chunk.end());
+            co_return std::error_code{};
+        },
+        [&](std::error_code ec) { done_ec = ec; });
+    const auto payload = make_payload(700);
+    TEST_EXPECT_OK(feed(*sink, payload, 244, true));
+    TEST_EXPECT(got == payload);
+    TEST_EXPECT_OK(done_ec);
+
+    // 精确 (stream, function) 规则优先于整条 stream；未命中返回 nullptr。
+    int hit = 0;
+    auto factory_for = [&](int id) {
+        return [&hit, id](const secs::core::BodySinkInfo &) {
+            hit = id;
+            return std::shared_ptr<BodySink>{};
+        };
+    };
+    const std::vector<secs::core::BodySinkRule> rules{
+        {.stream = 7, .function = std::nullopt, .factory = factory_for(1)},
+        {.stream = 7, .function = 3, .factory = factory_for(2)},
+    };
+    const auto *f = secs::core::find_body_sink_factory(rules, 7, 3);
+    TEST_EXPECT(f != nullptr);
+    if (f) {
+        (void)(*f)(secs::core::BodySinkInfo{});
+        TEST_EXPECT_EQ(hit, 2);
+    }
+    f = secs::core::find_body_sink_factory(rules, 7, 5);
+    TEST_EXPECT(f != nullptr);
+    if (f) {
+        (void)(*f)(secs::core::BodySinkInfo{});
+        TEST_EXPECT_EQ(hit, 1);
+    }
+    TEST_EXPECT(secs::core::find_body_sink_factory(rules, 6, 11) == nullptr);
+}
+
+} // namespace
+
+int main() {
+    test_file_sink_writes_and_abort_removes();
+    test_mapped_sink_accepts_in_place_and_bounds_writes();
+    test_callback_sink_and_rule_lookup();
+    return ::secs::tests::run_and_report();
+}
@@ -0,0 +1,141 @@
+#include "secs/core/body_source.hpp"
+#include "secs/core/error.hpp"
+
+#include "test_main.hpp"
+
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using secs::core::BodySource;
+using secs::core::byte;
+using secs::core::mutable_bytes_view;
+
+std::vector<byte> make_payload(std::size_t n) {
+    std::vector<byte> v(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        v[i] = static_cast<byte>(i * 7 + 3);
+    }
+    return v;
+}
+
+std::string write_temp_file(const std::vector<byte> &data) {
+    const auto path =
+        (std::filesystem::temp_directory_path() / "secs_test_body_source.bin").string();
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    f.write(reinterpret_cast<const char *>(data.data()),
+            static_cast<std::streamsize>(data.size()));
+    return path;
+}
+
+// 以 chunk 字节为单位读完整个来源。
+std::vector<byte> drain(BodySource &source, std::size_t chunk) {
+    asio::io_context ioc;
+    std::vector<byte> out;
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            std::vector<byte> buf(chunk);
+            for (;;) {
+                auto [ec, n] =
+                    co_await source.async_read(mutable_bytes_view{buf.data(), buf.size()});
+                TEST_EXPECT_OK(ec);
+                if (ec || n == 0) {
+                    co_return;
+                }
+                out.insert(out.end(), buf.begin(), buf.begin() + static_cast<long>(n));
+            }
+        },
+        asio::detached);
+    ioc.run();
+    return out;
+}
+
+void test_file_body_reads_in_chunks() {
+    const auto payload = make_payload(10000);
+    const auto path = write_temp_file(payload);
+
+    std::error_code ec;
+    auto source = secs::core::open_file_body(path, ec);
+    TEST_EXPECT_OK(ec);
+    TEST_EXPECT(source != nullptr);
+    if (source) {
+        TEST_EXPECT_EQ(source->size(), payload.size());
+        TEST_EXPECT(source->contiguous().empty());
+        TEST_EXPECT(drain(*source, 4096) == payload);
+    }
+
+    auto missing = secs::core::open_file_body(path + ".missing", ec);
+    TEST_EXPECT(missing == nullptr);
+    TEST_EXPECT(static_cast<bool>(ec));
+    std::remove(path.c_str());
+}
+
+void test_mapped_body_is_contiguous() {
+    const auto payload = make_payload(5000);
+    const auto path = write_temp_file(payload);
+
+    std::error_code ec;
+    auto source = secs::core::map_file_body(path, ec);
+    TEST_EXPECT_OK(ec);
+    TEST_EXPECT(source != nullptr);
+    if (source) {
+        TEST_EXPECT_EQ(source->size(), payload.size());
+#if !defined(_WIN32)
+        const auto whole = source->contiguous();
+        TEST_EXPECT(std::vector<byte>(whole.begin(), whole.end()) == payload);
+#endif
+        TEST_EXPECT(drain(*source, 999) == payload);
+    }
+    std::remove(path.c_str());
+}
+
+void test_generator_body_truncates_and_detects_short_source() {
+    // 生成器每次给出超过剩余长度的字节：按声明的总长度截断。
+    auto source = secs::core::make_generator_body(
+        10, [](mutable_bytes_view dst) -> asio::awaitable<std::pair<std::error_code, std::size_t>> {
+            for (auto &b : dst) {
+                b = 0xAB;
+            }
+            co_return std::pair{std::error_code{}, dst.size() + 100};
+        });
+    const auto out = drain(*source, 4);
+    TEST_EXPECT_EQ(out.size(), 10U);
+
+    // 来源提前结束：async_read_full 返回 invalid_argument。
+    auto short_source = secs::core::make_generator_body(
+        8, [](mutable_bytes_view) -> asio::awaitable<std::pair<std::error_code, std::size_t>> {
+            co_return std::pair{std::error_code{}, std::size_t{0}};
+        });
+    asio::io_context ioc;
+    std::error_code read_ec;
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            std::vector<byte> buf(8);
+            read_ec = co_await secs::core::async_read_full(
+                *short_source, mutable_bytes_view{buf.data(), buf.size()});
+        },
+        asio::detached);
+    ioc.run();
+    TEST_EXPECT_EQ(read_ec,
+                   secs::core::make_error_code(secs::core::errc::invalid_argument));
+}
+
+} // namespace
+
+int main() {
+    test_file_body_reads_in_chunks();
+    test_mapped_body_is_contiguous();
+    test_generator_body_truncates_and_detects_short_source();
+    return ::secs::tests::run_and_report();
+}
@@ -0,0 +1,160 @@
+#include "secs/core/error.hpp"
+#include "secs/core/memory_budget.hpp"
+
+#include "test_main.hpp"
+
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+#include <asio/post.hpp>
+#include <asio/use_awaitable.hpp>
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+using secs::core::MemoryBudget;
+using secs::core::MemoryBudgetOptions;
+using secs::core::MemoryReservation;
+using secs::core::errc;
+using secs::core::make_error_code;
+
+std::shared_ptr<MemoryBudget> make_budget(std::size_t limit) {
+    return std::make_shared<MemoryBudget>(MemoryBudgetOptions{.limit_bytes = limit});
+}
+
+void test_try_acquire_and_reservation_raii() {
+    auto budget = make_budget(1000);
+    TEST_EXPECT(budget->try_acquire(600));
+    TEST_EXPECT(!budget->try_acquire(500));
+    TEST_EXPECT_EQ(budget->rejections(), 1U);
+    budget->release(600);
+    TEST_EXPECT_EQ(budget->used(), 0U);
+
+    {
+        MemoryReservation r(budget);
+        TEST_EXPECT(r.try_grow(400));
+        TEST_EXPECT(r.try_grow(500));
+        TEST_EXPECT(!r.try_grow(200));
+        TEST_EXPECT_EQ(r.bytes(), 900U);
+        r.shrink(100);
+        TEST_EXPECT_EQ(budget->used(), 800U);
+
+        // 移交给共享租约：消息拷贝之间不重复计数，最后一个持有者析构时归还。
+        auto lease = secs::core::make_memory_lease(std::move(r));
+        TEST_EXPECT(lease != nullptr);
+        auto copy = lease;
+        lease.reset();
+        TEST_EXPECT_EQ(budget->used(), 800U);
+        copy.reset();
+        TEST_EXPECT_EQ(budget->used(), 0U);
+    }
+    TEST_EXPECT_EQ(budget->peak(), 900U);
+
+    // 不限制：只统计。
+    auto unlimited = make_budget(0);
+    TEST_EXPECT(unlimited->try_acquire(std::size_t{1} << 40));
+    TEST_EXPECT_EQ(unlimited->utilization(), 0.0);
+}
+
+void test_waiters_are_granted_in_fifo_order() {
+    asio::io_context ioc;
+    secs::core::metrics::Registry reg;
+    auto budget = std::make_shared<MemoryBudget>(
+        MemoryBudgetOptions{.limit_bytes = 1000, .metrics = reg.make_group({})});
+    TEST_EXPECT(budget->try_acquire(900));
+
+    std::vector<int> order;
+    std::error_code big_ec = make_error_code(errc::timeout);
+    std::error_code small_ec = make_error_code(errc::timeout);
+    std::error_code oversized_ec;
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            big_ec = co_await budget->async_acquire(800);
+            order.push_back(1);
+        },
+        asio::detached);
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            // 预算足够，但前面有等待者：排队，不插队。
+            small_ec = co_await budget->async_acquire(50);
+            order.push_back(2);
+        },
+        asio::detached);
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            oversized_ec = co_await budget->async_acquire(1001);
+            co_await asio::post(ioc, asio::use_awaitable);
+            TEST_EXPECT_EQ(budget->waiting(), 2U);
+            budget->release(900);
+        },
+        asio::detached);
+    ioc.run();
+
+    TEST_EXPECT_EQ(oversized_ec, make_error_code(errc::buffer_overflow));
+    TEST_EXPECT_OK(big_ec);
+    TEST_EXPECT_OK(small_ec);
+    TEST_EXPECT(order == (std::vector<int>{1, 2}));
+    TEST_EXPECT_EQ(budget->used(), 850U);
+    TEST_EXPECT_EQ(budget->waits(), 2U);
+
+    secs::core::metrics::Snapshot snap;
+    TEST_EXPECT_OK(reg.snapshot(snap));
+    std::string text;
+    TEST_EXPECT_OK(secs::core::metrics::render_prometheus(snap, text));
+    TEST_EXPECT(text.find("secs_memory_budget_bytes_total{op=\"acquire\"} 1750\n") !=
+                std::string::npos);
+    TEST_EXPECT(text.find("secs_memory_budget_waits_total 2\n") != std::string::npos);
+}
+
+void test_wait_times_out_or_is_cancelled() {
+    asio::io_context ioc;
+    auto budget = make_budget(100);
+    TEST_EXPECT(budget->try_acquire(100));
+
+    const int owner = 0;
+    std::error_code timed_out;
+    std::error_code cancelled;
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            timed_out = co_await budget->async_acquire(10, std::chrono::milliseconds(20));
+        },
+        asio::detached);
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            cancelled = co_await budget->async_acquire(10, std::nullopt, &owner);
+        },
+        asio::detached);
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            co_await asio::post(ioc, asio::use_awaitable);
+            budget->cancel_waits(&owner);
+        },
+        asio::detached);
+    ioc.run();
+
+    TEST_EXPECT_EQ(timed_out, make_error_code(errc::timeout));
+    TEST_EXPECT_EQ(cancelled, make_error_code(errc::cancelled));
+    TEST_EXPECT_EQ(budget->waiting(), 0U);
+    TEST_EXPECT_EQ(budget->used(), 100U);
+}
+
+} // namespace
+
+int main() {
+    test_try_acquire_and_reservation_raii();
+    test_waiters_are_granted_in_fifo_order();
+    test_wait_times_out_or_is_cancelled();
+    return ::secs::tests::run_and_report();
+}
@@ -0,0 +1,172 @@
+#include "secs/core/metrics.hpp"
+
+#include "test_main.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using secs::core::metrics::Counter;
+using secs::core::metrics::Histogram;
+using secs::core::metrics::HistogramSnapshot;
+using secs::core::metrics::MetricType;
+using secs::core::metrics::Registry;
+using secs::core::metrics::Snapshot;
+
+bool contains(const std::string &haystack, const std::string &needle) {
+    return haystack.find(needle) != std::string::npos;
+}
+
+void test_counter_merges_thread_shards() {
+    Counter c;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&c] {
+            for (int i = 0; i < 10000; ++i) {
+                c.add();
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    c.add(5);
+    TEST_EXPECT_EQ(c.value(), 40005u);
+}
+
+void test_histogram_bucket_bounds() {
+    // 每个值都落在 [lower, upper] 内，且相邻桶首尾相接。
+    const std::uint64_t probes[] = {0,    1,    7,          8,
+                                    9,    15,   16,         1000,
+                                    4095, 4096, 1234567890, UINT64_MAX};
+    for (const auto v : probes) {
+        const auto idx = Histogram::bucket_index(v);
+        TEST_EXPECT(idx < Histogram::kBucketCount);
+        TEST_EXPECT(Histogram::bucket_lower_bound(idx) <= v);
+        TEST_EXPECT(v <= Histogram::bucket_upper_bound(idx));
+    }
+    for (std::size_t i = 0; i + 1 < Histogram::kBucketCount; ++i) {
+        TEST_EXPECT_EQ(Histogram::bucket_upper_bound(i) + 1,
+                       Histogram::bucket_lower_bound(i + 1));
+    }
+    TEST_EXPECT_EQ(Histogram::bucket_index(UINT64_MAX), Histogram::kBucketCount - 1);
+    TEST_EXPECT_EQ(Histogram::bucket_upper_bound(Histogram::kBucketCount - 1),
+                   UINT64_MAX);
+}
+
+void test_histogram_quantiles() {
+    Histogram h;
+    for (std::uint64_t v = 1; v <= 1000; ++v) {
+        h.record(v);
+    }
+    h.record_duration(std::chrono::microseconds(5)); // 5000ns
+
+    const HistogramSnapshot s = h.snapshot();
+    TEST_EXPECT_EQ(s.count, 1001u);
+    TEST_EXPECT_EQ(s.sum, 500500u + 5000u);
+    TEST_EXPECT_EQ(s.max, 5000u);
+    TEST_EXPECT_EQ(s.value_at_quantile(1.0), 5000u);
+
+    // 相对误差 <= 1/8
+    const auto p50 = s.value_at_quantile(0.5);
+    TEST_EXPECT(p50 >= 500u && p50 <= 500u + 500u / 8u);
+    const auto p99 = s.value_at_quantile(0.99);
+    TEST_EXPECT(p99 >= 990u && p99 <= 990u + 990u / 8u);
+
+    TEST_EXPECT_EQ(HistogramSnapshot{}.value_at_quantile(0.5), 0u);
+}
+
+void test_group_get_or_create_and_unregister() {
+    Registry reg;
+    {
+        auto g = reg.make_group({{"session", "1"}});
+        auto &a = g->counter("secs_test_total", "test counter");
+        auto &b = g->counter("secs_test_total", "test counter");
+        TEST_EXPECT(&a == &b);
+        auto &tx = g->counter("secs_test_dir_total", "dir", {{"direction", "tx"}});
+        auto &rx = g->counter("secs_test_dir_total", "dir", {{"direction", "rx"}});
+        TEST_EXPECT(&tx != &rx);
+        a.add(3);
+        tx.add(1);
+
+        Snapshot snap;
+        TEST_EXPECT_OK(reg.snapshot(snap));
+        TEST_EXPECT_EQ(snap.samples.size(), 3u);
+        // 按 name 排序，同名按 labels 排序（direction=rx 在 tx 之前）
+        TEST_EXPECT_EQ(snap.samples[0].name, std::string("secs_test_dir_total"));
+        TEST_EXPECT_EQ(snap.samples[0].labels.back().second, std::string("rx"));
+        TEST_EXPECT_EQ(snap.samples[1].value, 1u);
+        TEST_EXPECT_EQ(snap.samples[2].name, std::string("secs_test_total"));
+        TEST_EXPECT_EQ(snap.samples[2].value, 3u);
+        TEST_EXPECT_EQ(snap.samples[2].labels.front().first, std::string("session"));
+    }
+
+    Snapshot snap;
+    TEST_EXPECT_OK(reg.snapshot(snap));
+    TEST_EXPECT(snap.samples.empty());
+}
+
+void test_render_prometheus_text() {
+    Registry reg;
+    auto g1 = reg.make_group({{"tool", "EQ\"01\"\n"}});
+    auto g2 = reg.make_group({{"tool", "EQ02"}});
+    g1->counter("secs_test_frames_total", "Frames.").add(2);
+    g2->counter("secs_test_frames_total", "Frames.").add(7);
+
+    auto &rtt = g2->histogram("secs_test_rtt_seconds", "RTT.", {}, 1e-9);
+    rtt.record(3);   // 粗粒度区间 le=3
+    rtt.record(100); // 粗粒度区间 le=127
+
+    Snapshot snap;
+    TEST_EXPECT_OK(reg.snapshot(snap));
+
+    std::string text;
+    TEST_EXPECT_OK(render_prometheus(snap, text));
+
+    // HELP/TYPE 每个 family 只出现一次
+    TEST_EXPECT_EQ(text.find("# TYPE secs_test_frames_total counter"),
+                   text.rfind("# TYPE secs_test_frames_total counter"));
+    TEST_EXPECT(contains(text, "secs_test_frames_total{tool=\"EQ\\\"01\\\"\\n\"} 2\n"));
+    TEST_EXPECT(contains(text, "secs_test_frames_total{tool=\"EQ02\"} 7\n"));
+    TEST_EXPECT(contains(text, "# TYPE secs_test_rtt_seconds histogram\n"));
+    TEST_EXPECT(contains(text, "secs_test_rtt_seconds_bucket{tool=\"EQ02\",le=\"3e-09\"} 1\n"));
+    TEST_EXPECT(contains(text, "secs_test_rtt_seconds_bucket{tool=\"EQ02\",le=\"1.27e-07\"} 2\n"));
+    TEST_EXPECT(contains(text, "secs_test_rtt_seconds_bucket{tool=\"EQ02\",le=\"+Inf\"} 2\n"));
+    TEST_EXPECT(contains(text, "secs_test_rtt_seconds_count{tool=\"EQ02\"} 2\n"));
+    TEST_EXPECT(!contains(text, "# EOF"));
+
+    std::string om;
+    TEST_EXPECT_OK(render_prometheus(snap, om, true));
+    TEST_EXPECT(contains(om, "# TYPE secs_test_frames counter\n"));
+    TEST_EXPECT(contains(om, "secs_test_frames_total{tool=\"EQ02\"} 7\n"));
+    TEST_EXPECT(om.size() >= 6 && om.compare(om.size() - 6, 6, "# EOF\n") == 0);
+}
+
+void test_types_exposed_in_snapshot() {
+    Registry reg;
+    auto g = reg.make_group();
+    g->histogram("secs_test_size_bytes", "Size.").record(4096);
+
+    Snapshot snap;
+    TEST_EXPECT_OK(reg.snapshot(snap));
+    TEST_EXPECT_EQ(snap.samples.size(), 1u);
+    TEST_EXPECT(snap.samples[0].type == MetricType::histogram);
+    TEST_EXPECT_EQ(snap.samples[0].value, 1u);
+    TEST_EXPECT_EQ(snap.samples[0].histogram.max, 4096u);
+}
+
+} // namespace
+
+int main() {
+    test_counter_merges_thread_shards();
+    test_histogram_bucket_bounds();
+    test_histogram_quantiles();
+    test_group_get_or_create_and_unregister();
+    test_render_prometheus_text();
+    test_types_exposed_in_snapshot();
+    return ::secs::tests::run_and_report();
+}
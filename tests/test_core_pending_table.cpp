@@ -0,0 +1,216 @@
+#include "secs/core/error.hpp"
+#include "secs/core/pending_table.hpp"
+
+#include "test_main.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using secs::core::errc;
+using secs::core::make_error_code;
+using secs::core::PendingTable;
+
+struct Entry final {
+    explicit Entry(int v) : value(v) {}
+
+    int value{0};
+    std::string note{};
+};
+
+using Table = PendingTable<Entry>;
+
+void test_emplace_find_release() {
+    Table table(4);
+    TEST_EXPECT_EQ(table.capacity(), 4u);
+    TEST_EXPECT_EQ(table.size(), 0u);
+    TEST_EXPECT(table.find(1) == nullptr);
+
+    Table::Handle h1{};
+    Table::Handle h2{};
+    TEST_EXPECT_OK(table.emplace(1, h1, 10));
+    TEST_EXPECT_OK(table.emplace(0xFFFFFFFFu, h2, 20));
+    TEST_EXPECT_EQ(table.size(), 2u);
+
+    TEST_EXPECT(table.find(1) != nullptr);
+    TEST_EXPECT_EQ(table.find(1)->value, 10);
+    TEST_EXPECT_EQ(table.find(0xFFFFFFFFu)->value, 20);
+    TEST_EXPECT(table.get(h1) == table.find(1));
+
+    table.release(h1);
+    TEST_EXPECT_EQ(table.size(), 1u);
+    TEST_EXPECT(table.find(1) == nullptr);
+    TEST_EXPECT(table.get(h1) == nullptr);
+    TEST_EXPECT_EQ(table.find(0xFFFFFFFFu)->value, 20);
+
+    // 重复 release / 默认句柄都应被忽略。
+    table.release(h1);
+    table.release(Table::Handle{});
+    TEST_EXPECT_EQ(table.size(), 1u);
+}
+
+void test_capacity_and_zero_capacity() {
+    Table table(2);
+    Table::Handle h{};
+    TEST_EXPECT_OK(table.emplace(1, h, 1));
+    TEST_EXPECT_OK(table.emplace(2, h, 2));
+    TEST_EXPECT_EQ(table.emplace(3, h, 3), make_error_code(errc::buffer_overflow));
+    TEST_EXPECT(table.find(3) == nullptr);
+
+    Table one(0);
+    TEST_EXPECT_EQ(one.capacity(), 1u);
+}
+
+void test_capacity_is_clamped_and_slab_grows_lazily() {
+    // 超大配置：截断到 kMaxCapacity，且构造时不按配置值分配（否则这里会 bad_alloc）。
+    Table huge(std::numeric_limits<std::size_t>::max());
+    TEST_EXPECT_EQ(huge.capacity(), Table::kMaxCapacity);
+    Table big(std::size_t{1} << 32);
+    TEST_EXPECT_EQ(big.capacity(), Table::kMaxCapacity);
+
+    // 跨越多块：早先条目的地址与句柄在扩容后保持有效。
+    const std::size_t n = Table::kChunkEntries * 3 + 5;
+    Table table(n);
+    std::vector<Table::Handle> handles(n);
+    std::vector<const Entry *> addrs(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        TEST_EXPECT_OK(table.emplace(static_cast<std::uint32_t>(i * 7), handles[i],
+                                     static_cast<int>(i)));
+        addrs[i] = table.get(handles[i]);
+    }
+    Table::Handle h{};
+    TEST_EXPECT_EQ(table.emplace(0xABCDu, h, 0), make_error_code(errc::buffer_overflow));
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto *e = table.find(static_cast<std::uint32_t>(i * 7));
+        TEST_EXPECT(e != nullptr && e == addrs[i] && e == table.get(handles[i]));
+        TEST_EXPECT_EQ(e->value, static_cast<int>(i));
+    }
+    std::size_t visited = 0;
+    table.unlink_if([&](std::uint32_t, Entry &) noexcept {
+        ++visited;
+        return false;
+    });
+    TEST_EXPECT_EQ(visited, n);
+}
+
+void test_generation_defeats_stale_handle() {
+    Table table(1);
+    Table::Handle old{};
+    TEST_EXPECT_OK(table.emplace(7, old, 1));
+    table.release(old);
+
+    // 同一 slab 条目被新事务复用：旧句柄必须失效，不能读到/释放新条目。
+    Table::Handle fresh{};
+    TEST_EXPECT_OK(table.emplace(7, fresh, 2));
+    TEST_EXPECT_EQ(fresh.index, old.index);
+    TEST_EXPECT(fresh.generation != old.generation);
+    TEST_EXPECT(table.get(old) == nullptr);
+    table.release(old);
+    TEST_EXPECT_EQ(table.get(fresh)->value, 2);
+    TEST_EXPECT_EQ(table.size(), 1u);
+}
+
+void test_unlink_keeps_entry_until_release() {
+    Table table(4);
+    Table::Handle a{};
+    Table::Handle b{};
+    TEST_EXPECT_OK(table.emplace(100, a, 1));
+    TEST_EXPECT_OK(table.emplace(200, b, 2));
+
+    table.unlink_if([](std::uint32_t key, Entry &e) noexcept {
+        if (key != 100) {
+            return false;
+        }
+        e.note = "cancelled";
+        return true;
+    });
+
+    // 摘出索引后迟到的响应匹配不到，但持有方仍可读取条目。
+    TEST_EXPECT(table.find(100) == nullptr);
+    TEST_EXPECT(table.get(a) != nullptr);
+    TEST_EXPECT_EQ(table.get(a)->note, std::string("cancelled"));
+    TEST_EXPECT_EQ(table.find(200)->value, 2);
+    TEST_EXPECT_EQ(table.size(), 2u);
+
+    table.unlink(b);
+    TEST_EXPECT(table.find(200) == nullptr);
+    table.release(a);
+    table.release(b);
+    TEST_EXPECT_EQ(table.size(), 0u);
+}
+
+void test_duplicate_key_unlinks_previous() {
+    Table table(4);
+    Table::Handle first{};
+    Table::Handle second{};
+    TEST_EXPECT_OK(table.emplace(5, first, 1));
+    TEST_EXPECT_OK(table.emplace(5, second, 2));
+
+    TEST_EXPECT_EQ(table.find(5)->value, 2);
+    TEST_EXPECT_EQ(table.get(first)->value, 1);
+
+    // 释放被覆盖的旧条目不应影响新条目的索引。
+    table.release(first);
+    TEST_EXPECT_EQ(table.find(5)->value, 2);
+    table.release(second);
+    TEST_EXPECT(table.find(5) == nullptr);
+}
+
+void test_randomized_against_map() {
+    // 随机插入/释放，与 unordered_map 对照（覆盖 backward-shift 删除路径）。
+    constexpr std::size_t kCapacity = 64;
+    Table table(kCapacity);
+    std::unordered_map<std::uint32_t, Table::Handle> live;
+    std::vector<std::uint32_t> keys;
+
+    std::mt19937 rng(12345);
+    for (int step = 0; step < 20000; ++step) {
+        const bool insert = live.size() < kCapacity && (live.empty() || rng() % 2 == 0);
+        if (insert) {
+            // 小范围 key：制造大量同 home 冲突
+            const std::uint32_t key = rng() % 512u;
+            if (live.count(key) != 0) {
+                continue;
+            }
+            Table::Handle h{};
+            TEST_EXPECT_OK(table.emplace(key, h, static_cast<int>(key)));
+            live.emplace(key, h);
+            keys.push_back(key);
+        } else {
+            const auto pos = rng() % keys.size();
+            const auto key = keys[pos];
+            keys[pos] = keys.back();
+            keys.pop_back();
+            table.release(live.at(key));
+            live.erase(key);
+        }
+
+        if (step % 97 == 0) {
+            for (const auto &[key, h] : live) {
+                auto *e = table.find(key);
+                TEST_EXPECT(e != nullptr);
+                TEST_EXPECT(e == table.get(h));
+                TEST_EXPECT_EQ(e->value, static_cast<int>(key));
+            }
+            TEST_EXPECT_EQ(table.size(), live.size());
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    test_emplace_find_release();
+    test_capacity_and_zero_capacity();
+    test_capacity_is_clamped_and_slab_grows_lazily();
+    test_generation_defeats_stale_handle();
+    test_unlink_keeps_entry_until_release();
+    test_duplicate_key_unlinks_previous();
+    test_randomized_against_map();
+    return ::secs::tests::run_and_report();
+}
@@ -0,0 +1,118 @@
+#include "secs/core/recycling_allocator.hpp"
+
+#include "test_main.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using secs::core::RecyclingAllocator;
+using Cache = secs::core::detail::ThreadBlockCache;
+
+void test_same_class_block_is_reused() {
+    void *a = Cache::allocate(100);
+    TEST_EXPECT(a != nullptr);
+    Cache::deallocate(a, 100);
+
+    // 同级（65..128B）请求复用刚释放的块。
+    void *b = Cache::allocate(90);
+    TEST_EXPECT_EQ(b, a);
+
+    // 不同级别不复用。
+    void *c = Cache::allocate(200);
+    TEST_EXPECT(c != b);
+    Cache::deallocate(b, 90);
+    Cache::deallocate(c, 200);
+
+    Cache::deallocate(nullptr, 16);
+}
+
+void test_large_blocks_bypass_cache() {
+    void *big = Cache::allocate(Cache::kMaxBlockSize + 1);
+    TEST_EXPECT(big != nullptr);
+    static_cast<unsigned char *>(big)[Cache::kMaxBlockSize] = 0x5A;
+    Cache::deallocate(big, Cache::kMaxBlockSize + 1);
+}
+
+void test_cache_is_bounded_per_class() {
+    constexpr std::size_t n = Cache::kMaxCachedPerClass + 8;
+    std::vector<void *> first;
+    for (std::size_t i = 0; i < n; ++i) {
+        first.push_back(Cache::allocate(40));
+    }
+    for (void *p : first) {
+        Cache::deallocate(p, 40);
+    }
+
+    // 只有 kMaxCachedPerClass 块留在缓存里，其余已交还系统。
+    std::vector<void *> second;
+    std::size_t reused = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        void *p = Cache::allocate(40);
+        if (std::find(first.begin(), first.end(), p) != first.end()) {
+            ++reused;
+        }
+        second.push_back(p);
+    }
+    TEST_EXPECT(reused >= Cache::kMaxCachedPerClass);
+    for (void *p : second) {
+        Cache::deallocate(p, 40);
+    }
+}
+
+void test_cross_thread_free_goes_to_freeing_thread() {
+    void *p = nullptr;
+    std::thread producer([&] { p = Cache::allocate(300); });
+    producer.join();
+    TEST_EXPECT(p != nullptr);
+
+    void *reused = nullptr;
+    std::thread consumer([&] {
+        Cache::deallocate(p, 300);
+        reused = Cache::allocate(300);
+        Cache::deallocate(reused, 300);
+    });
+    consumer.join();
+    TEST_EXPECT_EQ(reused, p);
+}
+
+struct alignas(64) OverAligned final {
+    std::uint8_t bytes[64];
+};
+
+void test_allocator_with_std_containers() {
+    auto sp = std::allocate_shared<std::uint64_t>(RecyclingAllocator<std::uint64_t>(), 42U);
+    TEST_EXPECT_EQ(*sp, 42U);
+
+    std::list<int, RecyclingAllocator<int>> l;
+    for (int i = 0; i < 100; ++i) {
+        l.push_back(i);
+    }
+    TEST_EXPECT_EQ(l.size(), 100U);
+    TEST_EXPECT_EQ(l.back(), 99);
+    l.clear();
+
+    // 超对齐类型绕过缓存，仍满足对齐要求。
+    RecyclingAllocator<OverAligned> oa;
+    OverAligned *o = oa.allocate(2);
+    TEST_EXPECT_EQ(reinterpret_cast<std::uintptr_t>(o) % alignof(OverAligned), 0U);
+    oa.deallocate(o, 2);
+
+    TEST_EXPECT(RecyclingAllocator<int>() == RecyclingAllocator<long>());
+}
+
+} // namespace
+
+int main() {
+    test_same_class_block_is_reused();
+    test_large_blocks_bypass_cache();
+    test_cache_is_bounded_per_class();
+    test_cross_thread_free_goes_to_freeing_thread();
+    test_allocator_with_std_containers();
+    return ::secs::tests::run_and_report();
+}
@@ -0,0 +1,101 @@
+#include "secs/core/shared_bytes.hpp"
+
+#include "test_main.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+using secs::core::byte;
+using secs::core::bytes_view;
+using secs::core::SharedBytes;
+
+std::vector<byte> to_vec(bytes_view v) {
+    return std::vector<byte>(v.begin(), v.end());
+}
+
+void test_default_is_empty() {
+    SharedBytes b;
+    TEST_EXPECT(b.empty());
+    TEST_EXPECT_EQ(b.size(), 0U);
+    TEST_EXPECT_EQ(b.headroom(), 0U);
+    TEST_EXPECT_EQ(b.use_count(), 0);
+
+    const std::array<byte, 2> prefix{1, 2};
+    TEST_EXPECT(b.claim_headroom(bytes_view{prefix.data(), prefix.size()}).empty());
+    b.release_headroom();
+}
+
+void test_copy_shares_single_payload() {
+    const std::vector<byte> src{1, 2, 3, 4, 5};
+    auto a = SharedBytes::copy(bytes_view{src.data(), src.size()}, 8);
+    TEST_EXPECT_EQ(a.size(), src.size());
+    TEST_EXPECT_EQ(a.headroom(), 8U);
+    TEST_EXPECT_EQ(to_vec(a.view()), src);
+    TEST_EXPECT(a.data() != src.data());
+
+    // 拷贝只增加引用计数，负载地址不变。
+    auto b = a;
+    TEST_EXPECT_EQ(a.use_count(), 2);
+    TEST_EXPECT_EQ(b.data(), a.data());
+
+    auto c = std::move(b);
+    TEST_EXPECT_EQ(a.use_count(), 2);
+    TEST_EXPECT_EQ(c.data(), a.data());
+
+    // 空负载也可以带 headroom。
+    auto e = SharedBytes::copy(bytes_view{}, 4);
+    TEST_EXPECT(e.empty());
+    TEST_EXPECT_EQ(e.headroom(), 4U);
+}
+
+void test_adopt_does_not_copy() {
+    std::vector<byte> src{9, 8, 7};
+    const auto *p = src.data();
+    auto a = SharedBytes::adopt(std::move(src));
+    TEST_EXPECT_EQ(a.data(), p);
+    TEST_EXPECT_EQ(a.size(), 3U);
+    TEST_EXPECT_EQ(a.headroom(), 0U);
+
+    const std::array<byte, 1> prefix{0};
+    TEST_EXPECT(a.claim_headroom(bytes_view{prefix.data(), prefix.size()}).empty());
+}
+
+void test_claim_headroom_is_exclusive() {
+    const std::vector<byte> src{0xAA, 0xBB};
+    auto a = SharedBytes::copy(bytes_view{src.data(), src.size()}, 4);
+    auto b = a;
+
+    const std::array<byte, 4> prefix{1, 2, 3, 4};
+    const auto frame = a.claim_headroom(bytes_view{prefix.data(), prefix.size()});
+    TEST_EXPECT_EQ(to_vec(frame), (std::vector<byte>{1, 2, 3, 4, 0xAA, 0xBB}));
+    TEST_EXPECT_EQ(frame.data() + prefix.size(), a.data());
+
+    // 同一缓冲的其他持有者在释放前无法占用 headroom。
+    TEST_EXPECT(b.claim_headroom(bytes_view{prefix.data(), prefix.size()}).empty());
+    a.release_headroom();
+
+    const std::array<byte, 2> shorter{7, 8};
+    const auto frame2 = b.claim_headroom(bytes_view{shorter.data(), shorter.size()});
+    TEST_EXPECT_EQ(to_vec(frame2), (std::vector<byte>{7, 8, 0xAA, 0xBB}));
+    b.release_headroom();
+
+    // 前缀超过 headroom：拒绝。
+    const std::array<byte, 5> too_long{};
+    TEST_EXPECT(a.claim_headroom(bytes_view{too_long.data(), too_long.size()}).empty());
+
+    // 负载始终不变。
+    TEST_EXPECT_EQ(to_vec(a.view()), src);
+}
+
+} // namespace
+
+int main() {
+    test_default_is_empty();
+    test_copy_shares_single_payload();
+    test_adopt_does_not_copy();
+    test_claim_headroom_is_exclusive();
+    return ::secs::tests::run_and_report();
+}
@@ -0,0 +1,316 @@
+#include "secs/hsms/connection.hpp"
+#include "secs/hsms/io_uring_stream.hpp"
+#include "secs/hsms/message.hpp"
+#include "secs/hsms/session.hpp"
+
+#include "secs/core/common.hpp"
+#include "secs/core/error.hpp"
+#include "secs/core/metrics.hpp"
+#include "secs/core/shared_bytes.hpp"
+
+#include "test_main.hpp"
+
+#include <asio/as_tuple.hpp>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/steady_timer.hpp>
+#include <asio/use_awaitable.hpp>
+#include <asio/write.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+using secs::core::byte;
+using secs::core::bytes_view;
+using secs::core::errc;
+using secs::core::make_error_code;
+
+using secs::hsms::Connection;
+using secs::hsms::ConnectionOptions;
+using secs::hsms::IoUringAcceptor;
+using secs::hsms::Message;
+using secs::hsms::Session;
+using secs::hsms::SessionOptions;
+using secs::hsms::Stream;
+using secs::hsms::StreamBackend;
+
+using namespace std::chrono_literals;
+
+const asio::ip::tcp::endpoint kLoopback{asio::ip::make_address("127.0.0.1"), 0};
+
+std::vector<byte> make_body(std::size_t n) {
+    std::vector<byte> body(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        body[i] = static_cast<byte>(i * 7U + 3U);
+    }
+    return body;
+}
+
+void test_io_uring_unavailable_falls_back_to_tcp() {
+    asio::io_context ioc;
+
+    // 无论 io_uring 是否可用，按 io_uring 后端构造的 Connection 都应可用。
+    Connection conn(ioc.get_executor(),
+                    ConnectionOptions{.backend = StreamBackend::io_uring});
+    TEST_EXPECT(!conn.is_open());
+
+    if (secs::hsms::io_uring_available()) {
+        return;
+    }
+    std::unique_ptr<Stream> stream;
+    TEST_EXPECT_EQ(secs::hsms::make_io_uring_stream(ioc.get_executor(), stream),
+                   std::make_error_code(std::errc::function_not_supported));
+    TEST_EXPECT(!stream);
+
+    IoUringAcceptor acceptor(ioc.get_executor());
+    TEST_EXPECT(acceptor.listen(kLoopback).value() != 0);
+    TEST_EXPECT(!acceptor.is_open());
+}
+
+void test_io_uring_acceptor_echo_roundtrip() {
+    asio::io_context ioc;
+    // 较小的注册槽：让 64KB 消息体走大块读路径，小消息走 READ_FIXED。
+    TEST_EXPECT_OK(secs::hsms::configure_io_uring(
+        ioc.get_executor(),
+        secs::hsms::IoUringOptions{.entries = 64, .registered_slots = 4,
+                                   .slot_size = 1024}));
+
+    IoUringAcceptor acceptor(ioc.get_executor());
+    TEST_EXPECT_OK(acceptor.listen(kLoopback));
+    const auto endpoint = acceptor.local_endpoint();
+    TEST_EXPECT(endpoint.port() != 0);
+
+    // ring 已创建后不允许再调整参数。
+    TEST_EXPECT_EQ(secs::hsms::configure_io_uring(ioc.get_executor(), {}),
+                   make_error_code(errc::invalid_argument));
+
+    constexpr int kClients = 2;
+    std::atomic<int> echoed{0};
+    std::atomic<bool> done{false};
+
+    // 服务端：multishot accept 连续接受两个连接，各自回显两条消息。
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            for (int i = 0; i < kClients; ++i) {
+                auto [ec, stream] = co_await acceptor.async_accept();
+                TEST_EXPECT_OK(ec);
+                if (ec) {
+                    co_return;
+                }
+                auto conn = std::make_shared<Connection>(std::move(stream));
+                asio::co_spawn(
+                    ioc,
+                    [conn, &echoed]() -> asio::awaitable<void> {
+                        for (;;) {
+                            auto [rec, msg] = co_await conn->async_read_message();
+                            if (rec) {
+                                break;
+                            }
+                            TEST_EXPECT_OK(co_await conn->async_write_message(msg));
+                            ++echoed;
+                        }
+                        (void)co_await conn->async_close();
+                    },
+                    asio::detached);
+            }
+            co_return;
+        },
+        asio::detached);
+
+    // 客户端 1：Connection 自建 io_uring 流（async_connect + SEND/SENDMSG）。
+    // 客户端 2：asio socket 建链后交给 Connection，按 io_uring 后端接管。
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            Connection first(ioc.get_executor(),
+                             ConnectionOptions{.t8 = 1s,
+                                               .backend = StreamBackend::io_uring});
+            TEST_EXPECT_OK(co_await first.async_connect(endpoint));
+            TEST_EXPECT(first.is_open());
+
+            asio::ip::tcp::socket sock(ioc.get_executor());
+            auto [cec] = co_await sock.async_connect(
+                endpoint, asio::as_tuple(asio::use_awaitable));
+            TEST_EXPECT(!cec);
+            Connection second(std::move(sock),
+                              ConnectionOptions{.t8 = 1s,
+                                                .backend = StreamBackend::io_uring});
+            TEST_EXPECT(second.is_open());
+
+            const auto small = make_body(16);
+            const auto large = make_body(64 * 1024);
+            std::uint32_t sb = 1;
+            for (Connection *conn : {&first, &second}) {
+                const auto m1 = secs::hsms::make_data_message(
+                    0x0001, 1, 1, true, sb++, bytes_view{small.data(), small.size()});
+                // 共享消息体：写出时走 headroom 连续帧或 SENDMSG 分散写。
+                const auto m2 = secs::hsms::make_data_message_shared(
+                    0x0001, 6, 11, false, sb++,
+                    secs::core::SharedBytes::copy(
+                        bytes_view{large.data(), large.size()},
+                        secs::hsms::kFramePrefixSize));
+
+                TEST_EXPECT_OK(co_await conn->async_write_message(m1));
+                TEST_EXPECT_OK(co_await conn->async_write_message(m2));
+
+                auto [r1, e1] = co_await conn->async_read_message();
+                TEST_EXPECT_OK(r1);
+                TEST_EXPECT_EQ(e1.header.system_bytes, m1.header.system_bytes);
+                TEST_EXPECT(e1.body == small);
+
+                auto [r2, e2] = co_await conn->async_read_message();
+                TEST_EXPECT_OK(r2);
+                TEST_EXPECT_EQ(e2.header.system_bytes, m2.header.system_bytes);
+                TEST_EXPECT(e2.body == large);
+            }
+
+            (void)co_await first.async_close();
+            (void)co_await second.async_close();
+            TEST_EXPECT(!first.is_open());
+            acceptor.close();
+            done = true;
+            co_return;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+    TEST_EXPECT_EQ(echoed.load(), 2 * kClients);
+}
+
+void test_io_uring_t8_linked_timeout() {
+    asio::io_context ioc;
+
+    asio::ip::tcp::acceptor acceptor(ioc, kLoopback);
+    const auto endpoint = acceptor.local_endpoint();
+
+    secs::core::metrics::Registry registry;
+    auto metrics = registry.make_group();
+    std::atomic<bool> done{false};
+
+    // 对端只写出半个帧头，然后停顿，远超 T8。
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto [aec, peer] =
+                co_await acceptor.async_accept(asio::as_tuple(asio::use_awaitable));
+            TEST_EXPECT(!aec);
+
+            const std::vector<byte> body = {0x10, 0x20};
+            const auto frame = secs::hsms::encode_frame(secs::hsms::make_data_message(
+                0x0001, 1, 1, false, 0x01020304, bytes_view{body.data(), body.size()}));
+            auto [wec, n] = co_await asio::async_write(
+                peer, asio::buffer(frame.data(), 4 + 3),
+                asio::as_tuple(asio::use_awaitable));
+            TEST_EXPECT(!wec);
+            (void)n;
+
+            asio::steady_timer delay(ioc);
+            delay.expires_after(200ms);
+            (void)co_await delay.async_wait(asio::as_tuple(asio::use_awaitable));
+            co_return;
+        },
+        asio::detached);
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            Connection conn(ioc.get_executor(),
+                            ConnectionOptions{.t8 = 20ms,
+                                              .metrics = metrics,
+                                              .backend = StreamBackend::io_uring});
+            TEST_EXPECT_OK(co_await conn.async_connect(endpoint));
+
+            const auto start = std::chrono::steady_clock::now();
+            auto [rec, msg] = co_await conn.async_read_message();
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            (void)msg;
+            TEST_EXPECT_EQ(rec, make_error_code(errc::timeout));
+            TEST_EXPECT(elapsed < 150ms);
+
+            (void)co_await conn.async_close();
+            done = true;
+            co_return;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+    // 超时由链接超时报告，同样计入 T8 指标。
+    TEST_EXPECT_EQ(metrics
+                       ->counter("secs_hsms_t8_timeouts_total",
+                                 "HSMS T8 inter-character timeouts.")
+                       .value(),
+                   1U);
+}
+
+void test_io_uring_session_select_and_linktest() {
+    asio::io_context ioc;
+
+    SessionOptions opt;
+    opt.session_id = 0x0001;
+    opt.t6 = 500ms;
+    opt.t7 = 500ms;
+    opt.t8 = 200ms;
+    opt.auto_reconnect = false;
+    opt.stream_backend = StreamBackend::io_uring;
+
+    Session server(ioc.get_executor(), opt);
+    Session client(ioc.get_executor(), opt);
+
+    asio::ip::tcp::acceptor acceptor(ioc, kLoopback);
+    const auto endpoint = acceptor.local_endpoint();
+    std::atomic<bool> done{false};
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto [aec, sock] =
+                co_await acceptor.async_accept(asio::as_tuple(asio::use_awaitable));
+            TEST_EXPECT(!aec);
+            TEST_EXPECT_OK(co_await server.async_open_passive(std::move(sock)));
+            co_return;
+        },
+        asio::detached);
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            TEST_EXPECT_OK(co_await client.async_open_active(endpoint));
+            TEST_EXPECT_OK(co_await client.async_linktest());
+
+            client.stop();
+            server.stop();
+            done = true;
+            co_return;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+}
+
+} // namespace
+
+int main() {
+    test_io_uring_unavailable_falls_back_to_tcp();
+    if (!secs::hsms::io_uring_available()) {
+        std::printf("io_uring unavailable; backend tests skipped\n");
+        return ::secs::tests::run_and_report();
+    }
+    test_io_uring_acceptor_echo_roundtrip();
+    test_io_uring_t8_linked_timeout();
+    test_io_uring_session_select_and_linktest();
+    return ::secs::tests::run_and_report();
+}
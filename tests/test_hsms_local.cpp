@@ -0,0 +1,400 @@
+#include "secs/hsms/connection.hpp"
+#include "secs/hsms/local_stream.hpp"
+#include "secs/hsms/message.hpp"
+#include "secs/hsms/session.hpp"
+
+#include "secs/core/common.hpp"
+#include "secs/core/error.hpp"
+
+#include "test_main.hpp"
+
+#include <asio/co_spawn.hpp>
+#include <asio/error.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using secs::core::byte;
+using secs::core::bytes_view;
+using secs::core::errc;
+using secs::core::make_error_code;
+
+using secs::hsms::Connection;
+using secs::hsms::ConnectionOptions;
+using secs::hsms::LocalAcceptor;
+using secs::hsms::LocalEndpoint;
+using secs::hsms::LocalTransport;
+using secs::hsms::Message;
+using secs::hsms::Session;
+using secs::hsms::SessionOptions;
+using secs::hsms::Stream;
+
+using namespace std::chrono_literals;
+
+std::string temp_socket_path(const char *tag) {
+    return "/tmp/secs_test_hsms_local_" + std::to_string(::getpid()) + "_" + tag +
+           ".sock";
+}
+
+std::vector<byte> make_body(std::size_t n) {
+    std::vector<byte> body(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        body[i] = static_cast<byte>(i * 13U + 5U);
+    }
+    return body;
+}
+
+// 服务端：接受一个连接，把收到的每条消息原样回显，直到对端断开。
+asio::awaitable<void> echo_one(LocalAcceptor &acceptor, int &echoed) {
+    auto [ec, stream] = co_await acceptor.async_accept();
+    TEST_EXPECT_OK(ec);
+    if (ec) {
+        co_return;
+    }
+    Connection conn(std::move(stream));
+    for (;;) {
+        auto [rec, msg] = co_await conn.async_read_message();
+        if (rec) {
+            break;
+        }
+        TEST_EXPECT_OK(co_await conn.async_write_message(msg));
+        ++echoed;
+    }
+    (void)co_await conn.async_close();
+}
+
+// 客户端：依次发送小/大消息并校验回显。
+asio::awaitable<void> roundtrip(asio::any_io_executor ex,
+                                const LocalEndpoint &endpoint,
+                                std::size_t large_size,
+                                bool &done) {
+    auto [ec, stream] = co_await secs::hsms::async_connect_local(ex, endpoint);
+    TEST_EXPECT_OK(ec);
+    if (ec) {
+        co_return;
+    }
+    Connection conn(std::move(stream), ConnectionOptions{.t8 = 1s});
+    TEST_EXPECT(conn.is_open());
+
+    const auto small = make_body(16);
+    const auto large = make_body(large_size);
+    std::uint32_t sb = 1;
+    for (int i = 0; i < 32; ++i) {
+        const auto &body = (i % 8 == 7) ? large : small;
+        const auto msg = secs::hsms::make_data_message(
+            0x0001, 6, 11, true, sb++, bytes_view{body.data(), body.size()});
+        TEST_EXPECT_OK(co_await conn.async_write_message(msg));
+        auto [rec, echo] = co_await conn.async_read_message();
+        TEST_EXPECT_OK(rec);
+        TEST_EXPECT_EQ(echo.header.system_bytes, msg.header.system_bytes);
+        TEST_EXPECT(echo.body == body);
+    }
+    (void)co_await conn.async_close();
+    done = true;
+}
+
+void test_unix_socket_roundtrip() {
+    asio::io_context ioc;
+    const LocalEndpoint endpoint{.path = temp_socket_path("unix"),
+                                 .transport = LocalTransport::unix_socket};
+
+    LocalAcceptor acceptor(ioc.get_executor());
+    TEST_EXPECT_OK(acceptor.listen(endpoint));
+    TEST_EXPECT(acceptor.is_open());
+    // 重复 listen 拒绝。
+    TEST_EXPECT_EQ(acceptor.listen(endpoint), make_error_code(errc::invalid_argument));
+
+    int echoed = 0;
+    bool done = false;
+    asio::co_spawn(ioc, echo_one(acceptor, echoed), asio::detached);
+    asio::co_spawn(ioc, roundtrip(ioc.get_executor(), endpoint, 256 * 1024, done),
+                   asio::detached);
+    ioc.run();
+
+    TEST_EXPECT(done);
+    TEST_EXPECT_EQ(echoed, 32);
+    acceptor.close();
+    TEST_EXPECT(::access(endpoint.path.c_str(), F_OK) != 0);
+}
+
+void test_listen_replaces_only_stale_socket() {
+    asio::io_context ioc;
+    const LocalEndpoint endpoint{.path = temp_socket_path("stale"),
+                                 .transport = LocalTransport::unix_socket};
+
+    // 残留的 socket 文件（bind 后无人 listen）：被删除后重新监听。
+    {
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        TEST_EXPECT(fd >= 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, endpoint.path.data(), endpoint.path.size());
+        TEST_EXPECT_EQ(
+            ::bind(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)), 0);
+        ::close(fd);
+    }
+    LocalAcceptor first(ioc.get_executor());
+    TEST_EXPECT_OK(first.listen(endpoint));
+
+    // 仍在监听的 socket：不抢占，first 的地址保持可用。
+    LocalAcceptor second(ioc.get_executor());
+    TEST_EXPECT_EQ(second.listen(endpoint),
+                   std::make_error_code(std::errc::address_in_use));
+    TEST_EXPECT(!second.is_open());
+    TEST_EXPECT(::access(endpoint.path.c_str(), F_OK) == 0);
+
+    bool connected = false;
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto [ec, stream] =
+                co_await secs::hsms::async_connect_local(ioc.get_executor(), endpoint);
+            TEST_EXPECT_OK(ec);
+            connected = !ec;
+        },
+        asio::detached);
+    ioc.run();
+    TEST_EXPECT(connected);
+
+    first.close();
+    TEST_EXPECT(::access(endpoint.path.c_str(), F_OK) != 0);
+}
+
+void test_shared_memory_roundtrip_wraps_ring() {
+    asio::io_context ioc;
+    // 最小环（4KiB）+ 256KiB 消息体：覆盖回绕与写端等待空间的门铃路径。
+    const LocalEndpoint endpoint{.path = temp_socket_path("shm"),
+                                 .transport = LocalTransport::shared_memory,
+                                 .ring_capacity = 1000};
+
+    LocalAcceptor acceptor(ioc.get_executor());
+    TEST_EXPECT_OK(acceptor.listen(endpoint));
+
+    int echoed = 0;
+    bool done = false;
+    asio::co_spawn(ioc, echo_one(acceptor, echoed), asio::detached);
+    asio::co_spawn(ioc, roundtrip(ioc.get_executor(), endpoint, 256 * 1024, done),
+                   asio::detached);
+    ioc.run();
+
+    TEST_EXPECT(done);
+    TEST_EXPECT_EQ(echoed, 32);
+}
+
+void test_shared_memory_peer_close() {
+    asio::io_context ioc;
+    const LocalEndpoint endpoint{.path = temp_socket_path("shm_close"),
+                                 .transport = LocalTransport::shared_memory};
+
+    LocalAcceptor acceptor(ioc.get_executor());
+    TEST_EXPECT_OK(acceptor.listen(endpoint));
+    bool done = false;
+
+    const auto body = make_body(100);
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto [aec, server] = co_await acceptor.async_accept();
+            TEST_EXPECT_OK(aec);
+            if (aec) {
+                co_return;
+            }
+            // 关闭前写入的数据仍可读出，之后读到 eof。
+            TEST_EXPECT_OK(co_await server->async_write_all(
+                bytes_view{body.data(), body.size()}));
+            server->close();
+            TEST_EXPECT(!server->is_open());
+        },
+        asio::detached);
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto [cec, client] =
+                co_await secs::hsms::async_connect_local(ioc.get_executor(), endpoint);
+            TEST_EXPECT_OK(cec);
+            if (cec) {
+                co_return;
+            }
+
+            std::vector<byte> got(body.size());
+            std::size_t total = 0;
+            while (total < got.size()) {
+                auto [rec, n] = co_await client->async_read_some(
+                    secs::core::mutable_bytes_view{got.data() + total,
+                                                   got.size() - total});
+                TEST_EXPECT_OK(rec);
+                if (rec) {
+                    break;
+                }
+                total += n;
+            }
+            TEST_EXPECT(got == body);
+
+            std::array<byte, 8> more{};
+            auto [eec, en] = co_await client->async_read_some(
+                secs::core::mutable_bytes_view{more.data(), more.size()});
+            TEST_EXPECT(eec == asio::error::eof);
+            TEST_EXPECT_EQ(en, 0U);
+
+            // 对端已关闭：写入失败而不是写进无人读取的环。
+            TEST_EXPECT(static_cast<bool>(co_await client->async_write_all(
+                bytes_view{body.data(), body.size()})));
+            client->close();
+            done = true;
+        },
+        asio::detached);
+    ioc.run();
+    TEST_EXPECT(done);
+}
+
+void test_session_over_shared_memory() {
+    asio::io_context ioc;
+    const LocalEndpoint endpoint{.path = temp_socket_path("session"),
+                                 .transport = LocalTransport::shared_memory};
+
+    SessionOptions opt;
+    opt.session_id = 0x0001;
+    opt.t3 = 1s;
+    opt.t6 = 500ms;
+    opt.t7 = 500ms;
+    opt.t8 = 200ms;
+    opt.auto_reconnect = false;
+
+    Session server(ioc.get_executor(), opt);
+    Session client(ioc.get_executor(), opt);
+    LocalAcceptor acceptor(ioc.get_executor());
+    TEST_EXPECT_OK(acceptor.listen(endpoint));
+    bool done = false;
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto [aec, stream] = co_await acceptor.async_accept();
+            TEST_EXPECT_OK(aec);
+            TEST_EXPECT_OK(co_await server.async_open_passive(std::move(stream)));
+
+            auto [rec, req] = co_await server.async_receive_data();
+            TEST_EXPECT_OK(rec);
+            const auto reply = secs::hsms::make_data_message(
+                opt.session_id, req.stream(), static_cast<std::uint8_t>(req.function() + 1), false,
+                req.header.system_bytes, bytes_view{req.body.data(), req.body.size()});
+            TEST_EXPECT_OK(co_await server.async_send(reply));
+        },
+        asio::detached);
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            TEST_EXPECT_OK(co_await client.async_open_active(endpoint));
+            TEST_EXPECT(client.is_selected());
+            TEST_EXPECT_OK(co_await client.async_linktest());
+
+            const auto body = make_body(64);
+            auto [ec, rsp] = co_await client.async_request_data(
+                1, 1, bytes_view{body.data(), body.size()});
+            TEST_EXPECT_OK(ec);
+            TEST_EXPECT_EQ(rsp.function(), 2);
+            TEST_EXPECT(rsp.body == body);
+
+            client.stop();
+            server.stop();
+            done = true;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done);
+
+    // 空 Stream 拒绝。
+    Session idle(ioc.get_executor(), opt);
+    std::error_code idle_ec;
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            idle_ec = co_await idle.async_open_passive(std::unique_ptr<Stream>{});
+        },
+        asio::detached);
+    ioc.restart();
+    ioc.run();
+    TEST_EXPECT_EQ(idle_ec, make_error_code(errc::invalid_argument));
+}
+
+// 真正的跨进程：子进程监听并回显，父进程连接后往返校验。
+void test_shared_memory_cross_process() {
+    const LocalEndpoint endpoint{.path = temp_socket_path("fork"),
+                                 .transport = LocalTransport::shared_memory,
+                                 .ring_capacity = 64 * 1024};
+
+    // 子进程开始监听后经管道通知父进程。
+    int ready[2] = {-1, -1};
+    TEST_EXPECT_EQ(::pipe(ready), 0);
+    const pid_t child = ::fork();
+    TEST_EXPECT(child >= 0);
+    if (child < 0) {
+        return;
+    }
+    if (child == 0) {
+        ::close(ready[0]);
+        asio::io_context ioc;
+        LocalAcceptor acceptor(ioc.get_executor());
+        if (acceptor.listen(endpoint)) {
+            ::_exit(2);
+        }
+        const char ok = 1;
+        (void)::write(ready[1], &ok, 1);
+        ::close(ready[1]);
+        int echoed = 0;
+        asio::co_spawn(ioc, echo_one(acceptor, echoed), asio::detached);
+        ioc.run();
+        acceptor.close();
+        ::_exit(echoed == 32 && secs::tests::failure_count() == 0 ? 0 : 1);
+    }
+
+    ::close(ready[1]);
+    char ok = 0;
+    TEST_EXPECT_EQ(::read(ready[0], &ok, 1), 1);
+    ::close(ready[0]);
+
+    asio::io_context ioc;
+    bool done = false;
+    asio::co_spawn(ioc, roundtrip(ioc.get_executor(), endpoint, 1024 * 1024, done),
+                   asio::detached);
+    ioc.run();
+    TEST_EXPECT(done);
+
+    int status = 0;
+    TEST_EXPECT_EQ(::waitpid(child, &status, 0), child);
+    TEST_EXPECT(WIFEXITED(status));
+    TEST_EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+} // namespace
+
+int main() {
+    test_unix_socket_roundtrip();
+    test_listen_replaces_only_stale_socket();
+    test_shared_memory_roundtrip_wraps_ring();
+    test_shared_memory_peer_close();
+    test_session_over_shared_memory();
+    test_shared_memory_cross_process();
+    return ::secs::tests::run_and_report();
+}
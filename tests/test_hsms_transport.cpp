@@ -1,10 +1,15 @@
+#include "secs/hsms/capture.hpp"
 #include "secs/hsms/connection.hpp"
+#include "secs/hsms/general_session.hpp"
+#include "secs/hsms/governor.hpp"
 #include "secs/hsms/message.hpp"
 #include "secs/hsms/session.hpp"
 #include "secs/hsms/timer.hpp"
 
+#include "secs/core/body_source.hpp"
 #include "secs/core/common.hpp"
 #include "secs/core/error.hpp"
+#include "secs/core/shared_bytes.hpp"
 
 #include "test_main.hpp"
 
@@ -12,10 +17,13 @@
 #include <asio/co_spawn.hpp>
 #include <asio/detached.hpp>
 #include <asio/io_context.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/strand.hpp>
 #include <asio/steady_timer.hpp>
 #include <asio/use_awaitable.hpp>
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
@@ -23,9 +31,14 @@
 #include <cstdio>
 #include <cstdlib>
 #include <deque>
+#include <filesystem>
 #include <memory>
+#include <optional>
 #include <set>
+#include <string>
 #include <system_error>
+#include <thread>
+#include <tuple>
 #include <vector>
 
 namespace {
@@ -36,7 +49,11 @@ using secs::core::errc;
 using secs::core::make_error_code;
 
 using secs::hsms::Connection;
+using secs::hsms::ConnectGovernor;
+using secs::hsms::ConnectGovernorOptions;
 using secs::hsms::ConnectionOptions;
+using secs::hsms::GeneralSession;
+using secs::hsms::GeneralSessionOptions;
 using secs::hsms::Message;
 using secs::hsms::Session;
 using secs::hsms::SessionOptions;
@@ -420,6 +437,72 @@ void test_connection_queue_limit_prioritizes_control() {
     TEST_EXPECT(done.load());
 }
 
+void test_connection_data_priority_lanes() {
+    asio::io_context ioc;
+    // write_delay 让第 1 条（大）消息占住 writer，其余消息在队列中按通道排序。
+    auto duplex = make_memory_duplex_with_write_delay(ioc.get_executor(), 20ms);
+
+    ConnectionOptions opt{};
+    opt.t8 = 0ms;
+    opt.data_priorities = {
+        {.stream = 5, .function = std::nullopt, .lane = 0}, // 报警
+        {.stream = 7, .function = std::nullopt, .lane = 3}, // 配方
+        {.stream = 6, .function = 11, .lane = 3},           // 事件报告
+        {.stream = 6, .function = 11, .lane = 0},           // 同级后出现：忽略
+        {.stream = 1, .function = 1, .lane = 200},          // 越界：最低优先级
+    };
+
+    Connection conn(std::move(duplex.client_stream), opt);
+    Connection peer(std::move(duplex.server_stream), ConnectionOptions{.t8 = 0ms});
+
+    const std::vector<byte> body(64, static_cast<byte>(0x5A));
+    const auto msg = [&](std::uint8_t stream, std::uint8_t function, std::uint32_t sb) {
+        return secs::hsms::make_data_message(
+            0x0001, stream, function, false, sb, bytes_view{body.data(), body.size()});
+    };
+
+    const auto write = [&](Message m) {
+        asio::co_spawn(
+            ioc,
+            [&, m = std::move(m)]() -> asio::awaitable<void> {
+                TEST_EXPECT_OK(co_await conn.async_write_message(m));
+            },
+            asio::detached);
+    };
+
+    std::vector<std::uint32_t> order;
+    bool done = false;
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            write(msg(7, 3, 1));
+            asio::steady_timer t(ioc);
+            t.expires_after(1ms);
+            (void)co_await t.async_wait(asio::as_tuple(asio::use_awaitable));
+
+            write(msg(7, 3, 2));  // 通道 3
+            write(msg(6, 11, 3)); // 通道 3
+            write(msg(1, 1, 4));  // 通道 3（越界截断）
+            write(msg(1, 3, 5));  // 默认通道 2
+            write(msg(5, 1, 6));  // 通道 0
+
+            for (int i = 0; i < 6; ++i) {
+                auto [ec, m] = co_await peer.async_read_message();
+                TEST_EXPECT_OK(ec);
+                order.push_back(m.header.system_bytes);
+            }
+            done = true;
+            ioc.stop();
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done);
+    // 已在写的第 1 条不被打断；其后按通道号取，通道内保持 FIFO。
+    const std::vector<std::uint32_t> expected = {1, 6, 5, 2, 3, 4};
+    TEST_EXPECT(order == expected);
+}
+
 void test_timer_wait_and_cancel() {
     asio::io_context ioc;
     Timer t(ioc.get_executor());
@@ -520,6 +603,463 @@ void test_connection_loopback_framing() {
     TEST_EXPECT(done.load());
 }
 
+void test_connection_writes_shared_body_without_copy() {
+    asio::io_context ioc;
+    auto duplex = make_memory_duplex(ioc.get_executor());
+
+    Connection client_conn(std::move(duplex.client_stream));
+    Connection server_conn(std::move(duplex.server_stream));
+
+    const std::vector<byte> body = {0x10, 0x20, 0x30, 0x40};
+    const auto shared = secs::core::SharedBytes::copy(
+        bytes_view{body.data(), body.size()}, secs::hsms::kFramePrefixSize);
+
+    // encode_frame 对共享消息体与普通消息体输出相同的帧。
+    {
+        const auto plain = secs::hsms::make_data_message(
+            0x0001, 6, 11, true, 0x01, bytes_view{body.data(), body.size()});
+        const auto zero_copy =
+            secs::hsms::make_data_message_shared(0x0001, 6, 11, true, 0x01, shared);
+        TEST_EXPECT(zero_copy.body.empty());
+        TEST_EXPECT_EQ(zero_copy.shared_body.data(), shared.data());
+        TEST_EXPECT_EQ(secs::hsms::encode_frame(zero_copy),
+                       secs::hsms::encode_frame(plain));
+    }
+
+    std::atomic<bool> done{false};
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            // 1) headroom 可用：连续写出；2) headroom 被占用：分散写；
+            // 3) adopt 的消息体没有 headroom：分散写。三帧在对端都应完整。
+            auto ec = co_await client_conn.async_write_message(
+                secs::hsms::make_data_message_shared(0x0001, 6, 11, false, 1, shared));
+            TEST_EXPECT_OK(ec);
+
+            const std::array<byte, 1> hold{0};
+            TEST_EXPECT(!shared.claim_headroom(bytes_view{hold.data(), hold.size()}).empty());
+            ec = co_await client_conn.async_write_message(
+                secs::hsms::make_data_message_shared(0x0001, 6, 11, false, 2, shared));
+            TEST_EXPECT_OK(ec);
+            shared.release_headroom();
+
+            ec = co_await client_conn.async_write_message(secs::hsms::make_data_message_shared(
+                0x0001,
+                6,
+                11,
+                false,
+                3,
+                secs::core::SharedBytes::adopt(std::vector<byte>(body))));
+            TEST_EXPECT_OK(ec);
+
+            for (std::uint32_t sb = 1; sb <= 3; ++sb) {
+                auto [rec, msg] = co_await server_conn.async_read_message();
+                TEST_EXPECT_OK(rec);
+                TEST_EXPECT_EQ(msg.header.system_bytes, sb);
+                TEST_EXPECT_EQ(msg.body, body);
+            }
+
+            // 写出完成后连接不再持有消息体。
+            TEST_EXPECT_EQ(shared.use_count(), 1);
+
+            client_conn.cancel_and_close();
+            server_conn.cancel_and_close();
+            done = true;
+            co_return;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+}
+
+void test_connection_writes_streamed_body_in_chunks() {
+    asio::io_context ioc;
+    auto duplex = make_memory_duplex(ioc.get_executor());
+
+    // 分段缓冲小于消息体：前缀 + 首段、其余分段各写一次。
+    Connection client_conn(std::move(duplex.client_stream),
+                           ConnectionOptions{.stream_chunk_size = 100});
+    Connection server_conn(std::move(duplex.server_stream));
+
+    std::vector<byte> body(1000);
+    for (std::size_t i = 0; i < body.size(); ++i) {
+        body[i] = static_cast<byte>(i * 13 + 1);
+    }
+    std::size_t produced = 0;
+    auto source = secs::core::make_generator_body(
+        body.size(),
+        [&](secs::core::mutable_bytes_view dst)
+            -> asio::awaitable<std::pair<std::error_code, std::size_t>> {
+            // 每次最多给 37 字节，验证发送方会读满一段。
+            const auto n = std::min<std::size_t>({dst.size(), 37, body.size() - produced});
+            std::copy_n(body.begin() + static_cast<long>(produced), n, dst.begin());
+            produced += n;
+            co_return std::pair{std::error_code{}, n};
+        });
+
+    const auto streamed =
+        secs::hsms::make_data_message_streamed(0x0001, 7, 3, false, 5, source);
+    TEST_EXPECT_EQ(streamed.body_size(), body.size());
+    std::vector<byte> frame;
+    TEST_EXPECT_EQ(secs::hsms::encode_frame(streamed, frame),
+                   make_error_code(errc::invalid_argument));
+
+    std::atomic<bool> done{false};
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto ec = co_await client_conn.async_write_message(streamed);
+            TEST_EXPECT_OK(ec);
+
+            auto [rec, msg] = co_await server_conn.async_read_message();
+            TEST_EXPECT_OK(rec);
+            TEST_EXPECT_EQ(msg.header.system_bytes, 5U);
+            TEST_EXPECT_EQ(msg.body, body);
+
+            client_conn.cancel_and_close();
+            server_conn.cancel_and_close();
+            done = true;
+            co_return;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+}
+
+void test_connection_reads_registered_body_into_sink() {
+    asio::io_context ioc;
+    auto duplex = make_memory_duplex(ioc.get_executor());
+
+    // 超过 kMaxPayloadSize 的 S7F3：发送端流式写出，接收端命中 sink 注册后分段交付。
+    const std::size_t big = std::size_t{secs::hsms::kMaxPayloadSize} + 4096;
+    auto pattern = [](std::size_t i) { return static_cast<byte>((i * 31 + 7) & 0xFF); };
+
+    Connection client_conn(std::move(duplex.client_stream));
+    std::size_t sunk = 0;
+    bool pattern_ok = true;
+    std::size_t max_chunk = 0;
+    std::optional<std::size_t> announced{};
+    std::error_code done_ec = make_error_code(errc::timeout);
+    Connection server_conn(
+        std::move(duplex.server_stream),
+        ConnectionOptions{
+            .stream_chunk_size = 256 * 1024,
+            .body_sinks = {{
+                .stream = 7,
+                .function = 3,
+                .factory =
+                    [&](const secs::core::BodySinkInfo &info) {
+                        announced = info.size;
+                        return secs::core::make_callback_sink(
+                            [&](bytes_view chunk) -> asio::awaitable<std::error_code> {
+                                for (std::size_t i = 0; i < chunk.size(); ++i) {
+                                    pattern_ok = pattern_ok && chunk[i] == pattern(sunk + i);
+                                }
+                                sunk += chunk.size();
+                                max_chunk = std::max(max_chunk, chunk.size());
+                                co_return std::error_code{};
+                            },
+                            [&](std::error_code ec) { done_ec = ec; });
+                    },
+            }},
+        });
+
+    std::size_t produced = 0;
+    auto source = secs::core::make_generator_body(
+        big,
+        [&](secs::core::mutable_bytes_view dst)
+            -> asio::awaitable<std::pair<std::error_code, std::size_t>> {
+            for (std::size_t i = 0; i < dst.size(); ++i) {
+                dst[i] = pattern(produced + i);
+            }
+            produced += dst.size();
+            co_return std::pair{std::error_code{}, dst.size()};
+        });
+
+    std::atomic<bool> done{false};
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            // 未注册的 (stream, function) 仍按普通方式读入 body。
+            const std::vector<byte> small = {0x01, 0x02, 0x03};
+            auto ec = co_await client_conn.async_write_message(secs::hsms::make_data_message(
+                0x0001, 6, 11, false, 1, bytes_view{small.data(), small.size()}));
+            TEST_EXPECT_OK(ec);
+            auto [rec, msg] = co_await server_conn.async_read_message();
+            TEST_EXPECT_OK(rec);
+            TEST_EXPECT(msg.body_sink == nullptr);
+            TEST_EXPECT_EQ(msg.body, small);
+
+            asio::co_spawn(
+                ioc,
+                [&]() -> asio::awaitable<void> {
+                    TEST_EXPECT_OK(co_await client_conn.async_write_message(
+                        secs::hsms::make_data_message_streamed(0x0001, 7, 3, true, 2, source)));
+                },
+                asio::detached);
+
+            std::tie(rec, msg) = co_await server_conn.async_read_message();
+            TEST_EXPECT_OK(rec);
+            TEST_EXPECT_EQ(msg.header.system_bytes, 2U);
+            TEST_EXPECT(msg.body.empty());
+            TEST_EXPECT(msg.body_sink != nullptr);
+            TEST_EXPECT_EQ(msg.body_size(), big);
+
+            client_conn.cancel_and_close();
+            server_conn.cancel_and_close();
+            done = true;
+            co_return;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+    TEST_EXPECT(announced.has_value() && *announced == big);
+    TEST_EXPECT_EQ(sunk, big);
+    TEST_EXPECT(pattern_ok);
+    TEST_EXPECT(max_chunk <= std::size_t{256 * 1024});
+    TEST_EXPECT_OK(done_ec);
+}
+
+void test_connection_read_paused_by_memory_budget() {
+    asio::io_context ioc;
+    auto duplex = make_memory_duplex(ioc.get_executor());
+
+    // 预算只够一条 600B 消息：第二条读到长度后暂停，直到第一条被释放。
+    auto budget = std::make_shared<secs::core::MemoryBudget>(
+        secs::core::MemoryBudgetOptions{.limit_bytes = 1000});
+    Connection client_conn(std::move(duplex.client_stream));
+    Connection server_conn(std::move(duplex.server_stream),
+                           ConnectionOptions{.memory_budget = budget});
+
+    const std::vector<byte> body(600, byte{0x5A});
+    bool second_read = false;
+    std::error_code paused_ec;
+    std::atomic<bool> done{false};
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            for (std::uint32_t sb = 1; sb <= 3; ++sb) {
+                TEST_EXPECT_OK(co_await client_conn.async_write_message(
+                    secs::hsms::make_data_message(
+                        0x0001, 6, 11, false, sb, bytes_view{body.data(), body.size()})));
+            }
+
+            auto [rec, first] = co_await server_conn.async_read_message();
+            TEST_EXPECT_OK(rec);
+            TEST_EXPECT(first.memory_lease != nullptr);
+            TEST_EXPECT_EQ(budget->used(), 600U);
+
+            Message second;
+            asio::co_spawn(
+                ioc,
+                [&]() -> asio::awaitable<void> {
+                    auto [ec2, msg2] = co_await server_conn.async_read_message();
+                    TEST_EXPECT_OK(ec2);
+                    second = std::move(msg2);
+                    second_read = true;
+                },
+                asio::detached);
+
+            Timer timer(ioc.get_executor());
+            (void)co_await timer.async_wait_for(20ms);
+            TEST_EXPECT(!second_read);
+            TEST_EXPECT_EQ(budget->waiting(), 1U);
+
+            first = Message{};
+            (void)co_await timer.async_wait_for(20ms);
+            TEST_EXPECT(second_read);
+            TEST_EXPECT_EQ(second.header.system_bytes, 2U);
+            TEST_EXPECT_EQ(budget->used(), 600U);
+
+            // 仍持有第二条：第三条暂停，关闭连接时读协程以 cancelled 结束。
+            asio::co_spawn(
+                ioc,
+                [&]() -> asio::awaitable<void> {
+                    auto [ec3, msg3] = co_await server_conn.async_read_message();
+                    paused_ec = ec3;
+                },
+                asio::detached);
+            (void)co_await timer.async_wait_for(20ms);
+            client_conn.cancel_and_close();
+            server_conn.cancel_and_close();
+            (void)co_await timer.async_wait_for(20ms);
+            second = Message{};
+            done = true;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+    TEST_EXPECT_EQ(paused_ec, make_error_code(errc::cancelled));
+    TEST_EXPECT_EQ(budget->used(), 0U);
+    TEST_EXPECT_EQ(budget->waits(), 2U);
+}
+
+void test_connection_capture_and_replay() {
+    // 1) 录制：client -> server 的一帧 data 与 server -> client 的回显均写入抓包文件。
+    const auto path =
+        (std::filesystem::temp_directory_path() / "secs_test_hsms_capture.bin").string();
+
+    secs::hsms::CaptureWriter writer(
+        secs::hsms::CaptureWriterOptions{.flush_interval = 1ms});
+    TEST_EXPECT_OK(writer.open(path));
+    std::shared_ptr<secs::hsms::CaptureChannel> channel;
+    TEST_EXPECT_OK(writer.add_channel(0x0001, channel));
+
+    {
+        asio::io_context ioc;
+        auto duplex = make_memory_duplex(ioc.get_executor());
+        Connection client_conn(std::move(duplex.client_stream));
+        Connection server_conn(std::move(duplex.server_stream),
+                               ConnectionOptions{.capture = channel});
+
+        asio::co_spawn(
+            ioc,
+            [&]() -> asio::awaitable<void> {
+                const std::vector<byte> body = {0x41, 0x01, 0x58};
+                const auto msg = secs::hsms::make_data_message(
+                    0x0001, 1, 1, true, 0x01000001, bytes_view{body.data(), body.size()});
+                TEST_EXPECT_OK(co_await client_conn.async_write_message(msg));
+
+                auto [rec, in] = co_await server_conn.async_read_message();
+                TEST_EXPECT_OK(rec);
+                TEST_EXPECT_OK(co_await server_conn.async_write_message(in));
+                auto [rec2, echo] = co_await client_conn.async_read_message();
+                TEST_EXPECT_OK(rec2);
+
+                client_conn.cancel_and_close();
+                server_conn.cancel_and_close();
+            },
+            asio::detached);
+        ioc.run();
+    }
+    channel.reset();
+    writer.close();
+    TEST_EXPECT_OK(writer.last_error());
+    TEST_EXPECT_EQ(writer.records_written(), 2u);
+    TEST_EXPECT_EQ(writer.dropped(), 0u);
+
+    std::vector<byte> capture;
+    TEST_EXPECT_OK(secs::hsms::load_capture_file(path, capture));
+    std::filesystem::remove(path);
+
+    secs::hsms::CaptureReader reader;
+    TEST_EXPECT_OK(reader.open(bytes_view{capture.data(), capture.size()}));
+    std::vector<secs::hsms::CaptureRecordView> records;
+    for (secs::hsms::CaptureRecordView rec; reader.next(rec);) {
+        records.push_back(rec);
+    }
+    TEST_EXPECT_OK(reader.error());
+    TEST_EXPECT_EQ(records.size(), 2u);
+    if (records.size() == 2u) {
+        TEST_EXPECT(records[0].direction == secs::hsms::CaptureDirection::rx);
+        TEST_EXPECT(records[1].direction == secs::hsms::CaptureDirection::tx);
+        TEST_EXPECT_EQ(records[0].session_id, 0x0001u);
+        TEST_EXPECT_EQ(records[0].frame.size(), 4u + 10u + 3u);
+        TEST_EXPECT(records[0].timestamp_ns <= records[1].timestamp_ns);
+        TEST_EXPECT(std::equal(records[0].frame.begin(),
+                               records[0].frame.end(),
+                               records[1].frame.begin(),
+                               records[1].frame.end()));
+    }
+
+    // 2) 回放：按 rx 方向、最大速度把录到的流量灌给新的对端。
+    asio::io_context ioc;
+    auto duplex = make_memory_duplex(ioc.get_executor());
+    Connection replayer(std::move(duplex.client_stream));
+    Connection target(std::move(duplex.server_stream));
+
+    std::atomic<bool> done{false};
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto [ec, stats] = co_await secs::hsms::async_replay(
+                replayer,
+                bytes_view{capture.data(), capture.size()},
+                secs::hsms::ReplayOptions{.speed = 0.0});
+            TEST_EXPECT_OK(ec);
+            TEST_EXPECT_EQ(stats.frames, 1u);
+            TEST_EXPECT_EQ(stats.bytes, 17u);
+
+            auto [rec, msg] = co_await target.async_read_message();
+            TEST_EXPECT_OK(rec);
+            TEST_EXPECT_EQ(msg.header.system_bytes, 0x01000001u);
+            TEST_EXPECT_EQ(msg.body.size(), 3u);
+
+            replayer.cancel_and_close();
+            target.cancel_and_close();
+            done = true;
+        },
+        asio::detached);
+    ioc.run();
+    TEST_EXPECT(done.load());
+}
+
+void test_replay_original_speed_and_corrupt_input() {
+    // 两帧相隔 40ms（抓包时间戳），2 倍速回放应至少间隔约 20ms。
+    std::vector<byte> capture;
+    secs::hsms::append_capture_file_header(capture);
+    for (std::uint32_t i = 0; i < 2; ++i) {
+        const auto frame = secs::hsms::encode_frame(
+            secs::hsms::make_data_message(0x0001, 1, 13, false, i + 1U, bytes_view{}));
+        TEST_EXPECT_OK(secs::hsms::append_capture_record(
+            secs::hsms::CaptureRecordView{
+                .timestamp_ns = 1'000'000'000ULL + i * 40'000'000ULL,
+                .direction = secs::hsms::CaptureDirection::rx,
+                .session_id = 7,
+                .frame = bytes_view{frame.data(), frame.size()}},
+            capture));
+    }
+
+    asio::io_context ioc;
+    auto duplex = make_memory_duplex(ioc.get_executor());
+    Connection replayer(std::move(duplex.client_stream));
+    Connection target(std::move(duplex.server_stream));
+
+    std::atomic<bool> done{false};
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto [ec, stats] = co_await secs::hsms::async_replay(
+                replayer,
+                bytes_view{capture.data(), capture.size()},
+                secs::hsms::ReplayOptions{.speed = 2.0, .session_id = 7});
+            TEST_EXPECT_OK(ec);
+            TEST_EXPECT_EQ(stats.frames, 2u);
+            TEST_EXPECT(stats.elapsed >= 19ms);
+
+            // session_id 不匹配：不发送任何帧
+            auto [ec2, none] = co_await secs::hsms::async_replay(
+                replayer,
+                bytes_view{capture.data(), capture.size()},
+                secs::hsms::ReplayOptions{.speed = 0.0, .session_id = 8});
+            TEST_EXPECT_OK(ec2);
+            TEST_EXPECT_EQ(none.frames, 0u);
+
+            // 截断的最后一条记录：回放已发送的帧后报告 invalid_argument
+            auto [ec3, partial] = co_await secs::hsms::async_replay(
+                replayer,
+                bytes_view{capture.data(), capture.size() - 1},
+                secs::hsms::ReplayOptions{.speed = 0.0});
+            TEST_EXPECT_EQ(ec3, make_error_code(errc::invalid_argument));
+            TEST_EXPECT_EQ(partial.frames, 1u);
+
+            for (int i = 0; i < 3; ++i) {
+                auto [rec, msg] = co_await target.async_read_message();
+                TEST_EXPECT_OK(rec);
+            }
+            replayer.cancel_and_close();
+            target.cancel_and_close();
+            done = true;
+        },
+        asio::detached);
+    ioc.run();
+    TEST_EXPECT(done.load());
+}
+
 void test_connection_t8_intercharacter_timeout() {
     asio::io_context ioc;
     auto duplex = make_memory_duplex(ioc.get_executor());
@@ -2319,6 +2859,254 @@ void test_session_concurrent_sends_system_bytes_unique() {
     TEST_EXPECT(done.load());
 }
 
+void test_session_receive_data_batch() {
+    asio::io_context ioc;
+
+    SessionOptions opt;
+    opt.session_id = 0x0001;
+    opt.t6 = 50ms;
+    opt.t7 = 200ms;
+    opt.t8 = 50ms;
+
+    Session server(ioc.get_executor(), opt);
+    Session client(ioc.get_executor(), opt);
+
+    auto duplex = make_memory_duplex(ioc.get_executor());
+    Connection client_conn(std::move(duplex.client_stream),
+                           ConnectionOptions{.t8 = opt.t8});
+    Connection server_conn(std::move(duplex.server_stream),
+                           ConnectionOptions{.t8 = opt.t8});
+
+    constexpr std::size_t kN = 10;
+    std::vector<std::uint32_t> sent_sb;
+    bool sent_all = false;
+    bool done = false;
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto ec = co_await client.async_open_active(std::move(client_conn));
+            TEST_EXPECT_OK(ec);
+            for (std::size_t i = 0; i < kN; ++i) {
+                const auto sb = client.allocate_system_bytes();
+                const std::array<byte, 1> body = {static_cast<byte>(i)};
+                auto ec2 = co_await client.async_send(secs::hsms::make_data_message(
+                    opt.session_id, 6, 11, false, sb, bytes_view{body.data(), body.size()}));
+                TEST_EXPECT_OK(ec2);
+                sent_sb.push_back(sb);
+            }
+            sent_all = true;
+        },
+        asio::detached);
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto ec = co_await server.async_open_passive(std::move(server_conn));
+            TEST_EXPECT_OK(ec);
+
+            // 等对端全部发出后，所有消息都已在入站队列中就绪。
+            while (!sent_all) {
+                asio::steady_timer t(ioc);
+                t.expires_after(1ms);
+                (void)co_await t.async_wait(asio::as_tuple(asio::use_awaitable));
+            }
+            {
+                asio::steady_timer t(ioc);
+                t.expires_after(10ms);
+                (void)co_await t.async_wait(asio::as_tuple(asio::use_awaitable));
+            }
+
+            // max_n 限制单批条数；0 表示取走余下全部。顺序与到达顺序一致。
+            auto [ec1, first] = co_await server.async_receive_data_batch(4, 100ms);
+            TEST_EXPECT_OK(ec1);
+            TEST_EXPECT_EQ(first.size(), std::size_t{4});
+            auto [ec2, rest] = co_await server.async_receive_data_batch(0, 100ms);
+            TEST_EXPECT_OK(ec2);
+            TEST_EXPECT_EQ(rest.size(), kN - 4);
+
+            std::vector<std::uint32_t> got;
+            for (const auto &m : first) {
+                got.push_back(m.header.system_bytes);
+            }
+            for (const auto &m : rest) {
+                got.push_back(m.header.system_bytes);
+            }
+            TEST_EXPECT(got == sent_sb);
+
+            // 队列已空：等待超时。
+            auto [ec3, none] = co_await server.async_receive_data_batch(0, 5ms);
+            TEST_EXPECT_EQ(ec3, make_error_code(errc::timeout));
+            TEST_EXPECT(none.empty());
+
+            client.stop();
+            server.stop();
+            done = true;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done);
+}
+
+void test_sessions_on_multithreaded_io_context() {
+    // 多个会话共享一个多线程 io_context：各会话绑定自己的 strand，入口从
+    // 非 strand 执行器调用时自动切换。断言结果汇总到原子量，在主线程检查。
+    asio::io_context ioc;
+
+    SessionOptions opt;
+    opt.session_id = 0x0001;
+    opt.t3 = 2s;
+    opt.t6 = 1s;
+    opt.t7 = 1s;
+    opt.t8 = secs::core::duration{};
+    opt.auto_reconnect = false;
+
+    constexpr std::size_t kPairs = 4;
+    constexpr std::size_t kRequests = 200;
+    constexpr std::size_t kThreads = 4;
+
+    std::vector<std::unique_ptr<Session>> servers;
+    std::vector<std::unique_ptr<Session>> clients;
+    asio::ip::tcp::acceptor acceptor(
+        ioc, asio::ip::tcp::endpoint{asio::ip::make_address("127.0.0.1"), 0});
+    const auto endpoint = acceptor.local_endpoint();
+
+    // 建链在单线程下依次完成（acceptor 本身不是线程安全的）。
+    for (std::size_t i = 0; i < kPairs; ++i) {
+        servers.push_back(std::make_unique<Session>(ioc.get_executor(), opt));
+        clients.push_back(std::make_unique<Session>(ioc.get_executor(), opt));
+        auto &server = *servers.back();
+        auto &client = *clients.back();
+        using SessionStrand = asio::strand<asio::any_io_executor>;
+        TEST_EXPECT(server.executor().target<SessionStrand>() != nullptr);
+
+        int opened = 0;
+        asio::co_spawn(
+            ioc,
+            [&]() -> asio::awaitable<void> {
+                auto [ec, sock] = co_await acceptor.async_accept(
+                    server.executor(), asio::as_tuple(asio::use_awaitable));
+                TEST_EXPECT_OK(ec);
+                TEST_EXPECT_OK(co_await server.async_open_passive(std::move(sock)));
+                ++opened;
+            },
+            asio::detached);
+        asio::co_spawn(
+            ioc,
+            [&]() -> asio::awaitable<void> {
+                TEST_EXPECT_OK(co_await client.async_open_active(endpoint));
+                ++opened;
+            },
+            asio::detached);
+        while (opened != 2) {
+            ioc.run_one();
+        }
+    }
+
+    std::atomic<std::size_t> failures{0};
+    std::atomic<std::size_t> completed{0};
+    std::atomic<std::size_t> finished{0};
+    for (auto &server : servers) {
+        asio::co_spawn(
+            ioc,
+            [&, s = server.get()]() -> asio::awaitable<void> {
+                for (;;) {
+                    auto [ec, msg] = co_await s->async_receive_data();
+                    if (ec) {
+                        co_return;
+                    }
+                    auto rsp = secs::hsms::make_data_message(
+                        msg.header.session_id,
+                        msg.stream(),
+                        static_cast<std::uint8_t>(msg.function() + 1),
+                        false,
+                        msg.header.system_bytes,
+                        msg.body_view());
+                    if (co_await s->async_send(rsp)) {
+                        co_return;
+                    }
+                }
+            },
+            asio::detached);
+    }
+    for (auto &client : clients) {
+        asio::co_spawn(
+            ioc,
+            [&, c = client.get()]() -> asio::awaitable<void> {
+                for (std::size_t i = 0; i < kRequests; ++i) {
+                    const std::array<byte, 2> body = {static_cast<byte>(i),
+                                                      static_cast<byte>(i >> 8)};
+                    auto [ec, rsp] = co_await c->async_request_data(
+                        1, 1, bytes_view{body.data(), body.size()});
+                    if (ec || rsp.body.size() != body.size() ||
+                        rsp.body[0] != body[0] || rsp.body[1] != body[1]) {
+                        failures.fetch_add(1);
+                    } else {
+                        completed.fetch_add(1);
+                    }
+                }
+                if (finished.fetch_add(1) + 1 == kPairs) {
+                    for (auto &s : servers) {
+                        s->stop();
+                    }
+                    for (auto &s : clients) {
+                        s->stop();
+                    }
+                }
+            },
+            asio::detached);
+    }
+
+    std::vector<std::thread> pool;
+    for (std::size_t i = 0; i < kThreads; ++i) {
+        pool.emplace_back([&] { ioc.run(); });
+    }
+    for (auto &t : pool) {
+        t.join();
+    }
+
+    TEST_EXPECT_EQ(failures.load(), std::size_t{0});
+    TEST_EXPECT_EQ(completed.load(), kPairs * kRequests);
+    for (auto &c : clients) {
+        TEST_EXPECT(c->state() == secs::hsms::SessionState::disconnected);
+    }
+}
+
+void test_stop_off_strand_outlived_by_session() {
+    // strand 外 stop() 后立即析构 Session：投递的断线通知不得访问已析构对象。
+    asio::io_context ioc;
+    SessionOptions opt;
+    opt.session_id = 0x0001;
+    {
+        auto session = std::make_unique<Session>(ioc.get_executor(), opt);
+        session->stop();
+    }
+    ioc.run();
+
+    // async_stop()：从普通执行器调用，返回时停止流程已在 strand 上完成。
+    ioc.restart();
+    Session session(ioc.get_executor(), opt);
+    std::error_code stop_ec = make_error_code(errc::timeout);
+    int attempts = 0;
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            stop_ec = co_await session.async_stop();
+            // 已停止：主动端循环不再建链。
+            TEST_EXPECT_OK(co_await session.async_run_active(
+                [&](Connection &) -> asio::awaitable<std::error_code> {
+                    ++attempts;
+                    co_return std::error_code{};
+                }));
+        },
+        asio::detached);
+    ioc.run();
+    TEST_EXPECT_OK(stop_ec);
+    TEST_EXPECT(session.state() == secs::hsms::SessionState::disconnected);
+    TEST_EXPECT_EQ(attempts, 0);
+}
+
 void test_run_active_exits_when_auto_reconnect_disabled() {
     asio::io_context ioc;
 
@@ -2350,8 +3138,469 @@ void test_run_active_exits_when_auto_reconnect_disabled() {
     TEST_EXPECT(done.load());
 }
 
+void test_connect_governor_token_bucket_and_backoff() {
+    // 注入时钟：令牌桶完全由测试推进，结果可复现。
+    auto now = secs::core::steady_clock::time_point{} + 1h;
+    ConnectGovernor gov(ConnectGovernorOptions{
+        .rate_per_second = 10.0,
+        .burst = 3,
+        .backoff_multiplier = 2.0,
+        .max_backoff = 1s,
+        .jitter = 0.0,
+        .seed = 1,
+        .clock = [&now]() { return now; },
+    });
+
+    // 突发 3 个立即可用，之后按 100ms 间隔排队（透支预约）。
+    TEST_EXPECT_EQ(gov.reserve(), secs::core::duration{});
+    TEST_EXPECT_EQ(gov.reserve(), secs::core::duration{});
+    TEST_EXPECT_EQ(gov.reserve(), secs::core::duration{});
+    TEST_EXPECT_EQ(gov.reserve(), secs::core::duration{100ms});
+    TEST_EXPECT_EQ(gov.reserve(), secs::core::duration{200ms});
+    TEST_EXPECT_EQ(gov.granted(), 5U);
+    TEST_EXPECT_EQ(gov.throttled(), 2U);
+
+    // 150ms 后补回 1.5 个令牌：仍欠 0.5 个。
+    now += 150ms;
+    TEST_EXPECT_EQ(gov.reserve(), secs::core::duration{150ms});
+    // 长时间空闲后桶回满（不超过 burst）。
+    now += 10s;
+    for (int i = 0; i < 3; ++i) {
+        TEST_EXPECT_EQ(gov.reserve(), secs::core::duration{});
+    }
+    TEST_EXPECT_EQ(gov.reserve(), secs::core::duration{100ms});
+
+    // 无抖动：T5 * 2^(n-1)，封顶 max_backoff。
+    TEST_EXPECT_EQ(gov.backoff(100ms, 1), secs::core::duration{100ms});
+    TEST_EXPECT_EQ(gov.backoff(100ms, 2), secs::core::duration{200ms});
+    TEST_EXPECT_EQ(gov.backoff(100ms, 4), secs::core::duration{800ms});
+    TEST_EXPECT_EQ(gov.backoff(100ms, 5), secs::core::duration{1s});
+    TEST_EXPECT_EQ(gov.backoff(100ms, 1000), secs::core::duration{1s});
+
+    // 抖动：落在 [d/2, d]，同一种子得到同一序列。
+    ConnectGovernor a(ConnectGovernorOptions{.jitter = 0.5, .seed = 7});
+    ConnectGovernor b(ConnectGovernorOptions{.jitter = 0.5, .seed = 7});
+    bool varied = false;
+    secs::core::duration prev{};
+    for (std::uint32_t n = 1; n <= 32; ++n) {
+        const auto da = a.backoff(1s, 1);
+        TEST_EXPECT_EQ(da, b.backoff(1s, 1));
+        TEST_EXPECT(da >= secs::core::duration{500ms});
+        TEST_EXPECT(da <= secs::core::duration{1s});
+        varied = varied || (n > 1 && da != prev);
+        prev = da;
+    }
+    TEST_EXPECT(varied);
+
+    // rate <= 0：不限速。
+    ConnectGovernor unlimited(ConnectGovernorOptions{.rate_per_second = 0.0});
+    for (int i = 0; i < 100; ++i) {
+        TEST_EXPECT_EQ(unlimited.reserve(), secs::core::duration{});
+    }
+}
+
+void test_run_active_governor_spreads_reconnect_storm() {
+    asio::io_context ioc;
+    constexpr std::size_t kSessions = 8;
+    constexpr auto kInterval = 5ms; // 200 次/秒
+
+    auto governor = std::make_shared<ConnectGovernor>(ConnectGovernorOptions{
+        .rate_per_second = 200.0,
+        .burst = 2,
+        .backoff_multiplier = 2.0,
+        .max_backoff = 200ms,
+        .jitter = 0.5,
+        .seed = 42,
+    });
+
+    SessionOptions client_opt;
+    client_opt.t5 = 20ms;
+    client_opt.t6 = 200ms;
+    client_opt.t8 = 0ms;
+    client_opt.auto_reconnect = true;
+    client_opt.governor = governor;
+
+    SessionOptions server_opt;
+    server_opt.t6 = 200ms;
+    server_opt.t7 = 500ms;
+    server_opt.t8 = 0ms;
+    server_opt.auto_reconnect = false;
+
+    // 纯内存“网络”：每次建链新建一对内存流，并为其起一个被动端 Session。
+    std::vector<std::unique_ptr<Session>> clients;
+    std::vector<std::vector<std::unique_ptr<Session>>> servers(kSessions);
+    std::vector<secs::core::steady_clock::time_point> attempts;
+    for (std::size_t i = 0; i < kSessions; ++i) {
+        client_opt.session_id = static_cast<std::uint16_t>(0x100 + i);
+        clients.push_back(std::make_unique<Session>(ioc.get_executor(), client_opt));
+    }
+
+    const auto make_connect = [&](std::size_t i) -> secs::hsms::ConnectFn {
+        return [&, i](Connection &conn) -> asio::awaitable<std::error_code> {
+            attempts.push_back(secs::core::steady_clock::now());
+            auto duplex = make_memory_duplex(ioc.get_executor());
+            auto opt = server_opt;
+            opt.session_id = static_cast<std::uint16_t>(0x100 + i);
+            servers[i].push_back(std::make_unique<Session>(ioc.get_executor(), opt));
+            auto *server = servers[i].back().get();
+            asio::co_spawn(
+                ioc,
+                [server, stream = std::move(duplex.server_stream)]() mutable
+                -> asio::awaitable<void> {
+                    (void)co_await server->async_open_passive(
+                        Connection(std::move(stream)));
+                },
+                asio::detached);
+            conn = Connection(std::move(duplex.client_stream));
+            co_return std::error_code{};
+        };
+    };
+
+    std::size_t run_exited = 0;
+    std::atomic<bool> done{false};
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            // 第一波：8 个会话同时启动，只有 burst 个立即建链，其余按令牌间隔排开。
+            const auto start = secs::core::steady_clock::now();
+            for (std::size_t i = 0; i < kSessions; ++i) {
+                asio::co_spawn(
+                    ioc,
+                    [&, i]() -> asio::awaitable<void> {
+                        (void)co_await clients[i]->async_run_active(make_connect(i));
+                        ++run_exited;
+                    },
+                    asio::detached);
+            }
+            for (auto &c : clients) {
+                TEST_EXPECT_OK(co_await c->async_wait_selected(1, 2s));
+            }
+            TEST_EXPECT_EQ(attempts.size(), kSessions);
+            std::sort(attempts.begin(), attempts.end());
+            for (std::size_t k = 2; k < attempts.size(); ++k) {
+                TEST_EXPECT(attempts[k] - start >= (k - 1) * kInterval);
+            }
+            TEST_EXPECT(governor->throttled() >= 1U);
+
+            // 网络抖动：所有连接同时断开。重连前至少退避 T5*(1-jitter)，且不再同时发生。
+            attempts.clear();
+            const auto blip = secs::core::steady_clock::now();
+            for (auto &per_client : servers) {
+                per_client.back()->stop();
+            }
+            // 先等客户端察觉断线（仍处于第 1 代 selected 时 async_wait_selected(2) 不会让出）。
+            asio::steady_timer poll(ioc.get_executor());
+            for (auto &c : clients) {
+                while (c->is_selected() && c->selected_generation() < 2) {
+                    poll.expires_after(1ms);
+                    (void)co_await poll.async_wait(asio::as_tuple(asio::use_awaitable));
+                }
+            }
+            for (auto &c : clients) {
+                TEST_EXPECT_OK(co_await c->async_wait_selected(2, 2s));
+            }
+            TEST_EXPECT_EQ(attempts.size(), kSessions);
+            std::sort(attempts.begin(), attempts.end());
+            TEST_EXPECT(attempts.front() - blip >= 10ms);
+            TEST_EXPECT(attempts.back() - attempts.front() >= 2ms);
+            TEST_EXPECT_EQ(governor->granted(), 2 * kSessions);
+
+            for (auto &c : clients) {
+                c->stop();
+            }
+            for (auto &per_client : servers) {
+                for (auto &server : per_client) {
+                    server->stop();
+                }
+            }
+            // stop() 打断退避等待，run 循环全部退出。
+            for (int i = 0; i < 100 && run_exited < kSessions; ++i) {
+                poll.expires_after(1ms);
+                (void)co_await poll.async_wait(asio::as_tuple(asio::use_awaitable));
+            }
+            TEST_EXPECT_EQ(run_exited, kSessions);
+            done = true;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+}
+
+void test_run_active_stop_interrupts_backoff() {
+    asio::io_context ioc;
+
+    SessionOptions opt;
+    opt.session_id = 0x0001;
+    opt.t5 = 10s;
+    opt.auto_reconnect = true;
+    Session client(ioc.get_executor(), opt);
+
+    int attempts = 0;
+    std::atomic<bool> done{false};
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            const auto started = secs::core::steady_clock::now();
+            auto ec = co_await client.async_run_active(
+                [&](Connection &) -> asio::awaitable<std::error_code> {
+                    ++attempts;
+                    co_return make_error_code(errc::invalid_argument);
+                });
+            TEST_EXPECT_OK(ec);
+            TEST_EXPECT_EQ(attempts, 1);
+            TEST_EXPECT(secs::core::steady_clock::now() - started < 5s);
+            done = true;
+        },
+        asio::detached);
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            asio::steady_timer t(ioc.get_executor());
+            t.expires_after(20ms);
+            (void)co_await t.async_wait(asio::as_tuple(asio::use_awaitable));
+            client.stop();
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+}
+
 } // namespace
 
+GeneralSessionOptions make_gs_options(std::vector<std::uint16_t> ids) {
+    GeneralSessionOptions opt;
+    opt.session_ids = std::move(ids);
+    opt.t3 = 200ms;
+    opt.t6 = 50ms;
+    opt.t7 = 200ms;
+    opt.t8 = 50ms;
+    opt.auto_reconnect = false;
+    return opt;
+}
+
+void test_general_session_multiplexes_sessions() {
+    asio::io_context ioc;
+
+    GeneralSession server(ioc.get_executor(), make_gs_options({1, 2}));
+    GeneralSession client(ioc.get_executor(), make_gs_options({2, 1}));
+
+    auto duplex = make_memory_duplex(ioc.get_executor());
+    Connection client_conn(std::move(duplex.client_stream));
+    Connection server_conn(std::move(duplex.server_stream));
+
+    // 服务端：每个逻辑会话各自回显，回包 body 首字节标记 SessionID。
+    for (const std::uint16_t sid : {std::uint16_t{1}, std::uint16_t{2}}) {
+        asio::co_spawn(
+            ioc,
+            [&server, sid]() -> asio::awaitable<void> {
+                for (;;) {
+                    auto [ec, msg] = co_await server.async_receive_data(sid);
+                    if (ec) {
+                        co_return;
+                    }
+                    TEST_EXPECT_EQ(msg.header.session_id, sid);
+                    std::vector<byte> body = {static_cast<byte>(sid)};
+                    body.insert(body.end(), msg.body.begin(), msg.body.end());
+                    const auto rsp = secs::hsms::make_data_message(
+                        sid,
+                        msg.stream(),
+                        static_cast<std::uint8_t>(msg.function() + 1),
+                        false,
+                        msg.header.system_bytes,
+                        bytes_view{body.data(), body.size()});
+                    TEST_EXPECT_OK(co_await server.async_send(rsp));
+                }
+            },
+            asio::detached);
+    }
+
+    std::atomic<bool> done{false};
+    asio::co_spawn(
+        ioc, server.async_open_passive(std::move(server_conn)), asio::detached);
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto ec = co_await client.async_open_active(std::move(client_conn));
+            TEST_EXPECT_OK(ec);
+            TEST_EXPECT_EQ(client.selected_count(), 2U);
+            TEST_EXPECT(server.is_selected(1));
+            TEST_EXPECT(server.is_selected(2));
+
+            for (int i = 0; i < 20; ++i) {
+                const std::uint16_t sid = (i % 2 == 0) ? 1 : 2;
+                const std::vector<byte> payload = {static_cast<byte>(i)};
+                auto [rec, rsp] = co_await client.async_request_data(
+                    sid, 1, 1, bytes_view{payload.data(), payload.size()});
+                TEST_EXPECT_OK(rec);
+                TEST_EXPECT_EQ(rsp.header.session_id, sid);
+                TEST_EXPECT_EQ(rsp.function(), 2);
+                TEST_EXPECT_EQ(rsp.body.size(), 2U);
+                if (rsp.body.size() == 2U) {
+                    TEST_EXPECT_EQ(rsp.body[0], static_cast<byte>(sid));
+                    TEST_EXPECT_EQ(rsp.body[1], static_cast<byte>(i));
+                }
+            }
+
+            // LINKTEST 是连接级的。
+            TEST_EXPECT_OK(co_await client.async_linktest());
+
+            // DESELECT 只影响目标逻辑会话。
+            TEST_EXPECT_OK(co_await client.async_deselect(2));
+            TEST_EXPECT(!client.is_selected(2));
+            TEST_EXPECT(!server.is_selected(2));
+            TEST_EXPECT(server.is_selected(1));
+            const auto msg2 = secs::hsms::make_data_message(2, 1, 1, false, 99, {});
+            TEST_EXPECT_EQ(co_await client.async_send(msg2),
+                           make_error_code(errc::invalid_argument));
+
+            auto [rec, rsp] = co_await client.async_request_data(1, 1, 1, {});
+            TEST_EXPECT_OK(rec);
+
+            // 重新 SELECT 后可继续使用。
+            TEST_EXPECT_OK(co_await client.async_select(2));
+            TEST_EXPECT(server.is_selected(2));
+
+            // SEPARATE 同样只结束目标逻辑会话，连接保持。
+            TEST_EXPECT_OK(co_await client.async_separate(1));
+            asio::steady_timer t(ioc);
+            t.expires_after(5ms);
+            (void)co_await t.async_wait(asio::as_tuple(asio::use_awaitable));
+            TEST_EXPECT(!server.is_selected(1));
+            TEST_EXPECT(server.is_selected(2));
+            TEST_EXPECT(server.is_connected());
+
+            client.stop();
+            server.stop();
+            done = true;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+    TEST_EXPECT_EQ(server.state(1), secs::hsms::SessionState::disconnected);
+}
+
+void test_general_session_rejects_unknown_and_unselected() {
+    asio::io_context ioc;
+
+    GeneralSession server(ioc.get_executor(), make_gs_options({1}));
+
+    auto duplex = make_memory_duplex(ioc.get_executor());
+    Connection peer(std::move(duplex.client_stream));
+    Connection server_conn(std::move(duplex.server_stream));
+
+    std::atomic<bool> done{false};
+    asio::co_spawn(
+        ioc, server.async_open_passive(std::move(server_conn)), asio::detached);
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            // 未注册的 SessionID：Select.rsp status=4。
+            TEST_EXPECT_OK(co_await peer.async_write_message(
+                secs::hsms::make_select_req(7, 100)));
+            auto [ec, rsp] = co_await peer.async_read_message();
+            TEST_EXPECT_OK(ec);
+            TEST_EXPECT(rsp.header.s_type == secs::hsms::SType::select_rsp);
+            TEST_EXPECT_EQ(rsp.header.session_id, 7);
+            TEST_EXPECT_EQ(rsp.header.header_byte2, 4);
+
+            // 已注册：接受。
+            TEST_EXPECT_OK(co_await peer.async_write_message(
+                secs::hsms::make_select_req(1, 101)));
+            std::tie(ec, rsp) = co_await peer.async_read_message();
+            TEST_EXPECT_OK(ec);
+            TEST_EXPECT_EQ(rsp.header.header_byte2, 0);
+            TEST_EXPECT(server.is_selected(1));
+
+            // 重复 SELECT：status=1（already active）。
+            TEST_EXPECT_OK(co_await peer.async_write_message(
+                secs::hsms::make_select_req(1, 102)));
+            std::tie(ec, rsp) = co_await peer.async_read_message();
+            TEST_EXPECT_OK(ec);
+            TEST_EXPECT_EQ(rsp.header.header_byte2, 1);
+
+            // 未选择的 SessionID 上的数据：Reject.req reason=4，回显原 header。
+            TEST_EXPECT_OK(co_await peer.async_write_message(
+                secs::hsms::make_data_message(5, 1, 1, true, 103, {})));
+            std::tie(ec, rsp) = co_await peer.async_read_message();
+            TEST_EXPECT_OK(ec);
+            TEST_EXPECT(rsp.header.s_type == secs::hsms::SType::reject_req);
+            TEST_EXPECT_EQ(rsp.header.header_byte2, 4);
+            TEST_EXPECT_EQ(rsp.header.system_bytes, 103U);
+            secs::hsms::Header rejected{};
+            TEST_EXPECT_OK(secs::hsms::decode_header(
+                bytes_view{rsp.body.data(), rsp.body.size()}, rejected));
+            TEST_EXPECT_EQ(rejected.session_id, 5);
+
+            // 已选择的逻辑会话正常交付。
+            TEST_EXPECT_OK(co_await peer.async_write_message(
+                secs::hsms::make_data_message(1, 1, 3, false, 104, {})));
+            auto [rec, data] = co_await server.async_receive_data(1, 200ms);
+            TEST_EXPECT_OK(rec);
+            TEST_EXPECT_EQ(data.function(), 3);
+
+            // LINKTEST（0xFFFF）由连接直接应答。
+            TEST_EXPECT_OK(co_await peer.async_write_message(
+                secs::hsms::make_linktest_req(0xFFFF, 105)));
+            std::tie(ec, rsp) = co_await peer.async_read_message();
+            TEST_EXPECT_OK(ec);
+            TEST_EXPECT(rsp.header.s_type == secs::hsms::SType::linktest_rsp);
+
+            // 参数校验。
+            TEST_EXPECT_EQ(server.add_session(0x8001),
+                           make_error_code(errc::invalid_argument));
+            TEST_EXPECT_OK(server.add_session(9));
+            TEST_EXPECT_EQ(server.state(9), secs::hsms::SessionState::connected);
+            auto [uec, unused] = co_await server.async_receive_data(42, 1ms);
+            TEST_EXPECT_EQ(uec, make_error_code(errc::invalid_argument));
+
+            server.stop();
+            peer.cancel_and_close();
+            done = true;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+}
+
+void test_general_session_open_active_fails_on_unknown_entity() {
+    asio::io_context ioc;
+
+    GeneralSession server(ioc.get_executor(), make_gs_options({1}));
+    GeneralSession client(ioc.get_executor(), make_gs_options({1, 3}));
+
+    auto duplex = make_memory_duplex(ioc.get_executor());
+    Connection client_conn(std::move(duplex.client_stream));
+    Connection server_conn(std::move(duplex.server_stream));
+
+    std::atomic<bool> done{false};
+    asio::co_spawn(
+        ioc, server.async_open_passive(std::move(server_conn)), asio::detached);
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto ec = co_await client.async_open_active(std::move(client_conn));
+            TEST_EXPECT_EQ(ec, make_error_code(errc::invalid_argument));
+            TEST_EXPECT(!client.is_connected());
+            TEST_EXPECT_EQ(client.selected_count(), 0U);
+            TEST_EXPECT_OK(co_await server.async_wait_reader_stopped(200ms));
+            TEST_EXPECT(!server.is_connected());
+            server.stop();
+            done = true;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+}
+
 int main() {
     // 仅用于本地调试定位“卡住在哪个用例”，默认不输出；按需设置：
     // SECS_TEST_TRACE=1 ./build/tests/test_hsms_transport
@@ -2368,8 +3617,15 @@ int main() {
     RUN_TEST(test_encode_frame_rejects_oversized_payload);
     RUN_TEST(test_connection_write_rejects_oversized_message);
     RUN_TEST(test_connection_queue_limit_prioritizes_control);
+    RUN_TEST(test_connection_data_priority_lanes);
     RUN_TEST(test_timer_wait_and_cancel);
     RUN_TEST(test_connection_loopback_framing);
+    RUN_TEST(test_connection_writes_shared_body_without_copy);
+    RUN_TEST(test_connection_writes_streamed_body_in_chunks);
+    RUN_TEST(test_connection_reads_registered_body_into_sink);
+    RUN_TEST(test_connection_read_paused_by_memory_budget);
+    RUN_TEST(test_connection_capture_and_replay);
+    RUN_TEST(test_replay_original_speed_and_corrupt_input);
     RUN_TEST(test_connection_t8_intercharacter_timeout);
     RUN_TEST(test_connection_t8_disabled);
     RUN_TEST(test_connection_null_stream_and_tcpstream_error_paths);
@@ -2397,7 +3653,16 @@ int main() {
     RUN_TEST(test_session_separate_clears_inbound_and_cancels_pending);
     RUN_TEST(test_session_reopen_after_separate);
     RUN_TEST(test_session_concurrent_sends_system_bytes_unique);
+    RUN_TEST(test_session_receive_data_batch);
+    RUN_TEST(test_sessions_on_multithreaded_io_context);
+    RUN_TEST(test_stop_off_strand_outlived_by_session);
     RUN_TEST(test_run_active_exits_when_auto_reconnect_disabled);
+    RUN_TEST(test_connect_governor_token_bucket_and_backoff);
+    RUN_TEST(test_run_active_governor_spreads_reconnect_storm);
+    RUN_TEST(test_run_active_stop_interrupts_backoff);
+    RUN_TEST(test_general_session_multiplexes_sessions);
+    RUN_TEST(test_general_session_rejects_unknown_and_unselected);
+    RUN_TEST(test_general_session_open_active_fails_on_unknown_entity);
 
 #undef RUN_TEST
     return ::secs::tests::run_and_report();
@@ -5,7 +5,9 @@
 #include "secs/core/common.hpp"
 #include "secs/core/error.hpp"
 #include "secs/core/event.hpp"
+#include "secs/core/shared_bytes.hpp"
 #include "secs/hsms/connection.hpp"
+#include "secs/hsms/general_session.hpp"
 #include "secs/hsms/message.hpp"
 #include "secs/hsms/session.hpp"
 #include "secs/secs1/link.hpp"
@@ -27,9 +29,11 @@
 #include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <filesystem>
 #include <memory>
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
 #include <string_view>
 #include <system_error>
@@ -221,7 +225,8 @@ void test_system_bytes_unique_release_reuse_and_wrap() {
 
     std::uint32_t b2 = 0;
     TEST_EXPECT_OK(sb.allocate(b2));
-    TEST_EXPECT_EQ(b2, b); // 释放后应可重用
+    TEST_EXPECT_EQ(b2, c + 1U); // 候选值单调前进：释放的值要绕一圈才会复用
+    TEST_EXPECT(sb.is_in_use(b2));
     TEST_EXPECT_EQ(sb.in_use_count(), 3U);
 
     sb.release(a);
@@ -277,6 +282,71 @@ void test_system_bytes_exhaustion_small_space() {
     TEST_EXPECT_EQ(sb.in_use_count(), 3U);
 }
 
+void test_system_bytes_window_limits_in_flight() {
+    SystemBytes sb(1U);
+
+    std::vector<std::uint32_t> held;
+    held.reserve(SystemBytes::kWindowSize);
+    for (std::size_t i = 0; i < SystemBytes::kWindowSize; ++i) {
+        std::uint32_t v = 0;
+        TEST_EXPECT_OK(sb.allocate(v));
+        held.push_back(v);
+    }
+    TEST_EXPECT_EQ(sb.in_use_count(), SystemBytes::kWindowSize);
+
+    std::uint32_t extra = 0;
+    TEST_EXPECT_EQ(sb.allocate(extra), make_error_code(errc::buffer_overflow));
+
+    // 释放窗口中间的一个值后，只有与它同槽的下一个候选可用。
+    const auto released = held[100];
+    sb.release(released);
+    TEST_EXPECT_OK(sb.allocate(extra));
+    TEST_EXPECT(extra > released);
+    TEST_EXPECT_EQ((extra - released) % SystemBytes::kWindowSize, 0U);
+    TEST_EXPECT(!sb.is_in_use(released));
+    TEST_EXPECT(sb.is_in_use(extra));
+
+    // 同槽的另一个值不算“在用”。
+    TEST_EXPECT(!sb.is_in_use(
+        held[0] + 2U * static_cast<std::uint32_t>(SystemBytes::kWindowSize)));
+}
+
+void test_system_bytes_concurrent_allocate_release() {
+    SystemBytes sb(1U);
+
+    constexpr int kThreads = 4;
+    constexpr int kRounds = 20000;
+    constexpr int kBatch = 8;
+
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&] {
+            std::uint32_t held[kBatch]{};
+            for (int r = 0; r < kRounds; ++r) {
+                for (auto &v : held) {
+                    if (sb.allocate(v) || v == 0U) {
+                        failures.fetch_add(1);
+                    }
+                }
+                for (auto v : held) {
+                    // 持有期间必须一直在用（未被其它线程重复分配后释放）。
+                    if (!sb.is_in_use(v)) {
+                        failures.fetch_add(1);
+                    }
+                    sb.release(v);
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    TEST_EXPECT_EQ(failures.load(), 0);
+    TEST_EXPECT_EQ(sb.in_use_count(), 0U);
+}
+
 void test_router_set_find_erase_clear() {
     Router r;
     TEST_EXPECT(!r.find(1, 1).has_value());
@@ -1631,117 +1701,136 @@ void test_session_invalid_arguments() {
     ioc.run();
 }
 
-void test_protocol_runtime_dump_hsms_and_secs1() {
-    // 1) HSMS：跑一次 request/response，并验证 dump sink 收到输出
-    {
-        asio::io_context ioc;
-        const std::uint16_t session_id = 0x2222;
-
-        secs::core::Event server_opened{};
-        secs::core::Event client_opened{};
-
-        secs::hsms::Session server(ioc.get_executor(),
-                                   secs::hsms::SessionOptions{
-                                       .session_id = session_id,
-                                       .t3 = 200ms,
-                                       .t5 = 10ms,
-                                       .t6 = 50ms,
-                                       .t7 = 50ms,
-                                       .t8 = 0ms,
-                                       .linktest_interval = 0ms,
-                                       .auto_reconnect = false,
-                                   });
-
-        secs::hsms::Session client(ioc.get_executor(),
-                                   secs::hsms::SessionOptions{
-                                       .session_id = session_id,
-                                       .t3 = 200ms,
-                                       .t5 = 10ms,
-                                       .t6 = 50ms,
-                                       .t7 = 50ms,
-                                       .t8 = 0ms,
-                                       .linktest_interval = 0ms,
-                                       .auto_reconnect = false,
-                                   });
+void run_hsms_dump_case(bool deferred) {
+    // HSMS：跑一次 request/response，并验证 dump sink 收到输出
+    asio::io_context ioc;
+    const std::uint16_t session_id = 0x2222;
 
-        std::string captured;
-        captured.reserve(1u << 20);
+    secs::core::Event server_opened{};
+    secs::core::Event client_opened{};
 
-        SessionOptions proto_opts{};
-        proto_opts.t3 = 200ms;
-        proto_opts.poll_interval = 1ms;
-        proto_opts.dump.enable = true;
-        proto_opts.dump.dump_tx = true;
-        proto_opts.dump.dump_rx = true;
-        proto_opts.dump.sink = append_to_string_sink;
-        proto_opts.dump.sink_user = &captured;
-        proto_opts.dump.hsms.include_hex = false;
-        proto_opts.dump.hsms.enable_secs2_decode = false;
-
-        Session proto_server(server, session_id, proto_opts);
-        Session proto_client(client, session_id, proto_opts);
-
-        proto_server.router().set(
-            1,
-            1,
-            [](const DataMessage &msg) -> asio::awaitable<secs::protocol::HandlerResult> {
-                co_return secs::protocol::HandlerResult{std::error_code{},
-                                                        msg.body};
-            });
+    secs::hsms::Session server(ioc.get_executor(),
+                               secs::hsms::SessionOptions{
+                                   .session_id = session_id,
+                                   .t3 = 200ms,
+                                   .t5 = 10ms,
+                                   .t6 = 50ms,
+                                   .t7 = 50ms,
+                                   .t8 = 0ms,
+                                   .linktest_interval = 0ms,
+                                   .auto_reconnect = false,
+                               });
 
-        auto duplex = make_memory_duplex(ioc.get_executor());
-        Connection server_conn(std::move(duplex.server_stream));
-        Connection client_conn(std::move(duplex.client_stream));
+    secs::hsms::Session client(ioc.get_executor(),
+                               secs::hsms::SessionOptions{
+                                   .session_id = session_id,
+                                   .t3 = 200ms,
+                                   .t5 = 10ms,
+                                   .t6 = 50ms,
+                                   .t7 = 50ms,
+                                   .t8 = 0ms,
+                                   .linktest_interval = 0ms,
+                                   .auto_reconnect = false,
+                               });
 
-        asio::co_spawn(
-            ioc,
-            [&, server_conn = std::move(server_conn)]() mutable
-            -> asio::awaitable<void> {
-                TEST_EXPECT_OK(
-                    co_await server.async_open_passive(std::move(server_conn)));
-                server_opened.set();
-            },
-            asio::detached);
+    // 延迟模式下两个 Session 各自在后台线程调用 sink，因此分别收集。
+    std::string captured_server;
+    std::string captured_client;
 
-        asio::co_spawn(
-            ioc,
-            [&, client_conn = std::move(client_conn)]() mutable
-            -> asio::awaitable<void> {
-                TEST_EXPECT_OK(
-                    co_await client.async_open_active(std::move(client_conn)));
-                client_opened.set();
-            },
-            asio::detached);
+    SessionOptions proto_opts{};
+    proto_opts.t3 = 200ms;
+    proto_opts.poll_interval = 1ms;
+    proto_opts.dump.enable = true;
+    proto_opts.dump.dump_tx = true;
+    proto_opts.dump.dump_rx = true;
+    proto_opts.dump.sink = append_to_string_sink;
+    proto_opts.dump.hsms.include_hex = false;
+    proto_opts.dump.hsms.enable_secs2_decode = false;
+    proto_opts.dump.deferred = deferred;
+    proto_opts.dump.deferred_buffer_bytes = 4096;
+
+    SessionOptions server_opts = proto_opts;
+    server_opts.dump.sink_user = &captured_server;
+    SessionOptions client_opts = proto_opts;
+    client_opts.dump.sink_user = &captured_client;
+
+    Session proto_server(server, session_id, server_opts);
+    Session proto_client(client, session_id, client_opts);
 
-        asio::co_spawn(
-            ioc,
-            [&]() -> asio::awaitable<void> {
-                TEST_EXPECT_OK(co_await server_opened.async_wait(200ms));
-                TEST_EXPECT_OK(co_await client_opened.async_wait(200ms));
+    proto_server.router().set(
+        1,
+        1,
+        [](const DataMessage &msg) -> asio::awaitable<secs::protocol::HandlerResult> {
+            co_return secs::protocol::HandlerResult{std::error_code{},
+                                                    msg.body};
+        });
 
-                asio::co_spawn(ioc, proto_server.async_run(), asio::detached);
-                asio::co_spawn(ioc, proto_client.async_run(), asio::detached);
+    auto duplex = make_memory_duplex(ioc.get_executor());
+    Connection server_conn(std::move(duplex.server_stream));
+    Connection client_conn(std::move(duplex.client_stream));
 
-                auto [ec, rsp] =
-                    co_await proto_client.async_request(1, 1, as_bytes("hi"));
-                TEST_EXPECT_OK(ec);
-                TEST_EXPECT_EQ(rsp.stream, 1);
-                TEST_EXPECT_EQ(rsp.function, 2);
+    asio::co_spawn(
+        ioc,
+        [&, server_conn = std::move(server_conn)]() mutable
+        -> asio::awaitable<void> {
+            TEST_EXPECT_OK(
+                co_await server.async_open_passive(std::move(server_conn)));
+            server_opened.set();
+        },
+        asio::detached);
 
-                proto_server.stop();
-                proto_client.stop();
-                server.stop();
-                client.stop();
-                ioc.stop();
-            },
-            asio::detached);
+    asio::co_spawn(
+        ioc,
+        [&, client_conn = std::move(client_conn)]() mutable
+        -> asio::awaitable<void> {
+            TEST_EXPECT_OK(
+                co_await client.async_open_active(std::move(client_conn)));
+            client_opened.set();
+        },
+        asio::detached);
 
-        ioc.run();
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            TEST_EXPECT_OK(co_await server_opened.async_wait(200ms));
+            TEST_EXPECT_OK(co_await client_opened.async_wait(200ms));
 
-        TEST_EXPECT(captured.find("HSMS:") != std::string::npos);
-        TEST_EXPECT(captured.find("S1F1") != std::string::npos);
-        TEST_EXPECT(captured.find("S1F2") != std::string::npos);
-    }
+            asio::co_spawn(ioc, proto_server.async_run(), asio::detached);
+            asio::co_spawn(ioc, proto_client.async_run(), asio::detached);
+
+            auto [ec, rsp] =
+                co_await proto_client.async_request(1, 1, as_bytes("hi"));
+            TEST_EXPECT_OK(ec);
+            TEST_EXPECT_EQ(rsp.stream, 1);
+            TEST_EXPECT_EQ(rsp.function, 2);
+
+            proto_server.stop();
+            proto_client.stop();
+            server.stop();
+            client.stop();
+            ioc.stop();
+        },
+        asio::detached);
+
+    ioc.run();
+
+    // 延迟模式：sink 在后台线程输出，读取前先等待队列排空。
+    proto_server.flush_dump();
+    proto_client.flush_dump();
+    TEST_EXPECT_EQ(proto_server.dump_dropped(), 0u);
+    TEST_EXPECT_EQ(proto_client.dump_dropped(), 0u);
+    const std::string captured = captured_server + captured_client;
+
+    TEST_EXPECT(captured.find("protocol dump: TX HSMS") != std::string::npos);
+    TEST_EXPECT(captured.find("HSMS:") != std::string::npos);
+    TEST_EXPECT(captured.find("S1F1") != std::string::npos);
+    TEST_EXPECT(captured.find("S1F2") != std::string::npos);
+}
+
+void test_protocol_runtime_dump_hsms_and_secs1() {
+    // 1) HSMS：同步 dump 与延迟 dump（后台格式化）
+    run_hsms_dump_case(false);
+    run_hsms_dump_case(true);
 
     // 2) SECS-I：跑一次 request/response，并验证 dump sink 收到输出
     {
@@ -1809,9 +1898,389 @@ void test_protocol_runtime_dump_hsms_and_secs1() {
 
 } // namespace
 
+void test_hsms_gs_protocol_sessions_share_connection() {
+    asio::io_context ioc;
+
+    secs::hsms::GeneralSessionOptions gs_opt;
+    gs_opt.session_ids = {0x0011, 0x0022};
+    gs_opt.t3 = 200ms;
+    gs_opt.t6 = 50ms;
+    gs_opt.t7 = 200ms;
+    gs_opt.t8 = 0ms;
+    gs_opt.auto_reconnect = false;
+
+    secs::hsms::GeneralSession server(ioc.get_executor(), gs_opt);
+    secs::hsms::GeneralSession client(ioc.get_executor(), gs_opt);
+
+    SessionOptions proto_opts{};
+    proto_opts.t3 = 200ms;
+
+    // 每个逻辑会话各一个 protocol::Session，共享同一条连接。
+    Session server_a(server, 0x0011, proto_opts);
+    Session server_b(server, 0x0022, proto_opts);
+    Session client_a(client, 0x0011, proto_opts);
+    Session client_b(client, 0x0022, proto_opts);
+
+    auto reply_with = [](std::uint8_t tag) {
+        return [tag](const DataMessage &) -> asio::awaitable<secs::protocol::HandlerResult> {
+            co_return secs::protocol::HandlerResult{std::error_code{},
+                                                    std::vector<byte>{tag}};
+        };
+    };
+    server_a.router().set(1, 1, reply_with(0xA0));
+    server_b.router().set(1, 1, reply_with(0xB0));
+
+    auto duplex = make_memory_duplex(ioc.get_executor());
+    Connection server_conn(std::move(duplex.server_stream));
+    Connection client_conn(std::move(duplex.client_stream));
+
+    asio::co_spawn(
+        ioc, server.async_open_passive(std::move(server_conn)), asio::detached);
+
+    std::atomic<bool> done{false};
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            TEST_EXPECT_OK(co_await client.async_open_active(std::move(client_conn)));
+            asio::co_spawn(ioc, server_a.async_run(), asio::detached);
+            asio::co_spawn(ioc, server_b.async_run(), asio::detached);
+
+            for (int i = 0; i < 10; ++i) {
+                auto [ec_a, rsp_a] = co_await client_a.async_request(1, 1, {});
+                TEST_EXPECT_OK(ec_a);
+                TEST_EXPECT_EQ(rsp_a.body.size(), 1U);
+                TEST_EXPECT(!rsp_a.body.empty() && rsp_a.body[0] == 0xA0);
+
+                auto [ec_b, rsp_b] = co_await client_b.async_request(1, 1, {});
+                TEST_EXPECT_OK(ec_b);
+                TEST_EXPECT_EQ(rsp_b.body.size(), 1U);
+                TEST_EXPECT(!rsp_b.body.empty() && rsp_b.body[0] == 0xB0);
+            }
+
+            // 停止一个 protocol::Session 不影响共享连接上的其它逻辑会话。
+            server_a.stop();
+            client_a.stop();
+            auto [ec_b, rsp_b] = co_await client_b.async_request(1, 1, {});
+            TEST_EXPECT_OK(ec_b);
+            TEST_EXPECT(client.is_connected());
+
+            server_b.stop();
+            client_b.stop();
+            client.stop();
+            server.stop();
+            done = true;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+}
+
+void test_hsms_protocol_spool_and_drain() {
+    asio::io_context ioc;
+    const std::uint16_t session_id = 0x1031;
+
+    const secs::hsms::SessionOptions hsms_opt{
+        .session_id = session_id,
+        .t3 = 200ms,
+        .t5 = 10ms,
+        .t6 = 50ms,
+        .t7 = 50ms,
+        .t8 = 0ms,
+        .linktest_interval = 0ms,
+        .auto_reconnect = false,
+    };
+    secs::hsms::Session server(ioc.get_executor(), hsms_opt);
+    secs::hsms::Session client(ioc.get_executor(), hsms_opt);
+
+    const auto dir =
+        (std::filesystem::temp_directory_path() / "secs_test_protocol_spool").string();
+    std::filesystem::remove_all(dir);
+    auto spool = std::make_shared<secs::protocol::Spool>(
+        secs::protocol::SpoolOptions{.directory = dir, .segment_bytes = 1024});
+    TEST_EXPECT_OK(spool->open());
+    TEST_EXPECT_OK(spool->enable_stream(6));
+
+    SessionOptions client_opts{};
+    client_opts.t3 = 200ms;
+    client_opts.spool = spool;
+    Session proto_client(client, session_id, client_opts);
+    Session proto_server(server, session_id, SessionOptions{.t3 = 200ms});
+
+    std::vector<std::pair<int, byte>> received;
+    const auto record = [&](const DataMessage &msg)
+        -> asio::awaitable<secs::protocol::HandlerResult> {
+        received.emplace_back(msg.function, msg.body.empty() ? 0 : msg.body[0]);
+        co_return secs::protocol::HandlerResult{std::error_code{}, {}};
+    };
+    proto_server.router().set(6, 11, record);
+    proto_server.router().set(6, 1, record);
+
+    auto duplex = make_memory_duplex(ioc.get_executor());
+    Connection server_conn(std::move(duplex.server_stream));
+    Connection client_conn(std::move(duplex.client_stream));
+
+    constexpr int kSpooled = 40;
+    std::atomic<bool> done{false};
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            // 链路未建立：S6 写入 spool，其它 Stream 照常发送（失败）。
+            for (int i = 0; i < kSpooled; ++i) {
+                const std::vector<byte> body = {static_cast<byte>(i)};
+                const bytes_view bv{body.data(), body.size()};
+                if (i % 2 == 0) {
+                    auto [ec, rsp] = co_await proto_client.async_request(6, 11, bv);
+                    TEST_EXPECT_EQ(ec, std::make_error_code(std::errc::operation_in_progress));
+                } else {
+                    TEST_EXPECT_OK(co_await proto_client.async_send(6, 1, bv));
+                }
+            }
+            TEST_EXPECT(static_cast<bool>(co_await proto_client.async_send(5, 1, {})));
+            TEST_EXPECT_EQ(spool->size(), static_cast<std::uint64_t>(kSpooled));
+
+            // 未 SELECTED 时补发直接失败，消息保留。
+            auto [early_ec, early_n] = co_await proto_client.async_drain_spool();
+            TEST_EXPECT_EQ(early_ec, make_error_code(errc::invalid_argument));
+            TEST_EXPECT_EQ(early_n, 0U);
+
+            asio::co_spawn(
+                ioc, server.async_open_passive(std::move(server_conn)), asio::detached);
+            TEST_EXPECT_OK(co_await client.async_open_active(std::move(client_conn)));
+            TEST_EXPECT_OK(co_await server.async_wait_selected(1, 200ms));
+            asio::co_spawn(ioc, proto_server.async_run(), asio::detached);
+
+            auto [ec, n] = co_await proto_client.async_drain_spool(8);
+            TEST_EXPECT_OK(ec);
+            TEST_EXPECT_EQ(n, static_cast<std::size_t>(kSpooled));
+            TEST_EXPECT(spool->empty());
+
+            // spool 清空且已 SELECTED：直接请求。
+            auto [rec, rsp] = co_await proto_client.async_request(6, 11, {});
+            TEST_EXPECT_OK(rec);
+            TEST_EXPECT_EQ(rsp.function, 12);
+
+            proto_server.stop();
+            proto_client.stop();
+            client.stop();
+            server.stop();
+            done = true;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+
+    // 补发顺序与写入顺序一致，随后是直接发送的一条。
+    TEST_EXPECT_EQ(received.size(), static_cast<std::size_t>(kSpooled + 1));
+    for (std::size_t i = 0; i < received.size() && i < kSpooled; ++i) {
+        TEST_EXPECT_EQ(received[i].first, (i % 2 == 0) ? 11 : 1);
+        TEST_EXPECT_EQ(received[i].second, static_cast<byte>(i));
+    }
+    spool->close();
+    std::filesystem::remove_all(dir);
+}
+
+void test_hsms_protocol_request_pipeline() {
+    asio::io_context ioc;
+    const std::uint16_t session_id = 0x1032;
+
+    const secs::hsms::SessionOptions hsms_opt{
+        .session_id = session_id,
+        .t3 = 200ms,
+        .t5 = 10ms,
+        .t6 = 50ms,
+        .t7 = 50ms,
+        .t8 = 0ms,
+        .linktest_interval = 0ms,
+        .auto_reconnect = false,
+    };
+    secs::hsms::Session server(ioc.get_executor(), hsms_opt);
+    secs::hsms::Session client(ioc.get_executor(), hsms_opt);
+
+    // 挂起表只有 4 个 slot，窗口为 8：超出部分必须等待而不是 buffer_overflow。
+    SessionOptions client_opts{};
+    client_opts.t3 = 500ms;
+    client_opts.max_pending_requests = 4;
+    client_opts.wait_for_pending_slot = true;
+    Session proto_client(client, session_id, client_opts);
+    Session proto_server(server, session_id, SessionOptions{.t3 = 500ms});
+
+    proto_server.router().set(
+        1, 3, [](const DataMessage &msg) -> asio::awaitable<secs::protocol::HandlerResult> {
+            co_return secs::protocol::HandlerResult{std::error_code{}, msg.body};
+        });
+
+    auto duplex = make_memory_duplex(ioc.get_executor());
+    Connection server_conn(std::move(duplex.server_stream));
+    Connection client_conn(std::move(duplex.client_stream));
+
+    constexpr std::size_t kRequests = 300;
+    std::vector<std::vector<byte>> bodies(kRequests);
+    std::vector<secs::protocol::PipelineRequest> requests(kRequests);
+    for (std::size_t i = 0; i < kRequests; ++i) {
+        bodies[i] = {static_cast<byte>(i), static_cast<byte>(i >> 8U)};
+        requests[i] = {1, 3, bytes_view{bodies[i].data(), bodies[i].size()}};
+    }
+    // 非法项只影响自身，不中止流水线。
+    requests[7].stream = 200;
+
+    std::atomic<bool> done{false};
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            asio::co_spawn(
+                ioc, server.async_open_passive(std::move(server_conn)), asio::detached);
+            TEST_EXPECT_OK(co_await client.async_open_active(std::move(client_conn)));
+            TEST_EXPECT_OK(co_await server.async_wait_selected(1, 200ms));
+            asio::co_spawn(ioc, proto_server.async_run(), asio::detached);
+
+            // 回调按提交顺序逐项交付。
+            std::vector<std::size_t> order;
+            std::size_t ok = 0;
+            const auto ec = co_await proto_client.async_request_pipeline(
+                requests,
+                [&](std::size_t index, std::error_code item_ec, DataMessage &rsp) {
+                    order.push_back(index);
+                    if (index == 7) {
+                        TEST_EXPECT_EQ(item_ec, make_error_code(errc::invalid_argument));
+                        return;
+                    }
+                    TEST_EXPECT_OK(item_ec);
+                    TEST_EXPECT_EQ(rsp.function, 4);
+                    TEST_EXPECT(rsp.body == bodies[index]);
+                    ++ok;
+                },
+                8);
+            TEST_EXPECT_EQ(ec, make_error_code(errc::invalid_argument));
+            TEST_EXPECT_EQ(order.size(), kRequests);
+            TEST_EXPECT(std::is_sorted(order.begin(), order.end()));
+            TEST_EXPECT_EQ(ok, kRequests - 1);
+
+            // vector 形式。
+            requests[7].stream = 1;
+            auto results = co_await proto_client.async_request_all(
+                std::span{requests}.first(40), 16);
+            TEST_EXPECT_EQ(results.size(), 40U);
+            for (std::size_t i = 0; i < results.size(); ++i) {
+                TEST_EXPECT_OK(results[i].first);
+                TEST_EXPECT(results[i].second.body == bodies[i]);
+            }
+
+            // wait_for_pending_slot：并发 async_request 超过挂起上限时排队而非失败。
+            std::size_t finished = 0;
+            secs::core::Event all_done{};
+            for (std::size_t i = 0; i < 12; ++i) {
+                asio::co_spawn(
+                    ioc,
+                    [&, i]() -> asio::awaitable<void> {
+                        auto [rec, rsp] = co_await proto_client.async_request(
+                            1, 3, bytes_view{bodies[i].data(), bodies[i].size()});
+                        TEST_EXPECT_OK(rec);
+                        TEST_EXPECT(rsp.body == bodies[i]);
+                        if (++finished == 12) {
+                            all_done.set();
+                        }
+                    },
+                    asio::detached);
+            }
+            TEST_EXPECT_OK(co_await all_done.async_wait(2s));
+
+            proto_server.stop();
+            proto_client.stop();
+            client.stop();
+            server.stop();
+            done = true;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+}
+
+void test_hsms_protocol_shared_body_send_and_request() {
+    asio::io_context ioc;
+    const std::uint16_t session_id = 0x1033;
+
+    const secs::hsms::SessionOptions hsms_opt{
+        .session_id = session_id,
+        .t3 = 200ms,
+        .t5 = 10ms,
+        .t6 = 50ms,
+        .t7 = 50ms,
+        .t8 = 0ms,
+        .linktest_interval = 0ms,
+        .auto_reconnect = false,
+    };
+    secs::hsms::Session server(ioc.get_executor(), hsms_opt);
+    secs::hsms::Session client(ioc.get_executor(), hsms_opt);
+
+    Session proto_client(client, session_id, SessionOptions{.t3 = 500ms});
+    Session proto_server(server, session_id, SessionOptions{.t3 = 500ms});
+
+    std::vector<byte> last_s6f11;
+    proto_server.router().set(
+        6, 11, [&](const DataMessage &msg) -> asio::awaitable<secs::protocol::HandlerResult> {
+            last_s6f11 = msg.body;
+            co_return secs::protocol::HandlerResult{std::error_code{}, {}};
+        });
+    proto_server.router().set(
+        1, 3, [](const DataMessage &msg) -> asio::awaitable<secs::protocol::HandlerResult> {
+            co_return secs::protocol::HandlerResult{std::error_code{}, msg.body};
+        });
+
+    auto duplex = make_memory_duplex(ioc.get_executor());
+    Connection server_conn(std::move(duplex.server_stream));
+    Connection client_conn(std::move(duplex.client_stream));
+
+    const std::vector<byte> body = {0x01, 0x02, 0x03, 0x04, 0x05};
+    const auto shared = secs::core::SharedBytes::copy(
+        bytes_view{body.data(), body.size()}, secs::hsms::kFramePrefixSize);
+
+    std::atomic<bool> done{false};
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            asio::co_spawn(
+                ioc, server.async_open_passive(std::move(server_conn)), asio::detached);
+            TEST_EXPECT_OK(co_await client.async_open_active(std::move(client_conn)));
+            TEST_EXPECT_OK(co_await server.async_wait_selected(1, 200ms));
+            asio::co_spawn(ioc, proto_server.async_run(), asio::detached);
+
+            // 同一个共享消息体连续发送多次（例如广播同一事件报告）。
+            for (int i = 0; i < 3; ++i) {
+                TEST_EXPECT_OK(co_await proto_client.async_send_shared(6, 11, shared));
+            }
+            auto [rec, rsp] = co_await proto_client.async_request_shared(1, 3, shared);
+            TEST_EXPECT_OK(rec);
+            TEST_EXPECT_EQ(rsp.function, 4);
+            TEST_EXPECT_EQ(rsp.body, body);
+            TEST_EXPECT_EQ(last_s6f11, body);
+
+            // 发送完成后 Session/Connection 不再持有引用。
+            TEST_EXPECT_EQ(shared.use_count(), 1);
+
+            // 参数校验与 bytes_view 版本一致。
+            TEST_EXPECT_EQ(co_await proto_client.async_send_shared(6, 12, shared),
+                           make_error_code(errc::invalid_argument));
+
+            proto_server.stop();
+            proto_client.stop();
+            client.stop();
+            server.stop();
+            done = true;
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT(done.load());
+}
+
 int main() {
     test_system_bytes_unique_release_reuse_and_wrap();
     test_system_bytes_exhaustion_small_space();
+    test_system_bytes_window_limits_in_flight();
+    test_system_bytes_concurrent_allocate_release();
     test_router_set_find_erase_clear();
     test_hsms_protocol_pending_filters();
     test_hsms_protocol_stop_cancels_pending();
@@ -1822,6 +2291,10 @@ int main() {
     test_hsms_protocol_echo_1000();
     test_hsms_protocol_both_sides_can_initiate_primary();
     test_hsms_protocol_t3_timeout();
+    test_hsms_gs_protocol_sessions_share_connection();
+    test_hsms_protocol_spool_and_drain();
+    test_hsms_protocol_request_pipeline();
+    test_hsms_protocol_shared_body_send_and_request();
     test_secs1_protocol_echo_100();
     test_secs1_protocol_reverse_bit_respects_options();
     test_secs1_protocol_equipment_can_initiate_primary();
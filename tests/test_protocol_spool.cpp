@@ -0,0 +1,367 @@
+#include "secs/protocol/spool.hpp"
+
+#include "secs/core/error.hpp"
+
+#include "test_main.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+using secs::core::byte;
+using secs::core::bytes_view;
+using secs::core::errc;
+using secs::core::make_error_code;
+
+using secs::protocol::Spool;
+using secs::protocol::SpoolMessage;
+using secs::protocol::SpoolOptions;
+
+namespace fs = std::filesystem;
+
+std::string fresh_dir(const char *name) {
+    const auto dir = (fs::temp_directory_path() / name).string();
+    fs::remove_all(dir);
+    return dir;
+}
+
+std::vector<byte> body_of(std::uint8_t tag, std::size_t n) {
+    return std::vector<byte>(n, static_cast<byte>(tag));
+}
+
+std::size_t count_segments(const std::string &dir) {
+    std::size_t n = 0;
+    for (const auto &entry : fs::directory_iterator(dir)) {
+        if (entry.path().extension() == ".seg") {
+            ++n;
+        }
+    }
+    return n;
+}
+
+fs::path last_segment(const std::string &dir) {
+    fs::path last;
+    for (const auto &entry : fs::directory_iterator(dir)) {
+        if (entry.path().extension() == ".seg" &&
+            (last.empty() || entry.path().filename() > last.filename())) {
+            last = entry.path();
+        }
+    }
+    return last;
+}
+
+void test_spool_filter_rules() {
+    Spool spool(SpoolOptions{.directory = fresh_dir("secs_test_spool_filter")});
+    TEST_EXPECT_EQ(spool.enable_stream(1), make_error_code(errc::invalid_argument));
+    TEST_EXPECT_EQ(spool.enable_stream(128), make_error_code(errc::invalid_argument));
+    TEST_EXPECT_EQ(spool.enable(5, 2), make_error_code(errc::invalid_argument));
+
+    TEST_EXPECT_OK(spool.enable_stream(6));
+    TEST_EXPECT_OK(spool.enable(5, 1));
+    TEST_EXPECT(spool.accepts(6, 11));
+    TEST_EXPECT(!spool.accepts(6, 12));
+    TEST_EXPECT(spool.accepts(5, 1));
+    TEST_EXPECT(!spool.accepts(5, 3));
+    TEST_EXPECT(!spool.accepts(1, 1));
+
+    spool.disable_stream(6);
+    TEST_EXPECT(!spool.accepts(6, 11));
+    spool.clear_filter();
+    TEST_EXPECT(!spool.accepts(5, 1));
+
+    // 未 open：push 失败；非法选项：open 失败。
+    const std::vector<byte> body = {1};
+    TEST_EXPECT_EQ(spool.push(6, 11, true, bytes_view{body.data(), body.size()}),
+                   make_error_code(errc::invalid_argument));
+    Spool bad(SpoolOptions{.directory = fresh_dir("secs_test_spool_bad"),
+                           .segment_bytes = 1024,
+                           .max_bytes = 1500});
+    TEST_EXPECT_EQ(bad.open(), make_error_code(errc::invalid_argument));
+}
+
+void test_spool_read_consume_and_reopen() {
+    const auto dir = fresh_dir("secs_test_spool_reopen");
+    {
+        Spool spool(SpoolOptions{.directory = dir});
+        TEST_EXPECT_OK(spool.open());
+        for (std::uint8_t i = 0; i < 5; ++i) {
+            const auto body = body_of(i, 10 + i);
+            TEST_EXPECT_OK(spool.push(6, 11, i % 2 == 0, bytes_view{body.data(), body.size()}));
+        }
+        TEST_EXPECT_EQ(spool.size(), 5U);
+
+        SpoolMessage m;
+        TEST_EXPECT(spool.next(m));
+        TEST_EXPECT_EQ(m.sequence, 1U);
+        TEST_EXPECT_EQ(m.stream, 6);
+        TEST_EXPECT_EQ(m.function, 11);
+        TEST_EXPECT(m.w_bit);
+        TEST_EXPECT_EQ(m.body, body_of(0, 10));
+        TEST_EXPECT(spool.next(m));
+        TEST_EXPECT_EQ(m.sequence, 2U);
+        TEST_EXPECT(!m.w_bit);
+
+        // 只确认第一条；第二条已读出但未确认，重开后应再次交付。
+        TEST_EXPECT_OK(spool.consume_through(1));
+        TEST_EXPECT_EQ(spool.size(), 4U);
+
+        // rewind 回到队首。
+        spool.rewind();
+        TEST_EXPECT(spool.next(m));
+        TEST_EXPECT_EQ(m.sequence, 2U);
+    }
+    {
+        Spool spool(SpoolOptions{.directory = dir});
+        TEST_EXPECT_OK(spool.open());
+        TEST_EXPECT_EQ(spool.size(), 4U);
+
+        SpoolMessage m;
+        std::uint64_t expect = 2;
+        while (spool.next(m)) {
+            TEST_EXPECT_EQ(m.sequence, expect);
+            TEST_EXPECT_EQ(m.body, body_of(static_cast<std::uint8_t>(expect - 1),
+                                           9 + static_cast<std::size_t>(expect)));
+            ++expect;
+        }
+        TEST_EXPECT_OK(spool.last_error());
+        TEST_EXPECT_EQ(expect, 6U);
+
+        // 序号跨重启单调递增。
+        const auto body = body_of(9, 3);
+        TEST_EXPECT_OK(spool.push(6, 5, false, bytes_view{body.data(), body.size()}));
+        TEST_EXPECT(spool.next(m));
+        TEST_EXPECT_EQ(m.sequence, 6U);
+
+        TEST_EXPECT_OK(spool.consume_through(6));
+        TEST_EXPECT(spool.empty());
+    }
+    fs::remove_all(dir);
+}
+
+void test_spool_recovers_torn_tail() {
+    const auto dir = fresh_dir("secs_test_spool_torn");
+    std::uintmax_t good_size = 0;
+    {
+        Spool spool(SpoolOptions{.directory = dir});
+        TEST_EXPECT_OK(spool.open());
+        for (std::uint8_t i = 0; i < 3; ++i) {
+            const auto body = body_of(i, 32);
+            TEST_EXPECT_OK(spool.push(6, 11, true, bytes_view{body.data(), body.size()}));
+        }
+        good_size = fs::file_size(last_segment(dir));
+    }
+
+    // 模拟写到一半崩溃：追加半条记录。
+    {
+        std::FILE *f = std::fopen(last_segment(dir).string().c_str(), "ab");
+        TEST_EXPECT(f != nullptr);
+        if (f != nullptr) {
+            const std::uint8_t partial[10] = {0, 0, 0, 50, 1, 2, 3, 4, 5, 6};
+            (void)std::fwrite(partial, 1, sizeof(partial), f);
+            (void)std::fclose(f);
+        }
+    }
+    // 再破坏最后一条完整记录的 body：校验失败，从该条起截断。
+    {
+        std::FILE *f = std::fopen(last_segment(dir).string().c_str(), "r+b");
+        TEST_EXPECT(f != nullptr);
+        if (f != nullptr) {
+            (void)std::fseek(f, static_cast<long>(good_size - 1), SEEK_SET);
+            const std::uint8_t junk = 0xEE;
+            (void)std::fwrite(&junk, 1, 1, f);
+            (void)std::fclose(f);
+        }
+    }
+
+    {
+        Spool spool(SpoolOptions{.directory = dir});
+        TEST_EXPECT_OK(spool.open());
+        TEST_EXPECT_EQ(spool.size(), 2U);
+        TEST_EXPECT_EQ(fs::file_size(last_segment(dir)),
+                       good_size - (secs::protocol::kSpoolRecordHeaderSize + 32));
+
+        // 截断后继续追加，序号接着最后一条有效记录。
+        const auto body = body_of(7, 4);
+        TEST_EXPECT_OK(spool.push(6, 11, true, bytes_view{body.data(), body.size()}));
+        SpoolMessage m;
+        std::vector<std::uint64_t> seqs;
+        while (spool.next(m)) {
+            seqs.push_back(m.sequence);
+        }
+        TEST_EXPECT_EQ(seqs, (std::vector<std::uint64_t>{1, 2, 3}));
+    }
+    fs::remove_all(dir);
+}
+
+void test_spool_segments_rotate_and_are_removed() {
+    const auto dir = fresh_dir("secs_test_spool_rotate");
+    Spool spool(SpoolOptions{.directory = dir, .segment_bytes = 256, .max_bytes = 1 << 20});
+    TEST_EXPECT_OK(spool.open());
+
+    for (std::uint8_t i = 0; i < 20; ++i) {
+        const auto body = body_of(i, 100);
+        TEST_EXPECT_OK(spool.push(6, 11, false, bytes_view{body.data(), body.size()}));
+    }
+    TEST_EXPECT(count_segments(dir) >= 10U);
+
+    SpoolMessage m;
+    std::uint64_t last = 0;
+    std::size_t n = 0;
+    while (spool.next(m)) {
+        TEST_EXPECT_EQ(m.body.front(), static_cast<byte>(n));
+        last = m.sequence;
+        ++n;
+    }
+    TEST_EXPECT_EQ(n, 20U);
+    TEST_EXPECT_OK(spool.consume_through(last));
+    TEST_EXPECT(spool.empty());
+    // 已确认的段被删除，只保留当前写入段。
+    TEST_EXPECT_EQ(count_segments(dir), 1U);
+    TEST_EXPECT_EQ(spool.disk_bytes(), fs::file_size(last_segment(dir)));
+
+    spool.close();
+    fs::remove_all(dir);
+}
+
+void test_spool_bounded_reject_and_overwrite() {
+    const std::vector<byte> body = body_of(1, 200);
+    const bytes_view bv{body.data(), body.size()};
+    {
+        const auto dir = fresh_dir("secs_test_spool_reject");
+        Spool spool(SpoolOptions{.directory = dir, .segment_bytes = 512, .max_bytes = 1024});
+        TEST_EXPECT_OK(spool.open());
+        std::size_t accepted = 0;
+        for (int i = 0; i < 10; ++i) {
+            if (!spool.push(6, 11, false, bv)) {
+                ++accepted;
+            }
+        }
+        TEST_EXPECT_EQ(accepted, 4U);
+        TEST_EXPECT_EQ(spool.rejected(), 6U);
+        TEST_EXPECT(spool.disk_bytes() <= 1024U);
+        TEST_EXPECT_EQ(spool.push(6, 11, false, bv), make_error_code(errc::buffer_overflow));
+        spool.close();
+        fs::remove_all(dir);
+    }
+    {
+        const auto dir = fresh_dir("secs_test_spool_overwrite");
+        Spool spool(SpoolOptions{.directory = dir,
+                                 .segment_bytes = 512,
+                                 .max_bytes = 1024,
+                                 .overwrite_when_full = true});
+        TEST_EXPECT_OK(spool.open());
+        for (int i = 0; i < 10; ++i) {
+            TEST_EXPECT_OK(spool.push(6, 11, false, bv));
+        }
+        TEST_EXPECT(spool.disk_bytes() <= 1024U);
+        TEST_EXPECT(spool.dropped() > 0U);
+        TEST_EXPECT_EQ(spool.size() + spool.dropped(), 10U);
+
+        // 剩下的是最新的消息，且按顺序。
+        SpoolMessage m;
+        std::uint64_t expect = 10 - spool.size() + 1;
+        while (spool.next(m)) {
+            TEST_EXPECT_EQ(m.sequence, expect);
+            ++expect;
+        }
+        TEST_EXPECT_EQ(expect, 11U);
+        spool.close();
+        fs::remove_all(dir);
+    }
+}
+
+void test_spool_index_falls_back_to_previous_slot() {
+    const auto dir = fresh_dir("secs_test_spool_index");
+    {
+        Spool spool(SpoolOptions{.directory = dir});
+        TEST_EXPECT_OK(spool.open());
+        for (std::uint8_t i = 0; i < 4; ++i) {
+            const auto body = body_of(i, 8);
+            TEST_EXPECT_OK(spool.push(6, 11, false, bytes_view{body.data(), body.size()}));
+        }
+        SpoolMessage m;
+        TEST_EXPECT(spool.next(m));
+        TEST_EXPECT_OK(spool.consume_through(m.sequence));
+        TEST_EXPECT(spool.next(m));
+        TEST_EXPECT_OK(spool.consume_through(m.sequence));
+        TEST_EXPECT_EQ(spool.size(), 2U);
+    }
+
+    // 找到 generation 较大的槽并破坏其 CRC（模拟写槽时崩溃）。
+    const auto index_path = (fs::path(dir) / "spool.idx").string();
+    {
+        std::FILE *f = std::fopen(index_path.c_str(), "r+b");
+        TEST_EXPECT(f != nullptr);
+        if (f != nullptr) {
+            std::uint8_t raw[secs::protocol::kSpoolIndexFileSize] = {};
+            TEST_EXPECT_EQ(std::fread(raw, 1, sizeof(raw), f), sizeof(raw));
+            const auto gen = [&](std::size_t slot) {
+                std::uint64_t v = 0;
+                for (std::size_t i = 0; i < 8; ++i) {
+                    v = (v << 8U) | raw[16 + slot * 40 + i];
+                }
+                return v;
+            };
+            const std::size_t newest = gen(0) > gen(1) ? 0 : 1;
+            (void)std::fseek(f, static_cast<long>(16 + newest * 40 + 32), SEEK_SET);
+            const std::uint8_t junk[4] = {0xDE, 0xAD, 0xBE, 0xEF};
+            (void)std::fwrite(junk, 1, sizeof(junk), f);
+            (void)std::fclose(f);
+        }
+    }
+
+    {
+        Spool spool(SpoolOptions{.directory = dir});
+        TEST_EXPECT_OK(spool.open());
+        // 退回到上一个有效槽：已确认的第二条会再交付一次（至少一次语义）。
+        TEST_EXPECT_EQ(spool.size(), 3U);
+        SpoolMessage m;
+        TEST_EXPECT(spool.next(m));
+        TEST_EXPECT_EQ(m.sequence, 2U);
+    }
+    fs::remove_all(dir);
+}
+
+void test_spool_purge() {
+    const auto dir = fresh_dir("secs_test_spool_purge");
+    Spool spool(SpoolOptions{.directory = dir, .segment_bytes = 256, .max_bytes = 1 << 20});
+    TEST_EXPECT_OK(spool.open());
+    for (std::uint8_t i = 0; i < 10; ++i) {
+        const auto body = body_of(i, 100);
+        TEST_EXPECT_OK(spool.push(6, 11, false, bytes_view{body.data(), body.size()}));
+    }
+    TEST_EXPECT_OK(spool.purge());
+    TEST_EXPECT(spool.empty());
+    TEST_EXPECT_EQ(count_segments(dir), 1U);
+    SpoolMessage m;
+    TEST_EXPECT(!spool.next(m));
+
+    const auto body = body_of(42, 1);
+    TEST_EXPECT_OK(spool.push(6, 11, false, bytes_view{body.data(), body.size()}));
+    TEST_EXPECT(spool.next(m));
+    TEST_EXPECT_EQ(m.sequence, 11U);
+    spool.close();
+
+    Spool reopened(SpoolOptions{.directory = dir});
+    TEST_EXPECT_OK(reopened.open());
+    TEST_EXPECT_EQ(reopened.size(), 1U);
+    reopened.close();
+    fs::remove_all(dir);
+}
+
+} // namespace
+
+int main() {
+    test_spool_filter_rules();
+    test_spool_read_consume_and_reopen();
+    test_spool_recovers_torn_tail();
+    test_spool_segments_rotate_and_are_removed();
+    test_spool_bounded_reject_and_overwrite();
+    test_spool_index_falls_back_to_previous_slot();
+    test_spool_purge();
+    return ::secs::tests::run_and_report();
+}
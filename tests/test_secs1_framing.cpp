@@ -19,6 +19,7 @@
 #include <chrono>
 #include <cstdint>
 #include <deque>
+#include <optional>
 #include <string_view>
 #include <vector>
 
@@ -438,6 +439,43 @@ void test_reassembler_happy_path() {
         std::equal(out.begin(), out.end(), payload.begin(), payload.end()));
 }
 
+void test_reassembler_memory_budget() {
+    auto h = sample_header();
+    auto payload = make_payload(secs::secs1::kMaxBlockDataSize + 100);
+    auto frames = secs::secs1::fragment_message(
+        h, bytes_view{payload.data(), payload.size()});
+    TEST_EXPECT_EQ(frames.size(), 2U);
+
+    auto budget = std::make_shared<secs::core::MemoryBudget>(
+        secs::core::MemoryBudgetOptions{.limit_bytes = 400});
+    TEST_EXPECT(budget->try_acquire(100)); // 其它消息占用
+    Reassembler re(h.device_id);
+    re.set_memory_budget(budget);
+
+    std::vector<DecodedBlock> blocks(frames.size());
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        TEST_EXPECT_OK(secs::secs1::decode_block(
+            bytes_view{frames[i].data(), frames[i].size()}, blocks[i]));
+    }
+    TEST_EXPECT_OK(re.accept(blocks[0]));
+
+    // 预算不足：拒绝该块且不推进重组状态，释放后重发同一块即可继续。
+    TEST_EXPECT_EQ(re.accept(blocks[1]),
+                   secs::core::make_error_code(secs::core::errc::out_of_memory));
+    TEST_EXPECT(!re.has_message());
+    budget->release(100);
+    TEST_EXPECT_OK(re.accept(blocks[1]));
+    TEST_EXPECT(re.has_message());
+
+    {
+        auto reservation = re.take_reservation();
+        TEST_EXPECT_EQ(reservation.bytes(), payload.size());
+        TEST_EXPECT(re.take_body() == payload);
+        TEST_EXPECT_EQ(budget->used(), payload.size());
+    }
+    TEST_EXPECT_EQ(budget->used(), 0U);
+}
+
 void test_reassembler_device_id_mismatch() {
     auto h = sample_header();
     h.device_id = 0x0002;
@@ -969,6 +1007,151 @@ void test_state_machine_send_receive_single_block() {
     TEST_EXPECT_EQ(done.load(), 2);
 }
 
+void test_state_machine_send_streamed_body_multi_block() {
+    asio::io_context ioc;
+    auto [a, b] = MemoryLink::create(ioc.get_executor());
+
+    Timeouts timeouts{};
+    timeouts.t1_intercharacter = 20ms;
+    timeouts.t2_protocol = 50ms;
+    timeouts.t3_reply = 100ms;
+    timeouts.t4_interblock = 50ms;
+
+    StateMachine sender(a, 0x1234, timeouts);
+    StateMachine receiver(b, 0x1234, timeouts);
+
+    auto h = sample_header();
+    const auto payload = make_payload(600); // 3 块：244 + 244 + 112
+
+    // 生成器每次只给 100 字节：发送方需要跨多次读取拼满一个块。
+    std::size_t offset = 0;
+    auto source = secs::core::make_generator_body(
+        payload.size(),
+        [&](secs::core::mutable_bytes_view dst)
+            -> asio::awaitable<std::pair<std::error_code, std::size_t>> {
+            const auto n = std::min<std::size_t>({dst.size(), 100, payload.size() - offset});
+            std::copy_n(payload.begin() + static_cast<long>(offset), n, dst.begin());
+            offset += n;
+            co_return std::pair{std::error_code{}, n};
+        });
+
+    std::atomic<int> done{0};
+    asio::steady_timer watchdog(ioc);
+    watchdog.expires_after(1s);
+    watchdog.async_wait([&](const std::error_code &) {
+        TEST_FAIL("watchdog fired");
+        ioc.stop();
+    });
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto ec = co_await sender.async_send(h, *source);
+            TEST_EXPECT_OK(ec);
+            TEST_EXPECT(sender.state() == secs::secs1::State::idle);
+            if (++done == 2) {
+                watchdog.cancel();
+                ioc.stop();
+            }
+        },
+        asio::detached);
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto [ec, msg] = co_await receiver.async_receive(200ms);
+            TEST_EXPECT_OK(ec);
+            TEST_EXPECT(msg.body == payload);
+            if (++done == 2) {
+                watchdog.cancel();
+                ioc.stop();
+            }
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT_EQ(done.load(), 2);
+}
+
+void test_state_machine_receive_into_body_sink() {
+    asio::io_context ioc;
+    auto [a, b] = MemoryLink::create(ioc.get_executor());
+
+    Timeouts timeouts{};
+    timeouts.t1_intercharacter = 20ms;
+    timeouts.t2_protocol = 50ms;
+    timeouts.t3_reply = 100ms;
+    timeouts.t4_interblock = 50ms;
+
+    StateMachine sender(a, 0x1234, timeouts);
+    StateMachine receiver(b, 0x1234, timeouts);
+
+    auto h = sample_header();
+    const auto payload = make_payload(600); // 3 块：244 + 244 + 112
+
+    // 注册该 (stream, function) 的 sink：每块数据在 ACK 前交给回调，不在内存中累积。
+    std::vector<byte> sunk;
+    std::vector<std::size_t> chunk_sizes;
+    std::optional<std::size_t> announced_size{0};
+    receiver.set_body_sinks({{
+        .stream = h.stream,
+        .function = h.function,
+        .factory =
+            [&](const secs::core::BodySinkInfo &info) {
+                announced_size = info.size;
+                return secs::core::make_callback_sink(
+                    [&](secs::core::bytes_view chunk) -> asio::awaitable<std::error_code> {
+                        sunk.insert(sunk.end(), chunk.begin(), chunk.end());
+                        chunk_sizes.push_back(chunk.size());
+                        co_return std::error_code{};
+                    });
+            },
+    }});
+
+    std::atomic<int> done{0};
+    asio::steady_timer watchdog(ioc);
+    watchdog.expires_after(1s);
+    watchdog.async_wait([&](const std::error_code &) {
+        TEST_FAIL("watchdog fired");
+        ioc.stop();
+    });
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto ec = co_await sender.async_send(h, bytes_view{payload.data(), payload.size()});
+            TEST_EXPECT_OK(ec);
+            if (++done == 2) {
+                watchdog.cancel();
+                ioc.stop();
+            }
+        },
+        asio::detached);
+
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto [ec, msg] = co_await receiver.async_receive(200ms);
+            TEST_EXPECT_OK(ec);
+            TEST_EXPECT(msg.body.empty());
+            TEST_EXPECT(msg.body_sink != nullptr);
+            if (msg.body_sink) {
+                TEST_EXPECT_EQ(msg.body_sink->size(), payload.size());
+            }
+            if (++done == 2) {
+                watchdog.cancel();
+                ioc.stop();
+            }
+        },
+        asio::detached);
+
+    ioc.run();
+    TEST_EXPECT_EQ(done.load(), 2);
+    TEST_EXPECT(!announced_size.has_value());
+    TEST_EXPECT(sunk == payload);
+    TEST_EXPECT_EQ(chunk_sizes.size(), 3U);
+}
+
 void test_state_machine_send_unexpected_handshake_byte_protocol_error_scripted() {
     asio::io_context ioc;
     ScriptedLink link(ioc.get_executor());
@@ -2553,6 +2736,7 @@ int main() {
     test_fragment_message_splits_and_decodes();
     test_fragment_message_empty_payload();
     test_reassembler_happy_path();
+    test_reassembler_memory_budget();
     test_reassembler_device_id_mismatch();
     test_reassembler_sequence_error();
     test_reassembler_mismatch_after_first_block();
@@ -2565,6 +2749,8 @@ int main() {
     test_memory_link_read_two_bytes_paths();
     test_timer_cancelled();
     test_state_machine_send_receive_single_block();
+    test_state_machine_send_streamed_body_multi_block();
+    test_state_machine_receive_into_body_sink();
     test_state_machine_send_unexpected_handshake_byte_protocol_error_scripted();
     test_state_machine_send_propagates_handshake_read_error_scripted();
     test_state_machine_send_propagates_handshake_write_error_scripted();
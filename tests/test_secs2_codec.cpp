@@ -1,10 +1,13 @@
 #include "secs/ii/codec.hpp"
 
+#include "secs/core/memory_budget.hpp"
+
 #include "test_main.hpp"
 
 #include <bit>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -20,6 +23,7 @@ using secs::ii::encoded_size;
 using secs::ii::errc;
 using secs::ii::Item;
 using secs::ii::make_error_code;
+using secs::ii::visit_encoded;
 
 Item placeholder_item() { return Item::binary(std::vector<byte>{}); }
 
@@ -474,6 +478,71 @@ void test_decode_total_byte_budget_exceeded_before_payload_read() {
     TEST_EXPECT_EQ(consumed, 0u);
 }
 
+void test_decode_one_charges_memory_budget() {
+    const auto item = Item::list(
+        {Item::binary(std::vector<byte>(100, byte{0x11})), Item::ascii("HELLO")});
+    const auto in = encode_ok(item);
+    // 3 个节点各 sizeof(Item)，加上叶子 payload 100 + 5 字节。
+    const std::size_t need = 3 * sizeof(Item) + 105;
+
+    auto budget = std::make_shared<secs::core::MemoryBudget>(
+        secs::core::MemoryBudgetOptions{.limit_bytes = need - 1});
+    secs::core::MemoryReservation reservation(budget);
+    Item out = placeholder_item();
+    std::size_t consumed = 0;
+    auto ec = decode_one(bytes_view{in.data(), in.size()},
+                         out,
+                         consumed,
+                         secs::ii::DecodeLimits{},
+                         reservation);
+    TEST_EXPECT_EQ(ec, make_error_code(errc::out_of_memory));
+    TEST_EXPECT_EQ(consumed, 0u);
+    TEST_EXPECT_EQ(reservation.bytes(), 0u);
+    TEST_EXPECT_EQ(budget->used(), 0u);
+
+    auto roomy = std::make_shared<secs::core::MemoryBudget>(
+        secs::core::MemoryBudgetOptions{.limit_bytes = need});
+    secs::core::MemoryReservation ok_reservation(roomy);
+    ec = decode_one(bytes_view{in.data(), in.size()},
+                    out,
+                    consumed,
+                    secs::ii::DecodeLimits{},
+                    ok_reservation);
+    TEST_EXPECT_OK(ec);
+    TEST_EXPECT(out == item);
+    TEST_EXPECT_EQ(consumed, in.size());
+    TEST_EXPECT_EQ(roomy->used(), need);
+    ok_reservation.reset();
+    TEST_EXPECT_EQ(roomy->used(), 0u);
+
+    // 通过 DecodeLimits 接入：不带 lease 的重载只在解码期间占用（准入）。
+    secs::ii::DecodeLimits limits{};
+    limits.memory_budget = budget;
+    ec = decode_one(bytes_view{in.data(), in.size()}, out, consumed, limits);
+    TEST_EXPECT_EQ(ec, make_error_code(errc::out_of_memory));
+    limits.memory_budget = roomy;
+    ec = decode_one(bytes_view{in.data(), in.size()}, out, consumed, limits);
+    TEST_EXPECT_OK(ec);
+    TEST_EXPECT_EQ(roomy->used(), 0u);
+
+    // 带 lease 的重载：预约随 lease 与解码结果一起持有。
+    secs::core::MemoryLease lease;
+    ec = decode_one(bytes_view{in.data(), in.size()}, out, consumed, limits, lease);
+    TEST_EXPECT_OK(ec);
+    TEST_EXPECT(out == item);
+    TEST_EXPECT(lease != nullptr);
+    TEST_EXPECT_EQ(roomy->used(), need);
+    // 预算被占满时，下一次解码拒绝且不影响已持有的 lease。
+    secs::core::MemoryLease second;
+    Item out2 = placeholder_item();
+    ec = decode_one(bytes_view{in.data(), in.size()}, out2, consumed, limits, second);
+    TEST_EXPECT_EQ(ec, make_error_code(errc::out_of_memory));
+    TEST_EXPECT(second == nullptr);
+    TEST_EXPECT_EQ(roomy->used(), need);
+    lease.reset();
+    TEST_EXPECT_EQ(roomy->used(), 0u);
+}
+
 void test_decode_large_ascii_length_truncated() {
     // 恶意输入：ASCII 声明 length=1MB，但负载只有 100 字节，必须返回
     // truncated。
@@ -683,6 +752,176 @@ void test_decode_one_deterministic_fuzz_does_not_crash() {
     }
 }
 
+// 把回调序列记录成紧凑文本，便于整体断言遍历顺序与内容。
+class TraceVisitor final : public secs::ii::EncodedVisitor {
+public:
+    std::string trace;
+
+    void on_list_begin(std::uint32_t count) override {
+        trace += "L" + std::to_string(count) + "[";
+    }
+    void on_list_end() override { trace += "]"; }
+    void on_ascii(std::string_view value) override {
+        trace += "A'" + std::string(value) + "'";
+    }
+    void on_binary(bytes_view value) override {
+        trace += "B" + std::to_string(value.size());
+    }
+    void on_boolean(bytes_view values) override {
+        trace += "BOOL";
+        for (byte b : values) {
+            trace += (b != 0) ? "1" : "0";
+        }
+    }
+    void on_i2(secs::ii::BigEndianView<std::int16_t> values) override {
+        trace += "I2";
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            trace += " " + std::to_string(values[i]);
+        }
+    }
+    void on_u4(secs::ii::BigEndianView<std::uint32_t> values) override {
+        trace += "U4";
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            trace += " " + std::to_string(values[i]);
+        }
+        u4_raw_bytes += values.raw().size();
+    }
+    void on_f8(secs::ii::BigEndianView<double> values) override {
+        trace += "F8";
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            f8_values.push_back(values[i]);
+        }
+    }
+
+    std::size_t u4_raw_bytes{0};
+    std::vector<double> f8_values;
+};
+
+void test_visit_encoded_walks_tree_in_order() {
+    const auto item = Item::list({
+        Item::ascii("SV"),
+        Item::list({
+            Item::u4(std::vector<std::uint32_t>{1u, 0xFFFFFFFFu}),
+            Item::i2(std::vector<std::int16_t>{-2, 300}),
+        }),
+        Item::boolean(std::vector<bool>{true, false}),
+        Item::binary(std::vector<byte>{byte{0x01}, byte{0x02}, byte{0x03}}),
+        Item::f8(std::vector<double>{1.5, -0.0}),
+        Item::list({}),
+        // 未覆写的回调（I1）走默认空实现
+        Item::i1(std::vector<std::int8_t>{-1}),
+    });
+    const auto encoded = encode_ok(item);
+
+    TraceVisitor v;
+    std::size_t consumed = 0;
+    TEST_EXPECT_OK(
+        visit_encoded(bytes_view{encoded.data(), encoded.size()}, v, consumed));
+    TEST_EXPECT_EQ(consumed, encoded.size());
+    TEST_EXPECT_EQ(v.trace,
+                   std::string("L7[A'SV'L2[U4 1 4294967295I2 -2 300]BOOL10B3F8"
+                               "L0[]]"));
+    TEST_EXPECT_EQ(v.u4_raw_bytes, 8u);
+    TEST_EXPECT_EQ(v.f8_values.size(), 2u);
+    if (v.f8_values.size() == 2u) {
+        TEST_EXPECT_EQ(v.f8_values[0], 1.5);
+        TEST_EXPECT_EQ(std::bit_cast<std::uint64_t>(v.f8_values[1]),
+                       std::bit_cast<std::uint64_t>(-0.0));
+    }
+}
+
+void test_visit_encoded_stream_consumed() {
+    // 与 decode_one 一致：只消费一个顶层 Item，尾随数据保留给调用方。
+    std::vector<byte> stream = encode_ok(Item::u4({7u}));
+    const auto first_size = stream.size();
+    const auto tail = encode_ok(Item::ascii("X"));
+    stream.insert(stream.end(), tail.begin(), tail.end());
+
+    TraceVisitor v;
+    std::size_t consumed = 0;
+    TEST_EXPECT_OK(
+        visit_encoded(bytes_view{stream.data(), stream.size()}, v, consumed));
+    TEST_EXPECT_EQ(consumed, first_size);
+    TEST_EXPECT_EQ(v.trace, std::string("U4 7"));
+}
+
+void test_visit_encoded_errors_match_decode_one() {
+    const auto check_same = [](const std::vector<byte> &in,
+                               const secs::ii::DecodeLimits &limits) {
+        Item out = placeholder_item();
+        std::size_t decode_consumed = 123;
+        const auto decode_ec = decode_one(
+            bytes_view{in.data(), in.size()}, out, decode_consumed, limits);
+
+        TraceVisitor v;
+        std::size_t visit_consumed = 123;
+        const auto visit_ec = visit_encoded(
+            bytes_view{in.data(), in.size()}, v, visit_consumed, limits);
+        TEST_EXPECT_EQ(visit_ec, decode_ec);
+        if (visit_ec) {
+            TEST_EXPECT_EQ(visit_consumed, 0u);
+        }
+    };
+
+    const secs::ii::DecodeLimits defaults{};
+    // 截断
+    check_same(std::vector<byte>{}, defaults);
+    // length bytes = 0
+    check_same(std::vector<byte>{byte{0xB0}}, defaults);
+    // 非法格式码
+    check_same(std::vector<byte>{byte{0xFD}, byte{0x00}}, defaults);
+    // U4 payload 不是 4 的倍数
+    check_same(std::vector<byte>{byte{0xB1}, byte{0x03}, byte{0x00}, byte{0x00},
+                                 byte{0x00}},
+               defaults);
+    // List 子元素截断
+    check_same(std::vector<byte>{byte{0x01}, byte{0x02}, byte{0x41}, byte{0x00}},
+               defaults);
+
+    // 嵌套深度超过 max_depth
+    secs::ii::DecodeLimits shallow{};
+    shallow.max_depth = 1;
+    check_same(encode_ok(Item::list({Item::list({Item::list({})})})), shallow);
+
+    // payload 超过 max_payload_bytes
+    secs::ii::DecodeLimits small_payload{};
+    small_payload.max_payload_bytes = 2;
+    check_same(encode_ok(Item::ascii("ABC")), small_payload);
+}
+
+void test_visit_encoded_deterministic_fuzz_matches_decode_one() {
+    secs::ii::DecodeLimits limits{};
+    limits.max_total_items = 128;
+    limits.max_total_bytes = 1024;
+
+    std::uint32_t x = 0x9E3779B9u;
+    const auto next_u32 = [&]() noexcept -> std::uint32_t {
+        x = x * 1664525u + 1013904223u;
+        return x;
+    };
+
+    for (std::size_t i = 0; i < 2000u; ++i) {
+        const std::size_t n = static_cast<std::size_t>(next_u32() % 128u);
+        std::vector<byte> buf(n);
+        for (std::size_t j = 0; j < n; ++j) {
+            buf[j] = static_cast<byte>(next_u32() & 0xFFu);
+        }
+
+        Item out = placeholder_item();
+        std::size_t decode_consumed = 0;
+        const auto decode_ec = decode_one(
+            bytes_view{buf.data(), buf.size()}, out, decode_consumed, limits);
+
+        TraceVisitor v;
+        std::size_t visit_consumed = 0;
+        const auto visit_ec = visit_encoded(
+            bytes_view{buf.data(), buf.size()}, v, visit_consumed, limits);
+
+        TEST_EXPECT_EQ(visit_ec, decode_ec);
+        TEST_EXPECT_EQ(visit_consumed, decode_consumed);
+    }
+}
+
 } // namespace
 
 int main() {
@@ -703,9 +942,14 @@ int main() {
     test_decode_list_too_large_rejected();
     test_decode_total_item_budget_exceeded_rejected();
     test_decode_total_byte_budget_exceeded_before_payload_read();
+    test_decode_one_charges_memory_budget();
     test_encode_to_buffer_overflow();
     test_encode_to_buffer_overflow_paths();
     test_length_overflow_limits();
     test_decode_one_deterministic_fuzz_does_not_crash();
+    test_visit_encoded_walks_tree_in_order();
+    test_visit_encoded_stream_consumed();
+    test_visit_encoded_errors_match_decode_one();
+    test_visit_encoded_deterministic_fuzz_matches_decode_one();
     return ::secs::tests::run_and_report();
 }
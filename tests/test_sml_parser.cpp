@@ -12,6 +12,7 @@
 
 #include "test_main.hpp"
 
+#include <limits>
 #include <string_view>
 
 namespace {
@@ -761,6 +762,134 @@ void test_lexer_string_escapes() {
     TEST_EXPECT_EQ(s[7], 'q');
 }
 
+void test_lexer_tokens_are_views_into_source() {
+    const std::string source = R"(m: S1F1 <A "plain"> <A "esc\"x"> <U4 42>.)";
+    Lexer lexer(source);
+    auto result = lexer.tokenize();
+    TEST_EXPECT_OK(result.ec);
+
+    const auto in_source = [&](std::string_view v) {
+        return v.data() >= source.data() &&
+               v.data() + v.size() <= source.data() + source.size();
+    };
+
+    std::size_t strings = 0;
+    for (const auto &tok : result.tokens) {
+        if (tok.is(TokenType::String)) {
+            ++strings;
+            if (tok.value == "plain") {
+                TEST_EXPECT(in_source(tok.value));
+            } else {
+                // 含转义：解码到 owned_strings，move 后视图仍然有效。
+                TEST_EXPECT_EQ(tok.value, std::string_view("esc\"x"));
+                TEST_EXPECT(!in_source(tok.value));
+            }
+        } else if (tok.is(TokenType::Identifier) || tok.is(TokenType::Integer)) {
+            TEST_EXPECT(in_source(tok.value));
+        }
+    }
+    TEST_EXPECT_EQ(strings, 2u);
+    TEST_EXPECT_EQ(result.owned_strings.size(), 1u);
+
+    auto moved = std::move(result);
+    TEST_EXPECT_EQ(moved.tokens[9].value, std::string_view("esc\"x"));
+}
+
+void test_lexer_next_token_streams_and_sticks_on_error() {
+    Lexer lexer("S1F1 W @ <L>");
+    TEST_EXPECT(lexer.next_token().is(TokenType::Identifier));
+    TEST_EXPECT(lexer.next_token().is(TokenType::KwW));
+
+    const auto err = lexer.next_token();
+    TEST_EXPECT(err.is(TokenType::Error));
+    TEST_EXPECT_EQ(err.column, 8u);
+    TEST_EXPECT_EQ(lexer.error(), make_error_code(lexer_errc::invalid_character));
+    TEST_EXPECT(!lexer.error_message().empty());
+    TEST_EXPECT(lexer.next_token().is(TokenType::Error));
+
+    Lexer done("  // only comment\n");
+    TEST_EXPECT(done.next_token().is(TokenType::Eof));
+    TEST_EXPECT(done.next_token().is(TokenType::Eof));
+}
+
+void test_parser_streaming_matches_batch() {
+    const char *sml = R"(
+    m1: S1F1 W <L <A "a\tb"> <U2 1 0x1F> <F4 -0x10 1.5e2> <Boolean 1>>.
+    m2: 'S2F2' <B 0xFF>.
+    if (m1(2)==<A "a\tb">) m2.
+    every 5 send m1.
+    )";
+
+    Lexer batch_lexer(sml);
+    auto lex = batch_lexer.tokenize();
+    TEST_EXPECT_OK(lex.ec);
+    Parser batch(std::move(lex.tokens));
+    auto from_batch = batch.parse();
+    TEST_EXPECT_OK(from_batch.ec);
+
+    Lexer stream_lexer(sml);
+    Parser streaming(stream_lexer);
+    auto from_stream = streaming.parse();
+    TEST_EXPECT_OK(from_stream.ec);
+
+    const auto &a = from_batch.document.messages;
+    const auto &b = from_stream.document.messages;
+    TEST_EXPECT_EQ(a.size(), b.size());
+    for (std::size_t i = 0; i < a.size() && i < b.size(); ++i) {
+        TEST_EXPECT_EQ(a[i].name, b[i].name);
+        TEST_EXPECT_EQ(a[i].stream, b[i].stream);
+        TEST_EXPECT_EQ(a[i].function, b[i].function);
+        TEST_EXPECT_EQ(a[i].w_bit, b[i].w_bit);
+        Item ra{List{}};
+        Item rb{List{}};
+        TEST_EXPECT_OK(render_item(a[i].item, RenderContext{}, ra));
+        TEST_EXPECT_OK(render_item(b[i].item, RenderContext{}, rb));
+        TEST_EXPECT(ra == rb);
+    }
+    TEST_EXPECT_EQ(from_stream.document.conditions.size(), 1u);
+    TEST_EXPECT_EQ(from_stream.document.timers.size(), 1u);
+
+    // 整数/十六进制 token 作为 F4 值
+    const auto &list = std::get<TplList>(
+        from_stream.document.messages[0].item.storage());
+    const auto &f4 = std::get<TplF4>(list[2].storage());
+    TEST_EXPECT_EQ(std::get<float>(f4.values[0]), -16.0f);
+    TEST_EXPECT_EQ(std::get<float>(f4.values[1]), 150.0f);
+}
+
+void test_parse_float_literal_out_of_range() {
+    // 越界字面量：上溢为 ±inf，下溢为 0（与 strtod 一致），而不是被丢弃。
+    auto result = parse_sml("m: S1F1 <L <F4 1.0e999 -1.0e999> <F8 1.0e999 -1.0e999 1.0e-999>>.");
+    TEST_EXPECT(!result.ec);
+    TEST_EXPECT_EQ(result.document.messages.size(), 1u);
+    const auto &list =
+        std::get<TplList>(result.document.messages[0].item.storage());
+    const auto &f4 = std::get<TplF4>(list[0].storage());
+    TEST_EXPECT_EQ(f4.values.size(), 2u);
+    TEST_EXPECT_EQ(std::get<float>(f4.values[0]),
+                   std::numeric_limits<float>::infinity());
+    TEST_EXPECT_EQ(std::get<float>(f4.values[1]),
+                   -std::numeric_limits<float>::infinity());
+    const auto &f8 = std::get<TplF8>(list[1].storage());
+    TEST_EXPECT_EQ(f8.values.size(), 3u);
+    TEST_EXPECT_EQ(std::get<double>(f8.values[0]),
+                   std::numeric_limits<double>::infinity());
+    TEST_EXPECT_EQ(std::get<double>(f8.values[1]),
+                   -std::numeric_limits<double>::infinity());
+    TEST_EXPECT_EQ(std::get<double>(f8.values[2]), 0.0);
+}
+
+void test_parse_sml_reports_first_error_in_stream_order() {
+    // 流式解析：位于词法错误之前的语法错误先被报告。
+    auto syntax_first = parse_sml("S1F1 <X>. @");
+    TEST_EXPECT_EQ(syntax_first.ec, make_error_code(parser_errc::expected_item));
+
+    auto lexer_first = parse_sml("S1F1 <L>. @ S1F2 <X>.");
+    TEST_EXPECT_EQ(lexer_first.ec,
+                   make_error_code(lexer_errc::invalid_character));
+    TEST_EXPECT_EQ(lexer_first.error_column, 11u);
+}
+
 void test_parse_sml_propagates_lexer_error() {
     auto result = parse_sml("@");
     TEST_EXPECT_EQ(result.ec, make_error_code(lexer_errc::invalid_character));
@@ -1298,6 +1427,11 @@ int main() {
     test_lexer_invalid_hex_literal_is_error();
     test_lexer_unexpected_equal_is_error();
     test_lexer_string_escapes();
+    test_lexer_tokens_are_views_into_source();
+    test_lexer_next_token_streams_and_sticks_on_error();
+    test_parser_streaming_matches_batch();
+    test_parse_float_literal_out_of_range();
+    test_parse_sml_reports_first_error_in_stream_order();
 
     // Parser 测试
     test_parser_simple_message();
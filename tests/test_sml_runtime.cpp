@@ -1,9 +1,49 @@
 #include "secs/sml/runtime.hpp"
 
+#include "secs/ii/codec.hpp"
+
 #include "test_main.hpp"
 
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
 namespace {
 
+using secs::ii::Item;
+
+std::vector<secs::ii::byte> encode_body(const Item &item) {
+    std::vector<secs::ii::byte> out;
+    TEST_EXPECT_OK(secs::ii::encode(item, out));
+    return out;
+}
+
+// 同一 body 分别走 Item 路径与编码路径，两者结果必须一致。
+std::string match_both(const secs::sml::Runtime &rt,
+                       std::uint8_t stream,
+                       std::uint8_t function,
+                       const Item &body) {
+    const auto by_item = rt.match_response(stream, function, body);
+
+    const auto bytes = encode_body(body);
+    const std::string *by_bytes = nullptr;
+    TEST_EXPECT_OK(rt.match_response_encoded(
+        stream,
+        function,
+        secs::core::bytes_view{bytes.data(), bytes.size()},
+        by_bytes));
+
+    TEST_EXPECT_EQ(by_item.has_value(), by_bytes != nullptr);
+    if (by_item && by_bytes) {
+        TEST_EXPECT_EQ(*by_item, *by_bytes);
+    }
+    return by_item.value_or(std::string{});
+}
+
 void test_sf_index_named_first_wins() {
     secs::sml::Runtime rt;
     const char *source = R"(
@@ -38,11 +78,365 @@ S1F1 W <L <A "anon">>.
     TEST_EXPECT(msg_name->name.empty());
 }
 
+void test_condition_index_keeps_document_order_per_sf() {
+    secs::sml::Runtime rt;
+    const char *source = R"(
+req: S1F3 W <L <U4 1>>.
+r_any: S1F4 <L>.
+r_two: S1F4 <L>.
+r_one: S1F4 <L>.
+r_s2: S2F2 <L>.
+if (S2F1) r_s2.
+if (req(2)==<U4 2>) r_two.
+if (S1F3(2)==<U4 1>) r_one.
+if (S1F3) r_any.
+if (missing) r_any.
+)";
+    TEST_EXPECT_OK(rt.load(source));
+
+    TEST_EXPECT_EQ(match_both(rt, 1, 3, Item::list({Item::u4({1u})})),
+                   std::string("r_one"));
+    TEST_EXPECT_EQ(match_both(rt, 1, 3, Item::list({Item::u4({2u})})),
+                   std::string("r_two"));
+    TEST_EXPECT_EQ(match_both(rt, 1, 3, Item::list({Item::u4({3u})})),
+                   std::string("r_any"));
+    TEST_EXPECT_EQ(match_both(rt, 2, 1, Item::list({})), std::string("r_s2"));
+    TEST_EXPECT_EQ(match_both(rt, 9, 9, Item::list({})), std::string{});
+}
+
+void test_encoded_match_nested_index_and_fallbacks() {
+    secs::sml::Runtime rt;
+    const char *source = R"(
+r_nested: S6F12 <B 0>.
+r_bool: S1F2 <L>.
+r_float: S3F2 <L>.
+if (S6F11(3)==<L <U4 100> <A "ON">>) r_nested.
+if (S1F1(2)==<Boolean 0x01>) r_bool.
+if (S3F1(3)==<F4 1.5>) r_float.
+)";
+    TEST_EXPECT_OK(rt.load(source));
+
+    // 先序编号 3 指向一个子 List：需要整棵子树逐字节相等。
+    const auto report = Item::list({
+        Item::u4({7u}),
+        Item::list({Item::u4({100u}), Item::ascii("ON")}),
+        Item::ascii("tail"),
+    });
+    TEST_EXPECT_EQ(match_both(rt, 6, 11, report), std::string("r_nested"));
+    TEST_EXPECT_EQ(
+        match_both(rt,
+                   6,
+                   11,
+                   Item::list({Item::u4({7u}),
+                               Item::list({Item::u4({100u}),
+                                           Item::ascii("OFF")})})),
+        std::string{});
+
+    // 根节点不是 List：索引规则不命中
+    TEST_EXPECT_EQ(match_both(rt, 6, 11, Item::u4({100u})), std::string{});
+
+    // Boolean 非 0 字节在解码时视为 true：编码路径回退为解码比较
+    const std::vector<secs::ii::byte> bool_body{
+        secs::ii::byte{0x01}, secs::ii::byte{0x01}, // <L [1]>
+        secs::ii::byte{0x25}, secs::ii::byte{0x01}, // <Boolean [1]>
+        secs::ii::byte{0x02}};
+    const std::string *name = nullptr;
+    TEST_EXPECT_OK(rt.match_response_encoded(
+        1, 1, secs::core::bytes_view{bool_body.data(), bool_body.size()}, name));
+    TEST_EXPECT(name != nullptr);
+    if (name) {
+        TEST_EXPECT_EQ(*name, std::string("r_bool"));
+    }
+
+    // 顶层浮点保留容差比较
+    TEST_EXPECT_EQ(
+        match_both(rt,
+                   3,
+                   1,
+                   Item::list({Item::u1({0u}), Item::f4({1.50001f})})),
+        std::string("r_float"));
+    TEST_EXPECT_EQ(
+        match_both(rt, 3, 1, Item::list({Item::u1({0u}), Item::f4({1.6f})})),
+        std::string{});
+}
+
+void test_encoded_match_ignores_length_width_and_nested_float_bits() {
+    secs::sml::Runtime rt;
+    const char *source = R"(
+r_nested: S6F12 <B 0>.
+r_zero: S2F14 <L>.
+if (S6F11(3)==<L <U4 100> <A "ON">>) r_nested.
+if (S2F13(3)==<L <F4 0.0>>) r_zero.
+)";
+    TEST_EXPECT_OK(rt.load(source));
+
+    // 合法但非最短的长度字段：编码路径必须与解码后的 Item 路径一致。
+    using B = secs::ii::byte;
+    const std::vector<B> wide{
+        B{0x02}, B{0x00}, B{0x02},                            // <L [2]>，2 字节长度
+        B{0xB1}, B{0x04}, B{0x00}, B{0x00}, B{0x00}, B{0x07}, // <U4 7>
+        B{0x03}, B{0x00}, B{0x00}, B{0x02},                   // <L [2]>，3 字节长度
+        B{0xB1}, B{0x04}, B{0x00}, B{0x00}, B{0x00}, B{0x64}, // <U4 100>
+        B{0x42}, B{0x00}, B{0x02}, B{'O'}, B{'N'},            // <A "ON">，2 字节长度
+    };
+    Item decoded = Item::list({});
+    std::size_t consumed = 0;
+    TEST_EXPECT_OK(secs::ii::decode_one(
+        secs::ii::bytes_view{wide.data(), wide.size()}, decoded, consumed));
+    TEST_EXPECT_EQ(rt.match_response(6, 11, decoded).value_or(std::string{}),
+                   std::string("r_nested"));
+    const std::string *name = nullptr;
+    TEST_EXPECT_OK(rt.match_response_encoded(
+        6, 11, secs::core::bytes_view{wide.data(), wide.size()}, name));
+    TEST_EXPECT(name != nullptr && *name == "r_nested");
+
+    // 含嵌套浮点的期望值不走字节比较：-0.0、NaN 的结果与 items_equal 一致。
+    TEST_EXPECT_EQ(match_both(rt,
+                              2,
+                              13,
+                              Item::list({Item::u1({0u}),
+                                          Item::list({Item::f4({0.0f})})})),
+                   std::string("r_zero"));
+    (void)match_both(
+        rt, 2, 13, Item::list({Item::u1({0u}), Item::list({Item::f4({-0.0f})})}));
+    (void)match_both(
+        rt,
+        2,
+        13,
+        Item::list({Item::u1({0u}),
+                    Item::list({Item::f4({std::numeric_limits<float>::quiet_NaN()})})}));
+}
+
+void test_encoded_match_rejects_invalid_body() {
+    secs::sml::Runtime rt;
+    TEST_EXPECT_OK(rt.load("r: S1F2 <L>.\nif (S1F1) r.\n"));
+
+    const std::string *name = nullptr;
+    const std::vector<secs::ii::byte> truncated{secs::ii::byte{0x41},
+                                                secs::ii::byte{0x05}};
+    const auto ec = rt.match_response_encoded(
+        1, 1, secs::core::bytes_view{truncated.data(), truncated.size()}, name);
+    TEST_EXPECT_EQ(ec, secs::ii::make_error_code(secs::ii::errc::truncated));
+    TEST_EXPECT(name == nullptr);
+
+    TEST_EXPECT_EQ(
+        rt.match_response_encoded(1, 1, secs::core::bytes_view{}, name),
+        secs::ii::make_error_code(secs::ii::errc::truncated));
+}
+
+// encode_message_body（可能走预编码快路径）必须与 render_item + encode 逐字节一致。
+std::vector<secs::ii::byte> encode_both(const secs::sml::Runtime &rt,
+                                        std::string_view name,
+                                        const secs::sml::RenderContext &ctx) {
+    const auto *msg = rt.get_message(name);
+    TEST_EXPECT(msg != nullptr);
+    if (!msg) {
+        return {};
+    }
+    Item rendered{secs::ii::List{}};
+    TEST_EXPECT_OK(secs::sml::render_item(msg->item, ctx, rendered));
+    const auto expected = encode_body(rendered);
+
+    std::vector<secs::ii::byte> out;
+    TEST_EXPECT_OK(rt.encode_message_body(name, ctx, out));
+    TEST_EXPECT(out == expected);
+    return out;
+}
+
+void test_encoded_template_fast_path_matches_render() {
+    secs::sml::Runtime rt;
+    const char *source = R"(
+lit: S1F13 W <L <A "MDL"> <A "1.0"> <U4 1 2 3> <F8 1.5> <Boolean 0x01>>.
+rpt: S6F11 W <L <U4 DATAID> <U2 CEID> <L <F4 TEMP> <B FLAG> <Boolean ON> <I8 -1 POS>>>.
+name: S1F1 <A MDLN>.
+)";
+    TEST_EXPECT_OK(rt.load(source));
+
+    secs::sml::EncodedTemplate tpl;
+    TEST_EXPECT(secs::sml::compile_template(rt.get_message("lit")->item, tpl));
+    TEST_EXPECT(tpl.slots.empty());
+    TEST_EXPECT(secs::sml::compile_template(rt.get_message("rpt")->item, tpl));
+    TEST_EXPECT_EQ(tpl.slots.size(), static_cast<std::size_t>(6));
+    // ASCII 占位符长度不定：不生成镜像。
+    TEST_EXPECT(!secs::sml::compile_template(rt.get_message("name")->item, tpl));
+    TEST_EXPECT(!tpl.fast_path);
+
+    const secs::sml::RenderContext empty{};
+    (void)encode_both(rt, "lit", empty);
+
+    secs::sml::RenderContext ctx;
+    ctx.set("DATAID", Item::u4({0x01020304u}));
+    ctx.set("CEID", Item::u2({0xBEEFu}));
+    ctx.set("TEMP", Item::f4({-12.25f}));
+    ctx.set("FLAG", Item::binary({secs::ii::byte{0xA5}}));
+    ctx.set("ON", Item::boolean({true}));
+    ctx.set("POS", Item::i8({-0x1122334455667788LL}));
+    (void)encode_both(rt, "rpt", ctx);
+
+    // 补丁只写入 ctx 的值，不残留上一次的数据。
+    ctx.set("DATAID", Item::u4({7u}));
+    ctx.set("ON", Item::boolean({false}));
+    (void)encode_both(rt, "rpt", ctx);
+
+    ctx.set("MDLN", Item::ascii("EQP-01"));
+    (void)encode_both(rt, "name", ctx);
+}
+
+void test_encoded_template_falls_back_to_render() {
+    secs::sml::Runtime rt;
+    const char *source = R"(
+rpt: S6F11 W <L <U4 DATAID> <U2 CEIDS>>.
+)";
+    TEST_EXPECT_OK(rt.load(source));
+
+    secs::sml::RenderContext ctx;
+    ctx.set("DATAID", Item::u4({1u}));
+
+    // 多值 / 空值展开：镜像长度不成立，回退到 render_item。
+    ctx.set("CEIDS", Item::u2({1u, 2u, 3u}));
+    auto out = encode_both(rt, "rpt", ctx);
+    TEST_EXPECT_EQ(out.size(), static_cast<std::size_t>(2 + 2 + 4 + 2 + 6));
+    ctx.set("CEIDS", Item::u2(std::vector<std::uint16_t>{}));
+    (void)encode_both(rt, "rpt", ctx);
+
+    // 错误码仍由慢路径给出，且 out_body 被清空。
+    std::vector<secs::ii::byte> body{secs::ii::byte{0xFF}};
+    ctx.set("CEIDS", Item::u4({1u}));
+    TEST_EXPECT_EQ(rt.encode_message_body("rpt", ctx, body),
+                   secs::sml::make_error_code(
+                       secs::sml::render_errc::type_mismatch));
+    TEST_EXPECT(body.empty());
+
+    secs::sml::RenderContext missing;
+    missing.set("DATAID", Item::u4({1u}));
+    body.assign(3, secs::ii::byte{0xFF});
+    TEST_EXPECT_EQ(rt.encode_message_body("rpt", missing, body),
+                   secs::sml::make_error_code(
+                       secs::sml::render_errc::missing_variable));
+    TEST_EXPECT(body.empty());
+}
+
+// 含注释、字符串、浮点与跨行语句的源文本：切片扫描必须与 Lexer 的边界判断一致。
+std::string make_library_source(std::size_t count) {
+    std::string out = "/* header. with dots. */\n";
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto n = std::to_string(i);
+        out += "m" + n + ": S1F" + std::to_string(i % 200 + 1) + " W\n";
+        out += "  <L <A \"v1.0. \\\"q.\"> <F4 1.5 2.25> // tail.\n";
+        out += "     <U4 " + n + ">>.\n";
+        out += "if (m" + n + "(3)==<U4 " + n + ">) m" + n + ". /* x.\n y. */\n";
+    }
+    out += "every 5 send m0.\n";
+    return out;
+}
+
+void expect_same_document(const secs::sml::Document &a,
+                          const secs::sml::Document &b) {
+    TEST_EXPECT_EQ(a.messages.size(), b.messages.size());
+    TEST_EXPECT_EQ(a.conditions.size(), b.conditions.size());
+    TEST_EXPECT_EQ(a.timers.size(), b.timers.size());
+    for (std::size_t i = 0; i < a.messages.size() && i < b.messages.size(); ++i) {
+        TEST_EXPECT_EQ(a.messages[i].name, b.messages[i].name);
+        TEST_EXPECT_EQ(a.messages[i].function, b.messages[i].function);
+    }
+    for (std::size_t i = 0; i < a.conditions.size() && i < b.conditions.size();
+         ++i) {
+        TEST_EXPECT_EQ(a.conditions[i].response_name,
+                       b.conditions[i].response_name);
+    }
+}
+
+void test_parallel_parse_matches_sequential() {
+    const auto source = make_library_source(200);
+    const auto sequential = secs::sml::parse_sml(source);
+    TEST_EXPECT_OK(sequential.ec);
+
+    secs::sml::LibraryLoadOptions opt;
+    opt.threads = 4;
+    opt.split_bytes = 64; // 强制切成大量切片
+    const auto parallel = secs::sml::parse_sml_parallel(source, opt);
+    TEST_EXPECT_OK(parallel.ec);
+    expect_same_document(sequential.document, parallel.document);
+
+    // 报错位置（行号相对整个源文本）与顺序解析一致，且取第一个错误。
+    const auto bad = source + "m_bad: S1F1 <U4 @>.\nm_bad2: S1F1 <X>.\n";
+    const auto seq_err = secs::sml::parse_sml(bad);
+    const auto par_err = secs::sml::parse_sml_parallel(bad, opt);
+    TEST_EXPECT(static_cast<bool>(seq_err.ec));
+    TEST_EXPECT_EQ(par_err.ec, seq_err.ec);
+    TEST_EXPECT_EQ(par_err.error_line, seq_err.error_line);
+    TEST_EXPECT_EQ(par_err.error_column, seq_err.error_column);
+    TEST_EXPECT(par_err.document.messages.empty());
+}
+
+void test_load_files_merges_in_path_order() {
+    namespace fs = std::filesystem;
+    const auto dir = fs::temp_directory_path() / "secs_sml_library_test";
+    fs::create_directories(dir);
+    const auto write = [&](const char *name, const std::string &text) {
+        const auto path = (dir / name).string();
+        std::ofstream(path, std::ios::binary) << text;
+        return path;
+    };
+
+    const auto a = write("a.sml", "dup: S1F1 <A \"a\">.\nonly_a: S2F1 <L>.\n");
+    const auto b = write("b.sml", make_library_source(50) +
+                                      "dup: S1F1 <A \"b\">.\n");
+    const auto empty = write("empty.sml", "");
+    std::string concat;
+    for (const auto &p : {a, b, empty}) {
+        std::ifstream f(p, std::ios::binary);
+        concat.append(std::istreambuf_iterator<char>(f),
+                      std::istreambuf_iterator<char>());
+    }
+
+    secs::sml::Runtime expected;
+    TEST_EXPECT_OK(expected.load(concat));
+
+    secs::sml::LibraryLoadOptions opt;
+    opt.threads = 3;
+    opt.split_bytes = 128;
+    secs::sml::Runtime rt;
+    TEST_EXPECT_OK(rt.load_files({a, b, empty}, opt));
+    expect_same_document(
+        secs::sml::Document{expected.messages(), expected.conditions(),
+                            expected.timers()},
+        secs::sml::Document{rt.messages(), rt.conditions(), rt.timers()});
+
+    // 同名冲突：与单文件加载一致（后定义覆盖名称索引）。
+    const auto *dup = rt.get_message("dup");
+    TEST_EXPECT(dup != nullptr);
+    TEST_EXPECT(dup == &rt.messages().back());
+
+    // 出错文件：给出路径与相对该文件的行号。
+    const auto bad = write("bad.sml", "ok: S1F1.\n\nbroken: S1F1 <L\n");
+    auto result = secs::sml::parse_sml_files({a, bad}, opt);
+    TEST_EXPECT_EQ(result.ec,
+                   secs::sml::make_error_code(secs::sml::parser_errc::unclosed_item));
+    TEST_EXPECT_EQ(result.error_path, bad);
+    TEST_EXPECT_EQ(result.error_line, 4u);
+
+    const auto missing = (dir / "missing.sml").string();
+    result = secs::sml::parse_sml_files({a, missing}, opt);
+    TEST_EXPECT(result.ec == std::errc::no_such_file_or_directory);
+    TEST_EXPECT_EQ(result.error_path, missing);
+
+    fs::remove_all(dir);
+}
+
 } // namespace
 
 int main() {
     test_sf_index_named_first_wins();
     test_sf_index_anonymous_overrides_named();
+    test_condition_index_keeps_document_order_per_sf();
+    test_encoded_match_nested_index_and_fallbacks();
+    test_encoded_match_ignores_length_width_and_nested_float_bits();
+    test_encoded_match_rejects_invalid_body();
+    test_encoded_template_fast_path_matches_render();
+    test_encoded_template_falls_back_to_render();
+    test_parallel_parse_matches_sequential();
+    test_load_files_merges_in_path_order();
     return secs::tests::run_and_report();
 }
 
@@ -4,6 +4,7 @@
  */
 
 #include "secs/core/error.hpp"
+#include "secs/core/memory_budget.hpp"
 #include "secs/ii/codec.hpp"
 #include "secs/protocol/router.hpp"
 #include "secs/protocol/typed_handler.hpp"
@@ -15,6 +16,7 @@
 #include <asio/io_context.hpp>
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -133,6 +135,25 @@ public:
     }
 };
 
+// 记录 handle() 执行期间预算的占用量。
+class BudgetProbeHandler : public TypedHandler<TestRequest, TestResponse> {
+public:
+    explicit BudgetProbeHandler(std::shared_ptr<secs::core::MemoryBudget> budget)
+        : budget_(std::move(budget)) {}
+
+    asio::awaitable<std::pair<std::error_code, TestResponse>>
+    handle(const TestRequest &request,
+           const DataMessage & /*原始消息*/) override {
+        used_in_handle = budget_->used();
+        co_return std::pair{std::error_code{}, TestResponse{request.value}};
+    }
+
+    std::size_t used_in_handle{0};
+
+private:
+    std::shared_ptr<secs::core::MemoryBudget> budget_;
+};
+
 // ============================================================================
 // 辅助函数
 // ============================================================================
@@ -361,6 +382,39 @@ void test_decode_limits_can_reject_large_payload() {
     ioc.run();
 }
 
+void test_decoded_request_is_charged_to_message_budget() {
+    asio::io_context ioc;
+    auto budget = std::make_shared<secs::core::MemoryBudget>(
+        secs::core::MemoryBudgetOptions{.limit_bytes = 0});
+    auto handler = std::make_shared<BudgetProbeHandler>(budget);
+
+    const auto body = encode_request(TestRequest{"hello"});
+    auto msg = make_data_message(body);
+    // 模拟接收路径：消息体已计入预算（DecodeOptions 未配置预算时沿用之）。
+    TEST_EXPECT(budget->try_acquire(body.size()));
+    msg.memory_lease = secs::core::make_memory_lease(
+        secs::core::MemoryReservation(budget, body.size()));
+
+    std::error_code ec = make_error_code(errc::timeout);
+    asio::co_spawn(
+        ioc,
+        [&]() -> asio::awaitable<void> {
+            auto [rec, response_body] = co_await handler->invoke(msg);
+            ec = rec;
+            co_return;
+        },
+        asio::detached);
+    ioc.run();
+
+    TEST_EXPECT_OK(ec);
+    // handle() 执行期间：消息体 + 解码出的 2 个节点与 5 字节 payload。
+    TEST_EXPECT_EQ(handler->used_in_handle, body.size() + 2 * sizeof(Item) + 5);
+    // invoke 返回后解码结果已释放，只剩消息体本身。
+    TEST_EXPECT_EQ(budget->used(), body.size());
+    msg.memory_lease.reset();
+    TEST_EXPECT_EQ(budget->used(), 0U);
+}
+
 void test_register_typed_handler() {
     asio::io_context ioc;
     Router router;
@@ -434,6 +488,7 @@ int main() {
     test_decode_strict_consumed_rejects_trailing_bytes();
     test_decode_non_strict_consumed_allows_trailing_bytes();
     test_decode_limits_can_reject_large_payload();
+    test_decoded_request_is_charged_to_message_budget();
     test_register_typed_handler();
     test_multiple_handlers();
     test_secs_message_concept();
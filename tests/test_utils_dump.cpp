@@ -4,14 +4,17 @@
 #include <secs/hsms/message.hpp>
 #include <secs/ii/codec.hpp>
 #include <secs/secs1/block.hpp>
+#include <secs/utils/async_dump.hpp>
 #include <secs/utils/hex.hpp>
 #include <secs/utils/hsms_dump.hpp>
 #include <secs/utils/item_dump.hpp>
 #include <secs/utils/secs1_dump.hpp>
 
 #include <cstddef>
+#include <atomic>
 #include <cstdint>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace secs;
@@ -156,6 +159,32 @@ int main() {
         const auto s = utils::dump_item(item, opt);
         TEST_EXPECT(s.find("...") != std::string::npos);
     }
+    // 2.3) Item dump：I1/U1 按数值输出；append_* 与 dump_* 结果一致且只追加
+    {
+        ii::Item item = ii::Item::list({
+            ii::Item::i1({-1, 65}),
+            ii::Item::u1({65, 255}),
+            ii::Item::f8({0.1}),
+        });
+        utils::ItemDumpOptions opt;
+        opt.multiline = false;
+        const auto s = utils::dump_item(item, opt);
+        TEST_EXPECT(s.find("I1[2] -1 65") != std::string::npos);
+        TEST_EXPECT(s.find("U1[2] 65 255") != std::string::npos);
+        TEST_EXPECT(s.find("F8[1] 0.1") != std::string::npos);
+
+        std::string out = "prefix:";
+        utils::append_item_dump(out, item, opt);
+        TEST_EXPECT_EQ(out, "prefix:" + s);
+
+        const std::vector<core::byte> bytes = {static_cast<core::byte>(0x00),
+                                               static_cast<core::byte>(0xAB)};
+        const core::bytes_view bv{bytes.data(), bytes.size()};
+        out.clear();
+        utils::append_hex_dump(out, bv);
+        utils::append_hex_dump(out, bv);
+        TEST_EXPECT_EQ(out, utils::hex_dump(bv) + utils::hex_dump(bv));
+    }
 
     // 3) HSMS frame dump（含 SECS-II 解码）
     std::vector<core::byte> secs2_body;
@@ -185,6 +214,12 @@ int main() {
         TEST_EXPECT(out.find("S1F2") != std::string::npos);
         TEST_EXPECT(out.find("W=0") != std::string::npos);
         TEST_EXPECT(out.find("A[2]") != std::string::npos);
+
+        // 复用缓冲：append 结果与 dump 一致，且不会覆盖已有内容。
+        std::string buf = out;
+        utils::append_hsms_frame_dump(
+            buf, core::bytes_view{frame.data(), frame.size()}, opt);
+        TEST_EXPECT_EQ(buf, out + out);
     }
     // 3.1) HSMS dump：反例 + not fully consumed
     {
@@ -348,6 +383,11 @@ int main() {
             hdr, core::bytes_view{secs2_body.data(), secs2_body.size()}, opt);
         TEST_EXPECT(out.find("SECS-I message:") != std::string::npos);
         TEST_EXPECT(out.find("SECS-II:") != std::string::npos);
+
+        std::string buf = "x";
+        utils::append_secs1_message_dump(
+            buf, hdr, core::bytes_view{secs2_body.data(), secs2_body.size()}, opt);
+        TEST_EXPECT_EQ(buf, "x" + out);
     }
     // 4.1) SECS-I dump：反例 + not fully consumed
     {
@@ -492,5 +532,86 @@ int main() {
         TEST_EXPECT_EQ(ascii->value.size(), static_cast<std::size_t>(512));
     }
 
+    // 6) 延迟 dump：后台线程输出与同步 dump 相同的文本，保持入队顺序
+    {
+        std::string captured;
+        utils::AsyncDumpOptions opt;
+        opt.sink = [](void *user, const char *data, std::size_t size) noexcept {
+            static_cast<std::string *>(user)->append(data, size);
+        };
+        opt.sink_user = &captured;
+        opt.hsms.include_hex = true;
+        opt.secs1.include_hex = false;
+
+        const std::vector<core::byte> body = {0x41, 0x01, 0x5A};
+        const auto msg = hsms::make_data_message(
+            0x0001, 1, 1, true, 0x01020304, core::bytes_view{body.data(), body.size()});
+
+        secs1::Header h{};
+        h.device_id = 1;
+        h.stream = 6;
+        h.function = 11;
+        h.end_bit = true;
+        h.system_bytes = 7;
+
+        {
+            utils::AsyncDumper dumper(opt);
+            TEST_EXPECT(dumper.push_hsms(
+                "[A]\n", msg.header, core::bytes_view{msg.body.data(), msg.body.size()}));
+            TEST_EXPECT(dumper.push_secs1(
+                "[B]\n", h, core::bytes_view{body.data(), body.size()}));
+            dumper.flush();
+            TEST_EXPECT_EQ(dumper.dumped(), 2u);
+            TEST_EXPECT_EQ(dumper.dropped(), 0u);
+        }
+
+        const auto frame = hsms::encode_frame(msg);
+        const auto expected =
+            "[A]\n" +
+            utils::dump_hsms_frame(core::bytes_view{frame.data(), frame.size()},
+                                   opt.hsms) +
+            "[B]\n" +
+            utils::dump_secs1_message(h, core::bytes_view{body.data(), body.size()},
+                                      opt.secs1);
+        TEST_EXPECT_EQ(captured, expected);
+    }
+
+    // 6.1) 延迟 dump：缓冲区满时丢弃并计数，不阻塞生产者
+    {
+        static std::atomic<bool> release{false};
+        release = false;
+        utils::AsyncDumpOptions opt;
+        opt.buffer_bytes = 1024;
+        // sink 阻塞到 release，模拟后台线程跟不上。
+        opt.sink = [](void *, const char *, std::size_t) noexcept {
+            while (!release.load()) {
+                std::this_thread::yield();
+            }
+        };
+
+        const std::vector<core::byte> body(200, 0x00);
+        const hsms::Header header{};
+        utils::AsyncDumper dumper(opt);
+        int accepted = 0;
+        for (int i = 0; i < 64; ++i) {
+            if (dumper.push_hsms("", header, core::bytes_view{body.data(), body.size()})) {
+                ++accepted;
+            }
+        }
+        TEST_EXPECT(accepted < 64);
+        TEST_EXPECT_EQ(dumper.dropped(), static_cast<std::uint64_t>(64 - accepted));
+
+        // 超过缓冲区容量的单条记录直接丢弃。
+        const std::vector<core::byte> huge(4096, 0x00);
+        TEST_EXPECT(!dumper.push_hsms("", header, core::bytes_view{huge.data(), huge.size()}));
+
+        release = true;
+        dumper.flush();
+        TEST_EXPECT_EQ(dumper.dumped(), static_cast<std::uint64_t>(accepted));
+
+        dumper.stop();
+        TEST_EXPECT(!dumper.push_hsms("", header, core::bytes_view{body.data(), body.size()}));
+    }
+
     return secs::tests::run_and_report();
 }